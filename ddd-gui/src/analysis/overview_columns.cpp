@@ -0,0 +1,68 @@
+/************************************************************************
+
+    overview_columns.cpp
+
+    A capture overview reduced to one column per pixel
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "overview_columns.h"
+
+#include <algorithm>
+
+namespace ddd::analysis {
+
+void DecimateOverview(const std::vector<capture::OverviewBlock>& blocks,
+                      const WaveformMapping& mapping,
+                      std::vector<OverviewColumn>& columns) {
+  columns.assign(
+      mapping.Valid() ? static_cast<size_t>(mapping.width_pixels) : size_t{0},
+      OverviewColumn{});
+  if (columns.empty()) {
+    return;
+  }
+
+  // Each column's blocks merged whole, and the RMS taken once at the end from
+  // the merged sum of squares.
+  std::vector<capture::OverviewBlock> merged(columns.size());
+
+  const uint64_t window_end = mapping.first_sample + mapping.sample_span;
+  for (const capture::OverviewBlock& block : blocks) {
+    if (block.sample_count == 0 || block.end_sample() <= mapping.first_sample ||
+        block.first_sample >= window_end) {
+      continue;
+    }
+
+    const uint64_t start = std::max<uint64_t>(
+        block.first_sample, static_cast<uint64_t>(mapping.first_sample));
+    const double x = mapping.SampleToX(static_cast<double>(start));
+    if (x < 0.0) {
+      continue;
+    }
+    const auto column = static_cast<size_t>(x);
+    if (column >= columns.size()) {
+      continue;
+    }
+
+    merged[column].Merge(block);
+  }
+
+  for (size_t column = 0; column < columns.size(); ++column) {
+    const capture::OverviewBlock& summary = merged[column];
+    if (summary.sample_count == 0) {
+      continue;
+    }
+
+    OverviewColumn& target = columns[column];
+    target.populated = true;
+    target.minimum = summary.minimum_value;
+    target.maximum = summary.maximum_value;
+    target.rms = summary.Rms();
+    target.clipped = summary.clipped_low_count + summary.clipped_high_count;
+  }
+}
+
+}  // namespace ddd::analysis
@@ -0,0 +1,53 @@
+/************************************************************************
+
+    overview_columns.h
+
+    A capture overview reduced to one column per pixel
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "capture_overview.h"
+#include "waveform_mapping.h"
+
+namespace ddd::analysis {
+
+// The review view's arithmetic: DecimateToColumns, for blocks rather than
+// samples.
+//
+// The same rule applies and for the same reason. Each block goes to the column
+// its first sample falls in, and a column no block starts in is left
+// unpopulated — so a view zoomed in past the overview's finest level shows the
+// gaps between the blocks it has, rather than stretching each one across
+// columns it was never measured for. The view picks the level that keeps the
+// blocks no longer than a column (CaptureOverviewFile::LevelFor), and at that
+// level every column has one.
+//
+// The extremes of a column are the extremes of its blocks, its clipping their
+// sum, and its RMS the RMS of all their samples together — recomputed from the
+// sums of squares rather than averaged, since an average of RMS figures is not
+// the RMS of anything.
+struct OverviewColumn {
+  uint16_t minimum = 0;
+  uint16_t maximum = 0;
+  double rms = 0.0;
+  uint64_t clipped = 0;
+  bool populated = false;
+};
+
+// Reduce a run of blocks, in order, to one column per pixel across the
+// mapping's window. A block that starts before the window and reaches into it
+// is credited to the first column; the window begins inside it.
+void DecimateOverview(const std::vector<capture::OverviewBlock>& blocks,
+                      const WaveformMapping& mapping,
+                      std::vector<OverviewColumn>& columns);
+
+}  // namespace ddd::analysis
@@ -12,6 +12,7 @@
 #include "sinc_interpolation.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <numbers>
 
@@ -68,6 +69,16 @@ ReconstructionKernel::ReconstructionKernel(int half_taps)
       }
     }
   }
+
+  const auto tap_count = static_cast<size_t>(taps());
+  run_stride_ = ((tap_count + kRunLanes - 1) / kRunLanes) * kRunLanes;
+  run_weights_.assign(kReconstructionPhases * run_stride_, 0.0F);
+  for (size_t phase = 0; phase < kReconstructionPhases; ++phase) {
+    for (size_t tap = 0; tap < tap_count; ++tap) {
+      run_weights_[(phase * run_stride_) + tap] =
+          static_cast<float>(weights_[(phase * tap_count) + tap]);
+    }
+  }
 }
 
 double ReconstructionKernel::Evaluate(const uint16_t* codes, size_t count,
@@ -101,4 +112,70 @@ double ReconstructionKernel::Evaluate(const uint16_t* codes, size_t count,
   return total;
 }
 
+void ReconstructionKernel::EvaluateRun(const uint16_t* codes, size_t count,
+                                       double first_position, double step,
+                                       size_t points,
+                                       std::vector<float>& values) {
+  values.resize(points);
+  if (points == 0) {
+    return;
+  }
+  if (codes == nullptr || count == 0) {
+    std::fill(values.begin(), values.end(), 0.0F);
+    return;
+  }
+  if (count == 1) {
+    std::fill(values.begin(), values.end(), static_cast<float>(codes[0]));
+    return;
+  }
+
+  // The whole parts the run can land on. Positions move one way only, so its
+  // two ends bound them whichever way the step goes.
+  const double last = static_cast<double>(count - 1);
+  const double end_position =
+      first_position + (step * static_cast<double>(points - 1));
+  const auto low_base = static_cast<int64_t>(std::floor(
+      std::clamp(std::min(first_position, end_position), 0.0, last)));
+  const auto high_base = static_cast<int64_t>(std::floor(
+      std::clamp(std::max(first_position, end_position), 0.0, last)));
+
+  // From the first tap of the lowest to the last padded tap of the highest,
+  // with every index past an end reading that end, as Evaluate's clamp does.
+  const int64_t origin = low_base - half_taps_ + 1;
+  padded_.resize(static_cast<size_t>(high_base - low_base) + run_stride_);
+  for (size_t index = 0; index < padded_.size(); ++index) {
+    const int64_t source = std::clamp<int64_t>(
+        origin + static_cast<int64_t>(index), 0,
+        static_cast<int64_t>(count) - 1);
+    padded_[index] = static_cast<float>(codes[static_cast<size_t>(source)]);
+  }
+
+  for (size_t point = 0; point < points; ++point) {
+    const double position = std::clamp(
+        first_position + (step * static_cast<double>(point)), 0.0, last);
+    const double base = std::floor(position);
+    const size_t phase = std::min(
+        kReconstructionPhases - 1,
+        static_cast<size_t>((position - base) *
+                            static_cast<double>(kReconstructionPhases)));
+
+    const float* const row = &run_weights_[phase * run_stride_];
+    const float* const input =
+        &padded_[static_cast<size_t>(static_cast<int64_t>(base) - low_base)];
+
+    std::array<float, kRunLanes> lanes{};
+    for (size_t tap = 0; tap < run_stride_; tap += kRunLanes) {
+      for (size_t lane = 0; lane < kRunLanes; ++lane) {
+        lanes[lane] += input[tap + lane] * row[tap + lane];
+      }
+    }
+
+    float total = 0.0F;
+    for (const float lane : lanes) {
+      total += lane;
+    }
+    values[point] = total;
+  }
+}
+
 }  // namespace ddd::analysis
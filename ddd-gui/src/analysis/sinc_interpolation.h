@@ -63,6 +63,27 @@ class ReconstructionKernel {
   // show something flat rather than something invented.
   double Evaluate(const uint16_t* codes, size_t count, double position) const;
 
+  // The same at `points` evenly spaced positions, first_position and then
+  // `step` apart, into values — one call per sweep rather than one per pixel.
+  // Ends are held exactly as Evaluate holds them.
+  //
+  // The display's path, and built to be cheap rather than exact. Evaluate
+  // clamps every tap's index and works in double; at a zoomed-in span on a
+  // high-density screen that is several thousand points a sweep and thirty
+  // sweeps a frame, and it is what made those views slow to redraw. Here the
+  // input the run can reach is copied once into a padded float buffer with the
+  // ends already held, so no tap needs a clamp, and each point is a fixed
+  // number of multiply-adds over two contiguous float rows in eight
+  // independent partial sums — a shape the compiler turns into vector
+  // instructions on any target without being told which. In float the result
+  // is within a thousandth of a code of Evaluate's, a hundredth of a pixel on
+  // the tallest plot.
+  //
+  // Not safe to call from two threads at once, unlike Evaluate: the padded
+  // copy is the kernel's own scratch, kept so a sweep allocates nothing.
+  void EvaluateRun(const uint16_t* codes, size_t count, double first_position,
+                   double step, size_t points, std::vector<float>& values);
+
   int half_taps() const { return half_taps_; }
   int taps() const { return half_taps_ * 2; }
 
@@ -76,6 +97,16 @@ class ReconstructionKernel {
   // fraction, which would draw a flat signal as a faint ripple at the pixel
   // pitch — an artefact that looks like noise on the signal and is not.
   std::vector<double> weights_;
+
+  // The same table in float for EvaluateRun, each row padded with zero
+  // weights to a whole number of kRunLanes so the partial sums never need a
+  // remainder loop.
+  static constexpr size_t kRunLanes = 8;
+  size_t run_stride_ = 0;
+  std::vector<float> run_weights_;
+
+  // EvaluateRun's copy of the input it reads, ends held
+  std::vector<float> padded_;
 };
 
 }  // namespace ddd::analysis
@@ -0,0 +1,345 @@
+/************************************************************************
+
+    video_preview.cpp
+
+    A field of the disc's picture, from one contiguous run of RF
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "video_preview.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sample_format.h"
+
+namespace ddd::analysis {
+namespace {
+
+// IEC 60856: sync tip 6.76 MHz, blanking 7.1, peak white 7.9. 625 lines at
+// 25 frames, so 64 µs a line and 312.5 to a field. The picture starts 10.5 µs
+// after the sync's leading edge — 12 µs of blanking less the 1.5 µs front
+// porch before it — and runs for 52.
+constexpr VideoStandardPreset kPalPreset = {
+    "PAL", 6'760'000.0, 7'100'000.0, 7'900'000.0, 64.0e-6, 312.5,
+    4.7e-6, 10.5e-6, 52.0e-6, 3'000'000.0, 13'000'000.0};
+
+// IEC 60857: sync tip 7.6 MHz, blanking 8.1, peak white 9.3. 525 lines at
+// 29.97 frames. The band starts higher than PAL's because the analogue audio
+// carriers are at 2.3 and 2.8 MHz rather than below 1.1.
+constexpr VideoStandardPreset kNtscPreset = {
+    "NTSC", 7'600'000.0, 8'100'000.0, 9'300'000.0, 63.556e-6, 262.5,
+    4.7e-6, 9.4e-6, 52.6e-6, 3'500'000.0, 14'000'000.0};
+
+// The highest carrier a rate can represent without folding, with the same
+// margin the demodulator keeps below Nyquist.
+constexpr double kHighestCarrierFraction = 0.48;
+
+// The demodulated frequency is smoothed over half a microsecond before syncs
+// are looked for. The sync's edges are a quarter of a microsecond; the
+// demodulator's ripple is at twice the carrier, a tenth of that.
+constexpr double kSyncSmoothingSeconds = 0.5e-6;
+
+// What counts as a line sync, relative to the standard's width. Equalising
+// pulses are half a sync and broad pulses six of them, so both fall well
+// outside and neither is mistaken for a line.
+constexpr double kLineSyncShortest = 0.7;
+constexpr double kLineSyncLongest = 1.5;
+
+// A broad pulse is most of a half line. Anything longer than this much of a
+// line is one; nothing in the active picture holds the carrier at sync tip
+// for nearly that long.
+constexpr double kBroadPulseLines = 0.3;
+
+// How far from its predicted place a line sync may be and still be taken for
+// the line's own. A little over half a line, because the field before a
+// vertical sync is offset from the one after it by exactly half a line, and
+// the first line sync the walk back finds has to be allowed to pull the raster
+// that far. Which of the two equally distant syncs it takes decides nothing
+// but whether the bottom of the picture sits a line higher or lower.
+constexpr double kSnapLines = 0.55;
+
+// Broad pulses come every half line through the vertical interval. The one
+// that starts it is the first with no other within this much of a line before
+// it.
+constexpr double kVerticalRunLines = 0.6;
+
+}  // namespace
+
+const VideoStandardPreset& PresetFor(VideoStandard standard) {
+  return standard == VideoStandard::kNtsc ? kNtscPreset : kPalPreset;
+}
+
+VideoPreview::VideoPreview(const Options& options)
+    : options_(options),
+      preset_(PresetFor(options.standard)),
+      demodulator_([&] {
+        FmDemodulator::Options demodulator;
+        demodulator.sample_rate_hz = options.sample_rate_hz == 0
+                                         ? capture::kSampleRateHz
+                                         : options.sample_rate_hz;
+        demodulator.band_low_hz = PresetFor(options.standard).band_low_hz;
+        demodulator.band_high_hz = PresetFor(options.standard).band_high_hz;
+        return demodulator;
+      }()) {
+  if (options_.sample_rate_hz == 0) {
+    options_.sample_rate_hz = capture::kSampleRateHz;
+  }
+  options_.width = std::max<size_t>(options_.width, 1);
+
+  const double rate = static_cast<double>(options_.sample_rate_hz);
+  samples_per_line_ = preset_.line_seconds * rate;
+  sync_samples_ =
+      std::max<size_t>(1, static_cast<size_t>(preset_.sync_seconds * rate));
+}
+
+bool VideoPreview::RateCarries(VideoStandard standard,
+                               uint32_t sample_rate_hz) {
+  return PresetFor(standard).white_hz <
+         static_cast<double>(sample_rate_hz) * kHighestCarrierFraction;
+}
+
+size_t VideoPreview::rows() const {
+  return static_cast<size_t>(preset_.lines_per_field);
+}
+
+bool VideoPreview::Render(const uint16_t* codes, size_t count) {
+  if (!rate_carries()) {
+    return false;
+  }
+
+  // A field and a line either side is the least a whole picture can come
+  // from; anything shorter is refused before the demodulator is paid for.
+  const double needed = samples_per_line_ * (preset_.lines_per_field + 2.0);
+  if (static_cast<double>(count) < needed) {
+    return false;
+  }
+
+  if (demodulator_.Demodulate(codes, count, frequency_hz_) == 0) {
+    return false;
+  }
+
+  FindSyncPulses();
+  if (vertical_syncs_.empty()) {
+    return false;
+  }
+
+  PlaceRows();
+
+  field_.standard = options_.standard;
+  field_.width = options_.width;
+  field_.rows = rows();
+  field_.pixels.assign(field_.width * field_.rows, 0);
+  field_.locked_rows = 0;
+  for (size_t row = 0; row < field_.rows; ++row) {
+    if (row_starts_[row] < 0.0) {
+      continue;
+    }
+    DrawRow(row, row_starts_[row]);
+    if (row_locked_[row]) {
+      ++field_.locked_rows;
+    }
+  }
+  return true;
+}
+
+void VideoPreview::FindSyncPulses() {
+  const size_t count = frequency_hz_.size();
+  const double rate = static_cast<double>(options_.sample_rate_hz);
+
+  // A centred running mean. Kept as a double sum so that a million samples of
+  // adding and subtracting floats does not drift.
+  const size_t span = std::max<size_t>(
+      1, static_cast<size_t>(kSyncSmoothingSeconds * rate) | 1U);
+  const size_t reach = span / 2;
+  smoothed_hz_.resize(count);
+  double sum = 0.0;
+  size_t held = 0;
+  for (size_t index = 0; index < std::min(reach, count); ++index) {
+    sum += frequency_hz_[index];
+    ++held;
+  }
+  for (size_t index = 0; index < count; ++index) {
+    if (index + reach < count) {
+      sum += frequency_hz_[index + reach];
+      ++held;
+    }
+    if (index > reach) {
+      sum -= frequency_hz_[index - reach - 1];
+      --held;
+    }
+    smoothed_hz_[index] = static_cast<float>(sum / static_cast<double>(held));
+  }
+
+  // Halfway between sync tip and blanking, with a quarter of the gap as
+  // hysteresis so that noise on an edge does not split one pulse into two.
+  const double gap = preset_.blanking_hz - preset_.sync_tip_hz;
+  const auto enter = static_cast<float>(preset_.sync_tip_hz + (gap * 0.5));
+  const auto leave = static_cast<float>(preset_.sync_tip_hz + (gap * 0.75));
+
+  const auto shortest = static_cast<size_t>(
+      kLineSyncShortest * static_cast<double>(sync_samples_));
+  const auto longest = static_cast<size_t>(kLineSyncLongest *
+                                           static_cast<double>(sync_samples_));
+  const auto broad = static_cast<size_t>(kBroadPulseLines * samples_per_line_);
+  const auto run = static_cast<size_t>(kVerticalRunLines * samples_per_line_);
+
+  line_syncs_.clear();
+  vertical_syncs_.clear();
+  bool inside = false;
+  size_t start = 0;
+  size_t last_broad = 0;
+  bool seen_broad = false;
+  for (size_t index = 0; index < count; ++index) {
+    const float level = smoothed_hz_[index];
+    if (!inside) {
+      if (level < enter) {
+        inside = true;
+        start = index;
+      }
+      continue;
+    }
+    if (level <= leave) {
+      continue;
+    }
+    inside = false;
+
+    const size_t width = index - start;
+    if (width >= shortest && width <= longest) {
+      line_syncs_.push_back({start, width});
+    } else if (width >= broad) {
+      // The start of a vertical interval, provided the one before it was not
+      // a broad pulse too and the buffer had been running for long enough to
+      // know that
+      if (start >= run && (!seen_broad || start - last_broad > run)) {
+        vertical_syncs_.push_back(start);
+      }
+      seen_broad = true;
+      last_broad = start;
+    }
+  }
+}
+
+void VideoPreview::PlaceRows() {
+  const size_t row_count = rows();
+  row_starts_.assign(row_count, -1.0);
+  row_locked_.assign(row_count, false);
+
+  const auto tolerance = kSnapLines * samples_per_line_;
+  const auto last_start =
+      static_cast<double>(frequency_hz_.size()) - samples_per_line_;
+
+  // The line sync nearest a predicted start, if one is near enough
+  const auto snap = [&](double predicted, bool& locked) {
+    const auto after = std::lower_bound(
+        line_syncs_.begin(), line_syncs_.end(), predicted,
+        [](const Pulse& pulse, double value) {
+          return static_cast<double>(pulse.start) < value;
+        });
+    double best = predicted;
+    double best_distance = tolerance;
+    locked = false;
+    for (auto candidate = after == line_syncs_.begin() ? after : after - 1;
+         candidate != line_syncs_.end() && candidate <= after; ++candidate) {
+      const double distance =
+          std::fabs(static_cast<double>(candidate->start) - predicted);
+      if (distance < best_distance) {
+        best = static_cast<double>(candidate->start);
+        best_distance = distance;
+        locked = true;
+      }
+    }
+    return best;
+  };
+
+  // From the vertical sync down to the bottom of the field, or to the end of
+  // the run, whichever comes first
+  const auto origin = static_cast<double>(vertical_syncs_.front());
+  double start = origin;
+  for (size_t row = 0; row < row_count; ++row) {
+    if (row > 0) {
+      bool locked = false;
+      start = snap(start + samples_per_line_, locked);
+      row_locked_[row] = locked;
+    }
+    if (start > last_start) {
+      break;
+    }
+    row_starts_[row] = start;
+  }
+
+  // And from the vertical sync back up, filling from the bottom whatever the
+  // walk down did not reach
+  start = origin;
+  for (size_t row = row_count; row-- > 1;) {
+    if (row_starts_[row] >= 0.0) {
+      break;
+    }
+    bool locked = false;
+    start = snap(start - samples_per_line_, locked);
+    if (start < 0.0) {
+      break;
+    }
+    row_starts_[row] = start;
+    row_locked_[row] = locked;
+  }
+}
+
+void VideoPreview::DrawRow(size_t row, double line_start) {
+  const double rate = static_cast<double>(options_.sample_rate_hz);
+  const double first = line_start + (preset_.active_start_seconds * rate);
+  const double per_column =
+      preset_.active_seconds * rate / static_cast<double>(options_.width);
+  const size_t count = frequency_hz_.size();
+
+  const double black = preset_.blanking_hz;
+  const double scale = 255.0 / (preset_.white_hz - preset_.blanking_hz);
+
+  uint8_t* const pixels = field_.pixels.data() + (row * options_.width);
+  for (size_t column = 0; column < options_.width; ++column) {
+    const auto from = static_cast<size_t>(
+        first + (per_column * static_cast<double>(column)));
+    const size_t to = std::min(
+        count, static_cast<size_t>(
+                   first + (per_column * static_cast<double>(column + 1))));
+    if (from >= to) {
+      break;
+    }
+
+    double sum = 0.0;
+    for (size_t index = from; index < to; ++index) {
+      sum += frequency_hz_[index];
+    }
+    const double level =
+        ((sum / static_cast<double>(to - from)) - black) * scale;
+    pixels[column] = static_cast<uint8_t>(std::lround(std::clamp(level, 0.0,
+                                                                 255.0)));
+  }
+}
+
+WorkPacer::WorkPacer(double budget_fraction)
+    : budget_fraction_(std::clamp(budget_fraction, 0.001, 1.0)) {}
+
+bool WorkPacer::Due(double now_seconds) const {
+  return now_seconds >= next_due_seconds_;
+}
+
+void WorkPacer::Record(double started_seconds, double finished_seconds) {
+  last_cost_seconds_ = std::max(0.0, finished_seconds - started_seconds);
+
+  // A run of cost c at a budget b earns a rest of c(1 - b)/b, which makes the
+  // run and its rest together c/b: exactly the budget's share of the time
+  next_due_seconds_ = finished_seconds + (last_cost_seconds_ *
+                                          (1.0 - budget_fraction_) /
+                                          budget_fraction_);
+}
+
+void WorkPacer::Reset() {
+  next_due_seconds_ = 0.0;
+  last_cost_seconds_ = 0.0;
+}
+
+}  // namespace ddd::analysis
@@ -0,0 +1,202 @@
+/************************************************************************
+
+    video_preview.h
+
+    A field of the disc's picture, from one contiguous run of RF
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fm_demodulator.h"
+
+namespace ddd::analysis {
+
+// The most direct answer there is to "is this capture any good": the picture.
+//
+// Not a decoder. ld-decode's output is the product, and nothing here tries to
+// compete with it — no time-base correction beyond locking each line to its own
+// sync, no dropout concealment, no colour. What it does is put a recognisable
+// grey field on the screen while a capture runs, which is enough to see that
+// the player is on the right side, that tracking has not gone, and that the
+// level is sensible, without stopping to decode a file.
+//
+// One field is 20 ms of PAL or 16.7 ms of NTSC, and the monitor tap's ordinary
+// snapshot is 0.8 ms, so this is fed from a tap of its own that copies a whole
+// buffer, rarely. The field is assembled from that run alone: lines after the
+// first vertical sync in it fill the raster from the top, and lines before it —
+// the bottom of the previous field — fill it from the bottom up, so any run a
+// field long makes a whole picture wherever its vertical interval happens to
+// fall.
+
+enum class VideoStandard {
+  kPal,
+  kNtsc,
+};
+
+// Where a standard's levels sit on the carrier, and how its lines are timed.
+//
+// The carrier figures are the LaserDisc ones from IEC 60856 and 60857, not the
+// broadcast ones: the disc's modulator maps sync tip, blanking and peak white
+// to fixed frequencies, and those are what the demodulated signal is measured
+// against.
+struct VideoStandardPreset {
+  const char* name = "";
+
+  double sync_tip_hz = 0.0;
+  double blanking_hz = 0.0;
+  double white_hz = 0.0;
+
+  double line_seconds = 0.0;
+
+  // Per field. Whole lines are what is drawn; the half line is there for the
+  // field's length, which is what the raster is sized to.
+  double lines_per_field = 0.0;
+
+  // The line sync's width, and where the picture starts and how long it runs,
+  // both measured from the sync's leading edge.
+  double sync_seconds = 0.0;
+  double active_start_seconds = 0.0;
+  double active_seconds = 0.0;
+
+  // The band the demodulator passes, from below the audio carriers' reach to
+  // above white's first sideband.
+  double band_low_hz = 0.0;
+  double band_high_hz = 0.0;
+};
+
+const VideoStandardPreset& PresetFor(VideoStandard standard);
+
+// One rendered field, top line first, one byte of grey per pixel.
+struct VideoField {
+  VideoStandard standard = VideoStandard::kPal;
+  size_t width = 0;
+  size_t rows = 0;
+  std::vector<uint8_t> pixels;
+
+  // Rows whose line sync was found where it was expected, out of rows. The
+  // rest were placed by the line period alone, which is right in the vertical
+  // interval — it has no line syncs — and wrong anywhere else. A field with
+  // few of them locked is a carrier with no picture on it.
+  size_t locked_rows = 0;
+
+  bool empty() const { return pixels.empty(); }
+};
+
+class VideoPreview {
+ public:
+  // 256 columns is a little under five per microsecond of active line: enough
+  // to read a caption, and few enough that a column is an average of eight
+  // samples at full rate, which is what takes the demodulator's ripple out.
+  static constexpr size_t kDefaultWidth = 256;
+
+  struct Options {
+    VideoStandard standard = VideoStandard::kPal;
+    uint32_t sample_rate_hz = 40'000'000;
+    size_t width = kDefaultWidth;
+  };
+
+  explicit VideoPreview(const Options& options);
+
+  // Whether the stream's rate can carry this standard at all. Peak white must
+  // sit below Nyquist, or the top of the deviation folds back down onto the
+  // bottom and the picture is nonsense; a quarter-rate capture has filtered
+  // the carrier out entirely.
+  static bool RateCarries(VideoStandard standard, uint32_t sample_rate_hz);
+  bool rate_carries() const {
+    return RateCarries(options_.standard, options_.sample_rate_hz);
+  }
+
+  // Demodulate a run of converter codes and render the field in it. Returns
+  // false and leaves field() as it was when the run holds no vertical sync or
+  // the rate cannot carry the standard — a buffer too short, a player
+  // stopped, or a carrier with no picture on it.
+  bool Render(const uint16_t* codes, size_t count);
+
+  const VideoField& field() const { return field_; }
+  const Options& options() const { return options_; }
+
+  // The rows a field is drawn in: the whole lines of one field.
+  size_t rows() const;
+
+ private:
+  struct Pulse {
+    size_t start = 0;
+    size_t width = 0;
+  };
+
+  void FindSyncPulses();
+
+  // Where each row's line starts: a line at a time down from the first
+  // vertical sync and then up from it, snapping to each line sync found near
+  // where it should be. Rows the run does not reach are left at -1.
+  void PlaceRows();
+
+  void DrawRow(size_t row, double line_start);
+
+  Options options_;
+  VideoStandardPreset preset_;
+  FmDemodulator demodulator_;
+
+  double samples_per_line_ = 0.0;
+  size_t sync_samples_ = 0;
+
+  // Scratch, reused from field to field
+  std::vector<float> frequency_hz_;
+  std::vector<float> smoothed_hz_;
+  std::vector<Pulse> line_syncs_;
+  std::vector<size_t> vertical_syncs_;
+  std::vector<double> row_starts_;
+  std::vector<bool> row_locked_;
+
+  VideoField field_;
+};
+
+// Keeps a piece of work to a share of one core by spacing it out.
+//
+// The analysis thread is shared with the waveform and the spectrum, and a
+// field takes tens of milliseconds on a fast machine and a good deal more on a
+// slow one. Run whenever a tap arrived, a slow machine would spend its whole
+// analysis thread rendering pictures and the other panels would stall behind
+// them. Instead each run is followed by a rest long enough to bring its cost
+// down to the budget, so a slow machine gets fewer fields a second and the
+// same smooth waveform, and a fast one gets every field the tap offers.
+//
+// Times are the caller's, in seconds on any steady clock, because this
+// library keeps no clock of its own.
+class WorkPacer {
+ public:
+  // A tenth of a core: the preview is the least important thing on the
+  // thread.
+  static constexpr double kDefaultBudgetFraction = 0.1;
+
+  explicit WorkPacer(double budget_fraction = kDefaultBudgetFraction);
+
+  // Whether enough time has passed since the last run.
+  bool Due(double now_seconds) const;
+
+  // A run that started and finished at these times. The next is due once the
+  // rest it earns has passed.
+  void Record(double started_seconds, double finished_seconds);
+
+  void Reset();
+
+  double budget_fraction() const { return budget_fraction_; }
+
+  // The most recent run's cost, and zero before the first.
+  double last_cost_seconds() const { return last_cost_seconds_; }
+
+ private:
+  double budget_fraction_;
+  double next_due_seconds_ = 0.0;
+  double last_cost_seconds_ = 0.0;
+};
+
+}  // namespace ddd::analysis
@@ -12,6 +12,7 @@
 #include "waveform_mapping.h"
 
 #include <algorithm>
+#include <array>
 
 namespace ddd::analysis {
 
@@ -105,20 +106,177 @@ double WaveformMapping::SampleToSeconds(size_t sample_index,
          static_cast<double>(sample_rate_hz);
 }
 
-void DecimateToColumns(const uint16_t* codes, size_t code_count,
-                       const WaveformMapping& mapping,
-                       std::vector<WaveformColumn>& columns) {
-  columns.assign(
-      mapping.Valid() ? static_cast<size_t>(mapping.width_pixels) : size_t{0},
-      WaveformColumn{});
+namespace {
 
-  if (codes == nullptr || code_count == 0 || columns.empty()) {
-    return;
+// How close to a column edge, in pixels, a sample has to be before the integer
+// stepping below stops trusting itself and asks SampleToX. A millionth of a
+// pixel is far wider than SampleToX's own rounding and far narrower than
+// anything a real trigger offset produces more than once in a long while.
+constexpr double kEdgeMarginPixels = 1e-6;
+
+// Below this many samples a column — where the panel stops drawing an
+// envelope — most runs are a single sample, and placing each sample on its own
+// is cheaper than stepping across every column to find them.
+constexpr double kRunSamplesPerPixel = 2.0;
+
+// The extremes of a run of codes that all land in one column.
+//
+// Reduced sixteen lanes abreast, each lane keeping its own extremes, and the
+// lanes folded together at the end. The loop over the lanes has a fixed count
+// and nothing else in it — no test of whether the column is populated yet, no
+// position to compute — which is the form a compiler turns into packed
+// minimum and maximum instructions even at the cost model -O2 uses, where a
+// loop of unknown length is left a sample at a time.
+constexpr size_t kReductionLanes = 16;
+
+void ExtremesOfRun(const uint16_t* codes, size_t count, uint16_t& minimum,
+                   uint16_t& maximum) {
+  uint16_t low = UINT16_MAX;
+  uint16_t high = 0;
+  size_t index = 0;
+
+  // Only for a run long enough to fill the lanes: a shorter one would spend
+  // more setting them up and folding them than it saved.
+  if (count >= kReductionLanes) {
+    std::array<uint16_t, kReductionLanes> lowest;
+    std::array<uint16_t, kReductionLanes> highest;
+    lowest.fill(UINT16_MAX);
+    highest.fill(0);
+
+    for (; index + kReductionLanes <= count; index += kReductionLanes) {
+      for (size_t lane = 0; lane < kReductionLanes; ++lane) {
+        // By value and without std::min, whose references read to the
+        // compiler as possible aliases of the lanes
+        const uint16_t code = codes[index + lane];
+        lowest[lane] = code < lowest[lane] ? code : lowest[lane];
+        highest[lane] = code > highest[lane] ? code : highest[lane];
+      }
+    }
+
+    for (size_t lane = 0; lane < kReductionLanes; ++lane) {
+      low = std::min(low, lowest[lane]);
+      high = std::max(high, highest[lane]);
+    }
   }
 
-  const size_t last =
-      std::min(mapping.first_sample + mapping.sample_span, code_count);
+  for (; index < count; ++index) {
+    low = std::min(low, codes[index]);
+    high = std::max(high, codes[index]);
+  }
+
+  minimum = low;
+  maximum = high;
+}
+
+// Where each column's run of samples starts, a column at a time from the left.
+//
+// Column c starts at the first sample SampleToX puts at or right of c, which
+// is first_sample + ceil(c * span / width + sub_sample_offset). The whole part
+// of c * span / width is carried as a quotient and a remainder that each
+// column's step adds to, so crossing the plot takes no division at all, and
+// the offset joins the remainder scaled by the width.
+//
+// That is the exact answer, where SampleToX is a rounded one. The two can only
+// disagree about a sample within a hair of an edge, and there the edge is
+// settled by asking SampleToX itself — so every sample lands in the column
+// mapping it through SampleToX would put it in, which is the column the cursor
+// readout says it is in. With no offset the rounded answer is exact too, and
+// nothing is ever asked.
+class ColumnEdges {
+ public:
+  ColumnEdges(const WaveformMapping& mapping, size_t last)
+      : mapping_(mapping),
+        last_(last),
+        width_(static_cast<size_t>(mapping.width_pixels)),
+        whole_step_(mapping.sample_span / width_),
+        part_step_(mapping.sample_span % width_),
+        scaled_offset_(mapping.sub_sample_offset *
+                       static_cast<double>(width_)),
+        margin_(mapping.sub_sample_offset == 0.0
+                    ? 0.0
+                    : kEdgeMarginPixels *
+                          static_cast<double>(mapping.sample_span)),
+        offset_in_range_(mapping.sub_sample_offset >= 0.0 &&
+                         mapping.sub_sample_offset < 1.0),
+        previous_(mapping.first_sample) {}
+
+  // The first sample of the next column's run, or `last` if the data ends
+  // before it. The first call is column 0's.
+  size_t Next() {
+    const size_t column = column_;
+    const size_t estimate = Estimate();
+    const size_t from = previous_;
+
+    ++column_;
+    quotient_ += whole_step_;
+    remainder_ += part_step_;
+    if (remainder_ >= width_) {
+      remainder_ -= width_;
+      ++quotient_;
+    }
+
+    previous_ = settle_ ? Settle(column, estimate, from)
+                        : std::clamp(estimate, from, last_);
+    return previous_;
+  }
+
+ private:
+  // The exact start of the current column, and whether a sample sits close
+  // enough to its edge to need settling
+  size_t Estimate() {
+    const double width = static_cast<double>(width_);
+    const double scaled = static_cast<double>(remainder_) + scaled_offset_;
+
+    size_t whole = 0;
+    if (scaled > 0.0) {
+      whole = scaled > width ? 2 : 1;
+    }
+
+    // The distance from the edge to the sample past it, and from the sample
+    // before it, in samples times the width — span times the pixels the
+    // margin is in
+    const double past = (static_cast<double>(whole) * width) - scaled;
+    settle_ = !offset_in_range_ || past < margin_ || width - past < margin_;
+
+    return mapping_.first_sample + quotient_ + whole;
+  }
+
+  size_t Settle(size_t column, size_t estimate, size_t from) const {
+    const double edge = static_cast<double>(column);
+    size_t index = std::clamp(estimate, from, last_);
+    while (index > from &&
+           mapping_.SampleToX(static_cast<double>(index - 1)) >= edge) {
+      --index;
+    }
+    while (index < last_ &&
+           mapping_.SampleToX(static_cast<double>(index)) < edge) {
+      ++index;
+    }
+    return index;
+  }
+
+  const WaveformMapping& mapping_;
+  const size_t last_;
+  const size_t width_;
+  const size_t whole_step_;
+  const size_t part_step_;
+  const double scaled_offset_;
+  const double margin_;
+  const bool offset_in_range_;
 
+  size_t column_ = 0;
+  size_t quotient_ = 0;
+  size_t remainder_ = 0;
+  size_t previous_;
+  bool settle_ = false;
+};
+
+// A sample at a time, each through SampleToX. What the decimation always was,
+// and still the cheaper form where a column holds a sample or two: there is
+// nothing in a run that short to reduce.
+void DecimateEachSample(const uint16_t* codes, size_t last,
+                        const WaveformMapping& mapping,
+                        std::vector<WaveformColumn>& columns) {
   for (size_t index = mapping.first_sample; index < last; ++index) {
     // Computed from the sample rather than the sample from the column, so a
     // span shorter than the plot is wide leaves the columns between samples
@@ -147,4 +305,47 @@ void DecimateToColumns(const uint16_t* codes, size_t code_count,
   }
 }
 
+}  // namespace
+
+void DecimateToColumns(const uint16_t* codes, size_t code_count,
+                       const WaveformMapping& mapping,
+                       std::vector<WaveformColumn>& columns) {
+  columns.assign(
+      mapping.Valid() ? static_cast<size_t>(mapping.width_pixels) : size_t{0},
+      WaveformColumn{});
+
+  if (codes == nullptr || code_count == 0 || columns.empty()) {
+    return;
+  }
+
+  const size_t last =
+      std::min(mapping.first_sample + mapping.sample_span, code_count);
+  if (mapping.first_sample >= last) {
+    return;
+  }
+
+  if (mapping.SamplesPerPixel() < kRunSamplesPerPixel) {
+    DecimateEachSample(codes, last, mapping, columns);
+    return;
+  }
+
+  // A run at a time. Positions only ever grow with the sample index, so the
+  // samples a column holds are one unbroken run: step to where the next
+  // column's run starts and reduce what is in between. At 20,000 samples
+  // across a panel that replaces a division and a branch a sample with a
+  // few additions a column and a vector reduction, which was most of a
+  // frame's decimation on a slow machine.
+  ColumnEdges edges(mapping, last);
+  size_t begin = edges.Next();
+  for (size_t column = 0; column < columns.size() && begin < last; ++column) {
+    const size_t end = edges.Next();
+    if (end > begin) {
+      WaveformColumn& target = columns[column];
+      target.populated = true;
+      ExtremesOfRun(codes + begin, end - begin, target.minimum, target.maximum);
+    }
+    begin = end;
+  }
+}
+
 }  // namespace ddd::analysis
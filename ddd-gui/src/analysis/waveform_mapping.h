@@ -145,6 +145,9 @@ struct WaveformColumn {
 // span narrower than the plot is wide there genuinely is nothing to draw
 // between the samples, and inventing it would draw a signal that was never
 // measured.
+//
+// Every sample lands in the column SampleToX puts it in, however the columns
+// are actually found — see waveform_mapping.cpp.
 void DecimateToColumns(const uint16_t* codes, size_t code_count,
                        const WaveformMapping& mapping,
                        std::vector<WaveformColumn>& columns);
@@ -0,0 +1,57 @@
+/************************************************************************
+
+    address_index.cpp
+
+    Where in a capture each of the player's addresses was
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "address_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace ddd::capture {
+
+bool AddressIndex::Add(int32_t address, uint64_t sent_sample,
+                       uint64_t answered_sample) {
+  if (answered_sample < sent_sample || readings_.size() >= kMaximumReadings) {
+    return false;
+  }
+
+  const uint64_t half_bracket = (answered_sample - sent_sample) / 2;
+  const AddressReading reading{sent_sample + half_bracket, address};
+
+  if (!readings_.empty() && (reading.address <= readings_.back().address ||
+                             reading.sample <= readings_.back().sample)) {
+    return false;
+  }
+
+  readings_.push_back(reading);
+  uncertainty_samples_ = std::max(uncertainty_samples_, half_bracket);
+  return true;
+}
+
+std::optional<uint64_t> AddressIndex::Locate(int32_t address) const {
+  // The first reading past the address, and so the one before it is the last
+  // at or before
+  const auto after = std::upper_bound(
+      readings_.begin(), readings_.end(), address,
+      [](int32_t wanted, const AddressReading& reading) {
+        return wanted < reading.address;
+      });
+  if (after == readings_.begin()) {
+    return std::nullopt;
+  }
+  return std::prev(after)->sample;
+}
+
+void AddressIndex::Clear() {
+  readings_.clear();
+  uncertainty_samples_ = 0;
+}
+
+}  // namespace ddd::capture
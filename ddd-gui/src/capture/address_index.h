@@ -0,0 +1,95 @@
+/************************************************************************
+
+    address_index.h
+
+    Where in a capture each of the player's addresses was
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ddd::capture {
+
+// One reading: the player said it was at `address` when the file had reached
+// `sample`.
+//
+// The address is the player's own figure, undecoded — a frame number, or for a
+// CLV disc a time code written as hmmssff. Decoding it is the player library's
+// business and this one does not link it; a reader of the sidecar is told which
+// of the two it is alongside the list.
+struct AddressReading {
+  uint64_t sample = 0;
+  int32_t address = 0;
+
+  bool operator==(const AddressReading&) const = default;
+};
+
+// The disc's addresses against the capture's sample positions, built from the
+// readings an automatic capture takes anyway.
+//
+// The watch asks the player where it is twice a second for the whole of a side,
+// to know when to stop, and until this was kept every one of those answers was
+// thrown away. Every tool downstream then had to find frame N by decoding its
+// way through the RF file from the start, which for a side of a CAV disc is an
+// hour of samples searched for one number. Kept, frame N is a lookup here and a
+// seek in CaptureReader, followed by at most half a second of decoding.
+//
+// **A reading is bracketed, not timed.** The question goes out on a serial link
+// and the answer comes back some tens of milliseconds later — the better part
+// of a second at 1200 baud — and the player took its reading somewhere in
+// between. So each reading is given the file's position halfway between the
+// two, and the worst half-bracket seen is kept beside the list as the figure it
+// is good to. That is honest about the link without pretending to know the
+// player's latency, which nothing here can measure.
+//
+// **The list only goes forwards.** A reading that is not past the last one in
+// both address and position is left out: a player that stumbled and re-read a
+// frame, or a reply that arrived late, would otherwise put a step backwards
+// into a table whose whole use is being searched in order. A whole-side capture
+// never goes backwards, so nothing of value is lost.
+//
+// Thread-safety: none. Built on the interface thread, which is the thread that
+// hears the player's answers, and read there when the file is finished.
+class AddressIndex {
+ public:
+  // The list stops growing here. At two readings a second that is nine hours
+  // of side, which is several times the longest disc there is.
+  static constexpr size_t kMaximumReadings = 65'536;
+
+  // Record a reading of `address`, taken by a query sent when the file stood at
+  // `sent_sample` and answered when it stood at `answered_sample`. Returns
+  // whether it was kept.
+  bool Add(int32_t address, uint64_t sent_sample, uint64_t answered_sample);
+
+  // Where to start looking for `address`: the position of the last reading at
+  // or before it. Absent for an address before the first reading, which this
+  // file may not hold at all.
+  //
+  // A place to seek to rather than the address's own position. The frame
+  // itself is at most one reading interval further on, plus the uncertainty —
+  // and a lookup that tried to be exact by interpolating would be exact only
+  // for frame numbers, since a time code does not count evenly.
+  std::optional<uint64_t> Locate(int32_t address) const;
+
+  const std::vector<AddressReading>& readings() const { return readings_; }
+  bool empty() const { return readings_.empty(); }
+
+  // The largest half-bracket of any reading kept, in samples.
+  uint64_t uncertainty_samples() const { return uncertainty_samples_; }
+
+  void Clear();
+
+ private:
+  std::vector<AddressReading> readings_;
+  uint64_t uncertainty_samples_ = 0;
+};
+
+}  // namespace ddd::capture
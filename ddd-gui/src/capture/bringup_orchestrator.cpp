@@ -34,6 +34,26 @@ constexpr double kConfigureBytesPerSecond = 500000.0;
 // or a board that is genuinely wrong.
 constexpr int kConfigureAttempts = 2;
 
+// The player's own words, which name both values on a mismatch, and after
+// them where in the file to look. The sentence is not wrapped or rephrased:
+// it was written for a user, and the place it stopped is the one thing it
+// cannot know about itself.
+std::string WithPlaceInFile(std::string problem, size_t line,
+                            const std::string& keyword) {
+  if (line == 0) {
+    return problem;
+  }
+  // Written as a label rather than as prose, because no article reads right
+  // in front of every SVF keyword there is — "an SDR" and "a STATE" — and
+  // because this half is what gets copied into a report.
+  problem += " (Programming file line " + std::to_string(line);
+  if (!keyword.empty()) {
+    problem += ", " + keyword;
+  }
+  problem += ".)";
+  return problem;
+}
+
 }  // namespace
 
 int EstimateConfigureSeconds(uint64_t svf_bytes) {
@@ -55,9 +75,8 @@ BringUpConfigureOutcome BringUpOrchestrator::ConfigureFailure(
   return outcome;
 }
 
-BringUpConfigureOutcome BringUpOrchestrator::PlayVectors(std::string_view text,
-                                                         int attempt,
-                                                         bool& cable_opened) {
+BringUpConfigureOutcome BringUpOrchestrator::PlayVectors(
+    const SvfProgram& program, int attempt, bool& cable_opened) {
   BringUpConfigureOutcome outcome;
   cable_opened = false;
 
@@ -110,27 +129,16 @@ BringUpConfigureOutcome BringUpOrchestrator::PlayVectors(std::string_view text,
     player.SetStopCallback(cancel_);
   }
 
-  outcome.play = player.Play(text);
+  outcome.play = player.Play(program);
   outcome.succeeded = outcome.play.succeeded;
   outcome.stopped = outcome.play.stopped;
 
   if (!outcome.succeeded) {
-    // The player's own words, which name both values on a mismatch, and after
-    // them where in the file to look. The sentence is not wrapped or
-    // rephrased: it was written for a user, and the place it stopped is the
-    // one thing it cannot know about itself.
-    outcome.problem = outcome.play.problem;
-    if (outcome.play.line > 0 && !outcome.stopped) {
-      // Written as a label rather than as prose, because no article reads
-      // right in front of every SVF keyword there is — "an SDR" and "a
-      // STATE" — and because this half is what gets copied into a report.
-      outcome.problem +=
-          " (Programming file line " + std::to_string(outcome.play.line);
-      if (!outcome.play.statement_keyword.empty()) {
-        outcome.problem += ", " + outcome.play.statement_keyword;
-      }
-      outcome.problem += ".)";
-    }
+    outcome.problem =
+        outcome.stopped
+            ? outcome.play.problem
+            : WithPlaceInFile(outcome.play.problem, outcome.play.line,
+                              outcome.play.statement_keyword);
   }
 
   return outcome;
@@ -180,11 +188,21 @@ BringUpConfigureOutcome BringUpOrchestrator::ConfigureFpga(
 
   const auto configure_started = std::chrono::steady_clock::now();
 
+  // Read once, before the cable is opened, and held for every attempt: a
+  // retry replays what is already decided rather than reading 1.4 MB of text
+  // again, and a file that cannot be read is refused before anything at all
+  // is sent to the board.
+  const SvfCompileResult compiled = CompileSvf(text);
+  if (!compiled.succeeded) {
+    return ConfigureFailure(WithPlaceInFile(
+        compiled.problem, compiled.line, compiled.statement_keyword));
+  }
+
   BringUpConfigureOutcome outcome;
   for (int attempt = 1; attempt <= kConfigureAttempts; ++attempt) {
     bool cable_opened = false;
     const auto attempt_started = std::chrono::steady_clock::now();
-    outcome = PlayVectors(text, attempt, cable_opened);
+    outcome = PlayVectors(compiled.program, attempt, cable_opened);
     outcome.attempts = attempt;
 
     if (logger_ != nullptr) {
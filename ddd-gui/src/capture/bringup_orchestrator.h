@@ -175,8 +175,8 @@ class BringUpOrchestrator {
   // One attempt at the vectors: open the cable, play the file, close it
   // again. ConfigureFpga decides how many of these there are, and needs to
   // know whether the cable opened at all to decide whether a second is worth
-  // anything.
-  BringUpConfigureOutcome PlayVectors(std::string_view text, int attempt,
+  // anything. The file arrives already compiled, once for every attempt.
+  BringUpConfigureOutcome PlayVectors(const SvfProgram& program, int attempt,
                                       bool& cable_opened);
 
   BringUpAccess access_;
@@ -13,13 +13,16 @@
 
 #include <algorithm>
 #include <cctype>
+#include <initializer_list>
 
 #include "sample_format.h"
 
 namespace ddd::capture {
 
 bool IsSupportedDecimationFactor(int factor) {
-  return factor == kUndecimatedFactor || factor == kTapeDecimationFactor;
+  return factor == kUndecimatedFactor || factor == kTapeDecimationFactor ||
+         factor == kQuarterRateDecimationFactor ||
+         factor == kEighthRateDecimationFactor;
 }
 
 uint32_t FlacSampleRateLabelFor(int decimation_factor) {
@@ -41,6 +44,17 @@ uint32_t SampleRateHzFor(int decimation_factor) {
   return kSampleRateHz / static_cast<uint32_t>(decimation_factor);
 }
 
+uint32_t SampleRateHzForFlacLabel(uint32_t label) {
+  for (const int factor :
+       {kUndecimatedFactor, kTapeDecimationFactor, kQuarterRateDecimationFactor,
+        kEighthRateDecimationFactor}) {
+    if (FlacSampleRateLabelFor(factor) == label) {
+      return SampleRateHzFor(factor);
+    }
+  }
+  return 0;
+}
+
 const char* CaptureFileSuffix(CaptureOutputFormat format) {
   switch (format) {
     case CaptureOutputFormat::kFlac:
@@ -64,14 +64,18 @@ inline constexpr uint32_t kFlacSampleRateLabel = 40'000;
 // the samples reach the USB link. One is every sample, which is what a
 // LaserDisc capture needs. Two halves both the rate and the file — enough for
 // tape RF, whose bandwidth is a fraction of a LaserDisc's, and the reason this
-// exists at all.
+// exists at all. Four and eight are for narrower signals still, such as a
+// tape's hi-fi audio carriers on their own.
 //
-// Not plain selection: the gateware low-passes at 10 MHz with a 63-tap
-// half-band filter first, because dropping alternate samples without that folds
-// everything above 10 MHz down on top of the signal. See
-// fpga/application/halfBandDecimator.v.
+// Not plain selection: the gateware low-passes at a quarter of the input rate
+// with a 63-tap half-band filter first, because dropping alternate samples
+// without that folds everything above the new Nyquist down on top of the
+// signal. Four and eight are that filter behind one or two shorter 2:1 stages.
+// See fpga/application/decimationChain.v.
 inline constexpr int kUndecimatedFactor = 1;
 inline constexpr int kTapeDecimationFactor = 2;
+inline constexpr int kQuarterRateDecimationFactor = 4;
+inline constexpr int kEighthRateDecimationFactor = 8;
 
 // Whether a factor is one this application will write.
 bool IsSupportedDecimationFactor(int factor);
@@ -90,6 +94,11 @@ uint32_t FlacSampleRateLabelFor(int decimation_factor);
 // and calls a 1 ms sweep 500 µs.
 uint32_t SampleRateHzFor(int decimation_factor);
 
+// The other way: the rate a FLAC file's samples arrived at, from the label in
+// its header. Zero for a label this application never writes, which says
+// nothing about the rate a file from elsewhere was taken at.
+uint32_t SampleRateHzForFlacLabel(uint32_t label);
+
 // Channels and bit depth in the written file. Mono is definitional: a stereo
 // file is not a Domesday Duplicator capture, and the reader says so rather than
 // silently reading one channel.
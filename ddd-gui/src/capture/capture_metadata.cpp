@@ -157,6 +157,39 @@ void WritePlayer(YamlWriter& yaml, const PlayerIdentity& player) {
   yaml.EndMapping();
 }
 
+void WriteThreadUsage(YamlWriter& yaml, const char* key,
+                      const ThreadUsage& usage) {
+  if (!usage.present) {
+    return;
+  }
+
+  yaml.BeginMapping(key);
+  yaml.Unsigned("threads", usage.threads);
+  yaml.Number("user_seconds", usage.user_seconds, 3);
+  yaml.Number("system_seconds", usage.system_seconds, 3);
+  yaml.Unsigned("voluntary_switches", usage.voluntary_switches);
+  yaml.Unsigned("involuntary_switches", usage.involuntary_switches);
+  if (usage.migrations_known) {
+    yaml.Unsigned("migrations", usage.migrations);
+  }
+  yaml.Unsigned("minor_faults", usage.minor_faults);
+  yaml.Unsigned("major_faults", usage.major_faults);
+  yaml.EndMapping();
+}
+
+// "12, 544, 1007": a list on one line, since YamlWriter writes no sequences and
+// a mapping keyed by the codes themselves would have nothing to map them to.
+std::string JoinCodes(const std::vector<uint16_t>& codes) {
+  std::string joined;
+  for (const uint16_t code : codes) {
+    if (!joined.empty()) {
+      joined += ", ";
+    }
+    joined += std::to_string(code);
+  }
+  return joined;
+}
+
 void WriteDisc(YamlWriter& yaml, const DiscScan& disc) {
   yaml.BeginMapping("disc");
 
@@ -273,6 +306,110 @@ std::string BuildCaptureMetadataYaml(const CaptureMetadata& metadata) {
     yaml.BlankLine();
   }
 
+  if (metadata.codes.known) {
+    const LinearityProfile& linearity = metadata.codes.linearity;
+    yaml.Comment("How often each code turned up in this file. DNL is a code's");
+    yaml.Comment("count against the median of its neighbours, in LSB, for the");
+    yaml.Comment("codes with enough signal around them to judge.");
+    yaml.BeginMapping("codes");
+    yaml.Unsigned("samples", linearity.sample_count);
+    yaml.Unsigned("lowest_code", linearity.lowest_code);
+    yaml.Unsigned("highest_code", linearity.highest_code);
+    yaml.Unsigned("codes_assessed", linearity.codes_assessed);
+    if (linearity.known) {
+      yaml.Number("worst_dnl", linearity.worst_dnl, 3);
+      yaml.Unsigned("worst_dnl_code", linearity.worst_dnl_code);
+      yaml.Number("rms_dnl", linearity.rms_dnl, 4);
+      yaml.Unsigned("missing_codes", linearity.missing_codes.size());
+      if (!linearity.missing_codes.empty()) {
+        yaml.String("missing", JoinCodes(linearity.missing_codes));
+      }
+    }
+
+    // Keyed by code, and only the codes that turned up: a disc's signal uses
+    // a few hundred of the thousand, and a run of zeros is no information.
+    yaml.BeginMapping("histogram");
+    for (size_t code = 0; code < kSampleCodeCount; ++code) {
+      if (metadata.codes.counts[code] != 0) {
+        yaml.Unsigned(std::to_string(code), metadata.codes.counts[code]);
+      }
+    }
+    yaml.EndMapping();
+    yaml.EndMapping();
+    yaml.BlankLine();
+  }
+
+  if (metadata.dropouts.known) {
+    yaml.Comment("Where the RF envelope collapsed, found while capturing.");
+    yaml.Comment("Each event is the sample it starts at, counted from this");
+    yaml.Comment("file's first, and its length in samples.");
+    yaml.BeginMapping("dropouts");
+    yaml.Unsigned("count", metadata.dropouts.count);
+    yaml.Unsigned("total_samples", metadata.dropouts.total_samples);
+    if (metadata.dropouts.events.size() < metadata.dropouts.count) {
+      yaml.Unsigned("listed", metadata.dropouts.events.size());
+    }
+
+    // A mapping keyed by position rather than a sequence of pairs, which keeps
+    // the document inside what YamlWriter can express and costs a reader
+    // nothing: the starts are unique and ascending, so the keys are too.
+    yaml.BeginMapping("events");
+    for (const DropoutEvent& event : metadata.dropouts.events) {
+      yaml.Unsigned(std::to_string(event.start_sample),
+                    event.duration_samples);
+    }
+    yaml.EndMapping();
+    yaml.EndMapping();
+    yaml.BlankLine();
+  }
+
+  if (metadata.addresses.present()) {
+    yaml.Comment("Where the player said it was, keyed by this file's sample");
+    yaml.Comment("at the time. Each reading is good to uncertainty_samples");
+    yaml.Comment("either way; seek to the last one at or before the address");
+    yaml.Comment("wanted.");
+    yaml.BeginMapping("addresses");
+    yaml.String("addressing", metadata.addresses.addressing);
+    yaml.Unsigned("uncertainty_samples",
+                  metadata.addresses.uncertainty_samples);
+
+    // Keyed by position for the reason the dropout list is
+    yaml.BeginMapping("readings");
+    for (const AddressReading& reading : metadata.addresses.readings) {
+      yaml.Integer(std::to_string(reading.sample), reading.address);
+    }
+    yaml.EndMapping();
+    yaml.EndMapping();
+    yaml.BlankLine();
+  }
+
+  if (metadata.encoder_effort.adjustable) {
+    const EncoderEffortSummary& effort = metadata.encoder_effort;
+    yaml.Comment("How hard the encoder worked. Below the configured level the");
+    yaml.Comment("file is larger, never different in its samples. The advised");
+    yaml.Comment("level is for the next file; this one kept its level.");
+    yaml.BeginMapping("encoder_effort");
+    yaml.Integer("configured_level", effort.configured_level);
+    yaml.Integer("level", effort.file_level);
+    yaml.Integer("advised_level", effort.advised_level);
+    yaml.Unsigned("advised_lower", effort.advised_lower);
+    yaml.Unsigned("advised_higher", effort.advised_higher);
+    yaml.EndMapping();
+    yaml.BlankLine();
+  }
+
+  if (metadata.threads.present()) {
+    yaml.Comment("How this machine's scheduler served the capture threads");
+    yaml.Comment("while the file was open. About the host, not about the");
+    yaml.Comment("recording.");
+    yaml.BeginMapping("threads");
+    WriteThreadUsage(yaml, "transfer", metadata.threads.transfer);
+    WriteThreadUsage(yaml, "processing", metadata.threads.processing);
+    WriteThreadUsage(yaml, "encoder", metadata.threads.encoder);
+    yaml.EndMapping();
+    yaml.BlankLine();
+  }
+
   WriteNaming(yaml, metadata.naming);
   yaml.BlankLine();
 
@@ -15,8 +15,14 @@
 #include <ctime>
 #include <filesystem>
 #include <string>
+#include <vector>
 
+#include "address_index.h"
 #include "capture_naming.h"
+#include "code_linearity.h"
+#include "dropout_detector.h"
+#include "encoder_effort.h"
+#include "thread_usage.h"
 
 namespace ddd::capture {
 
@@ -148,9 +154,9 @@ struct PlayerIdentity {
 struct ScannedFact {
   std::string value;
 
-  // "reported", "measured", "inferred" or "declared" — the wording the player
-  // library uses, passed through. Empty for a fact nothing established, which
-  // is the same thing as an empty value.
+  // "reported", "measured", "inferred", "declared" or "cached" — the wording
+  // the player library uses, passed through. Empty for a fact nothing
+  // established, which is the same thing as an empty value.
   std::string source;
 
   bool known() const { return !value.empty(); }
@@ -296,6 +302,65 @@ struct SignalSummary {
   uint64_t clipped_high_samples = 0;
 };
 
+// How often each converter code turned up in this file, and what that says
+// about the converter.
+//
+// Measured over the file's own samples on the same terms as SignalSummary. The
+// histogram is what a gain setting is tuned from — where the signal sits in the
+// range and how much of it is left unused — and the profile is what a missing
+// code or a stuck bit looks like, found at capture time rather than by a
+// separate pass over the file afterwards. See AnalyseLinearity for what it can
+// and cannot see.
+//
+// Absent for a test-mode capture, whose ramp is a check of the data path and
+// not a signal, and for a capture with no samples in it.
+struct CodeRecord {
+  bool known = false;
+
+  CodeCounts counts{};
+  LinearityProfile linearity;
+};
+
+// Where the RF dropped out in this file, found while it was being written.
+//
+// The figure an operator wants before the disc leaves the player: a side with
+// a bad patch is a side worth capturing again, and until this was recorded the
+// only way to know was a full decode hours later. Measured over the file's own
+// samples on the same terms as SignalSummary, and every position counts from
+// the file's first sample — see DropoutDetector.
+//
+// Absent for a test-mode capture, which has no envelope to watch, and for a
+// capture with no samples in it.
+struct DropoutRecord {
+  bool known = false;
+
+  // Every dropout the file held. The list below stops at the detector's
+  // capacity, and this does not.
+  uint64_t count = 0;
+  uint64_t total_samples = 0;
+
+  std::vector<DropoutEvent> events;
+};
+
+// Where the player said it was as the file went by — see AddressIndex.
+//
+// Only an automatic capture has this, because only an automatic capture asks
+// the player anything while the file is open; a capture taken by hand leaves
+// the player alone and carries no list rather than a guessed one.
+struct AddressRecord {
+  // "frame" or "time code", in the words the disc section uses, which is what
+  // a reader needs to know before the numbers below mean anything. Empty when
+  // there is no list.
+  std::string addressing;
+
+  // How far either way of its position each reading could have been taken
+  uint64_t uncertainty_samples = 0;
+
+  std::vector<AddressReading> readings;
+
+  bool present() const { return !addressing.empty() && !readings.empty(); }
+};
+
 // The whole document.
 struct CaptureMetadata {
   // The capture file this sits beside, as its name alone — not its path. A
@@ -324,6 +389,29 @@ struct CaptureMetadata {
   CaptureNamingFields naming;
   CaptureOutcome outcome;
   SignalSummary signal;
+  CodeRecord codes;
+  DropoutRecord dropouts;
+  AddressRecord addresses;
+
+  // How hard the encoder worked on this file, when it could have worked less,
+  // and the level the ring advised for the next one (see encoder_effort.h). A
+  // file written below its configured level is larger than it would otherwise
+  // have been and identical in its samples; it is recorded because a machine
+  // that needed the headroom is worth knowing about. Absent for a sink with
+  // nothing to adjust.
+  EncoderEffortSummary encoder_effort;
+
+  // What the capture's own threads had from the scheduler while this file was
+  // open: differences, on the same terms as the device's loss counters.
+  //
+  // The one place the document steps over the line CaptureOutcome draws, and
+  // knowingly. Ring depth says how close this machine came to losing samples;
+  // these say *why*, per capture PC — whether the elevated priority held,
+  // whether the locked ring kept the workers out of the page cache — and that
+  // is a question asked about a particular recording, months later, when it is
+  // the one with a fault in it. They are written under a section of their own
+  // that says what they are, and absent on a platform without the counters.
+  CaptureThreadUsage threads;
   DeviceBuild device;
   PlayerIdentity player;
   DiscScan disc;
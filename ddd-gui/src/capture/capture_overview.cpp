@@ -0,0 +1,494 @@
+/************************************************************************
+
+    capture_overview.cpp
+
+    A capture's whole length, summarised at every scale it is looked at
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "capture_overview.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+#include "capture_format.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+namespace {
+
+// The file's layout, little-endian throughout:
+//
+//   8   magic, "DDDOVRVW"
+//   4   format version
+//   4   level count
+//   8   total samples
+//   8   longest first-level block, in samples
+//   4   sample rate, in hertz, or 0 where the capture did not say
+//   4   zero, keeping what follows on 8-byte boundaries
+//   8   block count, once per level
+//   48  blocks, level 0 first, each level in sample order
+//
+// Fixed-size records so that block i of a level is at a known offset and the
+// reader can bisect a level on disk without reading up to it.
+constexpr std::array<char, 8> kMagic = {'D', 'D', 'D', 'O', 'V', 'R', 'V', 'W'};
+
+// Incremented when a field changes meaning. A reader refuses a version it does
+// not know rather than drawing a file it has misread.
+constexpr uint32_t kFormatVersion = 1;
+
+constexpr size_t kHeaderBytes = 40;
+constexpr size_t kBlockBytes = 48;
+
+// More levels than a 64-bit sample count can need. A header claiming more is
+// not an overview, whatever its magic says.
+constexpr uint32_t kMaximumLevels = 64;
+
+void PutUnsigned(uint8_t* out, uint64_t value, size_t bytes) {
+  for (size_t index = 0; index < bytes; ++index) {
+    out[index] = static_cast<uint8_t>((value >> (8 * index)) & 0xFF);
+  }
+}
+
+uint64_t GetUnsigned(const uint8_t* in, size_t bytes) {
+  uint64_t value = 0;
+  for (size_t index = 0; index < bytes; ++index) {
+    value |= static_cast<uint64_t>(in[index]) << (8 * index);
+  }
+  return value;
+}
+
+void EncodeBlock(const OverviewBlock& block, uint8_t* out) {
+  PutUnsigned(out, block.first_sample, 8);
+  PutUnsigned(out + 8, block.sample_count, 8);
+  PutUnsigned(out + 16, block.sum_of_squares, 8);
+  PutUnsigned(out + 24, block.clipped_low_count, 8);
+  PutUnsigned(out + 32, block.clipped_high_count, 8);
+  PutUnsigned(out + 40, block.minimum_value, 2);
+  PutUnsigned(out + 42, block.maximum_value, 2);
+  PutUnsigned(out + 44, 0, 4);
+}
+
+OverviewBlock DecodeBlock(const uint8_t* in) {
+  OverviewBlock block;
+  block.first_sample = GetUnsigned(in, 8);
+  block.sample_count = GetUnsigned(in + 8, 8);
+  block.sum_of_squares = GetUnsigned(in + 16, 8);
+  block.clipped_low_count = GetUnsigned(in + 24, 8);
+  block.clipped_high_count = GetUnsigned(in + 32, 8);
+  block.minimum_value = static_cast<uint16_t>(GetUnsigned(in + 40, 2));
+  block.maximum_value = static_cast<uint16_t>(GetUnsigned(in + 42, 2));
+  return block;
+}
+
+// Add a block to a level, and the pair it completes to the level above. The
+// carry is what keeps every level current as the file grows.
+void Push(std::vector<std::vector<OverviewBlock>>& levels, size_t level,
+          const OverviewBlock& block) {
+  for (OverviewBlock carried = block;; ++level) {
+    if (level == levels.size()) {
+      levels.emplace_back();
+    }
+    std::vector<OverviewBlock>& blocks = levels[level];
+    blocks.push_back(carried);
+    if (blocks.size() % 2 != 0) {
+      return;
+    }
+
+    OverviewBlock pair = blocks[blocks.size() - 2];
+    pair.Merge(blocks.back());
+    carried = pair;
+  }
+}
+
+}  // namespace
+
+double OverviewBlock::Rms() const {
+  if (sample_count == 0) {
+    return 0.0;
+  }
+  return std::sqrt(static_cast<double>(sum_of_squares) /
+                   static_cast<double>(sample_count));
+}
+
+void OverviewBlock::Merge(const OverviewBlock& next) {
+  if (next.sample_count == 0) {
+    return;
+  }
+  if (sample_count == 0) {
+    *this = next;
+    return;
+  }
+
+  sample_count += next.sample_count;
+  sum_of_squares += next.sum_of_squares;
+  clipped_low_count += next.clipped_low_count;
+  clipped_high_count += next.clipped_high_count;
+  minimum_value = std::min(minimum_value, next.minimum_value);
+  maximum_value = std::max(maximum_value, next.maximum_value);
+}
+
+OverviewBlock OverviewBlockFromTally(uint64_t first_sample,
+                                     const BufferTally& tally) {
+  OverviewBlock block;
+  block.first_sample = first_sample;
+  block.sample_count = tally.sample_count;
+  block.sum_of_squares = tally.sum_of_squares;
+  block.clipped_low_count = tally.clipped_low_count;
+  block.clipped_high_count = tally.clipped_high_count;
+  block.minimum_value = tally.minimum_value;
+  block.maximum_value = tally.maximum_value;
+  return block;
+}
+
+OverviewBlock MeasureOverviewBlock(const uint16_t* samples, size_t count,
+                                   uint64_t first_sample) {
+  OverviewBlock block;
+  block.first_sample = first_sample;
+  if (samples == nullptr || count == 0) {
+    return block;
+  }
+
+  // No branch but the clipping counts, which the compiler turns into selects:
+  // this is the loop an offline build spends its time in once the decoder has
+  // handed the samples over.
+  uint16_t minimum_value = UINT16_MAX;
+  uint16_t maximum_value = 0;
+  uint64_t clipped_low = 0;
+  uint64_t clipped_high = 0;
+  uint64_t sum_of_squares = 0;
+  for (size_t index = 0; index < count; ++index) {
+    const uint16_t value = samples[index];
+    minimum_value = std::min(minimum_value, value);
+    maximum_value = std::max(maximum_value, value);
+    clipped_low += value == kMinimumSampleValue ? 1 : 0;
+    clipped_high += value == kMaximumSampleValue ? 1 : 0;
+    const int32_t centred = static_cast<int32_t>(value) - kSampleZeroOffset;
+    sum_of_squares += static_cast<uint64_t>(centred * centred);
+  }
+
+  block.sample_count = count;
+  block.minimum_value = minimum_value;
+  block.maximum_value = maximum_value;
+  block.clipped_low_count = clipped_low;
+  block.clipped_high_count = clipped_high;
+  block.sum_of_squares = sum_of_squares;
+  return block;
+}
+
+uint64_t CaptureOverview::total_samples() const {
+  if (empty()) {
+    return 0;
+  }
+  return levels[0].back().end_sample() - levels[0].front().first_sample;
+}
+
+CaptureOverviewBuilder::CaptureOverviewBuilder(size_t maximum_blocks)
+    : maximum_blocks_(std::bit_ceil(std::max<size_t>(maximum_blocks, 2))) {
+  // A level holds half the one below, and one more for the odd block Finish
+  // carries up. The level above the single top block is the carry's too.
+  const size_t level_count =
+      static_cast<size_t>(std::countr_zero(maximum_blocks_)) + 2;
+  levels_.resize(level_count);
+  for (size_t level = 0; level < level_count; ++level) {
+    levels_[level].reserve((maximum_blocks_ >> level) + 1);
+  }
+}
+
+void CaptureOverviewBuilder::Append(const BufferTally& tally) {
+  Append(OverviewBlockFromTally(samples_, tally));
+}
+
+void CaptureOverviewBuilder::Append(OverviewBlock block) {
+  if (block.sample_count == 0) {
+    return;
+  }
+
+  block.first_sample = samples_;
+  samples_ += block.sample_count;
+  pending_.Merge(block);
+  if (++pending_blocks_ < blocks_per_block_) {
+    return;
+  }
+
+  PushFinest(pending_);
+  pending_ = OverviewBlock{};
+  pending_blocks_ = 0;
+
+  // Folded as soon as the level fills rather than when the next block
+  // arrives, so a full level never has to take one more.
+  if (maximum_blocks_ != 0 && levels_[0].size() == maximum_blocks_) {
+    Fold();
+  }
+}
+
+void CaptureOverviewBuilder::PushFinest(const OverviewBlock& block) {
+  block_samples_ = std::max(block_samples_, block.sample_count);
+  Push(levels_, 0, block);
+}
+
+void CaptureOverviewBuilder::Fold() {
+  // The level is a power of two long and full, so every level above it is
+  // whole pairs and already complete: moving each down loses nothing but the
+  // finest detail. Each fits, being half what the level below reserved.
+  block_samples_ = 0;
+  for (const OverviewBlock& block : levels_[1]) {
+    block_samples_ = std::max(block_samples_, block.sample_count);
+  }
+
+  size_t level = 0;
+  for (; level + 1 < levels_.size() && !levels_[level + 1].empty(); ++level) {
+    levels_[level].assign(levels_[level + 1].begin(),
+                          levels_[level + 1].end());
+  }
+  levels_[level].clear();
+  blocks_per_block_ *= 2;
+}
+
+CaptureOverview CaptureOverviewBuilder::Finish() {
+  // A first-level block that was still gathering appended ones goes in short,
+  // as the last buffer of a file does.
+  if (pending_blocks_ != 0) {
+    PushFinest(pending_);
+  }
+
+  // Each level holds its complete pairs merged in the level above already.
+  // What is left is the odd block at the end of a level, carried up alone —
+  // bottom first, since carrying one can complete a pair above it.
+  for (size_t level = 0; level < levels_.size(); ++level) {
+    if (levels_[level].size() > 1 && levels_[level].size() % 2 != 0) {
+      Push(levels_, level + 1, levels_[level].back());
+    }
+  }
+
+  CaptureOverview overview;
+  for (const std::vector<OverviewBlock>& level : levels_) {
+    if (level.empty()) {
+      break;
+    }
+    overview.levels.emplace_back(level.begin(), level.end());
+  }
+  overview.block_samples = block_samples_;
+  overview.sample_rate_hz = sample_rate_hz_;
+  Reset();
+  return overview;
+}
+
+void CaptureOverviewBuilder::Reset() {
+  // The levels are emptied rather than let go, keeping their reservation.
+  for (std::vector<OverviewBlock>& level : levels_) {
+    level.clear();
+  }
+  samples_ = 0;
+  block_samples_ = 0;
+  blocks_per_block_ = 1;
+  pending_blocks_ = 0;
+  pending_ = OverviewBlock{};
+}
+
+std::filesystem::path CaptureOverviewPath(
+    const std::filesystem::path& capture_path) {
+  const std::string text = capture_path.string();
+  const std::string suffix = MatchedCaptureFileSuffix(text);
+
+  // Appended to a path with neither capture suffix, as the metadata sidecar's
+  // is (see CaptureMetadataPath), so the association cannot be lost.
+  if (suffix.empty()) {
+    return std::filesystem::path(text + kCaptureOverviewSuffix);
+  }
+
+  return std::filesystem::path(text.substr(0, text.size() - suffix.size()) +
+                               kCaptureOverviewSuffix);
+}
+
+bool WriteCaptureOverviewFile(const std::filesystem::path& path,
+                              const CaptureOverview& overview,
+                              std::string& error) {
+  std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!file.is_open()) {
+    error = "The overview file could not be created at " + path.string();
+    return false;
+  }
+
+  std::vector<uint8_t> header(kHeaderBytes + (8 * overview.levels.size()));
+  std::copy(kMagic.begin(), kMagic.end(), header.begin());
+  PutUnsigned(header.data() + 8, kFormatVersion, 4);
+  PutUnsigned(header.data() + 12, overview.levels.size(), 4);
+  PutUnsigned(header.data() + 16, overview.total_samples(), 8);
+  PutUnsigned(header.data() + 24, overview.block_samples, 8);
+  PutUnsigned(header.data() + 32, overview.sample_rate_hz, 4);
+  for (size_t level = 0; level < overview.levels.size(); ++level) {
+    PutUnsigned(header.data() + kHeaderBytes + (8 * level),
+                overview.levels[level].size(), 8);
+  }
+  file.write(reinterpret_cast<const char*>(header.data()),
+             static_cast<std::streamsize>(header.size()));
+
+  std::vector<uint8_t> records;
+  for (const std::vector<OverviewBlock>& level : overview.levels) {
+    records.resize(level.size() * kBlockBytes);
+    for (size_t index = 0; index < level.size(); ++index) {
+      EncodeBlock(level[index], records.data() + (index * kBlockBytes));
+    }
+    file.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<std::streamsize>(records.size()));
+  }
+  file.close();
+
+  if (file.fail()) {
+    error = "The overview file could not be written to " + path.string();
+    return false;
+  }
+  return true;
+}
+
+bool CaptureOverviewFile::Open(const std::filesystem::path& path,
+                               std::string& error) {
+  Close();
+  path_ = path;
+
+  file_.open(path, std::ios::in | std::ios::binary);
+  if (!file_.is_open()) {
+    error = "The overview file could not be opened at " + path.string();
+    return false;
+  }
+
+  std::array<uint8_t, kHeaderBytes> header{};
+  file_.read(reinterpret_cast<char*>(header.data()), header.size());
+  if (!file_ || !std::equal(kMagic.begin(), kMagic.end(), header.begin())) {
+    error = path.filename().string() + " is not a capture overview";
+    Close();
+    return false;
+  }
+
+  const auto version = static_cast<uint32_t>(GetUnsigned(header.data() + 8, 4));
+  const auto levels = static_cast<uint32_t>(GetUnsigned(header.data() + 12, 4));
+  if (version != kFormatVersion || levels > kMaximumLevels) {
+    error = path.filename().string() + " is an overview format version " +
+            std::to_string(version) + ", which this application cannot read";
+    Close();
+    return false;
+  }
+
+  std::vector<uint8_t> counts(8 * size_t{levels});
+  file_.read(reinterpret_cast<char*>(counts.data()),
+             static_cast<std::streamsize>(counts.size()));
+  if (!file_) {
+    error = path.filename().string() + " ends inside its own header";
+    Close();
+    return false;
+  }
+
+  uint64_t offset = kHeaderBytes + counts.size();
+  for (uint32_t level = 0; level < levels; ++level) {
+    const uint64_t count = GetUnsigned(counts.data() + (8 * size_t{level}), 8);
+    level_block_counts_.push_back(count);
+    level_offsets_.push_back(offset);
+    offset += count * kBlockBytes;
+  }
+
+  // Checked against the size the header promises, so a file cut short by a
+  // full disk is refused here rather than drawn with its end missing.
+  std::error_code size_error;
+  const uintmax_t size = std::filesystem::file_size(path, size_error);
+  if (size_error || size != offset) {
+    error = path.filename().string() +
+            " is not the length its header describes; build it again from "
+            "the capture";
+    Close();
+    return false;
+  }
+
+  total_samples_ = GetUnsigned(header.data() + 16, 8);
+  block_samples_ = GetUnsigned(header.data() + 24, 8);
+  sample_rate_hz_ = static_cast<uint32_t>(GetUnsigned(header.data() + 32, 4));
+  return true;
+}
+
+void CaptureOverviewFile::Close() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+  file_.clear();
+  total_samples_ = 0;
+  block_samples_ = 0;
+  sample_rate_hz_ = 0;
+  level_block_counts_.clear();
+  level_offsets_.clear();
+}
+
+uint64_t CaptureOverviewFile::block_count(size_t level) const {
+  return level < level_block_counts_.size() ? level_block_counts_[level] : 0;
+}
+
+size_t CaptureOverviewFile::LevelFor(double samples_per_column) const {
+  size_t chosen = 0;
+  for (size_t level = 1; level < level_count(); ++level) {
+    const double longest = std::ldexp(static_cast<double>(block_samples_),
+                                      static_cast<int>(level));
+    if (longest > samples_per_column) {
+      break;
+    }
+    chosen = level;
+  }
+  return chosen;
+}
+
+bool CaptureOverviewFile::ReadBlock(size_t level, uint64_t index,
+                                    OverviewBlock& block) {
+  std::array<uint8_t, kBlockBytes> record{};
+  file_.clear();
+  file_.seekg(static_cast<std::streamoff>(level_offsets_[level] +
+                                          (index * kBlockBytes)));
+  file_.read(reinterpret_cast<char*>(record.data()), record.size());
+  if (!file_) {
+    last_error_ = "Failed to read " + path_.filename().string();
+    return false;
+  }
+  block = DecodeBlock(record.data());
+  return true;
+}
+
+bool CaptureOverviewFile::ReadBlocks(size_t level, uint64_t first_sample,
+                                     uint64_t end_sample,
+                                     std::vector<OverviewBlock>& blocks) {
+  blocks.clear();
+  if (!IsOpen() || level >= level_count() || first_sample >= end_sample) {
+    return true;
+  }
+
+  // The first block ending after first_sample, by bisection. A level's blocks
+  // are contiguous and in order, so this is a handful of 48-byte reads.
+  uint64_t low = 0;
+  uint64_t high = level_block_counts_[level];
+  OverviewBlock block;
+  while (low < high) {
+    const uint64_t middle = low + ((high - low) / 2);
+    if (!ReadBlock(level, middle, block)) {
+      return false;
+    }
+    if (block.end_sample() <= first_sample) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  for (uint64_t index = low; index < level_block_counts_[level]; ++index) {
+    if (!ReadBlock(level, index, block)) {
+      return false;
+    }
+    if (block.first_sample >= end_sample) {
+      break;
+    }
+    blocks.push_back(block);
+  }
+  return true;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,268 @@
+/************************************************************************
+
+    capture_overview.h
+
+    A capture's whole length, summarised at every scale it is looked at
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sample_metrics.h"
+
+namespace ddd::capture {
+
+// A two-hour capture is 2.9e11 samples, and until this there was no way to look
+// at one as a whole: the waveform panel shows a snapshot of the live stream,
+// and everything that reads a finished file reads all of it. Whether the level
+// sagged on side two, where the clipping was, which stretch of the disc the
+// dropouts sat in — every one of those meant decoding a hundred gigabytes.
+//
+// The overview is the answer precomputed. Each block holds the extremes, the
+// energy and the clipping of a run of samples; the first level has a block per
+// buffer, and every level above merges pairs from the one below, up to a single
+// block for the whole file. A view that wants N columns across a span reads the
+// coarsest level whose blocks are no longer than a column, which is never more
+// than about 2N blocks whatever the span — so the whole file draws as fast as a
+// second of it, and zooming in reads a finer level and only the stretch of it
+// on screen.
+//
+// The first level costs nothing to gather. The validator already measures
+// every buffer as it strips the markers (see BufferTally), so the pipeline
+// keeps each buffer's tally as a block while a file is open and writes the
+// pyramid beside the file when it closes, as it does the metadata sidecar. A
+// file older than this, or one whose overview was lost with a killed process,
+// is measured afresh by BuildCaptureOverview in capture_overview_build.h.
+//
+// In memory, a block per 2 MiB buffer is 48 bytes per 26 ms of capture: two
+// hours holds 13 MB of them, twice that with the levels above. The pipeline
+// reserves that much for each file as its sink is attached, off the processing
+// thread and only for a sink that stores data, and never grows past it: a file
+// longer than two hours has its finest level folded into the one above and
+// carries on at half the resolution, so adding a buffer's block never
+// allocates on the thread that has a deadline. A file is written once, whole,
+// when it is complete.
+
+// The suffix an overview is written with, beside the capture and its
+// metadata: `Casper_side1.ddd.flac` is accompanied by `Casper_side1.ddd.yaml`
+// and `Casper_side1.ddd.overview`.
+inline constexpr const char* kCaptureOverviewSuffix = ".ddd.overview";
+
+// Samples per first-level block when a file is measured after the fact. The
+// same as a ring slot holds, so an overview built from the file has the
+// resolution of the one the capture would have written.
+inline constexpr size_t kOverviewBlockSamples = size_t{1} << 20;
+
+// One run of samples, summarised. The same figures BufferTally carries, less
+// the histogram, which would make each block 4 KiB instead of 48 bytes.
+struct OverviewBlock {
+  // Where the run starts in the file, and how long it is. Blocks are as long
+  // as the buffers they came from, which are not all the same length — a
+  // decimated buffer, the last of a file — so each says where it starts rather
+  // than leaving that to be multiplied out.
+  uint64_t first_sample = 0;
+  uint64_t sample_count = 0;
+
+  // Sum of (value - 512)^2 over the run, as BufferTally defines it. 64 bits
+  // holds a whole capture's worth, which is what the top block is.
+  uint64_t sum_of_squares = 0;
+
+  uint64_t clipped_low_count = 0;
+  uint64_t clipped_high_count = 0;
+
+  // Seeded so that an empty block merges harmlessly
+  uint16_t minimum_value = UINT16_MAX;
+  uint16_t maximum_value = 0;
+
+  uint64_t end_sample() const { return first_sample + sample_count; }
+
+  // Root-mean-square about mid-scale, in codes. Zero for an empty block.
+  double Rms() const;
+
+  // Fold the run that follows this one into it.
+  void Merge(const OverviewBlock& next);
+};
+
+// A buffer's tally as a block starting at `first_sample`.
+OverviewBlock OverviewBlockFromTally(uint64_t first_sample,
+                                     const BufferTally& tally);
+
+// The same figures from 10-bit values, as the validator would have measured
+// them had they come through it. What a file is measured with after the fact.
+OverviewBlock MeasureOverviewBlock(const uint16_t* samples, size_t count,
+                                   uint64_t first_sample);
+
+// The pyramid. levels[0] is the finest; each level above holds the pairs of
+// the one below merged, the odd block at the end carried up alone, until a
+// level holds one block for the whole file.
+struct CaptureOverview {
+  std::vector<std::vector<OverviewBlock>> levels;
+
+  // The longest first-level block. What a level's blocks are measured against
+  // when a view chooses one: a block at level L is at most this times 2^L.
+  uint64_t block_samples = 0;
+
+  // The rate the samples arrived at, in hertz, so that a view can turn the
+  // sample counts into times. Zero where nothing said: an uncompressed file
+  // carries no rate, and one measured after the fact has only its name.
+  uint32_t sample_rate_hz = 0;
+
+  uint64_t total_samples() const;
+  bool empty() const { return levels.empty() || levels[0].empty(); }
+};
+
+// Gathers the pyramid a block at a time.
+//
+// Each pair is merged into the level above as soon as it is complete, so
+// Append is a handful of scalar operations however long the file gets, and
+// Finish only has the odd blocks at the ends of the levels to carry up.
+//
+// Built with a block limit, every level's storage is reserved up front and
+// Append never allocates. When the finest level is full it is dropped, the
+// level above taking its place, and from then on each first-level block is
+// the merge of twice as many appended ones. Built without one, the levels grow
+// as they need to, which is what measuring a file after the fact wants.
+//
+// Thread-safety: NOT thread-safe. The pipeline's processing thread owns one
+// while its file is open, and hands it over whole when the file closes.
+class CaptureOverviewBuilder {
+ public:
+  // The pipeline's limit: two hours of 2 MiB buffers at the full rate, 13 MB
+  // for the finest level and as much again for the levels above it.
+  static constexpr size_t kMaximumBlocks = size_t{1} << 18;
+
+  CaptureOverviewBuilder() = default;
+
+  // Reserves for `maximum_blocks` first-level blocks, rounded up to a power of
+  // two so that a full level is always whole pairs.
+  explicit CaptureOverviewBuilder(size_t maximum_blocks);
+
+  // A buffer as the validator measured it, placed after the last.
+  void Append(const BufferTally& tally);
+
+  // A block measured elsewhere. Its first_sample is replaced with where the
+  // last block ended, so blocks are contiguous however they were produced.
+  void Append(OverviewBlock block);
+
+  uint64_t samples() const { return samples_; }
+  bool empty() const { return samples_ == 0; }
+
+  // The rate the blocks' samples arrived at, carried into the overview Finish
+  // hands over. A property of the stream rather than of what has been
+  // gathered from it, so Reset leaves it alone.
+  void SetSampleRate(uint32_t sample_rate_hz) {
+    sample_rate_hz_ = sample_rate_hz;
+  }
+  uint32_t sample_rate_hz() const { return sample_rate_hz_; }
+
+  // Close the levels and hand the pyramid over, leaving the builder empty.
+  //
+  // A copy the size of the pyramid rather than the pyramid itself, so that the
+  // reservation stays here for the next file. Not something for a thread with
+  // a deadline: the pipeline hands its builder over unfinished, and this is
+  // called by whoever collects the file (see
+  // CapturePipeline::TakeRetiredOverview).
+  CaptureOverview Finish();
+
+  void Reset();
+
+  // How many first-level blocks fit without allocating, for the tests that
+  // pin that a file never grows past its reservation.
+  size_t block_capacity() const {
+    return levels_.empty() ? 0 : levels_[0].capacity();
+  }
+
+ private:
+  void PushFinest(const OverviewBlock& block);
+
+  // Drop the full finest level, each level above moving down into the
+  // reservation of the one below it.
+  void Fold();
+
+  std::vector<std::vector<OverviewBlock>> levels_;
+  uint64_t samples_ = 0;
+  uint64_t block_samples_ = 0;
+  uint32_t sample_rate_hz_ = 0;
+
+  // Zero for a builder without a limit.
+  size_t maximum_blocks_ = 0;
+
+  // How many appended blocks make one first-level block: 2^folds. The ones
+  // gathered towards the next are merged into `pending_`.
+  uint64_t blocks_per_block_ = 1;
+  uint64_t pending_blocks_ = 0;
+  OverviewBlock pending_;
+};
+
+// Where the overview for this capture goes.
+std::filesystem::path CaptureOverviewPath(
+    const std::filesystem::path& capture_path);
+
+// Write it. Returns false with the reason in `error`.
+//
+// Like the metadata sidecar, failing to write one is never a failed capture:
+// the recording is complete without it, and the overview can be built again
+// from the file.
+bool WriteCaptureOverviewFile(const std::filesystem::path& path,
+                              const CaptureOverview& overview,
+                              std::string& error);
+
+// Reads an overview a level and a stretch at a time.
+//
+// Only the header is read when the file is opened. A view asks for one level
+// over the span it shows, the block the span starts in is found by bisecting
+// that level on disk, and what is read is the blocks from there to the end of
+// the span — a few kilobytes, however large the capture it describes.
+//
+// Thread-safety: NOT thread-safe. One reader per thread.
+class CaptureOverviewFile {
+ public:
+  bool Open(const std::filesystem::path& path, std::string& error);
+  bool IsOpen() const { return file_.is_open(); }
+  void Close();
+
+  uint64_t total_samples() const { return total_samples_; }
+  uint64_t block_samples() const { return block_samples_; }
+
+  // Zero when the capture did not say; see CaptureOverview::sample_rate_hz.
+  uint32_t sample_rate_hz() const { return sample_rate_hz_; }
+  size_t level_count() const { return level_block_counts_.size(); }
+  uint64_t block_count(size_t level) const;
+
+  // The coarsest level whose blocks are no longer than `samples_per_column`,
+  // so that a view at that density has at least one block for every column.
+  // The finest level when even its blocks are longer.
+  size_t LevelFor(double samples_per_column) const;
+
+  // The blocks of `level` that hold any of samples [first_sample, end_sample),
+  // in order. Returns false with the reason in LastError() when the file could
+  // not be read.
+  bool ReadBlocks(size_t level, uint64_t first_sample, uint64_t end_sample,
+                  std::vector<OverviewBlock>& blocks);
+
+  const std::string& LastError() const { return last_error_; }
+
+ private:
+  bool ReadBlock(size_t level, uint64_t index, OverviewBlock& block);
+
+  std::ifstream file_;
+  std::filesystem::path path_;
+  uint64_t total_samples_ = 0;
+  uint64_t block_samples_ = 0;
+  uint32_t sample_rate_hz_ = 0;
+  std::vector<uint64_t> level_block_counts_;
+  std::vector<uint64_t> level_offsets_;
+  std::string last_error_;
+};
+
+}  // namespace ddd::capture
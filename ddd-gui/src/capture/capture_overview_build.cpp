@@ -0,0 +1,158 @@
+/************************************************************************
+
+    capture_overview_build.cpp
+
+    Measuring an overview from a finished capture
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "capture_overview_build.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "capture_reader.h"
+
+namespace ddd::capture {
+namespace {
+
+OverviewBuild Failed(const std::string& message) {
+  OverviewBuild build;
+  build.outcome = OverviewBuild::Outcome::kFailed;
+  build.message = message;
+  return build;
+}
+
+// Measure a run of samples a block at a time, each thread taking every
+// `threads`th block. Blocks are independent, so there is nothing to share but
+// the output, and each thread writes only its own entries in it.
+void MeasureChunk(const std::vector<uint16_t>& samples, size_t threads,
+                  std::vector<OverviewBlock>& blocks) {
+  const size_t block_count =
+      (samples.size() + kOverviewBlockSamples - 1) / kOverviewBlockSamples;
+  blocks.assign(block_count, OverviewBlock{});
+
+  const auto measure = [&samples, &blocks, block_count, threads](size_t lane) {
+    for (size_t index = lane; index < block_count; index += threads) {
+      const size_t first = index * kOverviewBlockSamples;
+      const size_t count =
+          std::min(kOverviewBlockSamples, samples.size() - first);
+      blocks[index] = MeasureOverviewBlock(samples.data() + first, count, 0);
+    }
+  };
+
+  const size_t lanes = std::min(threads, block_count);
+  if (lanes <= 1) {
+    measure(0);
+    return;
+  }
+
+  // Started per chunk rather than kept in a pool. A chunk is 16 M samples,
+  // and starting a handful of threads for each is nothing beside decoding it.
+  std::vector<std::thread> workers;
+  workers.reserve(lanes - 1);
+  for (size_t lane = 1; lane < lanes; ++lane) {
+    workers.emplace_back(measure, lane);
+  }
+  measure(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace
+
+OverviewBuild BuildCaptureOverview(const std::filesystem::path& capture_path,
+                                   const OverviewBuildProgress& progress,
+                                   const OverviewBuildCancelled& cancelled,
+                                   size_t threads) {
+  const std::string name = capture_path.filename().string();
+
+  const std::optional<CaptureReader::Format> format =
+      CaptureReader::FormatFromExtension(capture_path);
+  if (!format.has_value()) {
+    return Failed(name +
+                  " is not a capture file this application can read. "
+                  "Expected .flac, .s16 or .raw.");
+  }
+
+  CaptureReader reader;
+  std::string error_message;
+  if (!reader.Open(capture_path, *format, error_message)) {
+    return Failed("Could not open " + name + ": " + error_message);
+  }
+
+  if (threads == 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  const std::optional<uint64_t> total_samples = reader.TotalSamples();
+
+  // Zero, and so untimed, for an uncompressed file: nothing in it says.
+  CaptureOverviewBuilder builder;
+  builder.SetSampleRate(reader.SampleRateHz().value_or(0));
+  std::vector<uint16_t> read;
+  std::vector<uint16_t> chunk;
+  std::vector<OverviewBlock> blocks;
+  chunk.reserve(kOverviewBuildChunkSamples);
+  bool end_of_file = false;
+
+  while (!end_of_file) {
+    if (cancelled && cancelled()) {
+      OverviewBuild build;
+      build.outcome = OverviewBuild::Outcome::kCancelled;
+      build.message = "Cancelled; no overview was written for " + name + ".";
+      return build;
+    }
+
+    // Filled across as many reads as it takes. The reader returns what it has
+    // to hand — a raw file 64 K samples at a time — and a block cut wherever a
+    // read happened to end would not be the block the pipeline writes.
+    chunk.clear();
+    while (chunk.size() < kOverviewBuildChunkSamples && !end_of_file) {
+      if (!reader.Read(read, kOverviewBuildChunkSamples - chunk.size(),
+                       end_of_file)) {
+        return Failed("Failed to read " + name + ": " + reader.LastError());
+      }
+      if (read.empty()) {
+        end_of_file = true;
+        break;
+      }
+      chunk.insert(chunk.end(), read.begin(), read.end());
+    }
+    if (chunk.empty()) {
+      break;
+    }
+
+    MeasureChunk(chunk, threads, blocks);
+    for (const OverviewBlock& block : blocks) {
+      builder.Append(block);
+    }
+
+    if (progress) {
+      progress(builder.samples(), total_samples);
+    }
+  }
+
+  OverviewBuild build;
+  build.overview = builder.Finish();
+  build.overview_path = CaptureOverviewPath(capture_path);
+
+  std::string error;
+  if (!WriteCaptureOverviewFile(build.overview_path, build.overview, error)) {
+    build.outcome = OverviewBuild::Outcome::kFailed;
+    build.message = error;
+    return build;
+  }
+
+  build.outcome = OverviewBuild::Outcome::kBuilt;
+  build.message = "Overview of " + name + " written to " +
+                  build.overview_path.filename().string() + ".";
+  return build;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,85 @@
+/************************************************************************
+
+    capture_overview_build.h
+
+    Measuring an overview from a finished capture
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "capture_overview.h"
+
+namespace ddd::capture {
+
+// A capture written before the pipeline kept overviews, or one whose process
+// was killed before the overview could be written, has none — so the file is
+// read once and measured. The result is what the pipeline would have written,
+// block for block, with blocks of kOverviewBlockSamples. The sample rate comes
+// from the file where it says, as a FLAC capture's header does; an uncompressed
+// one does not, and its overview is written with none.
+//
+// Separate from capture_overview.h because this half reads capture files and
+// so needs the decoder, and the pyramid, the file format and the pipeline's
+// half need nothing of the kind.
+//
+// The decoder is sequential by nature: a FLAC stream is one frame after
+// another through one decoder, and a raw file is one read after another from
+// one drive. What is parallel is the measuring. Each read hands over a run of
+// whole blocks, and the blocks are measured on as many threads as the machine
+// has, so that measuring is never what a build waits on.
+
+// Samples per read: a run of whole blocks, long enough that every thread has a
+// few to measure, short enough that a cancel is acted on within a second.
+inline constexpr size_t kOverviewBuildChunkSamples = kOverviewBlockSamples * 16;
+
+struct OverviewBuild {
+  enum class Outcome {
+    kBuilt,
+
+    // The file could not be read, or the overview could not be written
+    kFailed,
+
+    // The caller asked to stop before the end. Nothing is written.
+    kCancelled,
+  };
+
+  Outcome outcome = Outcome::kFailed;
+  CaptureOverview overview;
+
+  // Where the overview was written, once it has been
+  std::filesystem::path overview_path;
+
+  // The sentence to show a user
+  std::string message;
+
+  bool built() const { return outcome == Outcome::kBuilt; }
+};
+
+// The same callbacks the test-data analysis takes (see test_data_analysis.h),
+// with the same meanings.
+using OverviewBuildProgress = std::function<void(
+    uint64_t samples_measured, std::optional<uint64_t> total)>;
+using OverviewBuildCancelled = std::function<bool()>;
+
+// Read a capture, measure it, and write its overview beside it.
+//
+// Blocking, and as slow as the file is to decode — minutes for a FLAC disc
+// side — so a GUI caller runs it on a thread of its own. `threads` is the
+// number to measure on; zero means one per hardware thread.
+OverviewBuild BuildCaptureOverview(const std::filesystem::path& capture_path,
+                                   const OverviewBuildProgress& progress = {},
+                                   const OverviewBuildCancelled& cancelled = {},
+                                   size_t threads = 0);
+
+}  // namespace ddd::capture
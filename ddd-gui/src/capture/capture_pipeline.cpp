@@ -12,11 +12,13 @@
 #include "capture_pipeline.h"
 
 #include <algorithm>
+#include <optional>
 #include <utility>
 
 #include "log_format.h"
 #include "logger.h"
 #include "sample_format.h"
+#include "snapshot_trigger.h"
 #include "thread_priority.h"
 #include "wire_protocol.h"
 
@@ -68,11 +70,21 @@ class CapturePipeline::Control : public SourceControl {
 CapturePipeline::CapturePipeline(ILogger* logger)
     : logger_(logger),
       snapshots_(std::make_unique<SnapshotPublisher>(
-          SnapshotPublisher::kDefaultSnapshotBytes)) {}
+          SnapshotPublisher::kDefaultSnapshotBytes)),
+      field_snapshots_(std::make_unique<SnapshotPublisher>(0)) {}
+
+uint64_t CapturePipeline::SlotSamples() const {
+  return ring_ != nullptr
+             ? SamplesInWireBytes(ring_->slot_size_bytes(),
+                                  options_.wire_format,
+                                  options_.inband_telemetry)
+             : 0;
+}
 
 CapturePipeline::~CapturePipeline() {
   Abort();
   Wait();
+  delete pending_sink_.exchange(nullptr);
 }
 
 bool CapturePipeline::Start(ISampleSource* source,
@@ -88,8 +100,26 @@ bool CapturePipeline::Start(ISampleSource* source,
   options_ = options;
   source_ = source;
   sink_ = std::move(sink);
-  validator_.Reset();
+  // A packed stream's words carry no markers; its block numbers are checked by
+  // the unpacker instead.
+  validator_.Reset(options.wire_format != WireFormat::kPacked);
+  unpacker_.Reset();
+  stripper_.Reset();
+  inband_overflowing_ = false;
+  inband_drop_logged_ = false;
   metrics_.Reset();
+  histograms_.Publish(CodeHistograms{});
+  dropouts_ = DropoutDetector({options.sample_rate_hz});
+  {
+    const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+    retired_dropouts_.clear();
+    retired_overview_.reset();
+  }
+  // Reserved here, for the same reason the detector's list is: the processing
+  // thread appends a block per buffer and must never be the one to allocate.
+  // Only for a run that opens with a file; one that starts by monitoring gets
+  // its builder with the sink that needs it.
+  overview_ = OverviewBuilderFor(sink_.get());
   test_pattern_verifier_ = TestPatternVerifier{};
   test_pattern_result_ = TestPatternVerifier::Result{};
   test_pattern_checked_ = false;
@@ -109,14 +139,17 @@ bool CapturePipeline::Start(ISampleSource* source,
   device_near_full_units_ = 0;
   ring_fill_.Reset();
   device_back_pressure_.Reset();
+  thread_usage_.Reset();
+  thread_usage_publisher_.Publish(CaptureThreadUsage{});
   capture_span_open_ = false;
   capture_span_start_buffer_ = 0;
   transfers_completed_ = 0;
   buffers_processed_ = 0;
+  buffers_skipped_ = 0;
   sink_change_requests_ = 0;
   sink_change_count_ = 0;
   last_sink_change_buffer_ = 0;
-  pending_sink_.store(nullptr);
+  delete pending_sink_.exchange(nullptr);
   pending_detach_.store(false);
   stop_requested_ = false;
   abort_requested_ = false;
@@ -129,7 +162,11 @@ bool CapturePipeline::Start(ISampleSource* source,
     result_detail_.clear();
   }
 
-  snapshots_ = std::make_unique<SnapshotPublisher>(options_.snapshot_bytes);
+  snapshots_ = std::make_unique<SnapshotPublisher>(
+      options_.snapshot_bytes, options_.snapshot_reader_capacity);
+  field_snapshots_ = std::make_unique<SnapshotPublisher>(
+      options_.field_snapshot_bytes,
+      SnapshotPublisher::kDefaultReaderCapacity, false);
 
   ring_ = std::make_unique<DiskBufferRing>(
       source_->PlanGeometry(options_.queue_size_bytes));
@@ -171,9 +208,21 @@ bool CapturePipeline::Start(ISampleSource* source,
                   std::to_string(ring_->slot_size_bytes() / 1024) + " KiB");
   }
 
+  // A run that starts straight into a file has an encoder already going.
+  if (sink_ != nullptr) {
+    thread_usage_.RegisterThreads(ThreadAccounting::Role::kEncoder,
+                                  sink_->WorkerThreadIds());
+  }
+
   LogStartDetail();
 
   start_time_ = std::chrono::steady_clock::now();
+
+  // Before the processing thread exists, so nothing else is touching it.
+  effort_ = EncoderEffortController{};
+  next_effort_step_ = 0;
+  BeginEncoderEffort();
+
   running_ = true;
 
   control_thread_ = std::thread(&CapturePipeline::ControlThread, this);
@@ -233,7 +282,10 @@ uint64_t CapturePipeline::AttachSink(std::unique_ptr<ISampleSink> sink) {
   // and the superseded sink is destroyed here rather than leaked — a caller
   // that attaches twice in one buffer period gets the second one, which is what
   // they asked for.
-  ISampleSink* const superseded = pending_sink_.exchange(sink.release());
+  auto pending = std::make_unique<PendingSink>();
+  pending->overview = OverviewBuilderFor(sink.get());
+  pending->sink = std::move(sink);
+  PendingSink* const superseded = pending_sink_.exchange(pending.release());
   delete superseded;
 
   pending_detach_.store(false);
@@ -241,7 +293,7 @@ uint64_t CapturePipeline::AttachSink(std::unique_ptr<ISampleSink> sink) {
 }
 
 uint64_t CapturePipeline::DetachSink() {
-  ISampleSink* const superseded = pending_sink_.exchange(nullptr);
+  PendingSink* const superseded = pending_sink_.exchange(nullptr);
   delete superseded;
 
   pending_detach_.store(true);
@@ -253,11 +305,49 @@ std::unique_ptr<ISampleSink> CapturePipeline::TakeRetiredSink() {
   return std::move(retired_sink_);
 }
 
+std::vector<DropoutEvent> CapturePipeline::TakeRetiredDropouts() {
+  const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+  std::vector<DropoutEvent> events;
+  events.swap(retired_dropouts_);
+  return events;
+}
+
+CaptureOverview CapturePipeline::TakeRetiredOverview() {
+  std::unique_ptr<CaptureOverviewBuilder> builder;
+  {
+    const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+    builder = std::move(retired_overview_);
+  }
+  if (builder == nullptr) {
+    return CaptureOverview{};
+  }
+  return builder->Finish();
+}
+
+std::unique_ptr<CaptureOverviewBuilder> CapturePipeline::OverviewBuilderFor(
+    const ISampleSink* sink) const {
+  if (sink == nullptr || !sink->StoresData()) {
+    return nullptr;
+  }
+  auto builder = std::make_unique<CaptureOverviewBuilder>(
+      CaptureOverviewBuilder::kMaximumBlocks);
+  builder->SetSampleRate(options_.sample_rate_hz);
+  return builder;
+}
+
 // The wire rate the configured sample rate implies, in bytes per second. What a
 // measured throughput is compared against.
 double CapturePipeline::ExpectedBytesPerSecond() const {
-  return static_cast<double>(options_.sample_rate_hz) *
-         static_cast<double>(kBytesPerSample);
+  const double samples =
+      WireBytesPerSecond(options_.wire_format, options_.sample_rate_hz);
+  if (!options_.inband_telemetry) {
+    return samples;
+  }
+
+  // Eight words of every packet are the block, so the wire carries that much
+  // more than the samples alone would need
+  return samples * static_cast<double>(kInbandPacketWords) /
+         static_cast<double>(kInbandPacketWords - kInbandBlockWords);
 }
 
 void CapturePipeline::LogStartDetail() {
@@ -285,15 +375,26 @@ void CapturePipeline::LogStartDetail() {
 
   logger_->Debug(
       std::string("Options: test mode ") + (options_.test_mode ? "on" : "off") +
+      ", wire format " +
+      (options_.wire_format == WireFormat::kPacked ? "packed" : "words") +
+      ", in-band telemetry " + (options_.inband_telemetry ? "on" : "off") +
       ", memory locking " + (options_.lock_memory ? "on" : "off") +
       ", priority elevation " + (options_.elevate_priority ? "on" : "off") +
       ", stall timeout " + std::to_string(options_.stall_timeout.count()) +
       " ms, snapshot every " +
       std::to_string(options_.snapshot_interval_buffers) + " buffers of " +
-      FormatBytes(options_.snapshot_bytes) + ", throughput window " +
+      FormatBytes(options_.snapshot_bytes) +
+      (options_.field_snapshot_bytes > 0
+           ? ", field snapshot every " +
+                 std::to_string(options_.field_snapshot_interval_buffers) +
+                 " buffers of " + FormatBytes(options_.field_snapshot_bytes)
+           : std::string()) +
+      ", throughput window " +
       std::to_string(options_.throughput_window.count()) +
       " ms, progress every " +
-      std::to_string(options_.progress_log_interval.count()) + " ms");
+      std::to_string(options_.progress_log_interval.count()) +
+      " ms, thread usage every " +
+      std::to_string(options_.thread_usage_interval.count()) + " ms");
 }
 
 void CapturePipeline::LogProgress() {
@@ -416,13 +517,28 @@ void CapturePipeline::LogStopDetail() {
   // sensible at all.
   logger_->Debug(
       "Signal over the run: " + std::to_string(stats.metrics.sample_count) +
-      " samples, range " + std::to_string(stats.metrics.minimum_value) + "-" +
+      " samples, " + std::to_string(stats.metrics.measured_sample_count) +
+      " of them measured, range " +
+      std::to_string(stats.metrics.minimum_value) + "-" +
       std::to_string(stats.metrics.maximum_value) + " of 1023, RMS " +
       FormatDecimal(stats.metrics.rms, 1) + ", clipped low " +
       std::to_string(stats.metrics.clipped_low_count) + " high " +
       std::to_string(stats.metrics.clipped_high_count) + "; sequence " +
       SequenceStateName(stats.sequence_state));
 
+  // Whether the priority and the locked ring did their job, in the kernel's
+  // own counts. Involuntary switches on an elevated thread and major faults on
+  // either worker are the two figures to look at first: each one is a moment
+  // the deadline was at the mercy of something else.
+  const CaptureThreadUsage threads = thread_usage_.Totals();
+  if (threads.present()) {
+    logger_->Debug("Transfer thread: " + threads.transfer.Describe());
+    logger_->Debug("Processing thread: " + threads.processing.Describe());
+    if (threads.encoder.present) {
+      logger_->Debug("Encoder threads: " + threads.encoder.Describe());
+    }
+  }
+
   if (stats.test_pattern_checked) {
     logger_->Debug(
         std::string("Test pattern: ") +
@@ -438,14 +554,19 @@ void CapturePipeline::PerformPendingSinkChange() {
   // and counted then.
   const uint64_t requests_seen = sink_change_requests_.load();
 
-  ISampleSink* const incoming = pending_sink_.exchange(nullptr);
+  std::unique_ptr<PendingSink> incoming(pending_sink_.exchange(nullptr));
   const bool detaching = pending_detach_.exchange(false);
 
   if (incoming == nullptr && !detaching) {
     return;
   }
 
-  std::unique_ptr<ISampleSink> replacement(incoming);
+  std::unique_ptr<ISampleSink> replacement;
+  std::unique_ptr<CaptureOverviewBuilder> replacement_overview;
+  if (incoming != nullptr) {
+    replacement = std::move(incoming->sink);
+    replacement_overview = std::move(incoming->overview);
+  }
   if (replacement == nullptr) {
     replacement = std::make_unique<NullSink>();
   }
@@ -470,6 +591,11 @@ void CapturePipeline::PerformPendingSinkChange() {
     // Timed because that is the claim: the pause is meant to be short against
     // the ring's headroom, and a log that carries both figures is how anybody
     // checks it on a machine that is not this one.
+    // The encoder's threads end inside Finish, and their last reading has to
+    // be taken while they still exist to be read.
+    thread_usage_.RetireThreads(sink_->WorkerThreadIds());
+    effort_.End();
+
     const auto finish_started = std::chrono::steady_clock::now();
     if (!sink_->Finish()) {
       LatchResult(TransferResult::kFileWriteError, sink_->LastError());
@@ -485,8 +611,23 @@ void CapturePipeline::PerformPendingSinkChange() {
     retired_sink_ = std::move(sink_);
   }
 
+  // The closing file's dropouts and overview go with it, under the same lock
+  // and for the same reason: the caller collecting the file wants all three,
+  // and the next file's span is about to start lists of its own. The overview
+  // as its builder, moved rather than finished: closing the levels copies the
+  // pyramid, and that is for the caller's thread (see TakeRetiredOverview).
+  if (closing_a_file) {
+    dropouts_.EndCaptureSpan();
+    const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+    retired_dropouts_ = dropouts_.TakeCaptureEvents();
+    retired_overview_ = std::move(overview_);
+  }
+
   sink_ = std::move(replacement);
+  overview_ = std::move(replacement_overview);
   last_sink_change_buffer_ = buffers_processed_.load();
+  thread_usage_.RegisterThreads(ThreadAccounting::Role::kEncoder,
+                                sink_->WorkerThreadIds());
 
   // Measure the recording separately from the session it sits in. The swap
   // happens between two buffers, so the span this opens and closes holds
@@ -494,9 +635,12 @@ void CapturePipeline::PerformPendingSinkChange() {
   // metadata has to describe, and not the minute of setting up before it.
   if (sink_->StoresData()) {
     metrics_.BeginCaptureSpan();
+    dropouts_.BeginCaptureSpan();
+    BeginEncoderEffort();
   } else {
     metrics_.EndCaptureSpan();
   }
+  histograms_.Publish(metrics_.Histograms());
 
   // Set to the number of requests this swap accounted for, rather than
   // incremented by one.
@@ -569,6 +713,71 @@ void CapturePipeline::PerformPendingSinkChange() {
   }
 }
 
+void CapturePipeline::BeginEncoderEffort() {
+  const double now = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_time_)
+                         .count();
+  if (sink_ == nullptr || !sink_->StoresData()) {
+    return;
+  }
+  effort_.Begin(options_.adapt_encoder_effort ? sink_->EffortLevels()
+                                              : std::vector<int>{},
+                sink_->EffortStep(), now);
+  if (effort_.active()) {
+    next_effort_step_ = effort_.step();
+  }
+}
+
+void CapturePipeline::AdjustEncoderEffort() {
+  if (!effort_.active() || sink_ == nullptr || ring_ == nullptr) {
+    return;
+  }
+
+  const double now = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start_time_)
+                         .count();
+  const double ring_fraction =
+      static_cast<double>(ring_->SlotsInUse()) /
+      static_cast<double>(std::max<size_t>(ring_->slot_count(), 1));
+  const double pending_seconds =
+      options_.sample_rate_hz == 0
+          ? 0.0
+          : static_cast<double>(sink_->SamplesPending()) /
+                static_cast<double>(options_.sample_rate_hz);
+
+  const size_t previous_step = effort_.step();
+  const std::optional<size_t> step =
+      effort_.Observe(now, ring_fraction, pending_seconds);
+  if (!step.has_value()) {
+    return;
+  }
+
+  // Nothing is asked of the sink. Its encoder keeps the level it was opened
+  // at, and this is only advice for whichever file opens next.
+  next_effort_step_ = *step;
+
+  // Event-driven, not scheduled, and rare by construction: the advice moves
+  // at most once a second, and back up only after ten quiet ones. Worded as
+  // advice, because the file being written is not helped by it and a line
+  // that read as if it were would hide the overflow it is still heading for.
+  if (logger_ != nullptr) {
+    const EncoderEffortSummary& summary = effort_.summary();
+    const bool lowered = *step > previous_step;
+    const std::string readings =
+        std::to_string(static_cast<int>(ring_fraction * 100.0)) +
+        "% full with " + FormatDecimal(pending_seconds, 2) +
+        " s of capture waiting in the encoder";
+    logger_->Info(
+        "Advising level " + std::to_string(summary.advised_level) +
+        " for the next " + sink_->Name() + " file: " +
+        (lowered ? "the ring is " + readings
+                 : "the ring has been quiet long enough, now " + readings) +
+        ". This file stays at level " + std::to_string(summary.file_level) +
+        " (configured " + std::to_string(summary.configured_level) + ")" +
+        (lowered ? " and gets no relief from this." : "."));
+  }
+}
+
 double CapturePipeline::MeasureThroughput(uint64_t buffers_processed,
                                           double elapsed_seconds) {
   const size_t slot_bytes = (ring_ != nullptr) ? ring_->slot_size_bytes() : 0;
@@ -626,10 +835,12 @@ void CapturePipeline::PublishStats() {
 
   stats.transfers_completed = transfers_completed_.load();
   stats.buffers_processed = buffers_processed_.load();
+  stats.buffers_skipped = buffers_skipped_;
   stats.bytes_written = (sink_ != nullptr) ? sink_->BytesWritten() : 0;
   stats.samples_written = (sink_ != nullptr) ? sink_->SamplesWritten() : 0;
   stats.samples_pending = (sink_ != nullptr) ? sink_->SamplesPending() : 0;
   stats.writing = (sink_ != nullptr) && sink_->StoresData();
+  stats.encoder_effort = effort_.summary();
 
   // A run that has stopped keeps the last rate it measured. The clock carries
   // on through the join and the encoder's final frame while no further buffer
@@ -647,10 +858,14 @@ void CapturePipeline::PublishStats() {
     stats.slot_count = ring_->slot_count();
   }
 
-  stats.sequence_state = validator_.state();
+  stats.sequence_state = options_.wire_format == WireFormat::kPacked
+                             ? unpacker_.state()
+                             : validator_.state();
   stats.test_pattern_checked = test_pattern_checked_;
   stats.test_pattern_passed = !test_pattern_verifier_.HasFailed();
   stats.metrics = metrics_.Snapshot();
+  stats.dropouts = dropouts_.Summary();
+  stats.threads = thread_usage_publisher_.Read();
 
   // The device's account of its own capture buffer, and the totals built from
   // it.
@@ -663,8 +878,17 @@ void CapturePipeline::PublishStats() {
   const FpgaTelemetry telemetry =
       (source_ != nullptr) ? source_->DeviceTelemetry() : FpgaTelemetry{};
 
-  if (telemetry.present &&
-      (!device_buffer_seen_ || telemetry.latch_count != device_buffer_latch_)) {
+  // With in-band telemetry on, every figure but the near-full duration comes
+  // from the blocks instead, which cover every packet; adding the polled
+  // readings in as well would count every stall twice.
+  if (telemetry.present && options_.inband_telemetry) {
+    if (telemetry.latch_count != device_buffer_latch_) {
+      device_buffer_latch_ = telemetry.latch_count;
+      device_near_full_units_ += telemetry.near_full_units;
+    }
+  } else if (telemetry.present && (!device_buffer_seen_ ||
+                                   telemetry.latch_count !=
+                                       device_buffer_latch_)) {
     device_buffer_seen_ = true;
     device_buffer_latch_ = telemetry.latch_count;
 
@@ -708,7 +932,58 @@ void CapturePipeline::PublishStats() {
   stats_.Publish(stats);
 }
 
+void CapturePipeline::AccumulateInbandTelemetry() {
+  for (const InbandTelemetry& block : inband_blocks_) {
+    const FpgaTelemetry& reading = block.reading;
+    device_buffer_seen_ = true;
+
+    // The gateware counts a stall once however long it lasts, and a stall
+    // longer than a packet interval appears in more than one block
+    const bool dropping = reading.dropped_words > 0;
+    if (dropping && !inband_overflowing_) {
+      ++device_overflow_events_;
+    }
+    inband_overflowing_ = dropping;
+
+    device_dropped_words_ += reading.dropped_words;
+    peak_device_buffer_words_ =
+        std::max(peak_device_buffer_words_, reading.peak);
+    peak_back_pressure_percent_ =
+        std::max(peak_back_pressure_percent_, reading.BackPressurePercent());
+    device_back_pressure_.AddPercent(reading.BackPressurePercent());
+
+    if (logger_ == nullptr) {
+      continue;
+    }
+
+    // The point of the in-band block: the polled warning can say that samples
+    // were lost, and this one can say where. Once per run, because the
+    // capture is about to fail on the gap and every later drop is the same
+    // news.
+    if (dropping && !inband_drop_logged_) {
+      inband_drop_logged_ = true;
+      logger_->Warning(
+          "The device's capture buffer overflowed in packet " +
+          std::to_string(block.packet_number) + ": " +
+          std::to_string(reading.dropped_words) +
+          " samples lost before stream word " +
+          std::to_string(block.stream_word) +
+          ". The host is not taking packets fast enough.");
+    } else if (!dropping && !device_buffer_squeezed_ &&
+               reading.BackPressurePercent() >= kSqueezedBackPressure) {
+      device_buffer_squeezed_ = true;
+      logger_->Info("The device's capture buffer reached " +
+                    std::to_string(reading.PeakPercentOfDepth()) +
+                    "% in packet " + std::to_string(block.packet_number) +
+                    ", at stream word " + std::to_string(block.stream_word) +
+                    " — over half the room a stall is paid out of");
+    }
+  }
+}
+
 void CapturePipeline::TransferThread() {
+  thread_usage_.RegisterCurrentThread(ThreadAccounting::Role::kTransfer);
+
   std::unique_ptr<ScopedThreadPriority> priority;
   if (options_.elevate_priority) {
     priority = std::make_unique<ScopedThreadPriority>();
@@ -726,11 +1001,14 @@ void CapturePipeline::TransferThread() {
                     " source stopped: " + TransferResultDescription(result));
   }
 
+  thread_usage_.RetireCurrentThread();
   transfer_finished_ = true;
   control_signal_.notify_all();
 }
 
 void CapturePipeline::ProcessingThread() {
+  thread_usage_.RegisterCurrentThread(ThreadAccounting::Role::kProcessing);
+
   std::unique_ptr<ScopedThreadPriority> priority;
   if (options_.elevate_priority) {
     priority = std::make_unique<ScopedThreadPriority>();
@@ -740,9 +1018,29 @@ void CapturePipeline::ProcessingThread() {
   }
 
   const size_t slot_bytes = ring_->slot_size_bytes();
-  const size_t samples_per_slot = slot_bytes / kBytesPerSample;
+  const bool packed = options_.wire_format == WireFormat::kPacked;
+  const bool inband = options_.inband_telemetry;
+
+  // Sized here, once, rather than as slots arrive: this thread is on a
+  // deadline from its first slot, and an allocation is the one thing on it
+  // with no bound.
+  const size_t most_stripped_bytes =
+      inband ? InbandTelemetryStripper::MaximumBytesFor(slot_bytes)
+             : slot_bytes;
+  if (inband) {
+    stripped_.resize(most_stripped_bytes);
+    inband_blocks_.clear();
+    inband_blocks_.reserve(
+        InbandTelemetryStripper::MaximumBlocksFor(slot_bytes));
+  }
+  if (packed) {
+    unpacked_.resize(PackedUnpacker::MaximumSamplesFor(most_stripped_bytes) *
+                     kBytesPerSample);
+  }
   size_t slot_index = 0;
   uint64_t buffers_since_snapshot = 0;
+  uint64_t buffers_since_field_snapshot = 0;
+  uint64_t buffers_since_checked = 0;
 
   while (true) {
     if (abort_requested_.load()) {
@@ -769,12 +1067,174 @@ void CapturePipeline::ProcessingThread() {
     // pass over the buffer itself.
     ring_fill_.Add(ring_->SlotsInUse(), ring_->slot_count());
 
-    uint8_t* const data = ring_->SlotData(slot_index);
+    uint8_t* data = ring_->SlotData(slot_index);
+    size_t data_bytes = slot_bytes;
+
+    // In-band telemetry comes out before anything else, because the gateware
+    // puts a block at the head of every packet whatever the packet holds.
+    if (inband) {
+      inband_blocks_.clear();
+      const InbandTelemetryStripper::Outcome stripped = stripper_.Process(
+          data, data_bytes, stripped_.data(), inband_blocks_);
+      if (!stripped.ok) {
+        std::string detail;
+        if (!stripped.blocks_found) {
+          detail =
+              "No in-band telemetry blocks were found in the first " +
+              FormatBytes(InbandTelemetryStripper::kSynchronisationBytes) +
+              " of the stream, although the device reported sending them";
+        } else if (stripped.block_damaged) {
+          detail = "The in-band telemetry block " +
+                   std::to_string(stripped.fault_packet_index) +
+                   " packets into the stream, in buffer " +
+                   std::to_string(buffers_processed_.load()) +
+                   ", was damaged or missing";
+        } else {
+          detail = "Packet number mismatch " +
+                   std::to_string(stripped.fault_packet_index) +
+                   " packets into the stream, in buffer " +
+                   std::to_string(buffers_processed_.load()) + ": expected " +
+                   std::to_string(stripped.expected_packet) + ", got " +
+                   std::to_string(stripped.actual_packet);
+        }
+        LatchResult(TransferResult::kSequenceMismatch, detail);
+        ring_->MarkSlotFree(slot_index);
+        break;
+      }
+      data = stripped_.data();
+      data_bytes = stripped.data_bytes;
+      AccumulateInbandTelemetry();
+    }
 
-    const SequenceValidator::Outcome outcome =
-        validator_.Process(data, slot_bytes);
+    // Packed, the slot is unpacked first and everything below sees the words,
+    // whose count is whatever the blocks the slot completed held. A slot that
+    // completes none — the opening ones, while the unpacker gathers enough to
+    // lock on — passes through with nothing in it.
+    if (packed) {
+      const PackedUnpacker::Outcome unpacked =
+          unpacker_.Process(data, data_bytes, unpacked_.data());
+      if (!unpacked.ok) {
+        std::string detail;
+        if (!unpacked.headers_found) {
+          detail =
+              "No packed block headers were found in the first " +
+              FormatBytes(PackedUnpacker::kSynchronisationBytes) +
+              " of the stream, although the device reported the packed wire "
+              "format";
+        } else {
+          detail = "Block number mismatch " +
+                   std::to_string(unpacked.mismatch_block_index) +
+                   " blocks into the stream, in buffer " +
+                   std::to_string(buffers_processed_.load()) + ": expected " +
+                   std::to_string(unpacked.expected_block) + ", got " +
+                   std::to_string(unpacked.actual_block);
+          if (unpacked.synchronised_here) {
+            detail += ", and the unpacker locked on " +
+                      std::to_string(unpacked.synchronisation_byte_offset) +
+                      " bytes into this buffer";
+          }
+        }
+        LatchResult(TransferResult::kSequenceMismatch, detail);
+        ring_->MarkSlotFree(slot_index);
+        break;
+      }
+      data = unpacked_.data();
+      data_bytes = unpacked.sample_count * kBytesPerSample;
+    }
+    const size_t sample_count = data_bytes / kBytesPerSample;
+
+    const bool snapshot_due =
+        buffers_since_snapshot + 1 >= options_.snapshot_interval_buffers &&
+        data_bytes > 0;
+    const bool field_snapshot_due =
+        options_.field_snapshot_bytes > 0 && field_snapshots_->enabled() &&
+        buffers_since_field_snapshot + 1 >=
+            options_.field_snapshot_interval_buffers &&
+        data_bytes > 0;
+
+    // Where the waveform tap copies from: the head of the slot, unless a
+    // trigger is armed and a crossing somewhere in the slot leaves room for a
+    // window around it (see snapshot_trigger.h). Placed before the validator
+    // strips the markers from what it passes over; the search masks them off
+    // itself, so it reads the slot the same either way.
+    size_t snapshot_first = 0;
+    std::optional<double> snapshot_trigger;
+    if (snapshot_due) {
+      if (const std::optional<SnapshotTrigger> trigger =
+              snapshots_->ArmedTrigger()) {
+        const std::optional<TriggeredWindow> window = PlaceTriggeredWindow(
+            data, sample_count, snapshots_->snapshot_bytes() / kBytesPerSample,
+            *trigger);
+        if (window.has_value()) {
+          snapshot_first = window->first_sample;
+          snapshot_trigger = window->crossing;
+        }
+      }
+    }
+
+    // Monitoring on a share of the buffers. Decided after the sink change at
+    // the top of the loop, so a storing sink never sees a buffer that was not
+    // checked whole, and only once the validator is running, since a skipped
+    // buffer is checked against the phase it has locked on to.
+    ++buffers_since_checked;
+    const bool skip =
+        options_.monitor_validation_interval > 1 && !options_.test_mode &&
+        (sink_ == nullptr || !sink_->StoresData()) &&
+        validator_.state() == SequenceState::kRunning && !field_snapshot_due &&
+        buffers_since_checked < options_.monitor_validation_interval;
+
+    // The code histogram costs a fifth of the validator's pass, and the only
+    // thing that keeps it is a file's metadata. Counted for a storing sink,
+    // and for the buffers a histogram is published from so the session and
+    // recent figures stay a fair sample while only monitoring.
+    const bool count_codes =
+        (sink_ != nullptr && sink_->StoresData()) || snapshot_due;
+
+    SequenceValidator::Outcome outcome;
+    if (skip) {
+      // The window the waveform tap is about to copy is checked, stripped and
+      // measured as any buffer is, which is also what keeps the histograms
+      // moving. The rest has its counter changes checked and nothing else.
+      const size_t window_begin = snapshot_first * kBytesPerSample;
+      const size_t window_end =
+          snapshot_due
+              ? window_begin +
+                    (std::min(data_bytes - window_begin,
+                              snapshots_->snapshot_bytes()) /
+                     kBytesPerSample) *
+                        kBytesPerSample
+              : 0;
+      outcome = validator_.Skip(data, window_begin);
+      if (outcome.ok) {
+        outcome = validator_.Process(data + window_begin,
+                                     window_end - window_begin, count_codes);
+        if (!outcome.ok) {
+          outcome.mismatch_sample_index += snapshot_first;
+        }
+      }
+      if (outcome.ok) {
+        SequenceValidator::Outcome rest =
+            validator_.Skip(data + window_end, data_bytes - window_end);
+        if (!rest.ok) {
+          rest.mismatch_sample_index += window_end / kBytesPerSample;
+          rest.tally = outcome.tally;
+          outcome = rest;
+        }
+      }
+      ++buffers_skipped_;
+    } else {
+      outcome = validator_.Process(data, data_bytes, count_codes);
+      buffers_since_checked = 0;
+    }
     metrics_.Accumulate(outcome.tally);
 
+    // What the skipped part of the slot adds to the run's length. Without it
+    // the session's sample count, and the stream duration and rates worked
+    // out from it, would cover only the buffers that were measured.
+    if (skip && outcome.ok) {
+      metrics_.CountUnmeasured(sample_count - outcome.tally.sample_count);
+    }
+
     if (!outcome.ok) {
       // The counters alone say a capture is not bit-perfect. What follows
       // them says where to look: how far short of a full counter period the
@@ -795,6 +1255,11 @@ void CapturePipeline::ProcessingThread() {
                   " of this buffer, which opened on counter " +
                   std::to_string(outcome.first_counter);
       }
+      if (skip) {
+        detail +=
+            ". The buffer was being monitored on its counter changes alone, "
+            "so the samples went missing up to a counter period before that";
+      }
       LatchResult(TransferResult::kSequenceMismatch, detail);
       ring_->MarkSlotFree(slot_index);
       break;
@@ -802,7 +1267,7 @@ void CapturePipeline::ProcessingThread() {
 
     if (options_.test_mode) {
       test_pattern_checked_ = true;
-      if (!test_pattern_verifier_.FeedWireBytes(data, slot_bytes)) {
+      if (!test_pattern_verifier_.FeedWireBytes(data, data_bytes)) {
         const TestPatternVerifier::Result& verdict =
             test_pattern_verifier_.GetResult();
         LatchResult(TransferResult::kVerificationError,
@@ -816,21 +1281,52 @@ void CapturePipeline::ProcessingThread() {
       }
     }
 
+    // After the checks rather than fused into them: the validator's pass is a
+    // loop over words with a branch per marker, and this one is a loop over
+    // blocks with none, which only stays vectorised on its own. The slot is
+    // still in cache from the pass before.
+    if (options_.detect_dropouts && !options_.test_mode) {
+      if (skip) {
+        dropouts_.Skip(sample_count);
+      } else {
+        dropouts_.ProcessWireBytes(data, data_bytes);
+      }
+    }
+
     ++buffers_since_snapshot;
-    if (buffers_since_snapshot >= options_.snapshot_interval_buffers) {
-      snapshots_->Publish(data, slot_bytes);
+    if (snapshot_due) {
+      snapshots_->Publish(data + (snapshot_first * kBytesPerSample),
+                          data_bytes - (snapshot_first * kBytesPerSample),
+                          snapshot_trigger);
+      histograms_.Publish(metrics_.Histograms());
       buffers_since_snapshot = 0;
     }
 
-    if (sink_ != nullptr && !sink_->Write(data, samples_per_slot)) {
+    ++buffers_since_field_snapshot;
+    if (field_snapshot_due) {
+      field_snapshots_->Publish(data, data_bytes);
+      buffers_since_field_snapshot = 0;
+    }
+
+    if (sink_ != nullptr && sample_count > 0 &&
+        !sink_->Write(data, sample_count)) {
       LatchResult(TransferResult::kFileWriteError, sink_->LastError());
       ring_->MarkSlotFree(slot_index);
       break;
     }
 
+    // The tally the validator took on its way through, kept as the file's
+    // next block. After the write, so the overview describes only samples
+    // that reached the file.
+    if (overview_ != nullptr) {
+      overview_->Append(outcome.tally);
+    }
+
     ring_->MarkSlotFree(slot_index);
     buffers_processed_.fetch_add(1);
 
+    AdjustEncoderEffort();
+
     PublishStats();
 
     slot_index = (slot_index + 1) % ring_->slot_count();
@@ -840,8 +1336,27 @@ void CapturePipeline::ProcessingThread() {
     test_pattern_result_ = test_pattern_verifier_.GetResult();
   }
 
+  // A file still open when the run ends is finished by the control thread
+  // after the join, and never passes through a sink change. Its dropouts and
+  // overview are handed over here instead, while this thread still owns the
+  // detector and the builder. The overview by what it holds rather than by the
+  // detector's span, which only a sink change opens: a run started with a file
+  // already attached has blocks and no span.
+  if (dropouts_.capturing()) {
+    dropouts_.EndCaptureSpan();
+    const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+    retired_dropouts_ = dropouts_.TakeCaptureEvents();
+  }
+  if (overview_ != nullptr && !overview_->empty()) {
+    const std::lock_guard<std::mutex> guard(retired_sink_mutex_);
+    retired_overview_ = std::move(overview_);
+  }
+  effort_.End();
+
+  histograms_.Publish(metrics_.Histograms());
   PublishStats();
 
+  thread_usage_.RetireCurrentThread();
   processing_finished_ = true;
   control_signal_.notify_all();
 }
@@ -852,6 +1367,7 @@ void CapturePipeline::ControlThread() {
 
   auto last_progress_time = std::chrono::steady_clock::now();
   auto last_progress_log = last_progress_time;
+  auto last_thread_usage = last_progress_time;
   uint64_t last_transfer_count = 0;
 
   while (!processing_finished_.load()) {
@@ -872,6 +1388,21 @@ void CapturePipeline::ControlThread() {
       }
     }
 
+    // The scheduler's account of the workers, read here so that neither of
+    // them spends a buffer's deadline in /proc — the processing thread reads
+    // it only to retire the encoder's threads when a file closes (see
+    // ThreadAccounting). Published rather than folded in directly,
+    // because the statistics block has one writer and it is the processing
+    // thread.
+    if (options_.thread_usage_interval.count() > 0) {
+      const auto usage_now = std::chrono::steady_clock::now();
+      if (usage_now - last_thread_usage >= options_.thread_usage_interval) {
+        last_thread_usage = usage_now;
+        thread_usage_.Sample();
+        thread_usage_publisher_.Publish(thread_usage_.Totals());
+      }
+    }
+
     // The stall watchdog. A device that stops delivering without ever failing a
     // transfer is invisible to every other check here: no error is raised, no
     // thread returns, and the application simply waits. That is the failure
@@ -933,10 +1464,17 @@ void CapturePipeline::ControlThread() {
 
   // Close the file last, and only after both workers have stopped, so nothing
   // can be mid-write while the stream header is being patched.
-  if (sink_ != nullptr && !sink_->Finish()) {
-    LatchResult(TransferResult::kFileWriteError, sink_->LastError());
+  if (sink_ != nullptr) {
+    thread_usage_.RetireThreads(sink_->WorkerThreadIds());
+    if (!sink_->Finish()) {
+      LatchResult(TransferResult::kFileWriteError, sink_->LastError());
+    }
   }
 
+  // Every worker has taken its own last reading by now, so these are the
+  // run's final figures.
+  thread_usage_publisher_.Publish(thread_usage_.Totals());
+
   if (!result_latched_.load()) {
     result_ = TransferResult::kSuccess;
   }
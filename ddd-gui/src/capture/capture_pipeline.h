@@ -20,16 +20,23 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "capture_overview.h"
 #include "disk_buffer_ring.h"
+#include "dropout_detector.h"
+#include "encoder_effort.h"
 #include "fill_history.h"
+#include "inband_telemetry.h"
 #include "monitor_tap.h"
+#include "packed_unpacker.h"
 #include "sample_format.h"
 #include "sample_metrics.h"
 #include "sample_sink.h"
 #include "sample_source.h"
 #include "sequence_validator.h"
 #include "test_pattern_verifier.h"
+#include "thread_usage.h"
 #include "transfer_result.h"
 
 namespace ddd::capture {
@@ -66,6 +73,12 @@ class CapturePipeline {
     // Only meaningful when the device has been put into test mode.
     bool test_mode = false;
 
+    // Watch the RF envelope for dropouts. One more pass over each buffer, a
+    // slot at a time while it is still in cache; off only for a test that
+    // wants the processing thread doing nothing it does not need. A test-mode
+    // run is never watched whatever this says — a ramp has no envelope.
+    bool detect_dropouts = true;
+
     // Pin the ring into physical memory. Off only for tests that would
     // otherwise need a raised locked-memory limit to run.
     bool lock_memory = true;
@@ -99,6 +112,27 @@ class CapturePipeline {
 
     size_t snapshot_bytes = SnapshotPublisher::kDefaultSnapshotBytes;
 
+    // How many consumers the waveform tap takes at once: the displays, and
+    // room for whatever else wants to watch the signal alongside them. Each
+    // place is another snapshot-sized buffer in the pool, which at 64 KiB is
+    // nothing. The field tap stays at one, since its buffers are 2 MiB and the
+    // preview is the only thing that reads it.
+    size_t snapshot_reader_capacity = 4;
+
+    // The second tap, for the video preview: a long contiguous run of samples
+    // every this many buffers. Sixteen is about two a second at full rate,
+    // which is as many fields as a preview running on a share of one core
+    // will take, and a 2 MB copy twice a second is nothing the processing
+    // thread would notice.
+    //
+    // Off unless asked for, and then off again until field_snapshots() is
+    // enabled: three buffers of this size are 6 MiB, and a copy of 2 MiB
+    // every sixteen buffers is work done for a picture. A capture with nobody
+    // looking at it — the command line, the automatic capture, a GUI with the
+    // preview closed — should pay for neither.
+    uint64_t field_snapshot_interval_buffers = 16;
+    size_t field_snapshot_bytes = 0;
+
     // What the device is delivering, after whatever decimation the gateware is
     // doing. Nothing in the pipeline depends on it: it is how the log turns
     // counts into times and says what a measured rate should have been, and a
@@ -106,6 +140,50 @@ class CapturePipeline {
     // right for an undecimated capture and optimistic for any other.
     uint32_t sample_rate_hz = kSampleRateHz;
 
+    // How the device was asked to lay the samples out, and said it would.
+    // Packed slots go through a PackedUnpacker before anything else sees them,
+    // so every consumer downstream still gets one word per sample; what
+    // changes is how many samples a slot holds, and the wire rate the
+    // measured throughput is held against.
+    WireFormat wire_format = WireFormat::kWords;
+
+    // Every packet opens with the device's in-band telemetry block, as the
+    // device was asked for and said it would. The blocks are stripped before
+    // anything else sees the slot, packed or not, and their packet numbers are
+    // a continuity check of their own. Their readings replace the polled ones
+    // as the source of the run's device-buffer totals, because they cover
+    // every packet rather than a sample of them; the polled reading still
+    // drives the live display and the near-full duration.
+    bool inband_telemetry = false;
+
+    // While the sink stores nothing — monitoring — check and measure one
+    // buffer in this many, and account for the rest with
+    // SequenceValidator::Skip. One checks every buffer, as a capture always
+    // does.
+    //
+    // A monitoring session is a bench left running between discs, sometimes
+    // for hours, and passing over every sample of it proves nothing that is
+    // kept. Skipped buffers still have their counters checked where they
+    // change, so continuity is proved across them as surely as across a
+    // checked one; what they give up is the measurement, which is a
+    // statistical picture that a share of the signal draws as well as all of
+    // it. The waveform tap is fed as before, with the head of a skipped buffer
+    // checked and measured on its way there; a buffer the video preview wants
+    // is checked whole. The ramp of a test-mode run, a stream with no counters
+    // and a packed stream are checked in full whatever this says: each of
+    // those has a pass over every sample that this would not save.
+    //
+    // Sinks are swapped between buffers, so the buffer a file opens on is the
+    // first one back under full checking, and the one after a file closes is
+    // the first that may be skipped.
+    uint64_t monitor_validation_interval = 1;
+
+    // Advise the next file a lower compression level when the ring filled
+    // while this one was written, and a higher one again once it has drained.
+    // The file being written is never changed. See encoder_effort.h. Off only
+    // for a test that wants a file's size to depend on its samples alone.
+    bool adapt_encoder_effort = true;
+
     // How often the control thread logs a line of progress, at debug level.
     // Zero turns it off.
     //
@@ -116,6 +194,16 @@ class CapturePipeline {
     // is already awake on a timer and is on no deadline; the processing thread
     // never logs on a schedule (see logger.h).
     std::chrono::milliseconds progress_log_interval{10000};
+
+    // How often the control thread reads the worker threads' scheduling
+    // counters into the published statistics. Zero turns it off, and the
+    // threads' own final readings are still taken as they exit.
+    //
+    // A second, because these are totals that only ever climb and what is
+    // wanted from them is the shape of a run — a fault count that jumped ten
+    // minutes in — rather than a reading per buffer. Each sample is a few small
+    // reads per thread, on a thread with nothing else to do.
+    std::chrono::milliseconds thread_usage_interval{1000};
   };
 
   explicit CapturePipeline(ILogger* logger);
@@ -174,13 +262,54 @@ class CapturePipeline {
   // already. This is how a caller gets at a finished file's size and path.
   std::unique_ptr<ISampleSink> TakeRetiredSink();
 
+  // Take the dropouts the most recently closed file held, counted from its
+  // first sample, if they have not been taken already. Handed over with the
+  // sink when a file is detached, and when the run ends with one still open.
+  std::vector<DropoutEvent> TakeRetiredDropouts();
+
+  // Take the overview of the most recently closed file, gathered from the
+  // validator's tally of each of its buffers (see capture_overview.h). Handed
+  // over on the same terms as the dropouts, and empty once taken.
+  //
+  // Closed here, on the caller's thread: the processing thread hands over the
+  // builder as it stands, and the copy its Finish makes is made by whoever
+  // collects the file.
+  CaptureOverview TakeRetiredOverview();
+
+  // The step down its sink's effort ladder (ISampleSink::EffortLevels) the
+  // next file should open at: where the readings taken while the last
+  // adjustable file was written left it, or 0 before there has been one. Read
+  // by whoever opens the next sink, from any thread.
+  size_t EffortStepForNextFile() const { return next_effort_step_.load(); }
+
   // --- Observers -----------------------------------------------------------
 
   const StatsPublisher& stats() const { return stats_; }
+  // The waveform tap. Replaced when a run starts, so a Reader registered on it
+  // belongs to that run and must be let go before the next one. So does a
+  // trigger armed on it, which lines the run's snapshots up on a crossing
+  // found anywhere in the slot rather than on the slot's head.
   SnapshotPublisher& snapshots() { return *snapshots_; }
 
+  // The video preview's tap. Replaced when a run starts, like the waveform's,
+  // and starts each run disabled and holding no pool: it publishes only
+  // while enabled, and only if field_snapshot_bytes was set for the run.
+  SnapshotPublisher& field_snapshots() { return *field_snapshots_; }
+
+  // The code histograms, refreshed with the waveform snapshot, whenever a file
+  // is opened or closed, and once more when the run ends — so the histogram of
+  // a file just closed is there to be read as soon as its sink change has
+  // been counted.
+  const HistogramPublisher& histograms() const { return histograms_; }
+
   const DiskBufferRing* ring() const { return ring_.get(); }
 
+  // The samples a full slot of the ring carries in this run's wire format, or
+  // zero before the first run. A slot is bytes off the wire, and how many
+  // samples those are depends on the format and the in-band block (see
+  // SamplesInWireBytes). From the thread that starts the pipeline.
+  uint64_t SlotSamples() const;
+
   // The verifier's findings, valid once a test-mode capture has stopped
   const TestPatternVerifier::Result& test_pattern_result() const {
     return test_pattern_result_;
@@ -197,6 +326,11 @@ class CapturePipeline {
     return device_back_pressure_;
   }
 
+  // What each worker thread had from the scheduler over the run. Safe from
+  // anywhere; final once Wait() has returned, because each worker takes its
+  // own last reading on the way out.
+  CaptureThreadUsage thread_usage() const { return thread_usage_.Totals(); }
+
  private:
   class Control;
 
@@ -212,6 +346,12 @@ class CapturePipeline {
   void PerformPendingSinkChange();
   void PublishStats();
 
+  // Start deciding the effort for a sink that has just been attached, and
+  // read the ring after each buffer it is given. Processing thread only, like
+  // the sink itself.
+  void BeginEncoderEffort();
+  void AdjustEncoderEffort();
+
   // The lines that exist for a developer reading a log after the event rather
   // than for a user watching a window. Each is a no-op without a logger.
   void LogStartDetail();
@@ -222,6 +362,10 @@ class CapturePipeline {
   // What a measured throughput is worth comparing against.
   double ExpectedBytesPerSecond() const;
 
+  // Fold the in-band blocks the last slot carried into the run's device-buffer
+  // figures. Processing thread only.
+  void AccumulateInbandTelemetry();
+
   // The rate across the most recent window, or zero while there is not yet a
   // window's worth of history to measure across.
   double MeasureThroughput(uint64_t buffers_processed, double elapsed_seconds);
@@ -232,8 +376,24 @@ class CapturePipeline {
   ISampleSource* source_ = nullptr;
   std::unique_ptr<DiskBufferRing> ring_;
 
+  // A sink waiting to be swapped in, and the overview builder it will be fed
+  // to if it stores anything. Built together by AttachSink on the caller's
+  // thread, so that the builder's reservation is made there rather than on the
+  // processing thread, and only for a sink that will use it, and so that the
+  // two travel through the one atomic and cannot be paired up wrongly.
+  struct PendingSink {
+    std::unique_ptr<ISampleSink> sink;
+    std::unique_ptr<CaptureOverviewBuilder> overview;
+  };
+
+  // A builder reserved to the pipeline's limit for `sink`, or none if it does
+  // not store data, stamped with the run's sample rate so the overview can be
+  // timed. Called on the caller's thread, never the processing one.
+  std::unique_ptr<CaptureOverviewBuilder> OverviewBuilderFor(
+      const ISampleSink* sink) const;
+
   std::unique_ptr<ISampleSink> sink_;
-  std::atomic<ISampleSink*> pending_sink_{nullptr};
+  std::atomic<PendingSink*> pending_sink_{nullptr};
   std::atomic<bool> pending_detach_{false};
   std::atomic<uint64_t> sink_change_requests_{0};
   std::atomic<uint64_t> sink_change_count_{0};
@@ -245,6 +405,8 @@ class CapturePipeline {
   // it.
   mutable std::mutex retired_sink_mutex_;
   std::unique_ptr<ISampleSink> retired_sink_;
+  std::vector<DropoutEvent> retired_dropouts_;
+  std::unique_ptr<CaptureOverviewBuilder> retired_overview_;
 
   std::thread control_thread_;
   std::thread transfer_thread_;
@@ -272,7 +434,36 @@ class CapturePipeline {
 
   // Processing-thread state. Touched by that thread alone.
   SequenceValidator validator_;
+
+  // Buffers accounted for by SequenceValidator::Skip this run
+  uint64_t buffers_skipped_ = 0;
+
+  // Packed runs only. The unpacked words are what every consumer of a slot is
+  // handed in place of the slot itself; sized once, at the start of the
+  // processing thread, for the largest slot the unpacker can turn out.
+  PackedUnpacker unpacker_;
+  std::vector<uint8_t> unpacked_;
+
+  // In-band runs only, on the same terms: the stripped samples, and the blocks
+  // they were stripped of, both sized once for the largest slot.
+  InbandTelemetryStripper stripper_;
+  std::vector<uint8_t> stripped_;
+  std::vector<InbandTelemetry> inband_blocks_;
+
+  // Whether the previous packet dropped samples, so that a stall spanning
+  // several packets is one overflow event as the gateware counts it, and
+  // whether the first drop has been logged with where it landed.
+  bool inband_overflowing_ = false;
+  bool inband_drop_logged_ = false;
   SampleMetrics metrics_;
+  DropoutDetector dropouts_;
+
+  // The open file's overview, a block per buffer written to it. Present only
+  // while a storing sink is attached, which is also when no buffer is skipped,
+  // so every tally it is given covers the whole buffer. Arrives with its sink
+  // already reserved to its limit, so that feeding it allocates nothing (see
+  // CaptureOverviewBuilder), and leaves with it unfinished.
+  std::unique_ptr<CaptureOverviewBuilder> overview_;
   TestPatternVerifier test_pattern_verifier_;
   TestPatternVerifier::Result test_pattern_result_;
   bool test_pattern_checked_ = false;
@@ -328,11 +519,25 @@ class CapturePipeline {
   uint64_t capture_span_start_buffer_ = 0;
   std::chrono::steady_clock::time_point capture_span_start_time_;
 
+  // The effort advised for the next file, stepped with the ring's fill.
+  // Processing-thread state, published in CaptureStats; the step it settles on
+  // is copied out for the thread that opens the next file.
+  EncoderEffortController effort_;
+  std::atomic<size_t> next_effort_step_{0};
+
+  // The workers' scheduling counters. The accounting is sampled by the control
+  // thread and handed to the processing thread through the publisher, which
+  // is how they reach CaptureStats without either thread waiting on the other.
+  ThreadAccounting thread_usage_;
+  ThreadUsagePublisher thread_usage_publisher_;
+
   StatsPublisher stats_;
+  HistogramPublisher histograms_;
 
   // Behind a pointer because a run may ask for a different snapshot size than
   // the last one did, and a class holding atomics cannot be reassigned.
   std::unique_ptr<SnapshotPublisher> snapshots_;
+  std::unique_ptr<SnapshotPublisher> field_snapshots_;
 
   std::chrono::steady_clock::time_point start_time_;
 };
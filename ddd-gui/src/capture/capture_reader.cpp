@@ -37,6 +37,7 @@ struct CaptureReader::Impl {
   Format format = Format::kFlac;
   std::string last_error;
   std::optional<uint64_t> total_samples;
+  std::optional<uint32_t> sample_rate_hz;
   std::vector<std::pair<std::string, std::string>> tags;
 
   // Uncompressed
@@ -89,6 +90,17 @@ struct CaptureReader::Impl {
       impl->total_samples = metadata->data.stream_info.total_samples;
     }
 
+    // The header holds a label rather than the rate (see
+    // kFlacSampleRateLabel), and only a label this application writes says
+    // what the rate was.
+    if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
+      const uint32_t rate =
+          SampleRateHzForFlacLabel(metadata->data.stream_info.sample_rate);
+      if (rate != 0) {
+        impl->sample_rate_hz = rate;
+      }
+    }
+
     if (metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT) {
       const FLAC__StreamMetadata_VorbisComment& comment =
           metadata->data.vorbis_comment;
@@ -274,6 +286,10 @@ std::optional<uint64_t> CaptureReader::TotalSamples() const {
   return impl_->total_samples;
 }
 
+std::optional<uint32_t> CaptureReader::SampleRateHz() const {
+  return impl_->sample_rate_hz;
+}
+
 const std::vector<std::pair<std::string, std::string>>& CaptureReader::Tags()
     const {
   return impl_->tags;
@@ -33,10 +33,10 @@ namespace ddd::capture {
 // read here: not its ".raw" spelling of the uncompressed format, not the
 // packed 10-bit .lds, not the Ogg-encapsulated .ldf.
 //
-// A decimated capture reads back as the samples it holds and nothing else. The
-// rate a file was written at is in a FLAC header's label and in no part of an
-// uncompressed file at all, and neither is something this reader reports:
-// everything downstream of it counts samples.
+// A decimated capture reads back as the samples it holds and nothing else:
+// everything downstream of the reader counts samples. The rate a file was
+// written at is reported beside them where the file says, which a FLAC
+// header's label does and no part of an uncompressed file does.
 //
 // Thread-safety: none. One thread owns an instance for its lifetime.
 class CaptureReader {
@@ -77,6 +77,12 @@ class CaptureReader {
   // progress rather than a fabricated percentage.
   std::optional<uint64_t> TotalSamples() const;
 
+  // The rate the samples arrived at, in hertz, from the label in a FLAC
+  // file's STREAMINFO (see SampleRateHzForFlacLabel). Nothing for the
+  // uncompressed format, which has no header to say, and nothing for a label
+  // this application does not write.
+  std::optional<uint32_t> SampleRateHz() const;
+
   // Vorbis comments from the file, as name/value pairs, for FLAC inputs. Empty
   // for any other format or for a file that carries none. This is how a capture
   // says which build produced it once it has been separated from its metadata
@@ -0,0 +1,108 @@
+/************************************************************************
+
+    code_linearity.cpp
+
+    What a capture's code histogram says about the converter
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "code_linearity.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace ddd::capture {
+namespace {
+
+// Codes either side of the one being judged. Eight is wide enough that a
+// faulty neighbour or two cannot move the median far, and narrow enough that
+// the signal's own curvature across it is a fraction of a percent.
+constexpr size_t kNeighbourhood = 8;
+
+// What the neighbours' median has to reach before a code is judged against it.
+// A thousand is a counting noise of about 3%, so a reported DNL of 0.1 LSB is
+// a finding rather than luck.
+constexpr double kMinimumExpectedCount = 1000.0;
+
+}  // namespace
+
+LinearityProfile AnalyseLinearity(const CodeCounts& counts) {
+  LinearityProfile profile;
+
+  bool any = false;
+  for (size_t code = 0; code < kSampleCodeCount; ++code) {
+    if (counts[code] == 0) {
+      continue;
+    }
+    if (!any) {
+      profile.lowest_code = static_cast<uint16_t>(code);
+      any = true;
+    }
+    profile.highest_code = static_cast<uint16_t>(code);
+    profile.sample_count += counts[code];
+  }
+  if (!any) {
+    return profile;
+  }
+
+  // The rails are neither judged nor used as anybody's neighbour
+  constexpr size_t kFirstJudged = kMinimumSampleValue + 1;
+  constexpr size_t kLastJudged = kMaximumSampleValue - 1;
+
+  double sum_of_squares = 0.0;
+  std::array<uint64_t, 2 * kNeighbourhood> neighbours{};
+
+  for (size_t code = kFirstJudged; code <= kLastJudged; ++code) {
+    size_t found = 0;
+    for (size_t offset = 1; offset <= kNeighbourhood; ++offset) {
+      if (code >= kFirstJudged + offset) {
+        neighbours[found++] = counts[code - offset];
+      }
+      if (code + offset <= kLastJudged) {
+        neighbours[found++] = counts[code + offset];
+      }
+    }
+
+    // The median, as the mean of the middle two. Taking either one alone
+    // would be a code's worth of the signal's slope to one side, which on the
+    // flanks of a disc's histogram is a few percent.
+    const auto end = neighbours.begin() + static_cast<ptrdiff_t>(found);
+    const auto middle = neighbours.begin() + static_cast<ptrdiff_t>(found / 2);
+    std::nth_element(neighbours.begin(), middle, end);
+    const uint64_t upper = *middle;
+    const uint64_t lower =
+        found % 2 == 0 ? *std::max_element(neighbours.begin(), middle) : upper;
+    const double expected =
+        (static_cast<double>(lower) + static_cast<double>(upper)) / 2.0;
+    if (expected < kMinimumExpectedCount) {
+      continue;
+    }
+
+    const double dnl = (static_cast<double>(counts[code]) / expected) - 1.0;
+    ++profile.codes_assessed;
+    sum_of_squares += dnl * dnl;
+    if (std::abs(dnl) > std::abs(profile.worst_dnl)) {
+      profile.worst_dnl = dnl;
+      profile.worst_dnl_code = static_cast<uint16_t>(code);
+    }
+    if (counts[code] == 0) {
+      profile.missing_codes.push_back(static_cast<uint16_t>(code));
+    }
+  }
+
+  if (profile.codes_assessed == 0) {
+    return profile;
+  }
+
+  profile.known = true;
+  profile.rms_dnl =
+      std::sqrt(sum_of_squares / static_cast<double>(profile.codes_assessed));
+  return profile;
+}
+
+}  // namespace ddd::capture
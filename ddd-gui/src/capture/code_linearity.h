@@ -0,0 +1,72 @@
+/************************************************************************
+
+    code_linearity.h
+
+    What a capture's code histogram says about the converter
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sample_metrics.h"
+
+namespace ddd::capture {
+
+// The converter's differential linearity, as far as one capture's histogram
+// can show it.
+//
+// **Against the neighbours, not against a model of the input.** The textbook
+// code-density test feeds the converter a known signal — a ramp, or a sine
+// whose histogram is worked out in advance — and measures each code against
+// what that signal predicts. A disc is not a known signal. What it is, is a
+// smooth one: over a handful of codes its histogram barely changes, while a
+// converter fault is a single code, or every other code, or every sixty-fourth
+// one. So each code is compared with the median of the eight codes either side
+// of it, and the difference is the code's DNL.
+//
+// That finds what goes wrong with a converter in service — a missing code, a
+// stuck bit, an odd-even pattern, a code twice as wide as its neighbours — and
+// cannot see a slow bow across the whole range, which an honest signal would
+// hide just as well. Integral linearity needs a ramp, and this does not claim
+// it.
+//
+// Only codes whose neighbours saw enough samples to be worth comparing with
+// are judged: a code in the thin tail of the signal, expected to turn up five
+// times and turning up twice, is counting noise and not a fault. The two rail
+// codes are never judged, since clipping piles samples onto them.
+struct LinearityProfile {
+  // False when no code saw enough to be judged — no signal, or too little of
+  // it. The sample count and the occupied range are filled in regardless, and
+  // the judgements below are zero.
+  bool known = false;
+
+  uint64_t sample_count = 0;
+
+  // The lowest and highest code with anything in them, rails included
+  uint16_t lowest_code = 0;
+  uint16_t highest_code = 0;
+
+  // How many codes had enough around them to be judged
+  uint32_t codes_assessed = 0;
+
+  // The judged code furthest from its neighbours, and by how much, in LSB:
+  // -1 is a missing code, +1 a code twice the width it should be.
+  double worst_dnl = 0.0;
+  uint16_t worst_dnl_code = 0;
+
+  // The spread of DNL across every judged code
+  double rms_dnl = 0.0;
+
+  // Judged codes that never turned up at all, in ascending order
+  std::vector<uint16_t> missing_codes;
+};
+
+LinearityProfile AnalyseLinearity(const CodeCounts& counts);
+
+}  // namespace ddd::capture
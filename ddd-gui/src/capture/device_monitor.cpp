@@ -18,8 +18,9 @@
 
 namespace ddd::capture {
 
-DeviceMonitor::DeviceMonitor(IUsbDevice* device, ILogger* logger)
-    : device_(device), logger_(logger) {}
+DeviceMonitor::DeviceMonitor(IUsbDevice* device, ILogger* logger,
+                             std::unique_ptr<IHotplugEvents> events)
+    : device_(device), logger_(logger), events_(std::move(events)) {}
 
 DeviceMonitor::~DeviceMonitor() { Stop(); }
 
@@ -29,7 +30,25 @@ void DeviceMonitor::Start(Callback on_change,
 
   on_change_ = std::move(on_change);
   poll_count_ = 0;
+  wake_requested_ = false;
+  event_arrived_ = false;
   running_ = true;
+
+  // Started before the thread, so that a device arriving between the first
+  // enumeration and the first wait is still an event rather than something
+  // nobody hears about.
+  listening_ = events_ != nullptr &&
+               events_->Start([this](HotplugEvent event) {
+                 OnHotplugEvent(event);
+               });
+  if (logger_ != nullptr) {
+    logger_->Info(listening_.load()
+                      ? std::string("Watching for devices through ") +
+                            events_->Name() + " events"
+                      : "Polling for devices every " +
+                            std::to_string(interval.count()) + " ms");
+  }
+
   thread_ = std::thread(&DeviceMonitor::Loop, this, interval);
 }
 
@@ -38,7 +57,13 @@ void DeviceMonitor::Stop() {
     return;
   }
 
-  wake_.notify_all();
+  // Before the join, so that no event can arrive for a monitor that has gone.
+  if (events_ != nullptr) {
+    events_->Stop();
+  }
+  listening_ = false;
+
+  Wake();
   if (thread_.joinable()) {
     thread_.join();
   }
@@ -53,11 +78,27 @@ void DeviceMonitor::SetSuspended(bool suspended) {
   // because the reason for resuming is usually that a capture has just ended
   // and the user is looking at the device list again.
   if (!suspended) {
-    wake_requested_ = true;
-    wake_.notify_all();
+    Wake();
   }
 }
 
+void DeviceMonitor::OnHotplugEvent(HotplugEvent event) {
+  if (event == HotplugEvent::kLost) {
+    listening_ = false;
+  } else {
+    event_arrived_ = true;
+  }
+  Wake();
+}
+
+void DeviceMonitor::Wake() {
+  wake_requested_ = true;
+  {
+    const std::lock_guard<std::mutex> guard(mutex_);
+  }
+  wake_.notify_all();
+}
+
 std::vector<DeviceInfo> DeviceMonitor::Devices() const {
   const std::lock_guard<std::mutex> guard(mutex_);
   return devices_;
@@ -65,6 +106,7 @@ std::vector<DeviceInfo> DeviceMonitor::Devices() const {
 
 void DeviceMonitor::Loop(std::chrono::milliseconds interval) {
   bool announced = false;
+  std::chrono::steady_clock::time_point settle_until{};
 
   while (running_.load()) {
     if (!suspended_.load() && device_ != nullptr) {
@@ -98,10 +140,22 @@ void DeviceMonitor::Loop(std::chrono::milliseconds interval) {
       }
     }
 
+    // Polling when there are no events, and for a while after each one; an
+    // untimed wait otherwise, which is the point — nothing wakes this thread
+    // while nothing happens on the bus.
     std::unique_lock<std::mutex> lock(mutex_);
-    wake_.wait_for(lock, interval, [this] {
+    const auto woken = [this] {
       return !running_.load() || wake_requested_.load();
-    });
+    };
+    if (!listening_.load() ||
+        std::chrono::steady_clock::now() < settle_until) {
+      wake_.wait_for(lock, interval, woken);
+    } else {
+      wake_.wait(lock, woken);
+    }
+    if (event_arrived_.exchange(false)) {
+      settle_until = std::chrono::steady_clock::now() + kSettleWindow;
+    }
     wake_requested_ = false;
   }
 }
@@ -15,11 +15,13 @@
 #include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 #include "usb_device_info.h"
+#include "usb_hotplug.h"
 
 namespace ddd::capture {
 
@@ -29,14 +31,28 @@ class IUsbDevice;
 // Watches for devices appearing and disappearing, and says so when the set
 // changes.
 //
-// Polling rather than a hot-plug callback, and that is a choice rather than an
-// omission. libusb has libusb_hotplug_register_callback, but it is unsupported
-// on Windows and its macOS behaviour has historically depended on the libusb
-// build; WinUSB has no equivalent at all and would need a window handle and a
-// device-notification message pump. Polling is the one mechanism that behaves
-// identically on all three platforms, and at 200 ms it costs a device
-// enumeration five times a second — measured in microseconds — to meet a
-// 500 ms detection requirement with room to spare.
+// Told where it can be, polling where it cannot. On Linux an IHotplugEvents
+// source — the kernel's own uevents over netlink — wakes the monitor the moment
+// a device of ours arrives or leaves, and between events the thread sleeps
+// without a timeout: no enumeration, and no wake-up, for as long as nothing
+// changes. An attach is reported in the milliseconds it takes to enumerate
+// rather than in up to one interval.
+//
+// Polling is the fallback and stays the whole answer elsewhere. libusb's
+// libusb_hotplug_register_callback is unsupported on Windows and its macOS
+// behaviour has historically depended on the libusb build; WinUSB has no
+// equivalent at all and would need a window handle and a device-notification
+// message pump. Polling behaves identically on all three platforms, and at
+// 200 ms it costs a device enumeration five times a second — measured in
+// microseconds — to meet a 500 ms detection requirement with room to spare.
+// It is also what happens on Linux when the events cannot arrive (see
+// UeventsCanArrive) or the source stops delivering them.
+//
+// An event is a reason to look, not a description of what is there: it
+// arrives from the kernel before udev has applied permissions and before
+// libusb's own hot-plug thread has updated its list, so the first enumeration
+// after one can see too little. For kSettleWindow after each event the monitor
+// therefore keeps polling at the ordinary interval, and only then goes quiet.
 //
 // It runs on its own thread because enumeration is not instant: reading a
 // product string means opening the device and doing a control transfer, and on
@@ -54,7 +70,16 @@ class DeviceMonitor {
   // asks for, even if a poll lands just after the device appears.
   static constexpr std::chrono::milliseconds kDefaultInterval{200};
 
-  DeviceMonitor(IUsbDevice* device, ILogger* logger);
+  // How long polling continues after an event. Long enough for udev's rules
+  // and libusb's own event thread to have caught up with the kernel; short
+  // enough that a device arriving costs a handful of enumerations rather than
+  // a return to five a second.
+  static constexpr std::chrono::milliseconds kSettleWindow{1000};
+
+  // `events` may be null, and is where the platform has none: the monitor then
+  // polls exactly as it always has.
+  DeviceMonitor(IUsbDevice* device, ILogger* logger,
+                std::unique_ptr<IHotplugEvents> events = nullptr);
   ~DeviceMonitor();
 
   DeviceMonitor(const DeviceMonitor&) = delete;
@@ -62,7 +87,7 @@ class DeviceMonitor {
   DeviceMonitor(DeviceMonitor&&) = delete;
   DeviceMonitor& operator=(DeviceMonitor&&) = delete;
 
-  // Begin polling. The callback fires once with the initial set and then only
+  // Begin watching. The callback fires once with the initial set and then only
   // when the set changes — a panel that redrew five times a second whether or
   // not anything had happened would be a needless waste on a machine that is
   // otherwise trying to sustain 80 MB/s.
@@ -71,6 +96,11 @@ class DeviceMonitor {
 
   void Stop();
 
+  // Is the monitor being told about changes, rather than polling for them?
+  // False before Start(), where there is no event source, and after one has
+  // been lost.
+  bool listening() const { return listening_.load(); }
+
   // Stop enumerating without stopping the monitor.
   //
   // Set while a capture is running. Enumeration opens devices to read their
@@ -92,9 +122,17 @@ class DeviceMonitor {
 
  private:
   void Loop(std::chrono::milliseconds interval);
+  void OnHotplugEvent(HotplugEvent event);
+
+  // Set the wake flag and notify, with the mutex taken in between. Needed now
+  // that the monitor can wait with no timeout: a notification landing between
+  // the wait's predicate check and its going to sleep would otherwise be lost,
+  // and with it the wake-up, for good.
+  void Wake();
 
   IUsbDevice* device_ = nullptr;
   ILogger* logger_ = nullptr;
+  std::unique_ptr<IHotplugEvents> events_;
 
   Callback on_change_;
 
@@ -108,6 +146,11 @@ class DeviceMonitor {
   // because a condition variable woken by a notification whose predicate is
   // still false simply goes back to sleep for the remaining time.
   std::atomic<bool> wake_requested_{false};
+
+  // Set by an event, so that the loop knows to open a settle window as well as
+  // to enumerate.
+  std::atomic<bool> event_arrived_{false};
+  std::atomic<bool> listening_{false};
   std::atomic<uint64_t> poll_count_{0};
 
   std::vector<DeviceInfo> devices_;
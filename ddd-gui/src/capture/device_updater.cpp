@@ -205,6 +205,41 @@ class UsbDeviceUpdater : public IDeviceUpdater {
     return sent == static_cast<int>(chunk_.size());
   }
 
+  uint64_t SendChunks(UpdateTarget target, std::span<const uint8_t> payload,
+                      uint64_t chunk_bytes, size_t depth,
+                      const std::function<bool(uint64_t sent)>& on_sent)
+      override {
+    if (channel_ == nullptr || chunk_bytes == 0) {
+      return 0;
+    }
+
+    // Described up front rather than as they go, because the whole point is
+    // that the channel has the next few in hand before the last has finished.
+    // The spans point into the payload, so this is a few words a chunk.
+    std::vector<ControlWrite> writes;
+    writes.reserve(static_cast<size_t>((payload.size() + chunk_bytes - 1) /
+                                       chunk_bytes));
+    for (uint64_t offset = 0; offset < payload.size(); offset += chunk_bytes) {
+      ControlWrite write;
+      write.value = static_cast<uint16_t>(writes.size());
+      write.index = TargetIndex(target);
+      write.data = payload.subspan(
+          offset, std::min<uint64_t>(chunk_bytes, payload.size() - offset));
+      writes.push_back(write);
+    }
+
+    const auto sent_after = [&payload, chunk_bytes](size_t chunks) {
+      return std::min<uint64_t>(chunks * chunk_bytes, payload.size());
+    };
+
+    const size_t completed = channel_->TransferQueued(
+        kVendorWriteRequestType, kUpdateDataRequest, writes, depth,
+        kWriteTimeoutMilliseconds, [&on_sent, &sent_after](size_t chunks) {
+          return !on_sent || on_sent(sent_after(chunks));
+        });
+    return sent_after(completed);
+  }
+
   bool Finish(UpdateTarget target) override {
     if (channel_ == nullptr) {
       return false;
@@ -324,6 +359,30 @@ class UsbDeviceUpdater : public IDeviceUpdater {
 
 }  // namespace
 
+uint64_t IDeviceUpdater::SendChunks(
+    UpdateTarget target, std::span<const uint8_t> payload,
+    uint64_t chunk_bytes, size_t /*depth*/,
+    const std::function<bool(uint64_t sent)>& on_sent) {
+  if (chunk_bytes == 0) {
+    return 0;
+  }
+
+  uint64_t sent = 0;
+  uint16_t index = 0;
+  while (sent < payload.size()) {
+    const uint64_t span = std::min(chunk_bytes, payload.size() - sent);
+    if (!SendChunk(target, index, payload.subspan(sent, span))) {
+      break;
+    }
+    sent += span;
+    ++index;
+    if (on_sent && !on_sent(sent)) {
+      break;
+    }
+  }
+  return sent;
+}
+
 bool DeviceIdentity::GatewareIsRecovery() const {
   // The same rule FpgaVersion applies to the same registers, and it has to
   // be: a role byte read from a gateware that did not answer is a byte that
@@ -12,7 +12,9 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
@@ -181,7 +183,8 @@ struct DeviceIdentity {
 // worker thread, never from a user interface thread.
 //
 // Thread-safety: NOT thread-safe. One thread owns an updater for its
-// lifetime.
+// lifetime. Several updaters, one per device, may be driven from several
+// threads at once — see RunUpdateOnEach.
 class IDeviceUpdater {
  public:
   IDeviceUpdater() = default;
@@ -211,6 +214,22 @@ class IDeviceUpdater {
   virtual bool SendChunk(UpdateTarget target, uint16_t index,
                          std::span<const uint8_t> data) = 0;
 
+  // 0xD2, the whole payload: cut into `chunk_bytes` pieces indexed from zero,
+  // with up to `depth` of them in flight at once where the transport can
+  // queue them.
+  //
+  // `on_sent` is called with the bytes accepted so far as each chunk
+  // completes, in order; returning false stops any more being sent. Returns
+  // the bytes the device accepted, which is the whole payload unless a chunk
+  // was refused or the caller stopped it.
+  //
+  // The default sends one chunk at a time through SendChunk, which is exact
+  // at depth one and what an implementation with nothing to queue on needs.
+  virtual uint64_t SendChunks(
+      UpdateTarget target, std::span<const uint8_t> payload,
+      uint64_t chunk_bytes, size_t depth,
+      const std::function<bool(uint64_t sent)>& on_sent);
+
   // 0xD3. Returns whether the request was accepted, which is not whether
   // the update succeeded — the device reads the written region back off
   // the medium afterwards, and the result of that is read with 0xD0.
@@ -0,0 +1,273 @@
+/************************************************************************
+
+    dropout_detector.cpp
+
+    Where the RF went away, found while the capture is still running
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "dropout_detector.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+namespace ddd::capture {
+namespace {
+
+// The envelope's block: 0.8 µs, which is 32 samples at full rate and five and
+// a half cycles of PAL's sync tip, the lowest frequency the carrier reaches.
+constexpr double kBlockSeconds = 0.8e-6;
+
+// Never fewer than this, whatever the rate. Below it the carrier no longer
+// averages out of a block, and the envelope ripples by more than a shallow
+// dropout is deep.
+constexpr size_t kShortestBlock = 4;
+
+// How long the reference remembers, and how much of that it has to have seen
+// before a dropout can be called against it.
+constexpr double kReferenceSeconds = 2.0e-3;
+constexpr double kSettleFraction = 0.25;
+
+// A dropout begins below this fraction of the reference and ends above the
+// second. See the class comment for why there are two.
+constexpr double kEnterFraction = 0.4;
+constexpr double kLeaveFraction = 0.6;
+
+// A mean envelope below this many codes is no signal at all: the converter's
+// own noise with nothing in front of it is a couple of codes, and a disc at
+// its nominal level is over two hundred. A detector with nothing to compare
+// against disarms rather than reporting the silence as one long dropout.
+constexpr double kMinimumEnvelopeCodes = 8.0;
+
+// Nothing on a disc takes the RF away for a whole field. A collapse that
+// lasts this long is the signal going away — the player stopped, searching,
+// or the gain changed under it — so it is closed here, and the reference is
+// learned again from whatever the signal has become.
+constexpr double kLongestDropoutSeconds = 0.02;
+
+// Wire bytes are turned into sample values this many at a time, in a buffer
+// that stays in the first-level cache, rather than in one pass over the whole
+// slot.
+constexpr size_t kWireChunkSamples = 4096;
+
+}  // namespace
+
+DropoutDetector::DropoutDetector(const Options& options) {
+  const double rate = options.sample_rate_hz == 0
+                          ? static_cast<double>(kSampleRateHz)
+                          : static_cast<double>(options.sample_rate_hz);
+  block_samples_ = std::max(
+      kShortestBlock, static_cast<size_t>(std::lround(kBlockSeconds * rate)));
+
+  const double block_seconds = static_cast<double>(block_samples_) / rate;
+  reference_blocks_ = std::max(1.0, kReferenceSeconds / block_seconds);
+  settle_blocks_ =
+      static_cast<uint64_t>(std::ceil(reference_blocks_ * kSettleFraction));
+  longest_dropout_samples_ =
+      static_cast<uint64_t>(std::llround(kLongestDropoutSeconds * rate));
+
+  capture_events_.reserve(kMaximumCaptureEvents);
+}
+
+void DropoutDetector::ProcessWireBytes(const uint8_t* wire_data,
+                                       size_t byte_count) {
+  std::array<uint16_t, kWireChunkSamples> chunk;
+  size_t remaining = byte_count / kBytesPerSample;
+  while (remaining > 0) {
+    const size_t count = std::min(remaining, chunk.size());
+    for (size_t index = 0; index < count; ++index) {
+      const size_t offset = index * kBytesPerSample;
+      chunk[index] = SampleValueFromWord(static_cast<uint16_t>(
+          static_cast<uint16_t>(wire_data[offset]) |
+          static_cast<uint16_t>(static_cast<uint16_t>(wire_data[offset + 1])
+                                << 8)));
+    }
+    Process(chunk.data(), count);
+    wire_data += count * kBytesPerSample;
+    remaining -= count;
+  }
+}
+
+void DropoutDetector::Process(const uint16_t* samples, size_t count) {
+  size_t index = 0;
+
+  // Finish the block the previous run left open
+  if (partial_count_ > 0) {
+    while (index < count && partial_count_ < block_samples_) {
+      partial_sum_ += static_cast<uint32_t>(
+          std::abs(static_cast<int32_t>(samples[index]) - kSampleZeroOffset));
+      ++partial_count_;
+      ++index;
+    }
+    if (partial_count_ == block_samples_) {
+      Classify(static_cast<double>(partial_sum_) /
+                   static_cast<double>(block_samples_),
+               partial_start_);
+      partial_sum_ = 0;
+      partial_count_ = 0;
+    }
+  }
+
+  // Whole blocks, straight from the caller's buffer. The inner loop is the
+  // whole cost of the detector and is written to be vectorised: fixed-length,
+  // no branches, no dependence between iterations but the sum.
+  for (; index + block_samples_ <= count; index += block_samples_) {
+    const uint16_t* const block = samples + index;
+    uint32_t sum = 0;
+    for (size_t offset = 0; offset < block_samples_; ++offset) {
+      sum += static_cast<uint32_t>(
+          std::abs(static_cast<int32_t>(block[offset]) - kSampleZeroOffset));
+    }
+    Classify(static_cast<double>(sum) / static_cast<double>(block_samples_),
+             samples_seen_ + index);
+  }
+
+  // And start the next block with whatever is left
+  if (index < count) {
+    if (partial_count_ == 0) {
+      partial_start_ = samples_seen_ + index;
+    }
+    for (; index < count; ++index) {
+      partial_sum_ += static_cast<uint32_t>(
+          std::abs(static_cast<int32_t>(samples[index]) - kSampleZeroOffset));
+      ++partial_count_;
+    }
+  }
+
+  samples_seen_ += count;
+}
+
+void DropoutDetector::Skip(size_t count) {
+  partial_sum_ = 0;
+  partial_count_ = 0;
+  if (in_dropout_) {
+    Close(samples_seen_);
+  }
+  samples_seen_ += count;
+}
+
+void DropoutDetector::Classify(double envelope, uint64_t block_start) {
+  if (!armed_) {
+    // Learning: a plain mean of everything so far, until there is enough of it
+    // to trust, and then the same slow average the armed detector keeps
+    ++reference_count_;
+    reference_ += (envelope - reference_) /
+                  std::min(static_cast<double>(reference_count_),
+                           reference_blocks_);
+    armed_ = reference_count_ >= settle_blocks_ &&
+             reference_ >= kMinimumEnvelopeCodes;
+    return;
+  }
+
+  if (in_dropout_) {
+    if (envelope > kLeaveFraction * reference_) {
+      Close(block_start);
+      return;
+    }
+    const uint64_t block_end = block_start + block_samples_;
+    if (block_end - dropout_start_ >= longest_dropout_samples_) {
+      Close(block_end);
+      armed_ = false;
+      reference_ = 0.0;
+      reference_count_ = 0;
+    }
+    return;
+  }
+
+  if (envelope < kEnterFraction * reference_) {
+    in_dropout_ = true;
+    dropout_start_ = block_start;
+    return;
+  }
+
+  reference_ += (envelope - reference_) / reference_blocks_;
+  if (reference_ < kMinimumEnvelopeCodes) {
+    // Faded away rather than collapsed. Nothing to compare against any more,
+    // so learn again from whatever comes next.
+    armed_ = false;
+    reference_count_ = 0;
+  }
+}
+
+void DropoutDetector::Close(uint64_t end_sample) {
+  in_dropout_ = false;
+
+  const uint64_t duration = end_sample - dropout_start_;
+  ++event_count_;
+  dropout_samples_ += duration;
+  longest_samples_ = std::max(longest_samples_, duration);
+  last_start_ = dropout_start_;
+
+  if (!capturing_) {
+    return;
+  }
+
+  // A dropout already under way when the file opened is the file's from its
+  // first sample, and no earlier
+  const uint64_t start = std::max(dropout_start_, capture_start_);
+  if (end_sample <= start) {
+    return;
+  }
+  ++capture_event_count_;
+  capture_dropout_samples_ += end_sample - start;
+  if (capture_events_.size() < kMaximumCaptureEvents) {
+    capture_events_.push_back({start - capture_start_, end_sample - start});
+  }
+}
+
+DropoutSummary DropoutDetector::Summary() const {
+  DropoutSummary summary;
+  summary.armed = armed_;
+  summary.event_count = event_count_;
+  summary.dropout_samples = dropout_samples_;
+  summary.longest_samples = longest_samples_;
+  summary.last_start_sample = last_start_;
+  summary.capture_event_count = capture_event_count_;
+  summary.capture_dropout_samples = capture_dropout_samples_;
+  return summary;
+}
+
+void DropoutDetector::BeginCaptureSpan() {
+  capturing_ = true;
+  capture_start_ = samples_seen_;
+  capture_event_count_ = 0;
+  capture_dropout_samples_ = 0;
+  capture_events_.clear();
+}
+
+void DropoutDetector::EndCaptureSpan() {
+  if (!capturing_) {
+    return;
+  }
+
+  // The part of a dropout in progress that the file holds. The dropout itself
+  // carries on and is counted in the run's totals when it ends; the file has
+  // finished and what it got is all it will ever get.
+  if (in_dropout_) {
+    const uint64_t start = std::max(dropout_start_, capture_start_);
+    if (samples_seen_ > start) {
+      ++capture_event_count_;
+      capture_dropout_samples_ += samples_seen_ - start;
+      if (capture_events_.size() < kMaximumCaptureEvents) {
+        capture_events_.push_back(
+            {start - capture_start_, samples_seen_ - start});
+      }
+    }
+  }
+
+  capturing_ = false;
+}
+
+std::vector<DropoutEvent> DropoutDetector::TakeCaptureEvents() {
+  std::vector<DropoutEvent> events(capture_events_.begin(),
+                                   capture_events_.end());
+  capture_events_.clear();
+  return events;
+}
+
+}  // namespace ddd::capture
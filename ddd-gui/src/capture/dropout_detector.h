@@ -0,0 +1,211 @@
+/************************************************************************
+
+    dropout_detector.h
+
+    Where the RF went away, found while the capture is still running
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sample_format.h"
+
+namespace ddd::capture {
+
+// One dropout: where the RF envelope collapsed, and for how long.
+//
+// In samples rather than in seconds, because a sample index is what the tools
+// downstream seek by and it means the same thing in the file whatever rate the
+// file was written at. The list a file's sidecar carries counts from the file's
+// first sample; the live one counts from the start of the run.
+struct DropoutEvent {
+  uint64_t start_sample = 0;
+  uint64_t duration_samples = 0;
+};
+
+// What the Statistics panel shows about dropouts, in one value small enough to
+// travel inside CaptureStats and be published with everything else.
+//
+// Totals rather than the events themselves. A damaged side can have thousands
+// of them, and the statistics block is copied out by a reader several times a
+// second; what somebody watching a capture wants is whether the figure is
+// climbing, which a count and a total say at a glance.
+struct DropoutSummary {
+  // False until the detector has seen enough signal to know what a normal
+  // envelope is, and false again whenever there is no signal to speak of — the
+  // player stopped, the tray open. Zero dropouts from a detector that is not
+  // armed is not a clean disc, and the panel says so.
+  bool armed = false;
+
+  // Over the whole run
+  uint64_t event_count = 0;
+  uint64_t dropout_samples = 0;
+  uint64_t longest_samples = 0;
+
+  // Where the most recent one started, in samples since the run began. How the
+  // panel tells a figure that has just moved from one that stopped moving a
+  // minute ago.
+  uint64_t last_start_sample = 0;
+
+  // Over the samples that went into the file, on the same terms as
+  // SampleMetricsSnapshot's capture_ figures: zero until a capture has run,
+  // frozen when the file closes.
+  uint64_t capture_event_count = 0;
+  uint64_t capture_dropout_samples = 0;
+};
+
+// Finds dropouts in the RF as it goes past: the signal's envelope falling far
+// below what it has been, because a scratch, a speck or a patch of rot has
+// passed under the pickup.
+//
+// This is the quality figure for a capture, and until now it only existed
+// after a full decode — by which time the disc is back on the shelf. Found
+// here, a side with a bad patch is known about while it is still in the
+// player.
+//
+// **The envelope** is the signal rectified about mid-scale and averaged over
+// blocks of just under a microsecond — a few cycles of the lowest carrier the
+// disc uses, so the FM itself averages out and a collapse shows as one. That is
+// the low-pass and the decimation in one step: the mean of each block is a
+// sample of the envelope at a thirty-second of the rate, and it is the only
+// thing the detector looks at afterwards. The loop that takes it does nothing
+// but widen, subtract, take an absolute value and add, which the compiler
+// vectorises without being asked.
+//
+// **The threshold adapts.** The envelope is not a fixed level: it changes with
+// radius, with the player, with the front-end gain, and across a side by more
+// than a dropout is deep. So each block is compared with a slow running mean
+// of the blocks before it — a couple of milliseconds of memory, long against
+// any dropout and short against everything that changes the level honestly —
+// and a dropout is a block below 40% of it. It ends at 60%: the gap is what
+// stops a marginal patch from being reported as a dozen dropouts in a row.
+// The mean is not updated inside a dropout, or a long one would lower the
+// threshold underneath itself.
+//
+// Positions are to the block, which is 0.8 µs at full rate: finer than any
+// decoder's own dropout handling needs, and coarser than the alternative would
+// cost.
+//
+// Thread-safety: none. Owned and driven by the processing thread, like
+// SampleMetrics; readers get the summary through the statistics block, and a
+// file's list through the pipeline once the file has closed.
+class DropoutDetector {
+ public:
+  struct Options {
+    // What the stream is running at, which sets the block length and the
+    // reference's memory in samples.
+    uint32_t sample_rate_hz = kSampleRateHz;
+  };
+
+  // A file's list stops growing here. 65,536 events is 1 MiB, reserved once
+  // when the detector is built and held for the run, and is far past anything
+  // a disc worth capturing produces; a side past it is a side whose problem
+  // is not going to be solved by knowing where the sixty-thousandth dropout
+  // was. The counts carry on, so the ones left off are the difference between
+  // the count and the list.
+  static constexpr size_t kMaximumCaptureEvents = 65'536;
+
+  DropoutDetector() : DropoutDetector(Options{}) {}
+  explicit DropoutDetector(const Options& options);
+
+  // Feed the next run of samples, still in the device's wire layout. The
+  // sequence markers are masked off here, as TestPatternVerifier does.
+  void ProcessWireBytes(const uint8_t* wire_data, size_t byte_count);
+
+  // Feed the next run of 10-bit sample values.
+  void Process(const uint16_t* samples, size_t count);
+
+  // Account for a run of samples nobody looked at, for a pipeline checking
+  // one buffer in several while it monitors (see
+  // CapturePipeline::Options::monitor_validation_interval). The reference is
+  // kept, since the signal it describes has not gone anywhere; a half-filled
+  // block is dropped rather than joined to samples that are not next to it,
+  // and a dropout in progress is closed at the last sample seen, since
+  // whatever it did after that was not watched.
+  void Skip(size_t count);
+
+  DropoutSummary Summary() const;
+
+  // Start listing the dropouts a file holds, discarding the previous file's
+  // list. Called at the buffer boundary a writer is attached at, which is the
+  // file's first sample — see SampleMetrics::BeginCaptureSpan.
+  //
+  // Allocates nothing: the list's full capacity was reserved when the
+  // detector was built, which for the pipeline is in Start, and it is only
+  // ever cleared after that.
+  void BeginCaptureSpan();
+
+  // Stop listing, with a dropout still in progress closed at the file's last
+  // sample.
+  void EndCaptureSpan();
+
+  // Hand the file's list over, leaving this one empty. Each event counts from
+  // the file's first sample.
+  //
+  // A copy the size of the list rather than the list itself, so that the
+  // reserved capacity stays here for the next file. A file has a handful of
+  // dropouts, so the copy is small where giving the list away would cost
+  // the next span a megabyte.
+  std::vector<DropoutEvent> TakeCaptureEvents();
+
+  // What the list can hold without allocating, for the tests that pin that a
+  // file's span never does.
+  size_t capture_event_capacity() const { return capture_events_.capacity(); }
+
+  // Whether a file's span is open
+  bool capturing() const { return capturing_; }
+
+  size_t block_samples() const { return block_samples_; }
+
+ private:
+  // Act on one block's mean envelope, which began at `block_start`.
+  void Classify(double envelope, uint64_t block_start);
+
+  void Close(uint64_t end_sample);
+
+  size_t block_samples_ = 0;
+
+  // The reference's memory, in blocks, and how many it needs before it is
+  // trusted.
+  double reference_blocks_ = 0.0;
+  uint64_t settle_blocks_ = 0;
+
+  // A dropout is closed, and the reference learned again, at this length
+  uint64_t longest_dropout_samples_ = 0;
+
+  // The block being accumulated, when a run of samples ended partway through
+  // one, and where it began
+  uint32_t partial_sum_ = 0;
+  size_t partial_count_ = 0;
+  uint64_t partial_start_ = 0;
+
+  uint64_t samples_seen_ = 0;
+
+  double reference_ = 0.0;
+  uint64_t reference_count_ = 0;
+  bool armed_ = false;
+
+  bool in_dropout_ = false;
+  uint64_t dropout_start_ = 0;
+
+  uint64_t event_count_ = 0;
+  uint64_t dropout_samples_ = 0;
+  uint64_t longest_samples_ = 0;
+  uint64_t last_start_ = 0;
+
+  // The file's span, and its list
+  bool capturing_ = false;
+  uint64_t capture_start_ = 0;
+  uint64_t capture_event_count_ = 0;
+  uint64_t capture_dropout_samples_ = 0;
+  std::vector<DropoutEvent> capture_events_;
+};
+
+}  // namespace ddd::capture
@@ -0,0 +1,113 @@
+/************************************************************************
+
+    encoder_effort.cpp
+
+    Trading compression for headroom while a capture is falling behind
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "encoder_effort.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace ddd::capture {
+namespace {
+
+// FLAC's default, the lowest level at its larger block size, and the fastest
+// level there is. Between them they roughly halve the encode cost at each
+// step, where the levels in between differ by a few percent.
+constexpr int kEffortRungs[] = {5, 3, 0};
+
+}  // namespace
+
+std::vector<int> EncoderEffortLadder(int configured_level) {
+  const int top = std::clamp(configured_level, 0, 8);
+  std::vector<int> ladder{top};
+  for (const int level : kEffortRungs) {
+    if (level < top) {
+      ladder.push_back(level);
+    }
+  }
+  return ladder;
+}
+
+void EncoderEffortController::Begin(std::vector<int> levels, size_t file_step,
+                                    double now_seconds) {
+  levels_ = std::move(levels);
+  active_ = !levels_.empty();
+  step_ = active_ ? std::min(file_step, levels_.size() - 1) : 0;
+  calm_since_seconds_.reset();
+
+  summary_ = EncoderEffortSummary{};
+  summary_.adjustable = active_;
+  if (active_) {
+    summary_.configured_level = levels_.front();
+    summary_.file_level = levels_[step_];
+    summary_.advised_level = levels_[step_];
+  }
+
+  // The first step down is allowed at once. A file opened onto a ring that is
+  // already filling has no time to wait out an interval nothing preceded.
+  last_change_seconds_ = now_seconds - thresholds_.lower_interval_seconds;
+}
+
+void EncoderEffortController::End() { active_ = false; }
+
+std::optional<size_t> EncoderEffortController::Observe(double now_seconds,
+                                                       double ring_fraction,
+                                                       double pending_seconds) {
+  if (!active_ || levels_.size() < 2) {
+    return std::nullopt;
+  }
+
+  const bool pressed = ring_fraction >= thresholds_.lower_ring_fraction ||
+                       pending_seconds >= thresholds_.lower_pending_seconds;
+  if (pressed) {
+    calm_since_seconds_.reset();
+    if (step_ + 1 < levels_.size() &&
+        now_seconds - last_change_seconds_ >=
+            thresholds_.lower_interval_seconds) {
+      Move(step_ + 1, now_seconds);
+      return step_;
+    }
+    return std::nullopt;
+  }
+
+  const bool calm = ring_fraction <= thresholds_.raise_ring_fraction &&
+                    pending_seconds <= thresholds_.raise_pending_seconds;
+  if (!calm) {
+    calm_since_seconds_.reset();
+    return std::nullopt;
+  }
+  if (!calm_since_seconds_.has_value()) {
+    calm_since_seconds_ = now_seconds;
+  }
+
+  // One step at a time, each earned by a calm of its own, so that a session
+  // that was struggling climbs back over several files rather than in one.
+  if (step_ > 0 &&
+      now_seconds - *calm_since_seconds_ >= thresholds_.raise_after_seconds &&
+      now_seconds - last_change_seconds_ >= thresholds_.raise_after_seconds) {
+    Move(step_ - 1, now_seconds);
+    calm_since_seconds_ = now_seconds;
+    return step_;
+  }
+  return std::nullopt;
+}
+
+void EncoderEffortController::Move(size_t step, double now_seconds) {
+  if (step > step_) {
+    ++summary_.advised_lower;
+  } else {
+    ++summary_.advised_higher;
+  }
+  step_ = step;
+  last_change_seconds_ = now_seconds;
+  summary_.advised_level = levels_[step_];
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,150 @@
+/************************************************************************
+
+    encoder_effort.h
+
+    Advising the next file a lower compression level when a capture falls
+    behind
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ddd::capture {
+
+// The compression level is chosen once, before a capture, for a machine as it
+// was then. A machine that gets busy halfway through a disc side — an indexer
+// waking up, a browser tab, a backup — slows the encoder, the ring fills, and
+// the capture ends in an overflow that a slightly bigger file would have
+// avoided entirely. The samples are what matter; a file 3% larger is not.
+//
+// Nothing here prevents that overflow, and it is worth being plain about
+// why. libFLAC settles its per-frame search — the LPC order,
+// how finely the residual is partitioned, which apodization windows are tried
+// — when an encoder is initialised, and a file is written by one encoder from
+// start to finish, so its STREAMINFO and MD5 are libFLAC's own. The file being
+// written therefore keeps its level whatever happens, and gets no relief from
+// anything here. A side is normally one file, so a machine that gets busy
+// halfway through one overflows the ring exactly as it would without this.
+//
+// What the readings taken while a file is written do decide is advice: the
+// level the next file of the session should open at
+// (FlacWriter::Options::effort_step), a lower FLAC level while the ring is
+// filling and a higher one again once it has drained. An automatic capture of
+// several sides acts on it from one side to the next. A capture of one side
+// only records it, in the log and the sidecar, as a sign that this computer
+// wants a lower configured level.
+//
+// Asymmetric on purpose. Pressure counts within a second, because a machine
+// that fell behind once is likely to again, and the next file should not have
+// to find that out for itself. Calm counts only after it has lasted, because a
+// ring that has just drained has not proved the machine is quiet again — and
+// advice that went back up the moment it could would send every file of a
+// busy session back to the level that could not keep up.
+
+// What the encoder's effort was over one file, and the advice the readings
+// taken while it was written left for the next, for the log and the sidecar.
+// The levels are the sink's own: FLAC levels, for a FLAC file.
+struct EncoderEffortSummary {
+  // Whether the file was written by a sink that has effort to adjust. False
+  // for an uncompressed capture, and for monitoring.
+  bool adjustable = false;
+
+  int configured_level = 0;
+
+  // The level the whole file was written at.
+  int file_level = 0;
+
+  // The level advised for the next file of the session, as things stood when
+  // this one closed: below file_level when this file fell behind at its own
+  // level and had not been calm for long enough since.
+  int advised_level = 0;
+
+  // How often the readings moved the advice down and back up while this file
+  // was open. The figures that say whether the machine struggled once or
+  // throughout.
+  uint64_t advised_lower = 0;
+  uint64_t advised_higher = 0;
+};
+
+// The levels a capture configured at `configured_level` steps between,
+// highest effort first: the configured level, then FLAC's own default of 5,
+// then 3, the lowest level at the larger block size, then 0. Only the ones
+// below the configured level are included, so a capture configured at 3 steps
+// to 0 and no further, and one configured at 0 has nowhere to go.
+std::vector<int> EncoderEffortLadder(int configured_level);
+
+// Decides, a buffer at a time, which step of the ladder to advise the next
+// file to open at. Nothing it decides reaches the file being written.
+//
+// Thread-safety: none. It belongs to the processing thread, which is the
+// thread that writes to the sink it is deciding for.
+class EncoderEffortController {
+ public:
+  struct Thresholds {
+    // Step down when the ring is at least this full, or when at least this
+    // much capture is waiting inside the encoder. The first is the disk or the
+    // encoder falling behind; the second is the encoder alone, seen before it
+    // has had time to fill the ring.
+    double lower_ring_fraction = 0.5;
+    double lower_pending_seconds = 1.0;
+
+    // And no more often than this, so that the readings behind one step are
+    // not the same readings counted again for the next.
+    double lower_interval_seconds = 1.0;
+
+    // Step back up once the ring has stayed at or below this, with at most
+    // this much waiting in the encoder, for this long.
+    double raise_ring_fraction = 0.1;
+    double raise_pending_seconds = 0.25;
+    double raise_after_seconds = 10.0;
+  };
+
+  EncoderEffortController() = default;
+  explicit EncoderEffortController(const Thresholds& thresholds)
+      : thresholds_(thresholds) {}
+
+  // Start deciding for a new file, opened at `levels[file_step]`. An empty
+  // ladder — a sink with no effort to adjust — makes every Observe() a no-op.
+  void Begin(std::vector<int> levels, size_t file_step, double now_seconds);
+
+  // Stop, freezing the summary as it stands.
+  void End();
+
+  // One reading, taken after a buffer has been written. Returns the step
+  // advised for the next file when it differs from the advice so far, and
+  // nothing otherwise.
+  std::optional<size_t> Observe(double now_seconds, double ring_fraction,
+                                double pending_seconds);
+
+  size_t step() const { return step_; }
+  bool active() const { return active_; }
+
+  // As of the last Observe() or End().
+  const EncoderEffortSummary& summary() const { return summary_; }
+
+ private:
+  void Move(size_t step, double now_seconds);
+
+  Thresholds thresholds_;
+  std::vector<int> levels_;
+  bool active_ = false;
+  size_t step_ = 0;
+
+  double last_change_seconds_ = 0.0;
+
+  // When the readings last stopped qualifying for a step up, so that the
+  // relief is measured from the moment it began.
+  std::optional<double> calm_since_seconds_;
+
+  EncoderEffortSummary summary_;
+};
+
+}  // namespace ddd::capture
@@ -0,0 +1,86 @@
+/************************************************************************
+
+    flac_encode_probe.cpp
+
+    How fast the FLAC encoder runs on this machine, and how well it packs
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "flac_encode_probe.h"
+
+#include <chrono>
+#include <system_error>
+#include <vector>
+
+#include "flac_writer.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+
+EncodeProbeResult ProbeFlacEncode(const std::filesystem::path& scratch_file,
+                                  std::span<const uint8_t> device_data,
+                                  int compression_level, unsigned int threads) {
+  EncodeProbeResult result;
+  result.compression_level = compression_level;
+  result.threads = threads;
+
+  const size_t samples = device_data.size() / kBytesPerSample;
+  if (samples == 0) {
+    result.error = "There were no samples to encode.";
+    return result;
+  }
+
+  const size_t bytes = samples * kBytesPerSample;
+  std::vector<uint8_t> stripped(device_data.begin(),
+                                device_data.begin() + bytes);
+  for (size_t index = 1; index < stripped.size(); index += kBytesPerSample) {
+    stripped[index] &= kSampleValueHighByteMask;
+  }
+
+  FlacWriter::Options options;
+  options.compression_level = compression_level;
+  options.threads = threads;
+
+  FlacWriter writer;
+  std::string error;
+  if (!writer.Open(scratch_file, options, error)) {
+    result.error = error;
+    return result;
+  }
+
+  // Finish is inside the timing: with several threads the encoder is still
+  // working on the tail when the last samples are handed over, and a figure
+  // that stopped the clock there would flatter the threaded configurations.
+  const auto started = std::chrono::steady_clock::now();
+  const bool written = writer.WriteRawDeviceSamples(stripped.data(), samples) &&
+                       writer.Finish();
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - started)
+          .count();
+
+  // Closed before it is removed, including when the encode failed part way
+  // and never reached Finish: a file the encoder still holds open cannot be
+  // removed on Windows, and the scratch file would be left in the temporary
+  // folder. The error is taken first, since it is the first failure that says
+  // what went wrong.
+  const std::string write_error = written ? std::string() : writer.LastError();
+  writer.Finish();
+  std::error_code ignored;
+  std::filesystem::remove(scratch_file, ignored);
+
+  if (!written) {
+    result.error = write_error;
+    return result;
+  }
+  result.ok = true;
+  result.samples_per_second =
+      seconds > 0.0 ? static_cast<double>(samples) / seconds : 0.0;
+  result.compression_ratio = static_cast<double>(writer.BytesWritten()) /
+                             static_cast<double>(samples * kBytesPerSample);
+  return result;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,37 @@
+/************************************************************************
+
+    flac_encode_probe.h
+
+    How fast the FLAC encoder runs on this machine, and how well it packs
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "host_qualification.h"
+
+namespace ddd::capture {
+
+// Encode `device_data` — the device's own layout, sequence counters and all —
+// into `scratch_file` at one level and thread count, and say how long it took
+// and how small it came out. The file is deleted afterwards.
+//
+// Through FlacWriter itself rather than libFLAC directly, so that what is
+// timed is exactly what a capture's processing thread runs, widening loop and
+// all. The counters are stripped first and the stripping is not timed; in a
+// capture the validator has already done it.
+//
+// The file belongs somewhere other than the capture folder. Encoding is
+// measured here, not writing, and a slow disk would be counted twice.
+EncodeProbeResult ProbeFlacEncode(const std::filesystem::path& scratch_file,
+                                  std::span<const uint8_t> device_data,
+                                  int compression_level, unsigned int threads);
+
+}  // namespace ddd::capture
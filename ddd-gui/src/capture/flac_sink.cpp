@@ -45,4 +45,14 @@ uint64_t FlacSink::SamplesWritten() const { return writer_->SamplesWritten(); }
 
 uint64_t FlacSink::SamplesPending() const { return writer_->SamplesPending(); }
 
+std::vector<uint64_t> FlacSink::WorkerThreadIds() const {
+  return writer_->EncoderThreadIds();
+}
+
+std::vector<int> FlacSink::EffortLevels() const {
+  return writer_->EffortLevels();
+}
+
+size_t FlacSink::EffortStep() const { return writer_->EffortStep(); }
+
 }  // namespace ddd::capture
@@ -14,6 +14,7 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "flac_writer.h"
 #include "sample_sink.h"
@@ -53,6 +54,10 @@ class FlacSink : public ISampleSink {
   uint64_t SamplesWritten() const override;
   uint64_t SamplesPending() const override;
 
+  std::vector<uint64_t> WorkerThreadIds() const override;
+  std::vector<int> EffortLevels() const override;
+  size_t EffortStep() const override;
+
   const std::string& LastError() const override { return last_error_; }
 
   const std::filesystem::path& file_path() const { return file_path_; }
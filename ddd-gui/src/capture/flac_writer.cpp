@@ -16,10 +16,14 @@
 
 #include <algorithm>
 #include <atomic>
+#include <iterator>
+#include <optional>
 #include <thread>
 
 #include "capture_format.h"
+#include "encoder_effort.h"
 #include "sample_format.h"
+#include "thread_usage.h"
 
 namespace ddd::capture {
 namespace {
@@ -29,10 +33,10 @@ namespace {
 // friendly.
 constexpr size_t kEncodeChunkSamples = 65'536;
 
-// ld-compress caps its own -j here, having observed throughput plateau once
-// feeding the encoder becomes the bottleneck rather than the encoding itself.
-// The same applies here, and the samples arrive on one thread.
-constexpr unsigned int kMaximumEncoderThreads = 8;
+// What the thread that starts an encoder is called while it does, and so what
+// libFLAC's workers are called for good. Within the kernel's fifteen
+// characters.
+constexpr const char* kEncoderThreadName = "ddd-flac-enc";
 
 // libFLAC documents its filenames as UTF-8 on every platform, including
 // Windows, where it widens them itself. std::u8string is a distinct type in
@@ -56,6 +60,13 @@ struct FlacWriter::Impl {
   // path.
   std::vector<int32_t> scratch;
 
+  // See FlacWriter::EncoderThreadIds. Set once, by Open.
+  std::vector<uint64_t> encoder_threads;
+
+  // See FlacWriter::EffortLevels and EffortStep. Set once, by Open.
+  std::vector<int> effort_levels;
+  size_t effort_step = 0;
+
   std::atomic<size_t> bytes_written{0};
   std::atomic<size_t> samples_written{0};
   std::atomic<size_t> samples_encoded{0};
@@ -133,9 +144,12 @@ bool FlacWriter::Open(const std::filesystem::path& file_path,
                                                       kFlacBitsPerSample);
   ok = ok && FLAC__stream_encoder_set_sample_rate(impl_->encoder,
                                                   options.sample_rate_label);
+  impl_->effort_levels = EncoderEffortLadder(options.compression_level);
+  impl_->effort_step =
+      std::min(options.effort_step, impl_->effort_levels.size() - 1);
   ok = ok && FLAC__stream_encoder_set_compression_level(
-                 impl_->encoder, static_cast<uint32_t>(std::clamp(
-                                     options.compression_level, 0, 8)));
+                 impl_->encoder, static_cast<uint32_t>(
+                                     impl_->effort_levels[impl_->effort_step]));
 
   // Verification re-decodes every frame as it is written and compares. That is
   // the wrong trade on a real-time path — it roughly doubles the cost of the
@@ -216,10 +230,24 @@ bool FlacWriter::Open(const std::filesystem::path& file_path,
 
   // init_file, not init_ogg_file. That one call is the whole difference between
   // this and the .ldf the old application wrote.
+  //
+  // Renamed for the length of the call, so that the threads libFLAC starts
+  // inside it are told apart by name from any that other threads start in the
+  // same moment (see RenameCurrentThread), and keep that name for top and
+  // perf to show.
   const std::string utf8_path = PathToUtf8(file_path);
+  const std::optional<std::string> own_name =
+      RenameCurrentThread(kEncoderThreadName);
+  const std::optional<std::vector<uint64_t>> threads_before =
+      ListProcessThreadIds();
   const FLAC__StreamEncoderInitStatus init_status =
       FLAC__stream_encoder_init_file(impl_->encoder, utf8_path.c_str(),
                                      &Impl::ProgressCallback, impl_.get());
+  const std::optional<std::vector<uint64_t>> threads_after =
+      ListProcessThreadIds();
+  if (own_name) {
+    RenameCurrentThread(*own_name);
+  }
   if (init_status != FLAC__STREAM_ENCODER_INIT_STATUS_OK) {
     error_message =
         std::string(
@@ -228,6 +256,24 @@ bool FlacWriter::Open(const std::filesystem::path& file_path,
     return false;
   }
 
+  // Both lists come back sorted, so the new threads are a set difference, of
+  // which only the ones carrying the name are libFLAC's. Without the rename
+  // there is no telling, and nothing is charged to the encoder rather than
+  // something that may not be its.
+  impl_->encoder_threads.clear();
+  if (own_name && threads_before && threads_after) {
+    std::vector<uint64_t> started;
+    std::set_difference(threads_after->begin(), threads_after->end(),
+                        threads_before->begin(), threads_before->end(),
+                        std::back_inserter(started));
+    for (const uint64_t thread_id : started) {
+      if (ReadThreadName(thread_id) == std::optional<std::string>(
+                                          kEncoderThreadName)) {
+        impl_->encoder_threads.push_back(thread_id);
+      }
+    }
+  }
+
   impl_->scratch.resize(kEncodeChunkSamples);
   impl_->bytes_written = 0;
   impl_->samples_written = 0;
@@ -311,4 +357,14 @@ size_t FlacWriter::SamplesPending() const {
 
 const std::string& FlacWriter::LastError() const { return impl_->last_error; }
 
+const std::vector<uint64_t>& FlacWriter::EncoderThreadIds() const {
+  return impl_->encoder_threads;
+}
+
+const std::vector<int>& FlacWriter::EffortLevels() const {
+  return impl_->effort_levels;
+}
+
+size_t FlacWriter::EffortStep() const { return impl_->effort_step; }
+
 }  // namespace ddd::capture
@@ -45,6 +45,11 @@ class FlacWriter {
     std::string value;
   };
 
+  // ld-compress caps its own -j here, having observed throughput plateau once
+  // feeding the encoder becomes the bottleneck rather than the encoding
+  // itself. The same applies here, and the samples arrive on one thread.
+  static constexpr unsigned int kMaximumEncoderThreads = 8;
+
   struct Options {
     // 0-8, as flac's -0 .. -8. The same default ld-compress uses, and for the
     // same reason: a capture is an archival copy that will be stored and copied
@@ -70,6 +75,17 @@ class FlacWriter {
     // setting as the first remedy.
     int compression_level = 8;
 
+    // How far down EncoderEffortLadder(compression_level) this file is
+    // written: 0, the level above, or a lower one for a capture that was
+    // falling behind when its last file closed (see encoder_effort.h). Past
+    // the end of the ladder means its last, lowest level.
+    //
+    // Fixed for the file's life. libFLAC settles its LPC order, partition
+    // search and apodization when an encoder is initialised, so a level can
+    // only change where a file does: one file, one encoder, and the stream
+    // header and MD5 are libFLAC's own.
+    size_t effort_step = 0;
+
     // 0 asks for one thread per core, capped at kMaximumEncoderThreads.
     // Multithreaded encoding needs libFLAC 1.5.0 or later; on anything older
     // this is silently a single-threaded encode, which is why the level default
@@ -140,6 +156,27 @@ class FlacWriter {
 
   const std::string& LastError() const;
 
+  // The threads libFLAC started for this encoder, by the kernel's identifiers.
+  // Empty for a single-threaded encode, and on a platform that cannot list a
+  // process's threads.
+  //
+  // Found rather than asked for: libFLAC starts its workers inside
+  // FLAC__stream_encoder_init_file and exposes no handle on them. Open renames
+  // its own thread for the length of that call, so these are the threads that
+  // exist after it, did not before, and carry the name they inherited from
+  // it. A thread something else in the process started in the same moment
+  // carries its own starter's name and is left out. Empty too where the
+  // platform cannot rename a thread.
+  const std::vector<uint64_t>& EncoderThreadIds() const;
+
+  // The levels this file's capture steps between, highest effort first: the
+  // configured compression_level, then the lower ones EncoderEffortLadder
+  // picks.
+  const std::vector<int>& EffortLevels() const;
+
+  // Where on EffortLevels() this file is being written, as Open settled it.
+  size_t EffortStep() const;
+
   // Whether the libFLAC this was built against can encode on more than one
   // thread. False means one core is doing all of it, which the application says
   // out loud rather than leaving as an unexplained shortfall.
@@ -0,0 +1,498 @@
+/************************************************************************
+
+    host_qualification.cpp
+
+    Measuring a capture host, and the settings the measurements imply
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "host_qualification.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <system_error>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "free_space.h"
+#include "log_format.h"
+#include "sequence_validator.h"
+
+namespace ddd::capture {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+constexpr double kTwoPi = 6.283185307179586;
+
+// The video carrier's swing: sync tip to peak white, as the LaserDisc
+// specification puts them, and the line it is swept at.
+constexpr double kSyncTipHz = 7.6e6;
+constexpr double kPeakWhiteHz = 9.3e6;
+constexpr double kLineSeconds = 63.556e-6;
+constexpr double kSyncSeconds = 4.7e-6;
+
+// The two analogue audio carriers, well below the video carrier's level.
+constexpr double kLeftAudioHz = 2.301e6;
+constexpr double kRightAudioHz = 2.812e6;
+
+// Levels in converter codes around the midpoint: a carrier with some room
+// under full scale, audio a tenth of it, and enough noise that the low bits
+// are as busy as a real capture's.
+constexpr double kCarrierAmplitude = 300.0;
+constexpr double kAudioAmplitude = 30.0;
+constexpr double kNoiseAmplitude = 12.0;
+
+// A small generator of its own rather than <random>, whose distributions are
+// free to differ between standard libraries: the same seed has to give the
+// same samples on every platform, or a probe's compression figures would
+// depend on the compiler.
+class Xorshift32 {
+ public:
+  explicit Xorshift32(uint32_t seed) : state_(seed == 0 ? 1 : seed) {}
+
+  // Uniform in [-1, 1)
+  double Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 17;
+    state_ ^= state_ << 5;
+    return static_cast<double>(state_) / 2147483648.0 - 1.0;
+  }
+
+ private:
+  uint32_t state_;
+};
+
+// Where the video signal is within a line, 0 at sync tip and 1 at peak white:
+// a sync pulse, then a ramp across the active line, which is a test card's
+// staircase without the steps.
+double LineLevel(double seconds) {
+  const double within = std::fmod(seconds, kLineSeconds);
+  if (within < kSyncSeconds) {
+    return 0.0;
+  }
+  return 0.3 + 0.7 * (within - kSyncSeconds) / (kLineSeconds - kSyncSeconds);
+}
+
+constexpr const char* kWriteProbeName = ".ddd-qualify-probe.tmp";
+
+// The probe's scratch file, unbuffered, so that what is timed is the write
+// into the operating system and the sync that takes it on to the disk. A
+// stream's flush and close only ever reach the page cache, and on a machine
+// with gigabytes of it twenty seconds of writing can finish without the disk
+// having been asked for a byte.
+class ProbeFile {
+ public:
+  explicit ProbeFile(const std::filesystem::path& path) {
+#ifdef _WIN32
+    descriptor_ = _wopen(path.c_str(),
+                         _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                         _S_IREAD | _S_IWRITE);
+#else
+    descriptor_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  }
+  ~ProbeFile() { Close(); }
+
+  ProbeFile(const ProbeFile&) = delete;
+  ProbeFile& operator=(const ProbeFile&) = delete;
+
+  bool is_open() const { return descriptor_ >= 0; }
+
+  // All of `data`, however many calls the operating system takes to accept it.
+  bool Write(std::span<const uint8_t> data) {
+    while (!data.empty()) {
+#ifdef _WIN32
+      const int written = _write(descriptor_, data.data(),
+                                 static_cast<unsigned int>(data.size()));
+#else
+      const ssize_t written = ::write(descriptor_, data.data(), data.size());
+#endif
+      // A signal that lands mid-write — a resized terminal, a profiler — is
+      // not the disk failing
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        return false;
+      }
+      data = data.subspan(static_cast<size_t>(written));
+    }
+    return true;
+  }
+
+  // Wait until what has been written is on the disk.
+  bool Sync() {
+#if defined(_WIN32)
+    return _commit(descriptor_) == 0;
+#elif defined(__APPLE__)
+    return ::fsync(descriptor_) == 0;
+#else
+    return ::fdatasync(descriptor_) == 0;
+#endif
+  }
+
+  void Close() {
+    if (descriptor_ < 0) {
+      return;
+    }
+#ifdef _WIN32
+    _close(descriptor_);
+#else
+    ::close(descriptor_);
+#endif
+    descriptor_ = -1;
+  }
+
+ private:
+  int descriptor_ = -1;
+};
+
+// The q-th quantile of sorted values, by the nearest-rank method: always one
+// of the values measured, never an interpolation between two.
+double Quantile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const double rank = std::ceil(q * static_cast<double>(sorted.size()));
+  const size_t index =
+      std::clamp<size_t>(static_cast<size_t>(rank), 1, sorted.size()) - 1;
+  return sorted[index];
+}
+
+std::string Times(double value) { return FormatDecimal(value, 2) + "x"; }
+
+// What the file needs from the disk, which depends on how well the samples
+// compress and so on the level chosen.
+double WriteHeadroom(const QualificationMeasurements& measurements,
+                     double compression_ratio) {
+  const double file_bytes_per_second =
+      static_cast<double>(measurements.sample_rate_hz) * kBytesPerSample *
+      compression_ratio;
+  return file_bytes_per_second > 0.0
+             ? measurements.write.bytes_per_second / file_bytes_per_second
+             : 0.0;
+}
+
+}  // namespace
+
+void GenerateQualificationRf(std::span<uint8_t> device_data,
+                             uint32_t sample_rate_hz, uint64_t first_sample,
+                             uint32_t seed) {
+  if (sample_rate_hz == 0) {
+    return;
+  }
+  Xorshift32 noise(seed);
+  const double period = 1.0 / static_cast<double>(sample_rate_hz);
+
+  // The carrier's phase is the integral of its frequency, so it is carried
+  // forward a sample at a time rather than computed from the time: a phase
+  // worked out from an instantaneous frequency jumps whenever the frequency
+  // does, and those jumps are wideband clicks no disc has in it.
+  double carrier_phase = 0.0;
+  const size_t samples = device_data.size() / kBytesPerSample;
+  for (size_t index = 0; index < samples; ++index) {
+    const uint64_t sample = first_sample + index;
+    const double seconds = static_cast<double>(sample) * period;
+
+    const double frequency =
+        kSyncTipHz + (kPeakWhiteHz - kSyncTipHz) * LineLevel(seconds);
+    carrier_phase += kTwoPi * frequency * period;
+    if (carrier_phase > kTwoPi) {
+      carrier_phase -= kTwoPi;
+    }
+
+    const double value =
+        kSampleZeroOffset + kCarrierAmplitude * std::sin(carrier_phase) +
+        kAudioAmplitude * std::sin(kTwoPi * kLeftAudioHz * seconds) +
+        kAudioAmplitude * std::sin(kTwoPi * kRightAudioHz * seconds) +
+        kNoiseAmplitude * (noise.Next() + noise.Next());
+    const auto code = static_cast<uint16_t>(
+        std::clamp(std::lround(value), static_cast<long>(kMinimumSampleValue),
+                   static_cast<long>(kMaximumSampleValue)));
+
+    const auto counter = static_cast<uint8_t>(
+        (sample / kSamplesPerSequenceCounter) % kSequenceCounterValues);
+    const uint16_t word = MakeWireWord(code, counter);
+    device_data[index * kBytesPerSample] = static_cast<uint8_t>(word & 0xFF);
+    device_data[index * kBytesPerSample + 1] = static_cast<uint8_t>(word >> 8);
+  }
+}
+
+WriteLatencySummary SummariseWriteLatencies(std::vector<double> seconds) {
+  WriteLatencySummary summary;
+  if (seconds.empty()) {
+    return summary;
+  }
+  std::sort(seconds.begin(), seconds.end());
+  summary.median_seconds = Quantile(seconds, 0.5);
+  summary.p99_seconds = Quantile(seconds, 0.99);
+  summary.p999_seconds = Quantile(seconds, 0.999);
+  summary.worst_seconds = seconds.back();
+  return summary;
+}
+
+WriteProbeResult ProbeWriteBandwidth(const std::filesystem::path& directory,
+                                     const WriteProbeOptions& options) {
+  WriteProbeResult result;
+  if (options.block_bytes == 0) {
+    result.error = "The write probe was given a block size of zero.";
+    return result;
+  }
+
+  uint64_t limit = options.maximum_bytes;
+  const FreeSpace space = AvailableSpace(directory);
+  if (space.known) {
+    const double share = static_cast<double>(space.bytes_available) *
+                         options.maximum_free_space_fraction;
+    limit = std::min(limit, static_cast<uint64_t>(share));
+  }
+  if (limit < options.block_bytes) {
+    result.error = "There is not enough free space in " + directory.string() +
+                   " to measure it.";
+    return result;
+  }
+
+  // Signal rather than zeroes: a filesystem that compresses — btrfs and ZFS
+  // both can — would write a block of zeroes in no time at all and report a
+  // disk many times faster than the one a capture will meet.
+  std::vector<uint8_t> block(options.block_bytes);
+  GenerateQualificationRf(block, kSampleRateHz);
+
+  const std::filesystem::path path = directory / kWriteProbeName;
+  ProbeFile file(path);
+  if (!file.is_open()) {
+    result.error = "Could not create a file in " + directory.string() + ".";
+    return result;
+  }
+
+  // Synced every so often rather than once at the end, so that the writeback
+  // lands on the blocks it holds up. Left to itself, the operating system
+  // takes blocks into memory in no time and then stalls one at random while it
+  // catches up; a sync at intervals is that stall, on a schedule, and it is the
+  // tail of the latencies that a capture's buffer ring has to ride out.
+  std::vector<double> latencies;
+  uint64_t unsynced_bytes = 0;
+  const Clock::time_point started = Clock::now();
+  while (result.bytes + options.block_bytes <= limit &&
+         SecondsSince(started) < options.duration_seconds) {
+    const Clock::time_point block_started = Clock::now();
+    bool written = file.Write(block);
+    unsynced_bytes += block.size();
+    if (written && unsynced_bytes >= options.sync_bytes) {
+      written = file.Sync();
+      unsynced_bytes = 0;
+    }
+    if (!written) {
+      result.error = "Writing to " + directory.string() + " failed.";
+      break;
+    }
+    latencies.push_back(SecondsSince(block_started));
+    result.bytes += block.size();
+  }
+
+  // The last sync is part of the write: the rate is for bytes on the disk, not
+  // bytes in memory waiting to be.
+  if (result.error.empty() && unsynced_bytes > 0 && !file.Sync()) {
+    result.error = "Writing to " + directory.string() + " failed.";
+  }
+  result.seconds = SecondsSince(started);
+  file.Close();
+
+  std::error_code ignored;
+  std::filesystem::remove(path, ignored);
+
+  if (!result.error.empty()) {
+    return result;
+  }
+  result.ok = true;
+  result.bytes_per_second =
+      result.seconds > 0.0 ? static_cast<double>(result.bytes) / result.seconds
+                           : 0.0;
+  result.latency = SummariseWriteLatencies(std::move(latencies));
+  return result;
+}
+
+double ProbeValidatorThroughput(std::span<const uint8_t> device_data,
+                                double minimum_seconds) {
+  if (device_data.size() < kBytesPerSample) {
+    return 0.0;
+  }
+  std::vector<uint8_t> work(device_data.size());
+  SequenceValidator validator;
+
+  double timed_seconds = 0.0;
+  uint64_t samples = 0;
+  do {
+    std::copy(device_data.begin(), device_data.end(), work.begin());
+
+    // Started afresh each pass. The data starts again at the same counter
+    // value, which to a validator that had carried on would be a lost stretch
+    // of samples and the end of the measurement.
+    validator.Reset();
+    const Clock::time_point started = Clock::now();
+    validator.Process(work.data(), work.size());
+    timed_seconds += SecondsSince(started);
+    samples += work.size() / kBytesPerSample;
+  } while (timed_seconds < minimum_seconds);
+
+  return timed_seconds > 0.0 ? static_cast<double>(samples) / timed_seconds
+                             : 0.0;
+}
+
+std::vector<size_t> QualificationQueueSizes() {
+  std::vector<size_t> sizes;
+  for (size_t size = DiskBufferRing::kMinimumQueueSizeBytes;
+       size <= DiskBufferRing::kMaximumQueueSizeBytes; size *= 2) {
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+bool EncodeKeepsUp(const QualificationMeasurements& measurements,
+                   const EncodeProbeResult& encode,
+                   const QualificationMargins& margins) {
+  if (!encode.ok || measurements.sample_rate_hz == 0) {
+    return false;
+  }
+  const double encode_headroom =
+      encode.samples_per_second /
+      static_cast<double>(measurements.sample_rate_hz);
+  return encode_headroom >= margins.throughput &&
+         WriteHeadroom(measurements, encode.compression_ratio) >=
+             margins.throughput;
+}
+
+QualificationResult RecommendQualifiedSettings(
+    const QualificationMeasurements& measurements,
+    const QualificationMargins& margins) {
+  QualificationResult result;
+
+  const double rate = static_cast<double>(measurements.sample_rate_hz);
+  const double wire_bytes_per_second = rate * kBytesPerSample;
+  if (rate <= 0.0) {
+    result.reason = "There is no sample rate to qualify the host for.";
+    return result;
+  }
+  if (!measurements.write.ok) {
+    result.reason = measurements.write.error.empty()
+                        ? "The capture folder could not be measured."
+                        : measurements.write.error;
+    return result;
+  }
+
+  result.validator_headroom = measurements.validator_samples_per_second / rate;
+
+  std::string shortfall;
+  if (measurements.output_format == CaptureOutputFormat::kSigned16Bit) {
+    result.write_headroom = WriteHeadroom(measurements, 1.0);
+    result.encode_headroom = 0.0;
+    if (result.write_headroom < margins.throughput) {
+      shortfall = "The disk writes " + Times(result.write_headroom) +
+                  " what an uncompressed capture needs, short of the " +
+                  Times(margins.throughput) + " margin.";
+    }
+  } else {
+    // The best configuration that passes, or failing that the one that comes
+    // nearest — its figures are what a user needs to see to know how far off
+    // the machine is.
+    const EncodeProbeResult* chosen = nullptr;
+    bool chosen_passes = false;
+    double chosen_worst = 0.0;
+    for (const EncodeProbeResult& encode : measurements.encodes) {
+      if (!encode.ok) {
+        continue;
+      }
+      const double worst =
+          std::min(encode.samples_per_second / rate,
+                   WriteHeadroom(measurements, encode.compression_ratio));
+      const bool passes = EncodeKeepsUp(measurements, encode, margins);
+
+      bool better = chosen == nullptr;
+      if (!better && passes != chosen_passes) {
+        better = passes;
+      } else if (!better && passes) {
+        better = encode.compression_level > chosen->compression_level ||
+                 (encode.compression_level == chosen->compression_level &&
+                  encode.threads < chosen->threads);
+      } else if (!better) {
+        better = worst > chosen_worst;
+      }
+      if (better) {
+        chosen = &encode;
+        chosen_passes = passes;
+        chosen_worst = worst;
+      }
+    }
+
+    if (chosen == nullptr) {
+      result.reason = "No FLAC encoder configuration could be measured.";
+      return result;
+    }
+    result.compression_level = chosen->compression_level;
+    result.encoder_threads = chosen->threads;
+    result.encode_headroom = chosen->samples_per_second / rate;
+    result.write_headroom =
+        WriteHeadroom(measurements, chosen->compression_ratio);
+    if (!chosen_passes && result.encode_headroom < result.write_headroom) {
+      shortfall = "The encoder manages at best " +
+                  Times(result.encode_headroom) +
+                  " the capture rate, short of the " +
+                  Times(margins.throughput) + " margin.";
+    } else if (!chosen_passes) {
+      shortfall = "The disk writes at best " + Times(result.write_headroom) +
+                  " what the compressed capture needs, short of the " +
+                  Times(margins.throughput) + " margin.";
+    }
+  }
+
+  if (shortfall.empty() && result.validator_headroom < margins.throughput) {
+    shortfall = "Checking the samples runs at " +
+                Times(result.validator_headroom) +
+                " the capture rate, short of the " + Times(margins.throughput) +
+                " margin.";
+  }
+
+  // The smallest ring that rides out the worst stall with its margin, or the
+  // largest there is when none does.
+  result.worst_stall_seconds = measurements.write.latency.worst_seconds;
+  const double needed_seconds = result.worst_stall_seconds * margins.stall;
+  const std::vector<size_t> sizes = QualificationQueueSizes();
+  result.queue_size_bytes = sizes.back();
+  for (const size_t size : sizes) {
+    if (static_cast<double>(size) / wire_bytes_per_second >= needed_seconds) {
+      result.queue_size_bytes = size;
+      break;
+    }
+  }
+  result.stall_tolerance_seconds =
+      static_cast<double>(result.queue_size_bytes) / wire_bytes_per_second;
+  if (shortfall.empty() && result.stall_tolerance_seconds < needed_seconds) {
+    shortfall = "The disk stalled for " +
+                FormatDecimal(result.worst_stall_seconds, 2) +
+                " s, longer than the largest buffer covers with a " +
+                Times(margins.stall) + " margin.";
+  }
+
+  result.qualified = shortfall.empty();
+  result.reason = shortfall;
+  return result;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,206 @@
+/************************************************************************
+
+    host_qualification.h
+
+    Measuring a capture host, and the settings the measurements imply
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "capture_format.h"
+#include "disk_buffer_ring.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+
+// The three settings that decide whether a machine keeps up — the ring's size,
+// the FLAC level and the encoder's threads — have until now been chosen by
+// guessing, and a wrong guess is found out when a two-hour capture stops with
+// an overflow. This is the alternative: measure the parts of the machine a
+// capture leans on, each on its own, and work the settings out from what was
+// measured with a margin that is stated rather than hoped for.
+//
+// Three measurements, because there are three ways a capture falls behind:
+//
+//   - the disk, which must take the file at its rate and must not stall for
+//     longer than the ring can cover;
+//   - the encoder, which must compress the samples faster than they arrive;
+//   - the processing thread's validation pass, which every sample goes
+//     through whatever the format.
+//
+// Each is measured alone, and a capture runs all three at once: the encoder
+// and the validator then share the processor's cores, caches and memory
+// bandwidth with each other and with the disk's writeback. So the figures are
+// a best case, which the margins have to cover and which the report says.
+//
+// The probes are here, with the arithmetic that turns them into settings, so
+// that the arithmetic can be tested on figures a test chooses. The FLAC probe
+// is in flac_encode_probe.h, beside the writer it drives.
+
+// Representative RF for the probes to work on: what a FLAC encoder is fed
+// during a capture, rather than a tone or a ramp, either of which compresses
+// far better than a disc does and would recommend a level the machine cannot
+// sustain on real signal.
+//
+// An FM carrier swept over the band a LaserDisc's video carrier occupies by a
+// line-rate waveform, with the audio carriers beneath it and noise across all
+// of it, at the device's levels and in the device's layout — sequence counters
+// and all, counted from `first_sample`. Deterministic for a given seed, so a
+// probe run twice is fed the same samples.
+void GenerateQualificationRf(std::span<uint8_t> device_data,
+                             uint32_t sample_rate_hz, uint64_t first_sample = 0,
+                             uint32_t seed = 1);
+
+// How long each block took to write, in order, summarised.
+struct WriteLatencySummary {
+  double median_seconds = 0.0;
+  double p99_seconds = 0.0;
+  double p999_seconds = 0.0;
+  double worst_seconds = 0.0;
+};
+
+WriteLatencySummary SummariseWriteLatencies(std::vector<double> seconds);
+
+struct WriteProbeOptions {
+  // Writes stop at whichever comes first. Long enough that the operating
+  // system's cache has filled and the figure is the disk's own rather than
+  // memory's — which is also when the stalls a capture meets begin.
+  double duration_seconds = 20.0;
+  uint64_t maximum_bytes = uint64_t{8} << 30;
+
+  // The unit a capture writes in.
+  size_t block_bytes = DiskBufferRing::kTargetSlotSizeBytes;
+
+  // How much is written between syncs to the disk. A second or so of capture
+  // at the sample rate, so that the stalls are the size writeback makes them.
+  uint64_t sync_bytes = uint64_t{64} << 20;
+
+  // Never take more than this share of the volume's free space, so that a
+  // nearly full disk is measured rather than filled.
+  double maximum_free_space_fraction = 0.5;
+};
+
+struct WriteProbeResult {
+  bool ok = false;
+  std::string error;
+
+  uint64_t bytes = 0;
+  double seconds = 0.0;
+  double bytes_per_second = 0.0;
+  WriteLatencySummary latency;
+};
+
+// Write a scratch file in `directory` flat out, a block at a time, syncing it
+// to the disk as it goes and at the end, and delete it after. The clock stops
+// after the last sync, so the rate is the disk's and not the page cache's.
+//
+// Flat out rather than at the capture's rate, so that the figure is the disk's
+// capacity and the stalls are the ones it has under load — pessimistic in both
+// directions, which is the right way round for a margin.
+WriteProbeResult ProbeWriteBandwidth(const std::filesystem::path& directory,
+                                     const WriteProbeOptions& options);
+
+// Samples a second the validator gets through, over `device_data` a pass at a
+// time until `minimum_seconds` have gone by. The data is copied before each
+// pass, since the validator strips what it reads, and only the validation is
+// timed.
+double ProbeValidatorThroughput(std::span<const uint8_t> device_data,
+                                double minimum_seconds = 0.5);
+
+// One encoder configuration as measured.
+struct EncodeProbeResult {
+  int compression_level = 0;
+  unsigned int threads = 1;
+
+  bool ok = false;
+  std::string error;
+
+  double samples_per_second = 0.0;
+
+  // Compressed size over the device's two bytes a sample.
+  double compression_ratio = 1.0;
+};
+
+// What the probes found, and what the capture is meant to run at.
+struct QualificationMeasurements {
+  uint32_t sample_rate_hz = kSampleRateHz;
+  CaptureOutputFormat output_format = CaptureOutputFormat::kFlac;
+
+  WriteProbeResult write;
+  double validator_samples_per_second = 0.0;
+
+  // Any subset of levels and thread counts, in any order. Ignored for the
+  // uncompressed format.
+  std::vector<EncodeProbeResult> encodes;
+};
+
+// The margins, stated.
+struct QualificationMargins {
+  // Every rate measured must beat the rate needed by this factor: the
+  // machine is doing other things during a real capture that it was not
+  // doing during the probe.
+  double throughput = 1.5;
+
+  // The ring must cover this many times the longest write stall measured. A
+  // probe of twenty seconds sees the stalls of twenty seconds, and a capture
+  // runs for an hour.
+  double stall = 4.0;
+};
+
+struct QualificationResult {
+  // False when no setting meets the margins. The figures below are then the
+  // nearest the machine comes, and `reason` says what fell short.
+  bool qualified = false;
+  std::string reason;
+
+  int compression_level = 0;
+  unsigned int encoder_threads = 0;
+  size_t queue_size_bytes = DiskBufferRing::kDefaultQueueSizeBytes;
+
+  // Each stage's rate over the rate it has to sustain.
+  double write_headroom = 0.0;
+  double encode_headroom = 0.0;
+  double validator_headroom = 0.0;
+
+  // How long the ring chosen would let the disk stall before samples were
+  // lost, and the longest stall the probe saw.
+  double stall_tolerance_seconds = 0.0;
+  double worst_stall_seconds = 0.0;
+};
+
+// The queue sizes the settings offer, smallest first: the minimum, doubling up
+// to the maximum.
+std::vector<size_t> QualificationQueueSizes();
+
+// Whether this one configuration keeps up with the margin: its encoder, and
+// the disk taking the file it produces. What RecommendQualifiedSettings() asks
+// of each configuration, and what lets a caller probing from the highest level
+// down stop at the first that passes.
+bool EncodeKeepsUp(
+    const QualificationMeasurements& measurements,
+    const EncodeProbeResult& encode,
+    const QualificationMargins& margins = QualificationMargins{});
+
+// The settings the measurements support.
+//
+// The highest compression level whose encoder and whose file both keep up
+// with the margin, on the fewest threads that manage it — threads the encoder
+// does not need are left to the rest of the machine. Then the smallest queue
+// that covers the worst stall with its margin: depth beyond that is memory
+// locked away from everything else for nothing.
+QualificationResult RecommendQualifiedSettings(
+    const QualificationMeasurements& measurements,
+    const QualificationMargins& margins = QualificationMargins{});
+
+}  // namespace ddd::capture
@@ -0,0 +1,238 @@
+/************************************************************************
+
+    inband_telemetry.cpp
+
+    Buffer readings carried in the sample stream itself
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "inband_telemetry.h"
+
+#include <algorithm>
+
+namespace ddd::capture {
+namespace {
+
+uint16_t WordAt(const uint8_t* block, size_t word) {
+  return static_cast<uint16_t>(
+      static_cast<uint16_t>(block[word * kBytesPerSample]) |
+      static_cast<uint16_t>(
+          static_cast<uint16_t>(block[(word * kBytesPerSample) + 1]) << 8));
+}
+
+}  // namespace
+
+InbandTelemetry ParseInbandTelemetry(std::span<const uint8_t> block) {
+  InbandTelemetry telemetry;
+
+  if (block.size() < InbandTelemetryStripper::kBlockBytes) {
+    return telemetry;
+  }
+
+  const uint8_t* words = block.data();
+  if (WordAt(words, kInbandWordTag) != kInbandTag) {
+    return telemetry;
+  }
+
+  uint16_t check = 0;
+  for (size_t word = 0; word < kInbandWordCheck; ++word) {
+    check = static_cast<uint16_t>(check ^ WordAt(words, word));
+  }
+  if (check != WordAt(words, kInbandWordCheck)) {
+    return telemetry;
+  }
+
+  // Exactly the layout this build understands, for the reason
+  // ParseFpgaTelemetry gives
+  const uint16_t format_flags = WordAt(words, kInbandWordFormatFlags);
+  const uint8_t format = static_cast<uint8_t>(format_flags & 0xFF);
+  const uint8_t flags = static_cast<uint8_t>(format_flags >> 8);
+  if (format != kInbandFormat) {
+    return telemetry;
+  }
+
+  // The packet size is not in the block: it is the spacing the block was found
+  // at, and a host that found it knows it already
+  const uint16_t depth = WordAt(words, kInbandWordDepth);
+  if (depth <= kInbandPacketWords) {
+    return telemetry;
+  }
+
+  telemetry.packet_number = WordAt(words, kInbandWordPacketNumber);
+  telemetry.near_full = (flags & kInbandFlagNearFull) != 0;
+
+  FpgaTelemetry& reading = telemetry.reading;
+  reading.present = true;
+  reading.format = format;
+  reading.saturated = (flags & kInbandFlagSaturated) != 0;
+  reading.used_now = WordAt(words, kInbandWordUsed);
+  reading.peak = WordAt(words, kInbandWordPeak);
+  reading.dropped_words = WordAt(words, kInbandWordDropped);
+  reading.overflow_events = reading.dropped_words > 0 ? 1 : 0;
+  reading.overflow_since_open = reading.dropped_words > 0;
+  reading.packets_read = 1;
+  reading.depth_words = depth;
+  reading.packet_words = static_cast<uint16_t>(kInbandPacketWords);
+
+  return telemetry;
+}
+
+size_t InbandTelemetryStripper::MaximumBytesFor(size_t bytes) {
+  return MaximumBlocksFor(bytes) * kPacketDataBytes;
+}
+
+size_t InbandTelemetryStripper::MaximumBlocksFor(size_t bytes) {
+  return (kSynchronisationBytes + bytes) / kPacketBytes;
+}
+
+InbandTelemetryStripper::InbandTelemetryStripper() { Reset(); }
+
+void InbandTelemetryStripper::Reset() {
+  state_ = SequenceState::kSynchronising;
+  next_packet_ = 0;
+  packets_stripped_ = 0;
+  stream_words_ = 0;
+  gathered_.clear();
+  gathered_.reserve(kSynchronisationBytes);
+  pending_.clear();
+  pending_.reserve(kPacketBytes);
+}
+
+InbandTelemetryStripper::Outcome InbandTelemetryStripper::Process(
+    const uint8_t* stream, size_t bytes, uint8_t* output,
+    std::vector<InbandTelemetry>& blocks) {
+  Outcome outcome;
+
+  if (state_ == SequenceState::kFailed) {
+    outcome.ok = false;
+    return outcome;
+  }
+
+  if (state_ == SequenceState::kRunning) {
+    outcome.ok = Consume(stream, bytes, output, outcome, blocks);
+    return outcome;
+  }
+
+  // Only as much as the search reads is gathered; the rest of this buffer is
+  // consumed from where it lies once the lock is taken.
+  const size_t take =
+      std::min(bytes, kSynchronisationBytes - gathered_.size());
+  gathered_.insert(gathered_.end(), stream, stream + take);
+  if (gathered_.size() < kSynchronisationBytes) {
+    return outcome;
+  }
+
+  size_t offset = 0;
+  if (!Synchronise(outcome, offset)) {
+    state_ = SequenceState::kFailed;
+    outcome.ok = false;
+    outcome.blocks_found = false;
+    gathered_.clear();
+    return outcome;
+  }
+
+  state_ = SequenceState::kRunning;
+  outcome.ok = Consume(gathered_.data() + offset, gathered_.size() - offset,
+                       output, outcome, blocks) &&
+               Consume(stream + take, bytes - take, output, outcome, blocks);
+  gathered_.clear();
+  return outcome;
+}
+
+bool InbandTelemetryStripper::Synchronise(Outcome& outcome, size_t& offset) {
+  // Even offsets only, as in PackedUnpacker: the device sends words.
+  for (offset = 0; offset < kPacketBytes; offset += kBytesPerSample) {
+    const auto block_at = [this, offset](size_t packet) {
+      const uint8_t* const block =
+          gathered_.data() + offset + (packet * kPacketBytes);
+      return ParseInbandTelemetry(std::span<const uint8_t>(block, kBlockBytes));
+    };
+
+    const InbandTelemetry first = block_at(0);
+    if (!first.reading.present) {
+      continue;
+    }
+    const InbandTelemetry second = block_at(1);
+    const InbandTelemetry third = block_at(2);
+
+    if (second.reading.present && third.reading.present &&
+        second.packet_number ==
+            static_cast<uint16_t>(first.packet_number + 1) &&
+        third.packet_number == static_cast<uint16_t>(first.packet_number + 2)) {
+      next_packet_ = first.packet_number;
+      outcome.synchronised_here = true;
+      outcome.synchronisation_byte_offset = offset;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool InbandTelemetryStripper::Consume(const uint8_t* data, size_t bytes,
+                                      uint8_t* output, Outcome& outcome,
+                                      std::vector<InbandTelemetry>& blocks) {
+  if (!pending_.empty()) {
+    const size_t take = std::min(bytes, kPacketBytes - pending_.size());
+    pending_.insert(pending_.end(), data, data + take);
+    data += take;
+    bytes -= take;
+
+    if (pending_.size() < kPacketBytes) {
+      return true;
+    }
+    if (!StripPacket(pending_.data(), output, outcome, blocks)) {
+      return false;
+    }
+    pending_.clear();
+  }
+
+  while (bytes >= kPacketBytes) {
+    if (!StripPacket(data, output, outcome, blocks)) {
+      return false;
+    }
+    data += kPacketBytes;
+    bytes -= kPacketBytes;
+  }
+
+  pending_.assign(data, data + bytes);
+  return true;
+}
+
+bool InbandTelemetryStripper::StripPacket(
+    const uint8_t* packet, uint8_t* output, Outcome& outcome,
+    std::vector<InbandTelemetry>& blocks) {
+  InbandTelemetry telemetry =
+      ParseInbandTelemetry(std::span<const uint8_t>(packet, kBlockBytes));
+
+  if (!telemetry.reading.present) {
+    state_ = SequenceState::kFailed;
+    outcome.fault_packet_index = packets_stripped_;
+    outcome.block_damaged = true;
+    return false;
+  }
+
+  if (telemetry.packet_number != next_packet_) {
+    state_ = SequenceState::kFailed;
+    outcome.fault_packet_index = packets_stripped_;
+    outcome.expected_packet = next_packet_;
+    outcome.actual_packet = telemetry.packet_number;
+    return false;
+  }
+
+  std::copy_n(packet + kBlockBytes, kPacketDataBytes,
+              output + outcome.data_bytes);
+  outcome.data_bytes += kPacketDataBytes;
+
+  telemetry.stream_word = stream_words_;
+  blocks.push_back(telemetry);
+
+  stream_words_ += kPacketDataBytes / kBytesPerSample;
+  ++next_packet_;
+  ++packets_stripped_;
+  return true;
+}
+
+}  // namespace ddd::capture
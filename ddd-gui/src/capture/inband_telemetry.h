@@ -0,0 +1,177 @@
+/************************************************************************
+
+    inband_telemetry.h
+
+    Buffer readings carried in the sample stream itself
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "fpga_telemetry.h"
+#include "sample_format.h"
+#include "sequence_validator.h"
+#include "wire_protocol.h"
+
+namespace ddd::capture {
+
+// One packet's in-band block: the device's buffer as it stood when the packet
+// was offered, and what it went through since the packet before.
+//
+// The polled reading in FpgaTelemetry is a sample taken four times a second,
+// so it can say a stall happened and cannot say where. This can: there is one
+// per packet, and each is tied to the samples that follow it in the stream.
+struct InbandTelemetry {
+  // Numbered by the gateware from reset, one per packet offered, wrapping at
+  // 65536. Consecutive packets carry consecutive numbers, which is what makes
+  // a packet lost between the device and this host a detectable fault.
+  uint16_t packet_number = 0;
+
+  // Where the packet's samples start in the stream the stripper writes, in
+  // words since it locked. In the word format that is a sample index; packed,
+  // it is a position in the packed stream, ahead of unpacking.
+  uint64_t stream_word = 0;
+
+  // The occupancy reached since the previous packet was offered was at or
+  // above the gateware's near-full mark.
+  bool near_full = false;
+
+  // The reading, in FpgaTelemetry's terms so that it is judged exactly as a
+  // polled one is. It covers one packet interval: used_now is the occupancy
+  // as the packet was offered, packets_read is one, and overflow_events is one
+  // when anything was dropped in the interval. The near-full duration and the
+  // lifetime figures are not in the block; those stay with the polled reading.
+  FpgaTelemetry reading;
+};
+
+// Parse one block. The reading's present flag is false for anything that is
+// not a well-formed block — wrong tag, wrong format, a check word that does
+// not match — and the rest is then meaningless.
+InbandTelemetry ParseInbandTelemetry(std::span<const uint8_t> block);
+
+// Takes the in-band blocks out of the device's stream and hands back the
+// samples, in the order the device sent them and with nothing missing.
+//
+// It stands in front of everything else on the processing thread — in front of
+// PackedUnpacker too, because the gateware puts the block at the head of the
+// packet whatever the packet holds — and it is a continuity check in its own
+// right: the packet numbers count up, so a packet lost between the device and
+// the ring is found here even in a stream with no markers of its own.
+//
+// Structured as PackedUnpacker is and for the same reasons. A packet can
+// straddle two buffers, so a partial one is carried across calls, in a buffer
+// Reset reserves as it does the one the lock is searched in. The lock is
+// taken on three consecutive blocks a packet apart and counting, because the
+// stream opens on whatever was in flight. Packed data can hold anything, so a
+// tag alone would prove nothing; three well-formed blocks exactly a packet
+// apart and numbered in order is a coincidence nothing in a stream produces.
+//
+// Thread-safety: none. One instance belongs to the processing thread for the
+// life of a capture.
+class InbandTelemetryStripper {
+ public:
+  static constexpr size_t kPacketBytes = kInbandPacketWords * kBytesPerSample;
+  static constexpr size_t kBlockBytes = kInbandBlockWords * kBytesPerSample;
+  static constexpr size_t kPacketDataBytes = kPacketBytes - kBlockBytes;
+
+  // Bytes the lock is looked for in: a packet's worth of candidate offsets,
+  // each with the two blocks that must follow it.
+  static constexpr size_t kSynchronisationBytes = 4 * kPacketBytes;
+
+  struct Outcome {
+    // False for a packet number that did not follow its predecessor, a block
+    // that failed its check, and a stream in which no blocks could be found at
+    // all — which, as with a packed stream with no headers, is a failure rather
+    // than an old device: blocks are only ever asked for from gateware that
+    // said it would send them.
+    bool ok = true;
+
+    // Sample bytes written to the output. Everything before a fault is
+    // written: those samples were real.
+    size_t data_bytes = 0;
+
+    // Where a fault was, in packets since the lock was taken. For a mismatch,
+    // the two numbers as well. Meaningless when ok is true or blocks_found is
+    // false.
+    uint64_t fault_packet_index = 0;
+    bool block_damaged = false;
+    uint16_t expected_packet = 0;
+    uint16_t actual_packet = 0;
+
+    // False when the search for a lock ran out of data to search.
+    bool blocks_found = true;
+
+    // True when the lock was taken during this call, at this byte offset into
+    // what had been gathered for the search.
+    bool synchronised_here = false;
+    size_t synchronisation_byte_offset = 0;
+  };
+
+  // The most sample bytes one call can write, for `bytes` of input. What the
+  // output buffer must hold, on the same terms as
+  // PackedUnpacker::MaximumSamplesFor.
+  static size_t MaximumBytesFor(size_t bytes);
+
+  // The most blocks one call can append, for `bytes` of input.
+  static size_t MaximumBlocksFor(size_t bytes);
+
+  // Strip, check and append. `output` must have room for MaximumBytesFor(bytes)
+  // bytes. One InbandTelemetry is appended to `blocks` for each packet
+  // completed; a caller that reserves MaximumBlocksFor(bytes) beforehand makes
+  // this allocation-free.
+  InbandTelemetryStripper();
+
+  Outcome Process(const uint8_t* stream, size_t bytes, uint8_t* output,
+                  std::vector<InbandTelemetry>& blocks);
+
+  // kSynchronising until the lock is taken, kRunning after, kFailed for good
+  // once anything is wrong. Never kDisabled.
+  SequenceState state() const { return state_; }
+
+  // Start again, looking for a lock, with the capacity of both buffers taken
+  // here rather than on the processing thread.
+  void Reset();
+
+ private:
+  // Look for the lock in what has been gathered. On success, the offset of
+  // the first locked packet in it.
+  bool Synchronise(Outcome& outcome, size_t& offset);
+
+  // Strip a run of locked stream: finish any carried packet, strip every
+  // whole packet that follows, and carry what is left. False on a fault.
+  bool Consume(const uint8_t* data, size_t bytes, uint8_t* output,
+               Outcome& outcome, std::vector<InbandTelemetry>& blocks);
+
+  // Check one whole packet's block and copy out its samples. False, with the
+  // fault recorded, when the block is damaged or misnumbered.
+  bool StripPacket(const uint8_t* packet, uint8_t* output, Outcome& outcome,
+                   std::vector<InbandTelemetry>& blocks);
+
+  SequenceState state_ = SequenceState::kSynchronising;
+
+  // The number the next packet should carry
+  uint16_t next_packet_ = 0;
+  uint64_t packets_stripped_ = 0;
+
+  // Sample words written since the lock, which is where the next packet's
+  // samples will start
+  uint64_t stream_words_ = 0;
+
+  // The first kSynchronisationBytes of the stream, gathered to look for a
+  // lock in; unused once it is taken.
+  std::vector<uint8_t> gathered_;
+
+  // The opening bytes of a packet the last buffer ended part way through.
+  // Never more than a packet.
+  std::vector<uint8_t> pending_;
+};
+
+}  // namespace ddd::capture
@@ -72,6 +72,22 @@ class IJtagCable {
   virtual bool Shift(std::span<const uint8_t> tms, std::span<const uint8_t> tdi,
                      size_t bit_count, std::vector<uint8_t>* tdo) = 0;
 
+  // Shift() with the answer allowed to arrive later.
+  //
+  // `tdo` is sized at once and filled in by the time the next Flush() has
+  // returned true, so it must stay where it is until then. What that buys is
+  // the round trip: a run of scans that are each read back costs one wait for
+  // the cable rather than one each, and the player is the one that knows when
+  // an answer is needed before anything more is sent (svf_player.h).
+  //
+  // The default is Shift(), which fills `tdo` before it returns and so keeps
+  // the promise trivially.
+  virtual bool ShiftDeferred(std::span<const uint8_t> tms,
+                             std::span<const uint8_t> tdi, size_t bit_count,
+                             std::vector<uint8_t>* tdo) {
+    return Shift(tms, tdi, bit_count, tdo);
+  }
+
   // Clock `count` cycles with TMS and TDI held low, capturing nothing.
   //
   // This is SVF's RUNTEST, and it is not a convenience: an EPCS write spends
@@ -82,7 +98,8 @@ class IJtagCable {
   // would take. Expressing it as a shift of zeros would hide that.
   virtual bool RunClock(size_t count) = 0;
 
-  // Send anything still buffered and wait for the cable to have taken it.
+  // Send anything still buffered, wait for the cable to have taken it, and
+  // collect every answer ShiftDeferred() still owes.
   //
   // Called at the end of a run, and by the implementation itself whenever a
   // caller asks for TDO. A player that never reads anything back must still
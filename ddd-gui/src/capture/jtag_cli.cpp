@@ -156,6 +156,15 @@ int RunJtagCli(const std::vector<std::string>& args, std::ostream& out,
 
   StreamLogger logger(out);
 
+  // Read before any cable is opened, so that a file this cannot play is
+  // said to be one without a board ever being touched.
+  const SvfCompileResult compiled = CompileSvf(text);
+  if (!compiled.succeeded) {
+    error << "Failed at line " << compiled.line << ": " << compiled.problem
+          << "\n";
+    return kJtagCliFile;
+  }
+
   // The cable, or the one that goes nowhere. Chosen here and nowhere else:
   // everything below this line is identical in both modes, which is what
   // makes a dry run worth trusting as a check of the real one.
@@ -194,7 +203,7 @@ int RunJtagCli(const std::vector<std::string>& args, std::ostream& out,
   });
 
   const auto started = std::chrono::steady_clock::now();
-  const SvfPlayResult result = player.Play(text);
+  const SvfPlayResult result = player.Play(compiled.program);
   const double seconds =
       std::chrono::duration<double>(std::chrono::steady_clock::now() - started)
           .count();
@@ -204,8 +213,7 @@ int RunJtagCli(const std::vector<std::string>& args, std::ostream& out,
   if (!result.succeeded) {
     error << (result.stopped ? "Stopped" : "Failed") << " at line "
           << result.line << ": " << result.problem << "\n";
-    return result.statements == 0 && !result.stopped ? kJtagCliFile
-                                                     : kJtagCliFailed;
+    return kJtagCliFailed;
   }
 
   // The numbers a bench run exists to produce: what the file asked for, and
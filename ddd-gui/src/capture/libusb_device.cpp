@@ -14,9 +14,11 @@
 
 #include <libusb.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -25,6 +27,7 @@
 #include <vector>
 
 #include "libusb_source.h"
+#include "log_format.h"
 #include "logger.h"
 #include "sysfs_device_list.h"
 #include "wire_protocol.h"
@@ -167,9 +170,11 @@ class LibUsbControlChannel : public IUsbControlChannel {
   // belongs to a context the backend may otherwise recycle, and an update
   // holds this channel open for minutes while the device monitor carries on
   // enumerating.
-  LibUsbControlChannel(libusb_device_handle* handle, bool claimed,
-                       std::shared_ptr<const void> lease, ILogger* logger)
-      : handle_(handle),
+  LibUsbControlChannel(libusb_context* context, libusb_device_handle* handle,
+                       bool claimed, std::shared_ptr<const void> lease,
+                       ILogger* logger)
+      : context_(context),
+        handle_(handle),
         claimed_(claimed),
         lease_(std::move(lease)),
         logger_(logger) {}
@@ -193,14 +198,157 @@ class LibUsbControlChannel : public IUsbControlChannel {
     // log: the update flow asks devices things they may not be able to do,
     // and finding out is the point of asking.
     if (result < 0 && result != LIBUSB_ERROR_PIPE && logger_ != nullptr) {
-      logger_->Debug(std::string("Update control transfer 0x") +
-                     std::to_string(request) +
+      logger_->Debug("Update control transfer " + FormatHex(request, 2) +
                      " failed: " + libusb_error_name(result));
     }
     return result;
   }
 
+  // The asynchronous path: a ring of `depth` transfers, each with its own
+  // setup-and-data buffer, reaped strictly oldest first so that completions
+  // are counted in the order the device saw them.
+  size_t TransferQueued(
+      uint8_t request_type, uint8_t request,
+      std::span<const ControlWrite> writes, size_t depth,
+      unsigned int timeout_milliseconds,
+      const std::function<bool(size_t completed)>& on_complete) override {
+    depth = std::clamp<size_t>(depth, 1, kMaximumQueuedControlTransfers);
+    if (depth == 1) {
+      return IUsbControlChannel::TransferQueued(request_type, request, writes,
+                                                depth, timeout_milliseconds,
+                                                on_complete);
+    }
+
+    LibUsbQueuedRing ring(*this, request_type, request, depth,
+                          timeout_milliseconds);
+    if (!ring.allocated()) {
+      return IUsbControlChannel::TransferQueued(request_type, request, writes,
+                                                1, timeout_milliseconds,
+                                                on_complete);
+    }
+    return RunQueuedControlTransfers(writes, depth, ring, on_complete);
+  }
+
  private:
+  // Eight is enough to hide the host's turnaround behind the device's write
+  // several times over, and few enough that a refused chunk has not dragged a
+  // long tail of doomed requests in behind it.
+  static constexpr size_t kMaximumQueuedControlTransfers = 8;
+
+  // A ring of libusb transfers, each with its own setup-and-data buffer.
+  class LibUsbQueuedRing : public IQueuedControlRing {
+   public:
+    LibUsbQueuedRing(LibUsbControlChannel& channel, uint8_t request_type,
+                     uint8_t request, size_t depth,
+                     unsigned int timeout_milliseconds)
+        : channel_(channel),
+          request_type_(request_type),
+          request_(request),
+          timeout_milliseconds_(timeout_milliseconds),
+          slots_(depth) {
+      for (Slot& slot : slots_) {
+        slot.transfer = libusb_alloc_transfer(0);
+        if (slot.transfer == nullptr) {
+          allocated_ = false;
+        }
+      }
+    }
+
+    ~LibUsbQueuedRing() override {
+      for (Slot& slot : slots_) {
+        if (slot.transfer != nullptr) {
+          libusb_free_transfer(slot.transfer);
+        }
+      }
+    }
+
+    LibUsbQueuedRing(const LibUsbQueuedRing&) = delete;
+    LibUsbQueuedRing& operator=(const LibUsbQueuedRing&) = delete;
+
+    bool allocated() const { return allocated_; }
+
+    bool Submit(size_t index, const ControlWrite& write) override {
+      Slot& slot = slots_[index];
+      slot.buffer.resize(LIBUSB_CONTROL_SETUP_SIZE + write.data.size());
+      libusb_fill_control_setup(slot.buffer.data(), request_type_, request_,
+                                write.value, write.index,
+                                static_cast<uint16_t>(write.data.size()));
+      std::copy(write.data.begin(), write.data.end(),
+                slot.buffer.begin() + LIBUSB_CONTROL_SETUP_SIZE);
+      libusb_fill_control_transfer(slot.transfer, channel_.handle_,
+                                   slot.buffer.data(),
+                                   &LibUsbQueuedRing::Trampoline, &slot,
+                                   timeout_milliseconds_);
+      slot.done = 0;
+
+      const int result = libusb_submit_transfer(slot.transfer);
+      if (result != 0) {
+        channel_.LogQueuedFailure(request_, libusb_error_name(result));
+        return false;
+      }
+      return true;
+    }
+
+    void Wait(size_t index) override {
+      Slot& slot = slots_[index];
+      while (slot.done == 0) {
+        libusb_handle_events_completed(channel_.context_, &slot.done);
+      }
+    }
+
+    bool Succeeded(size_t index) override {
+      const Slot& slot = slots_[index];
+      const libusb_transfer* const transfer = slot.transfer;
+      const int expected =
+          static_cast<int>(slot.buffer.size() - LIBUSB_CONTROL_SETUP_SIZE);
+      if (transfer->status == LIBUSB_TRANSFER_COMPLETED &&
+          transfer->actual_length == expected) {
+        return true;
+      }
+
+      // A stall is the device refusing the chunk, and it will say why
+      // through its status; anything else is the transport, and worth a
+      // line.
+      if (transfer->status != LIBUSB_TRANSFER_STALL) {
+        const std::string reason =
+            transfer->status == LIBUSB_TRANSFER_COMPLETED
+                ? std::string("a short data stage")
+                : "transfer status " +
+                      std::to_string(static_cast<int>(transfer->status));
+        channel_.LogQueuedFailure(request_, reason);
+      }
+      return false;
+    }
+
+   private:
+    struct Slot {
+      libusb_transfer* transfer = nullptr;
+      std::vector<uint8_t> buffer;
+
+      // What libusb_handle_events_completed watches.
+      int done = 0;
+    };
+
+    static void LIBUSB_CALL Trampoline(libusb_transfer* transfer) {
+      static_cast<Slot*>(transfer->user_data)->done = 1;
+    }
+
+    LibUsbControlChannel& channel_;
+    const uint8_t request_type_;
+    const uint8_t request_;
+    const unsigned int timeout_milliseconds_;
+    std::vector<Slot> slots_;
+    bool allocated_ = true;
+  };
+
+  void LogQueuedFailure(uint8_t request, const std::string& why) {
+    if (logger_ != nullptr) {
+      logger_->Debug("Queued update control transfer " +
+                     FormatHex(request, 2) + " failed: " + why);
+    }
+  }
+
+  libusb_context* context_ = nullptr;
   libusb_device_handle* handle_ = nullptr;
   bool claimed_ = false;
   std::shared_ptr<const void> lease_;
@@ -561,7 +709,7 @@ class LibUsbDevice : public IUsbDevice {
     const bool claimed = libusb_claim_interface(handle, kInterfaceNumber) == 0;
 
     return std::make_unique<LibUsbControlChannel>(
-        handle, claimed, std::move(lease.token), logger_);
+        lease.context, handle, claimed, std::move(lease.token), logger_);
   }
 
  private:
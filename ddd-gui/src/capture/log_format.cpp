@@ -59,6 +59,19 @@ std::string FormatDecimal(double value, int decimals) {
   return text;
 }
 
+std::string FormatHex(uint64_t value, int digits) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string reversed;
+  do {
+    reversed.push_back(kDigits[value & 0x0F]);
+    value >>= 4;
+  } while (value != 0);
+  while (static_cast<int>(reversed.size()) < digits) {
+    reversed.push_back('0');
+  }
+  return "0x" + std::string(reversed.rbegin(), reversed.rend());
+}
+
 std::string FormatBytes(uint64_t bytes) {
   constexpr uint64_t kKibi = uint64_t{1} << 10;
   constexpr uint64_t kMebi = uint64_t{1} << 20;
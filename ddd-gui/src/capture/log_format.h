@@ -37,6 +37,12 @@ std::string FormatDecimal(double value, int decimals);
 // buffer or a multiple of one.
 std::string FormatBytes(uint64_t bytes);
 
+// A register, request or address the way the datasheet and the firmware write
+// it: "0x" and lowercase hex digits, padded with zeros to at least `digits`.
+// A vendor request logged as 180 when the firmware's table says 0xb4 sends the
+// reader looking for a request that does not exist.
+std::string FormatHex(uint64_t value, int digits);
+
 // A duration, in whichever of four forms carries the most meaning at that
 // length: "412 ms", "3.24 s", "4 m 07 s", "1 h 12 m 04 s". Milliseconds below a
 // second because that is the scale an encoder flush is measured on; hours and
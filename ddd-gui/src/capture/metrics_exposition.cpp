@@ -0,0 +1,323 @@
+/************************************************************************
+
+    metrics_exposition.cpp
+
+    A capture's figures in the text format a metrics scraper reads
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "metrics_exposition.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <utility>
+
+#include "sequence_validator.h"
+#include "transfer_result.h"
+
+namespace ddd::capture {
+namespace {
+
+// One page being written. Each metric is a header and then its series, and a
+// metric's series have to follow its header without another metric between —
+// the format has no other way of saying which series belong to which.
+class Page {
+ public:
+  void Header(const char* name, const char* type, const char* help) {
+    text_ += "# HELP ";
+    text_ += name;
+    text_ += ' ';
+    text_ += help;
+    text_ += "\n# TYPE ";
+    text_ += name;
+    text_ += ' ';
+    text_ += type;
+    text_ += '\n';
+  }
+
+  // `labels` is written as given, braces and all, or not at all when empty.
+  // Every label value on this page is one of a fixed set of words, so none of
+  // them needs the format's escaping.
+  void Sample(const std::string& name, const std::string& labels,
+              double value) {
+    text_ += name;
+    text_ += labels;
+    text_ += ' ';
+    text_ += FormatMetricValue(value);
+    text_ += '\n';
+  }
+
+  void Sample(const std::string& name, const std::string& labels,
+              uint64_t value) {
+    text_ += name;
+    text_ += labels;
+    text_ += ' ';
+    text_ += std::to_string(value);
+    text_ += '\n';
+  }
+
+  // A metric with one unlabelled series, which is most of them.
+  void Gauge(const char* name, const char* help, double value) {
+    Header(name, "gauge", help);
+    Sample(name, std::string(), value);
+  }
+
+  void Gauge(const char* name, const char* help, uint64_t value) {
+    Header(name, "gauge", help);
+    Sample(name, std::string(), value);
+  }
+
+  void Counter(const char* name, const char* help, uint64_t value) {
+    Header(name, "counter", help);
+    Sample(name, std::string(), value);
+  }
+
+  void Histogram(const char* name, const char* help,
+                 const MetricsHistogram& histogram) {
+    Header(name, "histogram", help);
+    const std::string base(name);
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < histogram.upper_bounds().size();
+         ++bucket) {
+      cumulative += histogram.counts()[bucket];
+      Sample(base + "_bucket",
+             "{le=\"" + FormatMetricValue(histogram.upper_bounds()[bucket]) +
+                 "\"}",
+             cumulative);
+    }
+    Sample(base + "_bucket", "{le=\"+Inf\"}", histogram.count());
+    Sample(base + "_sum", std::string(), histogram.sum());
+    Sample(base + "_count", std::string(), histogram.count());
+  }
+
+  std::string Take() { return std::move(text_); }
+
+ private:
+  std::string text_;
+};
+
+std::string Label(const char* name, const char* value) {
+  return std::string("{") + name + "=\"" + value + "\"}";
+}
+
+}  // namespace
+
+MetricsHistogram::MetricsHistogram(std::span<const double> upper_bounds)
+    : upper_bounds_(upper_bounds.begin(), upper_bounds.end()),
+      counts_(upper_bounds.size() + 1, 0) {}
+
+void MetricsHistogram::Observe(double value) {
+  // A NaN would land in +Inf and poison the sum for the life of the process.
+  if (std::isnan(value)) {
+    return;
+  }
+  const auto bound =
+      std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), value);
+  ++counts_[static_cast<size_t>(bound - upper_bounds_.begin())];
+  ++count_;
+  sum_ += value;
+}
+
+CaptureMetrics::CaptureMetrics()
+    : ring_depth_(kFillPercentBuckets), back_pressure_(kFillPercentBuckets) {}
+
+void CaptureMetrics::Observe(const CaptureStats& stats) {
+  if (stats.slot_count > 0) {
+    ring_depth_.Observe(100.0 * static_cast<double>(stats.slots_in_use) /
+                        static_cast<double>(stats.slot_count));
+  }
+  if (stats.device_buffer.present) {
+    back_pressure_.Observe(stats.device_buffer.BackPressurePercent());
+  }
+}
+
+StageLatency StageLatencyFrom(const CaptureStats& stats,
+                              const MetricsContext& context) {
+  StageLatency latency;
+  if (context.sample_rate_hz <= 0.0) {
+    return latency;
+  }
+  // One word of the device's FIFO is one sample.
+  latency.device_seconds =
+      stats.device_buffer.present
+          ? static_cast<double>(stats.device_buffer.used_now) /
+                context.sample_rate_hz
+          : 0.0;
+  latency.ring_seconds = static_cast<double>(stats.slots_in_use) *
+                         static_cast<double>(context.ring_slot_samples) /
+                         context.sample_rate_hz;
+  latency.sink_seconds =
+      static_cast<double>(stats.samples_pending) / context.sample_rate_hz;
+  return latency;
+}
+
+std::string CaptureMetrics::Format(const CaptureStats& stats,
+                                   const MetricsContext& context) const {
+  Page page;
+
+  page.Gauge("ddd_capture_running",
+             "Whether a run is going on. The figures below stay at the last "
+             "run's values once it ends.",
+             static_cast<uint64_t>(context.running ? 1 : 0));
+  page.Gauge("ddd_capture_writing",
+             "Whether the run is writing a file rather than only monitoring.",
+             static_cast<uint64_t>(stats.writing ? 1 : 0));
+
+  // State as a label on a constant series, which is how the format carries a
+  // word: a graph of it is a line that changes colour.
+  page.Header("ddd_capture_result", "gauge",
+              "How the run stands or how it ended, as the result label.");
+  page.Sample("ddd_capture_result",
+              Label("result", TransferResultName(stats.result)),
+              static_cast<uint64_t>(1));
+  page.Header("ddd_sequence_state", "gauge",
+              "Whether the sample sequence is being followed, as the state "
+              "label.");
+  page.Sample("ddd_sequence_state",
+              Label("state", SequenceStateName(stats.sequence_state)),
+              static_cast<uint64_t>(1));
+
+  page.Gauge("ddd_capture_elapsed_seconds", "How long the run has been going.",
+             stats.elapsed_seconds);
+  page.Gauge("ddd_capture_throughput_bytes_per_second",
+             "The rate across the last second or so; zero until there is a "
+             "reading.",
+             stats.throughput_bytes_per_second);
+  page.Counter("ddd_capture_transfers_total",
+               "USB transfers completed this run.", stats.transfers_completed);
+  page.Counter("ddd_capture_buffers_processed_total",
+               "Buffers the processing thread has taken off the ring this run.",
+               stats.buffers_processed);
+  page.Counter("ddd_capture_buffers_skipped_total",
+               "Of those, buffers only their counter changes were checked in, "
+               "while monitoring.",
+               stats.buffers_skipped);
+  page.Counter("ddd_capture_written_bytes_total",
+               "Bytes written to the capture file this run.",
+               stats.bytes_written);
+  page.Counter("ddd_capture_written_samples_total",
+               "Samples written to the capture file this run.",
+               stats.samples_written);
+  page.Gauge("ddd_sink_pending_samples",
+             "Samples the sink has taken but not yet committed to the file.",
+             stats.samples_pending);
+
+  page.Gauge("ddd_ring_slots_in_use", "Slots of the host's ring now filled.",
+             static_cast<uint64_t>(stats.slots_in_use));
+  page.Gauge("ddd_ring_slots_in_use_peak",
+             "The most slots of the ring filled at once this run.",
+             static_cast<uint64_t>(stats.peak_slots_in_use));
+  page.Gauge("ddd_ring_slots", "Slots in the host's ring.",
+             static_cast<uint64_t>(stats.slot_count));
+  page.Histogram("ddd_ring_depth_percent",
+                 "How full the host's ring was, at each stats report since "
+                 "the application started.",
+                 ring_depth_);
+
+  // Only for a device that reports its buffer. A source without the instrument
+  // is not a device with an empty buffer, and a graph should show a gap for it
+  // rather than a flat line at zero.
+  if (stats.device_buffer.present) {
+    page.Gauge("ddd_device_buffer_used_words",
+               "Words in the device's capture buffer at the latest reading.",
+               static_cast<uint64_t>(stats.device_buffer.used_now));
+    page.Gauge("ddd_device_buffer_depth_words",
+               "Words the device's capture buffer holds.",
+               static_cast<uint64_t>(stats.device_buffer.depth_words));
+    page.Gauge("ddd_device_back_pressure_peak_percent",
+               "The worst back pressure the device reported this run.",
+               static_cast<uint64_t>(
+                   std::max(stats.peak_back_pressure_percent, 0)));
+  }
+  page.Histogram("ddd_device_back_pressure_percent",
+                 "The device's back pressure, at each stats report since the "
+                 "application started.",
+                 back_pressure_);
+  page.Counter("ddd_device_overflow_events_total",
+               "Times the device's buffer overflowed this run.",
+               stats.device_overflow_events);
+  page.Counter("ddd_device_dropped_words_total",
+               "Samples the device dropped to overflow this run.",
+               stats.device_dropped_words);
+
+  if (context.sample_rate_hz > 0.0) {
+    const StageLatency latency = StageLatencyFrom(stats, context);
+    page.Header("ddd_stage_latency_seconds", "gauge",
+                "How long a sample waits at each stage, from the depth of "
+                "the queue in front of it.");
+    if (stats.device_buffer.present) {
+      page.Sample("ddd_stage_latency_seconds", Label("stage", "device"),
+                  latency.device_seconds);
+    }
+    page.Sample("ddd_stage_latency_seconds", Label("stage", "ring"),
+                latency.ring_seconds);
+    page.Sample("ddd_stage_latency_seconds", Label("stage", "sink"),
+                latency.sink_seconds);
+  }
+
+  if (stats.threads.present()) {
+    page.Header("ddd_thread_cpu_seconds_total", "counter",
+                "CPU time each kind of capture thread has had this run.");
+    const std::array<std::pair<const char*, const ThreadUsage*>, 3> roles = {{
+        {"transfer", &stats.threads.transfer},
+        {"processing", &stats.threads.processing},
+        {"encoder", &stats.threads.encoder},
+    }};
+    for (const auto& [role, usage] : roles) {
+      if (usage->present) {
+        page.Sample("ddd_thread_cpu_seconds_total", Label("role", role),
+                    usage->CpuSeconds());
+      }
+    }
+  }
+
+  const SampleMetricsSnapshot& metrics = stats.metrics;
+  page.Gauge("ddd_signal_rms", "RMS of the signal over the whole run.",
+             metrics.rms);
+  page.Gauge("ddd_signal_recent_rms",
+             "RMS of the signal over the most recent buffer.",
+             metrics.recent_rms);
+  page.Gauge("ddd_signal_recent_minimum",
+             "Lowest sample code in the most recent buffer.",
+             static_cast<uint64_t>(metrics.recent_minimum_value));
+  page.Gauge("ddd_signal_recent_maximum",
+             "Highest sample code in the most recent buffer.",
+             static_cast<uint64_t>(metrics.recent_maximum_value));
+  page.Header("ddd_signal_clipped_samples_total", "counter",
+              "Samples at either end of the converter's range this run.");
+  page.Sample("ddd_signal_clipped_samples_total", Label("edge", "low"),
+              metrics.clipped_low_count);
+  page.Sample("ddd_signal_clipped_samples_total", Label("edge", "high"),
+              metrics.clipped_high_count);
+  page.Counter("ddd_signal_dropouts_total",
+               "Places the RF envelope collapsed this run.",
+               stats.dropouts.event_count);
+
+  return page.Take();
+}
+
+std::string FormatMetricValue(double value) {
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  // to_chars rather than snprintf: it ignores the locale, so a host set to a
+  // European one still writes a point, and it writes the shortest text that
+  // reads back as the same double, so 0.1 is "0.1" and not "0.100000".
+  std::array<char, 32> buffer{};
+  const auto [end, error] =
+      std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  if (error != std::errc()) {
+    return "NaN";
+  }
+  return std::string(buffer.data(), end);
+}
+
+}  // namespace ddd::capture
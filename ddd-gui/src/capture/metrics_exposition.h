@@ -0,0 +1,140 @@
+/************************************************************************
+
+    metrics_exposition.h
+
+    A capture's figures in the text format a metrics scraper reads
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "monitor_tap.h"
+
+namespace ddd::capture {
+
+// What a capture host looks like to the machine that watches a rack of them.
+//
+// The panels and the headless runner's progress lines are for a person looking
+// at one capture. A station running several decks overnight wants something
+// else: a number per figure, on a page a scraper can fetch every few seconds,
+// graphed beside the same numbers from every other host. This is that page, in
+// the text exposition format Prometheus and everything compatible with it
+// reads — a HELP and a TYPE line per metric, then one "name{labels} value"
+// line per series.
+//
+// Everything on it comes out of one CaptureStats, taken with
+// StatsPublisher::Read on the thread that is answering the scrape, so serving
+// it is a copy on a reader's side and nothing at all on the pipeline's. The two
+// histograms are the exception, and only in where their readings come from:
+// a scrape every fifteen seconds sees one ring depth in three hundred, so they
+// are fed from the stats timer instead — see CaptureMetrics::Observe.
+//
+// The counters are the run's own and go back to zero when the next run starts.
+// A scraper takes a counter that went down as a reset and carries on, which is
+// exactly what a new run is.
+//
+// Qt-free, so the page can be tested line by line without a socket.
+
+// Buckets for the two fill histograms, as upper bounds in percent. Fine at
+// the bottom, where a healthy run spends its whole life, and coarse above
+// half, where a run that gets there at all is already the thing to look at.
+inline constexpr double kFillPercentBuckets[] = {1,  5,  10, 25,
+                                                 50, 75, 90, 100};
+
+// A histogram on fixed bounds, held per bucket and written cumulatively, the
+// way the exposition wants it.
+class MetricsHistogram {
+ public:
+  explicit MetricsHistogram(std::span<const double> upper_bounds);
+
+  // Into the first bucket whose bound is at or above it, or the +Inf bucket
+  // past the last.
+  void Observe(double value);
+
+  const std::vector<double>& upper_bounds() const { return upper_bounds_; }
+
+  // Per bucket, not cumulative, with the +Inf bucket last — one more entry
+  // than there are bounds.
+  const std::vector<uint64_t>& counts() const { return counts_; }
+
+  uint64_t count() const { return count_; }
+  double sum() const { return sum_; }
+
+ private:
+  std::vector<double> upper_bounds_;
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  double sum_ = 0.0;
+};
+
+// What the stats block does not carry and the page needs to turn counts into
+// seconds.
+struct MetricsContext {
+  // Whether a run is going on, monitoring or capturing. The stats block keeps
+  // the last run's figures after it has ended, which a scraper should go on
+  // seeing — but with a gauge that says they are no longer moving.
+  bool running = false;
+
+  // The rate the run is sampling at. Zero leaves the latencies off the page
+  // rather than dividing by it.
+  double sample_rate_hz = 0.0;
+
+  // Samples in one slot of the ring, or zero when there is no ring.
+  uint64_t ring_slot_samples = 0;
+};
+
+// The histograms a host keeps between scrapes, and the page itself.
+class CaptureMetrics {
+ public:
+  CaptureMetrics();
+
+  // Fold one reading into the histograms. Meant for every stats report — the
+  // application's comes twenty times a second — rather than for every scrape.
+  // A reading from a source with no device buffer instrument leaves the back
+  // pressure histogram alone rather than recording a zero it did not measure.
+  void Observe(const CaptureStats& stats);
+
+  // The whole page for this reading.
+  std::string Format(const CaptureStats& stats,
+                     const MetricsContext& context) const;
+
+  const MetricsHistogram& ring_depth() const { return ring_depth_; }
+  const MetricsHistogram& back_pressure() const { return back_pressure_; }
+
+ private:
+  MetricsHistogram ring_depth_;
+  MetricsHistogram back_pressure_;
+};
+
+// How long a sample waits at each stage, in seconds, from the depth of the
+// queue in front of it: the device's FIFO, the host's ring, and what the sink
+// has taken and not yet committed.
+//
+// Not a measurement of any one sample. Nothing in the pipeline timestamps a
+// sample through it, and adding that to the processing thread's loop to serve
+// a graph would be the exporter costing the capture something. A queue's depth
+// over the rate it drains at is the delay it adds, and every depth here is
+// already in the stats block.
+struct StageLatency {
+  double device_seconds = 0.0;
+  double ring_seconds = 0.0;
+  double sink_seconds = 0.0;
+};
+
+StageLatency StageLatencyFrom(const CaptureStats& stats,
+                              const MetricsContext& context);
+
+// A value as the exposition spells it: shortest round-trip decimal, "+Inf",
+// "-Inf" or "NaN". Never a comma, whatever the process's locale.
+std::string FormatMetricValue(double value);
+
+}  // namespace ddd::capture
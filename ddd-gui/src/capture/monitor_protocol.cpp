@@ -0,0 +1,435 @@
+/************************************************************************
+
+    monitor_protocol.cpp
+
+    The frames a remote monitor is sent, and the queue they wait in
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "monitor_protocol.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace ddd::capture {
+namespace {
+
+// result, sequence state, writing and a spare byte; two doubles; two counts;
+// the slots; three more counts; the recent extremes, clip counts and RMS
+constexpr size_t kStatsPayloadBytes = 4 + 16 + 16 + 8 + 24 + 4 + 16 + 8;
+
+constexpr size_t kTypeOffset = 0;
+constexpr size_t kVersionOffset = 1;
+constexpr size_t kDroppedOffset = 2;
+constexpr size_t kLengthOffset = 6;
+
+void PutU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+void PutU64(std::vector<uint8_t>& out, uint64_t value) {
+  for (int shift = 0; shift < 64; shift += 8) {
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+void PutF64(std::vector<uint8_t>& out, double value) {
+  PutU64(out, std::bit_cast<uint64_t>(value));
+}
+
+void PokeU32(uint8_t* at, uint32_t value) {
+  for (int byte = 0; byte < 4; ++byte) {
+    at[byte] = static_cast<uint8_t>(value >> (8 * byte));
+  }
+}
+
+// Reads from the front of a payload, and remembers whether it ever ran past
+// the end rather than making every caller check every field.
+class PayloadReader {
+ public:
+  explicit PayloadReader(std::span<const uint8_t> bytes) : bytes_(bytes) {}
+
+  uint8_t U8() { return static_cast<uint8_t>(Take(1)); }
+  uint16_t U16() { return static_cast<uint16_t>(Take(2)); }
+  uint32_t U32() { return static_cast<uint32_t>(Take(4)); }
+  uint64_t U64() { return Take(8); }
+  double F64() { return std::bit_cast<double>(Take(8)); }
+
+  size_t remaining() const { return overrun_ ? 0 : bytes_.size() - offset_; }
+  bool overrun() const { return overrun_; }
+
+ private:
+  uint64_t Take(size_t size) {
+    if (overrun_ || bytes_.size() - offset_ < size) {
+      overrun_ = true;
+      return 0;
+    }
+    uint64_t value = 0;
+    for (size_t byte = 0; byte < size; ++byte) {
+      value |= static_cast<uint64_t>(bytes_[offset_ + byte]) << (8 * byte);
+    }
+    offset_ += size;
+    return value;
+  }
+
+  std::span<const uint8_t> bytes_;
+  size_t offset_ = 0;
+  bool overrun_ = false;
+};
+
+uint32_t ReadU32(std::span<const uint8_t> bytes, size_t offset) {
+  return PayloadReader(bytes.subspan(offset, 4)).U32();
+}
+
+// The header, with the length left to be filled in once the payload is known.
+// Returns where the payload starts.
+size_t BeginFrame(MonitorFrameType type, std::vector<uint8_t>& out) {
+  out.push_back(static_cast<uint8_t>(type));
+  out.push_back(kMonitorProtocolVersion);
+  PutU32(out, 0);
+  PutU32(out, 0);
+  return out.size();
+}
+
+void EndFrame(size_t payload_start, std::vector<uint8_t>& out) {
+  PokeU32(out.data() + payload_start - kMonitorFrameHeaderBytes + kLengthOffset,
+          static_cast<uint32_t>(out.size() - payload_start));
+}
+
+bool DecodeStats(std::span<const uint8_t> payload, MonitorStats& stats) {
+  if (payload.size() != kStatsPayloadBytes) {
+    return false;
+  }
+  PayloadReader in(payload);
+  stats.result = static_cast<TransferResult>(in.U8());
+  stats.sequence_state = static_cast<SequenceState>(in.U8());
+  stats.writing = in.U8() != 0;
+  in.U8();
+  stats.elapsed_seconds = in.F64();
+  stats.throughput_bytes_per_second = in.F64();
+  stats.bytes_written = in.U64();
+  stats.samples_written = in.U64();
+  stats.slots_in_use = in.U32();
+  stats.slot_count = in.U32();
+  stats.device_overflow_events = in.U64();
+  stats.device_dropped_words = in.U64();
+  stats.dropout_events = in.U64();
+  stats.recent_minimum_value = in.U16();
+  stats.recent_maximum_value = in.U16();
+  stats.recent_clipped_low_count = in.U64();
+  stats.recent_clipped_high_count = in.U64();
+  stats.recent_rms = in.F64();
+  return !in.overrun();
+}
+
+bool DecodeSpectrum(std::span<const uint8_t> payload,
+                    MonitorSpectrum& spectrum) {
+  PayloadReader in(payload);
+  spectrum.bin_width_hz = in.F64();
+  const uint32_t count = in.U32();
+  if (in.overrun() || in.remaining() != static_cast<size_t>(count) * 2) {
+    return false;
+  }
+  spectrum.centi_db.resize(count);
+  for (int16_t& level : spectrum.centi_db) {
+    level = static_cast<int16_t>(in.U16());
+  }
+  return !in.overrun();
+}
+
+bool DecodeWaveform(std::span<const uint8_t> payload,
+                    MonitorWaveform& waveform) {
+  PayloadReader in(payload);
+  waveform.sample_span = in.U32();
+  const uint32_t count = in.U32();
+  if (in.overrun() || in.remaining() != static_cast<size_t>(count) * 4) {
+    return false;
+  }
+  waveform.minimum.resize(count);
+  waveform.maximum.resize(count);
+  for (uint32_t column = 0; column < count; ++column) {
+    waveform.minimum[column] = in.U16();
+    waveform.maximum[column] = in.U16();
+  }
+  return !in.overrun();
+}
+
+int16_t ToCentiDb(double level_db) {
+  constexpr double kLowest = std::numeric_limits<int16_t>::min();
+  constexpr double kHighest = std::numeric_limits<int16_t>::max();
+  if (std::isnan(level_db)) {
+    return std::numeric_limits<int16_t>::min();
+  }
+  return static_cast<int16_t>(
+      std::clamp(std::round(level_db * 100.0), kLowest, kHighest));
+}
+
+}  // namespace
+
+size_t MonitorStreamIndex(MonitorFrameType type) {
+  switch (type) {
+    case MonitorFrameType::kStats:
+      return 0;
+    case MonitorFrameType::kSpectrum:
+      return 1;
+    case MonitorFrameType::kWaveform:
+      return 2;
+    case MonitorFrameType::kReply:
+      break;
+  }
+  return kMonitorStreamCount;
+}
+
+MonitorStats MonitorStatsFrom(const CaptureStats& stats) {
+  MonitorStats out;
+  out.result = stats.result;
+  out.sequence_state = stats.sequence_state;
+  out.writing = stats.writing;
+  out.elapsed_seconds = stats.elapsed_seconds;
+  out.throughput_bytes_per_second = stats.throughput_bytes_per_second;
+  out.bytes_written = stats.bytes_written;
+  out.samples_written = stats.samples_written;
+  out.slots_in_use = static_cast<uint32_t>(stats.slots_in_use);
+  out.slot_count = static_cast<uint32_t>(stats.slot_count);
+  out.device_overflow_events = stats.device_overflow_events;
+  out.device_dropped_words = stats.device_dropped_words;
+  out.dropout_events = stats.dropouts.event_count;
+  out.recent_minimum_value = stats.metrics.recent_minimum_value;
+  out.recent_maximum_value = stats.metrics.recent_maximum_value;
+  out.recent_clipped_low_count = stats.metrics.recent_clipped_low_count;
+  out.recent_clipped_high_count = stats.metrics.recent_clipped_high_count;
+  out.recent_rms = stats.metrics.recent_rms;
+  return out;
+}
+
+void EncodeMonitorReply(const std::string& json, std::vector<uint8_t>& out) {
+  const size_t payload = BeginFrame(MonitorFrameType::kReply, out);
+  out.insert(out.end(), json.begin(), json.end());
+  EndFrame(payload, out);
+}
+
+void EncodeMonitorStats(const MonitorStats& stats, std::vector<uint8_t>& out) {
+  const size_t payload = BeginFrame(MonitorFrameType::kStats, out);
+  out.push_back(static_cast<uint8_t>(stats.result));
+  out.push_back(static_cast<uint8_t>(stats.sequence_state));
+  out.push_back(stats.writing ? 1 : 0);
+  out.push_back(0);
+  PutF64(out, stats.elapsed_seconds);
+  PutF64(out, stats.throughput_bytes_per_second);
+  PutU64(out, stats.bytes_written);
+  PutU64(out, stats.samples_written);
+  PutU32(out, stats.slots_in_use);
+  PutU32(out, stats.slot_count);
+  PutU64(out, stats.device_overflow_events);
+  PutU64(out, stats.device_dropped_words);
+  PutU64(out, stats.dropout_events);
+  PutU16(out, stats.recent_minimum_value);
+  PutU16(out, stats.recent_maximum_value);
+  PutU64(out, stats.recent_clipped_low_count);
+  PutU64(out, stats.recent_clipped_high_count);
+  PutF64(out, stats.recent_rms);
+  EndFrame(payload, out);
+}
+
+void EncodeMonitorSpectrum(const MonitorSpectrum& spectrum,
+                           std::vector<uint8_t>& out) {
+  const size_t payload = BeginFrame(MonitorFrameType::kSpectrum, out);
+  PutF64(out, spectrum.bin_width_hz);
+  PutU32(out, static_cast<uint32_t>(spectrum.centi_db.size()));
+  for (const int16_t level : spectrum.centi_db) {
+    PutU16(out, static_cast<uint16_t>(level));
+  }
+  EndFrame(payload, out);
+}
+
+void EncodeMonitorWaveform(const MonitorWaveform& waveform,
+                           std::vector<uint8_t>& out) {
+  const size_t payload = BeginFrame(MonitorFrameType::kWaveform, out);
+  const size_t count = std::min(waveform.minimum.size(),
+                                waveform.maximum.size());
+  PutU32(out, waveform.sample_span);
+  PutU32(out, static_cast<uint32_t>(count));
+  for (size_t column = 0; column < count; ++column) {
+    PutU16(out, waveform.minimum[column]);
+    PutU16(out, waveform.maximum[column]);
+  }
+  EndFrame(payload, out);
+}
+
+MonitorDecodeStatus DecodeMonitorFrame(std::span<const uint8_t> bytes,
+                                       MonitorFrame& frame, size_t& consumed) {
+  consumed = 0;
+  if (bytes.size() < kMonitorFrameHeaderBytes) {
+    return MonitorDecodeStatus::kIncomplete;
+  }
+
+  const auto type = static_cast<MonitorFrameType>(bytes[kTypeOffset]);
+  if (bytes[kVersionOffset] != kMonitorProtocolVersion ||
+      bytes[kTypeOffset] > static_cast<uint8_t>(MonitorFrameType::kWaveform)) {
+    return MonitorDecodeStatus::kMalformed;
+  }
+
+  const size_t length = ReadU32(bytes, kLengthOffset);
+  if (length > kMaximumMonitorPayloadBytes) {
+    return MonitorDecodeStatus::kMalformed;
+  }
+  if (bytes.size() - kMonitorFrameHeaderBytes < length) {
+    return MonitorDecodeStatus::kIncomplete;
+  }
+
+  const std::span<const uint8_t> payload =
+      bytes.subspan(kMonitorFrameHeaderBytes, length);
+  frame = MonitorFrame{};
+  frame.type = type;
+  frame.dropped = ReadU32(bytes, kDroppedOffset);
+
+  bool ok = false;
+  switch (type) {
+    case MonitorFrameType::kReply:
+      frame.reply.assign(payload.begin(), payload.end());
+      ok = true;
+      break;
+    case MonitorFrameType::kStats:
+      ok = DecodeStats(payload, frame.stats);
+      break;
+    case MonitorFrameType::kSpectrum:
+      ok = DecodeSpectrum(payload, frame.spectrum);
+      break;
+    case MonitorFrameType::kWaveform:
+      ok = DecodeWaveform(payload, frame.waveform);
+      break;
+  }
+  if (!ok) {
+    return MonitorDecodeStatus::kMalformed;
+  }
+
+  consumed = kMonitorFrameHeaderBytes + length;
+  return MonitorDecodeStatus::kFrame;
+}
+
+void ReduceMonitorSpectrum(std::span<const double> levels_db, uint32_t bins,
+                           std::vector<int16_t>& centi_db) {
+  centi_db.clear();
+  const size_t available = levels_db.size();
+  if (bins == 0 || bins >= available) {
+    centi_db.reserve(available);
+    for (const double level : levels_db) {
+      centi_db.push_back(ToCentiDb(level));
+    }
+    return;
+  }
+
+  // Each output bin covers the input bins between its two edges, so that the
+  // remainder is spread across the range rather than piled into the last one
+  centi_db.reserve(bins);
+  for (size_t bin = 0; bin < bins; ++bin) {
+    const size_t first = bin * available / bins;
+    const size_t last = (bin + 1) * available / bins;
+    const double highest = *std::max_element(
+        levels_db.begin() + static_cast<ptrdiff_t>(first),
+        levels_db.begin() + static_cast<ptrdiff_t>(last));
+    centi_db.push_back(ToCentiDb(highest));
+  }
+}
+
+void MonitorRateLimiter::SetRate(double rate_hz) {
+  rate_hz_ = std::min(std::max(rate_hz, 0.0), kMaximumMonitorRateHz);
+  interval_seconds_ = rate_hz_ > 0.0 ? 1.0 / rate_hz_ : 0.0;
+  started_ = false;
+}
+
+bool MonitorRateLimiter::Admit(double now_seconds) {
+  if (rate_hz_ <= 0.0) {
+    return false;
+  }
+  if (!started_) {
+    started_ = true;
+    next_due_seconds_ = now_seconds + interval_seconds_;
+    return true;
+  }
+  if (now_seconds < next_due_seconds_) {
+    return false;
+  }
+
+  next_due_seconds_ += interval_seconds_;
+  if (next_due_seconds_ <= now_seconds) {
+    next_due_seconds_ = now_seconds + interval_seconds_;
+  }
+  return true;
+}
+
+MonitorOutbox::MonitorOutbox(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)) {}
+
+bool MonitorOutbox::Push(std::vector<uint8_t> frame) {
+  if (frame.size() < kMonitorFrameHeaderBytes) {
+    return true;
+  }
+
+  const bool reply = static_cast<MonitorFrameType>(frame[kTypeOffset]) ==
+                     MonitorFrameType::kReply;
+  if (reply && replies_ >= kMaximumReplies) {
+    return false;
+  }
+
+  if (frames_.size() >= capacity_) {
+    const auto oldest_data = std::find_if(
+        frames_.begin(), frames_.end(), [](const std::vector<uint8_t>& queued) {
+          return static_cast<MonitorFrameType>(queued[kTypeOffset]) !=
+                 MonitorFrameType::kReply;
+        });
+
+    // A queue of nothing but replies takes one more, up to kMaximumReplies:
+    // they are answers to requests the client made
+    if (oldest_data != frames_.end()) {
+      const size_t stream = MonitorStreamIndex(
+          static_cast<MonitorFrameType>((*oldest_data)[kTypeOffset]));
+      pending_dropped_[stream] += 1 + ReadU32(*oldest_data, kDroppedOffset);
+      ++dropped_total_;
+      frames_.erase(oldest_data);
+    }
+  }
+
+  if (reply) {
+    ++replies_;
+  }
+  frames_.push_back(std::move(frame));
+  return true;
+}
+
+bool MonitorOutbox::Pop(std::vector<uint8_t>& frame) {
+  if (frames_.empty()) {
+    return false;
+  }
+
+  frame = std::move(frames_.front());
+  frames_.pop_front();
+  if (static_cast<MonitorFrameType>(frame[kTypeOffset]) ==
+      MonitorFrameType::kReply) {
+    --replies_;
+  }
+
+  const size_t stream =
+      MonitorStreamIndex(static_cast<MonitorFrameType>(frame[kTypeOffset]));
+  if (stream < kMonitorStreamCount) {
+    PokeU32(frame.data() + kDroppedOffset,
+            ReadU32(frame, kDroppedOffset) + pending_dropped_[stream]);
+    pending_dropped_[stream] = 0;
+  }
+  return true;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,262 @@
+/************************************************************************
+
+    monitor_protocol.h
+
+    The frames a remote monitor is sent, and the queue they wait in
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "monitor_tap.h"
+
+namespace ddd::capture {
+
+// What a client watching a capture from elsewhere is sent, once it has asked
+// to monitor rather than to stop.
+//
+// **Binary, because of what is in it.** A stats report is a few dozen figures
+// and would be fine as JSON. A spectrum is hundreds of levels and a waveform
+// hundreds of column pairs, ten times a second, to every client — and as text
+// that is the control socket spending more time formatting numbers than the
+// analysis thread spent computing them. So the requests stay JSON lines, which
+// are rare and want to be readable, and everything the server sends after a
+// client has switched to monitoring is a frame:
+//
+//   offset  size  field
+//        0     1  type (MonitorFrameType)
+//        1     1  version (kMonitorProtocolVersion)
+//        2     4  frames of this stream dropped since the last one sent
+//        6     4  payload length in bytes
+//       10     n  payload
+//
+// Every field little-endian, whatever the host, so that a client on another
+// machine reading a TCP stream decodes what this one meant.
+//
+// Qt-free, like the rest of this library, so that the framing can be tested
+// byte for byte without a socket, and so that a client in any language has a
+// single page to read.
+
+inline constexpr uint8_t kMonitorProtocolVersion = 1;
+inline constexpr size_t kMonitorFrameHeaderBytes = 10;
+
+// Anything larger is not a frame this server could have sent: the largest is a
+// waveform at kMaximumMonitorPoints columns. A decoder refuses it rather than
+// waiting for megabytes that are never coming.
+inline constexpr size_t kMaximumMonitorPayloadBytes = 1 << 20;
+
+enum class MonitorFrameType : uint8_t {
+  // The answer to a request, as the JSON line it would have been before the
+  // connection switched to frames. Never dropped.
+  kReply = 0,
+  kStats = 1,
+  kSpectrum = 2,
+  kWaveform = 3,
+};
+
+// The three things a client can subscribe to, which are the three frame types
+// that carry data.
+inline constexpr size_t kMonitorStreamCount = 3;
+
+// The stream's slot in per-stream arrays, or kMonitorStreamCount for a reply.
+size_t MonitorStreamIndex(MonitorFrameType type);
+
+// Limits on what a subscription may ask for. The rates are the ones the
+// sources produce at most — stats four times a second, snapshots about nine —
+// with headroom, and a subscription above them simply receives every one.
+inline constexpr double kMaximumMonitorRateHz = 30.0;
+inline constexpr uint32_t kMaximumMonitorBins = 8192;
+inline constexpr uint32_t kMaximumMonitorPoints = 4096;
+
+// What a stats frame carries: the figures a remote display needs to say
+// whether the capture is healthy, and not the whole of CaptureStats, most of
+// which is diagnostics that belong in the sidecar.
+struct MonitorStats {
+  TransferResult result = TransferResult::kRunning;
+  SequenceState sequence_state = SequenceState::kSynchronising;
+  bool writing = false;
+
+  double elapsed_seconds = 0.0;
+  double throughput_bytes_per_second = 0.0;
+  uint64_t bytes_written = 0;
+  uint64_t samples_written = 0;
+
+  uint32_t slots_in_use = 0;
+  uint32_t slot_count = 0;
+
+  uint64_t device_overflow_events = 0;
+  uint64_t device_dropped_words = 0;
+  uint64_t dropout_events = 0;
+
+  // The signal over the recent window, which is what a level display shows
+  uint16_t recent_minimum_value = 0;
+  uint16_t recent_maximum_value = 0;
+  uint64_t recent_clipped_low_count = 0;
+  uint64_t recent_clipped_high_count = 0;
+  double recent_rms = 0.0;
+
+  bool operator==(const MonitorStats&) const = default;
+};
+
+MonitorStats MonitorStatsFrom(const CaptureStats& stats);
+
+// A spectrum as levels in hundredths of a dB, which is finer than any display
+// resolves and half the size of a float. The bin width is carried so that a
+// client can label the axis without knowing what transform size the
+// application's spectrum panel happens to be set to.
+struct MonitorSpectrum {
+  double bin_width_hz = 0.0;
+  std::vector<int16_t> centi_db;
+};
+
+// A waveform as the extremes of each column, the same reduction the scope
+// draws from, so that a carrier is an envelope and not an alias.
+// sample_span is how many samples the columns cover between them.
+struct MonitorWaveform {
+  uint32_t sample_span = 0;
+  std::vector<uint16_t> minimum;
+  std::vector<uint16_t> maximum;
+};
+
+// One decoded frame. Only the member its type names is filled in.
+struct MonitorFrame {
+  MonitorFrameType type = MonitorFrameType::kReply;
+  uint32_t dropped = 0;
+
+  std::string reply;
+  MonitorStats stats;
+  MonitorSpectrum spectrum;
+  MonitorWaveform waveform;
+};
+
+// Each encoder appends one whole frame with a dropped count of zero; the
+// outbox below fills the count in as the frame leaves.
+void EncodeMonitorReply(const std::string& json, std::vector<uint8_t>& out);
+void EncodeMonitorStats(const MonitorStats& stats, std::vector<uint8_t>& out);
+void EncodeMonitorSpectrum(const MonitorSpectrum& spectrum,
+                           std::vector<uint8_t>& out);
+void EncodeMonitorWaveform(const MonitorWaveform& waveform,
+                           std::vector<uint8_t>& out);
+
+enum class MonitorDecodeStatus {
+  kFrame,
+
+  // Not all of the frame has arrived. Nothing was consumed; call again with
+  // more.
+  kIncomplete,
+
+  // Not a frame this protocol sends — an unknown type or version, a length
+  // past the limit, or a payload that does not match its type. A stream that
+  // produced one cannot be resynchronised and should be closed.
+  kMalformed,
+};
+
+// Decode the frame at the front of `bytes`. On kFrame, `consumed` is its
+// length; on anything else it is zero.
+MonitorDecodeStatus DecodeMonitorFrame(std::span<const uint8_t> bytes,
+                                       MonitorFrame& frame, size_t& consumed);
+
+// Reduce a spectrum's levels to `bins` of them, each the highest level of the
+// bins it covers, in hundredths of a dB.
+//
+// The highest rather than the mean, because a spectrum is read for its peaks:
+// a carrier or a spur one bin wide averaged with its neighbours would shrink
+// into the noise floor exactly as far as the client asked for fewer bins.
+// Asking for as many bins as there are, or more, returns them all.
+void ReduceMonitorSpectrum(std::span<const double> levels_db, uint32_t bins,
+                           std::vector<int16_t>& centi_db);
+
+// Whether a stream is due to be sent to one client, at the rate it asked for.
+//
+// Times are the caller's, in seconds on any steady clock, so that a test can
+// drive it without sleeping. A frame that is not due is not queued at all:
+// the cheapest frame to send a slow client is the one never built for it.
+class MonitorRateLimiter {
+ public:
+  explicit MonitorRateLimiter(double rate_hz = 0.0) { SetRate(rate_hz); }
+
+  // Zero or less is never due, and anything past kMaximumMonitorRateHz is
+  // held to it.
+  void SetRate(double rate_hz);
+
+  // Whether a frame may go now. True advances the schedule; false leaves it.
+  //
+  // The schedule advances by one interval from when the last frame was due
+  // rather than from now, so that a source arriving at 9 Hz and a client
+  // asking for 3 gets every third snapshot rather than drifting to every
+  // fourth — unless it has fallen more than an interval behind, when it starts
+  // again from now rather than sending a burst to catch up.
+  bool Admit(double now_seconds);
+
+  double rate_hz() const { return rate_hz_; }
+
+ private:
+  double rate_hz_ = 0.0;
+  double interval_seconds_ = 0.0;
+  double next_due_seconds_ = 0.0;
+  bool started_ = false;
+};
+
+// A client's frames, waiting for its socket to take them.
+//
+// **Bounded, and the oldest goes.** A client that stops reading — a laptop
+// that went to sleep, a script wedged on its own output — must cost the
+// application a fixed amount of memory and nothing else: not a growing
+// buffer, and never a wait anywhere near the capture. So the queue has a
+// capacity, and a frame pushed into a full one displaces the oldest data
+// frame. The oldest because a monitor wants the present: a spectrum from two
+// seconds ago is worth less than the one that replaced it.
+//
+// Every frame displaced is counted against its stream, and the count is
+// written into the next frame of that stream to leave, so a client can say
+// exactly how much it missed. Replies are never displaced; a client waiting
+// for one would otherwise wait forever.
+//
+// Nor are they unbounded. A reply is queued for every request line, and a
+// client can write request lines as fast as it likes while reading nothing, so
+// replies alone could grow the queue without limit. At most kMaximumReplies
+// wait at once; the push that would exceed that is refused, and the caller
+// disconnects the client, which by then is not reading what it asked for.
+class MonitorOutbox {
+ public:
+  static constexpr size_t kDefaultCapacity = 8;
+  static constexpr size_t kMaximumReplies = 16;
+
+  explicit MonitorOutbox(size_t capacity = kDefaultCapacity);
+
+  // One whole encoded frame, as the encoders above produce. False when it is a
+  // reply and kMaximumReplies are already waiting, in which case it is not
+  // queued and the client should be let go.
+  bool Push(std::vector<uint8_t> frame);
+
+  // The next frame to send, with its dropped count filled in, or false when
+  // there is none.
+  bool Pop(std::vector<uint8_t>& frame);
+
+  bool empty() const { return frames_.empty(); }
+  size_t size() const { return frames_.size(); }
+  size_t capacity() const { return capacity_; }
+
+  // Frames displaced over the outbox's life, across every stream.
+  uint64_t dropped_total() const { return dropped_total_; }
+
+ private:
+  size_t capacity_;
+  std::deque<std::vector<uint8_t>> frames_;
+  std::array<uint32_t, kMonitorStreamCount> pending_dropped_{};
+  uint64_t dropped_total_ = 0;
+  size_t replies_ = 0;
+};
+
+}  // namespace ddd::capture
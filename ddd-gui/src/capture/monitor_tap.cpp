@@ -12,6 +12,7 @@
 #include "monitor_tap.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 
 namespace ddd::capture {
@@ -80,45 +81,237 @@ FpgaTelemetry TelemetryPublisher::Read() const {
   }
 }
 
-SnapshotPublisher::SnapshotPublisher(size_t snapshot_bytes)
-    : snapshot_bytes_(snapshot_bytes) {
-  for (Buffer& buffer : buffers_) {
-    buffer.data.resize(snapshot_bytes_);
+void ThreadUsagePublisher::Publish(const CaptureThreadUsage& usage) {
+  sequence_.fetch_add(1, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  value_ = usage;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+CaptureThreadUsage ThreadUsagePublisher::Read() const {
+  CaptureThreadUsage copy;
+
+  while (true) {
+    const uint64_t before = sequence_.load(std::memory_order_acquire);
+    if ((before & 1U) != 0) {
+      continue;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    copy = value_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const uint64_t after = sequence_.load(std::memory_order_acquire);
+    if (before == after) {
+      return copy;
+    }
+  }
+}
+
+void HistogramPublisher::Publish(const CodeHistograms& histograms) {
+  sequence_.fetch_add(1, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  value_ = histograms;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+CodeHistograms HistogramPublisher::Read() const {
+  CodeHistograms copy;
+
+  while (true) {
+    const uint64_t before = sequence_.load(std::memory_order_acquire);
+    if ((before & 1U) != 0) {
+      continue;
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    copy = value_;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const uint64_t after = sequence_.load(std::memory_order_acquire);
+    if (before == after) {
+      return copy;
+    }
   }
 }
 
-void SnapshotPublisher::Publish(const uint8_t* wire_data, size_t byte_count) {
+SnapshotPublisher::SnapshotPublisher(size_t snapshot_bytes,
+                                     size_t reader_capacity, bool enabled)
+    : snapshot_bytes_(snapshot_bytes),
+      reader_capacity_(std::clamp<size_t>(reader_capacity, 1, kIndexMask - 1)),
+      buffers_(reader_capacity_ + 2) {
+  SetEnabled(enabled);
+}
+
+void SnapshotPublisher::SetEnabled(bool enabled) {
+  const std::lock_guard<std::mutex> lock(enable_mutex_);
+  if (enabled && !allocated_) {
+    for (Buffer& buffer : buffers_) {
+      buffer.data.resize(snapshot_bytes_);
+    }
+    allocated_ = true;
+  }
+  enabled_.store(enabled, std::memory_order_release);
+}
+
+void SnapshotPublisher::Publish(const uint8_t* wire_data, size_t byte_count,
+                                std::optional<double> trigger_position) {
+  if (!enabled()) {
+    return;
+  }
+
   Buffer& target = buffers_[write_index_];
 
   const size_t copied = std::min(byte_count, snapshot_bytes_);
   std::memcpy(target.data.data(), wire_data, copied);
   target.used = copied;
-  target.generation = generation_.fetch_add(1) + 1;
+  target.trigger_position = trigger_position;
+  const uint64_t generation = generation_.fetch_add(1) + 1;
 
-  // Hand this buffer over and take whatever the reader is not using. One
-  // exchange, so there is no window in which the reader could see a buffer that
-  // is about to be written into.
-  const unsigned previous =
-      ready_.exchange(write_index_ | kFreshFlag, std::memory_order_acq_rel);
-  write_index_ = previous & kIndexMask;
+  // Hand this buffer over in one exchange. The previous newest may still be
+  // pinned, and is left alone either way until the search below finds it free.
+  newest_.store((generation << kIndexBits) | write_index_,
+                std::memory_order_seq_cst);
+
+  // A buffer nobody has pinned to fill next time. Readers pin one each at most,
+  // so of the capacity plus two, one besides the newest is always free; the
+  // search is bounded by the pool, and that bound is what keeps this wait-free.
+  const size_t newest = write_index_;
+  for (size_t index = 0; index < buffers_.size(); ++index) {
+    if (index != newest &&
+        buffers_[index].pins.load(std::memory_order_seq_cst) == 0) {
+      write_index_ = index;
+      return;
+    }
+  }
+}
+
+void SnapshotPublisher::ArmTrigger(const SnapshotTrigger& trigger) {
+  const double fraction = std::clamp(trigger.pre_trigger_fraction, 0.0, 1.0);
+  const auto millionths =
+      static_cast<uint64_t>(std::lround(fraction * kTriggerFractionScale));
+  trigger_.store(kTriggerArmedBit | (millionths << 32) |
+                 (uint64_t{trigger.hysteresis_codes} << 16) |
+                 trigger.level_codes);
+}
+
+void SnapshotPublisher::DisarmTrigger() { trigger_.store(0); }
+
+std::optional<SnapshotTrigger> SnapshotPublisher::ArmedTrigger() const {
+  const uint64_t packed = trigger_.load();
+  if ((packed & kTriggerArmedBit) == 0) {
+    return std::nullopt;
+  }
+
+  SnapshotTrigger trigger;
+  trigger.level_codes = static_cast<uint16_t>(packed & 0xFFFF);
+  trigger.hysteresis_codes = static_cast<uint16_t>((packed >> 16) & 0xFFFF);
+  trigger.pre_trigger_fraction =
+      static_cast<double>((packed & ~kTriggerArmedBit) >> 32) /
+      kTriggerFractionScale;
+  return trigger;
+}
+
+std::unique_ptr<SnapshotPublisher::Reader> SnapshotPublisher::AddReader() {
+  size_t registered = readers_.load();
+  do {
+    if (registered >= reader_capacity_) {
+      return nullptr;
+    }
+  } while (!readers_.compare_exchange_weak(registered, registered + 1));
+
+  return std::unique_ptr<Reader>(new Reader(this));
 }
 
 bool SnapshotPublisher::TryRead(std::vector<uint8_t>& out,
                                 uint64_t& generation) {
-  if ((ready_.load(std::memory_order_acquire) & kFreshFlag) == 0) {
-    return false;
+  std::optional<double> trigger_position;
+  return TryRead(out, generation, trigger_position);
+}
+
+bool SnapshotPublisher::TryRead(std::vector<uint8_t>& out,
+                                uint64_t& generation,
+                                std::optional<double>& trigger_position) {
+  if (copying_reader_ == nullptr) {
+    copying_reader_ = AddReader();
+    if (copying_reader_ == nullptr) {
+      return false;
+    }
   }
 
-  // Swap our buffer for the fresh one, clearing the flag as we take it.
-  const unsigned previous =
-      ready_.exchange(read_index_, std::memory_order_acq_rel);
-  read_index_ = previous & kIndexMask;
+  if (!copying_reader_->TryAcquire()) {
+    return false;
+  }
 
-  const Buffer& source = buffers_[read_index_];
-  out.assign(source.data.begin(),
-             source.data.begin() + static_cast<std::ptrdiff_t>(source.used));
-  generation = source.generation;
+  const std::span<const uint8_t> view = copying_reader_->data();
+  out.assign(view.begin(), view.end());
+  generation = copying_reader_->generation();
+  trigger_position = copying_reader_->trigger_position();
+  copying_reader_->Release();
   return true;
 }
 
+SnapshotPublisher::Reader::~Reader() {
+  Release();
+  publisher_->readers_.fetch_sub(1);
+}
+
+bool SnapshotPublisher::Reader::TryAcquire() {
+  uint64_t newest = publisher_->newest_.load(std::memory_order_acquire);
+  if ((newest >> kIndexBits) <= generation_) {
+    return false;
+  }
+
+  // Let go first. One pin per reader is what the pool's size is reckoned on.
+  Release();
+
+  while (true) {
+    const size_t index = newest & kIndexMask;
+    Buffer& buffer = publisher_->buffers_[index];
+
+    // Announce, then check it is still the newest. If the writer has moved on
+    // in between, it may be about to fill this buffer having looked before the
+    // announcement; let go and take the one that replaced it, which is newer
+    // still and so never sends this back to a snapshot it already had.
+    buffer.pins.fetch_add(1, std::memory_order_seq_cst);
+    const uint64_t check = publisher_->newest_.load(std::memory_order_seq_cst);
+    if (check == newest) {
+      pinned_ = index;
+      generation_ = newest >> kIndexBits;
+      return true;
+    }
+    buffer.pins.fetch_sub(1, std::memory_order_release);
+    newest = check;
+  }
+}
+
+std::span<const uint8_t> SnapshotPublisher::Reader::data() const {
+  if (pinned_ == kNothingPinned) {
+    return {};
+  }
+  const Buffer& buffer = publisher_->buffers_[pinned_];
+  return {buffer.data.data(), buffer.used};
+}
+
+std::optional<double> SnapshotPublisher::Reader::trigger_position() const {
+  if (pinned_ == kNothingPinned) {
+    return std::nullopt;
+  }
+  return publisher_->buffers_[pinned_].trigger_position;
+}
+
+void SnapshotPublisher::Reader::Release() {
+  if (pinned_ == kNothingPinned) {
+    return;
+  }
+  publisher_->buffers_[pinned_].pins.fetch_sub(1, std::memory_order_release);
+  pinned_ = kNothingPinned;
+}
+
 }  // namespace ddd::capture
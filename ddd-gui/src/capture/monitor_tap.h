@@ -14,11 +14,19 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <vector>
 
+#include "dropout_detector.h"
+#include "encoder_effort.h"
 #include "fpga_telemetry.h"
 #include "sample_metrics.h"
 #include "sequence_validator.h"
+#include "snapshot_trigger.h"
+#include "thread_usage.h"
 #include "transfer_result.h"
 
 namespace ddd::capture {
@@ -49,6 +57,11 @@ struct CaptureStats {
 
   uint64_t transfers_completed = 0;
   uint64_t buffers_processed = 0;
+
+  // Of those, the buffers taken off the ring with only their counter changes
+  // checked, while monitoring. See
+  // CapturePipeline::Options::monitor_validation_interval.
+  uint64_t buffers_skipped = 0;
   uint64_t bytes_written = 0;
   uint64_t samples_written = 0;
 
@@ -63,6 +76,11 @@ struct CaptureStats {
   // one.
   bool writing = false;
 
+  // What the encoder's effort did over the file being written, or over the
+  // last one once it has closed — which is when the sidecar reads it. Not
+  // adjustable while monitoring, and for a sink with no effort to adjust.
+  EncoderEffortSummary encoder_effort;
+
   // Ring depth. The number that says whether this machine is keeping up.
   size_t slots_in_use = 0;
   size_t peak_slots_in_use = 0;
@@ -93,7 +111,19 @@ struct CaptureStats {
   uint64_t device_overflow_events = 0;
   uint64_t device_dropped_words = 0;
 
+  // What the transfer, processing and encoder threads have had from the
+  // scheduler so far — CPU time, preemptions, migrations and page faults,
+  // totals since each thread began. Sampled by the control thread rather than
+  // measured per buffer, so it moves a few times a second at most; and absent
+  // on a platform that does not keep the counts. See thread_usage.h.
+  CaptureThreadUsage threads;
+
   SampleMetricsSnapshot metrics;
+
+  // Where the RF envelope collapsed, as counts and totals. The events
+  // themselves are not in here — see DropoutSummary — and a file's list is
+  // collected from the pipeline when the file closes.
+  DropoutSummary dropouts;
 };
 
 // Publishes the device's buffer readings from the thread that takes them.
@@ -117,6 +147,45 @@ class TelemetryPublisher {
   FpgaTelemetry value_;
 };
 
+// Publishes the threads' scheduling counters from the thread that samples them.
+//
+// The same arrangement as TelemetryPublisher, with the control thread as the
+// writer: reading /proc is a handful of file reads, which is nothing on the
+// thread that is already awake on a timer and would be a jitter source on
+// either of the two with a deadline. The processing thread reads the latest
+// totals into the statistics block alongside everything else.
+class ThreadUsagePublisher {
+ public:
+  void Publish(const CaptureThreadUsage& usage);
+
+  // Take a consistent copy. Every role absent until something has been
+  // published.
+  CaptureThreadUsage Read() const;
+
+ private:
+  std::atomic<uint64_t> sequence_{0};
+  CaptureThreadUsage value_;
+};
+
+// Publishes the sample code histograms from the processing thread.
+//
+// The same sequence lock again, kept out of CaptureStats because of its size:
+// three 1,024-entry histograms are 24 KiB, ten times everything else in the
+// statistics block put together, and the statistics block is copied on every
+// buffer. These are published at the snapshot cadence instead, which is as
+// often as anything draws them, and copied only by the reader that wants them.
+class HistogramPublisher {
+ public:
+  void Publish(const CodeHistograms& histograms);
+
+  // Take a consistent copy. All zero until something has been published.
+  CodeHistograms Read() const;
+
+ private:
+  std::atomic<uint64_t> sequence_{0};
+  CodeHistograms value_;
+};
+
 // Publishes a value that readers can take a consistent copy of without ever
 // making the writer wait.
 //
@@ -147,15 +216,39 @@ class StatsPublisher {
   CaptureStats value_;
 };
 
-// A copy of recent raw samples, for the waveform and spectrum displays.
+// A copy of recent raw samples, for the waveform and spectrum displays and
+// anything else that wants to look at the signal as it goes past.
 //
-// Triple buffered rather than locked: the writer always has a buffer nobody is
-// reading, the reader always has one nobody is writing, and the third is
-// whichever was most recently finished. Publishing is one atomic exchange —
+// A pool of buffers rather than a lock. The writer always has a buffer nobody
+// is reading, publishing is one atomic exchange of the newest buffer's index —
 // no copy on handover, no wait, and no chance of a reader seeing a buffer being
-// filled.
+// filled — and each reader pins the buffer it is looking at so the writer
+// leaves it alone until the reader lets go.
 //
-// Thread-safety: exactly one writer thread, exactly one reader thread.
+// **Several readers, each with a cursor of its own.** This began as a triple
+// buffer with one read index, and a second consumer on that would have stolen
+// snapshots from the first: whichever asked first took the fresh buffer, and
+// the other saw nothing new. Now each consumer registers a Reader, which
+// remembers the last generation it took and nothing else, so every reader sees
+// every snapshot it asks for in time — and one that falls behind drops only its
+// own.
+//
+// **Read in place.** A reader's view is the published buffer itself, pinned by
+// a count on it. The writer picks a buffer to fill from those with no count on
+// them, and there is always one: a reader pins one buffer at most, so with two
+// more buffers than readers there is a spare however the readers are placed.
+// The pool is sized for the readers at construction, which is what keeps the
+// writer's search for a spare bounded and the publish wait-free.
+//
+// A reader pinning a buffer announces it and then checks that the buffer is
+// still the newest. The writer announces a new buffer and then looks at the
+// counts. One of the two sees the other, so a buffer is never filled under a
+// reader that believes it has it; a reader that loses the race lets go and
+// tries again with the buffer that beat it.
+//
+// Thread-safety: exactly one writer thread. Any number of readers, up to the
+// capacity, each used from one thread at a time. The publisher must outlive
+// its readers.
 class SnapshotPublisher {
  public:
   // A snapshot is a fixed size chosen once. 64 KiB is 32,768 samples, which is
@@ -164,44 +257,160 @@ class SnapshotPublisher {
   // buffer.
   static constexpr size_t kDefaultSnapshotBytes = size_t{64} << 10;
 
-  explicit SnapshotPublisher(size_t snapshot_bytes = kDefaultSnapshotBytes);
+  // What the video preview asks for instead: 2 MiB, a whole buffer at full
+  // rate and 26 ms of signal, which is a PAL field with six milliseconds to
+  // spare. A field cannot be assembled from pieces of different ones, so this
+  // tap copies far more and far less often.
+  static constexpr size_t kFieldSnapshotBytes = size_t{2} << 20;
 
-  // Copy up to snapshot_bytes from a buffer and make it the current snapshot.
-  // Called from the processing thread, at most once every few buffers.
-  void Publish(const uint8_t* wire_data, size_t byte_count);
+  // One reader: the three buffers of the original triple buffer.
+  static constexpr size_t kDefaultReaderCapacity = 1;
+
+  // One consumer's place in the stream.
+  class Reader {
+   public:
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Pin the newest snapshot, if it is newer than the last one this reader
+    // took, letting go of that one first. Returns false when there is nothing
+    // new, and then whatever was pinned stays pinned: the view is the same
+    // snapshot as before, or empty if it had been released.
+    bool TryAcquire();
+
+    // The pinned snapshot, valid until the next TryAcquire or Release. Empty
+    // when nothing is pinned.
+    std::span<const uint8_t> data() const;
+
+    // The generation of the pinned snapshot, or of the last one pinned. A jump
+    // of more than one since the last is the snapshots this reader dropped.
+    uint64_t generation() const { return generation_; }
+
+    // Where the pinned snapshot's trigger crossing is, in samples from its
+    // start, when it was lined up on one. Nothing when the tap was not armed,
+    // or was and found no crossing in the slot to place the window around.
+    std::optional<double> trigger_position() const;
 
-  // Take the most recent snapshot, if one has arrived since the last call.
-  // Returns false when there is nothing new, which is the ordinary case for a
-  // display refreshing faster than snapshots are published.
+    // Let go of the pinned snapshot, so the writer may fill it again. A reader
+    // that is finished with one should say so rather than hold it until the
+    // next: a pinned buffer is one the writer cannot use.
+    void Release();
+
+   private:
+    friend class SnapshotPublisher;
+    explicit Reader(SnapshotPublisher* publisher) : publisher_(publisher) {}
+
+    static constexpr size_t kNothingPinned = SIZE_MAX;
+
+    SnapshotPublisher* publisher_;
+    size_t pinned_ = kNothingPinned;
+    uint64_t generation_ = 0;
+  };
+
+  // A publisher constructed disabled holds no pool until it is first enabled;
+  // see SetEnabled.
+  explicit SnapshotPublisher(size_t snapshot_bytes = kDefaultSnapshotBytes,
+                             size_t reader_capacity = kDefaultReaderCapacity,
+                             bool enabled = true);
+
+  // Copy up to snapshot_bytes from a buffer and make it the current snapshot.
+  // Called from the processing thread, at most once every few buffers, and
+  // does nothing while the publisher is disabled.
+  // trigger_position is where a crossing the caller lined the copy up on sits
+  // in it, for readers to draw from rather than search for again.
+  void Publish(const uint8_t* wire_data, size_t byte_count,
+               std::optional<double> trigger_position = std::nullopt);
+
+  // Ask the writer to line the snapshots up on a crossing: to look for one
+  // across the whole buffer it has, and copy the window around it rather than
+  // the buffer's head (see snapshot_trigger.h). From any thread, taking effect
+  // from the next snapshot. Only a publisher whose writer looks for it
+  // honours it; the publisher itself just keeps the setting.
+  void ArmTrigger(const SnapshotTrigger& trigger);
+  void DisarmTrigger();
+
+  // What the writer should line up on, if anything.
+  std::optional<SnapshotTrigger> ArmedTrigger() const;
+
+  // Turn publishing on or off, for a tap that is only worth its copies while
+  // somebody is looking at what it feeds. From any thread but the writer's,
+  // taking effect from the next snapshot due. The first enable allocates the
+  // pool, here and before the writer can see the change, so that the writer
+  // never allocates; a disable keeps it for the next enable.
+  void SetEnabled(bool enabled);
+
+  // Whether the writer should publish. What a writer checks before it does
+  // anything towards a snapshot.
+  bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+  // Register a consumer. Nothing when the capacity is taken; the capacity is
+  // fixed because it is what the pool was sized for.
+  std::unique_ptr<Reader> AddReader();
+
+  // Take a copy of the most recent snapshot, if one has arrived since the last
+  // call. Returns false when there is nothing new, which is the ordinary case
+  // for a display refreshing faster than snapshots are published.
+  //
+  // A reader of its own, registered on first use and held for the life of the
+  // publisher, for the consumer that wants its own copy to work on — which is
+  // the one the displays have always been. It takes a place in the capacity
+  // like any other.
   bool TryRead(std::vector<uint8_t>& out, uint64_t& generation);
 
+  // The same, with the snapshot's trigger position (see
+  // Reader::trigger_position).
+  bool TryRead(std::vector<uint8_t>& out, uint64_t& generation,
+               std::optional<double>& trigger_position);
+
   // Snapshots published in total. A consumer that falls behind sees this jump
   // by more than one, which is how it knows it dropped some — and dropping them
   // is correct, because an old snapshot of a live signal is of no interest.
   uint64_t Generation() const { return generation_.load(); }
 
   size_t snapshot_bytes() const { return snapshot_bytes_; }
+  size_t reader_capacity() const { return reader_capacity_; }
 
  private:
   struct Buffer {
     std::vector<uint8_t> data;
     size_t used = 0;
-    uint64_t generation = 0;
+    std::optional<double> trigger_position;
+
+    // Readers with this buffer pinned, including one part-way through pinning
+    // it that may yet let go
+    std::atomic<uint32_t> pins{0};
   };
 
-  // The index of the buffer holding the newest complete snapshot, with the top
-  // bit set when it has not been read yet. Packed into one atomic because the
-  // handover has to be a single indivisible step: an index and a flag in two
-  // atomics could be read half-updated.
-  static constexpr unsigned kFreshFlag = 0x4;
-  static constexpr unsigned kIndexMask = 0x3;
+  // The newest snapshot, as its generation and the buffer holding it packed
+  // into one word, so a reader can tell in one load both where it is and
+  // whether it is still the one it pinned. Zero until something is published.
+  static constexpr unsigned kIndexBits = 8;
+  static constexpr uint64_t kIndexMask = (uint64_t{1} << kIndexBits) - 1;
+
+  // The armed trigger, packed into one word so the writer takes all of it or
+  // none of a change: the level in the low sixteen bits, the hysteresis in the
+  // next sixteen, the pre-trigger fraction in millionths above those, and the
+  // top bit for armed. Zero is disarmed.
+  static constexpr uint64_t kTriggerArmedBit = uint64_t{1} << 63;
+  static constexpr double kTriggerFractionScale = 1'000'000.0;
 
   size_t snapshot_bytes_;
-  Buffer buffers_[3];
-  unsigned write_index_ = 0;
-  unsigned read_index_ = 1;
-  std::atomic<unsigned> ready_{2};
+  size_t reader_capacity_;
+  std::vector<Buffer> buffers_;
+  size_t write_index_ = 0;
+  std::atomic<uint64_t> newest_{0};
   std::atomic<uint64_t> generation_{0};
+  std::atomic<size_t> readers_{0};
+  std::atomic<uint64_t> trigger_{0};
+  std::unique_ptr<Reader> copying_reader_;
+
+  // Serialises enabling callers; the writer only ever reads enabled_, which
+  // is stored after the pool it guards is in place.
+  std::mutex enable_mutex_;
+  bool allocated_ = false;
+  std::atomic<bool> enabled_{false};
 };
 
 }  // namespace ddd::capture
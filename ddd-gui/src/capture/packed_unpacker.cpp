@@ -0,0 +1,187 @@
+/************************************************************************
+
+    packed_unpacker.cpp
+
+    Turning the packed wire format back into one word per sample
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "packed_unpacker.h"
+
+#include <algorithm>
+
+namespace ddd::capture {
+namespace {
+
+uint16_t BlockNumberAt(const uint8_t* header) {
+  return static_cast<uint16_t>(
+      static_cast<uint16_t>(header[0]) |
+      static_cast<uint16_t>(static_cast<uint16_t>(header[1]) << 8));
+}
+
+// One block's payload into 6552 little-endian words.
+//
+// Each group of five bytes is assembled into one 40-bit value and the four
+// samples are shifted out of it. Assembled from bytes rather than loaded as a
+// machine word, so that it means the same on any host and never reads past the
+// end of the payload; a compiler turns the assembly back into a load where the
+// host allows one. Every group is independent of every other — no branch, no
+// state carried from one to the next, a trip count fixed at compile time —
+// which is what lets the compiler vectorise the loop rather than walk it.
+void UnpackPayload(const uint8_t* payload, uint8_t* output) {
+  for (size_t group = 0; group < kPackedGroupsPerBlock; ++group) {
+    const uint8_t* in = payload + (group * kPackedGroupBytes);
+    const uint64_t bits = static_cast<uint64_t>(in[0]) |
+                          (static_cast<uint64_t>(in[1]) << 8) |
+                          (static_cast<uint64_t>(in[2]) << 16) |
+                          (static_cast<uint64_t>(in[3]) << 24) |
+                          (static_cast<uint64_t>(in[4]) << 32);
+
+    uint8_t* out = output + (group * kPackedGroupSamples * kBytesPerSample);
+    for (size_t sample = 0; sample < kPackedGroupSamples; ++sample) {
+      const uint16_t value =
+          static_cast<uint16_t>((bits >> (10 * sample)) & kSampleValueMask);
+      out[sample * kBytesPerSample] = static_cast<uint8_t>(value & 0xFF);
+      out[(sample * kBytesPerSample) + 1] = static_cast<uint8_t>(value >> 8);
+    }
+  }
+}
+
+}  // namespace
+
+size_t PackedUnpacker::MaximumSamplesFor(size_t bytes) {
+  return ((kSynchronisationBytes + bytes) / kPackedBlockBytes) *
+         kPackedSamplesPerBlock;
+}
+
+PackedUnpacker::PackedUnpacker() { Reset(); }
+
+void PackedUnpacker::Reset() {
+  state_ = SequenceState::kSynchronising;
+  next_block_ = 0;
+  blocks_unpacked_ = 0;
+  gathered_.clear();
+  gathered_.reserve(kSynchronisationBytes);
+  pending_.clear();
+  pending_.reserve(kPackedBlockBytes);
+}
+
+PackedUnpacker::Outcome PackedUnpacker::Process(const uint8_t* packed,
+                                                size_t bytes,
+                                                uint8_t* output) {
+  Outcome outcome;
+
+  // Already failed: reported rather than asserted, as the validator does,
+  // because the orchestrator shutting down may still drain one more buffer.
+  if (state_ == SequenceState::kFailed) {
+    outcome.ok = false;
+    return outcome;
+  }
+
+  if (state_ == SequenceState::kRunning) {
+    outcome.ok = Consume(packed, bytes, output, outcome);
+    return outcome;
+  }
+
+  // Synchronising. Gathered rather than searched in place, because the lock
+  // needs three headers and the first buffer of a run with small slots may not
+  // hold them. Only as much as the search needs is gathered; the rest of this
+  // buffer is consumed from where it lies once the lock is taken.
+  const size_t take =
+      std::min(bytes, kSynchronisationBytes - gathered_.size());
+  gathered_.insert(gathered_.end(), packed, packed + take);
+  if (gathered_.size() < kSynchronisationBytes) {
+    return outcome;
+  }
+
+  size_t offset = 0;
+  if (!Synchronise(outcome, offset)) {
+    state_ = SequenceState::kFailed;
+    outcome.ok = false;
+    outcome.headers_found = false;
+    gathered_.clear();
+    return outcome;
+  }
+
+  state_ = SequenceState::kRunning;
+  outcome.ok = Consume(gathered_.data() + offset,
+                       gathered_.size() - offset, output, outcome) &&
+               Consume(packed + take, bytes - take, output, outcome);
+  gathered_.clear();
+  return outcome;
+}
+
+bool PackedUnpacker::Synchronise(Outcome& outcome, size_t& offset) {
+  // Even offsets only. The device sends words, so a header starts on a word
+  // boundary wherever the stream was joined.
+  for (offset = 0; offset < kPackedBlockBytes; offset += kPackedHeaderBytes) {
+    const uint16_t first = BlockNumberAt(gathered_.data() + offset);
+    const uint16_t second =
+        BlockNumberAt(gathered_.data() + offset + kPackedBlockBytes);
+    const uint16_t third =
+        BlockNumberAt(gathered_.data() + offset + (2 * kPackedBlockBytes));
+
+    if (second == static_cast<uint16_t>(first + 1) &&
+        third == static_cast<uint16_t>(first + 2)) {
+      next_block_ = first;
+      outcome.synchronised_here = true;
+      outcome.synchronisation_byte_offset = offset;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PackedUnpacker::Consume(const uint8_t* data, size_t bytes,
+                             uint8_t* output, Outcome& outcome) {
+  if (!pending_.empty()) {
+    const size_t take = std::min(bytes, kPackedBlockBytes - pending_.size());
+    pending_.insert(pending_.end(), data, data + take);
+    data += take;
+    bytes -= take;
+
+    if (pending_.size() < kPackedBlockBytes) {
+      return true;
+    }
+    if (!UnpackBlock(pending_.data(), output, outcome)) {
+      return false;
+    }
+    pending_.clear();
+  }
+
+  while (bytes >= kPackedBlockBytes) {
+    if (!UnpackBlock(data, output, outcome)) {
+      return false;
+    }
+    data += kPackedBlockBytes;
+    bytes -= kPackedBlockBytes;
+  }
+
+  pending_.assign(data, data + bytes);
+  return true;
+}
+
+bool PackedUnpacker::UnpackBlock(const uint8_t* block, uint8_t* output,
+                                 Outcome& outcome) {
+  const uint16_t number = BlockNumberAt(block);
+  if (number != next_block_) {
+    state_ = SequenceState::kFailed;
+    outcome.mismatch_block_index = blocks_unpacked_;
+    outcome.expected_block = next_block_;
+    outcome.actual_block = number;
+    return false;
+  }
+
+  UnpackPayload(block + kPackedHeaderBytes,
+                output + (outcome.sample_count * kBytesPerSample));
+  outcome.sample_count += kPackedSamplesPerBlock;
+
+  ++next_block_;
+  ++blocks_unpacked_;
+  return true;
+}
+
+}  // namespace ddd::capture
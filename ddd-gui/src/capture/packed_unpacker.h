@@ -0,0 +1,129 @@
+/************************************************************************
+
+    packed_unpacker.h
+
+    Turning the packed wire format back into one word per sample
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "sample_format.h"
+#include "sequence_validator.h"
+
+namespace ddd::capture {
+
+// Unpacks the device's packed stream (WireFormat in sample_format.h) into the
+// 16-bit words everything downstream expects, and checks its block numbers on
+// the way.
+//
+// It stands in front of SequenceValidator and takes over the half of its job
+// the packed format moves: the samples it writes carry no marker bits, so the
+// continuity proof is the block numbers, and it is made here. The validator
+// still strips and measures the words, and is told not to look for markers
+// that will never be there.
+//
+// A block can straddle two buffers — nothing obliges a transfer to end where a
+// block does — so a partial block is carried across calls. That, and the
+// bytes gathered to search for the lock, are the only copies made of packed
+// data, each into a buffer of fixed size reserved by Reset, so Process never
+// allocates. Everything else is unpacked straight from the caller's buffer
+// into the caller's output.
+//
+// The lock is taken on three consecutive block numbers rather than one, for the
+// same reason the validator locks on a counter change rather than on the first
+// word: the stream opens on whatever was in flight, and two bytes of sample
+// data that happen to look like a header are far likelier than three spaced
+// exactly a block apart and counting up.
+//
+// Thread-safety: none. One instance belongs to the processing thread for the
+// life of a capture.
+class PackedUnpacker {
+ public:
+  // Bytes the lock is looked for in: enough for a block's worth of candidate
+  // offsets, each with the two headers that must follow it.
+  static constexpr size_t kSynchronisationBytes = 4 * kPackedBlockBytes;
+
+  struct Outcome {
+    // False for a block number that did not follow its predecessor, and for a
+    // stream in which no header could be found at all. Unlike a word stream
+    // with no markers, the latter is not an old device: packed data is only
+    // ever asked for from gateware that said it could produce it.
+    bool ok = true;
+
+    // Samples written to the output, as 16-bit words. Everything before a
+    // mismatch is written: those samples were real.
+    size_t sample_count = 0;
+
+    // Where a mismatch was, in blocks since the lock was taken, and the two
+    // numbers. Meaningless when ok is true or headers_found is false.
+    uint64_t mismatch_block_index = 0;
+    uint16_t expected_block = 0;
+    uint16_t actual_block = 0;
+
+    // False when the search for a lock ran out of data to search.
+    bool headers_found = true;
+
+    // True when the lock was taken during this call, at this byte offset into
+    // what had been gathered for the search.
+    bool synchronised_here = false;
+    size_t synchronisation_byte_offset = 0;
+  };
+
+  // The most samples one call can write, for `bytes` of input. What the output
+  // buffer must hold: a call may complete a block carried in from before, and
+  // the call that takes the lock unpacks everything gathered for the search.
+  static size_t MaximumSamplesFor(size_t bytes);
+
+  PackedUnpacker();
+
+  // Unpack, check and append. `output` must have room for
+  // MaximumSamplesFor(bytes) little-endian words.
+  Outcome Process(const uint8_t* packed, size_t bytes, uint8_t* output);
+
+  // kSynchronising until the lock is taken, kRunning after, kFailed for good
+  // once anything is wrong. Never kDisabled.
+  SequenceState state() const { return state_; }
+
+  // Start again, looking for a lock. Also where the two buffers get their
+  // capacity, so that it is taken when a capture starts rather than on the
+  // processing thread.
+  void Reset();
+
+ private:
+  // Look for the lock in what has been gathered. On success, the offset of
+  // the first locked block in it.
+  bool Synchronise(Outcome& outcome, size_t& offset);
+
+  // Unpack a run of locked stream: finish any carried block, unpack every
+  // whole block that follows, and carry what is left. False on a mismatch.
+  bool Consume(const uint8_t* data, size_t bytes, uint8_t* output,
+               Outcome& outcome);
+
+  // Check one whole block's header and unpack its samples. False, with the
+  // mismatch recorded, when the header is not the one expected.
+  bool UnpackBlock(const uint8_t* block, uint8_t* output, Outcome& outcome);
+
+  SequenceState state_ = SequenceState::kSynchronising;
+
+  // The number the next block should carry
+  uint16_t next_block_ = 0;
+  uint64_t blocks_unpacked_ = 0;
+
+  // The first kSynchronisationBytes of the stream, gathered to look for a
+  // lock in; unused once it is taken.
+  std::vector<uint8_t> gathered_;
+
+  // The opening bytes of a block the last buffer ended part way through. Never
+  // more than a block, so never more than its reserved capacity.
+  std::vector<uint8_t> pending_;
+};
+
+}  // namespace ddd::capture
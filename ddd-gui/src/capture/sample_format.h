@@ -14,6 +14,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "wire_protocol.h"
+
 // Every fact about what arrives from the device, in one place.
 //
 // The device delivers one 16-bit little-endian word per sample:
@@ -90,6 +92,95 @@ inline constexpr uint16_t MakeWireWord(uint16_t sample_value,
                             << kSequenceCounterShift));
 }
 
+// The packed wire format.
+//
+// What the device sends instead of one word per sample when the host asks it
+// to (kRegisterWireFormat in wire_protocol.h). Ten bits a sample rather than
+// sixteen, which is 50 MB/s at the full rate rather than 80 — the difference
+// between a USB 3 host controller that keeps up and one that drops packets.
+//
+// The stream is a run of fixed 8192-byte blocks:
+//
+//     bytes 0..1     a 16-bit block number, low byte first, counting up from
+//                    zero and wrapping at 65,536
+//     bytes 2..8191  6552 samples, ten bits each, least significant bit first
+//                    from bit 0 of byte 2
+//
+// So every five bytes of payload are four whole samples, and a block's payload
+// ends on a byte boundary with nothing left over. The block number does the
+// sequence counter's job — a block that did not follow its predecessor is a
+// hole in the stream — and the samples themselves carry no marker bits at all.
+//
+// The block length is the one that makes a header and its payload a power of
+// two, so a block boundary falls on every USB packet boundary the firmware
+// draws. Nothing on this side depends on that: a block is found by its header,
+// not by where a transfer happened to start.
+enum class WireFormat {
+  kWords,
+  kPacked,
+};
+
+inline constexpr size_t kPackedBlockBytes = 8192;
+inline constexpr size_t kPackedHeaderBytes = 2;
+inline constexpr size_t kPackedPayloadBytes =
+    kPackedBlockBytes - kPackedHeaderBytes;
+
+// Four samples in five bytes
+inline constexpr size_t kPackedGroupBytes = 5;
+inline constexpr size_t kPackedGroupSamples = 4;
+inline constexpr size_t kPackedGroupsPerBlock =
+    kPackedPayloadBytes / kPackedGroupBytes;
+inline constexpr size_t kPackedSamplesPerBlock =
+    kPackedGroupsPerBlock * kPackedGroupSamples;
+
+static_assert(kPackedPayloadBytes % kPackedGroupBytes == 0,
+              "a block's payload must be a whole number of groups");
+static_assert(kPackedSamplesPerBlock == 6552, "the gateware's block length");
+
+// What a second of samples costs on the wire in a given format, for the
+// figures that compare a measured rate against what it should have been.
+inline constexpr double WireBytesPerSecond(WireFormat format,
+                                           uint32_t sample_rate_hz) {
+  return format == WireFormat::kPacked
+             ? static_cast<double>(sample_rate_hz) *
+                   static_cast<double>(kPackedBlockBytes) /
+                   static_cast<double>(kPackedSamplesPerBlock)
+             : static_cast<double>(sample_rate_hz) *
+                   static_cast<double>(kBytesPerSample);
+}
+
+// How many samples a run of bytes off the wire carries: two bytes a sample in
+// the word format, 6552 to every 8192-byte block packed, and in either, eight
+// words fewer at the head of every packet while the in-band block is on (the
+// stripper takes those out before the unpacker sees anything). For counting
+// what is queued and not yet processed — a slot of the ring, or several —
+// where dividing by kBytesPerSample is right for only one of the four
+// combinations. A part-filled packet or block at the end counts the whole
+// samples it holds.
+inline constexpr uint64_t SamplesInWireBytes(uint64_t bytes, WireFormat format,
+                                             bool inband_telemetry) {
+  uint64_t payload = bytes;
+  if (inband_telemetry) {
+    constexpr uint64_t kPacketBytes = kInbandPacketWords * kBytesPerSample;
+    constexpr uint64_t kBlockBytes = kInbandBlockWords * kBytesPerSample;
+    const uint64_t tail = bytes % kPacketBytes;
+    payload -= ((bytes / kPacketBytes) * kBlockBytes) +
+               (tail < kBlockBytes ? tail : kBlockBytes);
+  }
+
+  if (format == WireFormat::kWords) {
+    return payload / kBytesPerSample;
+  }
+  const uint64_t tail = payload % kPackedBlockBytes;
+  const uint64_t tail_samples =
+      tail > kPackedHeaderBytes
+          ? ((tail - kPackedHeaderBytes) / kPackedGroupBytes) *
+                kPackedGroupSamples
+          : 0;
+  return ((payload / kPackedBlockBytes) * kPackedSamplesPerBlock) +
+         tail_samples;
+}
+
 // Convert a 10-bit unsigned sample to the signed 16-bit representation
 // ld-decode calls the DdD 16-bit format.
 //
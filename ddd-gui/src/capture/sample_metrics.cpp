@@ -17,6 +17,16 @@
 namespace ddd::capture {
 namespace {
 
+// A buffer's histogram into a span's, bin by bin. Widening and adding with no
+// dependence between the bins, which the compiler vectorises; a thousand of
+// them per two-megabyte buffer.
+void AddCodeCounts(CodeCounts& total,
+                   const std::array<uint32_t, kSampleCodeCount>& buffer) {
+  for (size_t code = 0; code < kSampleCodeCount; ++code) {
+    total[code] += buffer[code];
+  }
+}
+
 double RootMeanSquare(uint64_t sum_of_squares, uint64_t sample_count) {
   if (sample_count == 0) {
     return 0.0;
@@ -33,11 +43,13 @@ void SampleMetrics::Accumulate(const BufferTally& tally) {
   }
 
   sample_count_ += tally.sample_count;
+  measured_sample_count_ += tally.sample_count;
   minimum_value_ = std::min(minimum_value_, tally.minimum_value);
   maximum_value_ = std::max(maximum_value_, tally.maximum_value);
   clipped_low_count_ += tally.clipped_low_count;
   clipped_high_count_ += tally.clipped_high_count;
   sum_of_squares_ += tally.sum_of_squares;
+  AddCodeCounts(code_counts_, tally.code_counts);
 
   recent_ = tally;
 
@@ -53,11 +65,17 @@ void SampleMetrics::Accumulate(const BufferTally& tally) {
     capture_.clipped_low_count += tally.clipped_low_count;
     capture_.clipped_high_count += tally.clipped_high_count;
     capture_.sum_of_squares += tally.sum_of_squares;
+    AddCodeCounts(capture_code_counts_, tally.code_counts);
   }
 }
 
+void SampleMetrics::CountUnmeasured(uint64_t samples) {
+  sample_count_ += samples;
+}
+
 void SampleMetrics::BeginCaptureSpan() {
   capture_ = BufferTally{};
+  capture_code_counts_.fill(0);
   capturing_ = true;
 }
 
@@ -66,15 +84,16 @@ void SampleMetrics::EndCaptureSpan() { capturing_ = false; }
 SampleMetricsSnapshot SampleMetrics::Snapshot() const {
   SampleMetricsSnapshot snapshot;
   snapshot.sample_count = sample_count_;
+  snapshot.measured_sample_count = measured_sample_count_;
 
-  // Before any samples have arrived the minimum is still its seed, and
+  // Before any samples have been measured the minimum is still its seed, and
   // reporting 65535 as the quietest sample seen would be nonsense. Zero for
   // both is the honest "nothing measured yet".
-  snapshot.minimum_value = (sample_count_ == 0) ? 0 : minimum_value_;
+  snapshot.minimum_value = (measured_sample_count_ == 0) ? 0 : minimum_value_;
   snapshot.maximum_value = maximum_value_;
   snapshot.clipped_low_count = clipped_low_count_;
   snapshot.clipped_high_count = clipped_high_count_;
-  snapshot.rms = RootMeanSquare(sum_of_squares_, sample_count_);
+  snapshot.rms = RootMeanSquare(sum_of_squares_, measured_sample_count_);
 
   snapshot.recent_minimum_value =
       (recent_.sample_count == 0) ? 0 : recent_.minimum_value;
@@ -96,15 +115,27 @@ SampleMetricsSnapshot SampleMetrics::Snapshot() const {
   return snapshot;
 }
 
+CodeHistograms SampleMetrics::Histograms() const {
+  CodeHistograms histograms;
+  histograms.session = code_counts_;
+  std::copy(recent_.code_counts.begin(), recent_.code_counts.end(),
+            histograms.recent.begin());
+  histograms.capture = capture_code_counts_;
+  return histograms;
+}
+
 void SampleMetrics::Reset() {
   sample_count_ = 0;
+  measured_sample_count_ = 0;
   minimum_value_ = UINT16_MAX;
   maximum_value_ = 0;
   clipped_low_count_ = 0;
   clipped_high_count_ = 0;
   sum_of_squares_ = 0;
+  code_counts_.fill(0);
   recent_ = BufferTally{};
   capture_ = BufferTally{};
+  capture_code_counts_.fill(0);
   capturing_ = false;
 }
 
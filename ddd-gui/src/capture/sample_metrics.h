@@ -11,11 +11,22 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 
+#include "sample_format.h"
+
 namespace ddd::capture {
 
+// One histogram bin for each of the converter's codes.
+inline constexpr size_t kSampleCodeCount = size_t{kMaximumSampleValue} + 1;
+
+// How many times each code turned up over a span. 64-bit for the same reason
+// sum_of_squares is: an hour at 40 Msps is 1.4e11 samples, and the middle codes
+// of a quiet signal collect a fair share of them.
+using CodeCounts = std::array<uint64_t, kSampleCodeCount>;
+
 // One buffer's worth of tallies, produced by the single pass that also
 // validates the sequence markers.
 //
@@ -41,13 +52,27 @@ struct BufferTally {
   // would overflow partway through a long capture, which is the length of
   // capture this application exists for.
   uint64_t sum_of_squares = 0;
+
+  // How many times each code turned up in the buffer. 32-bit because a buffer
+  // is at most a few million samples, and that halves what is copied about with
+  // every tally — the spans below widen it as they add it in.
+  std::array<uint32_t, kSampleCodeCount> code_counts{};
 };
 
 // What a monitoring consumer sees. A plain value, so it can be copied out of
 // the published stats block without touching the accumulator.
 struct SampleMetricsSnapshot {
+  // Every sample that went past, measured or not.
   uint64_t sample_count = 0;
 
+  // The ones the figures below were measured over. The same as sample_count
+  // while a file is being written; while only monitoring, a pipeline that
+  // checks one buffer in several measures that one and the head of each of
+  // the rest (see CapturePipeline::Options::monitor_validation_interval), so
+  // the extremes, clipping counts and RMS are a sample of the run and this
+  // says how big a one.
+  uint64_t measured_sample_count = 0;
+
   // Over the whole capture so far
   uint16_t minimum_value = 0;
   uint16_t maximum_value = 0;
@@ -91,6 +116,27 @@ struct SampleMetricsSnapshot {
   double capture_rms = 0.0;
 };
 
+// The code histogram, over the same three spans as SampleMetricsSnapshot.
+//
+// Not part of that snapshot, and so not part of the statistics block. It is
+// 24 KiB where everything else the panels read is a few hundred bytes, nothing
+// on screen reads it at buffer rate, and the statistics block is copied whole
+// every time anybody reads any of it. It goes out through a publisher of its
+// own, less often — see HistogramPublisher.
+//
+// The session and recent histograms are whole while a file is being written
+// and a sample otherwise: a pipeline that is only monitoring counts codes on
+// the buffers it publishes from and no others (see SequenceValidator::Process),
+// so their shape is right and their totals are not a count of the run.
+struct CodeHistograms {
+  CodeCounts session{};
+  CodeCounts recent{};
+
+  // The file's own samples: zero until a capture has run, frozen when the
+  // file is closed, exactly as the capture_ figures are.
+  CodeCounts capture{};
+};
+
 // Accumulates per-buffer tallies into the figures the monitor panels show.
 //
 // Thread-safety: none. Owned and driven by the processing thread; readers get a
@@ -99,8 +145,15 @@ class SampleMetrics {
  public:
   void Accumulate(const BufferTally& tally);
 
+  // Count samples that went past without being measured, as the part of a
+  // skipped buffer outside the waveform tap's window does. They are part of
+  // the run's length and nothing else.
+  void CountUnmeasured(uint64_t samples);
+
   SampleMetricsSnapshot Snapshot() const;
 
+  CodeHistograms Histograms() const;
+
   void Reset();
 
   // Start measuring a capture, discarding whatever the previous one measured.
@@ -119,16 +172,22 @@ class SampleMetrics {
 
  private:
   uint64_t sample_count_ = 0;
+  uint64_t measured_sample_count_ = 0;
   uint16_t minimum_value_ = UINT16_MAX;
   uint16_t maximum_value_ = 0;
   uint64_t clipped_low_count_ = 0;
   uint64_t clipped_high_count_ = 0;
   uint64_t sum_of_squares_ = 0;
 
+  CodeCounts code_counts_{};
+
   BufferTally recent_;
 
-  // The span a file's own samples fall in, and whether it is still open.
+  // The span a file's own samples fall in, and whether it is still open. The
+  // histogram is kept beside it rather than in its tally, whose 32-bit bins
+  // are a buffer's width and would overflow inside an hour's capture.
   BufferTally capture_;
+  CodeCounts capture_code_counts_{};
   bool capturing_ = false;
 };
 
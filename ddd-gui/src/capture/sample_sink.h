@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace ddd::capture {
 
@@ -84,6 +85,24 @@ class ISampleSink {
   // remedies that look the same from the ring's point of view.
   virtual uint64_t SamplesPending() const { return 0; }
 
+  // Threads this sink does its work on besides the caller's, by the kernel's
+  // own identifiers. Empty for a sink that works on the processing thread
+  // alone; a FLAC sink names libFLAC's encoder threads, so that the pipeline's
+  // thread accounting can charge the encode to the encoder rather than to
+  // nobody.
+  virtual std::vector<uint64_t> WorkerThreadIds() const { return {}; }
+
+  // The levels of effort this sink's capture steps between, highest first, in
+  // its own units — FLAC compression levels, for a FLAC sink — and which of
+  // them this sink was opened at. Empty, and step 0, for a sink with no effort
+  // to spend, which is most of them.
+  //
+  // A sink's effort is fixed once it is open. The pipeline's
+  // EncoderEffortController watches the ring while it is written and decides
+  // the step the next file opens at (CapturePipeline::EffortStepForNextFile).
+  virtual std::vector<int> EffortLevels() const { return {}; }
+  virtual size_t EffortStep() const { return 0; }
+
   virtual const std::string& LastError() const = 0;
 };
 
@@ -31,14 +31,16 @@ const char* SequenceStateName(SequenceState state) {
   return "unknown";
 }
 
-void SequenceValidator::Reset() {
-  state_ = SequenceState::kSynchronising;
+void SequenceValidator::Reset(bool markers_carried) {
+  state_ = markers_carried ? SequenceState::kSynchronising
+                           : SequenceState::kDisabled;
   counter_value_ = 0;
   samples_until_increment_ = 0;
 }
 
 SequenceValidator::Outcome SequenceValidator::Process(uint8_t* buffer,
-                                                      size_t byte_count) {
+                                                      size_t byte_count,
+                                                      bool count_codes) {
   Outcome outcome;
 
   const size_t sample_count = byte_count / kBytesPerSample;
@@ -96,6 +98,18 @@ SequenceValidator::Outcome SequenceValidator::Process(uint8_t* buffer,
     }
   }
 
+  if (count_codes) {
+    StripAndMeasure<true>(buffer, sample_count, validate_from, outcome);
+  } else {
+    StripAndMeasure<false>(buffer, sample_count, validate_from, outcome);
+  }
+  return outcome;
+}
+
+template <bool kCountCodes>
+void SequenceValidator::StripAndMeasure(uint8_t* buffer, size_t sample_count,
+                                        size_t validate_from,
+                                        Outcome& outcome) {
   const bool checking = (state_ == SequenceState::kRunning);
 
   uint16_t minimum_value = UINT16_MAX;
@@ -105,6 +119,12 @@ SequenceValidator::Outcome SequenceValidator::Process(uint8_t* buffer,
   uint64_t sum_of_squares = 0;
   uint64_t measured = 0;
 
+  if constexpr (kCountCodes) {
+    for (std::array<uint32_t, kSampleCodeCount>& lane : lanes_) {
+      lane.fill(0);
+    }
+  }
+
   for (size_t index = 0; index < sample_count; ++index) {
     uint8_t* word = buffer + (index * kBytesPerSample);
     const uint8_t high_byte = word[1];
@@ -150,16 +170,103 @@ SequenceValidator::Outcome SequenceValidator::Process(uint8_t* buffer,
 
     const int32_t centred = static_cast<int32_t>(value) - kSampleZeroOffset;
     sum_of_squares += static_cast<uint64_t>(centred * centred);
+
+    // The mask is a no-op on a stripped word, and is there so the compiler
+    // can see the index is in range
+    if constexpr (kCountCodes) {
+      ++lanes_[index % kHistogramLanes][value & kSampleValueMask];
+    }
     ++measured;
   }
 
+  if constexpr (kCountCodes) {
+    outcome.tally.code_counts = lanes_[0];
+    for (size_t lane = 1; lane < lanes_.size(); ++lane) {
+      for (size_t code = 0; code < kSampleCodeCount; ++code) {
+        outcome.tally.code_counts[code] += lanes_[lane][code];
+      }
+    }
+  }
+
   outcome.tally.sample_count = measured;
   outcome.tally.minimum_value = minimum_value;
   outcome.tally.maximum_value = maximum_value;
   outcome.tally.clipped_low_count = clipped_low;
   outcome.tally.clipped_high_count = clipped_high;
   outcome.tally.sum_of_squares = sum_of_squares;
-  return outcome;
+}
+
+SequenceValidator::Outcome SequenceValidator::Skip(const uint8_t* buffer,
+                                                   size_t byte_count) {
+  Outcome outcome;
+
+  const size_t sample_count = byte_count / kBytesPerSample;
+  if (sample_count == 0) {
+    return outcome;
+  }
+  if (state_ == SequenceState::kFailed) {
+    outcome.ok = false;
+    return outcome;
+  }
+  if (state_ != SequenceState::kRunning) {
+    return outcome;
+  }
+
+  // The first sample of the current counter run within this buffer. Zero at
+  // the start, where the run may have begun in an earlier buffer.
+  size_t run_start = 0;
+
+  // Whether the sample at `index`, which is inside the current run, carries
+  // the current counter. A mismatch is recorded the way Process records one.
+  const auto matches = [&](size_t index) {
+    const uint8_t counter = static_cast<uint8_t>(
+        buffer[(index * kBytesPerSample) + 1] >> kSequenceCounterHighByteShift);
+    if (counter == counter_value_) {
+      return true;
+    }
+    state_ = SequenceState::kFailed;
+    outcome.ok = false;
+    outcome.mismatch_sample_index = index;
+    outcome.expected_counter = counter_value_;
+    outcome.actual_counter = counter;
+    outcome.samples_expected_remaining =
+        samples_until_increment_ - static_cast<uint32_t>(index - run_start);
+    return false;
+  };
+
+  if (!matches(0)) {
+    return outcome;
+  }
+
+  while (true) {
+    const size_t run_end = run_start + samples_until_increment_;
+    if (run_end > sample_count) {
+      // The run carries on into the next buffer
+      if (!matches(sample_count - 1)) {
+        return outcome;
+      }
+      samples_until_increment_ -=
+          static_cast<uint32_t>(sample_count - run_start);
+      return outcome;
+    }
+
+    if (!matches(run_end - 1)) {
+      return outcome;
+    }
+    ++counter_value_;
+    if (counter_value_ >= kSequenceCounterValues) {
+      counter_value_ = 0;
+    }
+    samples_until_increment_ = kSamplesPerSequenceCounter;
+    run_start = run_end;
+
+    if (run_start == sample_count) {
+      return outcome;
+    }
+    if (!matches(run_start)) {
+      return outcome;
+    }
+  }
 }
 
 }  // namespace ddd::capture
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 
@@ -95,14 +96,47 @@ class SequenceValidator {
 
   // Validate, strip and measure one buffer. byte_count must be even; a trailing
   // odd byte is not a sample and is left alone.
-  Outcome Process(uint8_t* buffer, size_t byte_count);
+  //
+  // count_codes false leaves the code histogram out of the tally, and with it
+  // about a fifth of the pass: the histogram's only lasting reader is the
+  // metadata of a file being written, so a pipeline that is only monitoring
+  // counts codes on the buffers it publishes a histogram from and no others.
+  // Everything else in the tally is measured either way.
+  Outcome Process(uint8_t* buffer, size_t byte_count, bool count_codes = true);
+
+  // Account for one buffer without passing over it: for a pipeline that is
+  // only monitoring, and has better things to do with a core than prove
+  // bit-perfect a stream nobody is keeping.
+  //
+  // Nothing is stripped or measured, and the tally is empty. The counter is
+  // read only where the arithmetic says it changes — the last sample of each
+  // counter run and the first of the next, about thirty reads in a 2 MB
+  // buffer, plus the buffer's own first and last samples. That is not a
+  // sampled check: a run of counter values each 65,536 samples long can only
+  // change where it is expected to if none of the samples before the change
+  // went missing, so a loss of anything short of a whole counter cycle shows
+  // up at the next expected change, whichever buffer it falls in. What is
+  // lost is precision about *where* — the mismatch is reported at the check
+  // that saw it, up to one counter run after the samples went.
+  //
+  // The phase carries across, so a Process after a Skip checks the next
+  // buffer exactly as if every sample in between had been looked at. Only a
+  // running validator has a phase to carry: while synchronising or disabled
+  // this does nothing, and a synchronising validator simply looks for its
+  // first change in the next buffer it is given to Process.
+  Outcome Skip(const uint8_t* buffer, size_t byte_count);
 
   SequenceState state() const { return state_; }
 
   // True once the validator has decided whether this stream carries markers.
   bool synchronised() const { return state_ != SequenceState::kSynchronising; }
 
-  void Reset();
+  // Start again. markers_carried false is for a stream known to have none —
+  // the packed format's unpacked words, whose continuity PackedUnpacker checks
+  // — and goes straight to kDisabled, so the validator strips and measures
+  // without spending its first 65,537 samples looking for a change that cannot
+  // come.
+  void Reset(bool markers_carried = true);
 
  private:
   SequenceState state_ = SequenceState::kSynchronising;
@@ -114,6 +148,27 @@ class SequenceValidator {
   // boundaries, which is what lets a buffer size that is not a whole number of
   // counter periods work — the device does not know where our buffers end.
   uint32_t samples_until_increment_ = 0;
+
+  // The code histogram, kept as four interleaved copies that are added
+  // together at the end of each buffer.
+  //
+  // A histogram is a scatter, and a scatter does not vectorise on anything
+  // this application is built for. What it does do is stall: an RF signal
+  // sits on neighbouring codes for sample after sample, so one counter is
+  // incremented over and over, and each increment waits for the store before
+  // it to land. Four copies, with consecutive samples going to different
+  // ones, leave four increments of the same code independent of each other
+  // and take the stall out. 16 KiB between them, which stays in the
+  // first-level cache with the buffer streaming past it.
+  static constexpr size_t kHistogramLanes = 4;
+  std::array<std::array<uint32_t, kSampleCodeCount>, kHistogramLanes> lanes_{};
+
+  // The pass itself, from validate_from on, in two copies so that the one
+  // without the histogram has no trace of it in the loop rather than a
+  // branch per sample.
+  template <bool kCountCodes>
+  void StripAndMeasure(uint8_t* buffer, size_t sample_count,
+                       size_t validate_from, Outcome& outcome);
 };
 
 }  // namespace ddd::capture
@@ -0,0 +1,146 @@
+/************************************************************************
+
+    snapshot_trigger.cpp
+
+    Lining the waveform tap up on the signal before it is copied
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "snapshot_trigger.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "sample_format.h"
+
+namespace ddd::capture {
+namespace {
+
+// Samples reduced to one minimum or maximum before the block is judged. Long
+// enough that the branch at the end of a block is nothing beside the block,
+// short enough that the scan stops soon after the sample it was looking for.
+constexpr size_t kScanBlockSamples = 64;
+
+uint16_t ValueAt(const uint8_t* wire_data, size_t index) {
+  const size_t offset = index * kBytesPerSample;
+  return SampleValueFromWord(static_cast<uint16_t>(
+      static_cast<uint16_t>(wire_data[offset]) |
+      static_cast<uint16_t>(static_cast<uint16_t>(wire_data[offset + 1])
+                            << 8)));
+}
+
+// The first sample in [first, end) below `threshold`, or `end`
+size_t FirstBelow(const uint8_t* wire_data, size_t first, size_t end,
+                  uint16_t threshold) {
+  size_t index = first;
+  for (; index + kScanBlockSamples <= end; index += kScanBlockSamples) {
+    uint16_t lowest = UINT16_MAX;
+    for (size_t offset = 0; offset < kScanBlockSamples; ++offset) {
+      lowest = std::min(lowest, ValueAt(wire_data, index + offset));
+    }
+    if (lowest < threshold) {
+      break;
+    }
+  }
+  for (; index < end; ++index) {
+    if (ValueAt(wire_data, index) < threshold) {
+      return index;
+    }
+  }
+  return end;
+}
+
+// The first sample in [first, end) at or above `threshold`, or `end`
+size_t FirstAtOrAbove(const uint8_t* wire_data, size_t first, size_t end,
+                      uint16_t threshold) {
+  size_t index = first;
+  for (; index + kScanBlockSamples <= end; index += kScanBlockSamples) {
+    uint16_t highest = 0;
+    for (size_t offset = 0; offset < kScanBlockSamples; ++offset) {
+      highest = std::max(highest, ValueAt(wire_data, index + offset));
+    }
+    if (highest >= threshold) {
+      break;
+    }
+  }
+  for (; index < end; ++index) {
+    if (ValueAt(wire_data, index) >= threshold) {
+      return index;
+    }
+  }
+  return end;
+}
+
+}  // namespace
+
+std::optional<double> FindRisingCrossing(const uint8_t* wire_data, size_t first,
+                                         size_t end, uint16_t level,
+                                         uint16_t arm_level) {
+  if (wire_data == nullptr || first >= end) {
+    return std::nullopt;
+  }
+
+  const size_t armed_at = FirstBelow(wire_data, first, end, arm_level);
+  if (armed_at >= end) {
+    return std::nullopt;
+  }
+
+  // Everything from the arming sample up to this one is below the level, since
+  // the arming level is not above it, so the sample before is the crossing's
+  // lower side and the denominator below cannot be zero.
+  const size_t above = FirstAtOrAbove(wire_data, armed_at + 1, end, level);
+  if (above >= end) {
+    return std::nullopt;
+  }
+
+  const auto previous = static_cast<double>(ValueAt(wire_data, above - 1));
+  const auto current = static_cast<double>(ValueAt(wire_data, above));
+  return static_cast<double>(above - 1) +
+         ((static_cast<double>(level) - previous) / (current - previous));
+}
+
+std::optional<TriggeredWindow> PlaceTriggeredWindow(
+    const uint8_t* wire_data, size_t sample_count, size_t window_samples,
+    const SnapshotTrigger& trigger) {
+  if (window_samples == 0 || sample_count < window_samples) {
+    return std::nullopt;
+  }
+
+  // Rounded up, so that a sweep the scope starts a pre-trigger fraction of
+  // its span before the crossing never starts before the window does.
+  const double fraction = std::clamp(trigger.pre_trigger_fraction, 0.0, 1.0);
+  const size_t pre = std::min(
+      window_samples, static_cast<size_t>(std::ceil(
+                          fraction * static_cast<double>(window_samples))));
+
+  // The crossing's lower sample has to be at least `pre` into the slot, for
+  // the window to start inside it, and no further in than leaves the rest of
+  // the window inside it too.
+  const size_t last_lower = sample_count - window_samples + pre;
+  const size_t end = std::min(sample_count, last_lower + 2);
+
+  const uint16_t arm_level =
+      trigger.level_codes > trigger.hysteresis_codes
+          ? static_cast<uint16_t>(trigger.level_codes -
+                                  trigger.hysteresis_codes)
+          : 0;
+
+  const std::optional<double> crossing = FindRisingCrossing(
+      wire_data, pre, end, trigger.level_codes, arm_level);
+  if (!crossing.has_value()) {
+    return std::nullopt;
+  }
+
+  // From the crossing's lower sample, which is the one before the sample it
+  // rounds up to: a crossing that lands exactly on a sample is credited to the
+  // pair that sample ends, as FindTriggers credits it.
+  TriggeredWindow window;
+  window.first_sample = static_cast<size_t>(std::ceil(*crossing)) - 1 - pre;
+  window.crossing = *crossing - static_cast<double>(window.first_sample);
+  return window;
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,86 @@
+/************************************************************************
+
+    snapshot_trigger.h
+
+    Lining the waveform tap up on the signal before it is copied
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace ddd::capture {
+
+// The scope triggers on a rising crossing of a level (see
+// analysis/waveform_trigger.h), and it used to look for one only in the 64 KiB
+// the tap copied from the head of a slot. That head starts wherever the
+// transfer did, so a signal whose crossings are sparse — a weak carrier that
+// seldom clears the hysteresis, a long span that leaves little of the snapshot
+// to search — often had none in it that left room for a whole sweep, and the
+// display fell back to free-running and jittered.
+//
+// The slot the head was cut from is thirty-two times longer and is already in
+// the processing thread's hands. So when the tap is armed, the crossing is
+// looked for across the whole slot, and the window that is copied is the one
+// that puts that crossing where the scope draws its trigger point. The copy is
+// the same size as before; what changes is where it starts.
+//
+// The search is two scans, each over blocks with no branch but the one at the
+// end of a block: the lowest sample of each block against the arming level,
+// until one arms, then the highest against the trigger level, until one
+// crosses. Both are min and max reductions over fixed-length runs, which the
+// compiler vectorises, and a carrier crosses every few samples — so the usual
+// search is a block or two, and a flat input that never crosses costs one
+// vectorised pass over the slot.
+//
+// Samples are read straight from the wire words with their markers masked off,
+// so the search works the same on a slot the validator has stripped and on one
+// it has not yet reached — or has skipped (see
+// CapturePipeline::Options::monitor_validation_interval).
+
+// What the tap is to line up on. The defaults are the scope's: mid-scale, and
+// the hysteresis of kDefaultTriggerHysteresisCodes, with the crossing a tenth
+// of the way into the window as kPreTriggerFraction puts it. Kept here as
+// numbers because the engine does not depend on the analysis library; the GUI
+// passes its own constants in.
+struct SnapshotTrigger {
+  uint16_t level_codes = 512;
+  uint16_t hysteresis_codes = 16;
+
+  // Where in the window the crossing is placed, as a fraction of it
+  double pre_trigger_fraction = 0.1;
+};
+
+// A window of a slot with a crossing where the trigger wants it.
+struct TriggeredWindow {
+  // The window's first sample, as an index into the slot
+  size_t first_sample = 0;
+
+  // The crossing, in samples from the window's first sample, between the two
+  // samples it fell between — the same fractional position FindTriggers gives.
+  double crossing = 0.0;
+};
+
+// The first rising crossing of `level` in samples [first, end) of a run of
+// wire words, after a sample below `arm_level` at or after `first`. Nothing
+// when there is none, or when the crossing's upper sample would be at or past
+// `end`.
+std::optional<double> FindRisingCrossing(const uint8_t* wire_data, size_t first,
+                                         size_t end, uint16_t level,
+                                         uint16_t arm_level);
+
+// Where to take a `window_samples` window from a slot of `sample_count`
+// samples so that its first qualifying crossing sits at the trigger's
+// pre-trigger fraction. Nothing when the slot is shorter than the window or
+// holds no crossing the window could be placed around.
+std::optional<TriggeredWindow> PlaceTriggeredWindow(
+    const uint8_t* wire_data, size_t sample_count, size_t window_samples,
+    const SnapshotTrigger& trigger);
+
+}  // namespace ddd::capture
@@ -16,7 +16,9 @@
 #include <cctype>
 #include <chrono>
 #include <cstdlib>
+#include <deque>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <vector>
@@ -168,7 +170,7 @@ std::optional<TapState> StateNamed(std::string_view name) {
 
 size_t BytesForBits(size_t bits) { return (bits + 7) / 8; }
 
-bool BitAt(const std::vector<uint8_t>& bits, size_t index) {
+bool BitAt(std::span<const uint8_t> bits, size_t index) {
   return ((bits[index / 8] >> (index % 8)) & 1U) != 0;
 }
 
@@ -256,7 +258,7 @@ struct HexWindow {
   size_t highest_bit = 0;
 };
 
-HexWindow BitsToHexAround(const std::vector<uint8_t>& bits, size_t bit_count,
+HexWindow BitsToHexAround(std::span<const uint8_t> bits, size_t bit_count,
                           size_t around, size_t maximum_digits) {
   // Nothing to show, and the arithmetic below would run off the bottom of
   // size_t working that out. The only caller has already refused a scan of no
@@ -335,22 +337,16 @@ struct StickyScan {
   std::vector<uint8_t> smask;
 };
 
-class Player {
+// Text to program. Everything that reads the file is here, and nothing here
+// touches a cable.
+class Compiler {
  public:
-  Player(IJtagCable& cable, ILogger* logger,
-         const SvfPlayer::ProgressCallback& progress,
-         const SvfPlayer::StopCallback& stop, bool device_attached)
-      : cable_(cable),
-        logger_(logger),
-        progress_(progress),
-        stop_(stop),
-        device_attached_(device_attached) {}
-
-  SvfPlayResult Play(std::string_view text);
+  SvfCompileResult Compile(std::string_view text);
 
  private:
   bool NextStatement(Statement& statement);
   bool Execute(const Statement& statement);
+  void EndStatement();
 
   bool DoScan(const Statement& statement, bool instruction);
   bool DoRunTest(const Statement& statement);
@@ -363,27 +359,25 @@ class Player {
   bool ParseScanFields(const Statement& statement, size_t first,
                        ScanFields& fields);
 
-  bool MoveTo(TapState target);
-  bool Shift(const std::vector<uint8_t>& tdi, size_t bit_count,
-             std::vector<uint8_t>* tdo);
+  // Emitting the program.
+  SvfProgram::Operation& Begin(SvfProgram::Kind kind);
+  SvfProgram::Operation& Run();
+  void MoveTo(TapState target);
+  void Shift(const std::vector<uint8_t>& tdi, size_t bit_count,
+             const std::vector<uint8_t>* expected,
+             const std::vector<uint8_t>& mask, bool instruction);
+  void Resolve();
 
-  bool Fail(const std::string& problem);
   bool FailAt(size_t line, const std::string& problem);
 
   static std::optional<double> Number(const Token& token);
 
-  IJtagCable& cable_;
-  ILogger* logger_ = nullptr;
-  const SvfPlayer::ProgressCallback& progress_;
-  const SvfPlayer::StopCallback& stop_;
-  bool device_attached_ = true;
-
   std::string_view text_;
   size_t position_ = 0;
   size_t line_ = 1;
-  size_t reported_position_ = 0;
 
   std::string statement_keyword_;
+  size_t statement_line_ = 0;
 
   TapState current_ = TapState::kReset;
   TapState end_dr_ = TapState::kIdle;
@@ -392,6 +386,67 @@ class Player {
   StickyScan sticky_dr_;
   StickyScan sticky_ir_;
 
+  // Bits used so far in the program's TMS and TDI pools, which are zero
+  // beyond this.
+  uint64_t pool_bits_ = 0;
+
+  // Whether the last operation is a run the next shift can join.
+  bool run_open_ = false;
+
+  // Comparisons emitted since the last point they are all made.
+  size_t owed_compares_ = 0;
+
+  SvfProgram program_;
+  SvfCompileResult result_;
+};
+
+// Program to cable.
+class Replayer {
+ public:
+  Replayer(IJtagCable& cable, ILogger* logger, const SvfProgram& program,
+           const SvfPlayer::ProgressCallback& progress,
+           const SvfPlayer::StopCallback& stop, bool device_attached)
+      : cable_(cable),
+        logger_(logger),
+        program_(program),
+        progress_(progress),
+        stop_(stop),
+        device_attached_(device_attached) {}
+
+  SvfPlayResult Play();
+
+ private:
+  // A comparison asked for and not yet made, and the answer it will be made
+  // against once the cable has filled it in.
+  struct Owed {
+    const SvfProgram::Compare* compare = nullptr;
+    std::vector<uint8_t> received;
+  };
+
+  bool PlayShift(const SvfProgram::Operation& operation);
+  bool PlayRunClock(const SvfProgram::Operation& operation);
+
+  // Flush, then make every comparison owed. Without `always`, a flush with
+  // nothing owed is skipped as the round trip it would be for nothing.
+  bool Settle(const SvfProgram::Operation& operation, bool always);
+  bool Check(const Owed& owed);
+
+  bool CableFailed(const SvfProgram::Operation& operation);
+  bool FailAt(size_t line, const std::string& keyword,
+              const std::string& problem);
+
+  IJtagCable& cable_;
+  ILogger* logger_ = nullptr;
+  const SvfProgram& program_;
+  const SvfPlayer::ProgressCallback& progress_;
+  const SvfPlayer::StopCallback& stop_;
+  bool device_attached_ = true;
+
+  // A deque because the cable holds a pointer into each answer until the
+  // next flush, and a deque does not move what it already holds.
+  std::deque<Owed> owed_;
+
+  size_t reported_position_ = 0;
   SvfPlayResult result_;
 };
 
@@ -416,74 +471,64 @@ constexpr size_t kMessageHexDigits = 32;
 // across the whole run, which is smoother than any bar can draw anyway.
 constexpr size_t kProgressStepBytes = size_t{64} << 10;
 
-SvfPlayResult Player::Play(std::string_view text) {
+// How long a run of joined shifts may grow before the next statement starts
+// another. A run is played without a look at the stop callback, and at the
+// USB-Blaster's pace a megabit is about a second.
+constexpr uint64_t kMaximumRunBits = uint64_t{1} << 20;
+
+// How many comparisons may be owed before they are all made, whatever comes
+// next. Each one holds its answer until then, and a file that read back
+// thousands of scans under one instruction would otherwise hold them all.
+constexpr size_t kMaximumOwedCompares = 64;
+
+SvfCompileResult Compiler::Compile(std::string_view text) {
   text_ = text;
   position_ = 0;
   line_ = 1;
-
-  if (logger_ != nullptr) {
-    logger_->Info("Playing a JTAG programming file through the " +
-                  std::string(cable_.Name()) + " cable");
-  }
-
-  // Start from Test-Logic-Reset, reached the way the standard says any state
-  // reaches it: five clocks with TMS high. A file's first statement assumes
-  // a known state and the cable has no idea what the last run left behind.
-  const std::vector<uint8_t> tms(1, 0x1F);
-  const std::vector<uint8_t> tdi(1, 0x00);
-  if (!cable_.Shift(tms, tdi, 5, nullptr)) {
-    Fail("The cable stopped answering.");
-    return result_;
-  }
-  current_ = TapState::kReset;
+  program_.text_bytes = text.size();
 
   Statement statement;
   while (NextStatement(statement)) {
     if (statement.tokens.empty()) {
       break;
     }
-
-    if (stop_ && stop_()) {
-      cable_.Flush();
-      result_.stopped = true;
-      result_.line = statement.line;
-      result_.problem = "Stopped before the end of the file.";
-      return result_;
-    }
-
+    statement_line_ = statement.line;
     if (!Execute(statement)) {
-      cable_.Flush();
-      return result_;
-    }
-    ++result_.statements;
-
-    if (progress_ && position_ - reported_position_ >= kProgressStepBytes) {
-      reported_position_ = position_;
-      progress_(position_, text_.size());
+      return std::move(result_);
     }
+    EndStatement();
   }
 
   if (!result_.problem.empty()) {
-    return result_;
+    return std::move(result_);
   }
 
-  if (!cable_.Flush()) {
-    Fail("The cable stopped answering.");
-    return result_;
-  }
+  // Whatever is still owed is made at the end of the play, which flushes.
+  result_.succeeded = true;
+  result_.program = std::move(program_);
+  return std::move(result_);
+}
 
-  if (progress_) {
-    progress_(text_.size(), text_.size());
+void Compiler::EndStatement() {
+  ++program_.statements;
+  if (program_.operations.empty()) {
+    return;
   }
 
-  result_.succeeded = true;
-  return result_;
+  SvfProgram::Operation& last = program_.operations.back();
+  last.ends_statement = true;
+  last.text_done = position_;
+  last.statements_done = program_.statements;
+
+  if (run_open_ && last.count >= kMaximumRunBits) {
+    run_open_ = false;
+  }
 }
 
 // Reads one statement, stopping at the semicolon that ends it. Returns false
 // at the end of the file and on a malformed one, which are told apart by
 // whether a problem was recorded.
-bool Player::NextStatement(Statement& statement) {
+bool Compiler::NextStatement(Statement& statement) {
   statement.tokens.clear();
   statement.line = line_;
 
@@ -608,7 +653,7 @@ bool Player::NextStatement(Statement& statement) {
   return false;
 }
 
-bool Player::Execute(const Statement& statement) {
+bool Compiler::Execute(const Statement& statement) {
   const std::string& command = statement.tokens.front().text;
 
   // Noted before anything is done with it, so that a failure inside any of
@@ -650,7 +695,7 @@ bool Player::Execute(const Statement& statement) {
                     "\", which this application does not understand.");
 }
 
-bool Player::ParseScanFields(const Statement& statement, size_t first,
+bool Compiler::ParseScanFields(const Statement& statement, size_t first,
                              ScanFields& fields) {
   for (size_t index = first; index < statement.tokens.size(); ++index) {
     const Token& keyword = statement.tokens[index];
@@ -680,7 +725,7 @@ bool Player::ParseScanFields(const Statement& statement, size_t first,
   return true;
 }
 
-bool Player::DoScan(const Statement& statement, bool instruction) {
+bool Compiler::DoScan(const Statement& statement, bool instruction) {
   if (statement.tokens.size() < 2) {
     return FailAt(statement.line, "A scan in the file has no length.");
   }
@@ -736,53 +781,33 @@ bool Player::DoScan(const Statement& statement, bool instruction) {
     return true;
   }
 
-  if (!MoveTo(instruction ? TapState::kIrShift : TapState::kDrShift)) {
-    return false;
+  // An instruction is what moves a device on to doing something else, so
+  // every comparison owed is made before one is loaded. A file checks the
+  // device is the one it was built for and then erases it: the first answer
+  // has to have been heard before the erase is sent.
+  if (instruction) {
+    Resolve();
   }
 
-  const bool compare = fields.tdo.has_value() && device_attached_;
+  MoveTo(instruction ? TapState::kIrShift : TapState::kDrShift);
 
-  std::vector<uint8_t> received;
-  if (!Shift(sticky.tdi, bit_count, compare ? &received : nullptr)) {
-    return false;
-  }
-  current_ = instruction ? TapState::kIrExit1 : TapState::kDrExit1;
+  // A mask with nothing in it compares nothing, and reading back an answer
+  // nobody will look at costs the round trip this arrangement exists to save.
+  // Quartus ends its silicon identifier check with one.
+  const bool compare =
+      fields.tdo.has_value() &&
+      std::any_of(sticky.mask.begin(), sticky.mask.end(),
+                  [](uint8_t byte) { return byte != 0; });
 
-  if (compare) {
-    for (size_t index = 0; index < bit_count; ++index) {
-      if (!BitAt(sticky.mask, index)) {
-        continue;
-      }
-      if (BitAt(received, index) == BitAt(expected, index)) {
-        continue;
-      }
-
-      // The one failure that means the hardware disagreed rather than the
-      // file being wrong, so it is worth every detail it can carry: an
-      // erase that did not take, a device that is not the one the file was
-      // built for, and a cable reading a bit late all land here.
-      //
-      // Both windows cover the same range by construction, so the range is
-      // named once. Without it the two values cannot be lined up against the
-      // bit number, and a report of one of these is unreadable.
-      const HexWindow said =
-          BitsToHexAround(received, bit_count, index, kMessageHexDigits);
-      const HexWindow wanted =
-          BitsToHexAround(expected, bit_count, index, kMessageHexDigits);
-      return FailAt(
-          statement.line,
-          "The device did not answer as the programming file expected at bit " +
-              std::to_string(index) + " of a " + std::to_string(bit_count) +
-              "-bit scan: across bits " + std::to_string(said.highest_bit) +
-              " to " + std::to_string(said.lowest_bit) + " it said " +
-              said.text + " where " + wanted.text + " was expected.");
-    }
-  }
+  Shift(sticky.tdi, bit_count, compare ? &expected : nullptr, sticky.mask,
+        instruction);
+  current_ = instruction ? TapState::kIrExit1 : TapState::kDrExit1;
 
-  return MoveTo(instruction ? end_ir_ : end_dr_);
+  MoveTo(instruction ? end_ir_ : end_dr_);
+  return true;
 }
 
-bool Player::DoRunTest(const Statement& statement) {
+bool Compiler::DoRunTest(const Statement& statement) {
   TapState run_state = TapState::kIdle;
   std::optional<TapState> end_state;
   uint64_t clocks = 0;
@@ -841,17 +866,7 @@ bool Player::DoRunTest(const Statement& statement) {
     index += 2;
   }
 
-  const auto began = std::chrono::steady_clock::now();
-
-  if (!MoveTo(run_state)) {
-    return false;
-  }
-  if (clocks > 0) {
-    if (!cable_.RunClock(static_cast<size_t>(clocks))) {
-      return Fail("The cable stopped answering.");
-    }
-    result_.run_clocks += clocks;
-  }
+  MoveTo(run_state);
 
   // How long this wait is *meant* to take, which is not the same question as
   // how many cycles it is.
@@ -870,31 +885,32 @@ bool Player::DoRunTest(const Statement& statement) {
   // cable is slower than the file declares — which is the ordinary case over
   // USB — this costs nothing at all, because the time has passed already.
   double intended = seconds;
-  if (clocks > 0 && result_.frequency_hz > 0) {
+  if (clocks > 0 && program_.frequency_hz > 0) {
     intended =
-        std::max(intended, static_cast<double>(clocks) / result_.frequency_hz);
+        std::max(intended, static_cast<double>(clocks) / program_.frequency_hz);
+  }
+  if (intended < kShortestEnforcedWaitSeconds) {
+    intended = 0;
   }
 
-  if (device_attached_ && intended >= kShortestEnforcedWaitSeconds) {
-    // Flushed first so that the cycles are on their way before the clock is
-    // read: what has to be true is that the *next* statement does not reach
-    // the device early, and that is what waiting here guarantees.
-    if (!cable_.Flush()) {
-      return Fail("The cable stopped answering.");
-    }
-    const double elapsed =
-        std::chrono::duration<double>(std::chrono::steady_clock::now() - began)
-            .count();
-    if (elapsed < intended) {
-      std::this_thread::sleep_for(
-          std::chrono::duration<double>(intended - elapsed));
+  if (clocks > 0 || intended > 0) {
+    SvfProgram::Operation& wait = Begin(SvfProgram::Kind::kRunClock);
+    wait.count = clocks;
+    wait.hold_seconds = intended;
+    program_.run_clocks += clocks;
+
+    // A held wait flushes, and the player makes every comparison owed when
+    // it does.
+    if (intended > 0) {
+      owed_compares_ = 0;
     }
   }
 
-  return MoveTo(end_state.value_or(run_state));
+  MoveTo(end_state.value_or(run_state));
+  return true;
 }
 
-bool Player::DoState(const Statement& statement) {
+bool Compiler::DoState(const Statement& statement) {
   if (statement.tokens.size() < 2) {
     return FailAt(statement.line, "A state change in the file names no state.");
   }
@@ -906,14 +922,12 @@ bool Player::DoState(const Statement& statement) {
                     "The file names a state that does not exist: " +
                         statement.tokens[index].text + ".");
     }
-    if (!MoveTo(*state)) {
-      return false;
-    }
+    MoveTo(*state);
   }
   return true;
 }
 
-bool Player::DoEndState(const Statement& statement, TapState& end_state) {
+bool Compiler::DoEndState(const Statement& statement, TapState& end_state) {
   if (statement.tokens.size() != 2) {
     return FailAt(statement.line, "An end state in the file is malformed.");
   }
@@ -926,7 +940,7 @@ bool Player::DoEndState(const Statement& statement, TapState& end_state) {
   return true;
 }
 
-bool Player::DoHeaderOrTrailer(const Statement& statement) {
+bool Compiler::DoHeaderOrTrailer(const Statement& statement) {
   if (statement.tokens.size() < 2) {
     return FailAt(statement.line, "A header in the file has no length.");
   }
@@ -948,22 +962,22 @@ bool Player::DoHeaderOrTrailer(const Statement& statement) {
                 "device on it, and this application drives a chain with one.");
 }
 
-bool Player::DoFrequency(const Statement& statement) {
+bool Compiler::DoFrequency(const Statement& statement) {
   if (statement.tokens.size() < 2) {
     // "FREQUENCY;" with nothing after it means "no maximum", which is
     // exactly what a cable with a fixed clock offers anyway.
-    result_.frequency_hz = 0;
+    program_.frequency_hz = 0;
     return true;
   }
   const std::optional<double> hertz = Number(statement.tokens[1]);
   if (!hertz.has_value()) {
     return FailAt(statement.line, "The file's clock rate is malformed.");
   }
-  result_.frequency_hz = *hertz;
+  program_.frequency_hz = *hertz;
   return true;
 }
 
-bool Player::DoTrst(const Statement& statement) {
+bool Compiler::DoTrst(const Statement& statement) {
   if (statement.tokens.size() != 2) {
     return FailAt(statement.line,
                   "A reset line setting in the file is "
@@ -986,57 +1000,131 @@ bool Player::DoTrst(const Statement& statement) {
   return true;
 }
 
-bool Player::MoveTo(TapState target) {
+SvfProgram::Operation& Compiler::Begin(SvfProgram::Kind kind) {
+  // Every operation starts on a byte boundary of the pools, so that the
+  // player can hand a run to the cable as the span it already is.
+  pool_bits_ = BytesForBits(pool_bits_) * 8;
+  run_open_ = false;
+
+  SvfProgram::Operation& operation = program_.operations.emplace_back();
+  operation.kind = kind;
+  operation.first_bit = pool_bits_;
+  operation.first_line = statement_line_;
+  operation.line = statement_line_;
+  operation.keyword = statement_keyword_;
+  return operation;
+}
+
+SvfProgram::Operation& Compiler::Run() {
+  if (!run_open_) {
+    Begin(SvfProgram::Kind::kShift);
+    run_open_ = true;
+  }
+
+  SvfProgram::Operation& run = program_.operations.back();
+  run.ends_statement = false;
+  run.line = statement_line_;
+  run.keyword = statement_keyword_;
+  return run;
+}
+
+void Compiler::MoveTo(TapState target) {
   const std::vector<bool> path = PathBetween(current_, target);
+  current_ = target;
   if (path.empty()) {
-    current_ = target;
-    return true;
+    return;
   }
 
-  std::vector<uint8_t> tms(BytesForBits(path.size()), 0);
-  const std::vector<uint8_t> tdi(BytesForBits(path.size()), 0);
+  SvfProgram::Operation& run = Run();
+  program_.tms.resize(BytesForBits(pool_bits_ + path.size()), 0);
+  program_.tdi.resize(program_.tms.size(), 0);
   for (size_t index = 0; index < path.size(); ++index) {
-    SetBitAt(tms, index, path[index]);
-  }
-
-  if (!cable_.Shift(tms, tdi, path.size(), nullptr)) {
-    return Fail("The cable stopped answering.");
+    if (path[index]) {
+      SetBitAt(program_.tms, pool_bits_ + index, true);
+    }
   }
-  current_ = target;
-  return true;
+  pool_bits_ += path.size();
+  run.count += path.size();
 }
 
 // Shift `bit_count` bits in the current shift state, leaving the TAP in the
 // matching Exit1 state: the last bit is clocked with TMS high, which is how
 // JTAG shifts the final bit and leaves at the same time.
-bool Player::Shift(const std::vector<uint8_t>& tdi, size_t bit_count,
-                   std::vector<uint8_t>* tdo) {
-  std::vector<uint8_t> tms(BytesForBits(bit_count), 0);
-  SetBitAt(tms, bit_count - 1, true);
+//
+// Joined to the run before it unless it is read back, in which case it is a
+// run of its own: the cable is handed exactly the bits whose answer is wanted.
+void Compiler::Shift(const std::vector<uint8_t>& tdi, size_t bit_count,
+                     const std::vector<uint8_t>* expected,
+                     const std::vector<uint8_t>& mask, bool instruction) {
+  SvfProgram::Operation& run =
+      expected != nullptr ? Begin(SvfProgram::Kind::kShift) : Run();
+
+  const uint64_t at = pool_bits_;
+  program_.tms.resize(BytesForBits(at + bit_count), 0);
+  program_.tdi.resize(program_.tms.size(), 0);
+
+  // Whole bytes at a time, spliced across the pool's byte boundaries when the
+  // run does not happen to be aligned. The source is zero beyond its last
+  // bit, so nothing past this scan is disturbed.
+  const size_t offset = at % 8;
+  const size_t first_byte = at / 8;
+  const size_t bytes = BytesForBits(bit_count);
+  for (size_t index = 0; index < bytes; ++index) {
+    const unsigned value = tdi[index];
+    program_.tdi[first_byte + index] |= static_cast<uint8_t>(value << offset);
+    if (offset != 0 && first_byte + index + 1 < program_.tdi.size()) {
+      program_.tdi[first_byte + index + 1] |=
+          static_cast<uint8_t>(value >> (8 - offset));
+    }
+  }
+  SetBitAt(program_.tms, at + bit_count - 1, true);
 
-  if (!cable_.Shift(tms, tdi, bit_count, tdo)) {
-    return Fail("The cable stopped answering.");
+  pool_bits_ += bit_count;
+  run.count += bit_count;
+  run.scan_bits += bit_count;
+  program_.shifted_bits += bit_count;
+
+  if (expected == nullptr) {
+    return;
+  }
+
+  SvfProgram::Compare& compare = program_.compares.emplace_back();
+  compare.first_bit = program_.expected.size() * 8;
+  compare.bit_count = bit_count;
+  compare.line = statement_line_;
+  compare.instruction = instruction;
+  compare.statements_before = program_.statements;
+  program_.expected.insert(program_.expected.end(), expected->begin(),
+                           expected->begin() + static_cast<ptrdiff_t>(bytes));
+  program_.mask.insert(program_.mask.end(), mask.begin(),
+                       mask.begin() + static_cast<ptrdiff_t>(bytes));
+
+  run.compare = static_cast<uint32_t>(program_.compares.size() - 1);
+  run_open_ = false;
+
+  if (++owed_compares_ >= kMaximumOwedCompares) {
+    Resolve();
   }
-  result_.shifted_bits += bit_count;
-  return true;
 }
 
-bool Player::Fail(const std::string& problem) { return FailAt(line_, problem); }
+void Compiler::Resolve() {
+  if (owed_compares_ == 0) {
+    return;
+  }
+  Begin(SvfProgram::Kind::kResolve);
+  owed_compares_ = 0;
+}
 
-bool Player::FailAt(size_t line, const std::string& problem) {
+bool Compiler::FailAt(size_t line, const std::string& problem) {
   if (result_.problem.empty()) {
     result_.problem = problem;
     result_.line = line;
     result_.statement_keyword = statement_keyword_;
-    if (logger_ != nullptr) {
-      logger_->Error("JTAG programming failed at line " + std::to_string(line) +
-                     ": " + problem);
-    }
   }
   return false;
 }
 
-std::optional<double> Player::Number(const Token& token) {
+std::optional<double> Compiler::Number(const Token& token) {
   if (token.bracketed || token.text.empty()) {
     return std::nullopt;
   }
@@ -1048,6 +1136,227 @@ std::optional<double> Player::Number(const Token& token) {
   return value;
 }
 
+SvfPlayResult Replayer::Play() {
+  result_.frequency_hz = program_.frequency_hz;
+
+  if (logger_ != nullptr) {
+    logger_->Info("Playing a JTAG programming file through the " +
+                  std::string(cable_.Name()) + " cable");
+  }
+
+  // Start from Test-Logic-Reset, reached the way the standard says any state
+  // reaches it: five clocks with TMS high. A file's first statement assumes
+  // a known state and the cable has no idea what the last run left behind.
+  // It is not part of the program because it belongs to every play of it.
+  const std::vector<uint8_t> tms(1, 0x1F);
+  const std::vector<uint8_t> tdi(1, 0x00);
+  if (!cable_.Shift(tms, tdi, 5, nullptr)) {
+    FailAt(0, "", "The cable stopped answering.");
+    return result_;
+  }
+
+  bool at_statement_boundary = true;
+  for (const SvfProgram::Operation& operation : program_.operations) {
+    if (at_statement_boundary && stop_ && stop_()) {
+      cable_.Flush();
+      result_.stopped = true;
+      result_.line = operation.first_line;
+      result_.problem = "Stopped before the end of the file.";
+      return result_;
+    }
+
+    bool played = false;
+    switch (operation.kind) {
+      case SvfProgram::Kind::kShift:
+        played = PlayShift(operation);
+        break;
+      case SvfProgram::Kind::kRunClock:
+        played = PlayRunClock(operation);
+        break;
+      case SvfProgram::Kind::kResolve:
+        played = Settle(operation, false);
+        break;
+    }
+    if (!played) {
+      cable_.Flush();
+      return result_;
+    }
+
+    at_statement_boundary = operation.ends_statement;
+    if (!operation.ends_statement) {
+      continue;
+    }
+    result_.statements = operation.statements_done;
+    if (progress_ &&
+        operation.text_done - reported_position_ >= kProgressStepBytes) {
+      reported_position_ = operation.text_done;
+      progress_(operation.text_done, program_.text_bytes);
+    }
+  }
+
+  // Whatever is still owed is made here: the end of the file is as late as
+  // any comparison can be left.
+  if (!program_.operations.empty() &&
+      !Settle(program_.operations.back(), true)) {
+    return result_;
+  }
+  if (program_.operations.empty() && !cable_.Flush()) {
+    FailAt(0, "", "The cable stopped answering.");
+    return result_;
+  }
+  result_.statements = program_.statements;
+
+  if (progress_) {
+    progress_(program_.text_bytes, program_.text_bytes);
+  }
+
+  result_.succeeded = true;
+  return result_;
+}
+
+bool Replayer::PlayShift(const SvfProgram::Operation& operation) {
+  const size_t first_byte = static_cast<size_t>(operation.first_bit / 8);
+  const size_t bytes = BytesForBits(static_cast<size_t>(operation.count));
+  const std::span<const uint8_t> tms(program_.tms.data() + first_byte, bytes);
+  const std::span<const uint8_t> tdi(program_.tdi.data() + first_byte, bytes);
+
+  bool sent = false;
+  if (operation.compare != SvfProgram::kNoCompare && device_attached_) {
+    // Asked for and left with the cable: the answer is looked at when the
+    // program next settles, and until then the scans behind this one go out
+    // without waiting for it.
+    Owed& owed = owed_.emplace_back();
+    owed.compare = &program_.compares[operation.compare];
+    sent = cable_.ShiftDeferred(tms, tdi, static_cast<size_t>(operation.count),
+                                &owed.received);
+  } else {
+    sent = cable_.Shift(tms, tdi, static_cast<size_t>(operation.count),
+                        nullptr);
+  }
+  if (!sent) {
+    return CableFailed(operation);
+  }
+  result_.shifted_bits += operation.scan_bits;
+  return true;
+}
+
+bool Replayer::PlayRunClock(const SvfProgram::Operation& operation) {
+  const auto began = std::chrono::steady_clock::now();
+
+  if (operation.count > 0) {
+    if (!cable_.RunClock(static_cast<size_t>(operation.count))) {
+      return CableFailed(operation);
+    }
+    result_.run_clocks += operation.count;
+  }
+
+  if (!device_attached_ || operation.hold_seconds <= 0) {
+    return true;
+  }
+
+  // Flushed first so that the cycles are on their way before the clock is
+  // read: what has to be true is that the *next* statement does not reach
+  // the device early, and that is what waiting here guarantees. The flush
+  // collects every answer owed as well, so they are checked while it is
+  // already paid for.
+  if (!Settle(operation, true)) {
+    return false;
+  }
+  const double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - began)
+          .count();
+  if (elapsed < operation.hold_seconds) {
+    std::this_thread::sleep_for(
+        std::chrono::duration<double>(operation.hold_seconds - elapsed));
+  }
+  return true;
+}
+
+bool Replayer::Settle(const SvfProgram::Operation& operation, bool always) {
+  if (owed_.empty() && !always) {
+    return true;
+  }
+  if (!cable_.Flush()) {
+    owed_.clear();
+    return CableFailed(operation);
+  }
+
+  // In the order they were asked for, so that the failure reported is the
+  // first scan that disagreed, just as it was when each was checked alone.
+  for (const Owed& owed : owed_) {
+    if (!Check(owed)) {
+      owed_.clear();
+      return false;
+    }
+  }
+  owed_.clear();
+  return true;
+}
+
+bool Replayer::Check(const Owed& owed) {
+  const SvfProgram::Compare& compare = *owed.compare;
+  const size_t bit_count = compare.bit_count;
+  const size_t bytes = BytesForBits(bit_count);
+  const std::span<const uint8_t> expected(
+      program_.expected.data() + compare.first_bit / 8, bytes);
+  const std::span<const uint8_t> mask(
+      program_.mask.data() + compare.first_bit / 8, bytes);
+
+  for (size_t index = 0; index < bit_count; ++index) {
+    if (!BitAt(mask, index)) {
+      continue;
+    }
+    if (BitAt(owed.received, index) == BitAt(expected, index)) {
+      continue;
+    }
+
+    // The one failure that means the hardware disagreed rather than the
+    // file being wrong, so it is worth every detail it can carry: an erase
+    // that did not take, a device that is not the one the file was built
+    // for, and a cable reading a bit late all land here.
+    //
+    // Both windows cover the same range by construction, so the range is
+    // named once. Without it the two values cannot be lined up against the
+    // bit number, and a report of one of these is unreadable.
+    const HexWindow said =
+        BitsToHexAround(owed.received, bit_count, index, kMessageHexDigits);
+    const HexWindow wanted =
+        BitsToHexAround(expected, bit_count, index, kMessageHexDigits);
+
+    // Found late, but reported as itself: the line, the keyword and the
+    // statement count are the scan's, not those of whatever made the
+    // program settle.
+    result_.statements = compare.statements_before;
+    return FailAt(
+        compare.line, compare.instruction ? "SIR" : "SDR",
+        "The device did not answer as the programming file expected at bit " +
+            std::to_string(index) + " of a " + std::to_string(bit_count) +
+            "-bit scan: across bits " + std::to_string(said.highest_bit) +
+            " to " + std::to_string(said.lowest_bit) + " it said " +
+            said.text + " where " + wanted.text + " was expected.");
+  }
+  return true;
+}
+
+bool Replayer::CableFailed(const SvfProgram::Operation& operation) {
+  return FailAt(operation.line, operation.keyword,
+                "The cable stopped answering.");
+}
+
+bool Replayer::FailAt(size_t line, const std::string& keyword,
+                      const std::string& problem) {
+  if (result_.problem.empty()) {
+    result_.problem = problem;
+    result_.line = line;
+    result_.statement_keyword = keyword;
+    if (logger_ != nullptr) {
+      logger_->Error("JTAG programming failed at line " + std::to_string(line) +
+                     ": " + problem);
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 const char* TapStateName(TapState state) {
@@ -1091,9 +1400,43 @@ const char* TapStateName(TapState state) {
 SvfPlayer::SvfPlayer(IJtagCable& cable, ILogger* logger)
     : cable_(cable), logger_(logger) {}
 
+size_t SvfProgram::MemoryBytes() const {
+  return operations.capacity() * sizeof(Operation) +
+         compares.capacity() * sizeof(Compare) + tms.capacity() +
+         tdi.capacity() + expected.capacity() + mask.capacity();
+}
+
+SvfCompileResult CompileSvf(std::string_view text) {
+  return Compiler().Compile(text);
+}
+
 SvfPlayResult SvfPlayer::Play(std::string_view text) {
-  Player player(cable_, logger_, progress_, stop_, device_attached_);
-  return player.Play(text);
+  const SvfCompileResult compiled = CompileSvf(text);
+  if (!compiled.succeeded) {
+    if (logger_ != nullptr) {
+      logger_->Error("JTAG programming failed at line " +
+                     std::to_string(compiled.line) + ": " + compiled.problem);
+    }
+    SvfPlayResult result;
+    result.problem = compiled.problem;
+    result.line = compiled.line;
+    result.statement_keyword = compiled.statement_keyword;
+    return result;
+  }
+  if (logger_ != nullptr) {
+    logger_->Debug("Compiled " + std::to_string(compiled.program.statements) +
+                   " statements into " +
+                   std::to_string(compiled.program.operations.size()) +
+                   " operations, holding " +
+                   std::to_string(compiled.program.MemoryBytes()) + " bytes");
+  }
+  return Play(compiled.program);
+}
+
+SvfPlayResult SvfPlayer::Play(const SvfProgram& program) {
+  return Replayer(cable_, logger_, program, progress_, stop_,
+                  device_attached_)
+      .Play();
 }
 
 }  // namespace ddd::capture
@@ -16,6 +16,7 @@
 #include <functional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace ddd::capture {
 
@@ -66,6 +67,117 @@ enum class TapState {
 // The SVF spelling of a state ("RESET", "DRPAUSE"), for messages.
 const char* TapStateName(TapState state);
 
+// A programming file, compiled: every statement read, every TAP walk worked
+// out and every remembered value filled in, leaving only what the cable has
+// to be told and in what order.
+//
+// Compiled once and played as many times as it is needed — the bring-up plays
+// its configure twice when the first attempt does not take, and nothing about
+// the file has changed in between. Playing it is then a walk down a list with
+// no text in sight, which also means a file that cannot be understood is
+// refused before anything has been sent, rather than half way through.
+//
+// Consecutive shifts that read nothing back are joined into one run, across
+// statement boundaries, so that the cable is handed long runs it can pack into
+// full USB transfers rather than a TAP walk at a time. A run is only ever
+// joined at the end of a statement, so a stop is still between statements,
+// and it is capped so that a stop is still prompt.
+//
+// Scans that are read back stay runs of their own, and their answers are
+// compared later than they are asked for: a batch of reads is collected in
+// one trip to the cable. How much later is the compiler's decision and is
+// never past the next instruction scan, a held-open wait or the end of the
+// file — an instruction is what moves a device on to doing something else,
+// and a comparison that says the device is not the one the file was built for
+// has to be heard before it is told to erase anything.
+//
+// Every run starts on a byte boundary of its pools, so that each one can be
+// handed to IJtagCable as it stands.
+struct SvfProgram {
+  enum class Kind : uint8_t {
+    // Bits [first_bit, first_bit + count) of `tms` and `tdi`.
+    kShift,
+
+    // `count` cycles of RUNTEST, then at least `hold_seconds` of wall time
+    // from when they began.
+    kRunClock,
+
+    // Every comparison still owed is made here, before anything further is
+    // sent.
+    kResolve,
+  };
+
+  static constexpr uint32_t kNoCompare = UINT32_MAX;
+
+  struct Operation {
+    Kind kind = Kind::kShift;
+    uint64_t first_bit = 0;
+    uint64_t count = 0;
+
+    // Of `count`, how many bits were a scan's own rather than a TAP walk,
+    // which is what SvfPlayResult::shifted_bits has always counted.
+    uint64_t scan_bits = 0;
+
+    // For a shift that is read back: its entry in `compares`.
+    uint32_t compare = kNoCompare;
+
+    double hold_seconds = 0;
+
+    // The first and last statements that contributed to this, for messages:
+    // a run stopped before this one stopped at the first, and one that failed
+    // in it failed in the last.
+    size_t first_line = 0;
+    size_t line = 0;
+    std::string keyword;
+
+    // Whether a statement ends with this operation, which is where a run may
+    // be stopped and where progress is reported; and, if so, how much of the
+    // file and how many statements are done once it has been played.
+    bool ends_statement = false;
+    size_t text_done = 0;
+    uint64_t statements_done = 0;
+  };
+
+  // What a read-back scan is expected to say: bits [first_bit, first_bit +
+  // bit_count) of `expected` and `mask`.
+  struct Compare {
+    uint64_t first_bit = 0;
+    uint64_t bit_count = 0;
+    size_t line = 0;
+    bool instruction = false;
+    uint64_t statements_before = 0;
+  };
+
+  std::vector<Operation> operations;
+  std::vector<Compare> compares;
+
+  std::vector<uint8_t> tms;
+  std::vector<uint8_t> tdi;
+  std::vector<uint8_t> expected;
+  std::vector<uint8_t> mask;
+
+  uint64_t statements = 0;
+  uint64_t shifted_bits = 0;
+  uint64_t run_clocks = 0;
+  double frequency_hz = 0;
+  size_t text_bytes = 0;
+
+  // What holding this costs, for the log.
+  size_t MemoryBytes() const;
+};
+
+// What compiling a file produced: a program, or where and why it could not.
+// The fields mean what SvfPlayResult's fields of the same name mean.
+struct SvfCompileResult {
+  bool succeeded = false;
+  SvfProgram program;
+  std::string problem;
+  size_t line = 0;
+  std::string statement_keyword;
+};
+
+SvfCompileResult CompileSvf(std::string_view text);
+
 // What a run did, whether or not it finished.
 struct SvfPlayResult {
   bool succeeded = false;
@@ -137,8 +249,13 @@ class SvfPlayer {
   // — is exactly what a real run does.
   void SetDeviceAttached(bool attached) { device_attached_ = attached; }
 
+  // Compile and play. A file that does not compile is refused with nothing
+  // sent to the cable.
   SvfPlayResult Play(std::string_view text);
 
+  // Play a file compiled earlier.
+  SvfPlayResult Play(const SvfProgram& program);
+
  private:
   IJtagCable& cable_;
   ILogger* logger_ = nullptr;
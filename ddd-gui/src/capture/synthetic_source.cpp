@@ -16,7 +16,9 @@
 #include <cmath>
 #include <thread>
 
+#include "inband_telemetry.h"
 #include "sample_format.h"
+#include "wire_protocol.h"
 
 namespace ddd::capture {
 namespace {
@@ -60,6 +62,14 @@ TransferResult SyntheticSource::Prepare(const DiskBufferRing& /*ring*/) {
   sequence_counter_ = 0;
   samples_until_counter_increment_ = kSamplesPerSequenceCounter;
   sine_phase_samples_ = 0;
+  block_.assign(kPackedBlockBytes, 0);
+  block_cursor_ = kPackedBlockBytes;
+  block_number_ = 0;
+  want_first_block_value_ = false;
+  packet_.assign(InbandTelemetryStripper::kPacketBytes, 0);
+  packet_cursor_ = InbandTelemetryStripper::kPacketBytes;
+  packet_number_ = 0;
+  want_first_packet_value_ = false;
   slots_generated_ = 0;
   slots_delivered_ = 0;
   have_first_delivered_sample_ = false;
@@ -69,29 +79,90 @@ TransferResult SyntheticSource::Prepare(const DiskBufferRing& /*ring*/) {
   return TransferResult::kSuccess;
 }
 
+uint16_t SyntheticSource::NextSampleValue() {
+  if (options_.pattern == Pattern::kRamp) {
+    const uint16_t value = ramp_value_;
+    ++ramp_value_;
+    if (ramp_value_ >= kRampLength) {
+      ramp_value_ = 0;
+    }
+    return value;
+  }
+
+  const double phase =
+      (kTwoPi * static_cast<double>(sine_phase_samples_)) / kSinePeriodSamples;
+  ++sine_phase_samples_;
+  return static_cast<uint16_t>(
+      std::clamp(kSampleZeroOffset +
+                     static_cast<int32_t>(kSineAmplitude * std::sin(phase)),
+                 static_cast<int32_t>(kMinimumSampleValue),
+                 static_cast<int32_t>(kMaximumSampleValue)));
+}
+
 void SyntheticSource::GenerateInto(uint8_t* destination, size_t bytes) {
-  const size_t sample_count = bytes / kBytesPerSample;
+  if (!options_.inband_telemetry) {
+    GenerateStreamInto(destination, bytes);
+    return;
+  }
 
-  for (size_t index = 0; index < sample_count; ++index) {
-    uint16_t value = 0;
-    if (options_.pattern == Pattern::kRamp) {
-      value = ramp_value_;
-      ++ramp_value_;
-      if (ramp_value_ >= kRampLength) {
-        ramp_value_ = 0;
-      }
-    } else {
-      const double phase = (kTwoPi * static_cast<double>(sine_phase_samples_)) /
-                           kSinePeriodSamples;
-      value = static_cast<uint16_t>(
-          std::clamp(kSampleZeroOffset +
-                         static_cast<int32_t>(kSineAmplitude * std::sin(phase)),
-                     static_cast<int32_t>(kMinimumSampleValue),
-                     static_cast<int32_t>(kMaximumSampleValue)));
-      ++sine_phase_samples_;
+  while (bytes > 0) {
+    if (packet_cursor_ == InbandTelemetryStripper::kPacketBytes) {
+      BuildPacket();
     }
+    const size_t take = std::min(
+        bytes, InbandTelemetryStripper::kPacketBytes - packet_cursor_);
+    std::copy_n(packet_.data() + packet_cursor_, take, destination);
+    packet_cursor_ += take;
+    destination += take;
+    bytes -= take;
+  }
+}
+
+void SyntheticSource::BuildPacket() {
+  // The block bufferMonitor.v builds, for a buffer offered every packet at the
+  // threshold and never above it
+  uint16_t words[kInbandBlockWords] = {};
+  words[kInbandWordTag] = kInbandTag;
+  words[kInbandWordFormatFlags] = kInbandFormat;
+  words[kInbandWordPacketNumber] = packet_number_;
+  words[kInbandWordUsed] = static_cast<uint16_t>(kInbandPacketWords);
+  words[kInbandWordPeak] = static_cast<uint16_t>(kInbandPacketWords);
+  words[kInbandWordDropped] = 0;
+  words[kInbandWordDepth] = static_cast<uint16_t>(2 * kInbandPacketWords);
+  for (size_t word = 0; word < kInbandWordCheck; ++word) {
+    words[kInbandWordCheck] =
+        static_cast<uint16_t>(words[kInbandWordCheck] ^ words[word]);
+  }
+  for (size_t word = 0; word < kInbandBlockWords; ++word) {
+    packet_[word * kBytesPerSample] = static_cast<uint8_t>(words[word] & 0xFF);
+    packet_[(word * kBytesPerSample) + 1] =
+        static_cast<uint8_t>(words[word] >> 8);
+  }
+  ++packet_number_;
+
+  uint8_t* stream = packet_.data() + InbandTelemetryStripper::kBlockBytes;
+  GenerateStreamInto(stream, InbandTelemetryStripper::kPacketDataBytes);
+
+  if (want_first_packet_value_) {
+    first_delivered_sample_value_ = SampleValueFromWord(static_cast<uint16_t>(
+        static_cast<uint16_t>(stream[0]) |
+        static_cast<uint16_t>(static_cast<uint16_t>(stream[1]) << 8)));
+    want_first_packet_value_ = false;
+  }
+
+  packet_cursor_ = 0;
+}
+
+void SyntheticSource::GenerateStreamInto(uint8_t* destination, size_t bytes) {
+  if (options_.wire_format == WireFormat::kPacked) {
+    GeneratePackedInto(destination, bytes);
+    return;
+  }
 
-    const uint16_t word = MakeWireWord(value, sequence_counter_);
+  const size_t sample_count = bytes / kBytesPerSample;
+
+  for (size_t index = 0; index < sample_count; ++index) {
+    const uint16_t word = MakeWireWord(NextSampleValue(), sequence_counter_);
     destination[index * kBytesPerSample] = static_cast<uint8_t>(word & 0xFF);
     destination[(index * kBytesPerSample) + 1] =
         static_cast<uint8_t>((word >> 8) & 0xFF);
@@ -107,6 +178,47 @@ void SyntheticSource::GenerateInto(uint8_t* destination, size_t bytes) {
   }
 }
 
+void SyntheticSource::GeneratePackedInto(uint8_t* destination, size_t bytes) {
+  while (bytes > 0) {
+    if (block_cursor_ == kPackedBlockBytes) {
+      BuildBlock();
+    }
+    const size_t take = std::min(bytes, kPackedBlockBytes - block_cursor_);
+    std::copy_n(block_.data() + block_cursor_, take, destination);
+    block_cursor_ += take;
+    destination += take;
+    bytes -= take;
+  }
+}
+
+void SyntheticSource::BuildBlock() {
+  block_[0] = static_cast<uint8_t>(block_number_ & 0xFF);
+  block_[1] = static_cast<uint8_t>(block_number_ >> 8);
+  ++block_number_;
+
+  // Written the way the gateware's shift register produces it, a group of four
+  // at a time, rather than by calling the unpacker's inverse: a source that
+  // shared the unpacker's idea of the format could not catch it being wrong.
+  uint8_t* payload = block_.data() + kPackedHeaderBytes;
+  for (size_t group = 0; group < kPackedGroupsPerBlock; ++group) {
+    uint64_t bits = 0;
+    for (size_t sample = 0; sample < kPackedGroupSamples; ++sample) {
+      const uint16_t value = NextSampleValue();
+      if (want_first_block_value_) {
+        first_delivered_sample_value_ = value;
+        want_first_block_value_ = false;
+      }
+      bits |= static_cast<uint64_t>(value & kSampleValueMask) << (10 * sample);
+    }
+    for (size_t byte = 0; byte < kPackedGroupBytes; ++byte) {
+      payload[(group * kPackedGroupBytes) + byte] =
+          static_cast<uint8_t>((bits >> (8 * byte)) & 0xFF);
+    }
+  }
+
+  block_cursor_ = 0;
+}
+
 void SyntheticSource::PaceForBytes(uint64_t bytes_generated) {
   if (options_.rate_bytes_per_second == 0) {
     return;
@@ -185,6 +297,13 @@ TransferResult SyntheticSource::Run(DiskBufferRing& ring,
                                      : TransferResult::kForcedAbort;
     }
 
+    if (faulting && options_.fault == Fault::kPacketLoss) {
+      // Applied before the slot is generated, so that the first packet built
+      // for it carries a number one further on than the stripper expects
+      control.Log("Synthetic source: injecting a lost packet");
+      ++packet_number_;
+    }
+
     if (faulting && options_.fault == Fault::kTransferFailure) {
       control.Log("Synthetic source: injecting a transfer failure");
       return TransferResult::kUsbTransferFailure;
@@ -203,6 +322,14 @@ TransferResult SyntheticSource::Run(DiskBufferRing& ring,
       bytes_to_generate = (slot_bytes / 2) & ~static_cast<size_t>(1);
     }
 
+    if (!discarding && !have_first_delivered_sample_) {
+      if (options_.wire_format == WireFormat::kPacked) {
+        want_first_block_value_ = true;
+      } else if (options_.inband_telemetry) {
+        want_first_packet_value_ = true;
+      }
+    }
+
     GenerateInto(ring.SlotData(slot_index), bytes_to_generate);
 
     if (faulting && options_.fault == Fault::kRampBreak) {
@@ -220,10 +347,18 @@ TransferResult SyntheticSource::Run(DiskBufferRing& ring,
       // expecting. Corrupting this slot's bytes would be caught too, but this
       // way the break falls at a slot boundary, which is the harder case and
       // the one a genuine dropped transfer produces.
+      //
+      // Packed, the block number is the marker, and skipping one is the same
+      // fault. It lands on the slot boundary too whenever a slot is a whole
+      // number of blocks, as the standard 2 MB slot is.
       control.Log("Synthetic source: injecting a sequence break");
-      ++sequence_counter_;
-      if (sequence_counter_ >= kSequenceCounterValues) {
-        sequence_counter_ = 0;
+      if (options_.wire_format == WireFormat::kPacked) {
+        ++block_number_;
+      } else {
+        ++sequence_counter_;
+        if (sequence_counter_ >= kSequenceCounterValues) {
+          sequence_counter_ = 0;
+        }
       }
     }
 
@@ -236,7 +371,12 @@ TransferResult SyntheticSource::Run(DiskBufferRing& ring,
       continue;
     }
 
-    if (!have_first_delivered_sample_) {
+    if (!have_first_delivered_sample_ &&
+        (options_.wire_format == WireFormat::kPacked ||
+         options_.inband_telemetry)) {
+      // Recorded as the block or the packet was built
+      have_first_delivered_sample_ = true;
+    } else if (!have_first_delivered_sample_) {
       const uint8_t* data = ring.SlotData(slot_index);
       const uint16_t word = static_cast<uint16_t>(
           static_cast<uint16_t>(data[0]) |
@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 
+#include "sample_format.h"
 #include "sample_source.h"
 
 namespace ddd::capture {
@@ -84,6 +85,12 @@ class SyntheticSource : public ISampleSource {
 
     // Report a transfer failure, as a USB backend would on a lost device.
     kTransferFailure,
+
+    // Skip an in-band packet number, which is what a packet lost between the
+    // device and the ring looks like to the stripper. Only meaningful with
+    // inband_telemetry on, and caught by the packet numbers whatever the wire
+    // format.
+    kPacketLoss,
   };
 
   struct Options {
@@ -123,6 +130,17 @@ class SyntheticSource : public ISampleSource {
     // and the swap logic does not care how big the buffers are.
     size_t slot_size_bytes = 0;
     size_t slot_count = 0;
+
+    // How the stream is laid out, as the device would be asked for it. Packed
+    // generates whole blocks and carries a part-sent one across slots, exactly
+    // as the gateware's stream crosses transfers; kSequenceBreak then skips a
+    // block number rather than a counter value.
+    WireFormat wire_format = WireFormat::kWords;
+
+    // Open every 16 KiB packet with an in-band telemetry block, as the device
+    // does when asked to. The block reports a buffer that is never squeezed:
+    // what is under test is the framing, not the figures.
+    bool inband_telemetry = false;
   };
 
   // The ramp length the current gateware produces. 1021, not 1024: the test
@@ -146,6 +164,12 @@ class SyntheticSource : public ISampleSource {
   // The first sample value of the first slot handed over. A consumer that knows
   // this can predict every sample that should follow, which is how the sink
   // swap is checked for lost or duplicated samples.
+  //
+  // Packed, it is the first sample of the first block that starts in that
+  // slot, which is where an unpacker joining the stream there locks on. With
+  // in-band telemetry in the word format, it is the first sample behind the
+  // first block; both assume slots that are a whole number of packets, as
+  // every slot the ring plans is.
   uint16_t FirstDeliveredSampleValue() const {
     return first_delivered_sample_value_;
   }
@@ -170,6 +194,17 @@ class SyntheticSource : public ISampleSource {
  private:
   // Fill `bytes` of a slot with the next stretch of the stream.
   void GenerateInto(uint8_t* destination, size_t bytes);
+  void GenerateStreamInto(uint8_t* destination, size_t bytes);
+  void GeneratePackedInto(uint8_t* destination, size_t bytes);
+
+  // The next sample of the pattern, advancing it.
+  uint16_t NextSampleValue();
+
+  // Generate the next packed block into block_.
+  void BuildBlock();
+
+  // Generate the next in-band packet, block and stream, into packet_.
+  void BuildPacket();
 
   // Hold back until the configured rate allows the next slot.
   void PaceForBytes(uint64_t bytes_generated);
@@ -182,6 +217,22 @@ class SyntheticSource : public ISampleSource {
   uint32_t samples_until_counter_increment_ = 0;
   uint64_t sine_phase_samples_ = 0;
 
+  // The packed block being sent, how much of it has gone, and the number the
+  // next one will carry
+  std::vector<uint8_t> block_;
+  size_t block_cursor_ = 0;
+  uint16_t block_number_ = 0;
+
+  // Set while the first slot to be handed over is generated, so that the
+  // first block starting in it records its opening sample
+  bool want_first_block_value_ = false;
+
+  // The in-band packet being sent, on the same terms as the block above
+  std::vector<uint8_t> packet_;
+  size_t packet_cursor_ = 0;
+  uint16_t packet_number_ = 0;
+  bool want_first_packet_value_ = false;
+
   uint64_t slots_generated_ = 0;
   std::atomic<uint64_t> slots_delivered_{0};
   uint16_t first_delivered_sample_value_ = 0;
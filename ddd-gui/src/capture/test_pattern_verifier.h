@@ -51,6 +51,11 @@ class TestPatternVerifier {
   // Feed the next block of 10-bit sample values. Returns false once the ramp
   // has broken; further calls are ignored, so a caller can stop at its own
   // convenience.
+  //
+  // Checked a run at a time against a table of the ramp rather than a sample
+  // at a time against a counter, and walked sample by sample only through a
+  // run that is already known to hold a break. The result is the same either
+  // way, down to the offset of the break; only the speed differs.
   bool Feed(const uint16_t* samples, size_t count);
 
   // Feed a block still in the device's wire layout — 16-bit little-endian words
@@ -70,6 +75,14 @@ class TestPatternVerifier {
   // Advance the state machine by one sample. Returns false on a break.
   bool FeedOne(uint16_t sample_value);
 
+  // Where in the ramp the next sample is expected, as an index into it.
+  // Seeded state only.
+  size_t NextPhase() const;
+
+  // Account for a run of samples found to match the ramp from `phase` on, as
+  // if each had been through FeedOne.
+  void AcceptRun(size_t phase, size_t count);
+
   Result result_;
   bool have_first_sample_ = false;
   uint16_t current_value_ = 0;
@@ -0,0 +1,526 @@
+/************************************************************************
+
+    thread_usage.cpp
+
+    What the capture threads actually got from the scheduler
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "thread_usage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+#include "log_format.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace ddd::capture {
+namespace {
+
+uint64_t CounterSince(uint64_t now, uint64_t earlier) {
+  return now > earlier ? now - earlier : 0;
+}
+
+double SecondsSince(double now, double earlier) {
+  return now > earlier ? now - earlier : 0.0;
+}
+
+// The whole of a small file, or nothing. /proc files report a size of zero, so
+// this reads to the end rather than asking how long it is.
+std::optional<std::string> ReadSmallFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    return std::nullopt;
+  }
+  return text;
+}
+
+// The value after "key:" on a line of its own, as /proc/<pid>/status and
+// /proc/<pid>/sched lay them out — the first with a tab, the second with a run
+// of spaces either side of the colon.
+std::optional<uint64_t> FindKeyedCounter(const std::string& text,
+                                         const std::string& key) {
+  std::istringstream lines(text);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.compare(0, key.size(), key) != 0) {
+      continue;
+    }
+    const size_t colon = line.find(':', key.size());
+    if (colon == std::string::npos) {
+      continue;
+    }
+
+    // Only whitespace between the key and the colon, so that a key that is a
+    // prefix of another — there are several in sched — does not match it.
+    if (line.find_first_not_of(" \t", key.size()) != colon) {
+      continue;
+    }
+
+    const char* const start = line.c_str() + colon + 1;
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(start, &end, 10);
+    if (end == start) {
+      return std::nullopt;
+    }
+    return static_cast<uint64_t>(value);
+  }
+  return std::nullopt;
+}
+
+double ClockTicksPerSecond() {
+#ifdef __linux__
+  const long ticks = sysconf(_SC_CLK_TCK);
+  return ticks > 0 ? static_cast<double>(ticks) : 100.0;
+#else
+  return 100.0;
+#endif
+}
+
+}  // namespace
+
+void ThreadUsage::Add(const ThreadUsage& other) {
+  if (!other.present) {
+    return;
+  }
+
+  // Migrations are known for the sum only if they were known for every part
+  // of it; a total missing one thread's count is not a total.
+  migrations_known = present ? (migrations_known && other.migrations_known)
+                             : other.migrations_known;
+  present = true;
+  threads += other.threads;
+  user_seconds += other.user_seconds;
+  system_seconds += other.system_seconds;
+  voluntary_switches += other.voluntary_switches;
+  involuntary_switches += other.involuntary_switches;
+  minor_faults += other.minor_faults;
+  major_faults += other.major_faults;
+  migrations += other.migrations;
+}
+
+ThreadUsage ThreadUsage::Since(const ThreadUsage& earlier) const {
+  if (!present) {
+    return {};
+  }
+  if (!earlier.present) {
+    return *this;
+  }
+
+  ThreadUsage difference;
+  difference.present = true;
+
+  // The threads that joined since the earlier reading where any did — a new
+  // file's encoder — and otherwise the same threads as before.
+  difference.threads =
+      threads > earlier.threads ? threads - earlier.threads : threads;
+  difference.user_seconds = SecondsSince(user_seconds, earlier.user_seconds);
+  difference.system_seconds =
+      SecondsSince(system_seconds, earlier.system_seconds);
+  difference.voluntary_switches =
+      CounterSince(voluntary_switches, earlier.voluntary_switches);
+  difference.involuntary_switches =
+      CounterSince(involuntary_switches, earlier.involuntary_switches);
+  difference.minor_faults = CounterSince(minor_faults, earlier.minor_faults);
+  difference.major_faults = CounterSince(major_faults, earlier.major_faults);
+  difference.migrations_known =
+      migrations_known && earlier.migrations_known;
+  difference.migrations =
+      difference.migrations_known
+          ? CounterSince(migrations, earlier.migrations)
+          : 0;
+  return difference;
+}
+
+std::string ThreadUsage::Describe() const {
+  if (!present) {
+    return "not measured";
+  }
+
+  std::string text =
+      FormatDecimal(CpuSeconds(), 2) + " s CPU (" +
+      FormatDecimal(user_seconds, 2) + " user, " +
+      FormatDecimal(system_seconds, 2) + " system), " +
+      std::to_string(involuntary_switches) + " involuntary and " +
+      std::to_string(voluntary_switches) + " voluntary switches, ";
+  if (migrations_known) {
+    text += std::to_string(migrations) + " migrations, ";
+  }
+  text += std::to_string(major_faults) + " major and " +
+          std::to_string(minor_faults) + " minor faults";
+  if (threads > 1) {
+    text += " over " + std::to_string(threads) + " threads";
+  }
+  return text;
+}
+
+CaptureThreadUsage CaptureThreadUsage::Since(
+    const CaptureThreadUsage& earlier) const {
+  CaptureThreadUsage difference;
+  difference.transfer = transfer.Since(earlier.transfer);
+  difference.processing = processing.Since(earlier.processing);
+  difference.encoder = encoder.Since(earlier.encoder);
+  return difference;
+}
+
+uint64_t CurrentNativeThreadId() {
+#if defined(_WIN32)
+  return static_cast<uint64_t>(GetCurrentThreadId());
+#elif defined(__linux__)
+  return static_cast<uint64_t>(syscall(SYS_gettid));
+#else
+  uint64_t thread_id = 0;
+  pthread_threadid_np(nullptr, &thread_id);
+  return thread_id;
+#endif
+}
+
+std::optional<std::vector<uint64_t>> ListProcessThreadIds(
+    const std::filesystem::path& task_root) {
+  std::error_code error;
+  std::filesystem::directory_iterator entries(task_root, error);
+  if (error) {
+    return std::nullopt;
+  }
+
+  std::vector<uint64_t> thread_ids;
+  for (const std::filesystem::directory_entry& entry : entries) {
+    const std::string name = entry.path().filename().string();
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(name.c_str(), &end, 10);
+    if (end == name.c_str() || *end != '\0') {
+      continue;
+    }
+    thread_ids.push_back(static_cast<uint64_t>(value));
+  }
+
+  std::sort(thread_ids.begin(), thread_ids.end());
+  return thread_ids;
+}
+
+std::optional<std::string> ReadThreadName(
+    uint64_t thread_id, const std::filesystem::path& task_root) {
+  std::optional<std::string> name =
+      ReadSmallFile(task_root / std::to_string(thread_id) / "comm");
+  if (name && !name->empty() && name->back() == '\n') {
+    name->pop_back();
+  }
+  return name;
+}
+
+std::optional<std::string> RenameCurrentThread(const std::string& name) {
+#ifdef __linux__
+  // The kernel keeps sixteen bytes, the terminator included, and cuts a
+  // longer name short rather than refusing it.
+  char previous[16] = {};
+  if (prctl(PR_GET_NAME, previous, 0, 0, 0) != 0 ||
+      prctl(PR_SET_NAME, name.c_str(), 0, 0, 0) != 0) {
+    return std::nullopt;
+  }
+  return std::string(previous);
+#else
+  static_cast<void>(name);
+  return std::nullopt;
+#endif
+}
+
+bool ParseTaskStat(const std::string& text, ThreadUsage& usage) {
+  // The second field is the thread's name in parentheses, and a name may hold
+  // spaces and parentheses of its own. The last ')' is the only reliable end of
+  // it; everything after that is space-separated numbers.
+  const size_t name_end = text.rfind(')');
+  if (name_end == std::string::npos) {
+    return false;
+  }
+
+  std::istringstream fields(text.substr(name_end + 1));
+  std::vector<std::string> values{std::istream_iterator<std::string>(fields),
+                                  std::istream_iterator<std::string>()};
+
+  // Numbered from the state field, which proc(5) calls field 3: minflt is 10,
+  // majflt 12, utime 14 and stime 15.
+  constexpr size_t kFirstField = 3;
+  constexpr size_t kMinorFaults = 10 - kFirstField;
+  constexpr size_t kMajorFaults = 12 - kFirstField;
+  constexpr size_t kUserTicks = 14 - kFirstField;
+  constexpr size_t kSystemTicks = 15 - kFirstField;
+
+  if (values.size() <= kSystemTicks) {
+    return false;
+  }
+
+  const double ticks = ClockTicksPerSecond();
+  usage.minor_faults = std::strtoull(values[kMinorFaults].c_str(), nullptr, 10);
+  usage.major_faults = std::strtoull(values[kMajorFaults].c_str(), nullptr, 10);
+  usage.user_seconds =
+      static_cast<double>(
+          std::strtoull(values[kUserTicks].c_str(), nullptr, 10)) /
+      ticks;
+  usage.system_seconds =
+      static_cast<double>(
+          std::strtoull(values[kSystemTicks].c_str(), nullptr, 10)) /
+      ticks;
+  return true;
+}
+
+bool ParseTaskStatus(const std::string& text, ThreadUsage& usage) {
+  const std::optional<uint64_t> voluntary =
+      FindKeyedCounter(text, "voluntary_ctxt_switches");
+  const std::optional<uint64_t> involuntary =
+      FindKeyedCounter(text, "nonvoluntary_ctxt_switches");
+  if (!voluntary || !involuntary) {
+    return false;
+  }
+  usage.voluntary_switches = *voluntary;
+  usage.involuntary_switches = *involuntary;
+  return true;
+}
+
+bool ParseTaskSched(const std::string& text, ThreadUsage& usage) {
+  const std::optional<uint64_t> migrations =
+      FindKeyedCounter(text, "se.nr_migrations");
+  if (!migrations) {
+    return false;
+  }
+  usage.migrations_known = true;
+  usage.migrations = *migrations;
+  return true;
+}
+
+ThreadUsage ReadThreadUsage(uint64_t thread_id,
+                            const std::filesystem::path& task_root) {
+  const std::filesystem::path directory =
+      task_root / std::to_string(thread_id);
+
+  const std::optional<std::string> stat = ReadSmallFile(directory / "stat");
+  const std::optional<std::string> status =
+      ReadSmallFile(directory / "status");
+  if (!stat || !status) {
+    return {};
+  }
+
+  ThreadUsage usage;
+  if (!ParseTaskStat(*stat, usage) || !ParseTaskStatus(*status, usage)) {
+    return {};
+  }
+
+  // Optional, and its absence is recorded rather than guessed at — see
+  // ThreadUsage::migrations_known.
+  if (const std::optional<std::string> sched =
+          ReadSmallFile(directory / "sched")) {
+    ParseTaskSched(*sched, usage);
+  }
+
+  usage.present = true;
+  usage.threads = 1;
+  return usage;
+}
+
+ThreadUsage ReadCurrentThreadUsage() {
+#ifdef __linux__
+  rusage counters{};
+  if (getrusage(RUSAGE_THREAD, &counters) != 0) {
+    return {};
+  }
+
+  ThreadUsage usage;
+  usage.present = true;
+  usage.threads = 1;
+  usage.user_seconds = static_cast<double>(counters.ru_utime.tv_sec) +
+                       static_cast<double>(counters.ru_utime.tv_usec) / 1.0e6;
+  usage.system_seconds = static_cast<double>(counters.ru_stime.tv_sec) +
+                         static_cast<double>(counters.ru_stime.tv_usec) / 1.0e6;
+  usage.voluntary_switches = static_cast<uint64_t>(counters.ru_nvcsw);
+  usage.involuntary_switches = static_cast<uint64_t>(counters.ru_nivcsw);
+  usage.minor_faults = static_cast<uint64_t>(counters.ru_minflt);
+  usage.major_faults = static_cast<uint64_t>(counters.ru_majflt);
+
+  // getrusage has no migration count, so that one still comes out of /proc.
+  if (const std::optional<std::string> sched =
+          ReadSmallFile(std::filesystem::path("/proc/thread-self/sched"))) {
+    ParseTaskSched(*sched, usage);
+  }
+  return usage;
+#else
+  return {};
+#endif
+}
+
+ThreadAccounting::ThreadAccounting() { threads_.reserve(kReservedThreads); }
+
+void ThreadAccounting::Reset() {
+  const std::lock_guard<std::mutex> guard(mutex_);
+  threads_.clear();
+  retired_ = CaptureThreadUsage{};
+}
+
+void ThreadAccounting::RegisterCurrentThread(Role role) {
+  Tracked tracked;
+  tracked.thread_id = CurrentNativeThreadId();
+  tracked.role = role;
+  tracked.baseline = ReadCurrentThreadUsage();
+  tracked.latest = tracked.baseline;
+
+  const std::lock_guard<std::mutex> guard(mutex_);
+  threads_.push_back(tracked);
+}
+
+void ThreadAccounting::RegisterThreads(
+    Role role, const std::vector<uint64_t>& thread_ids) {
+  const std::lock_guard<std::mutex> guard(mutex_);
+  for (const uint64_t thread_id : thread_ids) {
+    Tracked tracked;
+    tracked.thread_id = thread_id;
+    tracked.role = role;
+
+    // A zero baseline that is present, so that Since() charges the thread with
+    // everything it has done — which, for a thread started a moment ago for
+    // this purpose, is the right answer.
+    tracked.baseline.present = true;
+    tracked.baseline.threads = 1;
+    tracked.baseline.migrations_known = true;
+    threads_.push_back(tracked);
+  }
+}
+
+void ThreadAccounting::RetireCurrentThread() {
+  const uint64_t thread_id = CurrentNativeThreadId();
+  const ThreadUsage final_reading = ReadCurrentThreadUsage();
+
+  const std::lock_guard<std::mutex> guard(mutex_);
+  for (size_t index = 0; index < threads_.size(); ++index) {
+    if (threads_[index].thread_id == thread_id) {
+      RetireLocked(index, final_reading);
+      return;
+    }
+  }
+}
+
+void ThreadAccounting::RetireThreads(const std::vector<uint64_t>& thread_ids) {
+  // Read first and lock after, so that the control thread's next sample is
+  // not held up behind these reads, nor these behind it.
+  std::vector<ThreadUsage> final_readings;
+  final_readings.reserve(thread_ids.size());
+  for (const uint64_t thread_id : thread_ids) {
+    final_readings.push_back(ReadThreadUsage(thread_id));
+  }
+
+  const std::lock_guard<std::mutex> guard(mutex_);
+  for (size_t retiring = 0; retiring < thread_ids.size(); ++retiring) {
+    for (size_t index = 0; index < threads_.size(); ++index) {
+      if (threads_[index].thread_id == thread_ids[retiring]) {
+        RetireLocked(index, final_readings[retiring]);
+        break;
+      }
+    }
+  }
+}
+
+void ThreadAccounting::Sample() {
+  std::vector<uint64_t> thread_ids;
+  {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    thread_ids.reserve(threads_.size());
+    for (const Tracked& tracked : threads_) {
+      thread_ids.push_back(tracked.thread_id);
+    }
+  }
+
+  std::vector<ThreadUsage> readings;
+  readings.reserve(thread_ids.size());
+  for (const uint64_t thread_id : thread_ids) {
+    readings.push_back(ReadThreadUsage(thread_id));
+  }
+
+  // Matched by id rather than by position: a thread retired while the reads
+  // were under way has gone from the list, and its final reading stands.
+  const std::lock_guard<std::mutex> guard(mutex_);
+  for (size_t read = 0; read < thread_ids.size(); ++read) {
+    for (size_t index = 0; index < threads_.size(); ++index) {
+      if (threads_[index].thread_id != thread_ids[read]) {
+        continue;
+      }
+
+      // A thread whose /proc entry has gone has exited without retiring,
+      // which an encoder thread does if its sink is dropped rather than
+      // finished. Its last reading stands.
+      if (readings[read].present) {
+        threads_[index].latest = readings[read];
+      } else {
+        RetireLocked(index, ThreadUsage{});
+      }
+      break;
+    }
+  }
+}
+
+void ThreadAccounting::RetireLocked(size_t index,
+                                    const ThreadUsage& final_reading) {
+  Tracked& tracked = threads_[index];
+  if (final_reading.present) {
+    tracked.latest = final_reading;
+  }
+
+  const ThreadUsage used = tracked.latest.Since(tracked.baseline);
+  switch (tracked.role) {
+    case Role::kTransfer:
+      retired_.transfer.Add(used);
+      break;
+    case Role::kProcessing:
+      retired_.processing.Add(used);
+      break;
+    case Role::kEncoder:
+      retired_.encoder.Add(used);
+      break;
+  }
+
+  // Order does not matter here, so the last entry takes the place of the one
+  // that went rather than everything after it moving down.
+  threads_[index] = threads_.back();
+  threads_.pop_back();
+}
+
+CaptureThreadUsage ThreadAccounting::Totals() const {
+  const std::lock_guard<std::mutex> guard(mutex_);
+  CaptureThreadUsage totals = retired_;
+  for (const Tracked& tracked : threads_) {
+    const ThreadUsage used = tracked.latest.Since(tracked.baseline);
+    switch (tracked.role) {
+      case Role::kTransfer:
+        totals.transfer.Add(used);
+        break;
+      case Role::kProcessing:
+        totals.processing.Add(used);
+        break;
+      case Role::kEncoder:
+        totals.encoder.Add(used);
+        break;
+    }
+  }
+  return totals;
+}
+
+}  // namespace ddd::capture
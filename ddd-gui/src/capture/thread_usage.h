@@ -0,0 +1,232 @@
+/************************************************************************
+
+    thread_usage.h
+
+    What the capture threads actually got from the scheduler
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ddd::capture {
+
+// ScopedThreadPriority asks for the CPU and LockIntoMemory asks for the pages.
+// Neither says whether the asking worked, and on a machine that is losing
+// samples that is the only question worth answering: a thread that was
+// preempted two thousand times in a run was not running at the priority its
+// log line claims, and a major fault on the transfer thread is a disk read in
+// the middle of a deadline the ring was supposed to have made impossible.
+//
+// So the pipeline measures. Per thread, from the kernel's own accounting: CPU
+// time, the two kinds of context switch, the two kinds of page fault, and how
+// often the thread was moved between cores. Voluntary switches are a thread
+// waiting for work and are healthy; involuntary ones are the scheduler taking
+// the CPU away, and on an elevated thread every one of them is something the
+// elevation failed to prevent.
+//
+// Linux only. /proc/self/task has all of it, readable from any thread in the
+// process, and getrusage(RUSAGE_THREAD) has most of it for the calling thread.
+// Windows and macOS have thread CPU times and little else, and a figure that
+// exists on one platform and is zero on the others would read as a clean run
+// rather than as an unasked question — so there, every reading is absent
+// rather than empty, which is the same distinction FpgaTelemetry draws.
+
+// One thread's counters, or a sum of several threads'.
+struct ThreadUsage {
+  // False when nothing was read: a platform without the accounting, or a
+  // thread nobody has registered.
+  bool present = false;
+
+  // How many threads are summed into this. The encoder role is however many
+  // threads libFLAC started, and a total over eight threads means something
+  // different from the same total over one.
+  uint32_t threads = 0;
+
+  double user_seconds = 0.0;
+  double system_seconds = 0.0;
+
+  uint64_t voluntary_switches = 0;
+  uint64_t involuntary_switches = 0;
+
+  uint64_t minor_faults = 0;
+  uint64_t major_faults = 0;
+
+  // Only where the kernel keeps the count: it is in the scheduler's debug
+  // statistics, which most distribution kernels build and some do not. False
+  // means migrations is not a measurement, not that it is zero.
+  bool migrations_known = false;
+  uint64_t migrations = 0;
+
+  double CpuSeconds() const { return user_seconds + system_seconds; }
+
+  // Adds another reading in, for the roles that are more than one thread.
+  void Add(const ThreadUsage& other);
+
+  // What happened between an earlier reading and this one. Counters that went
+  // backwards — a thread that has gone and been replaced by one with fewer —
+  // are taken as zero rather than wrapped.
+  ThreadUsage Since(const ThreadUsage& earlier) const;
+
+  // One line for a log — "0.82 s CPU (0.70 user, 0.12 system), 14 involuntary
+  // and 3106 voluntary switches, 6 migrations, 0 major and 7 minor faults over
+  // 8 threads", without the migrations where they are not known and the
+  // thread count for one thread — or "not measured".
+  std::string Describe() const;
+};
+
+// The three kinds of thread a capture runs on, summed by role.
+struct CaptureThreadUsage {
+  ThreadUsage transfer;
+  ThreadUsage processing;
+
+  // libFLAC's worker threads, across every file the session has written. Empty
+  // while monitoring and for a raw capture, which encode nothing.
+  ThreadUsage encoder;
+
+  bool present() const {
+    return transfer.present || processing.present || encoder.present;
+  }
+
+  CaptureThreadUsage Since(const CaptureThreadUsage& earlier) const;
+};
+
+// The kernel's own identifier for the calling thread — the tid on Linux, the
+// thread ID on Windows. Not std::thread::id, which is opaque and means nothing
+// to /proc.
+uint64_t CurrentNativeThreadId();
+
+// Every thread in this process, or nothing where that cannot be asked.
+//
+// Half of the way libFLAC's encoder threads are found: it starts them itself
+// and exposes none of them, so the only handle on them is the set of threads
+// that exist after an encoder starts and did not before. The other half is
+// their name — see RenameCurrentThread.
+std::optional<std::vector<uint64_t>> ListProcessThreadIds(
+    const std::filesystem::path& task_root = "/proc/self/task");
+
+// A thread's name as the kernel holds it, or nothing when the thread has gone
+// or the platform has no /proc.
+std::optional<std::string> ReadThreadName(
+    uint64_t thread_id,
+    const std::filesystem::path& task_root = "/proc/self/task");
+
+// Rename the calling thread, returning the name it had so that the caller can
+// put it back. Nothing, and no change, where the platform cannot.
+//
+// A new thread starts with the name of the thread that created it, so a
+// thread that takes a name nothing else in the process has while it starts
+// threads through a library can tell those threads from any other thread
+// started in the same moment.
+std::optional<std::string> RenameCurrentThread(const std::string& name);
+
+// One thread's counters out of /proc, for any thread in the process. Absent
+// when the thread has gone or the platform has no /proc.
+ThreadUsage ReadThreadUsage(
+    uint64_t thread_id,
+    const std::filesystem::path& task_root = "/proc/self/task");
+
+// The calling thread's counters, through getrusage(RUSAGE_THREAD).
+//
+// What a thread reads about itself on the way out: once it has returned its
+// /proc entry has gone, and whatever it did between the last sample and its
+// exit would otherwise never be counted.
+ThreadUsage ReadCurrentThreadUsage();
+
+// The parsers behind ReadThreadUsage, exposed so the tests can hand them the
+// kernel's text without a kernel. Each fills what its file carries and leaves
+// the rest alone; false means the text was not the shape expected.
+bool ParseTaskStat(const std::string& text, ThreadUsage& usage);
+bool ParseTaskStatus(const std::string& text, ThreadUsage& usage);
+bool ParseTaskSched(const std::string& text, ThreadUsage& usage);
+
+// Which threads a capture is running on, and what each has used so far.
+//
+// Threads are registered by role as they start, and sampled by whoever has the
+// time to — in the pipeline, the control thread, which is awake on a timer and
+// on no deadline. Reading /proc is a dozen small file reads, which is nothing
+// on that thread and would be a jitter source on either of the other two.
+//
+// The one exception is the encoder's threads at their end. Their last reading
+// has to be taken while they still exist, and they end on the processing
+// thread, inside the sink's Finish when a file closes, so RetireThreads reads
+// /proc there. That is a pause between buffers that the ring already absorbs,
+// once per file; no buffer's own work ever reads /proc.
+//
+// A thread that has finished is folded into its role's totals and dropped, so
+// these only ever go up across a session — a caller can difference two
+// readings the way it differences the device's counters — while the list of
+// threads stays as long as the threads that are running.
+//
+// Thread-safety: every call may come from any thread. A mutex guards the list,
+// and is never held across a read of /proc: a sample takes the thread ids
+// under it, reads them without it, and takes it again to store what it read.
+// So the processing thread, which registers and retires the encoder's threads
+// at a file boundary, never waits behind the control thread's file I/O.
+class ThreadAccounting {
+ public:
+  enum class Role { kTransfer, kProcessing, kEncoder };
+
+  ThreadAccounting();
+
+  void Reset();
+
+  // Register the calling thread, and take a baseline so that what it did
+  // before the capture began is not charged to it.
+  void RegisterCurrentThread(Role role);
+
+  // Register threads the caller did not start — libFLAC's. They are new
+  // threads, so their counters already start from zero and no baseline is
+  // taken. Allocates nothing while the threads running number no more than
+  // kReservedThreads, which is what lets the processing thread call it.
+  void RegisterThreads(Role role, const std::vector<uint64_t>& thread_ids);
+
+  // Take a final reading of the calling thread, from getrusage, and stop
+  // sampling it. Called by a registered thread as the last thing it does.
+  void RetireCurrentThread();
+
+  // Take a final reading of threads that are about to go, and stop sampling
+  // them. The encoder's threads end inside FLAC__stream_encoder_finish, so
+  // this is called just before it — on the processing thread, and reading
+  // /proc there; see above.
+  void RetireThreads(const std::vector<uint64_t>& thread_ids);
+
+  // Read every live thread's counters.
+  void Sample();
+
+  // The totals as of the most recent sample or retirement.
+  CaptureThreadUsage Totals() const;
+
+ private:
+  // Two workers and a file's encoder threads at once, with room to spare.
+  static constexpr size_t kReservedThreads = 32;
+
+  struct Tracked {
+    uint64_t thread_id = 0;
+    Role role = Role::kProcessing;
+    ThreadUsage baseline;
+    ThreadUsage latest;
+  };
+
+  // Fold a finished thread into retired_ and drop it. Under the mutex.
+  void RetireLocked(size_t index, const ThreadUsage& final_reading);
+
+  mutable std::mutex mutex_;
+
+  // The threads still running
+  std::vector<Tracked> threads_;
+
+  // What the threads that have finished used, by role
+  CaptureThreadUsage retired_;
+};
+
+}  // namespace ddd::capture
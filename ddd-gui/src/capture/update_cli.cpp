@@ -12,6 +12,8 @@
 #include "update_cli.h"
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <vector>
 
@@ -64,13 +66,134 @@ class StreamLogger : public ILogger {
     if (level == LogLevel::kDebug) {
       return;
     }
+
+    // Locked because --all runs several updates at once, and each one logs
+    // from its own thread.
+    const std::lock_guard<std::mutex> guard(mutex_);
     out_ << message << "\n";
   }
 
  private:
+  std::mutex mutex_;
   std::ostream& out_;
 };
 
+// --all: every attached Duplicator that can take this bundle, at once.
+//
+// Each device is opened and gated on its own, and one that cannot be opened
+// or is refused by the gate is named and left out rather than stopping the
+// rest: on a rack of units, one with an old protocol is a reason to look at
+// that one, not to update none of them.
+int RunOnEveryDevice(const UpdateBundle& bundle, IUsbDevice& usb,
+                     const std::vector<DeviceInfo>& devices,
+                     const UpdateCliOptions& options, ILogger& logger,
+                     std::ostream& out, std::ostream& error) {
+  std::vector<std::string> paths;
+  std::vector<std::unique_ptr<IDeviceUpdater>> updaters;
+  bool refused = false;
+  bool unreachable = false;
+
+  for (const DeviceInfo& info : devices) {
+    if (info.personality != DevicePersonality::kApplication) {
+      out << "Skipping the device at " << info.path << ": "
+          << (info.personality == DevicePersonality::kRecovery
+                  ? "it has no working firmware. Program it on its own with "
+                    "--device."
+                  : "it cannot be updated from here.")
+          << "\n";
+      continue;
+    }
+
+    std::unique_ptr<IDeviceUpdater> updater =
+        MakeDeviceUpdater(usb, info.path, &logger);
+    const std::optional<DeviceIdentity> identity =
+        updater != nullptr ? updater->ReadIdentity() : std::nullopt;
+    if (!identity.has_value()) {
+      error << "The device at " << info.path << " did not answer.\n";
+      unreachable = true;
+      continue;
+    }
+
+    UpdateGateInput gate_input;
+    gate_input.device_attached = true;
+    gate_input.device = *identity;
+    gate_input.device_personality = info.personality;
+
+    const UpdateGateResult gate = CheckUpdateGate(bundle.manifest, gate_input);
+    for (const std::string& reason : gate.reasons) {
+      error << "Device at " << info.path << ": " << reason << "\n";
+    }
+    if (!gate.allowed()) {
+      refused = true;
+      continue;
+    }
+
+    out << "Device at " << info.path << ": " << info.product_string << "\n";
+    paths.push_back(info.path);
+    updaters.push_back(std::move(updater));
+  }
+
+  if (updaters.empty()) {
+    if (refused) {
+      return kUpdateCliBundle;
+    }
+    error << "No Domesday Duplicator that can take an update is attached.\n";
+    return kUpdateCliNoDevice;
+  }
+
+  if (options.dry_run) {
+    out << "The bundle verifies and can be installed on " << updaters.size()
+        << (updaters.size() == 1 ? " device" : " devices")
+        << ". Nothing was sent.\n";
+    return refused ? kUpdateCliBundle : kUpdateCliSuccess;
+  }
+
+  out << "Installing on " << updaters.size()
+      << (updaters.size() == 1 ? " device" : " devices")
+      << " at once. Leave them plugged in and powered.\n";
+
+  // One line per device per stage, as the single-device path prints one per
+  // stage. The callback is already serialised; the lock is for the logger's
+  // lines, which share the stream.
+  std::vector<UpdateStage> last_stage(updaters.size(), UpdateStage::kFailed);
+  std::mutex out_mutex;
+  const FleetProgressCallback report =
+      [&out, &out_mutex, &last_stage, &paths](size_t device,
+                                             const UpdateProgress& step) {
+        if (step.stage == last_stage[device]) {
+          return;
+        }
+        last_stage[device] = step.stage;
+        const std::lock_guard<std::mutex> guard(out_mutex);
+        out << "Device at " << paths[device] << ": "
+            << UpdateStageName(step.stage) << ": " << step.message << "\n";
+      };
+
+  std::vector<IDeviceUpdater*> running;
+  for (const std::unique_ptr<IDeviceUpdater>& updater : updaters) {
+    running.push_back(updater.get());
+  }
+  const std::vector<UpdateOutcome> outcomes =
+      RunUpdateOnEach(running, bundle, &logger, UpdateTimings{}, report);
+
+  bool failed = unreachable;
+  for (size_t device = 0; device < outcomes.size(); ++device) {
+    if (outcomes[device].succeeded) {
+      out << "Device at " << paths[device] << ": complete, now reports "
+          << outcomes[device].identity.product_string << ".\n";
+    } else {
+      error << "Device at " << paths[device] << ": "
+            << outcomes[device].problem << "\n";
+      failed = true;
+    }
+  }
+
+  if (failed) {
+    return kUpdateCliFailed;
+  }
+  return refused ? kUpdateCliBundle : kUpdateCliSuccess;
+}
+
 }  // namespace
 
 std::string UpdateCliUsage() {
@@ -82,6 +205,9 @@ std::string UpdateCliUsage() {
          "Options:\n"
          "  --device <path>       Update the device at this path, when several "
          "are attached\n"
+         "  --all                 Update every attached Duplicator at once. "
+         "Devices with no\n"
+         "                        working firmware are skipped\n"
          "  --dev-update-key      Accept a bundle signed with the development "
          "key, whose\n"
          "                        secret half is public. Proves the file is "
@@ -125,6 +251,11 @@ UpdateCliOptions ParseUpdateCliOptions(const std::vector<std::string>& args) {
       continue;
     }
 
+    if (argument == "--all") {
+      options.all_devices = true;
+      continue;
+    }
+
     if (argument == "--device") {
       if (index + 1 >= args.size()) {
         options.problem = "--device needs a device path after it.";
@@ -148,6 +279,8 @@ UpdateCliOptions ParseUpdateCliOptions(const std::vector<std::string>& args) {
 
   if (options.bundle_path.empty()) {
     options.problem = "No bundle given.";
+  } else if (options.all_devices && !options.device_path.empty()) {
+    options.problem = "--all and --device cannot be used together.";
   }
 
   return options;
@@ -219,6 +352,11 @@ int RunUpdateCli(const std::vector<std::string>& args, std::ostream& out,
     return kUpdateCliNoDevice;
   }
 
+  if (options.all_devices) {
+    return RunOnEveryDevice(*bundle, *usb, devices, options, logger, out,
+                            error);
+  }
+
   // Any personality, because a device with no working firmware is one of the
   // two this tool exists to program — the other being a device that has one
   // and wants a newer.
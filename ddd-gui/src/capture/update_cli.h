@@ -73,6 +73,12 @@ struct UpdateCliOptions {
   // and it is the only mode that touches no device state at all.
   bool dry_run = false;
 
+  // --all: every attached Duplicator running its own firmware, at once, from
+  // this one bundle. Devices in recovery are left for a run of their own —
+  // waking one is a different procedure, and a rack is updated from working
+  // units.
+  bool all_devices = false;
+
   bool show_help = false;
 
   // Set when parsing failed; already written for a human.
@@ -13,8 +13,12 @@
 #include "update_orchestrator.h"
 
 #include <algorithm>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "firmware_version.h"
 #include "log_format.h"
@@ -57,6 +61,22 @@ uint64_t AlignedChunk(uint64_t maximum) {
   return aligned == 0 ? kUpdateChunkAlignment : aligned;
 }
 
+// Another logger's lines, each with a label in front. What tells one device's
+// run from the next when RunUpdateOnEach has several writing to one log.
+class LabelledLogger : public ILogger {
+ public:
+  LabelledLogger(ILogger* inner, std::string label)
+      : inner_(inner), label_(std::move(label)) {}
+
+  void Log(LogLevel level, std::string_view message) override {
+    inner_->Log(level, label_ + std::string(message));
+  }
+
+ private:
+  ILogger* inner_ = nullptr;
+  std::string label_;
+};
+
 }  // namespace
 
 const char* UpdateStageName(UpdateStage stage) {
@@ -113,6 +133,12 @@ UpdateOrchestrator::UpdateOrchestrator(IDeviceUpdater& device, ILogger* logger)
 
 namespace {
 
+// Said the same way whether the stop came before the first chunk or between
+// two of them, because it is true either way: nothing counts until Finish.
+constexpr const char* kStoppedBeforeCommit =
+    "The update was stopped. Nothing was committed to the device — it still "
+    "has the firmware it started with.";
+
 // A digest is 64 characters and a log line is read by eye. The first eight are
 // enough to tell two payloads apart and to match a line against a manifest,
 // which is all this is ever used for.
@@ -427,35 +453,43 @@ bool UpdateOrchestrator::WriteComponent(UpdateTarget target,
     return false;
   }
 
-  uint64_t sent = 0;
-  uint16_t index = 0;
-  while (sent < total) {
-    if (Cancelled()) {
-      outcome.stage = UpdateStage::kFailed;
-      outcome.problem =
-          "The update was stopped. Nothing was committed to the device — it "
-          "still has the firmware it started with.";
-      return false;
-    }
-
-    const uint64_t span = std::min(chunk_bytes, total - sent);
-    if (!device_.SendChunk(target, index, payload.subspan(sent, span))) {
-      outcome.stage = UpdateStage::kFailed;
+  if (Cancelled()) {
+    outcome.stage = UpdateStage::kFailed;
+    outcome.problem = kStoppedBeforeCommit;
+    return false;
+  }
 
-      const std::optional<DeviceUpdateStatus> refused = device_.ReadStatus();
-      outcome.problem =
-          refused.has_value() && refused->error != DeviceUpdateError::kNone
-              ? DeviceUpdateErrorText(refused->error)
-              : std::string(
-                    "The device stopped accepting the update. Leave it "
-                    "plugged in, then try again.");
-      return false;
-    }
+  // Several chunks in flight rather than one, so that the next is already
+  // queued when the device finishes writing the last. The device still takes
+  // them one at a time and in order; what is saved is the host's turnaround
+  // between them. Cancelling stops the queue being refilled, and whatever is
+  // already in it is let through — the commit is Finish, not the chunks.
+  bool cancelled = false;
+  const uint64_t sent = device_.SendChunks(
+      target, payload, chunk_bytes, timings_.chunks_in_flight,
+      [this, target, total, &sending, &cancelled](uint64_t done) {
+        Report(UpdateStage::kTransferring, target, done, total, sending);
+        cancelled = Cancelled();
+        return !cancelled;
+      });
+
+  if (cancelled && sent < total) {
+    outcome.stage = UpdateStage::kFailed;
+    outcome.problem = kStoppedBeforeCommit;
+    return false;
+  }
 
-    sent += span;
-    ++index;
+  if (sent < total) {
+    outcome.stage = UpdateStage::kFailed;
 
-    Report(UpdateStage::kTransferring, target, sent, total, sending);
+    const std::optional<DeviceUpdateStatus> refused = device_.ReadStatus();
+    outcome.problem =
+        refused.has_value() && refused->error != DeviceUpdateError::kNone
+            ? DeviceUpdateErrorText(refused->error)
+            : std::string(
+                  "The device stopped accepting the update. Leave it "
+                  "plugged in, then try again.");
+    return false;
   }
 
   // The device now hashes the stream it received and, if that matches, reads
@@ -487,7 +521,9 @@ bool UpdateOrchestrator::WriteComponent(UpdateTarget target,
             .count();
     logger_->Debug(
         std::string("Sent the whole ") + UpdateTargetName(target) + ": " +
-        std::to_string(index) + " chunks, " + FormatBytes(total) + " in " +
+        std::to_string((total + chunk_bytes - 1) / chunk_bytes) +
+        " chunks with up to " + std::to_string(timings_.chunks_in_flight) +
+        " in flight, " + FormatBytes(total) + " in " +
         FormatDuration(seconds) +
         (seconds > 0.0 ? " (" +
                              FormatBytes(static_cast<uint64_t>(
@@ -770,4 +806,48 @@ UpdateOutcome UpdateOrchestrator::RunUpdate(const UpdateBundle& bundle) {
   return outcome;
 }
 
+std::vector<UpdateOutcome> RunUpdateOnEach(
+    std::span<IDeviceUpdater* const> devices, const UpdateBundle& bundle,
+    ILogger* logger, const UpdateTimings& timings,
+    FleetProgressCallback progress, std::function<bool()> cancel) {
+  std::vector<UpdateOutcome> outcomes(devices.size());
+  std::mutex progress_mutex;
+
+  std::vector<std::thread> workers;
+  workers.reserve(devices.size());
+  for (size_t device = 0; device < devices.size(); ++device) {
+    if (devices[device] == nullptr) {
+      outcomes[device].stage = UpdateStage::kFailed;
+      outcomes[device].problem = "The device could not be opened.";
+      continue;
+    }
+
+    workers.emplace_back([&, device] {
+      LabelledLogger labelled(logger,
+                              "Device " + std::to_string(device + 1) + ": ");
+
+      UpdateOrchestrator orchestrator(*devices[device],
+                                      logger != nullptr ? &labelled : nullptr);
+      orchestrator.SetTimings(timings);
+      if (progress) {
+        orchestrator.SetProgressCallback(
+            [&progress, &progress_mutex, device](const UpdateProgress& step) {
+              const std::lock_guard<std::mutex> guard(progress_mutex);
+              progress(device, step);
+            });
+      }
+      if (cancel) {
+        orchestrator.SetCancelCallback(cancel);
+      }
+
+      outcomes[device] = orchestrator.Run(bundle);
+    });
+  }
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return outcomes;
+}
+
 }  // namespace ddd::capture
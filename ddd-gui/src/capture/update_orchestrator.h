@@ -13,9 +13,12 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "device_updater.h"
 #include "update_bundle.h"
@@ -121,6 +124,12 @@ struct UpdateTimings {
   // called stuck. Generous, because an EEPROM page write is milliseconds and
   // an EPCS sector erase is most of a second.
   std::chrono::milliseconds stall_timeout{60000};
+
+  // How many chunks to keep queued ahead of the one the device is writing.
+  // Not a timing, but what most decides how long the transfer takes once the
+  // medium's own rate is set aside, and tuned alongside them. One is the
+  // original stop-and-wait behaviour.
+  size_t chunks_in_flight = 4;
 };
 
 // Run an update.
@@ -295,6 +304,37 @@ class UpdateOrchestrator {
   bool defer_restart_ = false;
 };
 
+// Progress from one of several devices being updated at once. `device` is its
+// position in the list RunUpdateOnEach was given.
+using FleetProgressCallback =
+    std::function<void(size_t device, const UpdateProgress&)>;
+
+// Install one bundle on several devices at once, each on a thread of its own,
+// and return how each ended, in the order they were given.
+//
+// A rack of units is the case: the time an update takes is almost all the
+// device writing its own medium, so a dozen of them one after another is a
+// dozen times the wait for no reason. Each device gets an ordinary
+// UpdateOrchestrator::Run — the same gate-passed assumption, the same restart
+// and proof — and nothing about one device's run depends on another's. A
+// failure on one is reported against that one and stops nothing else.
+//
+// The bundle is opened and verified once by the caller and shared, read-only,
+// by every run; its payloads are spans into the caller's buffer, and no copy
+// is made per device.
+//
+// `progress` is called from the worker threads, one call at a time. `cancel`
+// is called from all of them, concurrently, and must be safe to call that
+// way. Log lines from each run are prefixed with "Device <n>: ", counting
+// from one, so that interleaved runs can be told apart.
+//
+// A null entry is reported as a failure at kChecking rather than skipped, so
+// the outcomes still line up with the list.
+std::vector<UpdateOutcome> RunUpdateOnEach(
+    std::span<IDeviceUpdater* const> devices, const UpdateBundle& bundle,
+    ILogger* logger, const UpdateTimings& timings = {},
+    FleetProgressCallback progress = {}, std::function<bool()> cancel = {});
+
 // A rough estimate, in seconds, of how long installing this bundle will
 // take. Shown before the first byte moves, because "about four minutes" is
 // the difference between a user who waits and a user who unplugs it.
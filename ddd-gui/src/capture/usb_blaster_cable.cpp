@@ -52,6 +52,17 @@ constexpr uint8_t kByteShiftFlag = 0x80;
 // have caught up asks for TDO, and asking for TDO flushes.
 constexpr size_t kWriteBufferBytes = size_t{16} << 10;
 
+// How many answers may be owed before they are collected.
+//
+// Every read command puts a byte into the FT245's transmit buffer, which is
+// 384 bytes on the chip these cables carry and 256 on its later siblings. A
+// host that asked for more than fits before reading any would leave the CPLD
+// waiting for room, the OUT endpoint stalled behind it, and this side blocked
+// in a write that can never finish. Sixty-four is a single USB packet's worth
+// of answers with room to spare on either chip, and it still turns a 732-bit
+// status read from 732 round trips into a dozen.
+constexpr size_t kMaximumOwedAnswers = 64;
+
 bool BitAt(std::span<const uint8_t> bits, size_t index) {
   const size_t byte = index / 8;
   if (byte >= bits.size()) {
@@ -60,6 +71,20 @@ bool BitAt(std::span<const uint8_t> bits, size_t index) {
   return ((bits[byte] >> (index % 8)) & 1U) != 0;
 }
 
+// Eight bits starting at `index`, first bit in the least significant place.
+// A whole byte when the run happens to be aligned, which is the ordinary case
+// for a scan's data, and two halves spliced together when it is not.
+uint8_t ByteAt(std::span<const uint8_t> bits, size_t index) {
+  const size_t byte = index / 8;
+  const unsigned offset = index % 8;
+  const unsigned low = byte < bits.size() ? bits[byte] : 0U;
+  if (offset == 0) {
+    return static_cast<uint8_t>(low);
+  }
+  const unsigned high = byte + 1 < bits.size() ? bits[byte + 1] : 0U;
+  return static_cast<uint8_t>((low >> offset) | (high << (8 - offset)));
+}
+
 void SetBitAt(std::vector<uint8_t>& bits, size_t index, bool value) {
   if (!value) {
     return;
@@ -76,6 +101,15 @@ class UsbBlasterCable : public IJtagCable {
 
   bool Shift(std::span<const uint8_t> tms, std::span<const uint8_t> tdi,
              size_t bit_count, std::vector<uint8_t>* tdo) override {
+    if (!ShiftDeferred(tms, tdi, bit_count, tdo)) {
+      return false;
+    }
+    return tdo == nullptr || Flush();
+  }
+
+  bool ShiftDeferred(std::span<const uint8_t> tms,
+                     std::span<const uint8_t> tdi, size_t bit_count,
+                     std::vector<uint8_t>* tdo) override {
     if (tdo != nullptr) {
       tdo->assign((bit_count + 7) / 8, 0);
     }
@@ -100,7 +134,9 @@ class UsbBlasterCable : public IJtagCable {
       // Nothing is lost by avoiding it. In this project's own provisioning
       // file 103 bits of 73,297,811 are read — one ten-thousandth of one per
       // cent — so the fast path still carries everything that takes time,
-      // and a read costs sixteen command bytes a byte instead of two.
+      // and a read costs sixteen command bytes a byte instead of two. What
+      // a read used to cost as well was a round trip per bit; the answers
+      // are now owed and collected together, below.
       const size_t whole_bytes =
           tdo == nullptr ? ByteShiftableBytes(tms, bit, bit_count) : 0;
       if (whole_bytes > 0) {
@@ -145,18 +181,7 @@ class UsbBlasterCable : public IJtagCable {
     return true;
   }
 
-  bool Flush() override {
-    if (pending_.empty()) {
-      return true;
-    }
-    const bool sent = transport_.Write(pending_);
-    pending_.clear();
-    if (!sent) {
-      Fail("Sending to the USB-Blaster failed.");
-      return false;
-    }
-    return true;
-  }
+  bool Flush() override { return Send() && Collect(); }
 
  private:
   // How many whole bytes from `bit` can be clocked in byte-shift mode: TMS
@@ -165,14 +190,8 @@ class UsbBlasterCable : public IJtagCable {
   size_t ByteShiftableBytes(std::span<const uint8_t> tms, size_t bit,
                             size_t bit_count) const {
     size_t bytes = 0;
-    while (bytes < kMaximumShiftBytes && bit + (bytes + 1) * 8 <= bit_count) {
-      bool tms_low = true;
-      for (size_t index = 0; index < 8 && tms_low; ++index) {
-        tms_low = !BitAt(tms, bit + bytes * 8 + index);
-      }
-      if (!tms_low) {
-        break;
-      }
+    while (bytes < kMaximumShiftBytes && bit + (bytes + 1) * 8 <= bit_count &&
+           ByteAt(tms, bit + bytes * 8) == 0) {
       ++bytes;
     }
     return bytes;
@@ -185,13 +204,7 @@ class UsbBlasterCable : public IJtagCable {
   bool ShiftBytes(std::span<const uint8_t> tdi, size_t bit, size_t bytes) {
     Queue(static_cast<uint8_t>(kByteShiftFlag | bytes));
     for (size_t index = 0; index < bytes; ++index) {
-      uint8_t value = 0;
-      for (size_t offset = 0; offset < 8; ++offset) {
-        if (BitAt(tdi, bit + index * 8 + offset)) {
-          value |= static_cast<uint8_t>(1U << offset);
-        }
-      }
-      Queue(value);
+      Queue(ByteAt(tdi, bit + index * 8));
     }
 
     return FlushIfFull();
@@ -223,12 +236,14 @@ class UsbBlasterCable : public IJtagCable {
       return FlushIfFull();
     }
 
-    std::vector<uint8_t> answer;
-    if (!Read(1, answer)) {
-      return false;
+    // Owed rather than waited for. The answer is one byte in the stream the
+    // chip sends back, in the order the reads were asked for, so noting where
+    // it goes is all that is needed to put it there later.
+    owed_.push_back(OwedAnswer{tdo, bit});
+    if (owed_.size() >= kMaximumOwedAnswers) {
+      return Flush();
     }
-    SetBitAt(*tdo, bit, (answer[0] & 1U) != 0);
-    return true;
+    return FlushIfFull();
   }
 
   void Queue(uint8_t byte) { pending_.push_back(byte); }
@@ -237,16 +252,52 @@ class UsbBlasterCable : public IJtagCable {
     if (pending_.size() < kWriteBufferBytes) {
       return true;
     }
-    return Flush();
+
+    // Sent without collecting: the answers owed so far are at most
+    // kMaximumOwedAnswers, which the chip can hold however much is written
+    // behind them.
+    return Send();
   }
 
-  // Read exactly `wanted` payload bytes, dropping the two status bytes from
-  // the front of every packet the chip sends.
-  bool Read(size_t wanted, std::vector<uint8_t>& payload) {
-    if (!Flush()) {
+  bool Send() {
+    if (pending_.empty()) {
+      return true;
+    }
+    const bool sent = transport_.Write(pending_);
+    pending_.clear();
+    if (!sent) {
+      owed_.clear();
+      Fail("Sending to the USB-Blaster failed.");
       return false;
     }
+    return true;
+  }
+
+  // Read every answer owed, in one go, and put each bit where it belongs.
+  bool Collect() {
+    if (owed_.empty()) {
+      return true;
+    }
+
+    std::vector<uint8_t> answers;
+    const bool read = Read(owed_.size(), answers);
+    if (read) {
+      for (size_t index = 0; index < owed_.size(); ++index) {
+        SetBitAt(*owed_[index].tdo, owed_[index].bit,
+                 (answers[index] & 1U) != 0);
+      }
+    }
 
+    // Cleared either way. After a failed read the stream is out of step with
+    // the reads asked for, and nothing owed can be believed.
+    owed_.clear();
+    return read;
+  }
+
+  // Read exactly `wanted` payload bytes, dropping the two status bytes from
+  // the front of every packet the chip sends. Everything that asked for them
+  // has already been sent.
+  bool Read(size_t wanted, std::vector<uint8_t>& payload) {
     const size_t packet =
         std::max<size_t>(transport_.packet_bytes(), kFtdiStatusBytes + 1);
     payload.clear();
@@ -288,8 +339,8 @@ class UsbBlasterCable : public IJtagCable {
     }
 
     // More than was asked for means the cable sent a byte nothing requested,
-    // and there is exactly one read outstanding at a time — so the stream is
-    // out of step and every answer from here on would be one byte early.
+    // and every read outstanding is accounted for — so the stream is out of
+    // step and every answer from here on would be one byte early.
     //
     // Said rather than silently dropped, which is what this used to do. A
     // dropped byte turns into a scan that reads back plausible rubbish,
@@ -342,9 +393,16 @@ class UsbBlasterCable : public IJtagCable {
   // is the one that catches a cable answering promptly with nothing.
   static constexpr size_t kEmptyReadLimit = 32;
 
+  // Where an answer asked for and not yet read is to go.
+  struct OwedAnswer {
+    std::vector<uint8_t>* tdo = nullptr;
+    size_t bit = 0;
+  };
+
   IFtdiTransport& transport_;
   ILogger* logger_ = nullptr;
   std::vector<uint8_t> pending_;
+  std::vector<OwedAnswer> owed_;
 };
 
 }  // namespace
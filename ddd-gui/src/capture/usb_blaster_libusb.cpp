@@ -305,6 +305,11 @@ class OwningCable : public IJtagCable {
              size_t bit_count, std::vector<uint8_t>* tdo) override {
     return cable_->Shift(tms, tdi, bit_count, tdo);
   }
+  bool ShiftDeferred(std::span<const uint8_t> tms,
+                     std::span<const uint8_t> tdi, size_t bit_count,
+                     std::vector<uint8_t>* tdo) override {
+    return cable_->ShiftDeferred(tms, tdi, bit_count, tdo);
+  }
   bool RunClock(size_t count) override { return cable_->RunClock(count); }
   bool Flush() override { return cable_->Flush(); }
   const char* Name() const override { return cable_->Name(); }
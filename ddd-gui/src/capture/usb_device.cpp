@@ -109,6 +109,88 @@ TransferLayout PlanTransferLayout(size_t slot_bytes, size_t slot_count,
   return layout;
 }
 
+size_t IUsbControlChannel::TransferQueued(
+    uint8_t request_type, uint8_t request, std::span<const ControlWrite> writes,
+    size_t /*depth*/, unsigned int timeout_milliseconds,
+    const std::function<bool(size_t completed)>& on_complete) {
+  // Transfer()'s data stage is mutable because a control transfer may go
+  // either way. These all go out, so the copy is only to satisfy it; one
+  // buffer, reused, keeps it out of the per-request cost.
+  std::vector<uint8_t> buffer;
+  size_t completed = 0;
+  for (const ControlWrite& write : writes) {
+    buffer.assign(write.data.begin(), write.data.end());
+    const int sent =
+        Transfer(request_type, request, write.value, write.index,
+                 std::span<uint8_t>(buffer), timeout_milliseconds);
+    if (sent != static_cast<int>(buffer.size())) {
+      break;
+    }
+    ++completed;
+    if (on_complete && !on_complete(completed)) {
+      break;
+    }
+  }
+  return completed;
+}
+
+size_t RunQueuedControlTransfers(
+    std::span<const ControlWrite> writes, size_t depth,
+    IQueuedControlRing& ring,
+    const std::function<bool(size_t completed)>& on_complete) {
+  depth = std::max<size_t>(depth, 1);
+  size_t submitted = 0;
+  size_t reaped = 0;
+  size_t completed = 0;
+
+  // Two ways of stopping. A submission the backend could not make ends the
+  // run, but the transfers already out ahead of it are still counted as they
+  // finish — the device has them. A failure, or the caller saying stop, also
+  // ends the count: whatever is still queued behind it is left to finish on
+  // its own and counts for nothing.
+  bool submitting = true;
+  bool counting = true;
+
+  while (reaped < submitted || (submitting && submitted < writes.size())) {
+    // Keep the ring full.
+    while (submitting && submitted < writes.size() &&
+           submitted - reaped < depth) {
+      if (!ring.Submit(submitted % depth, writes[submitted])) {
+        submitting = false;
+        break;
+      }
+      ++submitted;
+    }
+
+    if (reaped == submitted) {
+      break;
+    }
+
+    // Oldest first. A later one finishing before it cannot happen on endpoint
+    // zero, and waiting on the oldest is what keeps the count honest if it
+    // somehow did.
+    const size_t slot = reaped % depth;
+    ring.Wait(slot);
+    ++reaped;
+
+    if (!counting) {
+      continue;
+    }
+    if (!ring.Succeeded(slot)) {
+      submitting = false;
+      counting = false;
+      continue;
+    }
+
+    ++completed;
+    if (on_complete && !on_complete(completed)) {
+      submitting = false;
+      counting = false;
+    }
+  }
+  return completed;
+}
+
 std::unique_ptr<IUsbDevice> MakeUsbDevice(ILogger* logger) {
 #ifdef _WIN32
   return MakeWinUsbDevice(logger);
@@ -13,6 +13,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <span>
 #include <string>
@@ -109,6 +110,50 @@ TransferLayout PlanTransferLayout(size_t slot_bytes, size_t slot_count,
                                   size_t endpoint_max_packet_bytes,
                                   const UsbSourceOptions& options);
 
+// One host-to-device request in a queued run of them. `data` must outlive the
+// TransferQueued call it is passed to.
+struct ControlWrite {
+  uint16_t value = 0;
+  uint16_t index = 0;
+  std::span<const uint8_t> data;
+};
+
+// The asynchronous half of a queued run, as a backend provides it: somewhere
+// to put `depth` transfers in flight, each in its own slot.
+//
+// RunQueuedControlTransfers owns the order — what goes in which slot, when the
+// ring is full, which slot to wait on next and when to stop — and a backend
+// owns only what its API does with one slot. That keeps the part that decides
+// what a run counted testable with a fake ring, on a machine without libusb
+// or a device.
+//
+// Thread-safety: none. Used by the thread running the queued transfer.
+class IQueuedControlRing {
+ public:
+  virtual ~IQueuedControlRing() = default;
+
+  // Submit `write` in `slot`, which is free. False if it could not be
+  // submitted, which ends the run.
+  virtual bool Submit(size_t slot, const ControlWrite& write) = 0;
+
+  // Wait until the transfer in `slot` has finished, however it finished.
+  virtual void Wait(size_t slot) = 0;
+
+  // Whether the transfer in `slot`, which has finished, moved all of its data.
+  // Asked only of transfers whose outcome still counts, so that the ones left
+  // to fail behind a refused chunk do not each report it again.
+  virtual bool Succeeded(size_t slot) = 0;
+};
+
+// Run `writes` through `ring` with up to `depth` in flight, reaping strictly
+// oldest first, with the contract of IUsbControlChannel::TransferQueued:
+// `on_complete` after each one in order, returning false to stop submitting;
+// everything submitted is waited for; the first failure ends the count.
+size_t RunQueuedControlTransfers(
+    std::span<const ControlWrite> writes, size_t depth,
+    IQueuedControlRing& ring,
+    const std::function<bool(size_t completed)>& on_complete);
+
 // A device held open for a run of control transfers.
 //
 // The register requests above open the device, do one transfer and close it
@@ -138,6 +183,37 @@ class IUsbControlChannel {
   virtual int Transfer(uint8_t request_type, uint8_t request, uint16_t value,
                        uint16_t index, std::span<uint8_t> data,
                        unsigned int timeout_milliseconds) = 0;
+
+  // A run of host-to-device transfers of one request, with up to `depth` of
+  // them submitted at once.
+  //
+  // What an update's data stage is: hundreds of UPDATE_DATA chunks, each of
+  // which the device acknowledges only once it has written it. One at a time,
+  // every chunk also pays for the host noticing the last one finished and
+  // getting the next one to the controller — small against an EEPROM page
+  // write, and not small against an EPCS page program. Queued, the next
+  // chunk's SETUP is already waiting when the device is ready for it.
+  //
+  // Endpoint zero carries one control transfer at a time, so the controller
+  // still executes them strictly in order; queueing changes when they are
+  // submitted and nothing about the sequence the device sees.
+  //
+  // `on_complete` is called with the count done so far as each one completes,
+  // in order, and returning false stops any more being submitted. Those
+  // already submitted are allowed to finish rather than cancelled: a control
+  // transfer cut off mid-data-stage leaves the device in a state nothing on
+  // this side can describe. Returns how many completed in full, in order —
+  // the first failure ends the run, and any behind it count for nothing even
+  // if the device took them.
+  //
+  // The default submits one at a time through Transfer(), which is the whole
+  // of the behaviour at depth one and the fallback for a backend with no
+  // asynchronous path.
+  virtual size_t TransferQueued(
+      uint8_t request_type, uint8_t request,
+      std::span<const ControlWrite> writes, size_t depth,
+      unsigned int timeout_milliseconds,
+      const std::function<bool(size_t completed)>& on_complete);
 };
 
 // A USB backend: how devices are found, configured and opened for streaming.
@@ -0,0 +1,356 @@
+/************************************************************************
+
+    usb_hotplug.cpp
+
+    Being told that the USB bus has changed, rather than asking
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "usb_hotplug.h"
+
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+#include "logger.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+// From linux/nsfs.h, which older kernel headers do not have. The ioctl itself
+// is Linux 4.9; a kernel without it fails the call, and that is handled.
+#ifndef NS_GET_USERNS
+#define NS_GET_USERNS _IO(0xb7, 0x1)
+#endif
+#endif
+
+namespace ddd::capture {
+namespace {
+
+// "1d50/603b/100": vendor, product and bcdDevice, in hex without leading
+// zeros. Only the first two are wanted.
+std::optional<UsbIdentity> ParseProduct(std::string_view value) {
+  const size_t first = value.find('/');
+  if (first == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const size_t second = value.find('/', first + 1);
+  const std::string_view vendor = value.substr(0, first);
+  const std::string_view product =
+      value.substr(first + 1, second == std::string_view::npos
+                                  ? std::string_view::npos
+                                  : second - first - 1);
+
+  UsbIdentity identity;
+  const auto parse = [](std::string_view text, uint16_t& out) {
+    const char* const end = text.data() + text.size();
+    const auto [ptr, error] = std::from_chars(text.data(), end, out, 16);
+    return !text.empty() && error == std::errc{} && ptr == end;
+  };
+  if (!parse(vendor, identity.vendor) || !parse(product, identity.product)) {
+    return std::nullopt;
+  }
+  return identity;
+}
+
+#ifdef __linux__
+
+// The initial user namespace's inode number, PROC_USER_INIT_INO in the
+// kernel's own headers, which do not export it. Fixed since namespaces were
+// given inodes, and every namespace created since has a different one.
+constexpr ino_t kInitialUserNamespaceInode = 0xEFFFFFFDU;
+
+// The kernel's own multicast group on NETLINK_KOBJECT_UEVENT. Group 2 is
+// udev's re-broadcast, which arrives only after rules have run and only where
+// udev is running at all.
+constexpr uint32_t kKernelUeventGroup = 1;
+
+class NetlinkHotplugEvents : public IHotplugEvents {
+ public:
+  explicit NetlinkHotplugEvents(ILogger* logger) : logger_(logger) {}
+  ~NetlinkHotplugEvents() override { Stop(); }
+
+  NetlinkHotplugEvents(const NetlinkHotplugEvents&) = delete;
+  NetlinkHotplugEvents& operator=(const NetlinkHotplugEvents&) = delete;
+
+  const char* Name() const override { return "netlink"; }
+
+  bool Start(Callback on_event) override {
+    Stop();
+
+    if (!UeventsCanArrive()) {
+      if (logger_ != nullptr) {
+        logger_->Debug(
+            "Kernel device events cannot reach this network namespace; "
+            "polling for devices instead");
+      }
+      return false;
+    }
+
+    socket_ = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC,
+                       NETLINK_KOBJECT_UEVENT);
+    if (socket_ < 0) {
+      Fail("socket");
+      return false;
+    }
+
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = kKernelUeventGroup;
+    if (::bind(socket_, reinterpret_cast<const sockaddr*>(&address),
+               sizeof(address)) != 0) {
+      Fail("bind");
+      return false;
+    }
+
+    // How Stop() interrupts a poll() that would otherwise wait for ever. A
+    // timeout would do it too, and would be the idle wake-up this whole file
+    // exists to remove.
+    stop_ = ::eventfd(0, EFD_CLOEXEC);
+    if (stop_ < 0) {
+      Fail("eventfd");
+      return false;
+    }
+
+    on_event_ = std::move(on_event);
+    thread_ = std::thread(&NetlinkHotplugEvents::Listen, this);
+    return true;
+  }
+
+  void Stop() override {
+    if (thread_.joinable()) {
+      const uint64_t one = 1;
+      [[maybe_unused]] const ssize_t written =
+          ::write(stop_, &one, sizeof(one));
+      thread_.join();
+    }
+    Close();
+  }
+
+ private:
+  void Fail(const char* what) {
+    if (logger_ != nullptr) {
+      logger_->Warning(std::string("Device events unavailable: ") + what +
+                       " failed: " + std::strerror(errno) +
+                       "; polling for devices instead");
+    }
+    Close();
+  }
+
+  void Close() {
+    if (socket_ >= 0) {
+      ::close(socket_);
+      socket_ = -1;
+    }
+    if (stop_ >= 0) {
+      ::close(stop_);
+      stop_ = -1;
+    }
+  }
+
+  void Listen() {
+    // The kernel's UEVENT_BUFFER_SIZE is 2048; anything longer is not a
+    // uevent, and is truncated into failing to parse.
+    std::array<char, 4096> buffer;
+
+    for (;;) {
+      std::array<pollfd, 2> fds{{{socket_, POLLIN, 0}, {stop_, POLLIN, 0}}};
+      if (::poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        Lose("poll");
+        return;
+      }
+      if (fds[1].revents != 0) {
+        return;
+      }
+      if ((fds[0].revents & POLLIN) == 0) {
+        Lose("the socket");
+        return;
+      }
+
+      sockaddr_nl sender{};
+      socklen_t sender_length = sizeof(sender);
+      const ssize_t received =
+          ::recvfrom(socket_, buffer.data(), buffer.size(), MSG_DONTWAIT,
+                     reinterpret_cast<sockaddr*>(&sender), &sender_length);
+      if (received < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+          continue;
+        }
+
+        // The receive queue overflowed and the kernel dropped messages — a
+        // hub full of devices all arriving at once. Any of them might have
+        // been ours, so the answer is to look.
+        if (errno == ENOBUFS) {
+          on_event_(HotplugEvent::kChanged);
+          continue;
+        }
+        Lose("recvfrom");
+        return;
+      }
+
+      // Only the kernel is port 0. Unprivileged processes cannot send to this
+      // group, but a message that claims to be a device arriving and did not
+      // come from the kernel is not one to act on regardless.
+      if (sender.nl_pid != 0) {
+        continue;
+      }
+
+      const std::optional<Uevent> event = ParseUevent(
+          std::string_view(buffer.data(), static_cast<size_t>(received)));
+      if (event.has_value() && IsRelevantUevent(*event)) {
+        on_event_(HotplugEvent::kChanged);
+      }
+    }
+  }
+
+  void Lose(const char* what) {
+    if (logger_ != nullptr) {
+      logger_->Warning(std::string("Device events stopped: ") + what +
+                       " failed: " + std::strerror(errno) +
+                       "; polling for devices instead");
+    }
+    on_event_(HotplugEvent::kLost);
+  }
+
+  ILogger* logger_ = nullptr;
+  Callback on_event_;
+  std::thread thread_;
+  int socket_ = -1;
+  int stop_ = -1;
+};
+
+#endif
+
+}  // namespace
+
+std::unique_ptr<IHotplugEvents> MakeHotplugEvents(ILogger* logger) {
+#ifdef __linux__
+  return std::make_unique<NetlinkHotplugEvents>(logger);
+#else
+  (void)logger;
+  return nullptr;
+#endif
+}
+
+std::optional<Uevent> ParseUevent(std::string_view datagram) {
+  // The header: "add@/devices/pci0000:00/.../1-2". Its action is repeated as
+  // ACTION= below, which is the one read; the header is only checked for,
+  // because its absence is what marks a datagram that is not a kernel uevent.
+  const size_t header_end = datagram.find('\0');
+  const std::string_view header = datagram.substr(0, header_end);
+  if (header.find('@') == std::string_view::npos) {
+    return std::nullopt;
+  }
+
+  Uevent event;
+  size_t position =
+      header_end == std::string_view::npos ? datagram.size() : header_end + 1;
+  while (position < datagram.size()) {
+    size_t end = datagram.find('\0', position);
+    if (end == std::string_view::npos) {
+      end = datagram.size();
+    }
+    const std::string_view pair = datagram.substr(position, end - position);
+    position = end + 1;
+
+    const size_t equals = pair.find('=');
+    if (equals == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view key = pair.substr(0, equals);
+    const std::string_view value = pair.substr(equals + 1);
+
+    if (key == "ACTION") {
+      event.action = value;
+    } else if (key == "SUBSYSTEM") {
+      event.subsystem = value;
+    } else if (key == "DEVTYPE") {
+      event.devtype = value;
+    } else if (key == "PRODUCT") {
+      event.identity = ParseProduct(value);
+    }
+  }
+
+  if (event.action.empty()) {
+    return std::nullopt;
+  }
+  return event;
+}
+
+bool IsRelevantUevent(const Uevent& event) {
+  if (event.subsystem != "usb" || event.devtype != "usb_device") {
+    return false;
+  }
+  if (event.action != "add" && event.action != "remove") {
+    return false;
+  }
+  return event.identity.has_value() && IsRecognisedUsbIdentity(*event.identity);
+}
+
+bool UeventsCanArrive() {
+#ifdef __linux__
+  const int network = ::open("/proc/self/ns/net", O_RDONLY | O_CLOEXEC);
+  if (network >= 0) {
+    const int owner = ::ioctl(network, NS_GET_USERNS);
+    ::close(network);
+    if (owner >= 0) {
+      struct stat status {};
+      const bool initial = ::fstat(owner, &status) == 0 &&
+                           status.st_ino == kInitialUserNamespaceInode;
+      ::close(owner);
+      return initial;
+    }
+  }
+
+  std::ifstream file("/proc/self/uid_map");
+  if (!file) {
+    return false;
+  }
+  const std::string text((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  return IsIdentityUidMap(text);
+#else
+  return false;
+#endif
+}
+
+bool IsIdentityUidMap(const std::string& text) {
+  // One line, "0 0 4294967295" give or take the column padding: uid 0 inside
+  // is uid 0 outside, for all 2^32 - 1 of them. A namespace that maps even
+  // one uid differently is not the initial one.
+  std::istringstream in(text);
+  uint64_t inside = 0;
+  uint64_t outside = 0;
+  uint64_t count = 0;
+  if (!(in >> inside >> outside >> count)) {
+    return false;
+  }
+  std::string rest;
+  if (in >> rest) {
+    return false;
+  }
+  return inside == 0 && outside == 0 && count == 4294967295U;
+}
+
+}  // namespace ddd::capture
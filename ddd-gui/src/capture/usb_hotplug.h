@@ -0,0 +1,127 @@
+/************************************************************************
+
+    usb_hotplug.h
+
+    Being told that the USB bus has changed, rather than asking
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "sysfs_device_list.h"
+
+namespace ddd::capture {
+
+class ILogger;
+
+// What an event source says. Deliberately no more than "look again": the
+// monitor's answer to any event is a full enumeration, which is what produces
+// the device list and its strings, so an event carrying which device arrived
+// would only be a second description of the bus to keep in step with the
+// first.
+enum class HotplugEvent {
+  // Something of ours has probably been attached or detached.
+  kChanged,
+
+  // The source has stopped and will say nothing more. The monitor goes back
+  // to polling rather than assuming that silence means nothing is happening.
+  kLost,
+};
+
+// A source of bus-change notifications for DeviceMonitor.
+//
+// An interface for the same reasons IUsbDevice is one: the real source needs a
+// kernel, and the tests need one they can fire by hand and count.
+//
+// Thread-safety: Start and Stop are for the monitor's controlling thread. The
+// callback arrives on whatever thread the source listens on, and must do no
+// more than note that the bus should be looked at. DeviceMonitor's wakes its
+// own thread and returns; the enumeration happens there.
+class IHotplugEvents {
+ public:
+  using Callback = std::function<void(HotplugEvent)>;
+
+  virtual ~IHotplugEvents() = default;
+
+  // For the log: "netlink".
+  virtual const char* Name() const = 0;
+
+  // Begin listening. False when events cannot be had here, in which case the
+  // callback is never called and the monitor polls as it always has.
+  virtual bool Start(Callback on_event) = 0;
+
+  // Stop listening. The callback is not called once this has returned.
+  virtual void Stop() = 0;
+};
+
+// The platform's event source, or nothing where there is none worth having.
+//
+// Linux only: a NETLINK_KOBJECT_UEVENT socket on the kernel's own multicast
+// group, the same messages udev and libusb's own hot-plug thread listen to.
+// Not libusb_hotplug_register_callback, for two reasons. Its callbacks are
+// delivered by whoever calls libusb_handle_events on the backend's context,
+// and that context is one the backend recycles when its cache goes stale —
+// see LibUsbDevice::Enumerate — so a registration would have to be torn down
+// and remade around every rescan. And it is silent in exactly the environment
+// SysfsDeviceList exists for, because it is fed by those same netlink
+// messages.
+//
+// Windows and macOS get nothing, and poll: WinUSB's notifications need a
+// window and a message pump, and IOKit's need a run loop, neither of which the
+// engine has or should grow for a device that is plugged in a few times a day.
+std::unique_ptr<IHotplugEvents> MakeHotplugEvents(ILogger* logger);
+
+// One kernel uevent, as much of it as the filter needs.
+struct Uevent {
+  std::string action;     // "add", "remove", "bind", ...
+  std::string subsystem;  // "usb"
+  std::string devtype;    // "usb_device", "usb_interface"
+
+  // From PRODUCT=, which the kernel sends with every usb_device event,
+  // removals included. Absent when the message had none.
+  std::optional<UsbIdentity> identity;
+};
+
+// Parse one datagram off the kernel's uevent group: "action@devpath" and then
+// NUL-separated KEY=value pairs. Nothing when it is not that shape — udev's
+// re-broadcasts on the other group start "libudev" and a binary header, and
+// are not asked for, but a stray one is not a reason to misread the rest.
+std::optional<Uevent> ParseUevent(std::string_view datagram);
+
+// Is this an event the monitor should wake for?
+//
+// Only a whole device of ours arriving or leaving. One device plugged in
+// produces a burst of messages — the device, then each interface, then each
+// driver binding — and every other device on the bus produces the same, so
+// waking for all of them would be a mouse being plugged in looking like
+// news, several times over.
+bool IsRelevantUevent(const Uevent& event);
+
+// Can kernel uevents reach this process at all?
+//
+// The kernel broadcasts them only into network namespaces owned by the
+// initial user namespace, and a socket in any other is created and bound
+// without complaint regardless (sysfs_device_list.h has the whole story). A
+// listener there would hear nothing and the monitor would wait on it for ever,
+// so the question is asked up front: the owner of this process's network
+// namespace, through NS_GET_USERNS, compared with the initial user namespace's
+// fixed inode number. Where that ioctl is missing the answer falls back to
+// IsIdentityUidMap on this process's own user namespace, which says no to some
+// setups that would have worked and never says yes to one that would not.
+bool UeventsCanArrive();
+
+// Is this /proc/<pid>/uid_map the initial user namespace's — every uid mapped
+// to itself?
+bool IsIdentityUidMap(const std::string& text);
+
+}  // namespace ddd::capture
@@ -30,6 +30,7 @@
 #include <string>
 #include <vector>
 
+#include "log_format.h"
 #include "logger.h"
 #include "winusb_source.h"
 #include "wire_protocol.h"
@@ -260,7 +261,7 @@ class WinUsbControlChannel : public IUsbControlChannel {
       // something, and the update flow asks devices things they may not be
       // able to do. It is the caller's business rather than an error.
       if (logger_ != nullptr) {
-        logger_->Debug("Update control transfer 0x" + std::to_string(request) +
+        logger_->Debug("Update control transfer " + FormatHex(request, 2) +
                        " failed with error " + std::to_string(GetLastError()));
       }
       return -1;
@@ -130,6 +130,8 @@ inline constexpr uint8_t kRegisterCommit = 0x03;
 inline constexpr uint8_t kRegisterImageRole = 0x0B;
 inline constexpr uint8_t kRegisterTestMode = 0x10;
 inline constexpr uint8_t kRegisterDecimation = 0x12;
+inline constexpr uint8_t kRegisterWireFormat = 0x13;
+inline constexpr uint8_t kRegisterInbandTelemetry = 0x14;
 
 // What the decimation register holds: the factor, not a flag, so that reading
 // it back is a statement of what the capture path is doing rather than an echo
@@ -138,6 +140,23 @@ inline constexpr uint8_t kRegisterDecimation = 0x12;
 // file.
 inline constexpr uint8_t kDecimationEverySample = 0x01;
 inline constexpr uint8_t kDecimationHalfRate = 0x02;
+inline constexpr uint8_t kDecimationQuarterRate = 0x04;
+inline constexpr uint8_t kDecimationEighthRate = 0x08;
+
+// What the wire format register holds. Like decimation, it is read back rather
+// than assumed: gateware that does not pack — the factory image, and every
+// application image before the packed format — reads 0x00 whatever was
+// written, and the host believes the register rather than its own request.
+// See WireFormat in sample_format.h for what the packed stream looks like.
+inline constexpr uint8_t kWireFormatWords = 0x00;
+inline constexpr uint8_t kWireFormatPacked = 0x01;
+
+// What the in-band telemetry register holds: off, or a block of buffer readings
+// at the head of every packet. Read back rather than assumed, on the same terms
+// as the wire format — gateware without it reads 0x00 — because a host that
+// stripped blocks from a stream that had none would throw away samples.
+inline constexpr uint8_t kInbandTelemetryOff = 0x00;
+inline constexpr uint8_t kInbandTelemetryOn = 0x01;
 
 // The identity block: signature, map version, build flags, eight commit
 // characters and the image role, contiguous so that one request fetches all of
@@ -205,6 +224,43 @@ inline constexpr uint8_t kTelemetryFlagSaturated = 0x20;
 // the field is sixteen bits.
 inline constexpr unsigned kTelemetryNearFullPrescale = 256;
 
+// The in-band telemetry block.
+//
+// With kRegisterInbandTelemetry on, the gateware opens every packet with eight
+// words of the buffer instrument's reading for that packet, taken as the packet
+// was offered to the FX3, and the packet's samples follow. Every field is one
+// word, least significant byte first. The packet is still kInbandPacketWords
+// long, so the block costs eight words of samples per packet rather than
+// lengthening anything the firmware or the USB link has to know about.
+//
+// The host finds a block by its place — the head of a packet — and believes it
+// by the tag and the check word, which is every other word exclusive-or'd
+// together. See InbandTelemetryStripper.
+inline constexpr size_t kInbandPacketWords = 8192;
+inline constexpr size_t kInbandBlockWords = 8;
+
+// The tag. Its top six bits are the one sequence number the generator never
+// stamps, so in the word format no sample can look like it; packed data has no
+// such guarantee, which is why the block is found by position first.
+inline constexpr uint16_t kInbandTag = 0xFDDD;
+
+// The layout this build understands, in the low byte of the second word.
+inline constexpr uint8_t kInbandFormat = 1;
+
+// Word offsets within the block.
+inline constexpr size_t kInbandWordTag = 0;
+inline constexpr size_t kInbandWordFormatFlags = 1;
+inline constexpr size_t kInbandWordPacketNumber = 2;
+inline constexpr size_t kInbandWordUsed = 3;
+inline constexpr size_t kInbandWordPeak = 4;
+inline constexpr size_t kInbandWordDropped = 5;
+inline constexpr size_t kInbandWordDepth = 6;
+inline constexpr size_t kInbandWordCheck = 7;
+
+// Bits of the flags byte, the high byte of the second word.
+inline constexpr uint8_t kInbandFlagNearFull = 0x01;
+inline constexpr uint8_t kInbandFlagSaturated = 0x02;
+
 // The fixed value at kRegisterId.
 //
 // Neither 0x00 nor 0xFF deliberately: SPI has no acknowledgement, so an FPGA
@@ -239,6 +295,18 @@ inline constexpr uint16_t MakeDecimationWrite(uint8_t factor) {
   return MakeRegisterWrite(kRegisterDecimation, factor);
 }
 
+// Build the wValue that selects how samples are laid out on the wire.
+inline constexpr uint16_t MakeWireFormatWrite(bool packed) {
+  return MakeRegisterWrite(kRegisterWireFormat,
+                           packed ? kWireFormatPacked : kWireFormatWords);
+}
+
+// Build the wValue that turns in-band telemetry on or off.
+inline constexpr uint16_t MakeInbandTelemetryWrite(bool on) {
+  return MakeRegisterWrite(kRegisterInbandTelemetry,
+                           on ? kInbandTelemetryOn : kInbandTelemetryOff);
+}
+
 // The device update agent.
 //
 // Six requests on endpoint 0, by which the host hands the FX3 a firmware or
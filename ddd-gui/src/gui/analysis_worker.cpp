@@ -12,14 +12,64 @@
 #include "analysis_worker.h"
 
 #include <QTimer>
+#include <chrono>
+#include <optional>
 
 #include "sample_format.h"
+#include "waveform_mapping.h"
+#include "waveform_trigger.h"
 
 namespace ddd::gui {
+namespace {
+
+// Assembled from bytes rather than reinterpreted as uint16_t: the wire format
+// is little-endian regardless of what this machine is, and a cast would be
+// right on one architecture and silently wrong on another.
+void WireToCodes(const std::vector<uint8_t>& wire,
+                 std::vector<uint16_t>& codes) {
+  const size_t sample_count = wire.size() / capture::kBytesPerSample;
+  codes.resize(sample_count);
+  for (size_t index = 0; index < sample_count; ++index) {
+    const uint16_t word =
+        static_cast<uint16_t>(wire[index * capture::kBytesPerSample]) |
+        static_cast<uint16_t>(
+            static_cast<uint16_t>(wire[(index * capture::kBytesPerSample) + 1])
+            << 8);
+    codes[index] = capture::SampleValueFromWord(word);
+  }
+}
+
+void ApplySnapshotTrigger(capture::SnapshotPublisher* snapshots, bool enabled) {
+  if (snapshots == nullptr) {
+    return;
+  }
+  if (!enabled) {
+    snapshots->DisarmTrigger();
+    return;
+  }
+
+  // The scope's own trigger, so the crossing the pipeline lines up on is one
+  // FindTriggers would have taken as well
+  capture::SnapshotTrigger trigger;
+  trigger.level_codes = static_cast<uint16_t>(analysis::kAdcMidScaleCode);
+  trigger.hysteresis_codes =
+      static_cast<uint16_t>(analysis::kDefaultTriggerHysteresisCodes);
+  trigger.pre_trigger_fraction = analysis::kPreTriggerFraction;
+  snapshots->ArmTrigger(trigger);
+}
+
+double SteadySeconds() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
 
 void SnapshotAnalyser::SetSource(capture::SnapshotPublisher* snapshots) {
   const std::lock_guard<std::mutex> lock(source_mutex_);
   source_ = snapshots;
+  ApplySnapshotTrigger(source_, snapshot_trigger_);
 
   // A new run is a new signal. Carrying the averaged spectrum and the peak hold
   // across would show the previous device's carrier for several seconds after
@@ -27,6 +77,12 @@ void SnapshotAnalyser::SetSource(capture::SnapshotPublisher* snapshots) {
   spectrum_.Reset();
 }
 
+void SnapshotAnalyser::SetSnapshotTrigger(bool enabled) {
+  const std::lock_guard<std::mutex> lock(source_mutex_);
+  snapshot_trigger_ = enabled;
+  ApplySnapshotTrigger(source_, snapshot_trigger_);
+}
+
 void SnapshotAnalyser::SetSpectrumAveraging(double averaging) {
   requested_averaging_.store(averaging);
   options_changed_.store(true);
@@ -41,6 +97,20 @@ void SnapshotAnalyser::RequestPeakHoldReset() {
   peak_hold_reset_requested_.store(true);
 }
 
+void SnapshotAnalyser::SetFieldSource(capture::SnapshotPublisher* fields) {
+  const std::lock_guard<std::mutex> lock(source_mutex_);
+  field_source_ = fields;
+}
+
+void SnapshotAnalyser::SetVideoPreview(bool enabled,
+                                       analysis::VideoStandard standard,
+                                       uint32_t sample_rate_hz) {
+  requested_standard_.store(standard);
+  requested_sample_rate_hz_.store(sample_rate_hz);
+  video_enabled_.store(enabled);
+  video_changed_.store(true);
+}
+
 void SnapshotAnalyser::Begin() {
   // Created here rather than in the constructor because a QTimer fires on the
   // thread it was created on. Built in the constructor it would belong to the
@@ -67,6 +137,12 @@ void SnapshotAnalyser::Poll() {
     spectrum_.ResetPeakHold();
   }
 
+  // Before the snapshot rather than after it, because the snapshot's path
+  // returns early whenever there is nothing new — which is most polls — and
+  // the field tap runs to a timetable of its own.
+  PollField();
+
+  std::optional<double> trigger_position;
   {
     const std::lock_guard<std::mutex> lock(source_mutex_);
     if (source_ == nullptr) {
@@ -74,7 +150,7 @@ void SnapshotAnalyser::Poll() {
     }
 
     uint64_t generation = 0;
-    if (!source_->TryRead(wire_, generation)) {
+    if (!source_->TryRead(wire_, generation, trigger_position)) {
       // Nothing new since the last poll, which is the ordinary case: the
       // pipeline publishes about nine snapshots a second and this looks thirty
       // times.
@@ -82,21 +158,9 @@ void SnapshotAnalyser::Poll() {
     }
   }
 
-  const size_t sample_count = wire_.size() / capture::kBytesPerSample;
-  codes_.resize(sample_count);
-  for (size_t index = 0; index < sample_count; ++index) {
-    // Assembled from bytes rather than reinterpreted as uint16_t: the wire
-    // format is little-endian regardless of what this machine is, and a cast
-    // would be right on one architecture and silently wrong on another.
-    const uint16_t word =
-        static_cast<uint16_t>(wire_[index * capture::kBytesPerSample]) |
-        static_cast<uint16_t>(
-            static_cast<uint16_t>(wire_[(index * capture::kBytesPerSample) + 1])
-            << 8);
-    codes_[index] = capture::SampleValueFromWord(word);
-  }
+  WireToCodes(wire_, codes_);
 
-  emit WaveformReady(codes_);
+  emit WaveformReady(codes_, trigger_position.value_or(-1.0));
 
   if (spectrum_.Analyse(codes_.data(), codes_.size())) {
     emit SpectrumReady(spectrum_.magnitudes_db(), spectrum_.peak_hold_db(),
@@ -104,11 +168,61 @@ void SnapshotAnalyser::Poll() {
   }
 }
 
+void SnapshotAnalyser::PollField() {
+  if (video_changed_.exchange(false)) {
+    preview_.reset();
+    preview_pacer_.Reset();
+    if (video_enabled_.load()) {
+      analysis::VideoPreview::Options options;
+      options.standard = requested_standard_.load();
+      options.sample_rate_hz = requested_sample_rate_hz_.load();
+      preview_ = std::make_unique<analysis::VideoPreview>(options);
+    }
+  }
+
+  // A rate that has filtered the carrier out is refused here rather than by
+  // Render, so the tap is not copied for a field that cannot be drawn
+  if (preview_ == nullptr || !preview_->rate_carries()) {
+    return;
+  }
+
+  // Not read while resting. The tap keeps only its newest field, so the one
+  // taken when the rest is over is as fresh as any taken now would have been.
+  const double started = SteadySeconds();
+  if (!preview_pacer_.Due(started)) {
+    return;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock(source_mutex_);
+    if (field_source_ == nullptr) {
+      return;
+    }
+    uint64_t generation = 0;
+    if (!field_source_->TryRead(field_wire_, generation)) {
+      return;
+    }
+  }
+
+  WireToCodes(field_wire_, field_codes_);
+  const bool rendered =
+      preview_->Render(field_codes_.data(), field_codes_.size());
+
+  // Charged whether or not a field came of it: a run with no vertical sync in
+  // it cost the demodulation all the same
+  preview_pacer_.Record(started, SteadySeconds());
+
+  if (rendered) {
+    emit VideoFieldReady(preview_->field());
+  }
+}
+
 AnalysisWorker::AnalysisWorker(QObject* parent) : QObject(parent) {
   // Registered here rather than in main() so that the types are known to the
   // meta-object system before any connection is made, whatever creates this.
   qRegisterMetaType<std::vector<uint16_t>>();
   qRegisterMetaType<std::vector<double>>();
+  qRegisterMetaType<ddd::analysis::VideoField>();
 }
 
 AnalysisWorker::~AnalysisWorker() {
@@ -125,6 +239,7 @@ void AnalysisWorker::Start() {
   }
 
   analyser_ = new SnapshotAnalyser();
+  analyser_->SetSnapshotTrigger(snapshot_trigger_);
 
   // Auto connections, which become queued because the sender ends up on the
   // worker thread and the receiver stays here. That is what puts the vectors
@@ -134,6 +249,8 @@ void AnalysisWorker::Start() {
           &AnalysisWorker::WaveformReady);
   connect(analyser_, &SnapshotAnalyser::SpectrumReady, this,
           &AnalysisWorker::SpectrumReady);
+  connect(analyser_, &SnapshotAnalyser::VideoFieldReady, this,
+          &AnalysisWorker::VideoFieldReady);
 
   analyser_->moveToThread(&thread_);
   connect(&thread_, &QThread::started, analyser_, &SnapshotAnalyser::Begin);
@@ -151,6 +268,7 @@ void AnalysisWorker::Stop() {
   // does next to the publisher cannot race a poll already under way.
   if (analyser_ != nullptr) {
     analyser_->SetSource(nullptr);
+    analyser_->SetFieldSource(nullptr);
   }
 
   thread_.quit();
@@ -167,6 +285,13 @@ void AnalysisWorker::SetSource(capture::SnapshotPublisher* snapshots) {
   }
 }
 
+void AnalysisWorker::SetSnapshotTrigger(bool enabled) {
+  snapshot_trigger_ = enabled;
+  if (analyser_ != nullptr) {
+    analyser_->SetSnapshotTrigger(enabled);
+  }
+}
+
 void AnalysisWorker::SetSpectrumAveraging(double averaging) {
   if (analyser_ != nullptr) {
     analyser_->SetSpectrumAveraging(averaging);
@@ -185,4 +310,18 @@ void AnalysisWorker::ResetPeakHold() {
   }
 }
 
+void AnalysisWorker::SetFieldSource(capture::SnapshotPublisher* fields) {
+  if (analyser_ != nullptr) {
+    analyser_->SetFieldSource(fields);
+  }
+}
+
+void AnalysisWorker::SetVideoPreview(bool enabled,
+                                     analysis::VideoStandard standard,
+                                     uint32_t sample_rate_hz) {
+  if (analyser_ != nullptr) {
+    analyser_->SetVideoPreview(enabled, standard, sample_rate_hz);
+  }
+}
+
 }  // namespace ddd::gui
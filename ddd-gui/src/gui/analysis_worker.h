@@ -23,6 +23,7 @@
 #include "capture_metatypes.h"
 #include "monitor_tap.h"
 #include "spectrum_analyser.h"
+#include "video_preview.h"
 
 class QTimer;
 
@@ -37,7 +38,7 @@ namespace ddd::gui {
 // coping. The measurement must not be part of what it is measuring.
 //
 // Nothing here can slow the capture down. The snapshots come from the
-// triple-buffered publisher in monitor_tap.h, which never makes its writer wait
+// buffer-pool publisher in monitor_tap.h, which never makes its writer wait
 // for anything: a poll that finds no new snapshot returns immediately, and a
 // consumer too slow to keep up misses snapshots rather than delaying the
 // pipeline. Frames are dropped, never queued — an old picture of a live signal
@@ -61,6 +62,12 @@ class SnapshotAnalyser : public QObject {
   // capture.
   void SetSource(capture::SnapshotPublisher* snapshots);
 
+  // Whether the pipeline should line its snapshots up on a rising crossing of
+  // mid-scale, which it does across the whole slot before it copies one (see
+  // capture/snapshot_trigger.h). Armed on the source now and on every source
+  // attached after. On by default, as the scope's trigger is.
+  void SetSnapshotTrigger(bool enabled);
+
   void SetSpectrumAveraging(double averaging);
 
   // The segment length the spectrum is estimated with, which is what sets its
@@ -70,6 +77,16 @@ class SnapshotAnalyser : public QObject {
 
   void RequestPeakHoldReset();
 
+  // Attach the video preview's tap, or detach it with nullptr. The same
+  // promise as SetSource: the worker is out of the old one when this returns.
+  void SetFieldSource(capture::SnapshotPublisher* fields);
+
+  // Whether to render fields, in which standard, and at what rate the stream
+  // is arriving. Off costs nothing — the tap is not even read — which is what
+  // the panel asks for whenever nobody can see it.
+  void SetVideoPreview(bool enabled, analysis::VideoStandard standard,
+                       uint32_t sample_rate_hz);
+
  public slots:
   // Builds the poll timer. Connected to the thread's started() signal so that
   // the timer is created on the thread it will fire on.
@@ -78,7 +95,10 @@ class SnapshotAnalyser : public QObject {
   void Poll();
 
  signals:
-  void WaveformReady(const std::vector<uint16_t>& codes);
+  // trigger_position is the crossing the snapshot was lined up on, in samples
+  // from its start, or negative when it was not lined up on one.
+  void WaveformReady(const std::vector<uint16_t>& codes,
+                     double trigger_position);
 
   // Three readings of the same transform, because the two displays want
   // different ones: the trace wants the averaged levels and its peak hold,
@@ -93,11 +113,20 @@ class SnapshotAnalyser : public QObject {
                      const std::vector<double>& peak_hold_db,
                      const std::vector<double>& snapshot_db, size_t segments);
 
+  void VideoFieldReady(const ddd::analysis::VideoField& field);
+
  private:
-  // Guards the source pointer and the read through it, and nothing else. Held
-  // for a memcpy, never for a transform.
+  // A field, if one is due and one has arrived. Paced by preview_pacer_, so a
+  // machine that cannot render every field the tap offers renders fewer of
+  // them and the waveform and spectrum on the same thread carry on as before.
+  void PollField();
+
+  // Both taps' guard, and nothing else. Held for a memcpy, never for a
+  // transform.
   std::mutex source_mutex_;
   capture::SnapshotPublisher* source_ = nullptr;
+  capture::SnapshotPublisher* field_source_ = nullptr;
+  bool snapshot_trigger_ = true;
 
   QTimer* timer_ = nullptr;
 
@@ -112,9 +141,21 @@ class SnapshotAnalyser : public QObject {
   std::atomic<bool> options_changed_{false};
   std::atomic<bool> peak_hold_reset_requested_{false};
 
+  // The preview, built on the worker thread when the request below changes and
+  // not before: a preview nobody asked for holds no scratch.
+  std::unique_ptr<analysis::VideoPreview> preview_;
+  analysis::WorkPacer preview_pacer_;
+  std::atomic<bool> video_enabled_{false};
+  std::atomic<analysis::VideoStandard> requested_standard_{
+      analysis::VideoStandard::kPal};
+  std::atomic<uint32_t> requested_sample_rate_hz_{capture::kSampleRateHz};
+  std::atomic<bool> video_changed_{false};
+
   // Worker-thread scratch. Reused rather than reallocated per frame.
   std::vector<uint8_t> wire_;
   std::vector<uint16_t> codes_;
+  std::vector<uint8_t> field_wire_;
+  std::vector<uint16_t> field_codes_;
 };
 
 // The GUI-side handle. Owns the thread and the object on it, and re-emits what
@@ -137,15 +178,23 @@ class AnalysisWorker : public QObject {
 
   bool running() const { return thread_.isRunning(); }
 
-  // All four are no-ops before Start() and after Stop(): there is no thread to
-  // carry the request to, and a caller should not have to check.
+  // All of these are no-ops before Start() and after Stop(): there is no
+  // thread to carry the request to, and a caller should not have to check.
   void SetSource(capture::SnapshotPublisher* snapshots);
   void SetSpectrumAveraging(double averaging);
   void SetSpectrumTransformSize(size_t transform_size);
   void ResetPeakHold();
 
+  // Kept as well as passed on, unlike the rest: the trigger box is set before
+  // the thread starts, and the analyser it starts with should agree with it.
+  void SetSnapshotTrigger(bool enabled);
+  void SetFieldSource(capture::SnapshotPublisher* fields);
+  void SetVideoPreview(bool enabled, analysis::VideoStandard standard,
+                       uint32_t sample_rate_hz);
+
  signals:
-  void WaveformReady(const std::vector<uint16_t>& codes);
+  void WaveformReady(const std::vector<uint16_t>& codes,
+                     double trigger_position);
 
   // Three readings of the same transform and the number of segments they were
   // averaged over. See SnapshotAnalyser::SpectrumReady.
@@ -153,6 +202,8 @@ class AnalysisWorker : public QObject {
                      const std::vector<double>& peak_hold_db,
                      const std::vector<double>& snapshot_db, size_t segments);
 
+  void VideoFieldReady(const ddd::analysis::VideoField& field);
+
  private:
   QThread thread_;
 
@@ -161,6 +212,8 @@ class AnalysisWorker : public QObject {
   // another thread. It is destroyed by a deleteLater connected to the thread's
   // finished signal, which runs on the thread that owns it.
   SnapshotAnalyser* analyser_ = nullptr;
+
+  bool snapshot_trigger_ = true;
 };
 
 }  // namespace ddd::gui
@@ -106,6 +106,10 @@ void AutoCaptureController::Start(const player::AutoCapturePlan& plan,
   // how each fact was arrived at.
   capture_->SetDiscScan(DescribeDiscScan(disc));
 
+  // And what the watch's address readings will mean, so the file can keep
+  // them. Set before the capture is opened for the reason the tags are.
+  capture_->SetAddressing(DescribeAddressing(plan.addressing));
+
   // The sequence owns the session for its duration. Without this the status
   // poll would interleave a query into the middle of a seek, and a reply
   // attributed to the wrong command is how a seek comes to report the tray
@@ -166,6 +170,10 @@ void AutoCaptureController::Step() {
       break;
   }
 
+  if (step->stage == player::AutoCaptureStage::kWatching) {
+    query_sent_position_ = capture_->CapturePosition();
+  }
+
   pending_request_ =
       player_->Send(CommandRequest(step->command, step->argument));
 }
@@ -201,7 +209,22 @@ void AutoCaptureController::OnReply(const PlayerReply& reply) {
   parsed.error_code = reply.error_code.toStdString();
   parsed.sent = reply.sent.toStdString();
 
+  // The watch's readings are kept against where the file was, rather than
+  // thrown away once the sequence has decided whether to stop. Only a reading
+  // the sequence took as an advance is passed on, which leaves out the lead-in,
+  // a reply it could not read, and a player reading the same frame twice.
+  const bool watching =
+      sequence_->stage() == player::AutoCaptureStage::kWatching;
+  const std::optional<int32_t> before = sequence_->last_address();
+
   Apply(player::PlayerReplied(parsed));
+
+  if (watching && sequence_ != nullptr &&
+      sequence_->last_address().has_value() &&
+      sequence_->last_address() != before) {
+    capture_->RecordPlayerAddress(*sequence_->last_address(),
+                                  query_sent_position_);
+  }
 }
 
 void AutoCaptureController::FinishRun() {
@@ -228,6 +251,7 @@ void AutoCaptureController::FinishRun() {
   if (capture_ != nullptr) {
     capture_->SetDiscProvenance({});
     capture_->SetDiscScan({});
+    capture_->SetAddressing({});
   }
 
   Log(tr("Automatic capture %1.").arg(AutoCaptureOutcomeText(outcome)));
@@ -176,6 +176,11 @@ class AutoCaptureController : public QObject {
   // would rearm its own timer for ever and never actually poll.
   bool delayed_ = false;
 
+  // Where the file being written stood when the watch's address query in
+  // flight was sent — the front of the bracket its answer is placed in. See
+  // CaptureController::RecordPlayerAddress.
+  uint64_t query_sent_position_ = 0;
+
   // Consecutive readings of a player that is not spinning. Reset by anything
   // else, which is what makes it a debounce rather than a count.
   int stopped_readings_ = 0;
@@ -15,6 +15,9 @@
 #include <QFileInfo>
 #include <QLatin1String>
 #include <QStringList>
+#include <algorithm>
+
+#include "capture_control_server.h"
 
 namespace ddd::gui {
 namespace {
@@ -23,6 +26,11 @@ namespace {
 // WantsCoreApplication() below has to recognise two of them without a parser.
 constexpr const char* kStartCaptureName = "start-capture";
 constexpr const char* kStopCaptureName = "stop-capture";
+constexpr const char* kMonitorName = "monitor";
+constexpr const char* kMonitorRateName = "monitor-rate";
+constexpr const char* kMonitorPortName = "monitor-port";
+constexpr const char* kMetricsPortName = "metrics-port";
+constexpr const char* kQualifyName = "qualify";
 constexpr const char* kHeadlessName = "headless";
 constexpr const char* kCaptureDirectoryName = "capture-directory";
 constexpr const char* kCaptureNameName = "capture-name";
@@ -42,8 +50,10 @@ constexpr const char* kSigned16BitFormatWord = "s16";
 // The rates this build can capture at, derived from the decimation factors
 // rather than written out beside them: a factor added to capture_format.h
 // appears on the command line without anything having to be kept in step.
-constexpr int kSupportedDecimationFactors[] = {capture::kUndecimatedFactor,
-                                               capture::kTapeDecimationFactor};
+constexpr int kSupportedDecimationFactors[] = {
+    capture::kUndecimatedFactor, capture::kTapeDecimationFactor,
+    capture::kQuarterRateDecimationFactor,
+    capture::kEighthRateDecimationFactor};
 
 constexpr uint32_t kHzPerMsps = 1'000'000;
 
@@ -66,7 +76,10 @@ QString SupportedRateWords() {
   for (const int factor : kSupportedDecimationFactors) {
     rates.append(QString::number(MegasamplesPerSecondFor(factor)));
   }
-  return rates.join(QStringLiteral(" or "));
+  const QString last = rates.takeLast();
+  return rates.isEmpty() ? last
+                         : rates.join(QStringLiteral(", ")) +
+                               QStringLiteral(" or ") + last;
 }
 
 // Whether a raw argument is this option, in either of the spellings Qt's parser
@@ -95,6 +108,36 @@ CaptureCliOptionSet AddCaptureCliOptions(QCommandLineParser& parser) {
           QLatin1String(kStopCaptureName),
           QStringLiteral("Stop the capture a running instance is taking, wait "
                          "for its file to be finished, and exit.")),
+      QCommandLineOption(
+          QLatin1String(kMonitorName),
+          QStringLiteral("Watch a running instance instead of starting one: "
+                         "print the streams named, any of stats, spectrum and "
+                         "waveform separated by commas, a line per update."),
+          QStringLiteral("streams")),
+      QCommandLineOption(
+          QLatin1String(kMonitorRateName),
+          QStringLiteral("How many updates a second --monitor asks for, up to "
+                         "%1. The default is 2.")
+              .arg(capture::kMaximumMonitorRateHz),
+          QStringLiteral("hz")),
+      QCommandLineOption(
+          QLatin1String(kMonitorPortName),
+          QStringLiteral("Also take monitors on this TCP port, on this machine "
+                         "only. With --monitor, watch through it instead of "
+                         "the local socket."),
+          QStringLiteral("port")),
+      QCommandLineOption(
+          QLatin1String(kMetricsPortName),
+          QStringLiteral("Serve the capture's figures for a metrics scraper "
+                         "at /metrics on this TCP port, on this machine "
+                         "only."),
+          QStringLiteral("port")),
+      QCommandLineOption(
+          QLatin1String(kQualifyName),
+          QStringLiteral("Measure the capture folder's disk, the FLAC encoder "
+                         "and sample checking on this machine, save the "
+                         "buffer queue, compression level and encoder threads "
+                         "they support, and exit.")),
       QCommandLineOption(
           QLatin1String(kHeadlessName),
           QStringLiteral("Run with no window. Requires --start-capture, and "
@@ -130,6 +173,11 @@ CaptureCliOptionSet AddCaptureCliOptions(QCommandLineParser& parser) {
 
   parser.addOption(set.start_capture);
   parser.addOption(set.stop_capture);
+  parser.addOption(set.monitor);
+  parser.addOption(set.monitor_rate);
+  parser.addOption(set.monitor_port);
+  parser.addOption(set.metrics_port);
+  parser.addOption(set.qualify);
   parser.addOption(set.headless);
   parser.addOption(set.capture_directory);
   parser.addOption(set.capture_name);
@@ -148,6 +196,74 @@ CaptureCliParseResult ParseCaptureCliOptions(const QCommandLineParser& parser,
   options.start_capture = parser.isSet(set.start_capture);
   options.stop_capture = parser.isSet(set.stop_capture);
   options.headless = parser.isSet(set.headless);
+  options.qualify = parser.isSet(set.qualify);
+
+  if (parser.isSet(set.monitor)) {
+    const QStringList words =
+        parser.value(set.monitor).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString& word : words) {
+      const std::optional<capture::MonitorFrameType> stream =
+          ParseMonitorStreamName(word.trimmed().toLower());
+      if (!stream.has_value()) {
+        result.error = QStringLiteral(
+                           "Unknown --monitor stream '%1'. Use stats, "
+                           "spectrum or waveform, separated by commas.")
+                           .arg(word.trimmed());
+        return result;
+      }
+      if (std::find(options.monitor_streams.begin(),
+                    options.monitor_streams.end(),
+                    *stream) == options.monitor_streams.end()) {
+        options.monitor_streams.push_back(*stream);
+      }
+    }
+    if (options.monitor_streams.empty()) {
+      result.error = QStringLiteral(
+          "--monitor needs at least one of stats, spectrum or waveform.");
+      return result;
+    }
+  }
+
+  if (parser.isSet(set.monitor_rate)) {
+    const QString text = parser.value(set.monitor_rate).trimmed();
+    bool numeric = false;
+    const double rate = text.toDouble(&numeric);
+    if (!numeric || rate <= 0.0 || rate > capture::kMaximumMonitorRateHz) {
+      result.error = QStringLiteral(
+                         "Unknown --monitor-rate '%1'. Use more than 0 and up "
+                         "to %2 updates a second.")
+                         .arg(text)
+                         .arg(capture::kMaximumMonitorRateHz);
+      return result;
+    }
+    options.monitor_rate_hz = rate;
+  }
+
+  if (parser.isSet(set.monitor_port)) {
+    const QString text = parser.value(set.monitor_port).trimmed();
+    bool numeric = false;
+    const uint port = text.toUInt(&numeric);
+    if (!numeric || port < 1 || port > 65535) {
+      result.error =
+          QStringLiteral("Unknown --monitor-port '%1'. Use 1 to 65535.")
+              .arg(text);
+      return result;
+    }
+    options.monitor_port = static_cast<quint16>(port);
+  }
+
+  if (parser.isSet(set.metrics_port)) {
+    const QString text = parser.value(set.metrics_port).trimmed();
+    bool numeric = false;
+    const uint port = text.toUInt(&numeric);
+    if (!numeric || port < 1 || port > 65535) {
+      result.error =
+          QStringLiteral("Unknown --metrics-port '%1'. Use 1 to 65535.")
+              .arg(text);
+      return result;
+    }
+    options.metrics_port = static_cast<quint16>(port);
+  }
 
   if (parser.isSet(set.capture_directory)) {
     const QString directory = parser.value(set.capture_directory).trimmed();
@@ -257,6 +373,58 @@ CaptureCliParseResult ParseCaptureCliOptions(const QCommandLineParser& parser,
     return result;
   }
 
+  // --monitor is a client of an instance, like --stop-capture, and the same
+  // reasoning applies. The port is allowed, since it says how to reach the
+  // instance.
+  if (!options.monitor_streams.empty() &&
+      (options.start_capture || options.stop_capture || options.headless ||
+       options.HasAttributeOverrides())) {
+    result.error = QStringLiteral(
+        "--monitor watches an instance that is already running, so it cannot "
+        "be given with the options that start or stop one.");
+    return result;
+  }
+
+  if (options.monitor_rate_hz.has_value() && options.monitor_streams.empty()) {
+    result.error = QStringLiteral(
+        "--monitor-rate is how often --monitor asks for updates, and needs "
+        "--monitor.");
+    return result;
+  }
+
+  // Stopping is only ever taken over the socket, which only this user can
+  // reach. A port given beside it would suggest otherwise.
+  if (options.stop_capture && options.monitor_port.has_value()) {
+    result.error = QStringLiteral(
+        "--stop-capture only works through the local socket, so it cannot be "
+        "given with --monitor-port.");
+    return result;
+  }
+
+  // The page is served by the instance doing the capturing, and a client of
+  // one has nothing to serve.
+  if (options.metrics_port.has_value() &&
+      (options.stop_capture || !options.monitor_streams.empty())) {
+    result.error = QStringLiteral(
+        "--metrics-port is served by the instance that is capturing, so it "
+        "cannot be given with --stop-capture or --monitor.");
+    return result;
+  }
+
+  // --qualify measures and exits, so it runs nothing a client could reach and
+  // takes no name for a file. The folder, the rate and the format are what it
+  // measures for, and are allowed.
+  if (options.qualify &&
+      (options.start_capture || options.stop_capture || options.headless ||
+       !options.monitor_streams.empty() || options.monitor_port.has_value() ||
+       options.metrics_port.has_value() || options.capture_name.has_value() ||
+       options.duration_limit_seconds.has_value())) {
+    result.error = QStringLiteral(
+        "--qualify measures this machine and exits, so it can only be given "
+        "with --capture-directory, --sample-rate and --output-format.");
+    return result;
+  }
+
   if (options.headless && !options.start_capture) {
     result.error = QStringLiteral(
         "--headless needs --start-capture. Without a window and without a "
@@ -297,8 +465,12 @@ bool WantsCoreApplication(int argc, char* argv[]) {
       break;
     }
 
+    // --monitor takes its streams as a value, which the parser also accepts
+    // joined on with an equals sign.
     if (IsOptionToken(token, kHeadlessName) ||
-        IsOptionToken(token, kStopCaptureName)) {
+        IsOptionToken(token, kStopCaptureName) ||
+        IsOptionToken(token, kQualifyName) ||
+        IsOptionToken(token.section(QLatin1Char('='), 0, 0), kMonitorName)) {
       return true;
     }
   }
@@ -13,10 +13,13 @@
 
 #include <QCommandLineOption>
 #include <QString>
+#include <QtGlobal>
 #include <optional>
+#include <vector>
 
 #include "capture_format.h"
 #include "capture_settings.h"
+#include "monitor_protocol.h"
 
 class QCommandLineParser;
 
@@ -48,8 +51,12 @@ enum CaptureCliExit : int {
   // above because it is the only one where a file exists to go and look at.
   kExitCaptureFailed = 4,
 
-  // --stop-capture found nothing to stop.
+  // --stop-capture found nothing to stop, or --monitor nothing to watch.
   kExitNoRunningInstance = 5,
+
+  // --qualify found the machine short of the margins, or could not measure
+  // it. Nothing was saved; the report says what fell short.
+  kExitHostNotQualified = 6,
 };
 
 // Every capture option the command line accepts, kept together so that main()
@@ -60,6 +67,11 @@ enum CaptureCliExit : int {
 struct CaptureCliOptionSet {
   QCommandLineOption start_capture;
   QCommandLineOption stop_capture;
+  QCommandLineOption monitor;
+  QCommandLineOption monitor_rate;
+  QCommandLineOption monitor_port;
+  QCommandLineOption metrics_port;
+  QCommandLineOption qualify;
   QCommandLineOption headless;
   QCommandLineOption capture_directory;
   QCommandLineOption capture_name;
@@ -83,6 +95,23 @@ struct CaptureCliOptions {
   bool stop_capture = false;
   bool headless = false;
 
+  // Measure this machine and save the settings it supports. See
+  // RunHostQualification().
+  bool qualify = false;
+
+  // The streams --monitor named, in the order it named them. Empty when the
+  // command line is not a monitor.
+  std::vector<capture::MonitorFrameType> monitor_streams;
+  std::optional<double> monitor_rate_hz;
+
+  // For an instance, a TCP port to take monitors on as well as the socket; for
+  // --monitor, the port to watch through instead of the socket.
+  std::optional<quint16> monitor_port;
+
+  // For an instance, a TCP port to serve the metrics page on. See
+  // MetricsServer.
+  std::optional<quint16> metrics_port;
+
   std::optional<QString> capture_directory;
   std::optional<QString> capture_name;
 
@@ -132,14 +161,15 @@ void ApplyCliOverrides(CaptureSettings& settings,
 // Whether this command line asks for something that needs no display.
 //
 // Read before any application object exists, because which one to construct is
-// the question it answers: a headless capture and a --stop-capture client both
-// run under a QCoreApplication, and a QApplication would need a platform plugin
-// neither of them has any use for — on a machine with no display, the
-// difference between working and refusing to start.
+// the question it answers: a headless capture, a --stop-capture client, a
+// --monitor client and --qualify all run under a QCoreApplication, and a
+// QApplication would need a platform plugin none of them has any use for — on
+// a machine with no display, the difference between working and refusing to
+// start.
 //
 // A scan of the raw arguments rather than a parse, since QCommandLineParser
 // needs the application it is about to decide on. It is deliberately literal:
-// it recognises the two switches exactly as the parser accepts them, and
+// it recognises the four switches exactly as the parser accepts them, and
 // anything else it sees is left for the parser to complain about properly.
 bool WantsCoreApplication(int argc, char* argv[]);
 
@@ -13,6 +13,8 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QHostAddress>
+#include <QIODevice>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
@@ -21,10 +23,18 @@
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
 #include <QtGlobal>
+#include <algorithm>
+#include <utility>
 
+#include "analysis_worker.h"
 #include "capture_controller.h"
 #include "logger.h"
+#include "spectrum_analyser.h"
+#include "waveform_mapping.h"
 
 namespace ddd::gui {
 namespace {
@@ -34,6 +44,10 @@ constexpr const char* kOkKey = "ok";
 constexpr const char* kFileKey = "file";
 constexpr const char* kBytesKey = "bytes";
 constexpr const char* kErrorKey = "error";
+constexpr const char* kStreamKey = "stream";
+constexpr const char* kRateKey = "rate_hz";
+constexpr const char* kBinsKey = "bins";
+constexpr const char* kPointsKey = "points";
 
 // How long to wait for something to answer on a socket that is already there.
 // Short, and deliberately: this runs before a scripted capture can start, and
@@ -51,6 +65,14 @@ constexpr int kFlushTimeoutMilliseconds = 1000;
 // to meet it would be a way to spend this application's memory from outside it.
 constexpr int kMaximumRequestBytes = 4096;
 
+// How far ahead of a monitoring client the socket's own buffer may get before
+// frames are held back in its outbox instead. A waveform at full size is
+// 16 KiB, so this is a few frames: enough that a client keeping up is never
+// waiting on the queue, and little enough that one not keeping up has its
+// backlog in the outbox, where the oldest of it is dropped, rather than in a
+// socket buffer where nothing ever is.
+constexpr qint64 kMonitorWriteAheadBytes = 64 * 1024;
+
 QString ToLine(const QJsonObject& object) {
   return QString::fromUtf8(
              QJsonDocument(object).toJson(QJsonDocument::Compact)) +
@@ -120,6 +142,104 @@ QString FormatControlReplyError(const QString& message) {
   return ToLine(object);
 }
 
+QString MonitorStreamName(capture::MonitorFrameType stream) {
+  switch (stream) {
+    case capture::MonitorFrameType::kStats:
+      return QStringLiteral("stats");
+    case capture::MonitorFrameType::kSpectrum:
+      return QStringLiteral("spectrum");
+    case capture::MonitorFrameType::kWaveform:
+      return QStringLiteral("waveform");
+    case capture::MonitorFrameType::kReply:
+      break;
+  }
+  return QString();
+}
+
+std::optional<capture::MonitorFrameType> ParseMonitorStreamName(
+    const QString& name) {
+  for (const capture::MonitorFrameType stream :
+       {capture::MonitorFrameType::kStats, capture::MonitorFrameType::kSpectrum,
+        capture::MonitorFrameType::kWaveform}) {
+    if (name == MonitorStreamName(stream)) {
+      return stream;
+    }
+  }
+  return std::nullopt;
+}
+
+QString FormatMonitorSubscribe(const MonitorSubscription& subscription) {
+  QJsonObject object;
+  object.insert(QLatin1String(kVerbKey), QLatin1String(kSubscribeVerb));
+  object.insert(QLatin1String(kStreamKey),
+                MonitorStreamName(subscription.stream));
+  object.insert(QLatin1String(kRateKey), subscription.rate_hz);
+  if (subscription.stream == capture::MonitorFrameType::kSpectrum) {
+    object.insert(QLatin1String(kBinsKey),
+                  static_cast<qint64>(subscription.size));
+  } else if (subscription.stream == capture::MonitorFrameType::kWaveform) {
+    object.insert(QLatin1String(kPointsKey),
+                  static_cast<qint64>(subscription.size));
+  }
+  return ToLine(object);
+}
+
+std::optional<MonitorSubscription> ParseMonitorSubscription(
+    const QByteArray& line) {
+  const std::optional<QJsonObject> object = ToObject(line);
+  if (!object.has_value()) {
+    return std::nullopt;
+  }
+
+  const QString verb = object->value(QLatin1String(kVerbKey)).toString();
+  const bool subscribe = verb == QLatin1String(kSubscribeVerb);
+  if (!subscribe && verb != QLatin1String(kUnsubscribeVerb)) {
+    return std::nullopt;
+  }
+
+  const std::optional<capture::MonitorFrameType> stream =
+      ParseMonitorStreamName(
+          object->value(QLatin1String(kStreamKey)).toString());
+  if (!stream.has_value()) {
+    return std::nullopt;
+  }
+
+  MonitorSubscription subscription;
+  subscription.stream = *stream;
+  if (!subscribe) {
+    return subscription;
+  }
+
+  const QJsonValue rate = object->value(QLatin1String(kRateKey));
+  if (!rate.isDouble() || rate.toDouble() < 0.0 ||
+      rate.toDouble() > capture::kMaximumMonitorRateHz) {
+    return std::nullopt;
+  }
+  subscription.rate_hz = rate.toDouble();
+
+  // Whichever size the stream takes, checked against what it may be. A stats
+  // subscription has none and ignores one given.
+  const bool spectrum = *stream == capture::MonitorFrameType::kSpectrum;
+  const QJsonValue size = object->value(
+      QLatin1String(spectrum ? kBinsKey : kPointsKey));
+  const qint64 limit = spectrum ? capture::kMaximumMonitorBins
+                                : capture::kMaximumMonitorPoints;
+  if (*stream != capture::MonitorFrameType::kStats && !size.isUndefined()) {
+    if (!size.isDouble() || size.toInteger(-1) < 0 ||
+        size.toInteger() > limit) {
+      return std::nullopt;
+    }
+    subscription.size = static_cast<uint32_t>(size.toInteger());
+  }
+  return subscription;
+}
+
+QString FormatControlReplyOk() {
+  QJsonObject object;
+  object.insert(QLatin1String(kOkKey), true);
+  return ToLine(object);
+}
+
 std::optional<ControlReply> ParseControlReply(const QByteArray& line) {
   const std::optional<QJsonObject> object = ToObject(line);
   if (!object.has_value()) {
@@ -160,12 +280,35 @@ CaptureControlServer::CaptureControlServer(CaptureController* controller,
   // being relied on here. RestrictToOwner() puts the access bits back.
   connect(server_, &QLocalServer::newConnection, this,
           &CaptureControlServer::OnNewConnection);
+
+  clock_.start();
+
+  // What the monitors are sent is what the window is already being sent: the
+  // stats the controller's timer reads, and the waveform and spectrum the
+  // analysis thread works out from the pipeline's snapshots. Nothing here reads
+  // the pipeline itself, so a roomful of monitors costs the capture nothing.
+  if (controller_ != nullptr) {
+    connect(controller_, &CaptureController::StatsUpdated, this,
+            &CaptureControlServer::OnStats);
+    if (AnalysisWorker* const analysis = controller_->analysis()) {
+      connect(analysis, &AnalysisWorker::WaveformReady, this,
+              &CaptureControlServer::OnWaveform);
+      connect(analysis, &AnalysisWorker::SpectrumReady, this,
+              [this](const std::vector<double>& magnitudes_db,
+                     const std::vector<double>& /*peak_hold_db*/,
+                     const std::vector<double>& /*snapshot_db*/,
+                     size_t /*segments*/) { OnSpectrum(magnitudes_db); });
+    }
+  }
 }
 
 CaptureControlServer::~CaptureControlServer() {
   // Explicitly, so the socket is taken out of the filesystem now rather than
   // whenever the object graph unwinds. The next instance to start looks for it.
   server_->close();
+  if (monitor_server_ != nullptr) {
+    monitor_server_->close();
+  }
 }
 
 QString CaptureControlServer::ServerName() {
@@ -319,13 +462,39 @@ QString CaptureControlServer::name() const {
   return server_->isListening() ? server_->serverName() : QString();
 }
 
-void CaptureControlServer::OnNewConnection() {
-  while (QLocalSocket* socket = server_->nextPendingConnection()) {
-    partial_.insert(socket, QByteArray());
+bool CaptureControlServer::ListenForMonitors(quint16 port, QString* error) {
+  if (monitor_server_ == nullptr) {
+    monitor_server_ = new QTcpServer(this);
+    connect(monitor_server_, &QTcpServer::newConnection, this,
+            &CaptureControlServer::OnNewMonitorConnection);
+  }
+  if (monitor_server_->isListening()) {
+    return true;
+  }
+
+  // The loopback address and nothing else. A monitor on another machine
+  // reaches this through a tunnel it has had to log in to make, rather than
+  // through a port open to whoever is on the network.
+  if (monitor_server_->listen(QHostAddress::LocalHost, port)) {
+    return true;
+  }
+  if (error != nullptr) {
+    *error = QStringLiteral("The monitor port %1 could not be opened: %2")
+                 .arg(port)
+                 .arg(monitor_server_->errorString());
+  }
+  return false;
+}
 
-    connect(socket, &QLocalSocket::readyRead, this,
-            [this, socket] { OnReadyRead(socket); });
+quint16 CaptureControlServer::monitor_port() const {
+  return monitor_server_ != nullptr && monitor_server_->isListening()
+             ? monitor_server_->serverPort()
+             : 0;
+}
 
+void CaptureControlServer::OnNewConnection() {
+  while (QLocalSocket* socket = server_->nextPendingConnection()) {
+    Adopt(socket);
     connect(socket, &QLocalSocket::disconnected, this, [this, socket] {
       Forget(socket);
       socket->deleteLater();
@@ -333,26 +502,63 @@ void CaptureControlServer::OnNewConnection() {
   }
 }
 
-void CaptureControlServer::OnReadyRead(QLocalSocket* socket) {
-  QByteArray& buffered = partial_[socket];
-  buffered.append(socket->readAll());
+void CaptureControlServer::OnNewMonitorConnection() {
+  while (QTcpSocket* socket = monitor_server_->nextPendingConnection()) {
+    remote_.insert(socket);
+    Adopt(socket);
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket] {
+      Forget(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void CaptureControlServer::Adopt(QIODevice* socket) {
+  partial_.insert(socket, QByteArray());
+  connect(socket, &QIODevice::readyRead, this,
+          [this, socket] { OnReadyRead(socket); });
+  connect(socket, &QIODevice::bytesWritten, this,
+          [this, socket] { Drain(socket); });
+}
+
+void CaptureControlServer::OnReadyRead(QIODevice* socket) {
+  // Worked on as a copy rather than in place. Answering a line can flush the
+  // socket, a flush that finds the client gone emits the disconnected that
+  // forgets it, and forgetting it frees the entry this would still be reading.
+  if (!partial_.contains(socket)) {
+    return;
+  }
+  QByteArray buffered = partial_.value(socket) + socket->readAll();
 
   qsizetype newline = buffered.indexOf('\n');
   while (newline >= 0) {
     const QByteArray line = buffered.left(newline);
     buffered.remove(0, newline + 1);
     HandleRequest(socket, line);
+    if (!partial_.contains(socket)) {
+      return;
+    }
     newline = buffered.indexOf('\n');
   }
 
   if (buffered.size() > kMaximumRequestBytes) {
+    // Refused once. Whatever arrives while the connection closes is read and
+    // dropped: taken as requests it would be buffered afresh and refused a
+    // second time, and left unread the socket would go on buffering it anyway.
+    partial_.remove(socket);
+    disconnect(socket, &QIODevice::readyRead, this, nullptr);
+    connect(socket, &QIODevice::readyRead, this,
+            [socket] { socket->skip(socket->bytesAvailable()); });
     Reply(socket,
           FormatControlReplyError(QStringLiteral("That is not a request.")));
-    socket->disconnectFromServer();
+    Disconnect(socket);
+    return;
   }
+
+  partial_.insert(socket, buffered);
 }
 
-void CaptureControlServer::HandleRequest(QLocalSocket* socket,
+void CaptureControlServer::HandleRequest(QIODevice* socket,
                                          const QByteArray& line) {
   const std::optional<QString> verb = ParseControlVerb(line);
   if (!verb.has_value()) {
@@ -366,13 +572,31 @@ void CaptureControlServer::HandleRequest(QLocalSocket* socket,
     return;
   }
 
+  if (*verb == QLatin1String(kMonitorVerb)) {
+    HandleMonitor(socket);
+    return;
+  }
+
+  if (*verb == QLatin1String(kSubscribeVerb) ||
+      *verb == QLatin1String(kUnsubscribeVerb)) {
+    HandleSubscription(socket, line);
+    return;
+  }
+
   // Answered rather than ignored: a client asking for something this build does
   // not do should be told so, not left waiting for a reply that is not coming.
   Reply(socket, FormatControlReplyError(
                     QStringLiteral("Unknown request '%1'.").arg(*verb)));
 }
 
-void CaptureControlServer::HandleStop(QLocalSocket* socket) {
+void CaptureControlServer::HandleStop(QIODevice* socket) {
+  if (remote_.contains(socket)) {
+    Reply(socket, FormatControlReplyError(QStringLiteral(
+                      "The monitor port can only monitor. Stop the capture "
+                      "through the local socket.")));
+    return;
+  }
+
   if (controller_ == nullptr || !controller_->capturing()) {
     Reply(socket,
           FormatControlReplyError(QStringLiteral("No capture is running.")));
@@ -403,17 +627,214 @@ void CaptureControlServer::HandleStop(QLocalSocket* socket) {
   controller_->StopCapture();
 }
 
-void CaptureControlServer::Forget(QLocalSocket* socket) {
+void CaptureControlServer::HandleMonitor(QIODevice* socket) {
+  if (monitors_.contains(socket)) {
+    Reply(socket, FormatControlReplyOk());
+    return;
+  }
+
+  // The last line this connection is sent. Written before the switch, so that
+  // the client reads it as the line it asked for and everything after it as
+  // frames.
+  Reply(socket, FormatControlReplyOk());
+  monitors_.insert(socket, std::make_shared<Monitor>());
+}
+
+void CaptureControlServer::HandleSubscription(QIODevice* socket,
+                                              const QByteArray& line) {
+  const auto monitor = monitors_.value(socket);
+  if (monitor == nullptr) {
+    Reply(socket, FormatControlReplyError(QStringLiteral(
+                      "Ask to monitor before subscribing to anything.")));
+    return;
+  }
+
+  const std::optional<MonitorSubscription> subscription =
+      ParseMonitorSubscription(line);
+  if (!subscription.has_value()) {
+    Reply(socket, FormatControlReplyError(QStringLiteral(
+                      "That is not a stream and a rate this can send.")));
+    return;
+  }
+
+  const size_t stream = capture::MonitorStreamIndex(subscription->stream);
+  monitor->limiters[stream].SetRate(subscription->rate_hz);
+  monitor->sizes[stream] = subscription->size;
+  Reply(socket, FormatControlReplyOk());
+}
+
+bool CaptureControlServer::Due(Monitor& monitor,
+                               capture::MonitorFrameType stream) {
+  const double now = static_cast<double>(clock_.nsecsElapsed()) / 1e9;
+  return monitor.limiters[capture::MonitorStreamIndex(stream)].Admit(now);
+}
+
+void CaptureControlServer::OnStats(const capture::CaptureStats& stats) {
+  // Encoded once, and only if somebody is due one: the figures are the same
+  // for every client, where a spectrum or a waveform is built to each one's
+  // size.
+  std::vector<uint8_t> frame;
+  for (auto it = monitors_.begin(); it != monitors_.end(); ++it) {
+    if (!Due(*it.value(), capture::MonitorFrameType::kStats)) {
+      continue;
+    }
+    if (frame.empty()) {
+      capture::EncodeMonitorStats(capture::MonitorStatsFrom(stats), frame);
+    }
+    Queue(it.key(), *it.value(), frame);
+  }
+}
+
+void CaptureControlServer::OnWaveform(const std::vector<uint16_t>& codes) {
+  if (codes.empty()) {
+    return;
+  }
+  const size_t stream =
+      capture::MonitorStreamIndex(capture::MonitorFrameType::kWaveform);
+
+  std::vector<analysis::WaveformColumn> columns;
+  for (auto it = monitors_.begin(); it != monitors_.end(); ++it) {
+    Monitor& monitor = *it.value();
+    if (!Due(monitor, capture::MonitorFrameType::kWaveform)) {
+      continue;
+    }
+
+    // The scope's own reduction, one column per point asked for. Never more
+    // columns than samples, since a column with nothing in it has nothing to
+    // say.
+    const uint32_t asked = monitor.sizes[stream];
+    analysis::WaveformMapping mapping;
+    mapping.width_pixels = static_cast<int>(
+        std::min<size_t>(asked == 0 ? capture::kMaximumMonitorPoints : asked,
+                         codes.size()));
+    mapping.height_pixels = 1;
+    mapping.sample_span = codes.size();
+    analysis::DecimateToColumns(codes.data(), codes.size(), mapping, columns);
+
+    capture::MonitorWaveform waveform;
+    waveform.sample_span = static_cast<uint32_t>(codes.size());
+    waveform.minimum.reserve(columns.size());
+    waveform.maximum.reserve(columns.size());
+    for (const analysis::WaveformColumn& column : columns) {
+      waveform.minimum.push_back(column.minimum);
+      waveform.maximum.push_back(column.maximum);
+    }
+
+    std::vector<uint8_t> frame;
+    capture::EncodeMonitorWaveform(waveform, frame);
+    Queue(it.key(), monitor, std::move(frame));
+  }
+}
+
+void CaptureControlServer::OnSpectrum(
+    const std::vector<double>& magnitudes_db) {
+  if (magnitudes_db.size() < 2) {
+    return;
+  }
+  const size_t stream =
+      capture::MonitorStreamIndex(capture::MonitorFrameType::kSpectrum);
+
+  // DC to Nyquist in transform_size / 2 + 1 bins, so the transform size is
+  // recoverable from the levels alone and the width follows from it
+  const size_t transform_size = 2 * (magnitudes_db.size() - 1);
+  const uint32_t sample_rate_hz =
+      controller_ != nullptr ? controller_->settings().SampleRateHz()
+                             : capture::kSampleRateHz;
+
+  for (auto it = monitors_.begin(); it != monitors_.end(); ++it) {
+    Monitor& monitor = *it.value();
+    if (!Due(monitor, capture::MonitorFrameType::kSpectrum)) {
+      continue;
+    }
+
+    capture::ReduceMonitorSpectrum(magnitudes_db, monitor.sizes[stream],
+                                   reduced_spectrum_);
+
+    // Wider bins when fewer were asked for: the same span of frequency,
+    // divided fewer ways
+    capture::MonitorSpectrum spectrum;
+    spectrum.bin_width_hz = analysis::SpectrumAnalyser::BinSpacingHz(
+                                transform_size, sample_rate_hz) *
+                            static_cast<double>(magnitudes_db.size()) /
+                            static_cast<double>(reduced_spectrum_.size());
+    spectrum.centi_db = reduced_spectrum_;
+
+    std::vector<uint8_t> frame;
+    capture::EncodeMonitorSpectrum(spectrum, frame);
+    Queue(it.key(), monitor, std::move(frame));
+  }
+}
+
+void CaptureControlServer::Queue(QIODevice* socket, Monitor& monitor,
+                                 std::vector<uint8_t> frame) {
+  // Refused only when the client has left a full outbox of replies unread: it
+  // is asking for things and not reading them, and there is no way to tell it
+  // so that it would see.
+  if (!monitor.outbox.Push(std::move(frame))) {
+    if (logger_ != nullptr) {
+      logger_->Warning(
+          "Dropping a monitoring connection: it has stopped reading replies.");
+    }
+    Abandon(socket);
+    return;
+  }
+  Drain(socket);
+}
+
+void CaptureControlServer::Drain(QIODevice* socket) {
+  const auto monitor = monitors_.value(socket);
+  if (monitor == nullptr || !socket->isOpen()) {
+    return;
+  }
+
+  std::vector<uint8_t> frame;
+  while (socket->bytesToWrite() < kMonitorWriteAheadBytes &&
+         monitor->outbox.Pop(frame)) {
+    socket->write(reinterpret_cast<const char*>(frame.data()),
+                  static_cast<qint64>(frame.size()));
+  }
+}
+
+void CaptureControlServer::Forget(QIODevice* socket) {
   partial_.remove(socket);
+  remote_.remove(socket);
+  monitors_.remove(socket);
+}
+
+void CaptureControlServer::Disconnect(QIODevice* socket) {
+  if (auto* const local = qobject_cast<QLocalSocket*>(socket)) {
+    local->disconnectFromServer();
+  } else if (auto* const tcp = qobject_cast<QTcpSocket*>(socket)) {
+    tcp->disconnectFromHost();
+  }
+}
+
+void CaptureControlServer::Abandon(QIODevice* socket) {
+  // Not from here: this is reached from inside OnReadyRead, which is still
+  // working through the socket's buffered lines, and an abort emits the
+  // disconnected that forgets them.
+  QTimer::singleShot(0, socket, [socket] {
+    if (auto* const local = qobject_cast<QLocalSocket*>(socket)) {
+      local->abort();
+    } else if (auto* const tcp = qobject_cast<QTcpSocket*>(socket)) {
+      tcp->abort();
+    }
+  });
 }
 
-void CaptureControlServer::Reply(QLocalSocket* socket, const QString& line) {
-  if (socket == nullptr || socket->state() != QLocalSocket::ConnectedState) {
+void CaptureControlServer::Reply(QIODevice* socket, const QString& line) {
+  if (socket == nullptr || !socket->isOpen()) {
+    return;
+  }
+
+  if (const auto monitor = monitors_.value(socket)) {
+    std::vector<uint8_t> frame;
+    capture::EncodeMonitorReply(line.trimmed().toStdString(), frame);
+    Queue(socket, *monitor, std::move(frame));
     return;
   }
 
   socket->write(line.toUtf8());
-  socket->flush();
 
   // A headless run quits as soon as the capture it was asked to stop has
   // finished, which can be the same turn of the event loop this reply is
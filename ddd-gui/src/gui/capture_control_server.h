@@ -12,14 +12,23 @@
 #pragma once
 
 #include <QByteArray>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QString>
 #include <QtGlobal>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <vector>
 
+#include "monitor_protocol.h"
+
+class QIODevice;
 class QLocalServer;
-class QLocalSocket;
+class QTcpServer;
 
 namespace ddd::capture {
 class ILogger;
@@ -50,6 +59,50 @@ class CaptureController;
 // application is told, instead of waiting for a reply that is never coming.
 inline constexpr const char* kStopVerb = "stop";
 
+// --- Monitoring -----------------------------------------------------------
+//
+// The same socket also serves anything that wants to watch a capture rather
+// than stop it — a script logging the levels through a long batch, a second
+// machine showing the spectrum across the room. The exchange goes:
+//
+//   request   {"verb":"monitor"}
+//   reply     {"ok":true}
+//   request   {"verb":"subscribe","stream":"spectrum","rate_hz":5,"bins":256}
+//   request   {"verb":"subscribe","stream":"waveform","rate_hz":2,"points":512}
+//   request   {"verb":"subscribe","stream":"stats","rate_hz":1}
+//   request   {"verb":"unsubscribe","stream":"spectrum"}
+//
+// After the monitor reply, everything the server sends on that connection is a
+// binary frame (see monitor_protocol.h), replies included; what the client
+// sends stays a JSON line. A subscription to a stream already subscribed to
+// replaces it, and a rate of zero is the same as unsubscribing.
+inline constexpr const char* kMonitorVerb = "monitor";
+inline constexpr const char* kSubscribeVerb = "subscribe";
+inline constexpr const char* kUnsubscribeVerb = "unsubscribe";
+
+// One stream, at one rate, at one size: bins for a spectrum, columns for a
+// waveform, and nothing for stats. A size of zero is the source's own.
+struct MonitorSubscription {
+  capture::MonitorFrameType stream = capture::MonitorFrameType::kStats;
+  double rate_hz = 0.0;
+  uint32_t size = 0;
+};
+
+// "stats", "spectrum" or "waveform", and back.
+QString MonitorStreamName(capture::MonitorFrameType stream);
+std::optional<capture::MonitorFrameType> ParseMonitorStreamName(
+    const QString& name);
+
+QString FormatMonitorSubscribe(const MonitorSubscription& subscription);
+
+// The subscription a subscribe or unsubscribe line asks for — an unsubscribe
+// reads as a rate of zero — or nothing when the line is neither, names a
+// stream there is not, or asks for a rate or a size out of range.
+std::optional<MonitorSubscription> ParseMonitorSubscription(
+    const QByteArray& line);
+
+QString FormatControlReplyOk();
+
 // A request line, terminated. Never empty.
 QString FormatControlRequest(const QString& verb);
 
@@ -87,6 +140,13 @@ std::optional<ControlReply> ParseControlReply(const QByteArray& line);
 // one device is not something either of them can do, so a scripted start that
 // finds the socket taken says so and exits rather than racing for the USB
 // claim. That is why Listen() reports failure rather than merely logging it.
+//
+// A connection may instead ask to monitor, and is then sent the capture's
+// figures, spectrum and waveform at the rates it subscribed to. Nothing about
+// that can slow the capture: the frames are built from what the stats timer
+// and the analysis thread have already produced for the window, on the GUI
+// thread, and each client's frames wait in a small queue of their own that
+// loses its oldest rather than growing when the client falls behind.
 class CaptureControlServer : public QObject {
   Q_OBJECT
 
@@ -126,12 +186,54 @@ class CaptureControlServer : public QObject {
   // The name being listened on, or empty. For the tests and the log.
   QString name() const;
 
+  // Also take monitoring clients on a TCP port, on the loopback interface only.
+  //
+  // For a client that cannot open a local socket — one in a container, or a
+  // tool on the far side of an SSH tunnel — and for nothing else: a connection
+  // that arrives this way may monitor and may not stop the capture, because
+  // anything on this machine can reach a TCP port and only this user can reach
+  // the socket. Port 0 takes whatever port is free; monitor_port() says which.
+  bool ListenForMonitors(quint16 port, QString* error);
+
+  // The port being listened on for monitors, or 0.
+  quint16 monitor_port() const;
+
+  // How many connections are currently monitoring. For the tests.
+  int monitor_count() const { return static_cast<int>(monitors_.size()); }
+
  private:
+  // What one monitoring connection asked for, and what is waiting to go to it.
+  struct Monitor {
+    capture::MonitorOutbox outbox;
+    std::array<capture::MonitorRateLimiter, capture::kMonitorStreamCount>
+        limiters;
+    std::array<uint32_t, capture::kMonitorStreamCount> sizes{};
+  };
+
   void OnNewConnection();
-  void OnReadyRead(QLocalSocket* socket);
-  void HandleRequest(QLocalSocket* socket, const QByteArray& line);
-  void HandleStop(QLocalSocket* socket);
-  void Forget(QLocalSocket* socket);
+  void OnNewMonitorConnection();
+  void Adopt(QIODevice* socket);
+  void OnReadyRead(QIODevice* socket);
+  void HandleRequest(QIODevice* socket, const QByteArray& line);
+  void HandleStop(QIODevice* socket);
+  void HandleMonitor(QIODevice* socket);
+  void HandleSubscription(QIODevice* socket, const QByteArray& line);
+  void Forget(QIODevice* socket);
+
+  // The sources. Each builds a frame for each monitor that is due one, to the
+  // size that monitor asked for, and queues it.
+  void OnStats(const capture::CaptureStats& stats);
+  void OnWaveform(const std::vector<uint16_t>& codes);
+  void OnSpectrum(const std::vector<double>& magnitudes_db);
+
+  // Whether this stream is due for this monitor now, by its own rate.
+  bool Due(Monitor& monitor, capture::MonitorFrameType stream);
+
+  void Queue(QIODevice* socket, Monitor& monitor, std::vector<uint8_t> frame);
+
+  // Hand queued frames to the socket for as long as it is keeping up. Run
+  // again whenever the socket says it has written some.
+  void Drain(QIODevice* socket);
 
   // Take the socket's access bits down to this user, once it exists.
   void RestrictToOwner();
@@ -140,16 +242,40 @@ class CaptureControlServer : public QObject {
   // capture it was asked to stop has finished, which can be within the same
   // turn of the event loop as this reply — so the bytes are pushed out here
   // rather than left for a socket that is about to be destroyed.
-  void Reply(QLocalSocket* socket, const QString& line);
+  //
+  // On a monitoring connection the line goes as a reply frame, through the
+  // same queue as everything else on it so that it cannot land in the middle of
+  // a frame.
+  void Reply(QIODevice* socket, const QString& line);
+
+  // Close a connection, whichever kind it is.
+  static void Disconnect(QIODevice* socket);
+
+  // Close a connection without waiting to send what is queued for it — which
+  // Disconnect does, and a client that is not reading would never let finish.
+  static void Abandon(QIODevice* socket);
 
   CaptureController* controller_ = nullptr;
   capture::ILogger* logger_ = nullptr;
   QLocalServer* server_ = nullptr;
+  QTcpServer* monitor_server_ = nullptr;
 
   // What has arrived on each connection but is not yet a whole line. A request
   // is one short line and almost always arrives in one piece, but "almost
   // always" is not something a protocol may be written against.
-  QHash<QLocalSocket*, QByteArray> partial_;
+  QHash<QIODevice*, QByteArray> partial_;
+
+  // Connections that arrived over TCP, and may not stop anything.
+  QSet<QIODevice*> remote_;
+
+  // Connections that have switched to monitoring.
+  QHash<QIODevice*, std::shared_ptr<Monitor>> monitors_;
+
+  // The rate limiters' clock
+  QElapsedTimer clock_;
+
+  // Scratch for building frames, reused from one to the next
+  std::vector<int16_t> reduced_spectrum_;
 };
 
 }  // namespace ddd::gui
@@ -21,7 +21,10 @@
 #include "capture_format.h"
 #include "capture_metadata.h"
 #include "capture_naming.h"
+#include "capture_overview.h"
 #include "capture_provenance.h"
+#include "code_linearity.h"
+#include "disk_buffer_ring.h"
 #include "firmware_version.h"
 #include "free_space.h"
 #include "gain_choices.h"
@@ -94,7 +97,8 @@ void CaptureController::Start() {
     return;
   }
 
-  monitor_ = std::make_unique<capture::DeviceMonitor>(device_, logger_);
+  monitor_ = std::make_unique<capture::DeviceMonitor>(
+      device_, logger_, capture::MakeHotplugEvents(logger_));
   monitor_->Start([this](const std::vector<capture::DeviceInfo>& devices) {
     // This runs on the monitor's thread. Everything past this point is on the
     // GUI thread, which is the whole reason the hop exists: a QWidget touched
@@ -113,6 +117,16 @@ void CaptureController::SetDeviceMonitorSuspended(bool suspended) {
   }
 }
 
+void CaptureController::SetFieldPreviewWanted(bool wanted) {
+  field_preview_wanted_ = wanted;
+
+  // Between runs the pipeline still holds the last run's tap, and enabling
+  // that would allocate a pool nothing will ever fill
+  if (monitoring_) {
+    pipeline_->field_snapshots().SetEnabled(wanted);
+  }
+}
+
 void CaptureController::SetSettings(const CaptureSettings& settings) {
   settings_ = settings;
   SaveCaptureSettings(settings_);
@@ -137,6 +151,39 @@ void CaptureController::SetDiscScan(const capture::DiscScan& disc) {
   disc_scan_ = disc;
 }
 
+void CaptureController::SetAddressing(const std::string& addressing) {
+  addressing_ = addressing;
+}
+
+uint64_t CaptureController::CapturePosition() const {
+  if (!capturing_ || pipeline_ == nullptr) {
+    return 0;
+  }
+
+  // Full slots, each counted in the run's wire format: a packed slot holds
+  // fewer bytes a sample than a word slot, and an in-band one a few samples
+  // fewer again
+  const capture::CaptureStats stats = pipeline_->stats().Read();
+  const uint64_t queued =
+      static_cast<uint64_t>(stats.slots_in_use) * pipeline_->SlotSamples();
+  return stats.metrics.capture_sample_count + queued;
+}
+
+uint64_t CaptureController::RingSlotSamples() const {
+  if (!monitoring_ || pipeline_ == nullptr) {
+    return 0;
+  }
+  return pipeline_->SlotSamples();
+}
+
+void CaptureController::RecordPlayerAddress(int32_t address,
+                                            uint64_t sent_position) {
+  if (!capturing_ || pending_metadata_.addresses.addressing.empty()) {
+    return;
+  }
+  address_index_.Add(address, sent_position, CapturePosition());
+}
+
 void CaptureController::OnDevicesChanged(
     const std::vector<capture::DeviceInfo>& devices) {
   devices_ = devices;
@@ -275,7 +322,8 @@ void CaptureController::StartMonitoring() {
   // Decimation is the device's to do, not this application's. Halving the rate
   // means low-passing the signal at 10 MHz first, or everything above that
   // folds down on top of the signal — and that filter is in the FPGA, where it
-  // costs 13% of the logic and no CPU at all.
+  // costs 13% of the logic and no CPU at all. 4:1 and 8:1 are the same filter
+  // behind shorter stages of its own kind.
   if (!device_->WriteRegister(
           path, capture::kRegisterDecimation,
           static_cast<uint8_t>(settings_.decimation_factor))) {
@@ -286,6 +334,75 @@ void CaptureController::StartMonitoring() {
     return;
   }
 
+  // And read back when decimating, because a factor the gateware does not
+  // implement is normalised to every sample rather than refused: an image from
+  // before 4:1 and 8:1 would stream at 40 Msps into a file labelled 5, and
+  // nothing downstream could tell. A device that cannot answer at all has no
+  // register bank to ask and is taken at its word, as it always was.
+  if (settings_.decimation_factor != capture::kUndecimatedFactor) {
+    std::vector<uint8_t> reported;
+    if (device_->ReadRegisters(path, capture::kRegisterDecimation, 1,
+                               reported) &&
+        reported.size() == 1 &&
+        reported[0] != static_cast<uint8_t>(settings_.decimation_factor)) {
+      emit Failed(tr("The sample rate is not available"),
+                  tr("The device's gateware cannot capture at %1 MSPS. Update "
+                     "the FPGA, or choose another sample rate.")
+                      .arg(capture::SampleRateHzFor(
+                               settings_.decimation_factor) /
+                           1'000'000));
+      return;
+    }
+  }
+
+  // The wire format, on the same terms again — and then read back, because the
+  // answer is the device's to give. Gateware that cannot pack reads 0x00
+  // whatever it was sent, and firmware that predates the register refuses the
+  // write outright. Either way the capture goes ahead one word per sample,
+  // which every device can do; unpacking a stream that is not packed, or
+  // failing to, would lose the capture for nothing.
+  //
+  // Written as words too when words are wanted, so that a device a previous
+  // session left packing is put back. A refusal of that write is the old
+  // firmware, which cannot have been packing.
+  capture::WireFormat wire_format = capture::WireFormat::kWords;
+  if (settings_.packed_wire) {
+    std::vector<uint8_t> reported;
+    if (device_->WriteRegister(path, capture::kRegisterWireFormat,
+                               capture::kWireFormatPacked) &&
+        device_->ReadRegisters(path, capture::kRegisterWireFormat, 1,
+                               reported) &&
+        reported.size() == 1 && reported[0] == capture::kWireFormatPacked) {
+      wire_format = capture::WireFormat::kPacked;
+    } else if (logger_ != nullptr) {
+      logger_->Warning(
+          "The packed wire format was asked for, but the device does not "
+          "offer it; streaming one word per sample");
+    }
+  } else {
+    device_->WriteRegister(path, capture::kRegisterWireFormat,
+                           capture::kWireFormatWords);
+  }
+
+  // In-band telemetry, on the same terms as the wire format, except that it is
+  // always asked for: it costs eight words in every 8192 and gives a reading
+  // for every packet rather than one every quarter second. Gateware without it
+  // reads 0x00, and the stream then carries no blocks and none are looked for.
+  bool inband_telemetry = false;
+  {
+    std::vector<uint8_t> reported;
+    inband_telemetry =
+        device_->WriteRegister(path, capture::kRegisterInbandTelemetry,
+                               capture::kInbandTelemetryOn) &&
+        device_->ReadRegisters(path, capture::kRegisterInbandTelemetry, 1,
+                               reported) &&
+        reported.size() == 1 && reported[0] == capture::kInbandTelemetryOn;
+    if (!inband_telemetry) {
+      device_->WriteRegister(path, capture::kRegisterInbandTelemetry,
+                             capture::kInbandTelemetryOff);
+    }
+  }
+
   // Before the stream is opened, because this is what puts the firmware into
   // its capturing state and the firmware spends that state holding the USB
   // link out of U1/U2. A link that drops into U2 once data is flowing loses
@@ -316,6 +433,15 @@ void CaptureController::StartMonitoring() {
   // decimation: a 2:1 capture delivers half as many samples a second, so a
   // count of them stands for twice as long.
   options.sample_rate_hz = settings_.SampleRateHz();
+  options.wire_format = wire_format;
+  options.inband_telemetry = inband_telemetry;
+  options.monitor_validation_interval = settings_.monitor_validation_interval;
+
+  // The video preview's tap. Asked for here and not by the command line,
+  // because this is the only caller with a picture to put it in, and then
+  // only switched on while the picture can be seen (SetFieldPreviewWanted).
+  options.field_snapshot_bytes =
+      capture::SnapshotPublisher::kFieldSnapshotBytes;
 
   // Enumerating opens devices and does control transfers on them. Doing that to
   // a device that is streaming would put avoidable traffic on the bus for an
@@ -347,6 +473,8 @@ void CaptureController::StartMonitoring() {
   // is one fewer thing to explain in a stack trace.
   analysis_->Start();
   analysis_->SetSource(&pipeline_->snapshots());
+  analysis_->SetFieldSource(&pipeline_->field_snapshots());
+  pipeline_->field_snapshots().SetEnabled(field_preview_wanted_);
 
   monitoring_ = true;
   stats_timer_.start();
@@ -417,6 +545,12 @@ std::unique_ptr<capture::ISampleSink> CaptureController::OpenCaptureFile() {
   } else {
     capture::FlacWriter::Options options;
     options.compression_level = settings_.compression_level;
+
+    // Lower than configured when the ring filled while the last file of this
+    // session was written (see encoder_effort.h). A file keeps the level it
+    // opens at.
+    options.effort_step = pipeline_->EffortStepForNextFile();
+    options.threads = settings_.encoder_threads;
     options.sample_rate_label = capture::FlacSampleRateLabelFor(decimation);
 
     const capture::DeviceBuild build = CurrentDeviceBuild();
@@ -478,6 +612,8 @@ std::unique_ptr<capture::ISampleSink> CaptureController::OpenCaptureFile() {
   pending_metadata_.device = CurrentDeviceBuild();
   pending_metadata_.player = player_identity_;
   pending_metadata_.disc = disc_scan_;
+  pending_metadata_.addresses.addressing = addressing_;
+  address_index_.Clear();
   if (settings_.DeclaredGain().declared()) {
     pending_metadata_.front_end_gain =
         DescribeFrontEndGain(settings_.front_end_gain_switches).toStdString();
@@ -491,6 +627,7 @@ std::unique_ptr<capture::ISampleSink> CaptureController::OpenCaptureFile() {
   const capture::CaptureStats opening = pipeline_->stats().Read();
   device_overflows_at_start_ = opening.device_overflow_events;
   device_drops_at_start_ = opening.device_dropped_words;
+  thread_usage_at_start_ = opening.threads;
 
   if (logger_ != nullptr) {
     logger_->Info("Capturing to " + path.string() + " (" + sink->Name() +
@@ -676,6 +813,7 @@ void CaptureController::FinishCaptureFile(const capture::CaptureStats& stats,
   }
 
   WriteMetadataSidecar(file, stats, bytes, samples, duration_seconds);
+  WriteOverviewSidecar(file);
 
   if (logger_ != nullptr) {
     logger_->Info("Capture finished: " + file.string() + ", " +
@@ -768,6 +906,10 @@ void CaptureController::WriteMetadataSidecar(
   metadata.outcome.device_dropped_words =
       Since(stats.device_dropped_words, device_drops_at_start_);
 
+  // The same difference for the threads: what the scheduler did to them while
+  // this file was open, not since monitoring began.
+  metadata.threads = stats.threads.Since(thread_usage_at_start_);
+
   // The validator's own word for how it ended, rather than a boolean derived
   // from it — see CaptureOutcome::sequence_check, where the reason "disabled"
   // cannot be folded into "intact" is set out, and why the session-long check
@@ -793,6 +935,34 @@ void CaptureController::WriteMetadataSidecar(
   metadata.signal.clipped_high_samples =
       stats.metrics.capture_clipped_high_count;
 
+  // The file's code histogram, from the same span, and what it says about the
+  // converter. The pipeline published it in the swap that closed the file, so
+  // it is complete by the time the change has been counted. A test ramp visits
+  // every code equally by construction and says nothing about the converter.
+  metadata.codes.known = !metadata.test_mode && samples > 0;
+  if (metadata.codes.known) {
+    metadata.codes.counts = pipeline_->histograms().Read().capture;
+    metadata.codes.linearity = capture::AnalyseLinearity(metadata.codes.counts);
+  }
+
+  // The file's dropouts, on the same terms: counted over its own span, and
+  // listed from its own first sample. The list was handed over when the file
+  // closed, whichever way it closed. Nothing is claimed for a test capture,
+  // whose ramp has no envelope to lose.
+  metadata.dropouts.known = !metadata.test_mode && samples > 0;
+  metadata.dropouts.count = stats.dropouts.capture_event_count;
+  metadata.dropouts.total_samples = stats.dropouts.capture_dropout_samples;
+  metadata.dropouts.events = pipeline_->TakeRetiredDropouts();
+
+  // Frozen when the file closed, and left for this to read until another file
+  // opens.
+  metadata.encoder_effort = stats.encoder_effort;
+
+  // Where the player said it was, for an automatic capture. The addressing was
+  // latched when the file opened; the readings are the index built since.
+  metadata.addresses.uncertainty_samples = address_index_.uncertainty_samples();
+  metadata.addresses.readings = address_index_.readings();
+
   const std::filesystem::path sidecar =
       capture::CaptureMetadataPath(capture_file);
 
@@ -813,6 +983,32 @@ void CaptureController::WriteMetadataSidecar(
   emit MetadataWriteFailed(QString::fromStdString(error));
 }
 
+void CaptureController::WriteOverviewSidecar(
+    const std::filesystem::path& capture_file) {
+  // Taken whether or not it is written, so a file that closed empty does not
+  // leave its overview to be mistaken for the next one's.
+  const capture::CaptureOverview overview = pipeline_->TakeRetiredOverview();
+  if (overview.empty()) {
+    return;
+  }
+
+  const std::filesystem::path path = capture::CaptureOverviewPath(capture_file);
+  std::string error;
+  if (!capture::WriteCaptureOverviewFile(path, overview, error)) {
+    // Logged and nothing more. The review view builds an overview from the
+    // capture itself when there is none, so this costs somebody a wait later
+    // and nothing else.
+    if (logger_ != nullptr) {
+      logger_->Warning(error);
+    }
+    return;
+  }
+
+  if (logger_ != nullptr) {
+    logger_->Debug("Capture overview written to " + path.string());
+  }
+}
+
 void CaptureController::CheckDurationLimit(const capture::CaptureStats& stats) {
   if (!capturing_ || settings_.duration_limit_seconds <= 0) {
     return;
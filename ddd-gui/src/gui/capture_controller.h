@@ -17,6 +17,7 @@
 #include <memory>
 #include <vector>
 
+#include "address_index.h"
 #include "analysis_worker.h"
 #include "capture_metadata.h"
 #include "capture_metatypes.h"
@@ -104,6 +105,12 @@ class CaptureController : public QObject {
   // three panels share what it produces.
   AnalysisWorker* analysis() { return analysis_.get(); }
 
+  // Whether anybody can see the video preview, and so whether the pipeline's
+  // field tap should be copying for it. Kept across runs and applied to each
+  // as it starts: the tap begins every run off and holding nothing, and is
+  // turned on, pool and all, only while the panel is showing a picture.
+  void SetFieldPreviewWanted(bool wanted);
+
   // What was in the player when this capture was set up.
   //
   // Set by the automatic-capture coupling and by nothing else, and cleared when
@@ -137,6 +144,39 @@ class CaptureController : public QObject {
   void SetDiscScan(const capture::DiscScan& disc);
   const capture::DiscScan& disc_scan() const { return disc_scan_; }
 
+  // How the player's addresses are written on the disc an automatic capture is
+  // running against — "frame" or "time code" — or empty when none is running.
+  // Set and cleared by the coupling alongside the disc scan, and latched when a
+  // file opens; a file opened while it is empty keeps no address index.
+  void SetAddressing(const std::string& addressing);
+
+  // Where the file being written has reached, in samples: everything the
+  // engine has processed into it, and everything already waiting in the ring
+  // behind that. Zero while nothing is being written.
+  //
+  // The ring is counted because a reading is an instant at the player, and
+  // the samples of that instant arrived when they arrived whether or not the
+  // processing thread has reached them yet. Read from the statistics block, so
+  // it moves a buffer at a time.
+  uint64_t CapturePosition() const;
+
+  // The pipeline's statistics block, for a reader that takes its own copy
+  // when it wants one rather than at the stats timer's pace — the metrics page,
+  // which is read whenever a scraper asks. Reading it costs the pipeline
+  // nothing; see capture::StatsPublisher.
+  const capture::StatsPublisher& stats_publisher() const {
+    return pipeline_->stats();
+  }
+
+  // Samples in one slot of the running pipeline's ring, or zero when there is
+  // no run.
+  uint64_t RingSlotSamples() const;
+
+  // The player said it was at `address`, in answer to a query sent when the
+  // file stood at `sent_position`. Kept in the file's address index, which its
+  // sidecar carries — see capture::AddressIndex.
+  void RecordPlayerAddress(int32_t address, uint64_t sent_position);
+
   // Applying settings while a capture is running changes what the next one will
   // do, not this one. Nothing here can be changed mid-stream without stopping,
   // and pretending otherwise would mean a ring that was resized underneath a
@@ -266,8 +306,8 @@ class CaptureController : public QObject {
   void CollectFinishedCapture(const capture::CaptureStats& stats);
 
   // Everything that happens once a capture's file is closed: the duration
-  // rename where the naming asks for one, the sidecar, and the signal that
-  // says so.
+  // rename where the naming asks for one, the sidecar and the overview, and the
+  // signal that says so.
   //
   // One function for the three because they have to happen in that order and
   // share the path they act on — a sidecar written before the rename would be
@@ -282,6 +322,10 @@ class CaptureController : public QObject {
                             const capture::CaptureStats& stats, uint64_t bytes,
                             uint64_t samples, double duration_seconds);
 
+  // Write the overview the pipeline gathered beside `capture_file`, on the
+  // same terms as the sidecar.
+  void WriteOverviewSidecar(const std::filesystem::path& capture_file);
+
   // Stop the capture because the duration limit has been reached.
   void CheckDurationLimit(const capture::CaptureStats& stats);
 
@@ -301,6 +345,7 @@ class CaptureController : public QObject {
   // reads through a publisher the pipeline owns, and the reverse order would
   // free the publisher first.
   std::unique_ptr<AnalysisWorker> analysis_;
+  bool field_preview_wanted_ = false;
 
   QTimer stats_timer_;
 
@@ -340,6 +385,13 @@ class CaptureController : public QObject {
   capture::PlayerIdentity player_identity_;
   capture::DiscScan disc_scan_;
 
+  // See SetAddressing and RecordPlayerAddress. The index is the open file's,
+  // and is emptied when the next one opens rather than when this one closes,
+  // because the file is finished — and its sidecar written — after the
+  // coupling has already moved on.
+  std::string addressing_;
+  capture::AddressIndex address_index_;
+
   // What the running capture will say about itself, filled in when its file is
   // opened and completed when the file is closed.
   //
@@ -360,6 +412,10 @@ class CaptureController : public QObject {
   // see SampleMetrics::BeginCaptureSpan.
   uint64_t device_overflows_at_start_ = 0;
   uint64_t device_drops_at_start_ = 0;
+
+  // The capture threads' scheduling counters at the same moment, for the same
+  // reason.
+  capture::CaptureThreadUsage thread_usage_at_start_;
 };
 
 }  // namespace ddd::gui
@@ -18,6 +18,7 @@
 #include "device_updater.h"
 #include "monitor_tap.h"
 #include "usb_device_info.h"
+#include "video_preview.h"
 
 // Every type that crosses a signal in this application, in one place.
 //
@@ -48,3 +49,8 @@ Q_DECLARE_METATYPE(ddd::capture::DeviceIdentity)
 // with one member and no behaviour.
 Q_DECLARE_METATYPE(std::vector<uint16_t>)
 Q_DECLARE_METATYPE(std::vector<double>)
+
+// A rendered field is the exception: its pixels mean nothing without the
+// width and height they were laid out in, and a row count carried in a
+// separate argument is a row count that can disagree with them.
+Q_DECLARE_METATYPE(ddd::analysis::VideoField)
@@ -0,0 +1,313 @@
+/************************************************************************
+
+    capture_monitor_client.cpp
+
+    --monitor, a running capture watched from a terminal
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "capture_monitor_client.h"
+
+#include <QByteArray>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QLocalSocket>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "capture_cli.h"
+
+namespace ddd::gui {
+namespace {
+
+constexpr double kBytesPerMegabyte = 1'000'000.0;
+
+QString Dropped(const capture::MonitorFrame& frame) {
+  return QStringLiteral(" dropped=%1").arg(frame.dropped);
+}
+
+}  // namespace
+
+QString FormatMonitorFrame(const capture::MonitorFrame& frame) {
+  switch (frame.type) {
+    case capture::MonitorFrameType::kStats: {
+      const capture::MonitorStats& stats = frame.stats;
+      return QStringLiteral(
+                 "stats elapsed=%1s written=%2 rate=%3MB/s buffer=%4/%5 "
+                 "range=%6..%7 rms=%8 overflows=%9 dropouts=%10")
+                 .arg(stats.elapsed_seconds, 0, 'f', 1)
+                 .arg(stats.bytes_written)
+                 .arg(stats.throughput_bytes_per_second / kBytesPerMegabyte, 0,
+                      'f', 1)
+                 .arg(stats.slots_in_use)
+                 .arg(stats.slot_count)
+                 .arg(stats.recent_minimum_value)
+                 .arg(stats.recent_maximum_value)
+                 .arg(stats.recent_rms, 0, 'f', 1)
+                 .arg(stats.device_overflow_events)
+                 .arg(stats.dropout_events) +
+             Dropped(frame);
+    }
+
+    case capture::MonitorFrameType::kSpectrum: {
+      QStringList levels;
+      levels.reserve(static_cast<qsizetype>(frame.spectrum.centi_db.size()));
+      for (const int16_t level : frame.spectrum.centi_db) {
+        levels.append(QString::number(level / 100.0, 'f', 1));
+      }
+      return QStringLiteral("spectrum bin_hz=%1")
+                 .arg(frame.spectrum.bin_width_hz, 0, 'f', 0) +
+             Dropped(frame) + QLatin1Char(' ') +
+             levels.join(QLatin1Char(' '));
+    }
+
+    case capture::MonitorFrameType::kWaveform: {
+      QStringList columns;
+      const size_t count = frame.waveform.minimum.size();
+      columns.reserve(static_cast<qsizetype>(count));
+      for (size_t column = 0; column < count; ++column) {
+        columns.append(QStringLiteral("%1:%2")
+                           .arg(frame.waveform.minimum[column])
+                           .arg(frame.waveform.maximum[column]));
+      }
+      return QStringLiteral("waveform span=%1")
+                 .arg(frame.waveform.sample_span) +
+             Dropped(frame) + QLatin1Char(' ') +
+             columns.join(QLatin1Char(' '));
+    }
+
+    case capture::MonitorFrameType::kReply:
+      break;
+  }
+  return QString();
+}
+
+std::vector<MonitorSubscription> MonitorClientSubscriptions(
+    const std::vector<capture::MonitorFrameType>& streams, double rate_hz) {
+  std::vector<MonitorSubscription> subscriptions;
+  subscriptions.reserve(streams.size());
+  for (const capture::MonitorFrameType stream : streams) {
+    MonitorSubscription subscription;
+    subscription.stream = stream;
+    subscription.rate_hz = rate_hz;
+    if (stream == capture::MonitorFrameType::kSpectrum) {
+      subscription.size = kMonitorClientBins;
+    } else if (stream == capture::MonitorFrameType::kWaveform) {
+      subscription.size = kMonitorClientPoints;
+    }
+    subscriptions.push_back(subscription);
+  }
+  return subscriptions;
+}
+
+int RunMonitor(QTextStream& out, QTextStream& error,
+               const MonitorClientOptions& options) {
+  // Either kind of socket, behind the one interface the exchange needs. What
+  // differs between them — connecting, and how each reports its end — is
+  // wired separately below.
+  std::unique_ptr<QIODevice> socket;
+  QLocalSocket* local = nullptr;
+  QTcpSocket* tcp = nullptr;
+  if (options.port != 0) {
+    socket = std::make_unique<QTcpSocket>();
+    tcp = static_cast<QTcpSocket*>(socket.get());
+  } else {
+    socket = std::make_unique<QLocalSocket>();
+    local = static_cast<QLocalSocket*>(socket.get());
+  }
+
+  QEventLoop loop;
+  QTimer deadline;
+  deadline.setSingleShot(true);
+
+  QByteArray buffered;
+  int code = kExitNoRunningInstance;
+  bool settled = false;
+  bool connected = false;
+  bool monitoring = false;
+  int frames = 0;
+
+  // Reaches an answer exactly once, for the reasons RunStopCapture gives: a
+  // socket has several ways to end and more than one of them can happen.
+  const auto settle = [&](int result) {
+    if (settled) {
+      return;
+    }
+    settled = true;
+    code = result;
+    loop.quit();
+  };
+
+  const auto on_connected = [&] {
+    connected = true;
+    deadline.stop();
+    if (options.duration_milliseconds > 0) {
+      deadline.start(options.duration_milliseconds);
+    }
+
+    // Everything at once. The server takes requests in order, so the
+    // subscriptions are read after the switch to monitoring they depend on.
+    socket->write(FormatControlRequest(QLatin1String(kMonitorVerb)).toUtf8());
+    for (const MonitorSubscription& subscription : options.subscriptions) {
+      socket->write(FormatMonitorSubscribe(subscription).toUtf8());
+    }
+  };
+
+  // The first line is the answer to the monitor request, and text; everything
+  // after it is frames.
+  const auto on_ready_read = [&] {
+    if (settled) {
+      return;
+    }
+    buffered.append(socket->readAll());
+
+    if (!monitoring) {
+      const qsizetype newline = buffered.indexOf('\n');
+      if (newline < 0) {
+        return;
+      }
+      const std::optional<ControlReply> reply =
+          ParseControlReply(buffered.left(newline));
+      buffered.remove(0, newline + 1);
+      if (!reply.has_value() || !reply->ok) {
+        error << "Error: "
+              << (reply.has_value()
+                      ? reply->error
+                      : QStringLiteral("the running application answered "
+                                       "with something that could not be "
+                                       "understood."))
+              << "\n";
+        settle(kExitCaptureFailed);
+        return;
+      }
+      monitoring = true;
+    }
+
+    while (!settled) {
+      capture::MonitorFrame frame;
+      size_t consumed = 0;
+      const capture::MonitorDecodeStatus status = capture::DecodeMonitorFrame(
+          std::span(reinterpret_cast<const uint8_t*>(buffered.constData()),
+                    static_cast<size_t>(buffered.size())),
+          frame, consumed);
+
+      if (status == capture::MonitorDecodeStatus::kIncomplete) {
+        return;
+      }
+      if (status == capture::MonitorDecodeStatus::kMalformed) {
+        error << "Error: the running application sent a frame that could not "
+                 "be read.\n";
+        settle(kExitCaptureFailed);
+        return;
+      }
+      buffered.remove(0, static_cast<qsizetype>(consumed));
+
+      if (frame.type == capture::MonitorFrameType::kReply) {
+        const std::optional<ControlReply> reply =
+            ParseControlReply(QByteArray::fromStdString(frame.reply));
+        if (reply.has_value() && !reply->ok) {
+          error << "Error: " << reply->error << "\n";
+          settle(kExitCaptureFailed);
+        }
+        continue;
+      }
+
+      out << FormatMonitorFrame(frame) << "\n";
+      out.flush();
+      ++frames;
+      if (options.frame_limit > 0 && frames >= options.frame_limit) {
+        settle(kExitSuccess);
+      }
+    }
+  };
+
+  // The far end going away is how a monitor ordinarily ends: the capture
+  // finished and the application with it.
+  const auto on_disconnected = [&] {
+    if (settled) {
+      return;
+    }
+    if (!monitoring) {
+      error << "Error: the running application closed the connection without "
+               "answering.\n";
+      settle(kExitCaptureFailed);
+      return;
+    }
+    error << "The application closed the connection.\n";
+    settle(kExitSuccess);
+  };
+
+  const auto on_error = [&] {
+    if (settled) {
+      return;
+    }
+    if (!connected) {
+      error << "There is no Domesday Duplicator running to monitor.\n";
+      settle(kExitNoRunningInstance);
+      return;
+    }
+    on_disconnected();
+  };
+
+  QObject::connect(socket.get(), &QIODevice::readyRead, socket.get(),
+                   on_ready_read);
+
+  if (local != nullptr) {
+    QObject::connect(local, &QLocalSocket::connected, local, on_connected);
+    QObject::connect(local, &QLocalSocket::disconnected, local,
+                     on_disconnected);
+    QObject::connect(local, &QLocalSocket::errorOccurred, local,
+                     [&](QLocalSocket::LocalSocketError) { on_error(); });
+  } else {
+    QObject::connect(tcp, &QTcpSocket::connected, tcp, on_connected);
+    QObject::connect(tcp, &QTcpSocket::disconnected, tcp, on_disconnected);
+    QObject::connect(tcp, &QTcpSocket::errorOccurred, tcp,
+                     [&](QAbstractSocket::SocketError) { on_error(); });
+  }
+
+  QObject::connect(&deadline, &QTimer::timeout, &deadline, [&] {
+    if (settled) {
+      return;
+    }
+    if (!connected) {
+      error << "There is no Domesday Duplicator running to monitor.\n";
+      settle(kExitNoRunningInstance);
+      return;
+    }
+    settle(kExitSuccess);
+  });
+
+  deadline.start(options.connect_timeout_milliseconds);
+  if (local != nullptr) {
+    local->connectToServer(options.server_name.isEmpty()
+                               ? CaptureControlServer::ServerName()
+                               : options.server_name);
+  } else {
+    tcp->connectToHost(QHostAddress::LocalHost, options.port);
+  }
+
+  // A connection that failed before there was an event loop to report it in has
+  // already settled, and exec() would then wait for a quit() that has been and
+  // gone.
+  if (!settled) {
+    loop.exec();
+  }
+
+  // The socket outlives everything the handlers above refer to, and closing
+  // it on the way out can still emit.
+  socket->disconnect();
+
+  out.flush();
+  error.flush();
+  return code;
+}
+
+}  // namespace ddd::gui
@@ -0,0 +1,74 @@
+/************************************************************************
+
+    capture_monitor_client.h
+
+    --monitor, a running capture watched from a terminal
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+#include "capture_control_server.h"
+#include "monitor_protocol.h"
+
+class QTextStream;
+
+namespace ddd::gui {
+
+struct MonitorClientOptions {
+  // Empty means the socket every instance listens on, as for --stop-capture.
+  QString server_name;
+
+  // Nonzero connects to the monitor port on this machine instead of the
+  // socket — the way in for a client that cannot reach the socket.
+  quint16 port = 0;
+
+  std::vector<MonitorSubscription> subscriptions;
+
+  int connect_timeout_milliseconds = 3000;
+
+  // Stop after this long, or after this many data frames; zero is for ever,
+  // which is until the application goes away or the user interrupts.
+  int duration_milliseconds = 0;
+  int frame_limit = 0;
+};
+
+// The sizes --monitor asks for. A terminal line of sixty-four levels or a
+// hundred and twenty-eight column pairs is already more than anybody reads,
+// and a script wanting more talks to the socket itself.
+inline constexpr uint32_t kMonitorClientBins = 64;
+inline constexpr uint32_t kMonitorClientPoints = 128;
+
+// Twice a second: fast enough to watch a level move, slow enough to read.
+inline constexpr double kMonitorClientRateHz = 2.0;
+
+// A subscription per stream, each at the rate given and at the sizes above.
+std::vector<MonitorSubscription> MonitorClientSubscriptions(
+    const std::vector<capture::MonitorFrameType>& streams, double rate_hz);
+
+// One frame as one line of text, stream name first, so that a script can grep
+// for the stream it wants. Replies are not data and are not printed.
+QString FormatMonitorFrame(const capture::MonitorFrame& frame);
+
+// Ask the running application to monitor, subscribe to what the options name,
+// and print each frame that arrives to `out` as a line, until the options'
+// limits or the application end it.
+//
+// Diagnostics go to `error`. Returns a CaptureCliExit code: success when the
+// stream ran until it was meant to stop — a limit reached, or an application
+// that finished and went away — nothing running to monitor, or a failure when
+// the application refused the subscription or sent something unreadable.
+//
+// Event-loop driven, like RunStopCapture, so that a test can host the server on
+// the same thread.
+int RunMonitor(QTextStream& out, QTextStream& error,
+               const MonitorClientOptions& options);
+
+}  // namespace ddd::gui
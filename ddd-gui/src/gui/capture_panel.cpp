@@ -177,14 +177,20 @@ CapturePanel::CapturePanel(CaptureController* controller, QWidget* parent)
                               capture::kUndecimatedFactor);
   sample_rate_combo_->addItem(tr("20 MSPS for VHS"),
                               capture::kTapeDecimationFactor);
+  sample_rate_combo_->addItem(tr("10 MSPS for colour-under chroma"),
+                              capture::kQuarterRateDecimationFactor);
+  sample_rate_combo_->addItem(tr("5 MSPS for hi-fi audio"),
+                              capture::kEighthRateDecimationFactor);
   sample_rate_combo_->setToolTip(
       tr("The converter always runs at 40 MSPS. Decimating halves that in the "
          "FPGA, which low-passes the signal at 10 MHz first and then keeps "
          "every second sample — half the file, and enough for any tape RF, "
          "whose bandwidth is a fraction of a LaserDisc's. VHS names the common "
          "case rather than the only one: Betamax and Video8 are the same "
-         "choice. Energy close to 10 MHz still folds down around it, so a "
-         "signal with content up there should be captured at the full rate."));
+         "choice. 10 and 5 MSPS halve it again and again, for a signal that "
+         "lives below 4 or 2 MHz. Energy close to half the chosen rate still "
+         "folds down around it, so a signal with content up there should be "
+         "captured at the next rate up."));
   form->addRow(tr("Sample rate"), sample_rate_combo_);
 
   compression_spin_ = new QSpinBox(contents);
@@ -24,6 +24,7 @@ namespace {
 constexpr const char* kPreferredDeviceKey = "capture/preferred_device";
 constexpr const char* kQueueSizeKey = "capture/queue_size_bytes";
 constexpr const char* kSmallTransfersKey = "capture/small_transfers";
+constexpr const char* kPackedWireKey = "capture/packed_wire";
 constexpr const char* kTransferQueueKey = "capture/transfer_queue_bytes";
 constexpr const char* kFrontEndGainKey = "hardware/front_end_gain_switches";
 constexpr const char* kCaptureDirectoryKey = "capture/directory";
@@ -31,6 +32,9 @@ constexpr const char* kCaptureNameKey = "capture/name";
 constexpr const char* kOutputFormatKey = "capture/output_format";
 constexpr const char* kDecimationFactorKey = "capture/decimation_factor";
 constexpr const char* kCompressionLevelKey = "capture/compression_level";
+constexpr const char* kEncoderThreadsKey = "capture/encoder_threads";
+constexpr const char* kMonitorValidationKey =
+    "capture/monitor_validation_interval";
 constexpr const char* kDurationLimitKey = "capture/duration_limit_seconds";
 constexpr const char* kLowSpaceKey = "capture/low_space_warning_minutes";
 
@@ -313,6 +317,10 @@ CaptureSettings LoadCaptureSettings() {
       settings.value(QLatin1String(kSmallTransfersKey), loaded.small_transfers)
           .toBool();
 
+  loaded.packed_wire =
+      settings.value(QLatin1String(kPackedWireKey), loaded.packed_wire)
+          .toBool();
+
   loaded.transfer_queue_bytes = std::clamp(
       static_cast<size_t>(
           settings
@@ -362,6 +370,18 @@ CaptureSettings LoadCaptureSettings() {
           .toInt(),
       0, 8);
 
+  loaded.encoder_threads = std::clamp(
+      settings.value(QLatin1String(kEncoderThreadsKey), loaded.encoder_threads)
+          .toUInt(),
+      0U, capture::FlacWriter::kMaximumEncoderThreads);
+
+  loaded.monitor_validation_interval = std::clamp<uint64_t>(
+      settings
+          .value(QLatin1String(kMonitorValidationKey),
+                 static_cast<qulonglong>(loaded.monitor_validation_interval))
+          .toULongLong(),
+      1, CaptureSettings::kMaximumMonitorValidationInterval);
+
   loaded.duration_limit_seconds =
       std::clamp(settings.value(QLatin1String(kDurationLimitKey), 0).toInt(), 0,
                  CaptureSettings::kMaximumDurationLimitSeconds);
@@ -382,6 +402,7 @@ void SaveCaptureSettings(const CaptureSettings& settings) {
   store.setValue(QLatin1String(kQueueSizeKey),
                  static_cast<qulonglong>(settings.queue_size_bytes));
   store.setValue(QLatin1String(kSmallTransfersKey), settings.small_transfers);
+  store.setValue(QLatin1String(kPackedWireKey), settings.packed_wire);
   store.setValue(QLatin1String(kTransferQueueKey),
                  static_cast<qulonglong>(settings.transfer_queue_bytes));
   store.setValue(QLatin1String(kFrontEndGainKey),
@@ -396,6 +417,9 @@ void SaveCaptureSettings(const CaptureSettings& settings) {
                  settings.decimation_factor);
   store.setValue(QLatin1String(kCompressionLevelKey),
                  settings.compression_level);
+  store.setValue(QLatin1String(kEncoderThreadsKey), settings.encoder_threads);
+  store.setValue(QLatin1String(kMonitorValidationKey),
+                 static_cast<qulonglong>(settings.monitor_validation_interval));
   store.setValue(QLatin1String(kDurationLimitKey),
                  settings.duration_limit_seconds);
   store.setValue(QLatin1String(kLowSpaceKey),
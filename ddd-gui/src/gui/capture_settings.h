@@ -44,6 +44,13 @@ struct CaptureSettings {
   // be decided here.
   bool small_transfers = true;
 
+  // Ask the device for the packed wire format: ten bits a sample on the wire
+  // rather than sixteen, 50 MB/s rather than 80. For a host controller that
+  // cannot sustain the full rate, and off by default because one that can
+  // gains nothing by it. Only a request — see StartMonitoring, which streams
+  // whatever the device says it is sending.
+  bool packed_wire = false;
+
   size_t transfer_queue_bytes =
       capture::UsbSourceOptions{}.transfer_queue_bytes;
 
@@ -98,7 +105,7 @@ struct CaptureSettings {
 
   // Keep every nth sample. 1 is the device's own rate and is what a LaserDisc
   // capture uses; 2 halves it to 20 Msps, which is enough for tape RF and half
-  // the file.
+  // the file; 4 and 8 are 10 and 5 Msps, for narrower signals still.
   //
   // Done by the gateware, not here. Halving the rate means low-passing the
   // signal at 10 MHz first — without that everything above 10 MHz folds down
@@ -122,6 +129,21 @@ struct CaptureSettings {
   // format, which has no encoder to ask.
   int compression_level = capture::FlacWriter::Options{}.compression_level;
 
+  // Encoder threads, as FlacWriter::Options::threads: 0 is one per core up to
+  // FlacWriter::kMaximumEncoderThreads. Not on the panel — the default is right
+  // for nearly every machine, and the one that wants fewer is best told so by
+  // --qualify, which measures each count and keeps the fewest that keep up.
+  unsigned int encoder_threads = capture::FlacWriter::Options{}.threads;
+
+  // While monitoring, check one buffer in this many and account for the rest
+  // by their counter changes — see
+  // CapturePipeline::Options::monitor_validation_interval. Not on the panel,
+  // like the thread count: sixteen takes the processing thread from a busy
+  // core to a few percent of one, with the scope and the meters still fed,
+  // and 1 is there for anyone who wants every buffer of a session checked
+  // whether it is being kept or not. A capture is checked whole either way.
+  uint64_t monitor_validation_interval = kDefaultMonitorValidationInterval;
+
   // Stop the capture automatically after this long. 0 means run until stopped,
   // which is the default: a limit that fired in the middle of a side would be
   // worse than no limit at all.
@@ -140,6 +162,8 @@ struct CaptureSettings {
   int low_space_warning_minutes = kDefaultLowSpaceWarningMinutes;
 
   static constexpr int kDefaultLowSpaceWarningMinutes = 10;
+  static constexpr uint64_t kDefaultMonitorValidationInterval = 16;
+  static constexpr uint64_t kMaximumMonitorValidationInterval = 256;
   static constexpr int kMaximumDurationLimitMinutes = 24 * 60;
   static constexpr int kMaximumDurationLimitSeconds =
       kMaximumDurationLimitMinutes * 60;
@@ -149,6 +173,7 @@ struct CaptureSettings {
     return preferred_device_path == other.preferred_device_path &&
            queue_size_bytes == other.queue_size_bytes &&
            small_transfers == other.small_transfers &&
+           packed_wire == other.packed_wire &&
            transfer_queue_bytes == other.transfer_queue_bytes &&
            front_end_gain_switches == other.front_end_gain_switches &&
            test_mode == other.test_mode &&
@@ -157,6 +182,8 @@ struct CaptureSettings {
            output_format == other.output_format &&
            decimation_factor == other.decimation_factor &&
            compression_level == other.compression_level &&
+           encoder_threads == other.encoder_threads &&
+           monitor_validation_interval == other.monitor_validation_interval &&
            duration_limit_seconds == other.duration_limit_seconds &&
            low_space_warning_minutes == other.low_space_warning_minutes;
   }
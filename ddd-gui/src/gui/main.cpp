@@ -27,6 +27,7 @@
 #include "capture_cli.h"
 #include "capture_control_server.h"
 #include "capture_controller.h"
+#include "capture_monitor_client.h"
 #include "capture_settings.h"
 #include "capture_stop_client.h"
 #include "console_attach.h"
@@ -34,9 +35,11 @@
 #include "log_options.h"
 #include "logger.h"
 #include "main_window.h"
+#include "metrics_server.h"
 #include "platform_description.h"
 #include "player_controller.h"
 #include "qt_message_filter.h"
+#include "qualify_cli.h"
 #include "signal_watcher.h"
 #include "spdlog_logger.h"
 #include "theme_controller.h"
@@ -80,6 +83,22 @@ int RunHeadlessCapture(QCoreApplication& app, ddd::gui::ApplicationLogger& log,
     return ddd::gui::kExitInstanceRunning;
   }
 
+  // Only once the socket is held, since an instance that is not the one
+  // capturing has nothing to be monitored for. Not fatal: the capture does not
+  // depend on anybody watching it.
+  if (options.monitor_port.has_value() &&
+      !control_server.ListenForMonitors(*options.monitor_port, &listen_error)) {
+    log.Warning(listen_error.toStdString());
+  }
+
+  // What an unattended host is watched through. Not fatal either, for the same
+  // reason.
+  ddd::gui::MetricsServer metrics_server(&capture_controller, &log);
+  if (options.metrics_port.has_value() &&
+      !metrics_server.Listen(*options.metrics_port, &listen_error)) {
+    log.Warning(listen_error.toStdString());
+  }
+
   ddd::gui::HeadlessCaptureRunner runner(&capture_controller, out, error);
 
   int exit_code = ddd::gui::kExitSuccess;
@@ -285,6 +304,24 @@ int main(int argc, char* argv[]) {
     return ddd::gui::RunStopCapture(out_stream, error_stream);
   }
 
+  // The other client mode, and no more than a client either.
+  if (!capture_cli.options.monitor_streams.empty()) {
+    ddd::gui::MonitorClientOptions monitor;
+    monitor.port = capture_cli.options.monitor_port.value_or(0);
+    monitor.subscriptions = ddd::gui::MonitorClientSubscriptions(
+        capture_cli.options.monitor_streams,
+        capture_cli.options.monitor_rate_hz.value_or(
+            ddd::gui::kMonitorClientRateHz));
+    return ddd::gui::RunMonitor(out_stream, error_stream, monitor);
+  }
+
+  // Measures, saves three settings and exits. No device, no log and no window:
+  // what it reports is the report.
+  if (capture_cli.options.qualify) {
+    return ddd::gui::RunHostQualification(capture_cli.options, out_stream,
+                                          error_stream);
+  }
+
   ddd::capture::LogConfig log_config;
 
   const QString level_name = parser.value(log_level_option);
@@ -379,7 +416,10 @@ int main(int argc, char* argv[]) {
   // Nothing is opened, enumerated or written to until the settings say player
   // control is on — see PlayerSettings::enabled, which is off until a user
   // turns it on.
-  ddd::gui::PlayerController player_controller({}, &logger);
+  ddd::gui::PlayerBackend player_backend;
+  player_backend.disc_cache_path = ddd::gui::DefaultDiscCachePath();
+  ddd::gui::PlayerController player_controller(std::move(player_backend),
+                                               &logger);
 
   ddd::gui::AutoCaptureController auto_capture_controller(
       &player_controller, &capture_controller, &logger);
@@ -463,6 +503,19 @@ int main(int argc, char* argv[]) {
                    " This window will not answer --stop-capture.");
   }
 
+  if (control_server.listening() && capture_cli.options.monitor_port &&
+      !control_server.ListenForMonitors(*capture_cli.options.monitor_port,
+                                        &listen_error)) {
+    logger.Warning(listen_error.toStdString());
+  }
+
+  ddd::gui::MetricsServer metrics_server(&capture_controller, &logger);
+  if (control_server.listening() && capture_cli.options.metrics_port &&
+      !metrics_server.Listen(*capture_cli.options.metrics_port,
+                             &listen_error)) {
+    logger.Warning(listen_error.toStdString());
+  }
+
   // Started after the window is up so that the first device report lands on a
   // window that already has panels to receive it.
   capture_controller.Start();
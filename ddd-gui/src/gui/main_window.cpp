@@ -47,6 +47,7 @@
 #include "player_controller.h"
 #include "player_remote_dialog.h"
 #include "player_text.h"
+#include "review_dialog.h"
 #include "serial_port_scanner.h"
 #include "settings_dialog.h"
 #include "spectrum_panel.h"
@@ -54,6 +55,7 @@
 #include "theme_controller.h"
 #include "usb_device_info.h"
 #include "version.h"
+#include "video_panel.h"
 #include "waveform_panel.h"
 
 namespace ddd::gui {
@@ -117,14 +119,16 @@ MainWindow::MainWindow(ThemeController* theme_controller,
   BuildWaveformDock();
   BuildSpectrumDock();
   BuildAmplitudeDock();
+  BuildVideoDock();
   BuildLogDock();
 
-  // After all six exist, because it applies to every one of them equally.
+  // After all seven exist, because it applies to every one of them equally.
   // Under Wayland a panel popped out of the window is one Qt draws a title bar
   // for and then cannot move; this hands the drag to the compositor instead.
   // See floating_dock_drag.h. It does nothing on any other platform.
   for (QDockWidget* dock : {capture_dock_, statistics_dock_, waveform_dock_,
-                            spectrum_dock_, amplitude_dock_, log_dock_}) {
+                            spectrum_dock_, amplitude_dock_, video_dock_,
+                            log_dock_}) {
     EnableFloatingDockDrag(dock);
   }
 
@@ -352,6 +356,23 @@ void MainWindow::BuildAmplitudeDock() {
   splitDockWidget(spectrum_dock_, amplitude_dock_, Qt::Vertical);
 }
 
+void MainWindow::BuildVideoDock() {
+  video_dock_ = new QDockWidget(tr("Video Preview"), this);
+  video_dock_->setObjectName(QStringLiteral("video_dock"));
+  video_dock_->setWidget(new VideoPanel(capture_controller_, video_dock_));
+  addDockWidget(Qt::RightDockWidgetArea, video_dock_);
+
+  // Tabbed with the amplitude history rather than split below it: a fourth
+  // panel down the right-hand side would leave every one of them too short to
+  // read.
+  tabifyDockWidget(amplitude_dock_, video_dock_);
+
+  // Hidden by default, like the log, but for a different reason: the panel
+  // costs a share of a core while it is showing, and the first run should not
+  // spend it on a picture nobody asked for. The View menu reveals it.
+  video_dock_->hide();
+}
+
 void MainWindow::BuildLogDock() {
   log_dock_ = new QDockWidget(tr("Log"), this);
   log_dock_->setObjectName(QStringLiteral("log_dock"));
@@ -369,6 +390,10 @@ void MainWindow::ShowLogPanel() {
 
 void MainWindow::BuildMenus() {
   QMenu* file_menu = menuBar()->addMenu(tr("&File"));
+  file_menu->addAction(tr("&Review capture…"), this,
+                       &MainWindow::ShowReviewDialog);
+  file_menu->addSeparator();
+
   // Spelled out rather than taken from QKeySequence::Preferences and
   // QKeySequence::Quit, which are wrong on Windows. Qt's standard-key table
   // holds two kinds of binding — keyboard chords and the dedicated hardware
@@ -400,6 +425,7 @@ void MainWindow::BuildMenus() {
   panels_menu->addAction(waveform_dock_->toggleViewAction());
   panels_menu->addAction(spectrum_dock_->toggleViewAction());
   panels_menu->addAction(amplitude_dock_->toggleViewAction());
+  panels_menu->addAction(video_dock_->toggleViewAction());
   panels_menu->addAction(log_dock_->toggleViewAction());
 
   view_menu->addSeparator();
@@ -874,6 +900,17 @@ void MainWindow::ShowAnalysisDialog() {
   dialog.ChooseFileAndAnalyse(starting_directory);
 }
 
+void MainWindow::ShowReviewDialog() {
+  // On the capture folder, as the analysis is and for the same reason
+  const QString starting_directory =
+      capture_controller_ != nullptr
+          ? capture_controller_->settings().ResolvedCaptureDirectory()
+          : DefaultCaptureDirectory();
+
+  ReviewDialog dialog(this);
+  dialog.ChooseFileAndReview(starting_directory);
+}
+
 void MainWindow::ShowRemoteDialog() {
   if (player_controller_ == nullptr) {
     return;
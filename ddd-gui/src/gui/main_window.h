@@ -104,6 +104,7 @@ class MainWindow : public QMainWindow {
   void BuildWaveformDock();
   void BuildSpectrumDock();
   void BuildAmplitudeDock();
+  void BuildVideoDock();
   void BuildLogDock();
   void BuildMenus();
   void BuildToolsMenu();
@@ -160,6 +161,9 @@ class MainWindow : public QMainWindow {
       SettingsDialog::Tab tab = SettingsDialog::Tab::kCapture);
   void ShowAnalysisDialog();
 
+  // A finished capture's whole length, at any zoom
+  void ShowReviewDialog();
+
   // Bring up the remote, or bring the one that is already up to the front.
   void ShowRemoteDialog();
 
@@ -202,6 +206,7 @@ class MainWindow : public QMainWindow {
   QDockWidget* waveform_dock_ = nullptr;
   QDockWidget* spectrum_dock_ = nullptr;
   QDockWidget* amplitude_dock_ = nullptr;
+  QDockWidget* video_dock_ = nullptr;
   QDockWidget* log_dock_ = nullptr;
 
   // Tools ▸ Test data ▸ Test data mode. Held so that a change made anywhere
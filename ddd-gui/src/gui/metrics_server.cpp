@@ -0,0 +1,216 @@
+/************************************************************************
+
+    metrics_server.cpp
+
+    The metrics page a monitoring system scrapes, served on loopback
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "metrics_server.h"
+
+#include <QHostAddress>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <string>
+
+#include "capture_controller.h"
+#include "logger.h"
+
+namespace ddd::gui {
+namespace {
+
+// The end of a request's headers. A scraper sends CRLFs; a person testing with
+// a hand-typed request may send bare newlines, and is answered the same.
+constexpr const char* kHeadersEnd = "\r\n\r\n";
+constexpr const char* kBareHeadersEnd = "\n\n";
+
+// Longer than any scraper's request by a wide margin. Past this, whatever is
+// on the other end is not asking for metrics and is not waited for.
+constexpr qsizetype kMaximumRequestBytes = 8192;
+
+// How long a connection may sit without finishing its request.
+constexpr int kRequestTimeoutMilliseconds = 5000;
+
+// Version 0.0.4 is the text format; a scraper that sees it parses the body as
+// the page capture::CaptureMetrics writes.
+constexpr const char* kMetricsContentType =
+    "text/plain; version=0.0.4; charset=utf-8";
+constexpr const char* kTextContentType = "text/plain; charset=utf-8";
+
+QByteArray Response(const char* status, const char* content_type,
+                    const QByteArray& body, bool head,
+                    const char* extra_header = nullptr) {
+  QByteArray response = QByteArray("HTTP/1.1 ") + status + "\r\n";
+  response += QByteArray("Content-Type: ") + content_type + "\r\n";
+  response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+  if (extra_header != nullptr) {
+    response += QByteArray(extra_header) + "\r\n";
+  }
+  response += "Connection: close\r\n\r\n";
+  if (!head) {
+    response += body;
+  }
+  return response;
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(CaptureController* controller,
+                             capture::ILogger* logger, QObject* parent)
+    : QObject(parent), controller_(controller), logger_(logger) {
+  connect(controller_, &CaptureController::StatsUpdated, this,
+          [this](const capture::CaptureStats& stats) {
+            metrics_.Observe(stats);
+          });
+}
+
+MetricsServer::~MetricsServer() = default;
+
+bool MetricsServer::Listen(quint16 port, QString* error) {
+  if (server_ == nullptr) {
+    server_ = new QTcpServer(this);
+    connect(server_, &QTcpServer::newConnection, this,
+            &MetricsServer::OnNewConnection);
+  }
+  if (server_->isListening()) {
+    return true;
+  }
+
+  if (server_->listen(QHostAddress::LocalHost, port)) {
+    if (logger_ != nullptr) {
+      logger_->Info("Serving metrics on 127.0.0.1:" +
+                    std::to_string(server_->serverPort()) + kMetricsPath);
+    }
+    return true;
+  }
+  if (error != nullptr) {
+    *error = QStringLiteral("The metrics port %1 could not be opened: %2")
+                 .arg(port)
+                 .arg(server_->errorString());
+  }
+  return false;
+}
+
+bool MetricsServer::listening() const {
+  return server_ != nullptr && server_->isListening();
+}
+
+quint16 MetricsServer::port() const {
+  return listening() ? server_->serverPort() : 0;
+}
+
+QByteArray MetricsServer::Page() const {
+  capture::MetricsContext context;
+  context.running = controller_->monitoring();
+  context.sample_rate_hz =
+      context.running ? controller_->settings().SampleRateHz() : 0.0;
+  context.ring_slot_samples = controller_->RingSlotSamples();
+
+  const std::string page =
+      metrics_.Format(controller_->stats_publisher().Read(), context);
+  return QByteArray(page.data(), static_cast<qsizetype>(page.size()));
+}
+
+void MetricsServer::OnNewConnection() {
+  while (QTcpSocket* socket = server_->nextPendingConnection()) {
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket] { OnReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket] {
+      partial_.remove(socket);
+      socket->deleteLater();
+    });
+
+    // Tied to the socket, so it goes with it when the request is answered in
+    // time.
+    QTimer::singleShot(kRequestTimeoutMilliseconds, socket,
+                       [socket] { socket->abort(); });
+  }
+}
+
+void MetricsServer::OnReadyRead(QTcpSocket* socket) {
+  QByteArray& buffered = partial_[socket];
+  buffered.append(socket->readAll());
+
+  // Only the request line matters, but the answer waits for the end of the
+  // headers: closing on a client still sending them resets the connection,
+  // and the reset can reach it before the answer does.
+  if (!buffered.contains(kHeadersEnd) && !buffered.contains(kBareHeadersEnd)) {
+    if (buffered.size() > kMaximumRequestBytes) {
+      StopReading(socket);
+      socket->write(Response("431 Request Header Fields Too Large",
+                             kTextContentType, "Request too large.\n", false));
+      socket->disconnectFromHost();
+    }
+    return;
+  }
+
+  const QByteArray request_line =
+      buffered.left(buffered.indexOf('\n')).trimmed();
+  StopReading(socket);
+  Respond(socket, request_line);
+}
+
+void MetricsServer::StopReading(QTcpSocket* socket) {
+  // Without this a client that kept sending after its answer would have its
+  // bytes buffered in a fresh entry, and once that entry grew past the limit,
+  // a second answer written behind the first.
+  partial_.remove(socket);
+  QObject::disconnect(socket, &QTcpSocket::readyRead, this, nullptr);
+
+  // Still read, though, and dropped. The socket goes on taking in whatever
+  // arrives whether or not anyone reads it, and a client that sends without
+  // reading keeps the close waiting on its answer until the timeout, so
+  // leaving it unread is memory without a bound. Reading it also keeps the
+  // kernel's buffer empty: a close that finds bytes left there goes out as a
+  // reset, and the reset can overtake the answer.
+  connect(socket, &QTcpSocket::readyRead, this,
+          [socket] { socket->skip(socket->bytesAvailable()); });
+}
+
+void MetricsServer::Respond(QTcpSocket* socket,
+                            const QByteArray& request_line) {
+  // "GET /metrics HTTP/1.1": a method, a target, and a version that is not
+  // looked at — every version since 1.0 asks for a page the same way.
+  const QList<QByteArray> words = request_line.split(' ');
+  if (words.size() != 3 || !words[2].startsWith("HTTP/")) {
+    socket->write(Response("400 Bad Request", kTextContentType,
+                           "Not an HTTP request.\n", false));
+    socket->disconnectFromHost();
+    return;
+  }
+
+  const QByteArray& method = words[0];
+  const bool head = method == "HEAD";
+  if (method != "GET" && !head) {
+    socket->write(Response("405 Method Not Allowed", kTextContentType,
+                           "Only GET and HEAD are served.\n", false,
+                           "Allow: GET, HEAD"));
+    socket->disconnectFromHost();
+    return;
+  }
+
+  // A query string is ignored rather than refused: some scrapers add one to
+  // every target they are given.
+  QByteArray path = words[1];
+  const qsizetype query = path.indexOf('?');
+  if (query >= 0) {
+    path.truncate(query);
+  }
+  if (path != kMetricsPath) {
+    socket->write(Response("404 Not Found", kTextContentType,
+                           QByteArray("The page is at ") + kMetricsPath + ".\n",
+                           head));
+    socket->disconnectFromHost();
+    return;
+  }
+
+  socket->write(Response("200 OK", kMetricsContentType, Page(), head));
+  socket->disconnectFromHost();
+}
+
+}  // namespace ddd::gui
@@ -0,0 +1,99 @@
+/************************************************************************
+
+    metrics_server.h
+
+    The metrics page a monitoring system scrapes, served on loopback
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QtGlobal>
+
+#include "metrics_exposition.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+namespace ddd::capture {
+class ILogger;
+}  // namespace ddd::capture
+
+namespace ddd::gui {
+
+class CaptureController;
+
+// The capture's figures as a page a metrics scraper fetches, for a host that
+// runs captures unattended and is watched from a dashboard rather than from a
+// window. See capture::CaptureMetrics for what is on the page.
+//
+// As little HTTP as a scraper needs and no more: GET or HEAD of /metrics, one
+// request per connection, answered and closed. Anything else is a 404 or a 405
+// and never touches the capture. No library for it, because the whole of the
+// protocol a scraper speaks is the request line, and a dependency that parsed
+// the rest would be a great deal of code to agree with about nothing.
+//
+// On the loopback interface only, as the monitor port is and for the same
+// reason. A scraper elsewhere reaches it through a tunnel or an agent on the
+// host, rather than through a port open to the network that nothing here
+// authenticates.
+//
+// Nothing about a scrape reaches the pipeline. The page is built on the GUI
+// thread from a copy taken through the stats publisher, which the pipeline
+// never waits for, and a scraper that connects and then says nothing is closed
+// after a few seconds rather than left holding a socket.
+class MetricsServer : public QObject {
+  Q_OBJECT
+
+ public:
+  MetricsServer(CaptureController* controller, capture::ILogger* logger,
+                QObject* parent = nullptr);
+  ~MetricsServer() override;
+
+  // Start listening on this port, or on whatever port is free for 0. False,
+  // with `error` in words meant for a user, when the port could not be taken.
+  bool Listen(quint16 port, QString* error);
+
+  bool listening() const;
+
+  // The port being listened on, or 0.
+  quint16 port() const;
+
+  // The page as a scrape would be sent it now. For the tests.
+  QByteArray Page() const;
+
+  static constexpr const char* kMetricsPath = "/metrics";
+
+ private:
+  void OnNewConnection();
+  void OnReadyRead(QTcpSocket* socket);
+
+  // Answer one request line and close the connection behind the answer.
+  void Respond(QTcpSocket* socket, const QByteArray& request_line);
+
+  // Stop listening to a connection that has had its answer: whatever else it
+  // sends while the close goes through is read and thrown away, neither
+  // buffered nor answered.
+  void StopReading(QTcpSocket* socket);
+
+  CaptureController* controller_ = nullptr;
+  capture::ILogger* logger_ = nullptr;
+  QTcpServer* server_ = nullptr;
+
+  // What has arrived on each connection before the end of its headers.
+  QHash<QTcpSocket*, QByteArray> partial_;
+
+  // Fed from every stats report for as long as the application runs, so that
+  // the histograms see the ring at the stats timer's rate rather than at the
+  // scraper's.
+  capture::CaptureMetrics metrics_;
+};
+
+}  // namespace ddd::gui
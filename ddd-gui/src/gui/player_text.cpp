@@ -149,6 +149,10 @@ QString UserCodeLine(const QString& label,
       code.text.begin(), code.text.end(), player::kUnreadableCharacter));
 
   if (unreadable == 0) {
+    if (code.from_cache) {
+      return QObject::tr("    %1: %2 (remembered from an earlier examination)")
+          .arg(label, Payload(code.text));
+    }
     return QObject::tr("    %1: %2").arg(label, Payload(code.text));
   }
 
@@ -1036,6 +1040,8 @@ QString ProvenanceNote(player::Provenance provenance) {
       return QObject::tr("inferred");
     case player::Provenance::kDeclared:
       return QObject::tr("declared");
+    case player::Provenance::kCached:
+      return QObject::tr("remembered from an earlier examination");
   }
   return QObject::tr("not established");
 }
@@ -1483,6 +1489,8 @@ const char* ProvenanceKeyword(player::Provenance provenance) {
       return "inferred";
     case player::Provenance::kDeclared:
       return "declared";
+    case player::Provenance::kCached:
+      return "cached";
     case player::Provenance::kUnknown:
       break;
   }
@@ -1545,6 +1553,10 @@ capture::PlayerIdentity DescribePlayerIdentity(
   return player;
 }
 
+std::string DescribeAddressing(player::AddressMode mode) {
+  return mode == player::AddressMode::kTimeCode ? "time code" : "frame";
+}
+
 capture::DiscScan DescribeDiscScan(const player::DiscProfile& disc) {
   capture::DiscScan scan;
   scan.examined = true;
@@ -1564,10 +1576,7 @@ capture::DiscScan DescribeDiscScan(const player::DiscProfile& disc) {
   scan.disc_type = Fact(disc.disc_type, [](player::DiscType type) {
     return DiscTypeName(type).toStdString();
   });
-  scan.addressing = Fact(disc.addressing, [](player::AddressMode value) {
-    return std::string(value == player::AddressMode::kTimeCode ? "time code"
-                                                               : "frame");
-  });
+  scan.addressing = Fact(disc.addressing, DescribeAddressing);
   scan.disc_size = Fact(disc.disc_size, [](player::DiscSize size) {
     return DiscSizeName(size).toStdString();
   });
@@ -14,6 +14,7 @@
 #include <QString>
 #include <cstdint>
 #include <optional>
+#include <string>
 
 #include "auto_capture_plan.h"
 #include "auto_capture_sequence.h"
@@ -312,4 +313,9 @@ capture::PlayerIdentity DescribePlayerIdentity(
 // a file that showed them alike would have to be believed rather than read.
 capture::DiscScan DescribeDiscScan(const player::DiscProfile& disc);
 
+// How a disc's addresses are written, in the sidecar's words: "frame" or "time
+// code". Shared by the disc section and the address index so the two cannot
+// come to name one mode differently.
+std::string DescribeAddressing(player::AddressMode mode);
+
 }  // namespace ddd::gui
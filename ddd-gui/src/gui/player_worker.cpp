@@ -11,7 +11,9 @@
 
 #include "player_worker.h"
 
+#include <QDir>
 #include <QElapsedTimer>
+#include <QStandardPaths>
 #include <QTimer>
 #include <algorithm>
 #include <utility>
@@ -107,6 +109,17 @@ PlayerConnectionProblem ProblemFor(const player::ProbeResult& result) {
 
 }  // namespace
 
+std::string DefaultDiscCachePath() {
+  const QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+  if (directory.isEmpty()) {
+    return std::string();
+  }
+  return QDir(directory)
+      .filePath(QStringLiteral("disc-cache.tsv"))
+      .toStdString();
+}
+
 PlayerWorker::PlayerWorker(PlayerBackend backend, capture::ILogger* logger,
                            QObject* parent)
     : QObject(parent), backend_(std::move(backend)), logger_(logger) {
@@ -303,8 +316,16 @@ void PlayerWorker::Examine(player::ExamineScope scope) {
   const bool was_paused = paused_;
   paused_ = true;
 
-  player::DiscExaminer examiner(*session_->identity().definition,
-                                session_->identity().firmware_version, scope);
+  const player::PlayerDefinition& definition = *session_->identity().definition;
+  if (!disc_cache_.has_value()) {
+    disc_cache_ = backend_.disc_cache_path.empty()
+                      ? player::DiscCache{}
+                      : player::DiscCache::Load(backend_.disc_cache_path);
+  }
+
+  player::DiscExaminer examiner(
+      definition, session_->identity().firmware_version, scope,
+      backend_.disc_cache_path.empty() ? nullptr : &*disc_cache_);
 
   Log(capture::LogLevel::kInfo, QStringLiteral("Examining the disc"));
 
@@ -334,6 +355,8 @@ void PlayerWorker::Examine(player::ExamineScope scope) {
   Log(capture::LogLevel::kInfo,
       QStringLiteral("Examination %1").arg(ExamineOutcomeText(outcome)));
 
+  UpdateDiscCache(definition, examiner);
+
   examining_ = false;
   paused_ = was_paused;
 
@@ -352,6 +375,56 @@ void PlayerWorker::Examine(player::ExamineScope scope) {
   }
 }
 
+void PlayerWorker::UpdateDiscCache(const player::PlayerDefinition& definition,
+                                   const player::DiscExaminer& examiner) {
+  if (backend_.disc_cache_path.empty() || !disc_cache_.has_value()) {
+    return;
+  }
+
+  bool changed = false;
+  switch (examiner.cache_match()) {
+    case player::CacheMatch::kConfirmed:
+      Log(capture::LogLevel::kInfo,
+          QStringLiteral("The disc matched one examined before, so its start "
+                         "and user code were taken from then rather than "
+                         "measured again"));
+      return;
+
+    case player::CacheMatch::kStale:
+      // Whatever happens next, the old entry is wrong. A completed
+      // examination replaces it below; anything less leaves nothing, which
+      // costs one full measurement next time and misleads nobody.
+      Log(capture::LogLevel::kInfo,
+          QStringLiteral("The disc resembled one examined before but did not "
+                         "end where that one did, so it was measured in full"));
+      if (const std::optional<player::DiscFingerprint> fingerprint =
+              player::FingerprintOf(definition.name, examiner.profile())) {
+        disc_cache_->Forget(*fingerprint);
+        changed = true;
+      }
+      break;
+
+    case player::CacheMatch::kNone:
+    case player::CacheMatch::kPending:
+      break;
+  }
+
+  // Only a full examination that ran to the end measured anything worth
+  // keeping. A cancelled one may have a length and no start, and an
+  // identifying one has neither.
+  if (examiner.scope() == player::ExamineScope::kFull &&
+      examiner.outcome() == player::ExamineOutcome::kCompleted &&
+      disc_cache_->Remember(definition.name, examiner.profile())) {
+    changed = true;
+  }
+
+  if (changed && !disc_cache_->Save(backend_.disc_cache_path)) {
+    Log(capture::LogLevel::kWarning,
+        QStringLiteral("The disc cache could not be written to %1")
+            .arg(QString::fromStdString(backend_.disc_cache_path)));
+  }
+}
+
 void PlayerWorker::Tick() {
   if (!running_ || stopping_.load() || session_ == nullptr) {
     return;
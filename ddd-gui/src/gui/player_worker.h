@@ -18,10 +18,14 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 // Included rather than forward declared: LogLevel is an enumeration, and the
 // worker's own logging helper takes one.
+#include "disc_cache.h"
+#include "disc_examiner.h"
 #include "logger.h"
 #include "player_connection.h"
 #include "player_metatypes.h"
@@ -52,8 +56,17 @@ struct PlayerBackend {
 
   // Where "now" comes from inside the protocol. Null means the steady clock.
   player::PlayerSession::Clock clock;
+
+  // The file examined discs are remembered in (player::DiscCache). Empty
+  // means nowhere, so every examination measures in full — the default, and
+  // what a test wants; the application passes DefaultDiscCachePath().
+  std::string disc_cache_path;
 };
 
+// Where the application keeps its disc cache: beside its other per-user data.
+// Empty where the platform names no such place.
+std::string DefaultDiscCachePath();
+
 // The serial link, on a thread of its own.
 //
 // It has to be off the interface thread, and the numbers say why: a command is
@@ -191,6 +204,11 @@ class PlayerWorker : public QObject {
 
   void Log(capture::LogLevel level, const QString& message) const;
 
+  // Keep what an examination measured, or forget what it showed to be wrong,
+  // and write the cache back if either changed it.
+  void UpdateDiscCache(const player::PlayerDefinition& definition,
+                       const player::DiscExaminer& examiner);
+
   PlayerBackend backend_;
   capture::ILogger* logger_ = nullptr;
 
@@ -223,6 +241,11 @@ class PlayerWorker : public QObject {
   // True while Examine() is on the stack, so a second one cannot start on top
   // of the first. Only this thread touches it.
   bool examining_ = false;
+
+  // Read from backend_.disc_cache_path on the first examination rather than at
+  // construction, so that an application that never examines a disc never
+  // reads the file. Only this thread touches it.
+  std::optional<player::DiscCache> disc_cache_;
 };
 
 }  // namespace ddd::gui
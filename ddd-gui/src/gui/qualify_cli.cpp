@@ -0,0 +1,215 @@
+/************************************************************************
+
+    qualify_cli.cpp
+
+    --qualify: measure this machine and choose the settings it can sustain
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "qualify_cli.h"
+
+#include <QDir>
+#include <QTextStream>
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "capture_settings.h"
+#include "flac_encode_probe.h"
+#include "flac_writer.h"
+#include "sample_format.h"
+
+namespace ddd::gui {
+namespace {
+
+constexpr int kHighestCompressionLevel = 8;
+constexpr double kBytesPerMegabyte = 1.0e6;
+constexpr double kMillisecondsPerSecond = 1000.0;
+
+QString Fixed(double value, int decimals = 2) {
+  return QString::number(value, 'f', decimals);
+}
+
+QString Milliseconds(double seconds) {
+  return Fixed(seconds * kMillisecondsPerSecond, 1) + QStringLiteral(" ms");
+}
+
+QString Mebibytes(size_t bytes) {
+  return QString::number(bytes >> 20) + QStringLiteral(" MiB");
+}
+
+QString Threads(unsigned int threads) {
+  return threads == 1 ? QStringLiteral("1 thread")
+                      : QStringLiteral("%1 threads").arg(threads);
+}
+
+// One, then doubling up to what the writer would start and the machine has.
+// Only one on a libFLAC that cannot encode on more: asking it for more would
+// time the same single-threaded encode again under another name.
+std::vector<unsigned int> ThreadCountsToTry() {
+  if (!capture::FlacWriter::SupportsMultithreading()) {
+    return {1};
+  }
+  const unsigned int cores = std::max(1U, std::thread::hardware_concurrency());
+  const unsigned int most =
+      std::min(cores, capture::FlacWriter::kMaximumEncoderThreads);
+  std::vector<unsigned int> counts;
+  for (unsigned int threads = 1; threads <= most; threads *= 2) {
+    counts.push_back(threads);
+  }
+  return counts;
+}
+
+}  // namespace
+
+int RunHostQualification(const CaptureCliOptions& cli, QTextStream& out,
+                         QTextStream& error, const QualifyOptions& options) {
+  CaptureSettings settings = LoadCaptureSettings();
+  ApplyCliOverrides(settings, cli);
+
+  const QString directory = settings.ResolvedCaptureDirectory();
+  std::error_code created;
+  std::filesystem::create_directories(directory.toStdString(), created);
+
+  capture::QualificationMeasurements measurements;
+  measurements.sample_rate_hz = settings.SampleRateHz();
+  measurements.output_format = settings.output_format;
+  const double wire_bytes_per_second =
+      static_cast<double>(measurements.sample_rate_hz) *
+      capture::kBytesPerSample;
+
+  out << "Qualifying this machine to capture at "
+      << Fixed(measurements.sample_rate_hz / 1.0e6, 0) << " Msps into "
+      << QDir::toNativeSeparators(directory) << ".\n";
+  out.flush();
+
+  measurements.write =
+      capture::ProbeWriteBandwidth(directory.toStdString(), options.write);
+  if (!measurements.write.ok) {
+    error << "Error: " << QString::fromStdString(measurements.write.error)
+          << "\n";
+    error.flush();
+    return kExitHostNotQualified;
+  }
+  const double disk_bytes_per_second = measurements.write.bytes_per_second;
+  const capture::WriteLatencySummary& latency = measurements.write.latency;
+  out << "Disk: " << Fixed(disk_bytes_per_second / kBytesPerMegabyte, 1)
+      << " MB/s sustained, "
+      << Fixed(disk_bytes_per_second / wire_bytes_per_second)
+      << "x the capture's rate. Writes took "
+      << Milliseconds(latency.median_seconds) << " median, "
+      << Milliseconds(latency.p99_seconds) << " at p99, "
+      << Milliseconds(latency.p999_seconds) << " at p99.9 and "
+      << Milliseconds(latency.worst_seconds) << " at worst.\n";
+  out.flush();
+
+  // Generated once and used for every probe that follows, so that each is
+  // measured on the same samples.
+  const auto signal_samples =
+      static_cast<size_t>(options.signal_seconds *
+                          static_cast<double>(measurements.sample_rate_hz));
+  std::vector<uint8_t> signal(
+      std::max<size_t>(signal_samples, 1) * capture::kBytesPerSample);
+  capture::GenerateQualificationRf(signal, measurements.sample_rate_hz);
+
+  measurements.validator_samples_per_second =
+      capture::ProbeValidatorThroughput(signal);
+  out << "Sample checking: "
+      << Fixed(measurements.validator_samples_per_second /
+               measurements.sample_rate_hz)
+      << "x the capture's rate.\n";
+  out.flush();
+
+  if (measurements.output_format == capture::CaptureOutputFormat::kFlac) {
+    const std::filesystem::path scratch =
+        std::filesystem::path((options.encode_directory.isEmpty()
+                                   ? QDir::tempPath()
+                                   : options.encode_directory)
+                                  .toStdString()) /
+        "ddd-qualify-encode.flac";
+    const std::vector<unsigned int> thread_counts = ThreadCountsToTry();
+
+    bool found = false;
+    for (int level = kHighestCompressionLevel; level >= 0 && !found; --level) {
+      for (const unsigned int threads : thread_counts) {
+        const capture::EncodeProbeResult encode =
+            capture::ProbeFlacEncode(scratch, signal, level, threads);
+        measurements.encodes.push_back(encode);
+
+        out << "FLAC level " << level << " on " << Threads(threads) << ": ";
+        if (!encode.ok) {
+          out << "failed, " << QString::fromStdString(encode.error) << "\n";
+        } else {
+          out << Fixed(encode.samples_per_second / measurements.sample_rate_hz)
+              << "x the capture's rate, "
+              << Fixed(encode.compression_ratio * 100.0, 1)
+              << "% of the raw size.\n";
+        }
+        out.flush();
+
+        if (capture::EncodeKeepsUp(measurements, encode, options.margins)) {
+          found = true;
+          break;
+        }
+      }
+    }
+  }
+
+  const capture::QualificationResult result =
+      capture::RecommendQualifiedSettings(measurements, options.margins);
+
+  out << "\n";
+  if (measurements.output_format == capture::CaptureOutputFormat::kFlac) {
+    out << (result.qualified ? "Recommended: " : "Nearest: ") << "FLAC level "
+        << result.compression_level << " on "
+        << Threads(result.encoder_threads) << ", a "
+        << Mebibytes(result.queue_size_bytes) << " buffer queue.\n";
+  } else {
+    out << (result.qualified ? "Recommended: " : "Nearest: ") << "a "
+        << Mebibytes(result.queue_size_bytes) << " buffer queue.\n";
+  }
+  out << "Headroom: the disk " << Fixed(result.write_headroom) << "x";
+  if (measurements.output_format == capture::CaptureOutputFormat::kFlac) {
+    out << ", the encoder " << Fixed(result.encode_headroom) << "x";
+  }
+  out << ", sample checking " << Fixed(result.validator_headroom)
+      << "x, against a margin of " << Fixed(options.margins.throughput)
+      << "x.\n";
+  out << "Stall tolerance: the disk can stall for "
+      << Fixed(result.stall_tolerance_seconds) << " s before samples are "
+      << "lost. The longest stall measured was "
+      << Fixed(result.worst_stall_seconds) << " s, and the margin asks for "
+      << Fixed(result.worst_stall_seconds * options.margins.stall) << " s.\n";
+  out << "Each of these was measured on its own. A capture runs them all at "
+      << "once, sharing the processor and memory, so they are a best case "
+      << "that the margin has to cover.\n";
+  out.flush();
+
+  if (!result.qualified) {
+    error << "Not qualified: " << QString::fromStdString(result.reason)
+          << " Nothing was saved.\n";
+    error.flush();
+    return kExitHostNotQualified;
+  }
+
+  // Loaded again rather than saving `settings`, which carries this run's
+  // command-line overrides: the folder, the rate and the format the
+  // measurement was made for are not this command's to save.
+  CaptureSettings saved = LoadCaptureSettings();
+  saved.queue_size_bytes = result.queue_size_bytes;
+  if (measurements.output_format == capture::CaptureOutputFormat::kFlac) {
+    saved.compression_level = result.compression_level;
+    saved.encoder_threads = result.encoder_threads;
+  }
+  SaveCaptureSettings(saved);
+
+  out << "Saved.\n";
+  out.flush();
+  return kExitSuccess;
+}
+
+}  // namespace ddd::gui
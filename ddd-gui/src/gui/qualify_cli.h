@@ -0,0 +1,63 @@
+/************************************************************************
+
+    qualify_cli.h
+
+    --qualify: measure this machine and choose the settings it can sustain
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <QString>
+
+#include "capture_cli.h"
+#include "host_qualification.h"
+
+class QTextStream;
+
+namespace ddd::gui {
+
+struct QualifyOptions {
+  capture::WriteProbeOptions write;
+  capture::QualificationMargins margins;
+
+  // How much generated signal each encoder configuration and the validator
+  // are timed on. Half a second of capture is long enough for a threaded
+  // encoder to have every thread busy, and short enough that the nine levels
+  // and their thread counts are minutes rather than an afternoon.
+  double signal_seconds = 0.5;
+
+  // Where the encoder writes its scratch files. Empty means the system's
+  // temporary folder — not the capture folder, whose speed the write probe
+  // has already measured and which would otherwise be counted twice.
+  QString encode_directory;
+};
+
+// Measure the capture folder's disk, the validator and the FLAC encoder at
+// each level and thread count, work out the ring size, level and threads they
+// support, print what was found, and save the three settings if the machine
+// qualifies.
+//
+// The folder, the rate and the format are the ones the capture will run with:
+// the saved settings, with whatever --capture-directory, --sample-rate and
+// --output-format say laid over them for this run. Only the three settings
+// worked out here are saved. A host that does not qualify has nothing saved,
+// since settings that are known not to keep up are no better than the ones it
+// had.
+//
+// The encoder is tried from level 8 down, and at each level on one thread and
+// then more, so that the first configuration to pass is the one wanted and the
+// rest are never run.
+//
+// The report goes to `out`, a line per measurement and then the verdict with
+// the stall the chosen ring would ride out in seconds. Returns kExitSuccess
+// for a host that qualifies and kExitHostNotQualified for one that does not,
+// including one whose folder could not be measured at all.
+int RunHostQualification(const CaptureCliOptions& cli, QTextStream& out,
+                         QTextStream& error,
+                         const QualifyOptions& options = {});
+
+}  // namespace ddd::gui
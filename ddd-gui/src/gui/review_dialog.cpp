@@ -0,0 +1,438 @@
+/************************************************************************
+
+    review_dialog.cpp
+
+    A finished capture's whole length, from its overview
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "review_dialog.h"
+
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QLabel>
+#include <QLocale>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QStackedWidget>
+#include <QVBoxLayout>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+#include "capture_overview_build.h"
+#include "log_format.h"
+#include "sample_format.h"
+#include "theme_color_tokens.h"
+
+namespace ddd::gui {
+namespace {
+
+// Room for the plot to breathe inside the dialog's frame. There is no scale to
+// reserve space for: the three guide lines say where the limits are.
+constexpr int kPlotMarginPixels = 6;
+
+// Wide enough that a two-hour capture is 1,300 columns of six seconds each,
+// which is the resolution a sagging level or a burst of clipping shows at.
+constexpr int kPlotMinimumWidthPixels = 720;
+constexpr int kPlotMinimumHeightPixels = 260;
+
+// How far one notch of the wheel zooms. A fifth per notch reaches a single
+// block from two hours in about forty notches, which is a few flicks rather
+// than a minute of scrolling.
+constexpr double kZoomPerNotch = 0.8;
+
+// The height of a clip mark along the top of the plot
+constexpr double kClipMarkPixels = 4.0;
+
+}  // namespace
+
+OverviewBuildWorker::OverviewBuildWorker(QString file_path, QObject* parent)
+    : QThread(parent), file_path_(std::move(file_path)) {}
+
+void OverviewBuildWorker::RequestCancel() { cancel_requested_ = true; }
+
+void OverviewBuildWorker::run() {
+  int last_percentage = -2;
+
+  const capture::OverviewBuild build = capture::BuildCaptureOverview(
+      std::filesystem::path(file_path_.toStdString()),
+      [this, &last_percentage](uint64_t measured,
+                               std::optional<uint64_t> total) {
+        int percentage = -1;
+        if (total.has_value() && *total > 0) {
+          percentage = static_cast<int>((measured * 100) / *total);
+        }
+
+        // Only when it changes, as the analysis worker does it
+        if (percentage != last_percentage) {
+          last_percentage = percentage;
+          emit Progress(percentage, static_cast<qulonglong>(measured));
+        }
+      },
+      [this] { return cancel_requested_.load(); });
+
+  emit Finished(build.built(), QString::fromStdString(build.message));
+}
+
+OverviewPlot::OverviewPlot(QWidget* parent) : QWidget(parent) {
+  setMinimumSize(kPlotMinimumWidthPixels, kPlotMinimumHeightPixels);
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+bool OverviewPlot::Open(const QString& overview_path, QString& error) {
+  std::string reason;
+  if (!file_.Open(std::filesystem::path(overview_path.toStdString()),
+                  reason)) {
+    error = QString::fromStdString(reason);
+    blocks_.clear();
+    columns_.clear();
+    update();
+    return false;
+  }
+
+  ShowWhole();
+  return true;
+}
+
+void OverviewPlot::ShowSpan(uint64_t first_sample, uint64_t sample_span) {
+  const uint64_t total = file_.total_samples();
+  sample_span_ = std::clamp(sample_span, std::min(MinimumSpan(), total), total);
+  first_sample_ = std::min(first_sample, total - sample_span_);
+  Refresh();
+  emit ViewChanged();
+}
+
+void OverviewPlot::ShowWhole() { ShowSpan(0, file_.total_samples()); }
+
+uint64_t OverviewPlot::MinimumSpan() const {
+  const analysis::WaveformMapping mapping = Mapping();
+  return std::max<uint64_t>(1, file_.block_samples()) *
+         static_cast<uint64_t>(std::max(1, mapping.width_pixels));
+}
+
+analysis::WaveformMapping OverviewPlot::Mapping() const {
+  analysis::WaveformMapping mapping;
+  mapping.width_pixels = std::max(0, width() - (2 * kPlotMarginPixels));
+  mapping.height_pixels = std::max(0, height() - (2 * kPlotMarginPixels));
+  mapping.first_sample = static_cast<size_t>(first_sample_);
+  mapping.sample_span = static_cast<size_t>(sample_span_);
+  return mapping;
+}
+
+void OverviewPlot::Refresh() {
+  blocks_.clear();
+  columns_.clear();
+
+  const analysis::WaveformMapping mapping = Mapping();
+  if (!file_.IsOpen() || !mapping.Valid()) {
+    update();
+    return;
+  }
+
+  level_ = file_.LevelFor(mapping.SamplesPerPixel());
+  if (!file_.ReadBlocks(level_, first_sample_, first_sample_ + sample_span_,
+                        blocks_)) {
+    blocks_.clear();
+  }
+  analysis::DecimateOverview(blocks_, mapping, columns_);
+  update();
+}
+
+void OverviewPlot::paintEvent(QPaintEvent* event) {
+  Q_UNUSED(event);
+
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing, false);
+
+  const QPalette& colours = palette();
+  const bool dark = theme_tokens::IsDarkPalette(colours);
+  painter.fillRect(rect(), colours.color(QPalette::Base));
+
+  const analysis::WaveformMapping mapping = Mapping();
+  if (!mapping.Valid()) {
+    return;
+  }
+
+  painter.translate(kPlotMarginPixels, kPlotMarginPixels);
+
+  // The clip levels and the centre, as the scope draws them, so the two read
+  // the same way.
+  const struct {
+    double code;
+    theme_tokens::PlotColorToken token;
+  } guides[] = {
+      {static_cast<double>(capture::kMaximumSampleValue),
+       theme_tokens::PlotColorToken::kClipMarker},
+      {static_cast<double>(capture::kSampleZeroOffset),
+       theme_tokens::PlotColorToken::kZeroReference},
+      {static_cast<double>(capture::kMinimumSampleValue),
+       theme_tokens::PlotColorToken::kClipMarker},
+  };
+  for (const auto& guide : guides) {
+    const double y = mapping.CodeToY(guide.code);
+    painter.setPen(
+        QPen(theme_tokens::PlotColor(guide.token, dark), 1.0, Qt::DashLine));
+    painter.drawLine(QPointF(0.0, y),
+                     QPointF(static_cast<double>(mapping.width_pixels), y));
+  }
+
+  const QPen envelope(theme_tokens::PlotColor(
+      theme_tokens::PlotColorToken::kAmplitudeEnvelope, dark));
+  const QPen rms(theme_tokens::PlotColor(
+      theme_tokens::PlotColorToken::kAmplitudeTrace, dark));
+  const QPen clip(theme_tokens::PlotColor(
+      theme_tokens::PlotColorToken::kClipMarker, dark));
+  const double centre = static_cast<double>(capture::kSampleZeroOffset);
+
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    const analysis::OverviewColumn& summary = columns_[column];
+    if (!summary.populated) {
+      continue;
+    }
+    const double x = static_cast<double>(column) + 0.5;
+
+    painter.setPen(envelope);
+    painter.drawLine(QPointF(x, mapping.CodeToY(summary.maximum)),
+                     QPointF(x, mapping.CodeToY(summary.minimum)));
+
+    // Inside the envelope, so a column whose level is right but whose extremes
+    // are one stray sample reads as the quiet column it mostly is.
+    painter.setPen(rms);
+    painter.drawLine(QPointF(x, mapping.CodeToY(centre + summary.rms)),
+                     QPointF(x, mapping.CodeToY(centre - summary.rms)));
+
+    if (summary.clipped > 0) {
+      painter.setPen(clip);
+      painter.drawLine(QPointF(x, 0.0), QPointF(x, kClipMarkPixels));
+    }
+  }
+}
+
+void OverviewPlot::resizeEvent(QResizeEvent* event) {
+  QWidget::resizeEvent(event);
+
+  // Through ShowSpan, so a window made wider cannot leave the view narrower
+  // than a block a column.
+  if (file_.IsOpen()) {
+    ShowSpan(first_sample_, sample_span_);
+  }
+}
+
+void OverviewPlot::wheelEvent(QWheelEvent* event) {
+  const analysis::WaveformMapping mapping = Mapping();
+  if (!file_.IsOpen() || !mapping.Valid()) {
+    return;
+  }
+
+  const double notches = event->angleDelta().y() / 120.0;
+  const double span = static_cast<double>(sample_span_) *
+                      std::pow(kZoomPerNotch, notches);
+
+  // About the cursor, so what is under it stays under it
+  const double fraction = std::clamp(
+      (event->position().x() - kPlotMarginPixels) / mapping.width_pixels, 0.0,
+      1.0);
+  const double anchor = static_cast<double>(first_sample_) +
+                        (fraction * static_cast<double>(sample_span_));
+  const double first = std::max(0.0, anchor - (fraction * span));
+
+  ShowSpan(static_cast<uint64_t>(first),
+           static_cast<uint64_t>(std::max(1.0, span)));
+  event->accept();
+}
+
+void OverviewPlot::mousePressEvent(QMouseEvent* event) {
+  if (event->button() != Qt::LeftButton) {
+    QWidget::mousePressEvent(event);
+    return;
+  }
+  dragging_ = true;
+  drag_x_ = event->position().x();
+  drag_first_sample_ = first_sample_;
+}
+
+void OverviewPlot::mouseMoveEvent(QMouseEvent* event) {
+  const analysis::WaveformMapping mapping = Mapping();
+  if (!dragging_ || (event->buttons() & Qt::LeftButton) == 0 ||
+      !mapping.Valid()) {
+    dragging_ = false;
+    return;
+  }
+
+  const double moved = (drag_x_ - event->position().x()) *
+                       mapping.SamplesPerPixel();
+  const double first =
+      std::max(0.0, static_cast<double>(drag_first_sample_) + moved);
+  ShowSpan(static_cast<uint64_t>(first), sample_span_);
+}
+
+void OverviewPlot::mouseDoubleClickEvent(QMouseEvent* event) {
+  Q_UNUSED(event);
+  ShowWhole();
+}
+
+ReviewDialog::ReviewDialog(QWidget* parent) : QDialog(parent) {
+  setWindowTitle(tr("Review capture"));
+
+  auto* layout = new QVBoxLayout(this);
+  layout->setContentsMargins(20, 20, 20, 16);
+  layout->setSpacing(12);
+
+  pages_ = new QStackedWidget(this);
+
+  progress_ = new QProgressBar(pages_);
+  progress_->setObjectName(QLatin1String(kProgressBarName));
+  progress_->setRange(0, 100);
+  pages_->addWidget(progress_);
+
+  plot_ = new OverviewPlot(pages_);
+  plot_->setObjectName(QLatin1String(kPlotName));
+  connect(plot_, &OverviewPlot::ViewChanged, this,
+          &ReviewDialog::OnViewChanged);
+  pages_->addWidget(plot_);
+
+  layout->addWidget(pages_, 1);
+
+  status_ = new QLabel(this);
+  status_->setObjectName(QLatin1String(kStatusLabelName));
+  status_->setWordWrap(true);
+  status_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+  layout->addWidget(status_);
+
+  auto* buttons = new QDialogButtonBox(this);
+  close_ = buttons->addButton(tr("Close"), QDialogButtonBox::RejectRole);
+  close_->setObjectName(QLatin1String(kCloseButtonName));
+  connect(close_, &QPushButton::clicked, this, &ReviewDialog::OnClosePressed);
+  layout->addWidget(buttons);
+}
+
+ReviewDialog::~ReviewDialog() {
+  // Stopped and joined before the object goes, for the reason the analysis
+  // dialog gives.
+  if (worker_ != nullptr) {
+    worker_->RequestCancel();
+    worker_->wait();
+  }
+}
+
+void ReviewDialog::ChooseFileAndReview(const QString& starting_directory) {
+  const QString file_path = QFileDialog::getOpenFileName(
+      this, tr("Select a capture to review"), starting_directory,
+      tr("Captures (*.flac *.s16);;All files (*)"));
+
+  if (file_path.isEmpty()) {
+    return;
+  }
+
+  Review(file_path);
+  exec();
+}
+
+void ReviewDialog::Review(const QString& capture_path) {
+  capture_path_ = capture_path;
+
+  // An overview that will not open — cut short, or from a format this build
+  // does not read — is measured again rather than reported: the capture it
+  // describes is still there, and that is what the user asked to see.
+  QString error;
+  const QString overview_path = QString::fromStdString(
+      capture::CaptureOverviewPath(capture_path.toStdString()).string());
+  if (QFileInfo::exists(overview_path) && plot_->Open(overview_path, error)) {
+    ShowOverview();
+    return;
+  }
+
+  pages_->setCurrentWidget(progress_);
+  progress_->setRange(0, 100);
+  progress_->setValue(0);
+  status_->setText(tr("%1 has no overview yet, so it is being measured. This "
+                      "happens once; the overview is kept beside the capture.")
+                       .arg(QFileInfo(capture_path).fileName()));
+  close_->setText(tr("Cancel"));
+
+  worker_ = new OverviewBuildWorker(capture_path, this);
+  connect(worker_, &OverviewBuildWorker::Progress, this,
+          &ReviewDialog::OnProgress);
+  connect(worker_, &OverviewBuildWorker::Finished, this,
+          &ReviewDialog::OnBuildFinished);
+  worker_->start();
+}
+
+void ReviewDialog::ShowOverview() {
+  pages_->setCurrentWidget(plot_);
+  close_->setText(tr("Close"));
+  OnViewChanged();
+}
+
+void ReviewDialog::OnProgress(int percentage, qulonglong samples_measured) {
+  if (percentage < 0) {
+    progress_->setRange(0, 0);
+  } else {
+    progress_->setRange(0, 100);
+    progress_->setValue(percentage);
+  }
+
+  status_->setText(
+      tr("Measured %1 samples…")
+          .arg(QLocale().toString(static_cast<qulonglong>(samples_measured))));
+}
+
+void ReviewDialog::OnBuildFinished(bool built, const QString& message) {
+  if (!built) {
+    progress_->setRange(0, 100);
+    progress_->setValue(0);
+    status_->setText(message);
+    close_->setText(tr("Close"));
+    return;
+  }
+
+  QString error;
+  const QString overview_path = QString::fromStdString(
+      capture::CaptureOverviewPath(capture_path_.toStdString()).string());
+  if (!plot_->Open(overview_path, error)) {
+    status_->setText(error);
+    close_->setText(tr("Close"));
+    return;
+  }
+  ShowOverview();
+}
+
+void ReviewDialog::OnViewChanged() {
+  // Timed at the rate the overview was written with. One measured from an
+  // uncompressed file has none, since nothing in the file says, and is timed
+  // at the device's full rate — right for an undecimated capture, and short
+  // by the factor for any other.
+  const uint32_t rate = plot_->sample_rate_hz() != 0
+                            ? plot_->sample_rate_hz()
+                            : capture::kSampleRateHz;
+  const uint64_t first = plot_->first_sample();
+  const uint64_t last = first + plot_->sample_span();
+  status_->setText(
+      tr("%1 — %2 to %3 of %4. Scroll to zoom, drag to move, double-click "
+         "for the whole capture.")
+          .arg(QFileInfo(capture_path_).fileName(),
+               QString::fromStdString(
+                   capture::FormatSampleDuration(first, rate)),
+               QString::fromStdString(
+                   capture::FormatSampleDuration(last, rate)),
+               QString::fromStdString(capture::FormatSampleDuration(
+                   plot_->total_samples(), rate))));
+}
+
+void ReviewDialog::OnClosePressed() {
+  if (worker_ != nullptr && worker_->isRunning()) {
+    worker_->RequestCancel();
+    return;
+  }
+  accept();
+}
+
+}  // namespace ddd::gui
@@ -0,0 +1,183 @@
+/************************************************************************
+
+    review_dialog.h
+
+    A finished capture's whole length, from its overview
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <QDialog>
+#include <QString>
+#include <QThread>
+#include <QWidget>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "capture_overview.h"
+#include "overview_columns.h"
+
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QStackedWidget;
+
+namespace ddd::gui {
+
+// Measures a capture that has no overview, off the GUI thread and for the
+// reason TestDataAnalysisWorker is: a FLAC disc side takes minutes to decode,
+// and the cancel button has to stay paintable throughout.
+class OverviewBuildWorker : public QThread {
+  Q_OBJECT
+
+ public:
+  explicit OverviewBuildWorker(QString file_path, QObject* parent = nullptr);
+
+  void RequestCancel();
+
+ signals:
+  // percentage is -1 when the file does not know its own length, as in the
+  // test-data analysis.
+  void Progress(int percentage, qulonglong samples_measured);
+  void Finished(bool built, const QString& message);
+
+ protected:
+  void run() override;
+
+ private:
+  QString file_path_;
+  std::atomic<bool> cancel_requested_{false};
+};
+
+// The whole of a capture as an envelope: a bar from the lowest code to the
+// highest across each pixel column, the RMS either side of mid-scale inside
+// it, and a mark along the top wherever anything clipped.
+//
+// Drawn from the overview file a level and a span at a time. Each change of
+// view asks the file for the coarsest level whose blocks fit a column and for
+// the blocks of the span on screen and no others (see
+// CaptureOverviewFile::LevelFor), so a two-hour capture draws whole as fast as
+// it draws a minute of itself.
+//
+// The wheel zooms about the cursor, a drag pans, and a double click goes back
+// to the whole file. Zooming stops where a column is one first-level block
+// wide: below that the overview has nothing more to say, and the waveform of
+// those samples is in the capture, not here.
+//
+// Thread-safety: NOT thread-safe. GUI thread only.
+class OverviewPlot : public QWidget {
+  Q_OBJECT
+
+ public:
+  explicit OverviewPlot(QWidget* parent = nullptr);
+
+  // Show the overview at `overview_path`, whole. Returns false with the reason
+  // in `error`, leaving the plot empty.
+  bool Open(const QString& overview_path, QString& error);
+
+  // The window on display, in samples
+  void ShowSpan(uint64_t first_sample, uint64_t sample_span);
+  void ShowWhole();
+
+  uint64_t first_sample() const { return first_sample_; }
+  uint64_t sample_span() const { return sample_span_; }
+  uint64_t total_samples() const { return file_.total_samples(); }
+
+  // The capture's rate, or 0 where its overview does not say
+  uint32_t sample_rate_hz() const { return file_.sample_rate_hz(); }
+
+  // The level the current view was drawn from. Held so a test can assert that
+  // zooming in reads a finer level, which no screenshot shows.
+  size_t level() const { return level_; }
+
+ signals:
+  void ViewChanged();
+
+ protected:
+  void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
+  void wheelEvent(QWheelEvent* event) override;
+  void mousePressEvent(QMouseEvent* event) override;
+  void mouseMoveEvent(QMouseEvent* event) override;
+  void mouseDoubleClickEvent(QMouseEvent* event) override;
+
+ private:
+  analysis::WaveformMapping Mapping() const;
+
+  // Read the view's blocks from the file and reduce them to columns. Done when
+  // the view or the size changes, not on every paint.
+  void Refresh();
+
+  // The narrowest span the plot will zoom to: one first-level block a column
+  uint64_t MinimumSpan() const;
+
+  capture::CaptureOverviewFile file_;
+  uint64_t first_sample_ = 0;
+  uint64_t sample_span_ = 0;
+  size_t level_ = 0;
+
+  std::vector<capture::OverviewBlock> blocks_;
+  std::vector<analysis::OverviewColumn> columns_;
+
+  bool dragging_ = false;
+  double drag_x_ = 0.0;
+  uint64_t drag_first_sample_ = 0;
+};
+
+// "Review capture…".
+//
+// Opens a finished capture's overview and shows it whole. A capture with no
+// overview beside it — taken before the application kept them, or by a
+// process that was killed before it could write one — is measured first, with
+// a progress bar and a way out, and the overview that produces is kept so the
+// wait happens once per file.
+//
+// Thread-safety: NOT thread-safe. GUI thread only.
+class ReviewDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  explicit ReviewDialog(QWidget* parent = nullptr);
+  ~ReviewDialog() override;
+
+  // Ask for a capture and review it. Returns without showing anything if the
+  // chooser was dismissed.
+  void ChooseFileAndReview(const QString& starting_directory);
+
+  // Review a named capture. Separated from the chooser so a test can drive the
+  // dialog without a modal file dialog in the way.
+  void Review(const QString& capture_path);
+
+  OverviewPlot* plot() const { return plot_; }
+
+  static constexpr const char* kPlotName = "review_plot";
+  static constexpr const char* kProgressBarName = "review_progress";
+  static constexpr const char* kStatusLabelName = "review_status";
+  static constexpr const char* kCloseButtonName = "review_close";
+
+ private slots:
+  void OnProgress(int percentage, qulonglong samples_measured);
+  void OnBuildFinished(bool built, const QString& message);
+  void OnViewChanged();
+  void OnClosePressed();
+
+ private:
+  void ShowOverview();
+
+  QString capture_path_;
+
+  QStackedWidget* pages_ = nullptr;
+  QProgressBar* progress_ = nullptr;
+  OverviewPlot* plot_ = nullptr;
+  QLabel* status_ = nullptr;
+  QPushButton* close_ = nullptr;
+
+  OverviewBuildWorker* worker_ = nullptr;
+};
+
+}  // namespace ddd::gui
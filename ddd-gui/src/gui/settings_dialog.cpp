@@ -181,6 +181,18 @@ QWidget* SettingsDialog::BuildCapturePage(
       "transfer completing and the next being submitted."));
   form->addRow(tr("USB transfers"), transfer_mode_);
 
+  wire_format_ = new QComboBox(page);
+  wire_format_->setObjectName(QLatin1String(kWireFormatComboName));
+  wire_format_->addItem(tr("One word per sample (recommended)"), false);
+  wire_format_->addItem(tr("Packed, ten bits per sample"), true);
+  wire_format_->setCurrentIndex(capture_.packed_wire ? 1 : 0);
+  wire_format_->setToolTip(
+      tr("Packed sends the same samples in five eighths of the bandwidth, "
+         "50 MB/s rather than 80, for a USB 3 port that cannot keep up with "
+         "the full rate. It needs gateware that can pack; a device without it "
+         "streams one word per sample whatever is chosen here."));
+  form->addRow(tr("Wire format"), wire_format_);
+
   front_end_gain_ = new QComboBox(page);
   front_end_gain_->setObjectName(QLatin1String(kFrontEndGainComboName));
 
@@ -368,6 +380,7 @@ CaptureSettings SettingsDialog::Settings() const {
   result.queue_size_bytes =
       static_cast<size_t>(queue_size_->currentData().toULongLong());
   result.small_transfers = transfer_mode_->currentData().toBool();
+  result.packed_wire = wire_format_->currentData().toBool();
   result.preferred_device_path = device_->currentData().toString();
   result.capture_directory = directory_->text();
   result.front_end_gain_switches =
@@ -65,6 +65,7 @@ class SettingsDialog : public QDialog {
   static constexpr const char* kQueueSizeComboName = "settings_queue_size";
   static constexpr const char* kTransferModeComboName =
       "settings_transfer_mode";
+  static constexpr const char* kWireFormatComboName = "settings_wire_format";
   static constexpr const char* kDeviceComboName = "settings_device";
   static constexpr const char* kDirectoryEditName = "settings_directory";
   static constexpr const char* kBrowseButtonName = "settings_browse";
@@ -93,6 +94,7 @@ class SettingsDialog : public QDialog {
 
   QComboBox* queue_size_ = nullptr;
   QComboBox* transfer_mode_ = nullptr;
+  QComboBox* wire_format_ = nullptr;
   QComboBox* device_ = nullptr;
   QLineEdit* directory_ = nullptr;
   QComboBox* front_end_gain_ = nullptr;
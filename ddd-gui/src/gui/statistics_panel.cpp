@@ -105,6 +105,13 @@ StatisticsPanel::StatisticsPanel(CaptureController* controller, QWidget* parent)
   amplitude_ = add_row(tr("Signal level"), kAmplitudeLabelName);
   extremes_ = add_row(tr("Extremes"), kExtremesLabelName);
   clipping_ = add_row(tr("Clipping"), kClippingLabelName);
+  dropouts_ = add_row(tr("Dropouts"), kDropoutsLabelName, true);
+  dropouts_->setToolTip(
+      tr("Places where the RF envelope collapsed — damage on the disc passing "
+         "under the pickup — found while the signal goes past rather than in "
+         "a decode afterwards. A side with many, or with long ones, is worth "
+         "capturing again before the disc leaves the player. Every one found "
+         "in a capture is listed in its metadata file."));
   transfers_ = add_row(tr("Transfers"), kTransfersLabelName);
   samples_ = add_row(tr("Samples"), kSamplesLabelName);
   elapsed_ = add_row(tr("Elapsed"), kElapsedLabelName);
@@ -225,6 +232,7 @@ void StatisticsPanel::Apply(const StatisticsView& view) {
   amplitude_->setText(view.signal_level);
   extremes_->setText(view.extremes);
   clipping_->setText(view.clipping);
+  dropouts_->setText(view.dropouts);
   transfers_->setText(view.transfers);
   samples_->setText(view.samples);
   elapsed_->setText(view.elapsed);
@@ -56,6 +56,7 @@ class StatisticsPanel : public QWidget {
   static constexpr const char* kAmplitudeLabelName = "statistics_amplitude";
   static constexpr const char* kExtremesLabelName = "statistics_extremes";
   static constexpr const char* kClippingLabelName = "statistics_clipping";
+  static constexpr const char* kDropoutsLabelName = "statistics_dropouts";
   static constexpr const char* kTransfersLabelName = "statistics_transfers";
   static constexpr const char* kSamplesLabelName = "statistics_samples";
   static constexpr const char* kElapsedLabelName = "statistics_elapsed";
@@ -98,6 +99,7 @@ class StatisticsPanel : public QWidget {
   QLabel* amplitude_ = nullptr;
   QLabel* extremes_ = nullptr;
   QLabel* clipping_ = nullptr;
+  QLabel* dropouts_ = nullptr;
   QLabel* transfers_ = nullptr;
   QLabel* samples_ = nullptr;
   QLabel* elapsed_ = nullptr;
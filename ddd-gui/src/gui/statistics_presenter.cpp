@@ -254,6 +254,39 @@ QString FormatEncoderBacklog(uint64_t samples_pending,
       .arg(samples_pending);
 }
 
+QString FormatDropouts(const capture::DropoutSummary& dropouts, bool writing,
+                       uint32_t sample_rate_hz) {
+  if (sample_rate_hz == 0) {
+    sample_rate_hz = capture::kSampleRateHz;
+  }
+
+  // Microseconds up to a millisecond, because that is where dropouts live, and
+  // milliseconds past it for the totals a long bad patch runs up
+  const auto length = [sample_rate_hz](uint64_t samples) {
+    const double seconds =
+        static_cast<double>(samples) / static_cast<double>(sample_rate_hz);
+    if (seconds < 1.0e-3) {
+      return Translate("%1 µs").arg(seconds * 1.0e6, 0, 'f', 0);
+    }
+    return Translate("%1 ms").arg(seconds * 1.0e3, 0, 'f', 1);
+  };
+
+  if (dropouts.event_count == 0) {
+    return dropouts.armed ? Translate("None")
+                          : Translate("Not watching — no signal to measure");
+  }
+
+  QString text = Translate("%1, %2 in all, longest %3")
+                     .arg(FormatCount(dropouts.event_count))
+                     .arg(length(dropouts.dropout_samples))
+                     .arg(length(dropouts.longest_samples));
+  if (writing) {
+    text += Translate("  (%1 in this file)")
+                .arg(FormatCount(dropouts.capture_event_count));
+  }
+  return text;
+}
+
 QString FormatSpaceRemaining(const capture::FreeSpace& space,
                              double bytes_per_second) {
   if (!space.known) {
@@ -281,6 +314,7 @@ StatisticsView PresentIdleStatistics(const analysis::FrontEndGain& gain,
   view.signal_level = None();
   view.extremes = None();
   view.clipping = None();
+  view.dropouts = None();
   view.transfers = None();
   view.samples = None();
   view.elapsed = None();
@@ -352,7 +386,16 @@ StatisticsView PresentStatistics(const capture::CaptureStats& stats,
                         .arg(stats.metrics.recent_clipped_low_count)
                         .arg(stats.metrics.recent_clipped_high_count);
 
+    // While only monitoring, the figures above are measured over a share of
+    // the run, and the count says how large a share.
     view.samples = FormatCount(stats.metrics.sample_count);
+    if (stats.metrics.measured_sample_count < stats.metrics.sample_count) {
+      view.samples = Translate("%1  (%2 measured)")
+                         .arg(view.samples)
+                         .arg(FormatCount(stats.metrics.measured_sample_count));
+    }
+    view.dropouts =
+        FormatDropouts(stats.dropouts, stats.writing, sample_rate_hz);
   }
 
   view.transfers = Translate("%1 transfers, %2 buffers")
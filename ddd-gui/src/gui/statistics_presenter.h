@@ -58,6 +58,10 @@ struct StatisticsView {
   QString extremes;
   QString clipping;
 
+  // How often the RF has collapsed, how much of it has been lost, and how
+  // much of that is in the file being written. See FormatDropouts.
+  QString dropouts;
+
   // Both scaled — see FormatCount. Ninety thousand million samples written out
   // in full is a figure nobody reads.
   QString transfers;
@@ -167,6 +171,16 @@ QString FormatCount(uint64_t value);
 QString FormatEncoderBacklog(uint64_t samples_pending,
                              uint32_t sample_rate_hz = capture::kSampleRateHz);
 
+// The dropout row: the count since the run started, what they add up to and
+// the longest, as lengths of signal — "14, 0.6 ms in all, longest 85 µs" —
+// with the file's own count beside them while one is being written.
+//
+// A detector that is not armed says so instead of reporting none. With no
+// signal in front of it there is nothing to drop out of, and "0" there would
+// read as a clean disc.
+QString FormatDropouts(const capture::DropoutSummary& dropouts, bool writing,
+                       uint32_t sample_rate_hz = capture::kSampleRateHz);
+
 // How much capture a volume will hold, as a time and a size.
 //
 // The rate is passed in because it is not a constant: an uncompressed capture
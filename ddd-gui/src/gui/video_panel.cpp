@@ -0,0 +1,273 @@
+/************************************************************************
+
+    video_panel.cpp
+
+    The picture on the disc, demodulated live
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "video_panel.h"
+
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QVBoxLayout>
+
+#include "analysis_worker.h"
+#include "capture_controller.h"
+
+namespace ddd::gui {
+namespace {
+
+constexpr double kPictureAspect = 4.0 / 3.0;
+
+// How quickly the displayed rate follows a change. Fields arrive a couple of
+// times a second, so this settles in a few seconds — quick enough to show a
+// machine starting to struggle, slow enough not to flicker between figures.
+constexpr double kIntervalSmoothing = 0.3;
+
+}  // namespace
+
+QString FormatVideoStatus(const analysis::VideoField& field,
+                          double fields_per_second) {
+  if (field.empty()) {
+    return VideoPanel::tr("Waiting for a vertical sync");
+  }
+
+  const QString standard =
+      QString::fromLatin1(analysis::PresetFor(field.standard).name);
+  const QString locked = VideoPanel::tr("%1 · %2 of %3 lines locked")
+                             .arg(standard)
+                             .arg(field.locked_rows)
+                             .arg(field.rows);
+  if (fields_per_second <= 0.0) {
+    return locked;
+  }
+  return VideoPanel::tr("%1 · %2 fields/s")
+      .arg(locked)
+      .arg(fields_per_second, 0, 'f', 1);
+}
+
+QString FormatVideoRateRefusal(analysis::VideoStandard standard,
+                               uint32_t sample_rate_hz) {
+  return VideoPanel::tr(
+             "At %1 Msps the %2 carrier has been filtered out; the picture "
+             "needs a full- or half-rate stream")
+      .arg(static_cast<double>(sample_rate_hz) / 1.0e6, 0, 'g', 3)
+      .arg(QString::fromLatin1(analysis::PresetFor(standard).name));
+}
+
+VideoPicture::VideoPicture(QWidget* parent) : QWidget(parent) {
+  setMinimumSize(160, 120);
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void VideoPicture::SetField(const analysis::VideoField& field) {
+  if (field.empty()) {
+    Clear();
+    return;
+  }
+
+  // Copied rather than wrapped: the field is the signal's copy of the worker's
+  // buffer and goes when the slot returns, and an image wrapping it would be
+  // drawn from freed memory on the next paint.
+  image_ = QImage(field.pixels.data(), static_cast<int>(field.width),
+                  static_cast<int>(field.rows), static_cast<int>(field.width),
+                  QImage::Format_Grayscale8)
+               .copy();
+  update();
+}
+
+void VideoPicture::Clear() {
+  image_ = QImage();
+  update();
+}
+
+QRectF VideoPicture::PictureArea() const {
+  const QRectF whole = rect();
+  double width = whole.width();
+  double height = width / kPictureAspect;
+  if (height > whole.height()) {
+    height = whole.height();
+    width = height * kPictureAspect;
+  }
+  return {whole.center().x() - (width / 2.0),
+          whole.center().y() - (height / 2.0), width, height};
+}
+
+void VideoPicture::paintEvent(QPaintEvent* /*event*/) {
+  QPainter painter(this);
+  painter.fillRect(rect(), palette().window());
+
+  const QRectF area = PictureArea();
+  if (image_.isNull()) {
+    painter.fillRect(area, Qt::black);
+    painter.setPen(palette().color(QPalette::PlaceholderText));
+    painter.drawText(area, Qt::AlignCenter, tr("No picture"));
+    return;
+  }
+
+  painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+  painter.drawImage(area, image_);
+}
+
+VideoPanel::VideoPanel(CaptureController* controller, QWidget* parent)
+    : QWidget(parent), controller_(controller) {
+  auto* layout = new QVBoxLayout(this);
+  layout->setContentsMargins(8, 8, 8, 8);
+
+  picture_ = new VideoPicture(this);
+  picture_->setObjectName(QLatin1String(kPictureName));
+  layout->addWidget(picture_, 1);
+
+  auto* controls = new QHBoxLayout();
+
+  standard_ = new QComboBox(this);
+  standard_->setObjectName(QLatin1String(kStandardComboName));
+  standard_->addItem(QStringLiteral("PAL"),
+                     static_cast<int>(analysis::VideoStandard::kPal));
+  standard_->addItem(QStringLiteral("NTSC"),
+                     static_cast<int>(analysis::VideoStandard::kNtsc));
+  standard_->setToolTip(
+      tr("The disc's standard, which sets the carrier frequencies the picture "
+         "is read against and the line timing it is drawn with. The wrong one "
+         "gives a picture that will not lock."));
+  connect(standard_, &QComboBox::currentIndexChanged, this, [this](int) {
+    Restart();
+    ApplyPreview();
+    UpdateStatus();
+  });
+  controls->addWidget(standard_);
+
+  status_ = new QLabel(this);
+  status_->setObjectName(QLatin1String(kStatusLabelName));
+  status_->setTextInteractionFlags(Qt::TextSelectableByMouse);
+  status_->setToolTip(
+      tr("A preview, not a decode: one field in grey, a couple of times a "
+         "second, with each line placed on its own sync. Lines locked counts "
+         "the lines whose sync was found where it should be; a healthy disc "
+         "locks all but the vertical interval. Fields arrive less often on a "
+         "slower machine, because the preview is held to a tenth of one "
+         "core rather than allowed to slow the other panels."));
+  controls->addWidget(status_, 1);
+
+  layout->addLayout(controls);
+
+  if (controller_ != nullptr) {
+    SetSampleRate(controller_->settings().SampleRateHz());
+
+    connect(controller_->analysis(), &AnalysisWorker::VideoFieldReady, this,
+            &VideoPanel::OnVideoFieldReady);
+    connect(controller_, &CaptureController::MonitoringChanged, this,
+            &VideoPanel::OnMonitoringChanged);
+    connect(controller_, &CaptureController::SettingsChanged, this,
+            [this](const CaptureSettings& settings) {
+              SetSampleRate(settings.SampleRateHz());
+            });
+  }
+
+  UpdateStatus();
+}
+
+analysis::VideoStandard VideoPanel::standard() const {
+  return static_cast<analysis::VideoStandard>(standard_->currentData().toInt());
+}
+
+void VideoPanel::OnVideoFieldReady(const ddd::analysis::VideoField& field) {
+  if (field.standard != standard()) {
+    // Rendered under the previous choice, and already on its way when the
+    // combo moved
+    return;
+  }
+
+  if (since_field_.isValid()) {
+    const double interval =
+        static_cast<double>(since_field_.elapsed()) / 1000.0;
+    field_interval_seconds_ =
+        field_interval_seconds_ <= 0.0
+            ? interval
+            : field_interval_seconds_ +
+                  (kIntervalSmoothing * (interval - field_interval_seconds_));
+  }
+  since_field_.start();
+
+  last_field_ = field;
+  picture_->SetField(field);
+  UpdateStatus();
+}
+
+void VideoPanel::OnMonitoringChanged(bool monitoring) {
+  if (!monitoring) {
+    return;
+  }
+
+  Restart();
+
+  // The worker is built fresh for each run, as the spectrum panel's note on
+  // the same call explains
+  ApplyPreview();
+  UpdateStatus();
+}
+
+void VideoPanel::SetSampleRate(uint32_t sample_rate_hz) {
+  if (sample_rate_hz == 0 || sample_rate_hz == sample_rate_hz_) {
+    return;
+  }
+  sample_rate_hz_ = sample_rate_hz;
+  Restart();
+  ApplyPreview();
+  UpdateStatus();
+}
+
+void VideoPanel::showEvent(QShowEvent* event) {
+  QWidget::showEvent(event);
+  ApplyPreview();
+}
+
+void VideoPanel::hideEvent(QHideEvent* event) {
+  QWidget::hideEvent(event);
+
+  // The last picture stays for when the panel is shown again, but the next
+  // field is not timed against it: the time between them is how long the
+  // panel was hidden.
+  since_field_.invalidate();
+  field_interval_seconds_ = 0.0;
+  ApplyPreview();
+}
+
+void VideoPanel::ApplyPreview() {
+  if (controller_ != nullptr) {
+    controller_->analysis()->SetVideoPreview(isVisible(), standard(),
+                                             sample_rate_hz_);
+
+    // The pipeline's side of the same decision. A rate that has filtered the
+    // carrier out is a picture that cannot be drawn, so it is not copied for
+    controller_->SetFieldPreviewWanted(
+        isVisible() &&
+        analysis::VideoPreview::RateCarries(standard(), sample_rate_hz_));
+  }
+}
+
+void VideoPanel::Restart() {
+  picture_->Clear();
+  last_field_ = analysis::VideoField();
+  since_field_.invalidate();
+  field_interval_seconds_ = 0.0;
+}
+
+void VideoPanel::UpdateStatus() {
+  if (!analysis::VideoPreview::RateCarries(standard(), sample_rate_hz_)) {
+    status_->setText(FormatVideoRateRefusal(standard(), sample_rate_hz_));
+    return;
+  }
+
+  const double rate =
+      field_interval_seconds_ > 0.0 ? 1.0 / field_interval_seconds_ : 0.0;
+  status_->setText(FormatVideoStatus(last_field_, rate));
+}
+
+}  // namespace ddd::gui
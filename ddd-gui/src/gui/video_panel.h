@@ -0,0 +1,133 @@
+/************************************************************************
+
+    video_panel.h
+
+    The picture on the disc, demodulated live
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QWidget>
+#include <cstdint>
+
+#include "capture_metatypes.h"
+#include "sample_format.h"
+#include "video_preview.h"
+
+class QComboBox;
+class QLabel;
+
+namespace ddd::gui {
+
+class CaptureController;
+
+// One field, drawn at the shape a television would draw it.
+//
+// The raster is 256 columns by 312 rows, which stretched to fill the panel
+// would be a tall narrow picture nobody recognises. It is drawn 4:3 instead,
+// letterboxed into whatever space the dock has, and smoothed as it is scaled:
+// a low-resolution field drawn with hard pixel edges reads as a fault in the
+// signal rather than as a property of the preview.
+class VideoPicture : public QWidget {
+  Q_OBJECT
+
+ public:
+  explicit VideoPicture(QWidget* parent = nullptr);
+
+  void SetField(const analysis::VideoField& field);
+  void Clear();
+
+  bool has_field() const { return !image_.isNull(); }
+  const QImage& image() const { return image_; }
+
+  // Where the picture is drawn: the largest 4:3 rectangle the widget holds.
+  QRectF PictureArea() const;
+
+  QSize sizeHint() const override { return {320, 240}; }
+
+ protected:
+  void paintEvent(QPaintEvent* event) override;
+
+ private:
+  QImage image_;
+};
+
+// The video preview panel: the picture, the standard, and how well it locked.
+//
+// The demodulation is on the analysis thread and costs something — a share of
+// one core while it runs — so it runs only while this panel can be seen. A
+// hidden dock, a minimised window or a panel nobody has opened asks the worker
+// for nothing at all.
+class VideoPanel : public QWidget {
+  Q_OBJECT
+
+ public:
+  explicit VideoPanel(CaptureController* controller,
+                      QWidget* parent = nullptr);
+
+  static constexpr const char* kPictureName = "video_picture";
+  static constexpr const char* kStandardComboName = "video_standard_combo";
+  static constexpr const char* kStatusLabelName = "video_status_label";
+
+  analysis::VideoStandard standard() const;
+
+ public slots:
+  void OnVideoFieldReady(const ddd::analysis::VideoField& field);
+  void OnMonitoringChanged(bool monitoring);
+
+  // The stream's rate, which decides whether the carrier is there to
+  // demodulate at all: a quarter-rate capture has filtered it out.
+  void SetSampleRate(uint32_t sample_rate_hz);
+
+ protected:
+  void showEvent(QShowEvent* event) override;
+  void hideEvent(QHideEvent* event) override;
+
+ private:
+  // Tell the worker what to do, from what is chosen and whether anybody can
+  // see the result.
+  void ApplyPreview();
+  void UpdateStatus();
+
+  // Forget the picture and the rate, for a stream that is not the one they
+  // were measured on.
+  void Restart();
+
+  CaptureController* controller_ = nullptr;
+  uint32_t sample_rate_hz_ = capture::kSampleRateHz;
+
+  // The interval between fields, measured as they arrive and smoothed. The
+  // pacer on the worker decides it, and a machine that is struggling shows
+  // here first, as a rate that falls. Only the fields of one unbroken stream
+  // are timed against each other: a gap the panel caused, by being hidden or
+  // by asking for something else, is not the machine slowing down.
+  QElapsedTimer since_field_;
+  double field_interval_seconds_ = 0.0;
+
+  // The most recent field's lock count, for the status line
+  analysis::VideoField last_field_;
+
+  VideoPicture* picture_ = nullptr;
+  QComboBox* standard_ = nullptr;
+  QLabel* status_ = nullptr;
+};
+
+// The status line: the standard, how many lines locked, and the rate fields
+// are arriving at — "PAL · 298 of 312 lines locked · 1.9 fields/s". Before a
+// field has arrived, what it is waiting for. A rate of zero or less is left
+// out rather than shown as nothing.
+QString FormatVideoStatus(const analysis::VideoField& field,
+                          double fields_per_second);
+
+// Why there is no picture when the rate is the reason: a decimated stream
+// whose Nyquist is below the standard's peak white.
+QString FormatVideoRateRefusal(analysis::VideoStandard standard,
+                               uint32_t sample_rate_hz);
+
+}  // namespace ddd::gui
@@ -126,8 +126,10 @@ WaveformPlot::WaveformPlot(QWidget* parent) : QWidget(parent) {
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 }
 
-void WaveformPlot::SetCodes(const std::vector<uint16_t>& codes) {
+void WaveformPlot::SetCodes(const std::vector<uint16_t>& codes,
+                            double trigger_position) {
   codes_ = codes;
+  snapshot_trigger_ = trigger_position;
   sweeps_valid_ = false;
 
   // A new snapshot is what the fade is measured in. See the alpha above.
@@ -193,6 +195,7 @@ void WaveformPlot::SetSampleRate(uint32_t sample_rate_hz) {
 
 void WaveformPlot::Clear() {
   codes_.clear();
+  snapshot_trigger_ = -1.0;
   sweeps_.clear();
   sweeps_valid_ = false;
   persistence_pending_ = false;
@@ -260,7 +263,29 @@ void WaveformPlot::FindSweeps() {
 
   const double pre = analysis::kPreTriggerFraction * static_cast<double>(span);
 
+  // The crossing the pipeline lined the snapshot up on comes first. It was
+  // looked for across the whole slot the snapshot was cut from, so a signal
+  // whose crossings are too sparse to leave a sweep's room in the snapshot
+  // alone still has this one; the crossings found here follow it at the usual
+  // separation.
+  double earliest = 0.0;
+  if (snapshot_trigger_ >= 0.0) {
+    const double origin = snapshot_trigger_ - pre;
+    if (origin >= 0.0 && origin + static_cast<double>(span) <=
+                             static_cast<double>(codes_.size())) {
+      sweeps_.push_back(origin);
+      earliest = snapshot_trigger_ +
+                 static_cast<double>(options.minimum_separation);
+    }
+  }
+
   for (const double trigger : triggers_) {
+    if (trigger < earliest) {
+      continue;
+    }
+    if (sweeps_.size() >= kMaximumSweeps) {
+      break;
+    }
     const double origin = trigger - pre;
     if (origin < 0.0) {
       continue;
@@ -343,10 +368,19 @@ void WaveformPlot::PaintSweep(QPainter& painter, double origin,
     // Joining the samples themselves here would cut the corners off every
     // crest — at five samples to a cycle, by as much as a fifth of the
     // amplitude.
+    //
+    // The pixels are evenly spaced, so the sweep is reconstructed in one run
+    // rather than a point at a time: the kernel copies the input it reaches
+    // once, and each point is then a fixed run of multiply-adds over it. See
+    // ReconstructionKernel::EvaluateRun.
+    kernel_.EvaluateRun(codes_.data(), codes_.size(),
+                        mapping.XToSamplePosition(0.0),
+                        mapping.SamplesPerPixel(),
+                        static_cast<size_t>(mapping.width_pixels) + 1,
+                        reconstructed_);
     for (int x = 0; x <= mapping.width_pixels; ++x) {
-      const double position = mapping.XToSamplePosition(x);
-      points_.append(QPointF(x, mapping.CodeToY(kernel_.Evaluate(
-                                    codes_.data(), codes_.size(), position))));
+      points_.append(QPointF(
+          x, mapping.CodeToY(reconstructed_[static_cast<size_t>(x)])));
     }
   }
 
@@ -651,8 +685,16 @@ WaveformPanel::WaveformPanel(CaptureController* controller, QWidget* parent)
          "a carrier is a different slice of a cycle every frame and reads as a "
          "band of fuzz. Turn it off to see the snapshot exactly as it "
          "arrived."));
-  connect(trigger_, &QCheckBox::toggled, this,
-          [this](bool on) { plot_->SetTriggered(on); });
+  connect(trigger_, &QCheckBox::toggled, this, [this, controller](bool on) {
+    plot_->SetTriggered(on);
+
+    // The pipeline lines the snapshots up too, across the whole slot, so that
+    // a crossing is there to be drawn from. Off, the snapshot is the slot's
+    // head exactly as it arrived, which is what the box promises.
+    if (controller != nullptr) {
+      controller->analysis()->SetSnapshotTrigger(on);
+    }
+  });
   controls->addWidget(trigger_);
 
   controls->addWidget(new QLabel(tr("Persistence"), this));
@@ -745,8 +787,9 @@ void WaveformPanel::SetSampleRate(uint32_t sample_rate_hz) {
   ClearCursor();
 }
 
-void WaveformPanel::OnWaveformReady(const std::vector<uint16_t>& codes) {
-  plot_->SetCodes(codes);
+void WaveformPanel::OnWaveformReady(const std::vector<uint16_t>& codes,
+                                    double trigger_position) {
+  plot_->SetCodes(codes, trigger_position);
 }
 
 void WaveformPanel::OnMonitoringChanged(bool monitoring) {
@@ -61,7 +61,11 @@ class WaveformPlot : public QWidget {
  public:
   explicit WaveformPlot(QWidget* parent = nullptr);
 
-  void SetCodes(const std::vector<uint16_t>& codes);
+  // trigger_position is where the pipeline found the crossing it lined the
+  // snapshot up on, in samples from its start, or negative when it did not
+  // (see capture/snapshot_trigger.h). That crossing is the first sweep.
+  void SetCodes(const std::vector<uint16_t>& codes,
+                double trigger_position = -1.0);
   void SetSampleSpan(size_t span);
 
   // How long a sweep lingers before it has faded to nothing worth seeing, in
@@ -160,6 +164,7 @@ class WaveformPlot : public QWidget {
   std::vector<double> triggers_;
   std::vector<double> sweeps_;
   bool sweeps_valid_ = false;
+  double snapshot_trigger_ = -1.0;
 
   // Whether the sweeps above came from crossings of the trigger level rather
   // than from the start of the snapshot.
@@ -183,6 +188,9 @@ class WaveformPlot : public QWidget {
   // transcendental calls, neither of which belongs in a paint.
   analysis::ReconstructionKernel kernel_;
 
+  // One sweep's reconstructed points, reused from sweep to sweep
+  std::vector<float> reconstructed_;
+
   // The accumulated picture, kept only while persistence is on. Every frame
   // fades what is there and draws over it, which is how a repeating waveform
   // builds up a bright envelope and a transient shows as a faint one — the
@@ -228,7 +236,8 @@ class WaveformPanel : public QWidget {
   static constexpr const char* kCursorLabelName = "waveform_cursor_label";
 
  public slots:
-  void OnWaveformReady(const std::vector<uint16_t>& codes);
+  void OnWaveformReady(const std::vector<uint16_t>& codes,
+                       double trigger_position = -1.0);
   void OnMonitoringChanged(bool monitoring);
   void SetFrontEndGain(analysis::FrontEndGain gain);
 
@@ -0,0 +1,304 @@
+/************************************************************************
+
+    disc_cache.cpp
+
+    Remembering the discs that have been measured, so they need not be again
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "disc_cache.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace ddd::player {
+namespace {
+
+// The first line of the file. A file that starts with anything else is one a
+// later version wrote, or not this cache at all, and is read as empty.
+constexpr std::string_view kHeader = "ddd-disc-cache 1";
+
+constexpr size_t kFieldCount = 9;
+
+// Whether a string can go in a field as it is. The player's replies are
+// printable ASCII, so this only ever refuses something that did not come from
+// a player — but a tab in a field would shift every field after it.
+bool Storable(std::string_view text) {
+  return text.find_first_of("\t\r\n") == std::string_view::npos;
+}
+
+bool Storable(const CachedDisc& disc) {
+  return Storable(disc.fingerprint.model) &&
+         Storable(disc.fingerprint.disc_status_reply) &&
+         Storable(disc.fingerprint.standard_user_code) &&
+         Storable(disc.pioneer_user_code.text);
+}
+
+char StandardLetter(VideoStandard standard) {
+  switch (standard) {
+    case VideoStandard::kNtsc:
+      return 'N';
+    case VideoStandard::kPal:
+      return 'P';
+    case VideoStandard::kUnknown:
+      break;
+  }
+  return '-';
+}
+
+std::optional<VideoStandard> StandardFromLetter(std::string_view text) {
+  if (text == "N") {
+    return VideoStandard::kNtsc;
+  }
+  if (text == "P") {
+    return VideoStandard::kPal;
+  }
+  if (text == "-") {
+    return VideoStandard::kUnknown;
+  }
+  return std::nullopt;
+}
+
+std::optional<int32_t> Integer(std::string_view text) {
+  int32_t value = 0;
+  const auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::vector<std::string_view> Fields(std::string_view line) {
+  std::vector<std::string_view> fields;
+  size_t start = 0;
+  while (true) {
+    const size_t tab = line.find('\t', start);
+    if (tab == std::string_view::npos) {
+      fields.push_back(line.substr(start));
+      return fields;
+    }
+    fields.push_back(line.substr(start, tab - start));
+    start = tab + 1;
+  }
+}
+
+std::optional<CachedDisc> ParseLine(std::string_view line) {
+  const std::vector<std::string_view> fields = Fields(line);
+  if (fields.size() != kFieldCount) {
+    return std::nullopt;
+  }
+
+  CachedDisc disc;
+  disc.fingerprint.model = fields[0];
+  disc.fingerprint.disc_status_reply = fields[1];
+  disc.fingerprint.standard_user_code = fields[3];
+
+  const std::optional<VideoStandard> standard = StandardFromLetter(fields[2]);
+  const std::optional<int32_t> start = Integer(fields[4]);
+  const std::optional<int32_t> end = Integer(fields[5]);
+  if (!standard.has_value() || !start.has_value() || !end.has_value() ||
+      disc.fingerprint.disc_status_reply.empty()) {
+    return std::nullopt;
+  }
+  disc.fingerprint.video_standard = *standard;
+  disc.programme_start = *start;
+  disc.programme_end = *end;
+
+  if (fields[6] == "1" || fields[6] == "0") {
+    disc.lead_in_reachable = fields[6] == "1";
+  } else if (fields[6] != "-") {
+    return std::nullopt;
+  }
+
+  if (fields[7] == "read") {
+    disc.pioneer_user_code.outcome = UserCodeReading::Outcome::kRead;
+  } else if (fields[7] == "none") {
+    disc.pioneer_user_code.outcome = UserCodeReading::Outcome::kNotEncoded;
+  } else if (fields[7] != "-") {
+    return std::nullopt;
+  }
+  disc.pioneer_user_code.text = fields[8];
+
+  return disc;
+}
+
+}  // namespace
+
+std::optional<DiscFingerprint> FingerprintOf(std::string_view model,
+                                             const DiscProfile& disc) {
+  if (disc.disc_status_reply.empty()) {
+    return std::nullopt;
+  }
+
+  DiscFingerprint fingerprint;
+  fingerprint.model = model;
+  fingerprint.disc_status_reply = disc.disc_status_reply;
+  fingerprint.video_standard = disc.video_standard.known()
+                                   ? disc.video_standard.value
+                                   : VideoStandard::kUnknown;
+
+  // Only a code that was read. "Not encoded" is an answer every disc without
+  // one gives alike, and adds nothing a fingerprint could use.
+  if (disc.standard_user_code.read()) {
+    fingerprint.standard_user_code = disc.standard_user_code.text;
+  }
+  return fingerprint;
+}
+
+const CachedDisc* DiscCache::Find(const DiscFingerprint& fingerprint) const {
+  const auto found = std::find_if(
+      entries_.begin(), entries_.end(), [&fingerprint](const CachedDisc& disc) {
+        return disc.fingerprint == fingerprint;
+      });
+  return found == entries_.end() ? nullptr : &*found;
+}
+
+bool DiscCache::Remember(std::string_view model, const DiscProfile& disc) {
+  const std::optional<DiscFingerprint> fingerprint = FingerprintOf(model, disc);
+  if (!fingerprint.has_value() || !disc.programme_start.known() ||
+      !disc.programme_end.known()) {
+    return false;
+  }
+
+  CachedDisc entry;
+  entry.fingerprint = *fingerprint;
+  entry.programme_start = disc.programme_start.value;
+  entry.programme_end = disc.programme_end.value;
+  if (disc.lead_in_reachable.known()) {
+    entry.lead_in_reachable = disc.lead_in_reachable.value;
+  }
+  if (disc.pioneer_user_code.outcome == UserCodeReading::Outcome::kRead ||
+      disc.pioneer_user_code.outcome == UserCodeReading::Outcome::kNotEncoded) {
+    entry.pioneer_user_code = disc.pioneer_user_code;
+    entry.pioneer_user_code.from_cache = false;
+  }
+
+  if (!Storable(entry)) {
+    return false;
+  }
+
+  // Moved to the back, which is the newest end: a disc examined again is one
+  // somebody is still capturing.
+  Forget(entry.fingerprint);
+  entries_.push_back(std::move(entry));
+  if (entries_.size() > kMaximumEntries) {
+    const auto excess =
+        static_cast<ptrdiff_t>(entries_.size() - kMaximumEntries);
+    entries_.erase(entries_.begin(), entries_.begin() + excess);
+  }
+  return true;
+}
+
+void DiscCache::Forget(const DiscFingerprint& fingerprint) {
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                [&fingerprint](const CachedDisc& disc) {
+                                  return disc.fingerprint == fingerprint;
+                                }),
+                 entries_.end());
+}
+
+std::string DiscCache::Serialise() const {
+  std::ostringstream out;
+  out << kHeader << '\n';
+  for (const CachedDisc& disc : entries_) {
+    const char* pioneer = "-";
+    if (disc.pioneer_user_code.outcome == UserCodeReading::Outcome::kRead) {
+      pioneer = "read";
+    } else if (disc.pioneer_user_code.outcome ==
+               UserCodeReading::Outcome::kNotEncoded) {
+      pioneer = "none";
+    }
+
+    out << disc.fingerprint.model << '\t' << disc.fingerprint.disc_status_reply
+        << '\t' << StandardLetter(disc.fingerprint.video_standard) << '\t'
+        << disc.fingerprint.standard_user_code << '\t' << disc.programme_start
+        << '\t' << disc.programme_end << '\t'
+        << (disc.lead_in_reachable.has_value()
+                ? (*disc.lead_in_reachable ? "1" : "0")
+                : "-")
+        << '\t' << pioneer << '\t' << disc.pioneer_user_code.text << '\n';
+  }
+  return out.str();
+}
+
+DiscCache DiscCache::Parse(std::string_view text) {
+  DiscCache cache;
+
+  size_t start = 0;
+  bool first = true;
+  while (start < text.size()) {
+    size_t end = text.find('\n', start);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    std::string_view line = text.substr(start, end - start);
+    start = end + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (first) {
+      if (line != kHeader) {
+        return cache;
+      }
+      first = false;
+      continue;
+    }
+
+    std::optional<CachedDisc> disc = ParseLine(line);
+    if (disc.has_value() && cache.entries_.size() < kMaximumEntries) {
+      cache.Forget(disc->fingerprint);
+      cache.entries_.push_back(std::move(*disc));
+    }
+  }
+  return cache;
+}
+
+DiscCache DiscCache::Load(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return {};
+  }
+  std::ostringstream text;
+  text << file.rdbuf();
+  return Parse(text.str());
+}
+
+bool DiscCache::Save(const std::string& path) const {
+  const std::filesystem::path target(path);
+  std::filesystem::path partial = target;
+  partial += ".partial";
+
+  std::error_code error;
+  if (target.has_parent_path()) {
+    std::filesystem::create_directories(target.parent_path(), error);
+  }
+
+  {
+    std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      return false;
+    }
+    file << Serialise();
+    if (!file.flush()) {
+      return false;
+    }
+  }
+
+  std::filesystem::rename(partial, target, error);
+  if (error) {
+    std::filesystem::remove(partial, error);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace ddd::player
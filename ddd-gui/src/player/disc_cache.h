@@ -0,0 +1,130 @@
+/************************************************************************
+
+    disc_cache.h
+
+    Remembering the discs that have been measured, so they need not be again
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "disc_profile.h"
+
+namespace ddd::player {
+
+// What a disc says about itself without being moved.
+//
+// Everything here comes from the cheap half of an examination — the queries the
+// player answers off the lead-in it has already read, in about twenty
+// milliseconds each — so it is known before any of the expensive half has
+// begun, which is the only moment a fingerprint is any use.
+//
+// It is not an identity, and nothing treats it as one. Two pressings of the
+// same title, or two unrelated CAV discs of the same side and standard with no
+// user code, fingerprint alike; that is why a match is only ever a candidate,
+// and why DiscExaminer confirms one with a seek before believing it.
+//
+// The model is part of it because the measurement is: a length is where this
+// model's seek past the end stopped, and another model may stop a frame either
+// side of it.
+struct DiscFingerprint {
+  std::string model;
+  std::string disc_status_reply;
+  VideoStandard video_standard = VideoStandard::kUnknown;
+
+  // "$Y", verbatim, and empty where it was not read. The strongest part of
+  // the fingerprint on a disc that carries one, and cheap: it does not move
+  // the player.
+  std::string standard_user_code;
+
+  bool operator==(const DiscFingerprint&) const = default;
+};
+
+// The fingerprint of what an examination found so far. Nothing when there is
+// too little to go on — no disc-status reply means nothing to tell one disc
+// from another, and a lookup on nothing would match the first entry there is.
+std::optional<DiscFingerprint> FingerprintOf(std::string_view model,
+                                             const DiscProfile& disc);
+
+// The expensive half of an examination, as it came out last time.
+struct CachedDisc {
+  DiscFingerprint fingerprint;
+
+  int32_t programme_start = 0;
+  int32_t programme_end = 0;
+
+  // Absent where the examination that measured the disc could not say.
+  std::optional<bool> lead_in_reachable;
+
+  // The Pioneer code as it was read, including "read, and none encoded". Not
+  // kept when it was refused or never asked, because those are findings
+  // about one examination rather than about the disc.
+  UserCodeReading pioneer_user_code;
+
+  bool operator==(const CachedDisc&) const = default;
+};
+
+// Discs this machine has measured, keyed by fingerprint.
+//
+// A value with no file in it: the caller loads and saves it, and the examiner
+// only reads it. That keeps the examination the pure step machine it is, and
+// puts the one question a cache on disk raises — which directory — in the
+// layer that knows what an application directory is.
+//
+// Bounded, oldest first out. A collection of a few thousand discs is still a
+// few hundred kilobytes, but a file that only ever grows is a file somebody has
+// to find and delete one day.
+//
+// Thread-safety: none. One thread owns it.
+class DiscCache {
+ public:
+  static constexpr size_t kMaximumEntries = 4096;
+
+  // The entry for this fingerprint, or null.
+  const CachedDisc* Find(const DiscFingerprint& fingerprint) const;
+
+  // Keep what a completed examination measured, replacing any entry for the
+  // same fingerprint. Returns false and keeps nothing when the profile has
+  // nothing worth keeping: a disc whose two ends were not both established
+  // is one the next examination would have to measure anyway.
+  bool Remember(std::string_view model, const DiscProfile& disc);
+
+  // Drop an entry, which is what a failed confirmation means.
+  void Forget(const DiscFingerprint& fingerprint);
+
+  size_t size() const { return entries_.size(); }
+
+  // The file, as text: a version line, then one tab-separated line per disc.
+  //
+  // Text rather than anything cleverer because the whole of it is a few
+  // strings and integers per disc, and somebody wondering why a disc was not
+  // measured should be able to open it and see. Parse() skips a line it cannot
+  // read rather than refusing the file, because a cache that is half lost is
+  // still a cache and the cost of a lost entry is one measurement.
+  std::string Serialise() const;
+  static DiscCache Parse(std::string_view text);
+
+  // Load and save, for the callers that have a path. A missing file loads as
+  // an empty cache. Save writes beside the file and renames over it, so a
+  // crash half way through leaves the last good copy where it was.
+  static DiscCache Load(const std::string& path);
+  bool Save(const std::string& path) const;
+
+ private:
+  // Oldest first, which is the eviction order. Linear to search, and that is
+  // fine: it is searched once per examination, against a list whose length
+  // is the size of one person's collection.
+  std::vector<CachedDisc> entries_;
+};
+
+}  // namespace ddd::player
@@ -16,10 +16,12 @@
 namespace ddd::player {
 
 DiscExaminer::DiscExaminer(const PlayerDefinition& definition,
-                           std::string_view firmware, ExamineScope scope)
+                           std::string_view firmware, ExamineScope scope,
+                           const DiscCache* cache)
     : definition_(&definition),
       controls_(ControlsFor(definition, firmware)),
-      scope_(scope) {
+      scope_(scope),
+      cache_(cache) {
   BuildPlan();
 }
 
@@ -62,11 +64,22 @@ void DiscExaminer::BuildPlan() {
   // identifying record and the examination is the one moment in a session when
   // reading it is free of consequence: the player is about to be sent to the
   // lead-in anyway, and everything that depends on position happens after.
+  //
+  // With a cache, the standard user code goes first. It is part of the
+  // fingerprint, and it does not move the disc, so asking it before the
+  // Pioneer code still leaves that code ahead of everything that does.
+  const bool standard_code_first =
+      cache_ != nullptr && controls_.Has(PlayerCommand::kQueryStandardUserCode);
+  if (standard_code_first) {
+    plan_.push_back(ExamineStage::kReadingStandardUserCode);
+  }
+
   if (controls_.Has(PlayerCommand::kQueryPioneerUserCode)) {
     plan_.push_back(ExamineStage::kReadingPioneerUserCode);
   }
 
-  if (controls_.Has(PlayerCommand::kQueryStandardUserCode)) {
+  if (!standard_code_first &&
+      controls_.Has(PlayerCommand::kQueryStandardUserCode)) {
     plan_.push_back(ExamineStage::kReadingStandardUserCode);
   }
 
@@ -88,6 +101,15 @@ void DiscExaminer::BuildPlan() {
     plan_.push_back(ExamineStage::kReadingEnd);
     plan_.push_back(ExamineStage::kFindingStart);
     plan_.push_back(ExamineStage::kReadingStart);
+
+    // The Pioneer code, a second time, for a disc the cache turned out to be
+    // wrong about: its proper place was skipped on the cache's word, and the
+    // measurement it would have disturbed is over by now. Applies() keeps it
+    // to one read whichever of the two places it happens in.
+    if (cache_ != nullptr &&
+        controls_.Has(PlayerCommand::kQueryPioneerUserCode)) {
+      plan_.push_back(ExamineStage::kReadingPioneerUserCode);
+    }
   }
 
   AppendRestoreSteps();
@@ -130,6 +152,19 @@ bool DiscExaminer::Applies(ExamineStage stage) const {
       // No point asking where no stop could follow.
       return spun_up_here_;
 
+    case ExamineStage::kReadingPioneerUserCode:
+      // Skipped while a cache entry that carries the code stands, because it
+      // is the slowest step there is. One that carries none is no reason to
+      // go without it.
+      if (pioneer_asked_) {
+        return false;
+      }
+      return !((cache_match_ == CacheMatch::kPending ||
+                cache_match_ == CacheMatch::kConfirmed) &&
+               candidate_.has_value() &&
+               candidate_->pioneer_user_code.outcome !=
+                   UserCodeReading::Outcome::kNotRead);
+
     case ExamineStage::kSpinningDown:
       // Two conditions, and both are load-bearing. The first: only where this
       // examination is why the disc is turning — a player that was already
@@ -140,7 +175,6 @@ bool DiscExaminer::Applies(ExamineStage stage) const {
       return spun_up_here_ && disc_turning_;
 
     case ExamineStage::kFindingEnd:
-    case ExamineStage::kFindingStart:
       // A disc whose type was never established cannot be seeked on: the frame
       // and time-code seeks are different commands with differently sized
       // addresses, and guessing which is the one mistake this whole library is
@@ -150,6 +184,12 @@ bool DiscExaminer::Applies(ExamineStage stage) const {
                                ? PlayerCommand::kSeekTimeCode
                                : PlayerCommand::kSeekFrame);
 
+    case ExamineStage::kFindingStart:
+      // As above, and not at all once the cache has been confirmed: the start
+      // is what it said, and going there would cost the seek it saved.
+      return cache_match_ != CacheMatch::kConfirmed &&
+             Applies(ExamineStage::kFindingEnd);
+
     case ExamineStage::kReadingEnd:
       return end_seek_sent_;
 
@@ -230,8 +270,75 @@ ExamineStep DiscExaminer::StepFor(ExamineStage stage) const {
   return step;
 }
 
+void DiscExaminer::LookUpBefore(ExamineStage stage) {
+  if (cache_ == nullptr || looked_up_) {
+    return;
+  }
+  switch (stage) {
+    case ExamineStage::kReadingPioneerUserCode:
+    case ExamineStage::kCheckingChapters:
+    case ExamineStage::kFindingEnd:
+    case ExamineStage::kFindingStart:
+      break;
+    default:
+      return;
+  }
+  looked_up_ = true;
+
+  // Only where the confirming seek can be made. An entry nothing can check is
+  // an entry taken on trust, and the whole design is that none is.
+  if (!Applies(ExamineStage::kFindingEnd)) {
+    return;
+  }
+
+  const std::optional<DiscFingerprint> fingerprint =
+      FingerprintOf(definition_->name, profile_);
+  if (!fingerprint.has_value()) {
+    return;
+  }
+  const CachedDisc* const found = cache_->Find(*fingerprint);
+  if (found == nullptr) {
+    return;
+  }
+
+  candidate_ = *found;
+  cache_match_ = CacheMatch::kPending;
+}
+
+void DiscExaminer::ConfirmCandidate() {
+  if (cache_match_ != CacheMatch::kPending || !candidate_.has_value()) {
+    return;
+  }
+
+  // The end is the number that tells discs apart: two that fingerprint alike
+  // and run to the same frame are, as far as a capture is concerned, the same
+  // disc. And it is the one measured anyway, so it stays kMeasured.
+  if (!profile_.programme_end.known() ||
+      profile_.programme_end.value != candidate_->programme_end) {
+    cache_match_ = CacheMatch::kStale;
+    return;
+  }
+
+  cache_match_ = CacheMatch::kConfirmed;
+  profile_.programme_start.Record(candidate_->programme_start,
+                                  Provenance::kCached);
+  if (candidate_->lead_in_reachable.has_value()) {
+    profile_.lead_in_reachable.Record(*candidate_->lead_in_reachable,
+                                      Provenance::kCached);
+  }
+  if (!pioneer_asked_ && candidate_->pioneer_user_code.outcome !=
+                             UserCodeReading::Outcome::kNotRead) {
+    profile_.pioneer_user_code = candidate_->pioneer_user_code;
+    profile_.pioneer_user_code.from_cache = true;
+  }
+}
+
 void DiscExaminer::Advance() {
-  while (index_ < plan_.size() && !Applies(plan_[index_])) {
+  while (index_ < plan_.size()) {
+    LookUpBefore(plan_[index_]);
+    if (Applies(plan_[index_])) {
+      break;
+    }
     ++index_;
     ++completed_;
   }
@@ -292,6 +399,7 @@ void DiscExaminer::Apply(const Reply& reply) {
       ApplyTvSystem(reply);
       break;
     case ExamineStage::kReadingPioneerUserCode:
+      pioneer_asked_ = true;
       ApplyUserCode(reply, profile_.pioneer_user_code);
       break;
     case ExamineStage::kReadingStandardUserCode:
@@ -308,6 +416,7 @@ void DiscExaminer::Apply(const Reply& reply) {
       break;
     case ExamineStage::kReadingEnd:
       ApplyEndAddress(reply);
+      ConfirmCandidate();
       break;
     case ExamineStage::kFindingStart:
       start_seek_ok_ = reply.ok();
@@ -537,6 +646,10 @@ void DiscExaminer::Restart() {
   spinning_ = false;
   end_seek_sent_ = false;
   start_seek_ok_ = false;
+  looked_up_ = false;
+  candidate_.reset();
+  cache_match_ = CacheMatch::kNone;
+  pioneer_asked_ = false;
 }
 
 ExamineStage DiscExaminer::stage() const {
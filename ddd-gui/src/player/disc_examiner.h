@@ -16,6 +16,7 @@
 #include <string_view>
 #include <vector>
 
+#include "disc_cache.h"
 #include "disc_profile.h"
 #include "player_command.h"
 #include "player_controls.h"
@@ -145,6 +146,24 @@ enum class ExamineOutcome : uint8_t {
   kCancelled,
 };
 
+// What the disc cache made of this disc.
+enum class CacheMatch : uint8_t {
+  // No cache, an identifying pass, or nothing in it fingerprinting alike.
+  kNone,
+
+  // An entry fingerprints alike, and the seek that confirms it has not been
+  // answered yet.
+  kPending,
+
+  // The seek past the end landed where the entry said it would, so the rest of
+  // the entry was taken instead of measured.
+  kConfirmed,
+
+  // The seek disagreed, or could not be made, and the disc was measured in
+  // full. The entry is wrong and the caller should replace or forget it.
+  kStale,
+};
+
 // One thing to do next.
 struct ExamineStep {
   ExamineStage stage = ExamineStage::kIdle;
@@ -183,8 +202,18 @@ class DiscExaminer {
   // The scope trims it further, and in the same way: an identifying pass has no
   // seek steps in its plan at all rather than steps it declines to run, so
   // steps_planned() is the truth about how long it will take.
+  //
+  // A cache, if there is one, lets a full examination skip what it measured
+  // last time. The cheap half is asked as always and gives the disc's
+  // fingerprint; where the cache knows it, the Pioneer user code and the seek
+  // to the start are left out, and the seek past the end — which is one seek
+  // and gives the most telling number — is made anyway and has to agree before
+  // anything from the cache is believed. Where it does not, the rest is
+  // measured as if there were no cache. The cache is only read, and must
+  // outlive the examiner.
   DiscExaminer(const PlayerDefinition& definition, std::string_view firmware,
-               ExamineScope scope = ExamineScope::kFull);
+               ExamineScope scope = ExamineScope::kFull,
+               const DiscCache* cache = nullptr);
 
   ExamineScope scope() const { return scope_; }
 
@@ -223,6 +252,8 @@ class DiscExaminer {
   size_t steps_completed() const { return completed_; }
   size_t steps_planned() const { return plan_.size(); }
 
+  CacheMatch cache_match() const { return cache_match_; }
+
  private:
   // Work out which steps this model can be asked at all. Called once.
   void BuildPlan();
@@ -235,6 +266,15 @@ class DiscExaminer {
   // Does this step still apply, given what has been learnt?
   bool Applies(ExamineStage stage) const;
 
+  // Look the disc up, once, just before the first step that would move it:
+  // the last moment a cache can save anything, and the first at which the
+  // whole fingerprint is known.
+  void LookUpBefore(ExamineStage stage);
+
+  // After the seek past the end: believe the cache entry, or stop relying on
+  // it.
+  void ConfirmCandidate();
+
   // Move past the steps that no longer apply, and notice when the plan has run
   // out. Called after every reply, so that the last one finishes the
   // examination rather than leaving it finished-but-not-saying-so until
@@ -262,6 +302,7 @@ class DiscExaminer {
   const PlayerDefinition* definition_ = nullptr;
   PlayerControls controls_;
   ExamineScope scope_ = ExamineScope::kFull;
+  const DiscCache* cache_ = nullptr;
 
   std::vector<ExamineStage> plan_;
   size_t index_ = 0;
@@ -295,6 +336,17 @@ class DiscExaminer {
   // here means the player did not move, and the address afterwards would be
   // somebody else's.
   bool start_seek_ok_ = false;
+
+  // The cache entry this disc matched, while there is one to rely on.
+  bool looked_up_ = false;
+  std::optional<CachedDisc> candidate_;
+  CacheMatch cache_match_ = CacheMatch::kNone;
+
+  // The Pioneer user code has been asked for. With a cache the plan carries
+  // the step twice — in its proper place, and again after the measurement in
+  // case a stale entry meant skipping the first — and this is what keeps it
+  // to one read.
+  bool pioneer_asked_ = false;
 };
 
 // The address a disc cannot have, per addressing scheme.
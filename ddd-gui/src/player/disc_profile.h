@@ -49,6 +49,13 @@ enum class Provenance : uint8_t {
   // The user said so. Nothing in the examination produces this; it is for the
   // fields a model cannot be asked about, which the capture setup collects.
   kDeclared,
+
+  // Measured by an earlier examination of a disc that fingerprints alike, and
+  // taken from the cache rather than measured again — see disc_cache.h. Only
+  // ever recorded after a seek has agreed with the cached length, and kept
+  // apart from kMeasured so that a report says which numbers were taken on
+  // trust from last time.
+  kCached,
 };
 
 // One field of the profile, with where it came from.
@@ -103,6 +110,10 @@ struct UserCodeReading {
   // job.
   std::string text;
 
+  // Taken from the disc cache rather than asked for. The Pioneer read is the
+  // slowest step of an examination, and a disc the cache recognises skips it.
+  bool from_cache = false;
+
   bool read() const { return outcome == Outcome::kRead; }
 
   bool operator==(const UserCodeReading&) const = default;
@@ -0,0 +1,143 @@
+/************************************************************************
+
+    test_fm_demodulator.cpp
+
+    The RF's instantaneous frequency, which is the video
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "fm_demodulator.h"
+#include "sample_format.h"
+
+namespace ddd::analysis {
+namespace {
+
+constexpr double kRateHz = 40'000'000.0;
+
+// A carrier at the given frequencies in turn, phase-continuous across each
+// change as a modulator's is, quantised to codes about mid-scale.
+std::vector<uint16_t> Carrier(const std::vector<double>& frequencies_hz,
+                              size_t samples_each, double amplitude = 300.0,
+                              double interferer_hz = 0.0,
+                              double interferer_amplitude = 0.0) {
+  std::vector<uint16_t> codes;
+  double phase = 0.0;
+  size_t index = 0;
+  for (const double frequency : frequencies_hz) {
+    for (size_t sample = 0; sample < samples_each; ++sample, ++index) {
+      const double interferer =
+          interferer_amplitude *
+          std::sin(2.0 * std::numbers::pi * interferer_hz *
+                   static_cast<double>(index) / kRateHz);
+      codes.push_back(static_cast<uint16_t>(std::lround(
+          capture::kSampleZeroOffset + (amplitude * std::cos(phase)) +
+          interferer)));
+      phase += 2.0 * std::numbers::pi * frequency / kRateHz;
+    }
+  }
+  return codes;
+}
+
+double Mean(const std::vector<float>& values, size_t from, size_t to) {
+  double sum = 0.0;
+  for (size_t index = from; index < to; ++index) {
+    sum += values[index];
+  }
+  return sum / static_cast<double>(to - from);
+}
+
+TEST(FastAtan2Test, AgreesWithTheLibraryAllTheWayRound) {
+  for (int step = 0; step < 3600; ++step) {
+    const double angle = (static_cast<double>(step) / 3600.0 * 2.0 *
+                          std::numbers::pi) -
+                         std::numbers::pi;
+    const auto y = static_cast<float>(3.0 * std::sin(angle));
+    const auto x = static_cast<float>(3.0 * std::cos(angle));
+
+    EXPECT_NEAR(FastAtan2(y, x), std::atan2(y, x), 2.0e-5)
+        << "at " << angle << " rad";
+  }
+}
+
+TEST(FastAtan2Test, TheOriginHasNoAngleAndGetsZero) {
+  EXPECT_FLOAT_EQ(FastAtan2(0.0F, 0.0F), 0.0F);
+}
+
+TEST(FmDemodulatorTest, AConstantCarrierReadsAsItsOwnFrequency) {
+  FmDemodulator demodulator({});
+
+  // Blanking on a PAL disc, and white on an NTSC one: the bottom and top of
+  // everything this is asked to measure
+  for (const double carrier : {7'100'000.0, 9'300'000.0}) {
+    const std::vector<uint16_t> codes = Carrier({carrier}, 8192);
+    std::vector<float> frequency;
+
+    ASSERT_EQ(demodulator.Demodulate(codes.data(), codes.size(), frequency),
+              codes.size() - (2 * demodulator.delay()));
+    EXPECT_NEAR(Mean(frequency, 0, frequency.size()), carrier, 20'000.0);
+  }
+}
+
+TEST(FmDemodulatorTest, AFrequencyStepIsFollowedInAQuarterOfAMicrosecond) {
+  FmDemodulator demodulator({});
+  const size_t each = 4000;
+  const std::vector<uint16_t> codes =
+      Carrier({6'760'000.0, 7'900'000.0}, each);
+  std::vector<float> frequency;
+  demodulator.Demodulate(codes.data(), codes.size(), frequency);
+
+  // Output j is input j + delay(), so the step is at each - delay() in the
+  // output. A quarter of a microsecond either side of it is ten samples.
+  const size_t step = each - demodulator.delay();
+  EXPECT_NEAR(Mean(frequency, step - 400, step - 10), 6'760'000.0, 30'000.0);
+  EXPECT_NEAR(Mean(frequency, step + 10, step + 400), 7'900'000.0, 30'000.0);
+}
+
+TEST(FmDemodulatorTest, AnAudioCarrierBelowTheBandDoesNotMoveTheReading) {
+  // A PAL disc's right-hand audio carrier at 1.066 MHz, a third of the video
+  // carrier's amplitude. Through an ordinary discriminator that is a ripple of
+  // hundreds of kilohertz on every line.
+  FmDemodulator demodulator({});
+  const std::vector<uint16_t> codes =
+      Carrier({7'500'000.0}, 16384, 300.0, 1'066'000.0, 100.0);
+  std::vector<float> frequency;
+  demodulator.Demodulate(codes.data(), codes.size(), frequency);
+
+  const auto [lowest, highest] =
+      std::minmax_element(frequency.begin(), frequency.end());
+  EXPECT_GT(*lowest, 7'300'000.0F);
+  EXPECT_LT(*highest, 7'700'000.0F);
+}
+
+TEST(FmDemodulatorTest, TheBandIsHeldBelowNyquist) {
+  FmDemodulator::Options options;
+  options.sample_rate_hz = 20'000'000;
+  options.band_high_hz = 14'000'000.0;
+  const FmDemodulator demodulator(options);
+
+  EXPECT_LT(demodulator.options().band_high_hz, 10'000'000.0);
+  EXPECT_EQ(demodulator.tap_count(),
+            (2 * FmDemodulator::kDefaultHalfLength) + 1);
+}
+
+TEST(FmDemodulatorTest, ABufferNoLongerThanTheFilterGivesNothing) {
+  FmDemodulator demodulator({});
+  const std::vector<uint16_t> codes(demodulator.tap_count(), 512);
+  std::vector<float> frequency(10, 1.0F);
+
+  EXPECT_EQ(demodulator.Demodulate(codes.data(), codes.size(), frequency), 0U);
+  EXPECT_TRUE(frequency.empty());
+}
+
+}  // namespace
+}  // namespace ddd::analysis
@@ -0,0 +1,113 @@
+/************************************************************************
+
+    test_overview_columns.cpp
+
+    Unit tests for reducing a capture overview to pixel columns
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "capture_overview.h"
+#include "overview_columns.h"
+#include "waveform_mapping.h"
+
+namespace ddd::analysis {
+namespace {
+
+WaveformMapping MakeMapping(int width, size_t first, size_t span) {
+  WaveformMapping mapping;
+  mapping.width_pixels = width;
+  mapping.height_pixels = 100;
+  mapping.first_sample = first;
+  mapping.sample_span = span;
+  return mapping;
+}
+
+// Blocks of 1,000 samples, block n ranging over n to n + 10 with an RMS of
+// n + 1, so a merged column can be told from any single block in it.
+std::vector<capture::OverviewBlock> Blocks(size_t count) {
+  std::vector<capture::OverviewBlock> blocks;
+  for (size_t index = 0; index < count; ++index) {
+    capture::OverviewBlock block;
+    block.first_sample = index * 1000;
+    block.sample_count = 1000;
+    block.minimum_value = static_cast<uint16_t>(index);
+    block.maximum_value = static_cast<uint16_t>(index + 10);
+    block.sum_of_squares = 1000 * (index + 1) * (index + 1);
+    block.clipped_high_count = index;
+    blocks.push_back(block);
+  }
+  return blocks;
+}
+
+TEST(OverviewColumnsTest, EachBlockLandsInTheColumnItStartsIn) {
+  std::vector<OverviewColumn> columns;
+  DecimateOverview(Blocks(10), MakeMapping(10, 0, 10'000), columns);
+
+  ASSERT_EQ(columns.size(), 10U);
+  for (size_t column = 0; column < columns.size(); ++column) {
+    ASSERT_TRUE(columns[column].populated);
+    EXPECT_EQ(columns[column].minimum, column);
+    EXPECT_EQ(columns[column].maximum, column + 10);
+    EXPECT_DOUBLE_EQ(columns[column].rms, static_cast<double>(column + 1));
+  }
+}
+
+TEST(OverviewColumnsTest, AColumnOfSeveralBlocksTakesTheirExtremesAndTotalRms) {
+  // Two blocks a column. The RMS is of the samples together — the root of the
+  // mean of 1 and 4 — not the mean of the two blocks' RMS figures.
+  std::vector<OverviewColumn> columns;
+  DecimateOverview(Blocks(4), MakeMapping(2, 0, 4'000), columns);
+
+  ASSERT_EQ(columns.size(), 2U);
+  EXPECT_EQ(columns[0].minimum, 0);
+  EXPECT_EQ(columns[0].maximum, 11);
+  EXPECT_DOUBLE_EQ(columns[0].rms, std::sqrt(2.5));
+  EXPECT_EQ(columns[0].clipped, 1U);
+  EXPECT_EQ(columns[1].clipped, 5U);
+}
+
+TEST(OverviewColumnsTest, ColumnsNoBlockStartsInAreLeftEmpty) {
+  // Zoomed in past the blocks: four columns to a block, and nothing is
+  // invented for the three between the starts.
+  std::vector<OverviewColumn> columns;
+  DecimateOverview(Blocks(2), MakeMapping(8, 0, 2'000), columns);
+
+  ASSERT_EQ(columns.size(), 8U);
+  EXPECT_TRUE(columns[0].populated);
+  EXPECT_FALSE(columns[1].populated);
+  EXPECT_FALSE(columns[3].populated);
+  EXPECT_TRUE(columns[4].populated);
+}
+
+TEST(OverviewColumnsTest, TheBlockAWindowStartsInsideGoesToTheFirstColumn) {
+  std::vector<OverviewColumn> columns;
+  DecimateOverview(Blocks(10), MakeMapping(4, 2'500, 4'000), columns);
+
+  ASSERT_EQ(columns.size(), 4U);
+  ASSERT_TRUE(columns[0].populated);
+  EXPECT_EQ(columns[0].minimum, 2);
+
+  // The last column holds the block starting inside it and not the one
+  // starting past the window's end
+  EXPECT_EQ(columns[3].minimum, 6);
+  EXPECT_EQ(columns[3].maximum, 16);
+}
+
+TEST(OverviewColumnsTest, AnInvalidMappingHasNoColumns) {
+  std::vector<OverviewColumn> columns;
+  DecimateOverview(Blocks(4), MakeMapping(0, 0, 4'000), columns);
+  EXPECT_TRUE(columns.empty());
+}
+
+}  // namespace
+}  // namespace ddd::analysis
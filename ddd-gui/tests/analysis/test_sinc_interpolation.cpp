@@ -13,6 +13,7 @@
 
 #include <cmath>
 #include <numbers>
+#include <utility>
 #include <vector>
 
 #include "front_end_gain.h"
@@ -152,5 +153,57 @@ TEST(SincInterpolationTest, TheKernelIsTheSizeItWasAskedFor) {
               CarrierAt(100.5), kAmplitude * 0.05);
 }
 
+TEST(SincInterpolationTest, ARunAgreesWithThePointByPointPath) {
+  // Off both ends, backwards as well as forwards, and with kernels whose taps
+  // fill the run's lanes exactly and leave some over.
+  const std::vector<uint16_t> codes = MakeCarrier(2000);
+
+  for (const int half_taps : {4, 5, kDefaultReconstructionHalfTaps}) {
+    ReconstructionKernel kernel(half_taps);
+    for (const auto& [first, step] : {std::pair{3.37, 0.173},
+                                      std::pair{-40.0, 0.71},
+                                      std::pair{2030.5, -0.29}}) {
+      std::vector<float> values;
+      kernel.EvaluateRun(codes.data(), codes.size(), first, step, 3000,
+                         values);
+      ASSERT_EQ(values.size(), 3000U);
+
+      for (size_t point = 0; point < values.size(); ++point) {
+        const double position = first + (step * static_cast<double>(point));
+        ASSERT_NEAR(values[point],
+                    kernel.Evaluate(codes.data(), codes.size(), position),
+                    1e-3)
+            << "at " << position << " with " << half_taps << " half taps";
+      }
+    }
+  }
+}
+
+TEST(SincInterpolationTest, ARunOfAConstantSignalStaysConstant) {
+  ReconstructionKernel kernel;
+  const std::vector<uint16_t> flat(300, 700);
+
+  std::vector<float> values;
+  kernel.EvaluateRun(flat.data(), flat.size(), -5.0, 0.037, 9000, values);
+  for (const float value : values) {
+    ASSERT_NEAR(value, 700.0, 1e-3);
+  }
+}
+
+TEST(SincInterpolationTest, ARunOverNothingIsHeldLikeAPoint) {
+  ReconstructionKernel kernel;
+  std::vector<float> values;
+
+  kernel.EvaluateRun(nullptr, 10, 0.0, 1.0, 4, values);
+  EXPECT_EQ(values, std::vector<float>(4, 0.0F));
+
+  const std::vector<uint16_t> one(1, 512);
+  kernel.EvaluateRun(one.data(), one.size(), 0.0, 0.5, 3, values);
+  EXPECT_EQ(values, std::vector<float>(3, 512.0F));
+
+  kernel.EvaluateRun(one.data(), one.size(), 0.0, 0.5, 0, values);
+  EXPECT_TRUE(values.empty());
+}
+
 }  // namespace
 }  // namespace ddd::analysis
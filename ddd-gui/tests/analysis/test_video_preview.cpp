@@ -0,0 +1,297 @@
+/************************************************************************
+
+    test_video_preview.cpp
+
+    A field of the disc's picture, from one contiguous run of RF
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "sample_format.h"
+#include "video_preview.h"
+
+namespace ddd::analysis {
+namespace {
+
+constexpr double kRateHz = 40'000'000.0;
+
+// Half lines in a field, and how the vertical interval is laid out in them:
+// five broad pulses, five equalising pulses, the picture, and five equalising
+// pulses before the next field's broad ones. PAL's layout, and close enough to
+// NTSC's for a preview that only looks for the first broad pulse.
+constexpr size_t kBroadHalfLines = 5;
+constexpr size_t kEqualisingHalfLines = 5;
+
+// Where a picture line's video line number puts it on the raster: the rows
+// above it are the vertical interval, counted from the first broad pulse.
+constexpr size_t kFirstPictureRow =
+    (kBroadHalfLines + kEqualisingHalfLines) / 2;
+
+// The test card. The picture is white on the right and black on the left in
+// the top half of the field, and the other way round in the bottom half, so
+// a field drawn upside down, half a line out or split in the wrong place
+// fails on both axes at once.
+bool CardIsWhite(size_t picture_line, size_t picture_lines, double across) {
+  return (across >= 0.5) != (picture_line >= picture_lines / 2);
+}
+
+// The carrier frequency a disc would be producing, sample by sample, for a
+// run of fields starting `offset_half_lines` into the first one.
+std::vector<double> Modulation(VideoStandard standard, size_t fields,
+                               size_t offset_half_lines) {
+  const VideoStandardPreset& preset = PresetFor(standard);
+  const size_t half_lines_per_field =
+      static_cast<size_t>(preset.lines_per_field * 2.0);
+  const double half_line = preset.line_seconds * kRateHz / 2.0;
+  const size_t picture_lines =
+      (half_lines_per_field - kBroadHalfLines - (2 * kEqualisingHalfLines)) / 2;
+
+  std::vector<double> frequency;
+  const size_t total = (fields * half_lines_per_field) - offset_half_lines;
+  frequency.reserve(
+      static_cast<size_t>(static_cast<double>(total) * half_line));
+
+  double clock = 0.0;
+  for (size_t slot = 0; slot < total; ++slot) {
+    const size_t in_field = (slot + offset_half_lines) % half_lines_per_field;
+    const auto first = static_cast<size_t>(clock);
+    clock += half_line;
+    const auto last = static_cast<size_t>(clock);
+
+    for (size_t sample = first; sample < last; ++sample) {
+      const double seconds = static_cast<double>(sample - first) / kRateHz;
+      double hz = preset.blanking_hz;
+      if (in_field < kBroadHalfLines) {
+        hz = seconds < 27.3e-6 ? preset.sync_tip_hz : preset.blanking_hz;
+      } else if (in_field < kBroadHalfLines + kEqualisingHalfLines ||
+                 in_field >= half_lines_per_field - kEqualisingHalfLines) {
+        hz = seconds < 2.35e-6 ? preset.sync_tip_hz : preset.blanking_hz;
+      } else {
+        // A picture line is two half lines; the sync is at the start of the
+        // first and the second is the rest of its picture
+        const size_t picture_half = in_field - kBroadHalfLines -
+                                    kEqualisingHalfLines;
+        const double into_line =
+            seconds + ((picture_half % 2) * preset.line_seconds / 2.0);
+        const double across = (into_line - preset.active_start_seconds) /
+                              preset.active_seconds;
+        if (into_line < preset.sync_seconds) {
+          hz = preset.sync_tip_hz;
+        } else if (across >= 0.0 && across < 1.0) {
+          hz = CardIsWhite(picture_half / 2, picture_lines, across)
+                   ? preset.white_hz
+                   : preset.blanking_hz;
+        }
+      }
+      frequency.push_back(hz);
+    }
+  }
+  return frequency;
+}
+
+std::vector<uint16_t> Modulate(const std::vector<double>& frequency_hz,
+                               double noise_codes = 0.0) {
+  std::mt19937 generator(36);
+  std::normal_distribution<double> noise(0.0, noise_codes);
+
+  std::vector<uint16_t> codes;
+  codes.reserve(frequency_hz.size());
+  double phase = 0.0;
+  for (const double hz : frequency_hz) {
+    const double value = capture::kSampleZeroOffset +
+                         (300.0 * std::cos(phase)) +
+                         (noise_codes > 0.0 ? noise(generator) : 0.0);
+    codes.push_back(static_cast<uint16_t>(
+        std::lround(std::clamp(value, 0.0, 1023.0))));
+    phase += 2.0 * std::numbers::pi * hz / kRateHz;
+  }
+  return codes;
+}
+
+// The average level across a band of a row, as a fraction of the way across.
+double RowLevel(const VideoField& field, size_t row, double from, double to) {
+  const auto first =
+      static_cast<size_t>(from * static_cast<double>(field.width));
+  const auto last = static_cast<size_t>(to * static_cast<double>(field.width));
+  double sum = 0.0;
+  for (size_t column = first; column < last; ++column) {
+    sum += field.pixels[(row * field.width) + column];
+  }
+  return sum / static_cast<double>(last - first);
+}
+
+void ExpectTheTestCard(const VideoField& field, VideoStandard standard) {
+  const size_t picture_lines =
+      (static_cast<size_t>(PresetFor(standard).lines_per_field * 2.0) -
+       kBroadHalfLines - (2 * kEqualisingHalfLines)) /
+      2;
+
+  // A quarter of the way down the picture and three quarters, away from the
+  // edges where the demodulator's filter is still settling
+  const size_t upper = kFirstPictureRow + (picture_lines / 4);
+  const size_t lower = kFirstPictureRow + (3 * picture_lines / 4);
+
+  EXPECT_LT(RowLevel(field, upper, 0.1, 0.4), 30.0);
+  EXPECT_GT(RowLevel(field, upper, 0.6, 0.9), 225.0);
+  EXPECT_GT(RowLevel(field, lower, 0.1, 0.4), 225.0);
+  EXPECT_LT(RowLevel(field, lower, 0.6, 0.9), 30.0);
+}
+
+VideoPreview::Options Options(VideoStandard standard) {
+  VideoPreview::Options options;
+  options.standard = standard;
+  options.sample_rate_hz = static_cast<uint32_t>(kRateHz);
+  return options;
+}
+
+TEST(VideoPreviewTest, AFieldThatStartsNearTheTopOfTheRunIsDrawnFromTheTop) {
+  // Two fields, with the run opening a little before the first one's
+  // vertical interval
+  const std::vector<uint16_t> codes =
+      Modulate(Modulation(VideoStandard::kPal, 2, 600));
+
+  VideoPreview preview(Options(VideoStandard::kPal));
+  ASSERT_TRUE(preview.Render(codes.data(), codes.size()));
+
+  const VideoField& field = preview.field();
+  EXPECT_EQ(field.rows, 312U);
+  EXPECT_EQ(field.width, VideoPreview::kDefaultWidth);
+  EXPECT_GT(field.locked_rows, 290U);
+  ExpectTheTestCard(field, VideoStandard::kPal);
+}
+
+TEST(VideoPreviewTest, AFieldSplitAcrossTheRunIsPutBackTogether) {
+  // One field and a bit, with the vertical interval three quarters of the way
+  // in: most of the picture is before it and has to be placed from the bottom
+  // up. Started on the odd half line, so the walk back crosses into the other
+  // field's half-line offset as a real disc's does.
+  const std::vector<uint16_t> full =
+      Modulate(Modulation(VideoStandard::kPal, 2, 155));
+  const std::vector<uint16_t> codes(full.begin(),
+                                    full.begin() + (full.size() * 3 / 5));
+
+  VideoPreview preview(Options(VideoStandard::kPal));
+  ASSERT_TRUE(preview.Render(codes.data(), codes.size()));
+
+  EXPECT_GT(preview.field().locked_rows, 290U);
+  ExpectTheTestCard(preview.field(), VideoStandard::kPal);
+}
+
+TEST(VideoPreviewTest, NtscIsDrawnOnItsOwnCarrierAndTiming) {
+  const std::vector<uint16_t> codes =
+      Modulate(Modulation(VideoStandard::kNtsc, 2, 500));
+
+  VideoPreview preview(Options(VideoStandard::kNtsc));
+  ASSERT_TRUE(preview.Render(codes.data(), codes.size()));
+
+  EXPECT_EQ(preview.field().rows, 262U);
+  EXPECT_GT(preview.field().locked_rows, 240U);
+  ExpectTheTestCard(preview.field(), VideoStandard::kNtsc);
+}
+
+TEST(VideoPreviewTest, ANoisyCarrierStillLocks) {
+  // Noise at a tenth of the carrier's amplitude: a poor disc, not a broken
+  // one, and a preview that lost the picture here would be useless exactly
+  // when it was wanted.
+  const std::vector<uint16_t> codes =
+      Modulate(Modulation(VideoStandard::kPal, 2, 600), 30.0);
+
+  VideoPreview preview(Options(VideoStandard::kPal));
+  ASSERT_TRUE(preview.Render(codes.data(), codes.size()));
+
+  EXPECT_GT(preview.field().locked_rows, 280U);
+  ExpectTheTestCard(preview.field(), VideoStandard::kPal);
+}
+
+TEST(VideoPreviewTest, ARunWithNoPictureLeavesTheLastFieldAlone) {
+  const std::vector<uint16_t> good =
+      Modulate(Modulation(VideoStandard::kPal, 2, 600));
+  VideoPreview preview(Options(VideoStandard::kPal));
+  ASSERT_TRUE(preview.Render(good.data(), good.size()));
+  const std::vector<uint8_t> before = preview.field().pixels;
+
+  // A carrier sitting at blanking: a player paused on a black screen with its
+  // syncs gone, or no disc at all
+  const std::vector<double> flat(good.size(), 7'100'000.0);
+  const std::vector<uint16_t> codes = Modulate(flat);
+
+  EXPECT_FALSE(preview.Render(codes.data(), codes.size()));
+  EXPECT_EQ(preview.field().pixels, before);
+}
+
+TEST(VideoPreviewTest, ARunShorterThanAFieldIsRefused) {
+  const std::vector<uint16_t> full =
+      Modulate(Modulation(VideoStandard::kPal, 2, 600));
+  const std::vector<uint16_t> codes(full.begin(),
+                                    full.begin() + (full.size() / 3));
+
+  VideoPreview preview(Options(VideoStandard::kPal));
+  EXPECT_FALSE(preview.Render(codes.data(), codes.size()));
+  EXPECT_TRUE(preview.field().empty());
+}
+
+TEST(VideoPreviewTest, OnlyARateThatHoldsPeakWhiteCanCarryAStandard) {
+  EXPECT_TRUE(VideoPreview::RateCarries(VideoStandard::kPal, 40'000'000));
+  EXPECT_TRUE(VideoPreview::RateCarries(VideoStandard::kNtsc, 40'000'000));
+
+  // Half rate keeps both, just; a quarter keeps neither
+  EXPECT_TRUE(VideoPreview::RateCarries(VideoStandard::kPal, 20'000'000));
+  EXPECT_TRUE(VideoPreview::RateCarries(VideoStandard::kNtsc, 20'000'000));
+  EXPECT_FALSE(VideoPreview::RateCarries(VideoStandard::kPal, 10'000'000));
+  EXPECT_FALSE(VideoPreview::RateCarries(VideoStandard::kNtsc, 10'000'000));
+}
+
+TEST(WorkPacerTest, ARunEarnsARestThatHoldsItToTheBudget) {
+  WorkPacer pacer(0.1);
+  EXPECT_TRUE(pacer.Due(0.0));
+
+  // 10 ms of work at a tenth of a core is 90 ms of rest
+  pacer.Record(1.000, 1.010);
+
+  EXPECT_NEAR(pacer.last_cost_seconds(), 0.010, 1.0e-9);
+  EXPECT_FALSE(pacer.Due(1.050));
+  EXPECT_FALSE(pacer.Due(1.099));
+  EXPECT_TRUE(pacer.Due(1.101));
+}
+
+TEST(WorkPacerTest, ASlowerMachineGetsFewerRunsRatherThanAFullerThread) {
+  WorkPacer pacer(0.1);
+
+  // Fields costing 50 ms each, offered as fast as they can be taken: over ten
+  // seconds of them, the work done stays at a tenth
+  double now = 0.0;
+  double working = 0.0;
+  int runs = 0;
+  while (now < 10.0) {
+    if (pacer.Due(now)) {
+      pacer.Record(now, now + 0.050);
+      working += 0.050;
+      now += 0.050;
+      ++runs;
+    } else {
+      now += 0.001;
+    }
+  }
+
+  EXPECT_NEAR(working / now, 0.1, 0.01);
+  EXPECT_NEAR(runs, 20, 1);
+}
+
+TEST(WorkPacerTest, TheWholeBudgetMeansNoRest) {
+  WorkPacer pacer(1.0);
+  pacer.Record(1.0, 1.5);
+
+  EXPECT_TRUE(pacer.Due(1.5));
+}
+
+}  // namespace
+}  // namespace ddd::analysis
@@ -11,6 +11,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <vector>
 
 #include "monitor_tap.h"
@@ -30,6 +33,51 @@ WaveformMapping MakeMapping(int width = 600, int height = 400, size_t first = 0,
   return mapping;
 }
 
+// What DecimateToColumns did before it worked a column at a time: every
+// sample through SampleToX on its own. Kept as the definition the faster form
+// has to agree with.
+void DecimateSampleBySample(const std::vector<uint16_t>& codes,
+                            const WaveformMapping& mapping,
+                            std::vector<WaveformColumn>& columns) {
+  columns.assign(static_cast<size_t>(mapping.width_pixels), WaveformColumn{});
+
+  const size_t last =
+      std::min(mapping.first_sample + mapping.sample_span, codes.size());
+  for (size_t index = mapping.first_sample; index < last; ++index) {
+    const double x = mapping.SampleToX(static_cast<double>(index));
+    if (x < 0.0 || static_cast<size_t>(x) >= columns.size()) {
+      continue;
+    }
+
+    WaveformColumn& target = columns[static_cast<size_t>(x)];
+    if (!target.populated) {
+      target = {codes[index], codes[index], true};
+      continue;
+    }
+    target.minimum = std::min(target.minimum, codes[index]);
+    target.maximum = std::max(target.maximum, codes[index]);
+  }
+}
+
+// A snapshot's worth of codes with no pattern a column edge could line up
+// with.
+std::vector<uint16_t> NoisySnapshot() {
+  constexpr size_t kSnapshotSamples =
+      capture::SnapshotPublisher::kDefaultSnapshotBytes /
+      capture::kBytesPerSample;
+  std::vector<uint16_t> codes(kSnapshotSamples);
+  uint32_t state = 12345;
+  for (uint16_t& code : codes) {
+    state = (state * 1'664'525U) + 1'013'904'223U;
+    code = static_cast<uint16_t>((state >> 16) % 1024);
+  }
+  return codes;
+}
+
+// Plot widths the panel is drawn at, from a docked panel on a small laptop
+// screen to the whole of a 1080p one.
+constexpr int kPlotWidths[] = {320, 480, 600, 800, 1024, 1366, 1920};
+
 TEST(WaveformMappingTest, TheWindowFillsThePlotExactly) {
   const WaveformMapping mapping = MakeMapping();
 
@@ -334,5 +382,98 @@ TEST(WaveformMappingTest, APixelMapsToAFractionalSamplePosition) {
   }
 }
 
+TEST(WaveformMappingTest, ColumnsAreWhatMappingEverySampleWouldGive) {
+  // Every span offered, at every width, triggered between samples and not,
+  // and from the start of the snapshot and partway into it. The column a
+  // sample lands in is decided by SampleToX and nothing else, so a sample on
+  // a column edge goes where the cursor readout says it is.
+  const std::vector<uint16_t> codes = NoisySnapshot();
+  constexpr double kOffsets[] = {0.0, 0.25, 0.5, 0.999};
+  constexpr size_t kFirstSamples[] = {0, 7, 3'277};
+
+  std::vector<WaveformColumn> expected;
+  std::vector<WaveformColumn> actual;
+  for (const size_t span : kWaveformSpanChoices) {
+    for (const int width : kPlotWidths) {
+      for (const double offset : kOffsets) {
+        for (const size_t first : kFirstSamples) {
+          WaveformMapping mapping = MakeMapping(width, 400, first, span);
+          mapping.sub_sample_offset = offset;
+
+          DecimateSampleBySample(codes, mapping, expected);
+          DecimateToColumns(codes.data(), codes.size(), mapping, actual);
+
+          ASSERT_EQ(actual.size(), expected.size());
+          for (size_t column = 0; column < expected.size(); ++column) {
+            ASSERT_EQ(actual[column].populated, expected[column].populated)
+                << "span " << span << ", width " << width << ", offset "
+                << offset << ", first " << first << ", column " << column;
+            ASSERT_EQ(actual[column].minimum, expected[column].minimum);
+            ASSERT_EQ(actual[column].maximum, expected[column].maximum);
+          }
+        }
+      }
+    }
+  }
+
+  // And a window running past the end of the data, triggered, where the last
+  // run is cut short by the data rather than by a column edge
+  WaveformMapping past_the_end =
+      MakeMapping(800, 400, codes.size() - 5'000, 20'000);
+  past_the_end.sub_sample_offset = 0.5;
+  DecimateSampleBySample(codes, past_the_end, expected);
+  DecimateToColumns(codes.data(), codes.size(), past_the_end, actual);
+  for (size_t column = 0; column < expected.size(); ++column) {
+    ASSERT_EQ(actual[column].populated, expected[column].populated);
+    ASSERT_EQ(actual[column].minimum, expected[column].minimum);
+    ASSERT_EQ(actual[column].maximum, expected[column].maximum);
+  }
+}
+
+TEST(WaveformMappingTest, EveryOfferedSpanDecimatesWellInsideAFrame) {
+  // The scope decimates the snapshot on the GUI thread once a frame, and with
+  // persistence on it is the same work again for every trace kept. Timed at
+  // every span and width, best of three, and printed whether it passes or not
+  // so a slow machine can be compared with a fast one.
+  const std::vector<uint16_t> codes = NoisySnapshot();
+  constexpr int kCallsPerPass = 200;
+
+  // Two milliseconds a call is an eighth of a 60 Hz frame. The floor is
+  // generous enough for an unoptimised build on a slow machine; the figures
+  // printed are the point.
+  constexpr double kSecondsPerCall = 2e-3;
+
+  std::vector<WaveformColumn> columns;
+  for (const size_t span : kWaveformSpanChoices) {
+    std::cout << "[          ] span " << span << ":";
+    for (const int width : kPlotWidths) {
+      WaveformMapping mapping = MakeMapping(width, 400, 1'000, span);
+      mapping.sub_sample_offset = 0.37;
+
+      double best_seconds = 0.0;
+      for (int pass = 0; pass < 4; ++pass) {
+        const auto started = std::chrono::steady_clock::now();
+        for (int call = 0; call < kCallsPerPass; ++call) {
+          DecimateToColumns(codes.data(), codes.size(), mapping, columns);
+        }
+        const double seconds = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count() /
+                               kCallsPerPass;
+
+        // The first pass warms the caches and is not counted
+        if (pass == 1 || (pass > 1 && seconds < best_seconds)) {
+          best_seconds = seconds;
+        }
+      }
+
+      std::cout << " " << width << "px " << best_seconds * 1.0e6 << " us";
+      EXPECT_LT(best_seconds, kSecondsPerCall)
+          << "span " << span << ", width " << width;
+    }
+    std::cout << "\n";
+  }
+}
+
 }  // namespace
 }  // namespace ddd::analysis
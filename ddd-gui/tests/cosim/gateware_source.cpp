@@ -0,0 +1,308 @@
+/************************************************************************
+
+    gateware_source.cpp
+
+    The capture gateware, run cycle by cycle as a sample source
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include "gateware_source.h"
+
+#include <verilated.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "Vcosim_datapath.h"
+#include "fpga_telemetry.h"
+
+namespace ddd::capture {
+namespace {
+
+// The system clock. The ADC samples on every second edge of it, so this is
+// what a second of simulated time costs.
+constexpr uint64_t kSystemClockHz = 2ULL * kSampleRateHz;
+
+constexpr size_t kPacketBytes = kInbandPacketWords * kBytesPerSample;
+
+// Cycles between looks at the pipeline's stop and abort flags. A few hundred
+// microseconds of simulated time, which is a few milliseconds of real time at
+// the rate the model runs — soon enough that a failed capture does not carry
+// on simulating, and rare enough that the atomics cost nothing.
+constexpr uint64_t kControlCheckCycles = uint64_t{1} << 15;
+
+// Held in reset for long enough to clear every stage's synchroniser and the
+// filters' pipelines. The top level's reset synchroniser is two flops.
+constexpr int kResetCycles = 16;
+
+uint64_t SecondsToCycles(double seconds) {
+  return static_cast<uint64_t>(seconds * static_cast<double>(kSystemClockHz));
+}
+
+}  // namespace
+
+GatewareSource::GatewareSource(Options options)
+    : options_(std::move(options)),
+      context_(std::make_unique<VerilatedContext>()) {}
+
+// Out of line, so the header need not see the model's definition
+GatewareSource::~GatewareSource() { Finish(); }
+
+DiskBufferRing::Geometry GatewareSource::PlanGeometry(
+    size_t queue_size_bytes) const {
+  if (options_.slot_size_bytes != 0 && options_.slot_count != 0) {
+    DiskBufferRing::Geometry geometry;
+    geometry.slot_size_bytes = options_.slot_size_bytes;
+    geometry.slot_count = options_.slot_count;
+    return geometry;
+  }
+
+  // Whole packets, as the USB backends plan it
+  return DiskBufferRing::PlanGeometry(queue_size_bytes, kPacketBytes);
+}
+
+TransferResult GatewareSource::Prepare(const DiskBufferRing& ring) {
+  // A slot must end on a packet boundary, or a DMA buffer would have to be
+  // split across two slots and the model would be doing something the
+  // transfer layout never does.
+  if (ring.slot_size_bytes() % kPacketBytes != 0) {
+    return TransferResult::kProgramError;
+  }
+
+  run_cycles_ = SecondsToCycles(options_.run_seconds);
+  usb_cycles_per_buffer_ = std::max<uint64_t>(
+      1, (kPacketBytes * kSystemClockHz) / options_.usb_bytes_per_second);
+  telemetry_interval_cycles_ = std::max<uint64_t>(
+      1, SecondsToCycles(options_.telemetry_interval_seconds));
+
+  stall_cycles_.clear();
+  for (const Stall& stall : options_.stalls) {
+    const uint64_t start = SecondsToCycles(stall.start_seconds);
+    stall_cycles_.emplace_back(start,
+                               start + SecondsToCycles(stall.duration_seconds));
+  }
+
+  pool_.assign(options_.fx3_buffer_count * kPacketBytes, 0);
+  head_ = 0;
+  full_ = 0;
+  receiving_ = false;
+  received_words_ = 0;
+  transfer_in_flight_ = false;
+  transfer_done_cycle_ = 0;
+  adc_value_ = 0;
+
+  cycles_ = 0;
+  words_written_ = 0;
+  words_dropped_ = 0;
+  packets_read_ = 0;
+  polled_dropped_words_ = 0;
+  telemetry_readings_ = 0;
+
+  // A fresh model for every run, so that a second capture from the same
+  // source starts from the same power-on state the first did
+  Finish();
+  model_ = std::make_unique<Vcosim_datapath>(context_.get());
+  model_->decimation = options_.decimation;
+  model_->test_mode = options_.test_mode ? 1 : 0;
+  model_->pack = options_.wire_format == WireFormat::kPacked ? 1 : 0;
+  model_->inband_telemetry = options_.inband_telemetry ? 1 : 0;
+  model_->read_data = 0;
+  model_->telemetry_latch = 0;
+  model_->adc_databus = 0;
+
+  // The registers are written before the FX3 releases the FPGA from reset, as
+  // the firmware does when the host opens the device
+  model_->reset_n = 0;
+  for (int cycle = 0; cycle < kResetCycles; ++cycle) {
+    model_->clock = 0;
+    model_->eval();
+    model_->clock = 1;
+    model_->eval();
+  }
+  model_->reset_n = 1;
+
+  return TransferResult::kSuccess;
+}
+
+bool GatewareSource::HostStalled() const {
+  return std::any_of(stall_cycles_.begin(), stall_cycles_.end(),
+                     [this](const std::pair<uint64_t, uint64_t>& window) {
+                       return cycles_ >= window.first &&
+                              cycles_ < window.second;
+                     });
+}
+
+void GatewareSource::Cycle() {
+  // The ADC pins carry a sawtooth. Nothing checks it — only the test pattern
+  // has an oracle — but the decimation filters run on it at their real rate,
+  // which is what decides when samples reach the buffer.
+  adc_value_ = static_cast<uint16_t>((adc_value_ + 7) & kSampleValueMask);
+  model_->adc_databus = adc_value_;
+
+  // Settle everything combinational on the low half of the clock. The buffer
+  // presents its next word ahead of the edge that takes it, so this is when
+  // the databus holds the word the FX3 is about to latch.
+  model_->clock = 0;
+  model_->eval();
+
+  if (model_->word_written != 0) {
+    ++words_written_;
+  }
+  if (model_->overflow != 0) {
+    ++words_dropped_;
+  }
+
+  if (model_->fx3_is_reading != 0 && receiving_) {
+    const size_t buffer = (head_ + full_) % options_.fx3_buffer_count;
+    uint8_t* destination =
+        pool_.data() + (buffer * kPacketBytes) + (received_words_ * 2);
+    const uint16_t word = model_->fx3_databus;
+    destination[0] = static_cast<uint8_t>(word & 0xFF);
+    destination[1] = static_cast<uint8_t>(word >> 8);
+
+    ++received_words_;
+    if (received_words_ == kInbandPacketWords) {
+      receiving_ = false;
+      received_words_ = 0;
+      ++full_;
+      ++packets_read_;
+    }
+  }
+
+  // The GPIF asks for a packet when one is offered and it has a buffer to put
+  // it in, for one clock. The state machine registers the request and sends
+  // the whole packet, so holding it longer would ask for a second one the
+  // moment the first ended, whether or not one was there.
+  const bool request = !receiving_ && model_->data_available != 0 &&
+                       full_ < options_.fx3_buffer_count;
+  model_->read_data = request ? 1 : 0;
+  if (request) {
+    receiving_ = true;
+  }
+
+  model_->clock = 1;
+  model_->eval();
+  ++cycles_;
+}
+
+void GatewareSource::ReadTelemetry() {
+  // The register read of kRegisterTelemetryId is what pulses the latch, and
+  // the bytes after it are read from the shadow it filled
+  model_->telemetry_latch = 1;
+  Cycle();
+  model_->telemetry_latch = 0;
+
+  std::array<uint8_t, kTelemetryBlockLength> block{};
+  block[0] = kTelemetryIdValue;
+  for (size_t byte = 0; byte < 16; ++byte) {
+    block[kTelemetryOffsetStatus + byte] = static_cast<uint8_t>(
+        (model_->telemetry[byte / 4] >> (8 * (byte % 4))) & 0xFF);
+  }
+  const uint64_t geometry = model_->telemetry_geometry;
+  for (size_t byte = 0; byte < 6; ++byte) {
+    block[kTelemetryOffsetDepth + byte] =
+        static_cast<uint8_t>((geometry >> (8 * byte)) & 0xFF);
+  }
+
+  const FpgaTelemetry reading = ParseFpgaTelemetry(block);
+  if (reading.present) {
+    polled_dropped_words_ += reading.dropped_words;
+    ++telemetry_readings_;
+  }
+  telemetry_.Publish(reading);
+}
+
+TransferResult GatewareSource::Run(DiskBufferRing& ring,
+                                   SourceControl& control) {
+  const size_t slot_bytes = ring.slot_size_bytes();
+  size_t slot_index = 0;
+  size_t slot_offset = 0;
+  bool stopping = false;
+  uint64_t next_telemetry_cycle = telemetry_interval_cycles_;
+  uint64_t next_control_cycle = 0;
+
+  if (!ring.WaitForSlotFree(slot_index)) {
+    return TransferResult::kForcedAbort;
+  }
+
+  while (true) {
+    if (cycles_ >= next_control_cycle) {
+      next_control_cycle = cycles_ + kControlCheckCycles;
+      if (control.AbortRequested() || ring.AbortRequested()) {
+        return TransferResult::kForcedAbort;
+      }
+      stopping = stopping || control.StopRequested();
+    }
+
+    if (run_cycles_ != 0 && cycles_ >= run_cycles_) {
+      return TransferResult::kSuccess;
+    }
+
+    Cycle();
+
+    if (cycles_ >= next_telemetry_cycle) {
+      ReadTelemetry();
+      next_telemetry_cycle = cycles_ + telemetry_interval_cycles_;
+    }
+
+    // The host's side: one bulk transfer at a time, a DMA buffer each, and
+    // none started while a stall is on.
+    if (!transfer_in_flight_ && full_ > 0 && !HostStalled()) {
+      transfer_in_flight_ = true;
+      transfer_done_cycle_ = cycles_ + usb_cycles_per_buffer_;
+    }
+
+    if (!transfer_in_flight_ || cycles_ < transfer_done_cycle_) {
+      continue;
+    }
+
+    std::memcpy(ring.SlotData(slot_index) + slot_offset,
+                pool_.data() + (head_ * kPacketBytes), kPacketBytes);
+    head_ = (head_ + 1) % options_.fx3_buffer_count;
+    --full_;
+    transfer_in_flight_ = false;
+    slot_offset += kPacketBytes;
+    control.AddCompletedTransfers(1);
+
+    if (slot_offset < slot_bytes) {
+      continue;
+    }
+
+    switch (ring.MarkSlotFull(slot_index)) {
+      case DiskBufferRing::FillResult::kHandedOver:
+        break;
+      case DiskBufferRing::FillResult::kOverflow:
+        return TransferResult::kBufferOverflow;
+      case DiskBufferRing::FillResult::kAborted:
+        return TransferResult::kForcedAbort;
+    }
+
+    if (stopping) {
+      return TransferResult::kSuccess;
+    }
+
+    // A ring the host has not emptied holds the clock here, which is the point
+    // of simulating: the model has no deadline to miss.
+    slot_index = (slot_index + 1) % ring.slot_count();
+    slot_offset = 0;
+    if (!ring.WaitForSlotFree(slot_index)) {
+      return TransferResult::kForcedAbort;
+    }
+  }
+}
+
+// Verilator asks for final() before a model is deleted, which is when the
+// design's final blocks run. There are none today; the call costs nothing and
+// keeps one from being skipped the day there is.
+void GatewareSource::Finish() {
+  if (model_ != nullptr) {
+    model_->final();
+    model_.reset();
+  }
+}
+
+}  // namespace ddd::capture
@@ -0,0 +1,174 @@
+/************************************************************************
+
+    gateware_source.h
+
+    The capture gateware, run cycle by cycle as a sample source
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "monitor_tap.h"
+#include "sample_format.h"
+#include "sample_source.h"
+#include "wire_protocol.h"
+
+class VerilatedContext;
+class Vcosim_datapath;
+
+namespace ddd::capture {
+
+// Drives a Verilator model of the gateware's capture datapath
+// (fpga/tests/cosimDatapath.v) and hands what it streams to the pipeline.
+//
+// SyntheticSource proves the host against a stream that is always on time. This
+// proves it against the buffer that decides whether a stream is on time at all:
+// the FIFO, its packet threshold, the in-band block and the instrument are the
+// gateware's own, clocked at 80 MHz, and what reaches the ring is exactly what
+// the FX3 would have been handed. A host that stops taking packets here fills
+// the real FIFO, and the drop the pipeline has to account for is one the real
+// buffer made.
+//
+// The FX3 and the USB link are modelled, not simulated: a pool of DMA buffers
+// the size the firmware allocates, a read requested whenever one is free and a
+// packet is offered, and a host that empties a buffer at a fixed bus rate
+// except while a stall is injected. That is enough to put the FIFO under the
+// pressure a real host puts it under and no more — the GPIF's own timing is
+// fx3StateMachine.v's testbench's business.
+//
+// Time here is simulated time. Every figure in Options is in simulated seconds,
+// and a host slower than the model simply makes the model wait: the ring being
+// full stops the clock rather than costing samples, so the only losses are the
+// ones a test asked for.
+//
+// Thread-safety: as ISampleSource. The counters are plain rather than atomic,
+// because they move every cycle and the model is what the time goes on, so
+// they are for reading once the pipeline has been waited for and not before.
+class GatewareSource : public ISampleSource {
+ public:
+  // A window in which the host takes nothing from the device. Transfers already
+  // in flight complete; nothing new is started until it ends.
+  struct Stall {
+    double start_seconds = 0.0;
+    double duration_seconds = 0.0;
+  };
+
+  struct Options {
+    // The register bank's settings, as the host would have written them
+    uint8_t decimation = 1;
+    bool test_mode = true;
+    WireFormat wire_format = WireFormat::kWords;
+    bool inband_telemetry = false;
+
+    // Simulated time to run for before returning kSuccess. 0 means until asked
+    // to stop.
+    double run_seconds = 1.0;
+
+    std::vector<Stall> stalls;
+
+    // The FX3's DMA pool: CY_FX_DMA_BUF_COUNT buffers on each of the two
+    // producer sockets in fx3/firmware/src/domesday-duplicator.h.
+    size_t fx3_buffer_count = 12;
+
+    // How fast the host empties a full DMA buffer once it is taking them. A
+    // working USB 3 link sustains well over the 80 MB/s the device produces,
+    // which is what lets the FIFO drain between packets.
+    uint64_t usb_bytes_per_second = 320'000'000;
+
+    // How often the register telemetry is read. The application polls every
+    // 250 ms; a test that wants every interval accounted for shortens it.
+    double telemetry_interval_seconds = 0.25;
+
+    // Ring geometry. Four packets a slot keeps a run of a few simulated seconds
+    // from spending its time waiting on 2 MB slots to fill.
+    size_t slot_size_bytes = 4 * kInbandPacketWords * kBytesPerSample;
+    size_t slot_count = 32;
+  };
+
+  explicit GatewareSource(Options options);
+  ~GatewareSource() override;
+
+  const char* Name() const override { return "gateware"; }
+
+  DiskBufferRing::Geometry PlanGeometry(size_t queue_size_bytes) const override;
+
+  TransferResult Prepare(const DiskBufferRing& ring) override;
+  TransferResult Run(DiskBufferRing& ring, SourceControl& control) override;
+  void Finish() override;
+
+  FpgaTelemetry DeviceTelemetry() const override { return telemetry_.Read(); }
+
+  // Clock cycles simulated, at 80 MHz
+  uint64_t SimulatedCycles() const { return cycles_; }
+
+  // Words the packer wrote into the buffer, and how many of those the buffer
+  // had no room for. Counted at the buffer's ports every cycle, so these are
+  // the reference the instrument's own figures are held against.
+  uint64_t WordsWritten() const { return words_written_; }
+  uint64_t WordsDropped() const { return words_dropped_; }
+
+  // Packets the modelled FX3 took off the databus
+  uint64_t PacketsRead() const { return packets_read_; }
+
+  // Samples the instrument reported dropped, summed over every register
+  // reading this source took — the polled path's total, which unlike the
+  // pipeline's sees every interval because nothing else reads the registers.
+  uint64_t PolledDroppedWords() const { return polled_dropped_words_; }
+  uint64_t TelemetryReadings() const { return telemetry_readings_; }
+
+ private:
+  // One system clock: the FX3's half of the GPIF, then the edge.
+  void Cycle();
+
+  // Latch the instrument, read it back as the register bank would present it,
+  // and publish it.
+  void ReadTelemetry();
+
+  bool HostStalled() const;
+
+  Options options_;
+
+  std::unique_ptr<VerilatedContext> context_;
+  std::unique_ptr<Vcosim_datapath> model_;
+
+  // Simulated-time figures, converted to cycles once
+  uint64_t run_cycles_ = 0;
+  uint64_t usb_cycles_per_buffer_ = 0;
+  uint64_t telemetry_interval_cycles_ = 0;
+  std::vector<std::pair<uint64_t, uint64_t>> stall_cycles_;
+
+  // The FX3's pool, a ring of whole packets. head_ is the oldest full one,
+  // full_ how many are waiting for the host, and receiving_ whether the one
+  // after them is being written by the GPIF.
+  std::vector<uint8_t> pool_;
+  size_t head_ = 0;
+  size_t full_ = 0;
+  bool receiving_ = false;
+  size_t received_words_ = 0;
+
+  // The host's transfer in progress, if any, and when it completes
+  bool transfer_in_flight_ = false;
+  uint64_t transfer_done_cycle_ = 0;
+
+  uint16_t adc_value_ = 0;
+
+  TelemetryPublisher telemetry_;
+
+  uint64_t cycles_ = 0;
+  uint64_t words_written_ = 0;
+  uint64_t words_dropped_ = 0;
+  uint64_t packets_read_ = 0;
+  uint64_t polled_dropped_words_ = 0;
+  uint64_t telemetry_readings_ = 0;
+};
+
+}  // namespace ddd::capture
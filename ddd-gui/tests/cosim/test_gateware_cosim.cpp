@@ -0,0 +1,251 @@
+/************************************************************************
+
+    test_gateware_cosim.cpp
+
+    T3 co-simulation: the host pipeline against the capture gateware
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#include "capture_pipeline.h"
+#include "gateware_source.h"
+#include "logger.h"
+#include "monitor_tap.h"
+#include "sample_format.h"
+#include "sample_sink.h"
+#include "wire_protocol.h"
+
+// The gateware's testbenches prove each module against its own contract, and
+// the pipeline's tests prove the host against a synthetic stream. Neither
+// proves that the two agree: that what the buffer puts on the databus after a
+// stall is what the validator expects to find, that the instrument's counters
+// mean to the parser what the gateware meant by them, or that the in-band
+// block lands where the stripper looks. Here the buffer is the real one,
+// compiled from fpga/application by Verilator, and the host is the real
+// pipeline, so a disagreement between them fails a test rather than a capture.
+//
+// What it does not cover: the GPIF's electrical timing, the FX3's DMA engine
+// and the USB stack, which are modelled in GatewareSource rather than
+// simulated. TESTING.md §5 is still the only test of those.
+
+namespace ddd::capture {
+namespace {
+
+// The depth the top level instantiates, and therefore what the instrument must
+// report. Stated here rather than read back so that the test notices if the
+// model and the image ever stop agreeing.
+constexpr uint16_t kFifoDepthWords = 24576;
+
+// How much simulated time the clean run covers. A quarter of a second by
+// default, which is 20 million system clocks: the sequence counter wraps every
+// 0.103 s at 40 MSPS, so that is two wraps, with the ramp wrapping ten thousand
+// times and the telemetry polled a dozen. The model is cycle-accurate and
+// single-threaded, so every simulated second is 80 million evaluations of the
+// whole datapath; the clean test prints what that cost in real time, which is
+// the figure to look at before raising this.
+//
+// DDD_COSIM_SECONDS changes it, in whole seconds, on the same terms as
+// DDD_SOAK_SECONDS. A value it cannot read leaves the default.
+constexpr double kDefaultCosimSeconds = 0.25;
+
+double CosimSeconds() {
+  const char* const configured = std::getenv("DDD_COSIM_SECONDS");
+  if (configured == nullptr) {
+    return kDefaultCosimSeconds;
+  }
+
+  char* end = nullptr;
+  errno = 0;
+  const std::int64_t seconds = std::strtoll(configured, &end, 10);
+  if (end == configured || *end != '\0' || errno != 0 || seconds <= 0 ||
+      seconds > std::numeric_limits<int>::max()) {
+    return kDefaultCosimSeconds;
+  }
+
+  return static_cast<double>(seconds);
+}
+
+struct CosimOutcome {
+  TransferResult result = TransferResult::kRunning;
+  CaptureStats stats;
+};
+
+CosimOutcome RunCosim(GatewareSource& source,
+                      const GatewareSource::Options& source_options,
+                      ILogger* logger) {
+  CapturePipeline::Options pipeline_options;
+  pipeline_options.lock_memory = false;
+  pipeline_options.elevate_priority = false;
+  pipeline_options.test_mode = source_options.test_mode;
+  pipeline_options.wire_format = source_options.wire_format;
+  pipeline_options.inband_telemetry = source_options.inband_telemetry;
+  pipeline_options.sample_rate_hz = kSampleRateHz / source_options.decimation;
+
+  // The model runs slower than the device, and a sanitiser build slower again.
+  // The watchdog is for sources that have stopped, which this one cannot.
+  pipeline_options.stall_timeout = std::chrono::milliseconds(60'000);
+
+  CapturePipeline pipeline(logger);
+
+  CosimOutcome outcome;
+  if (pipeline.Start(&source, std::make_unique<NullSink>(),
+                     pipeline_options)) {
+    pipeline.Wait();
+  }
+  outcome.result = pipeline.Result();
+  outcome.stats = pipeline.stats().Read();
+  return outcome;
+}
+
+// Words the host cannot have seen by the time the source returns: a full FIFO,
+// a full DMA pool and a part-filled slot.
+uint64_t WordsInFlight(const GatewareSource::Options& options) {
+  return kFifoDepthWords +
+         ((options.fx3_buffer_count + (options.slot_size_bytes /
+                                       kBytesPerSample / kInbandPacketWords)) *
+          kInbandPacketWords);
+}
+
+TEST(GatewareCosimTest, ACleanRunDeliversEveryWordTheBufferWasGiven) {
+  CallbackLogger logger(nullptr, LogLevel::kWarning);
+
+  GatewareSource::Options options;
+  options.run_seconds = CosimSeconds();
+  options.telemetry_interval_seconds = options.run_seconds / 12.0;
+  GatewareSource source(options);
+
+  const auto started = std::chrono::steady_clock::now();
+  const CosimOutcome outcome = RunCosim(source, options, &logger);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - started;
+  std::cout << "[          ] " << options.run_seconds << "s simulated, "
+            << source.SimulatedCycles() << " cycles, " << source.PacketsRead()
+            << " packets in " << elapsed.count() << "s ("
+            << (static_cast<double>(source.SimulatedCycles()) /
+                std::max(elapsed.count(), 1e-9) / 1e6)
+            << " MHz)\n";
+
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kRunning);
+  EXPECT_TRUE(outcome.stats.test_pattern_checked);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+
+  // A sample every second clock, all of them kept
+  EXPECT_NEAR(static_cast<double>(source.WordsWritten()),
+              static_cast<double>(source.SimulatedCycles()) / 2.0, 2.0);
+  EXPECT_EQ(source.WordsDropped(), 0U);
+  EXPECT_LE(source.WordsWritten() - outcome.stats.metrics.sample_count,
+            WordsInFlight(options));
+
+  // The register path, parsed by the host's own parser
+  EXPECT_GT(source.TelemetryReadings(), 0U);
+  EXPECT_EQ(source.PolledDroppedWords(), 0U);
+  EXPECT_TRUE(outcome.stats.device_buffer.present);
+  EXPECT_EQ(outcome.stats.device_buffer.depth_words, kFifoDepthWords);
+  EXPECT_EQ(outcome.stats.device_buffer.packet_words, kInbandPacketWords);
+  EXPECT_FALSE(outcome.stats.device_buffer.overflow_since_open);
+  EXPECT_EQ(outcome.stats.device_dropped_words, 0U);
+}
+
+// Packed at the lowest rate the chain offers, with the in-band block on: the
+// three features whose framing the host has to undo, all at once.
+TEST(GatewareCosimTest, APackedEighthRateStreamWithInbandBlocksIsClean) {
+  CallbackLogger logger(nullptr, LogLevel::kWarning);
+
+  GatewareSource::Options options;
+  options.run_seconds = 0.25;
+  options.decimation = kDecimationEighthRate;
+  options.wire_format = WireFormat::kPacked;
+  options.inband_telemetry = true;
+  GatewareSource source(options);
+
+  const CosimOutcome outcome = RunCosim(source, options, &logger);
+
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_TRUE(outcome.stats.test_pattern_checked);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+  EXPECT_GT(outcome.stats.metrics.sample_count, 0U);
+  EXPECT_EQ(source.WordsDropped(), 0U);
+  EXPECT_EQ(outcome.stats.device_dropped_words, 0U);
+}
+
+// The FX3's twelve buffers are 2.46 ms at full rate and the FIFO's headroom
+// above a packet is another 0.41 ms. A stall of 2.75 ms outlasts the first by
+// enough to push the FIFO past its packet threshold wherever in the sawtooth it
+// began, and stops short of the second by enough never to reach the top: the
+// instrument has to see it without anything having been lost.
+TEST(GatewareCosimTest, AStallInsideTheHeadroomCostsNothingAndIsSeen) {
+  CallbackLogger logger(nullptr, LogLevel::kWarning);
+
+  GatewareSource::Options options;
+  options.run_seconds = 0.1;
+  options.inband_telemetry = true;
+  options.stalls.push_back({0.05, 0.00275});
+  GatewareSource source(options);
+
+  const CosimOutcome outcome = RunCosim(source, options, &logger);
+
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+  EXPECT_EQ(source.WordsDropped(), 0U);
+  EXPECT_EQ(outcome.stats.device_dropped_words, 0U);
+  EXPECT_EQ(outcome.stats.device_overflow_events, 0U);
+  EXPECT_GT(outcome.stats.peak_device_buffer_words, kInbandPacketWords)
+      << "the stall outlasted the DMA pool, so the FIFO must have risen above "
+         "a packet";
+  EXPECT_LT(outcome.stats.peak_device_buffer_words, kFifoDepthWords);
+  EXPECT_GT(outcome.stats.peak_back_pressure_percent, 0);
+}
+
+// Four milliseconds is past everything the device can hold. The FIFO drops
+// what it cannot take, the host must stop on the gap, and both of the
+// instrument's paths must account for exactly the samples the buffer threw
+// away — not roughly, because a drop count that is merely plausible is the
+// one figure nobody would ever check by hand.
+//
+// Short enough that the drop stays inside a 16-bit interval counter: the
+// in-band interval cannot close while the FIFO is full, so the whole drop
+// lands in one block.
+TEST(GatewareCosimTest, AStallPastTheHeadroomIsCountedExactlyByBothPaths) {
+  CallbackLogger logger(nullptr, LogLevel::kError);
+
+  GatewareSource::Options options;
+  options.run_seconds = 0.1;
+  options.inband_telemetry = true;
+  options.telemetry_interval_seconds = 0.0001;
+  options.stalls.push_back({0.05, 0.004});
+  GatewareSource source(options);
+
+  const CosimOutcome outcome = RunCosim(source, options, &logger);
+
+  ASSERT_GT(source.WordsDropped(), 0U);
+  ASSERT_LT(source.WordsDropped(), 65535U);
+
+  EXPECT_EQ(outcome.result, TransferResult::kSequenceMismatch);
+
+  // In band, through the stripper and the pipeline's accumulation
+  EXPECT_EQ(outcome.stats.device_dropped_words, source.WordsDropped());
+  EXPECT_EQ(outcome.stats.device_overflow_events, 1U);
+  EXPECT_EQ(outcome.stats.peak_device_buffer_words, kFifoDepthWords);
+  EXPECT_EQ(outcome.stats.peak_back_pressure_percent, 100);
+
+  // And through the register bank, every interval of it
+  EXPECT_EQ(source.PolledDroppedWords(), source.WordsDropped());
+  EXPECT_TRUE(outcome.stats.device_buffer.overflow_since_open);
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -0,0 +1,195 @@
+/************************************************************************
+
+    test_capture_overview_build.cpp
+
+    T1/T2 tests for measuring an overview from a finished capture
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "capture_format.h"
+#include "capture_overview.h"
+#include "capture_overview_build.h"
+#include "flac_writer.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+namespace {
+
+// A capture and the overview beside it, both removed afterwards.
+class TemporaryCapture {
+ public:
+  explicit TemporaryCapture(const std::string& suffix) {
+    const ::testing::TestInfo* const info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+    path_ = std::filesystem::temp_directory_path() /
+            (std::string("ddd-overview-build-") +
+             (info != nullptr ? info->name() : "unknown") + suffix);
+    Remove();
+  }
+
+  ~TemporaryCapture() { Remove(); }
+
+  TemporaryCapture(const TemporaryCapture&) = delete;
+  TemporaryCapture& operator=(const TemporaryCapture&) = delete;
+  TemporaryCapture(TemporaryCapture&&) = delete;
+  TemporaryCapture& operator=(TemporaryCapture&&) = delete;
+
+  const std::filesystem::path& path() const { return path_; }
+
+ private:
+  void Remove() {
+    std::error_code ignored;
+    std::filesystem::remove(path_, ignored);
+    std::filesystem::remove(CaptureOverviewPath(path_), ignored);
+  }
+
+  std::filesystem::path path_;
+};
+
+void WriteSigned16Bit(const std::filesystem::path& path,
+                      const std::vector<uint16_t>& values) {
+  std::vector<char> bytes;
+  bytes.reserve(values.size() * kBytesPerSample);
+  for (const uint16_t value : values) {
+    const auto sample = static_cast<uint16_t>(
+        ToSigned16Bit(static_cast<int32_t>(value)));
+    bytes.push_back(static_cast<char>(sample & 0xFF));
+    bytes.push_back(static_cast<char>((sample >> 8) & 0xFF));
+  }
+  std::ofstream file(path, std::ios::binary);
+  file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Two and a half blocks, each at a level of its own and the second with one
+// clipped sample, so a block measured from the wrong stretch of the file shows.
+std::vector<uint16_t> Steps() {
+  std::vector<uint16_t> values;
+  const size_t count = (kOverviewBlockSamples * 5) / 2;
+  values.reserve(count);
+  for (size_t index = 0; index < count; ++index) {
+    const size_t block = index / kOverviewBlockSamples;
+    values.push_back(static_cast<uint16_t>(300 + (100 * block) + (index % 2)));
+  }
+  values[kOverviewBlockSamples + 7] = kMaximumSampleValue;
+  return values;
+}
+
+TEST(CaptureOverviewBuildTest, AFileIsMeasuredBlockByBlockAndWrittenBesideIt) {
+  const TemporaryCapture capture(".ddd.s16");
+  const std::vector<uint16_t> values = Steps();
+  WriteSigned16Bit(capture.path(), values);
+
+  const OverviewBuild build = BuildCaptureOverview(capture.path(), {}, {}, 2);
+  ASSERT_TRUE(build.built()) << build.message;
+  EXPECT_EQ(build.overview_path, CaptureOverviewPath(capture.path()));
+
+  const std::vector<OverviewBlock>& blocks = build.overview.levels[0];
+  ASSERT_EQ(blocks.size(), 3U);
+  EXPECT_EQ(blocks[0].minimum_value, 300);
+  EXPECT_EQ(blocks[0].maximum_value, 301);
+  EXPECT_EQ(blocks[1].first_sample, kOverviewBlockSamples);
+  EXPECT_EQ(blocks[1].minimum_value, 400);
+  EXPECT_EQ(blocks[1].maximum_value, kMaximumSampleValue);
+  EXPECT_EQ(blocks[1].clipped_high_count, 1U);
+  EXPECT_EQ(blocks[2].sample_count, kOverviewBlockSamples / 2);
+
+  // And the file says the same
+  CaptureOverviewFile reader;
+  std::string error;
+  ASSERT_TRUE(reader.Open(build.overview_path, error)) << error;
+  EXPECT_EQ(reader.total_samples(), values.size());
+  EXPECT_EQ(reader.block_samples(), kOverviewBlockSamples);
+
+  // An uncompressed file does not say what rate it was taken at, and the
+  // overview does not guess
+  EXPECT_EQ(reader.sample_rate_hz(), 0U);
+}
+
+TEST(CaptureOverviewBuildTest, AFlacCaptureIsTimedAtTheRateItsHeaderGives) {
+  const TemporaryCapture capture(".ddd.flac");
+  const std::vector<uint16_t> values = Steps();
+
+  // As the device delivers them: 10-bit values, little-endian, a word each
+  std::vector<uint8_t> wire;
+  wire.reserve(values.size() * kBytesPerSample);
+  for (const uint16_t value : values) {
+    wire.push_back(static_cast<uint8_t>(value & 0xFF));
+    wire.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+  }
+
+  FlacWriter writer;
+  FlacWriter::Options options;
+  options.sample_rate_label =
+      FlacSampleRateLabelFor(kEighthRateDecimationFactor);
+  std::string error;
+  ASSERT_TRUE(writer.Open(capture.path(), options, error)) << error;
+  ASSERT_TRUE(writer.WriteRawDeviceSamples(wire.data(), values.size()));
+  ASSERT_TRUE(writer.Finish());
+
+  const OverviewBuild build = BuildCaptureOverview(capture.path());
+  ASSERT_TRUE(build.built()) << build.message;
+  EXPECT_EQ(build.overview.sample_rate_hz, kSampleRateHz / 8);
+
+  CaptureOverviewFile reader;
+  ASSERT_TRUE(reader.Open(build.overview_path, error)) << error;
+  EXPECT_EQ(reader.sample_rate_hz(), kSampleRateHz / 8);
+}
+
+TEST(CaptureOverviewBuildTest, TheThreadCountDoesNotChangeTheResult) {
+  const TemporaryCapture capture(".ddd.s16");
+  WriteSigned16Bit(capture.path(), Steps());
+
+  const OverviewBuild one = BuildCaptureOverview(capture.path(), {}, {}, 1);
+  const OverviewBuild many = BuildCaptureOverview(capture.path(), {}, {}, 7);
+  ASSERT_TRUE(one.built()) << one.message;
+  ASSERT_TRUE(many.built()) << many.message;
+
+  ASSERT_EQ(one.overview.levels.size(), many.overview.levels.size());
+  for (size_t level = 0; level < one.overview.levels.size(); ++level) {
+    ASSERT_EQ(one.overview.levels[level].size(),
+              many.overview.levels[level].size());
+    for (size_t index = 0; index < one.overview.levels[level].size();
+         ++index) {
+      const OverviewBlock& a = one.overview.levels[level][index];
+      const OverviewBlock& b = many.overview.levels[level][index];
+      EXPECT_EQ(a.first_sample, b.first_sample);
+      EXPECT_EQ(a.sum_of_squares, b.sum_of_squares);
+      EXPECT_EQ(a.minimum_value, b.minimum_value);
+      EXPECT_EQ(a.maximum_value, b.maximum_value);
+    }
+  }
+}
+
+TEST(CaptureOverviewBuildTest, ACancelledBuildWritesNothing) {
+  const TemporaryCapture capture(".ddd.s16");
+  WriteSigned16Bit(capture.path(), Steps());
+
+  const OverviewBuild build =
+      BuildCaptureOverview(capture.path(), {}, [] { return true; });
+  EXPECT_EQ(build.outcome, OverviewBuild::Outcome::kCancelled);
+  EXPECT_FALSE(std::filesystem::exists(CaptureOverviewPath(capture.path())));
+}
+
+TEST(CaptureOverviewBuildTest, AFileThatIsNotACaptureIsReportedNotMeasured) {
+  const TemporaryCapture capture(".lds");
+  WriteSigned16Bit(capture.path(), Steps());
+
+  const OverviewBuild build = BuildCaptureOverview(capture.path());
+  EXPECT_EQ(build.outcome, OverviewBuild::Outcome::kFailed);
+  EXPECT_FALSE(build.message.empty());
+}
+
+}  // namespace
+}  // namespace ddd::capture
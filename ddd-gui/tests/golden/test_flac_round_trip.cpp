@@ -9,9 +9,11 @@
 
 ************************************************************************/
 
+#include <FLAC/stream_decoder.h>
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
@@ -115,6 +117,45 @@ std::vector<uint16_t> ReadEverything(CaptureReader& reader) {
   return all;
 }
 
+// STREAMINFO's MD5, as the file holds it. All zero means "not computed",
+// which a decoder takes as nothing to check.
+std::array<uint8_t, 16> StreamInfoMd5(const std::filesystem::path& path) {
+  std::array<uint8_t, 16> md5{};
+  std::ifstream stream(path, std::ios::binary);
+  stream.seekg(26);
+  stream.read(reinterpret_cast<char*>(md5.data()),
+              static_cast<std::streamsize>(md5.size()));
+  return md5;
+}
+
+// Decode the whole file with libFLAC's own MD5 checking on, which is what
+// flac -t does. libFLAC says nothing until the end of the stream, where a
+// finish that fails is a hash that did not match.
+bool LibFlacAcceptsTheMd5(const std::filesystem::path& path) {
+  FLAC__StreamDecoder* const decoder = FLAC__stream_decoder_new();
+  if (decoder == nullptr) {
+    return false;
+  }
+  FLAC__stream_decoder_set_md5_checking(decoder, true);
+  const auto write = [](const FLAC__StreamDecoder*, const FLAC__Frame*,
+                        const FLAC__int32* const[], void*) {
+    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+  };
+  const auto error = [](const FLAC__StreamDecoder*,
+                        FLAC__StreamDecoderErrorStatus, void* client_data) {
+    *static_cast<bool*>(client_data) = true;
+  };
+  bool decode_error = false;
+  bool ok = FLAC__stream_decoder_init_file(decoder, path.string().c_str(),
+                                           write, nullptr, error,
+                                           &decode_error) ==
+            FLAC__STREAM_DECODER_INIT_STATUS_OK;
+  ok = ok && FLAC__stream_decoder_process_until_end_of_stream(decoder);
+  ok = FLAC__stream_decoder_finish(decoder) && ok;
+  FLAC__stream_decoder_delete(decoder);
+  return ok && !decode_error;
+}
+
 TEST(FlacRoundTripTest, EverySampleSurvivesTheEncodeAndDecode) {
   // The property everything else rests on. A capture is an archival artefact;
   // if the compression were not lossless the whole format choice would be
@@ -255,6 +296,38 @@ TEST(FlacRoundTripTest, TheDecodedLengthIsKnownBeforeReadingTheSamples) {
   EXPECT_EQ(reader.TotalSamples(), std::optional<uint64_t>(values.size()));
 }
 
+// A file opened further down the effort ladder, as the next file of a capture
+// that had to ease off is. It is an ordinary one-encoder stream at the lower
+// level, with libFLAC's own STREAMINFO and MD5.
+TEST(FlacRoundTripTest, AFileOpenedDownTheLadderIsAnOrdinaryStream) {
+  const std::vector<uint16_t> values = SampleValues(60'000);
+  const std::vector<uint8_t> wire = ToWireBytes(values);
+
+  TemporaryFile file(".ddd.flac");
+  {
+    FlacWriter::Options options;
+    options.effort_step = 2;
+
+    FlacWriter writer;
+    std::string error;
+    ASSERT_TRUE(writer.Open(file.path(), options, error)) << error;
+    EXPECT_EQ(writer.EffortLevels(), (std::vector<int>{8, 5, 3, 0}));
+    EXPECT_EQ(writer.EffortStep(), 2U);
+    ASSERT_TRUE(writer.WriteRawDeviceSamples(wire.data(), values.size()));
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  CaptureReader reader;
+  std::string error;
+  ASSERT_TRUE(reader.Open(file.path(), CaptureReader::Format::kFlac, error))
+      << error;
+  EXPECT_EQ(reader.TotalSamples(), std::optional<uint64_t>(values.size()));
+  EXPECT_EQ(ReadEverything(reader), values);
+
+  EXPECT_NE(StreamInfoMd5(file.path()), (std::array<uint8_t, 16>{}));
+  EXPECT_TRUE(LibFlacAcceptsTheMd5(file.path()));
+}
+
 TEST(CaptureReaderTest, TheUncompressedFormatReadsBackTheSameValues) {
   TemporaryFile file(".s16");
 
@@ -346,6 +419,24 @@ TEST(DecimationTest, TheRateLabelHalvesWithTheRate) {
   EXPECT_EQ(SampleRateHzFor(kTapeDecimationFactor), kSampleRateHz / 2);
   EXPECT_EQ(SampleRateHzFor(3), kSampleRateHz);
 
+  // The cascade's factors, on the same terms. 5 Msps labels as 5000, which
+  // FLAC's field holds as easily as 40000.
+  EXPECT_EQ(FlacSampleRateLabelFor(kQuarterRateDecimationFactor),
+            kFlacSampleRateLabel / 4);
+  EXPECT_EQ(FlacSampleRateLabelFor(kEighthRateDecimationFactor),
+            kFlacSampleRateLabel / 8);
+  EXPECT_EQ(SampleRateHzFor(kQuarterRateDecimationFactor), kSampleRateHz / 4);
+  EXPECT_EQ(SampleRateHzFor(kEighthRateDecimationFactor), kSampleRateHz / 8);
+  EXPECT_EQ(SampleRateHzFor(16), kSampleRateHz);
+
+  // And back from the label, which is how a file measured after the fact gets
+  // the rate its overview is timed with. A label this application never wrote
+  // says nothing.
+  EXPECT_EQ(SampleRateHzForFlacLabel(kFlacSampleRateLabel), kSampleRateHz);
+  EXPECT_EQ(SampleRateHzForFlacLabel(kFlacSampleRateLabel / 8),
+            kSampleRateHz / 8);
+  EXPECT_EQ(SampleRateHzForFlacLabel(44'100), 0U);
+
   TemporaryFile file(".ddd.flac");
   const std::vector<uint16_t> values = SampleValues(4096);
   const std::vector<uint8_t> wire = ToWireBytes(values);
@@ -377,6 +468,12 @@ TEST(DecimationTest, TheRateLabelHalvesWithTheRate) {
   const uint32_t rate = (byte(18) << 12) | (byte(19) << 4) | (byte(20) >> 4);
 
   EXPECT_EQ(rate, kFlacSampleRateLabel / 2);
+
+  // And the reader turns the label back into the rate
+  CaptureReader reader;
+  ASSERT_TRUE(reader.Open(file.path(), CaptureReader::Format::kFlac, error))
+      << error;
+  EXPECT_EQ(reader.SampleRateHz(), std::optional<uint32_t>(kSampleRateHz / 2));
 }
 
 TEST(CaptureReaderTest, AnUnsupportedExtensionIsDeclinedRatherThanGuessedAt) {
@@ -14,6 +14,7 @@
 #include <QSignalSpy>
 #include <cmath>
 #include <numbers>
+#include <optional>
 #include <vector>
 
 #include "analysis_worker.h"
@@ -21,6 +22,7 @@
 #include "monitor_tap.h"
 #include "sample_format.h"
 #include "spectrum_analyser.h"
+#include "waveform_mapping.h"
 
 namespace ddd::gui {
 namespace {
@@ -131,6 +133,49 @@ TEST(SnapshotAnalyserTest, DetachingStopsTheFramesWithoutStoppingTheObject) {
   EXPECT_EQ(waveform.count(), 1);
 }
 
+TEST(SnapshotAnalyserTest, AnAttachedSourceIsArmedUnlessTheTriggerIsOff) {
+  // Armed with the scope's own trigger, so the crossing the pipeline lines up
+  // on is one the plot would have taken itself.
+  capture::SnapshotPublisher publisher(kSnapshotSamples *
+                                       capture::kBytesPerSample);
+
+  SnapshotAnalyser analyser;
+  analyser.SetSource(&publisher);
+  const std::optional<capture::SnapshotTrigger> armed =
+      publisher.ArmedTrigger();
+  ASSERT_TRUE(armed.has_value());
+  EXPECT_EQ(armed->level_codes, 512);
+  EXPECT_DOUBLE_EQ(armed->pre_trigger_fraction, analysis::kPreTriggerFraction);
+
+  analyser.SetSnapshotTrigger(false);
+  EXPECT_FALSE(publisher.ArmedTrigger().has_value());
+
+  // And a source attached while it is off is left alone
+  capture::SnapshotPublisher next(kSnapshotSamples * capture::kBytesPerSample);
+  analyser.SetSource(&next);
+  EXPECT_FALSE(next.ArmedTrigger().has_value());
+}
+
+TEST(SnapshotAnalyserTest, TheSnapshotsCrossingTravelsWithItsCodes) {
+  capture::SnapshotPublisher publisher(kSnapshotSamples *
+                                       capture::kBytesPerSample);
+  const std::vector<uint8_t> wire =
+      MakeWire(std::vector<uint16_t>(kSnapshotSamples, 512));
+
+  SnapshotAnalyser analyser;
+  analyser.SetSource(&publisher);
+  QSignalSpy waveform(&analyser, &SnapshotAnalyser::WaveformReady);
+
+  publisher.Publish(wire.data(), wire.size(), 409.5);
+  analyser.Poll();
+  publisher.Publish(wire.data(), wire.size());
+  analyser.Poll();
+
+  ASSERT_EQ(waveform.count(), 2);
+  EXPECT_DOUBLE_EQ(waveform.at(0).at(1).toDouble(), 409.5);
+  EXPECT_LT(waveform.at(1).at(1).toDouble(), 0.0);
+}
+
 TEST(SnapshotAnalyserTest, ASnapshotShorterThanATransformStillDrawsAWaveform) {
   // The scope can show anything; the spectrum cannot be computed from fewer
   // samples than its window. One must not take the other down with it.
@@ -135,6 +135,100 @@ TEST(CaptureCliTest, StopCaptureBesideAnAttributeIsRefused) {
   EXPECT_FALSE(parsed.error.isEmpty());
 }
 
+TEST(CaptureCliTest, MonitorNamesItsStreamsInOrder) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--monitor"), QStringLiteral("waveform,stats"),
+             QStringLiteral("--monitor-rate"), QStringLiteral("5")});
+
+  ASSERT_TRUE(parsed.ok()) << parsed.error.toStdString();
+  EXPECT_EQ(parsed.options.monitor_streams,
+            (std::vector<capture::MonitorFrameType>{
+                capture::MonitorFrameType::kWaveform,
+                capture::MonitorFrameType::kStats}));
+  EXPECT_EQ(parsed.options.monitor_rate_hz.value_or(0.0), 5.0);
+}
+
+TEST(CaptureCliTest, AStreamThereIsNotIsRefused) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--monitor"), QStringLiteral("stats,noise")});
+
+  EXPECT_FALSE(parsed.error.isEmpty());
+  EXPECT_TRUE(parsed.error.contains(QStringLiteral("noise")))
+      << parsed.error.toStdString();
+}
+
+// A monitor is a client, like --stop-capture, and has nothing to start.
+TEST(CaptureCliTest, MonitorBesideStartCaptureIsRefused) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--monitor"), QStringLiteral("stats"),
+             QStringLiteral("--start-capture")});
+
+  EXPECT_FALSE(parsed.error.isEmpty());
+}
+
+// The port reaches the monitor and nothing else, so a stop through it is an
+// instruction that could never be carried out.
+TEST(CaptureCliTest, StopCaptureBesideTheMonitorPortIsRefused) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--stop-capture"), QStringLiteral("--monitor-port"),
+             QStringLiteral("9400")});
+
+  EXPECT_FALSE(parsed.error.isEmpty());
+}
+
+TEST(CaptureCliTest, TheMetricsPortIsForAnInstance) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--start-capture"), QStringLiteral("--headless"),
+             QStringLiteral("--metrics-port"), QStringLiteral("9410")});
+
+  ASSERT_TRUE(parsed.ok()) << parsed.error.toStdString();
+  EXPECT_EQ(parsed.options.metrics_port.value_or(0), 9410);
+  EXPECT_FALSE(parsed.options.HasAttributeOverrides());
+}
+
+// A client has no capture of its own to serve figures for.
+TEST(CaptureCliTest, TheMetricsPortBesideAClientIsRefused) {
+  EXPECT_FALSE(Parse({QStringLiteral("--stop-capture"),
+                      QStringLiteral("--metrics-port"), QStringLiteral("9410")})
+                   .error.isEmpty());
+  EXPECT_FALSE(Parse({QStringLiteral("--monitor"), QStringLiteral("stats"),
+                      QStringLiteral("--metrics-port"), QStringLiteral("9410")})
+                   .error.isEmpty());
+  EXPECT_FALSE(Parse({QStringLiteral("--metrics-port"), QStringLiteral("0")})
+                   .error.isEmpty());
+}
+
+// --qualify measures for the folder, rate and format a capture would use, and
+// takes nothing else.
+TEST(CaptureCliTest, QualifyTakesWhatItMeasuresFor) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--qualify"), QStringLiteral("--sample-rate"),
+             QStringLiteral("20"), QStringLiteral("--output-format"),
+             QStringLiteral("flac")});
+
+  ASSERT_TRUE(parsed.ok()) << parsed.error.toStdString();
+  EXPECT_TRUE(parsed.options.qualify);
+  EXPECT_TRUE(parsed.options.decimation_factor.has_value());
+}
+
+TEST(CaptureCliTest, QualifyBesideACaptureOrAClientIsRefused) {
+  EXPECT_FALSE(Parse({QStringLiteral("--qualify"),
+                      QStringLiteral("--start-capture")})
+                   .error.isEmpty());
+  EXPECT_FALSE(
+      Parse({QStringLiteral("--qualify"), QStringLiteral("--stop-capture")})
+          .error.isEmpty());
+  EXPECT_FALSE(Parse({QStringLiteral("--qualify"), QStringLiteral("--monitor"),
+                      QStringLiteral("stats")})
+                   .error.isEmpty());
+  EXPECT_FALSE(Parse({QStringLiteral("--qualify"),
+                      QStringLiteral("--metrics-port"), QStringLiteral("9410")})
+                   .error.isEmpty());
+  EXPECT_FALSE(Parse({QStringLiteral("--qualify"),
+                      QStringLiteral("--capture-name"), QStringLiteral("disc")})
+                   .error.isEmpty());
+}
+
 // Attributes with no start command are not a mistake: they are "set this up for
 // me and I will press the button myself", and they populate the window.
 TEST(CaptureCliTest, AttributesWithNoStartCommandAreForTheWindow) {
@@ -167,6 +261,17 @@ TEST(CaptureCliTest, TheDiscRateIsNoDecimationAtAll) {
             std::optional<int>(capture::kUndecimatedFactor));
 }
 
+// The bottom of the cascade, which is two stages more than the tape rate and
+// nothing more to the command line.
+TEST(CaptureCliTest, TheLowestRateIsAnEighthOfTheDisc) {
+  const Parsed parsed =
+      Parse({QStringLiteral("--sample-rate"), QStringLiteral("5")});
+
+  ASSERT_TRUE(parsed.ok()) << parsed.error.toStdString();
+  EXPECT_EQ(parsed.options.decimation_factor,
+            std::optional<int>(capture::kEighthRateDecimationFactor));
+}
+
 // The message names the rates that would have worked. A script author reading
 // it in a log has no application in front of them to go and look at.
 TEST(CaptureCliTest, ARateTheDeviceCannotCaptureAtIsRefused) {
@@ -176,7 +281,7 @@ TEST(CaptureCliTest, ARateTheDeviceCannotCaptureAtIsRefused) {
   EXPECT_TRUE(parsed.accepted);
   EXPECT_TRUE(parsed.error.contains(QStringLiteral("40")))
       << parsed.error.toStdString();
-  EXPECT_TRUE(parsed.error.contains(QStringLiteral("20")))
+  EXPECT_TRUE(parsed.error.contains(QStringLiteral("20, 10 or 5")))
       << parsed.error.toStdString();
 }
 
@@ -368,12 +473,16 @@ TEST(CaptureCliTest, ACommandLineThatNamedNothingChangesNothing) {
 TEST(CaptureCliTest, TheScriptedModesNeedNoDisplay) {
   EXPECT_TRUE(WantsCore({"--headless", "--start-capture"}));
   EXPECT_TRUE(WantsCore({"--stop-capture"}));
+  EXPECT_TRUE(WantsCore({"--monitor", "stats"}));
+  EXPECT_TRUE(WantsCore({"--monitor=stats"}));
+  EXPECT_TRUE(WantsCore({"--qualify"}));
 }
 
 TEST(CaptureCliTest, TheWindowedModesDo) {
   EXPECT_FALSE(WantsCore({}));
   EXPECT_FALSE(WantsCore({"--start-capture"}));
   EXPECT_FALSE(WantsCore({"--capture-name", "disc-1"}));
+  EXPECT_FALSE(WantsCore({"--start-capture", "--monitor-port", "9400"}));
 }
 
 // Qt's parser takes a long name with one dash as well as two, so this has to
@@ -15,16 +15,20 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QHostAddress>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QString>
+#include <QStringList>
+#include <QTcpSocket>
 #include <QTextStream>
 #include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
@@ -33,10 +37,12 @@
 #include "capture_control_server.h"
 #include "capture_controller.h"
 #include "capture_format.h"
+#include "capture_monitor_client.h"
 #include "capture_stop_client.h"
 #include "disk_buffer_ring.h"
 #include "fake_usb_device.h"
 #include "logger.h"
+#include "monitor_protocol.h"
 #include "synthetic_source.h"
 
 namespace ddd::gui {
@@ -110,6 +116,48 @@ TEST(CaptureControlProtocolTest, SomethingThatIsNotAMessageIsNotOne) {
   EXPECT_FALSE(ParseControlReply(QByteArrayLiteral("nonsense")).has_value());
 }
 
+TEST(CaptureControlProtocolTest, ASubscriptionSurvivesTheRoundTrip) {
+  MonitorSubscription subscription;
+  subscription.stream = capture::MonitorFrameType::kSpectrum;
+  subscription.rate_hz = 4.5;
+  subscription.size = 256;
+
+  const std::optional<MonitorSubscription> parsed = ParseMonitorSubscription(
+      FormatMonitorSubscribe(subscription).toUtf8());
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->stream, capture::MonitorFrameType::kSpectrum);
+  EXPECT_DOUBLE_EQ(parsed->rate_hz, 4.5);
+  EXPECT_EQ(parsed->size, 256U);
+}
+
+TEST(CaptureControlProtocolTest, UnsubscribingIsARateOfZero) {
+  const std::optional<MonitorSubscription> parsed =
+      ParseMonitorSubscription(QByteArrayLiteral(
+          "{\"verb\":\"unsubscribe\",\"stream\":\"waveform\"}"));
+  ASSERT_TRUE(parsed.has_value());
+  EXPECT_EQ(parsed->stream, capture::MonitorFrameType::kWaveform);
+  EXPECT_EQ(parsed->rate_hz, 0.0);
+}
+
+TEST(CaptureControlProtocolTest, ASubscriptionOutOfRangeIsRefused) {
+  EXPECT_FALSE(ParseMonitorSubscription(
+                   QByteArrayLiteral("{\"verb\":\"subscribe\",\"stream\":"
+                                     "\"noise\",\"rate_hz\":1}"))
+                   .has_value());
+  EXPECT_FALSE(ParseMonitorSubscription(
+                   QByteArrayLiteral("{\"verb\":\"subscribe\",\"stream\":"
+                                     "\"stats\",\"rate_hz\":1000}"))
+                   .has_value());
+  EXPECT_FALSE(ParseMonitorSubscription(
+                   QByteArrayLiteral("{\"verb\":\"subscribe\",\"stream\":"
+                                     "\"spectrum\",\"rate_hz\":1,"
+                                     "\"bins\":100000}"))
+                   .has_value());
+  EXPECT_FALSE(ParseMonitorSubscription(
+                   QByteArrayLiteral("{\"verb\":\"stop\"}"))
+                   .has_value());
+}
+
 // --- The socket -----------------------------------------------------------
 
 constexpr size_t kTestSlotBytes = size_t{256} << 10;
@@ -255,6 +303,27 @@ class CaptureControlServerTest : public ::testing::Test {
     return buffer;
   }
 
+  Run Monitor(const std::vector<capture::MonitorFrameType>& streams,
+              int frame_limit, quint16 port = 0) {
+    Run run;
+    QTextStream out(&run.out);
+    QTextStream error(&run.error);
+
+    MonitorClientOptions options;
+    options.server_name = name_;
+    options.port = port;
+    options.subscriptions =
+        MonitorClientSubscriptions(streams, capture::kMaximumMonitorRateHz);
+    options.connect_timeout_milliseconds = 2000;
+    options.duration_milliseconds = 10000;
+    options.frame_limit = frame_limit;
+
+    run.code = RunMonitor(out, error, options);
+    out.flush();
+    error.flush();
+    return run;
+  }
+
   std::vector<std::filesystem::path> WrittenFiles() const {
     std::vector<std::filesystem::path> files;
     for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
@@ -509,6 +578,33 @@ TEST_F(CaptureControlServerTest, SomethingThatIsNotARequestIsAnsweredToo) {
   EXPECT_FALSE(reply.error.isEmpty());
 }
 
+// A line that never ends is refused, once, however much more of it is still
+// arriving as the connection closes.
+TEST_F(CaptureControlServerTest, AnOversizedRequestIsAnsweredOnce) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+
+  QLocalSocket socket;
+  socket.connectToServer(name_);
+  ASSERT_TRUE(PumpUntil(
+      [&socket] { return socket.state() == QLocalSocket::ConnectedState; }));
+
+  const QByteArray padding(16 << 10, 'x');
+  socket.write(padding);
+  socket.flush();
+
+  QByteArray buffer;
+  ASSERT_TRUE(PumpUntil([&socket, &buffer] {
+    buffer.append(socket.readAll());
+    return socket.state() == QLocalSocket::UnconnectedState;
+  }));
+  buffer.append(socket.readAll());
+
+  EXPECT_EQ(buffer.count('\n'), 1) << buffer.toStdString();
+  EXPECT_FALSE(ParseControlReply(buffer.left(buffer.indexOf('\n')))
+                   .value_or(ControlReply{.ok = true})
+                   .ok);
+}
+
 // A request is one short line and almost always arrives in one piece. Almost
 // always is not something a protocol may be written against.
 TEST_F(CaptureControlServerTest,
@@ -592,5 +688,120 @@ TEST_F(CaptureControlServerTest, AnApplicationThatQuitsAfterAnsweringIsFine) {
       << run.error.toStdString();
 }
 
+// --- Monitoring -----------------------------------------------------------
+
+TEST_F(CaptureControlServerTest, AMonitorIsSentTheStreamsItSubscribedTo) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+  controller_->StartCapture();
+
+  const Run run = Monitor({capture::MonitorFrameType::kStats,
+                           capture::MonitorFrameType::kWaveform},
+                          6);
+
+  EXPECT_EQ(run.code, kExitSuccess) << run.error.toStdString();
+  const QStringList lines = run.out.split(QLatin1Char('\n'),
+                                          Qt::SkipEmptyParts);
+  EXPECT_EQ(lines.size(), 6);
+  EXPECT_TRUE(run.out.contains(QStringLiteral("stats elapsed=")))
+      << run.out.toStdString();
+  EXPECT_TRUE(run.out.contains(QStringLiteral("waveform span=")))
+      << run.out.toStdString();
+  EXPECT_FALSE(run.out.contains(QStringLiteral("spectrum")));
+
+  // Watching took nothing from the capture it watched
+  EXPECT_TRUE(controller_->capturing());
+}
+
+TEST_F(CaptureControlServerTest, WithNothingRunningThereIsNothingToMonitor) {
+  const Run run = Monitor({capture::MonitorFrameType::kStats}, 1);
+
+  EXPECT_EQ(run.code, kExitNoRunningInstance);
+  EXPECT_TRUE(run.out.isEmpty()) << run.out.toStdString();
+}
+
+// Subscribing is only meaningful once a connection has switched to frames;
+// before that it is a line a stop client might have sent by mistake.
+TEST_F(CaptureControlServerTest, SubscribingBeforeMonitoringIsRefused) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+
+  const ControlReply reply =
+      ParseControlReply(Exchange(QByteArrayLiteral(
+                            "{\"verb\":\"subscribe\",\"stream\":\"stats\","
+                            "\"rate_hz\":1}\n")))
+          .value_or(ControlReply{});
+
+  EXPECT_FALSE(reply.ok);
+  EXPECT_TRUE(reply.error.contains(QStringLiteral("monitor")))
+      << reply.error.toStdString();
+}
+
+TEST_F(CaptureControlServerTest, TheMonitorPortMonitors) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+  QString error;
+  ASSERT_TRUE(server_->ListenForMonitors(0, &error)) << error.toStdString();
+  ASSERT_NE(server_->monitor_port(), 0);
+  controller_->StartCapture();
+
+  const Run run = Monitor({capture::MonitorFrameType::kStats}, 2,
+                          server_->monitor_port());
+
+  EXPECT_EQ(run.code, kExitSuccess) << run.error.toStdString();
+  EXPECT_TRUE(run.out.startsWith(QStringLiteral("stats ")))
+      << run.out.toStdString();
+}
+
+// Anything on this machine can reach a TCP port, where only this user can
+// reach the socket. What comes in that way may watch and may not stop.
+TEST_F(CaptureControlServerTest, TheMonitorPortCannotStopTheCapture) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+  QString error;
+  ASSERT_TRUE(server_->ListenForMonitors(0, &error)) << error.toStdString();
+  controller_->StartCapture();
+  ASSERT_TRUE(PumpUntil([this] { return controller_->capturing(); }));
+
+  QTcpSocket socket;
+  socket.connectToHost(QHostAddress::LocalHost, server_->monitor_port());
+  ASSERT_TRUE(PumpUntil([&socket] {
+    return socket.state() == QAbstractSocket::ConnectedState;
+  }));
+  socket.write(FormatControlRequest(QLatin1String(kStopVerb)).toUtf8());
+
+  QByteArray buffer;
+  ASSERT_TRUE(PumpUntil([&socket, &buffer] {
+    buffer.append(socket.readAll());
+    return buffer.contains('\n');
+  }));
+
+  const ControlReply reply = ParseControlReply(buffer).value_or(ControlReply{});
+  EXPECT_FALSE(reply.ok);
+  EXPECT_TRUE(controller_->capturing());
+}
+
+// A monitor that connects, subscribes and never reads again. The application
+// must go on exactly as before, holding no more than the client's outbox.
+TEST_F(CaptureControlServerTest,
+       AMonitorThatStopsReadingCostsTheCaptureNothing) {
+  ASSERT_NO_FATAL_FAILURE(Listen());
+  controller_->StartCapture();
+
+  QLocalSocket socket;
+  socket.connectToServer(name_);
+  ASSERT_TRUE(PumpUntil(
+      [&socket] { return socket.state() == QLocalSocket::ConnectedState; }));
+  socket.setReadBufferSize(1);
+  socket.write(FormatControlRequest(QLatin1String(kMonitorVerb)).toUtf8());
+  MonitorSubscription subscription;
+  subscription.stream = capture::MonitorFrameType::kWaveform;
+  subscription.rate_hz = capture::kMaximumMonitorRateHz;
+  subscription.size = capture::kMaximumMonitorPoints;
+  socket.write(FormatMonitorSubscribe(subscription).toUtf8());
+  socket.flush();
+
+  ASSERT_TRUE(PumpUntil([this] { return server_->monitor_count() == 1; }));
+  PumpFor(1500ms);
+
+  EXPECT_TRUE(controller_->capturing());
+}
+
 }  // namespace
 }  // namespace ddd::gui
@@ -402,6 +402,81 @@ TEST_F(CaptureControllerTest, TheFullRateIsAskedForExplicitly) {
   ASSERT_TRUE(PumpUntil([&] { return !controller_->monitoring(); }));
 }
 
+// Packing is asked for and then read back, and the register is what is
+// believed. This device has no register bank to read back from, so it is
+// streaming words whatever it was sent — and unpacking those as blocks would
+// fail a capture the device was delivering perfectly well.
+TEST_F(CaptureControllerTest, PackingTheDeviceDoesNotConfirmFallsBackToWords) {
+  UseSmallQueue();
+
+  CaptureSettings settings = controller_->settings();
+  settings.packed_wire = true;
+  controller_->SetSettings(settings);
+
+  QSignalSpy stats(controller_.get(), &CaptureController::StatsUpdated);
+  controller_->StartMonitoring();
+  ASSERT_TRUE(controller_->monitoring());
+
+  EXPECT_EQ(device_->written_to(capture::kRegisterWireFormat),
+            std::optional<uint8_t>(capture::kWireFormatPacked));
+
+  ASSERT_TRUE(PumpUntil([&] {
+    return stats.count() > 0 &&
+           qvariant_cast<ddd::capture::CaptureStats>(stats.back().at(0))
+                   .buffers_processed > 2;
+  }));
+  EXPECT_TRUE(controller_->monitoring());
+
+  controller_->StopMonitoring();
+  ASSERT_TRUE(PumpUntil([&] { return !controller_->monitoring(); }));
+}
+
+// Gateware that predates a factor normalises it to every sample rather than
+// refusing it, so the register is read back: the fake's bank reads 0x00 at the
+// decimation address, as an image without the cascade would read 0x01, and
+// streaming would write full-rate samples into a file labelled 5 Msps.
+TEST_F(CaptureControllerTest, ARateTheGatewareDoesNotConfirmIsNotStreamed) {
+  UseSmallQueue();
+  device_->SetGatewareCommit("0123abcd");
+
+  CaptureSettings settings = controller_->settings();
+  settings.decimation_factor = capture::kEighthRateDecimationFactor;
+  controller_->SetSettings(settings);
+
+  QSignalSpy failures(controller_.get(), &CaptureController::Failed);
+  controller_->StartMonitoring();
+
+  EXPECT_EQ(device_->written_to(capture::kRegisterDecimation),
+            std::optional<uint8_t>(capture::kDecimationEighthRate));
+  EXPECT_FALSE(controller_->monitoring());
+  EXPECT_EQ(failures.count(), 1);
+  EXPECT_EQ(device_->open_count(), 0U);
+}
+
+// The fake device's stream has no in-band blocks and it never confirms the
+// register, which is gateware that predates them: asked, refused, put back off,
+// and the capture runs regardless.
+TEST_F(CaptureControllerTest, InbandTelemetryTheDeviceDoesNotConfirmIsLeftOff) {
+  UseSmallQueue();
+
+  QSignalSpy stats(controller_.get(), &CaptureController::StatsUpdated);
+  controller_->StartMonitoring();
+  ASSERT_TRUE(controller_->monitoring());
+
+  EXPECT_EQ(device_->written_to(capture::kRegisterInbandTelemetry),
+            std::optional<uint8_t>(capture::kInbandTelemetryOff));
+
+  ASSERT_TRUE(PumpUntil([&] {
+    return stats.count() > 0 &&
+           qvariant_cast<ddd::capture::CaptureStats>(stats.back().at(0))
+                   .buffers_processed > 2;
+  }));
+  EXPECT_TRUE(controller_->monitoring());
+
+  controller_->StopMonitoring();
+  ASSERT_TRUE(PumpUntil([&] { return !controller_->monitoring(); }));
+}
+
 TEST_F(CaptureControllerTest, TheTransferSettingsReachTheBackend) {
   UseSmallQueue();
 
@@ -48,6 +48,7 @@ TEST_F(CaptureSettingsTest, AFirstRunGetsTheDefaults) {
   EXPECT_EQ(settings.queue_size_bytes,
             capture::DiskBufferRing::kDefaultQueueSizeBytes);
   EXPECT_TRUE(settings.small_transfers);
+  EXPECT_FALSE(settings.packed_wire);
   EXPECT_TRUE(settings.preferred_device_path.isEmpty());
 }
 
@@ -56,6 +57,7 @@ TEST_F(CaptureSettingsTest, WhatWasSavedIsWhatComesBack) {
   saved.preferred_device_path = QStringLiteral("/sys/bus/usb/devices/3-2");
   saved.queue_size_bytes = size_t{128} << 20;
   saved.small_transfers = false;
+  saved.packed_wire = true;
   saved.transfer_queue_bytes = size_t{8} << 20;
   SaveCaptureSettings(saved);
 
@@ -63,6 +65,7 @@ TEST_F(CaptureSettingsTest, WhatWasSavedIsWhatComesBack) {
   EXPECT_EQ(loaded.preferred_device_path, saved.preferred_device_path);
   EXPECT_EQ(loaded.queue_size_bytes, saved.queue_size_bytes);
   EXPECT_EQ(loaded.small_transfers, saved.small_transfers);
+  EXPECT_EQ(loaded.packed_wire, saved.packed_wire);
   EXPECT_EQ(loaded.transfer_queue_bytes, saved.transfer_queue_bytes);
 }
 
@@ -211,6 +214,41 @@ TEST_F(CaptureSettingsTest, ANonsensicalCompressionLevelIsClamped) {
   EXPECT_EQ(LoadCaptureSettings().compression_level, 0);
 }
 
+// Automatic until --qualify says otherwise, and never more than the writer
+// would start.
+TEST_F(CaptureSettingsTest, EncoderThreadsAreAutomaticUntilSetAndThenKept) {
+  EXPECT_EQ(LoadCaptureSettings().encoder_threads, 0U);
+
+  CaptureSettings saved;
+  saved.encoder_threads = 2;
+  SaveCaptureSettings(saved);
+  EXPECT_EQ(LoadCaptureSettings().encoder_threads, 2U);
+
+  QSettings store;
+  store.setValue(QStringLiteral("capture/encoder_threads"), 99);
+  EXPECT_EQ(LoadCaptureSettings().encoder_threads,
+            capture::FlacWriter::kMaximumEncoderThreads);
+}
+
+// Zero would be a buffer in none, which is not a setting; one is every buffer.
+TEST_F(CaptureSettingsTest, TheMonitorValidationIntervalIsKeptInRange) {
+  EXPECT_EQ(LoadCaptureSettings().monitor_validation_interval,
+            CaptureSettings::kDefaultMonitorValidationInterval);
+
+  CaptureSettings saved;
+  saved.monitor_validation_interval = 1;
+  SaveCaptureSettings(saved);
+  EXPECT_EQ(LoadCaptureSettings().monitor_validation_interval, 1U);
+
+  QSettings store;
+  store.setValue(QStringLiteral("capture/monitor_validation_interval"), 0);
+  EXPECT_EQ(LoadCaptureSettings().monitor_validation_interval, 1U);
+  store.setValue(QStringLiteral("capture/monitor_validation_interval"),
+                 100'000);
+  EXPECT_EQ(LoadCaptureSettings().monitor_validation_interval,
+            CaptureSettings::kMaximumMonitorValidationInterval);
+}
+
 TEST_F(CaptureSettingsTest, ANonsensicalDurationLimitIsClamped) {
   QSettings store;
   store.setValue(QStringLiteral("capture/duration_limit_seconds"), -60);
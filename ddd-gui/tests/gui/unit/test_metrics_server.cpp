@@ -0,0 +1,220 @@
+/************************************************************************
+
+    test_metrics_server.cpp
+
+    T1 tests for the metrics page, fetched as a scraper fetches it
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QSettings>
+#include <QString>
+#include <QTcpSocket>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "capture_controller.h"
+#include "disk_buffer_ring.h"
+#include "fake_usb_device.h"
+#include "logger.h"
+#include "metrics_server.h"
+#include "synthetic_source.h"
+
+namespace ddd::gui {
+namespace {
+
+using namespace std::chrono_literals;
+
+template <typename Predicate>
+bool PumpUntil(Predicate predicate, std::chrono::milliseconds limit = 5000ms) {
+  const auto deadline = std::chrono::steady_clock::now() + limit;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (predicate()) {
+      return true;
+    }
+    QCoreApplication::processEvents();
+    QCoreApplication::sendPostedEvents();
+    std::this_thread::sleep_for(1ms);
+  }
+  return predicate();
+}
+
+class MetricsServerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const ::testing::TestInfo* const info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+
+    QCoreApplication::setOrganizationName(QStringLiteral("Domesday86Test"));
+    QCoreApplication::setApplicationName(
+        QStringLiteral("ddd-gui-metrics-%1").arg(QLatin1String(info->name())));
+    QSettings().clear();
+
+    directory_ = std::filesystem::temp_directory_path() /
+                 (std::string("ddd-metrics-test-") + info->name());
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directories(directory_);
+
+    capture::SyntheticSource::Options source;
+    source.slot_size_bytes = size_t{256} << 10;
+    source.slot_count = 6;
+    device_ = std::make_unique<capture::FakeUsbDevice>();
+    device_->SetSourceOptions(source);
+    device_->SetSingleDevice("bus-1", capture::DeviceSpeed::kSuper,
+                             "Domesday Duplicator (a1b2c3d4)");
+
+    controller_ = std::make_unique<CaptureController>(device_.get(), &logger_);
+    CaptureSettings settings = controller_->settings();
+    settings.queue_size_bytes = capture::DiskBufferRing::kMinimumQueueSizeBytes;
+    settings.preferred_device_path = QStringLiteral("bus-1");
+    settings.capture_directory = QString::fromStdString(directory_.string());
+    controller_->ApplySessionSettings(settings);
+
+    server_ = std::make_unique<MetricsServer>(controller_.get(), &logger_);
+    QString error;
+    ASSERT_TRUE(server_->Listen(0, &error)) << error.toStdString();
+    ASSERT_NE(server_->port(), 0);
+  }
+
+  void TearDown() override {
+    // The server borrows the controller, so it goes first.
+    server_.reset();
+    controller_.reset();
+    device_.reset();
+    std::filesystem::remove_all(directory_);
+    QSettings().clear();
+  }
+
+  // One request, over loopback, read until the server closes the connection —
+  // which is how it says the answer is complete.
+  QByteArray Fetch(const QByteArray& request) {
+    QTcpSocket socket;
+    socket.connectToHost(QHostAddress::LocalHost, server_->port());
+    if (!PumpUntil([&socket] {
+          return socket.state() == QAbstractSocket::ConnectedState;
+        })) {
+      return QByteArray();
+    }
+    socket.write(request);
+
+    QByteArray response;
+    PumpUntil([&socket, &response] {
+      response.append(socket.readAll());
+      return socket.state() == QAbstractSocket::UnconnectedState;
+    });
+    response.append(socket.readAll());
+    return response;
+  }
+
+  QByteArray Get(const char* path) {
+    return Fetch(QByteArray("GET ") + path +
+                 " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  }
+
+  static QByteArray StatusLine(const QByteArray& response) {
+    return response.left(response.indexOf("\r\n"));
+  }
+
+  static QByteArray Body(const QByteArray& response) {
+    return response.mid(response.indexOf("\r\n\r\n") + 4);
+  }
+
+  capture::CallbackLogger logger_{
+      [](capture::LogLevel /*level*/, const std::string& /*message*/) {},
+      capture::LogLevel::kDebug};
+  std::filesystem::path directory_;
+  std::unique_ptr<capture::FakeUsbDevice> device_;
+  std::unique_ptr<CaptureController> controller_;
+  std::unique_ptr<MetricsServer> server_;
+};
+
+TEST_F(MetricsServerTest, TheMetricsPageIsServed) {
+  const QByteArray response = Get("/metrics");
+
+  EXPECT_EQ(StatusLine(response), "HTTP/1.1 200 OK");
+  EXPECT_TRUE(response.contains("Content-Type: text/plain; version=0.0.4"));
+  EXPECT_TRUE(Body(response).contains("# TYPE ddd_capture_running gauge"));
+  EXPECT_TRUE(Body(response).contains("ddd_capture_running 0\n"));
+}
+
+// The page is read through the stats publisher, so a running capture's
+// figures are on it without the pipeline knowing anyone asked.
+TEST_F(MetricsServerTest, ARunningCaptureIsOnThePage) {
+  controller_->StartMonitoring();
+  ASSERT_TRUE(PumpUntil([this] {
+    return controller_->monitoring() &&
+           controller_->stats_publisher().Read().buffers_processed > 0;
+  }));
+
+  const QByteArray body = Body(Get("/metrics"));
+
+  EXPECT_TRUE(body.contains("ddd_capture_running 1\n")) << body.toStdString();
+  EXPECT_FALSE(body.contains("ddd_capture_buffers_processed_total 0\n"));
+  EXPECT_TRUE(body.contains("ddd_stage_latency_seconds{stage=\"ring\"}"));
+
+  // Fed by the stats timer, not by the scrape.
+  EXPECT_TRUE(PumpUntil([this] {
+    return !Body(Get("/metrics")).contains("ddd_ring_depth_percent_count 0\n");
+  }));
+}
+
+TEST_F(MetricsServerTest, HeadIsAnsweredWithoutTheBody) {
+  const QByteArray response =
+      Fetch("HEAD /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+  EXPECT_EQ(StatusLine(response), "HTTP/1.1 200 OK");
+  EXPECT_TRUE(Body(response).isEmpty());
+}
+
+TEST_F(MetricsServerTest, AQueryStringIsIgnored) {
+  EXPECT_EQ(StatusLine(Get("/metrics?format=text")), "HTTP/1.1 200 OK");
+}
+
+TEST_F(MetricsServerTest, AnythingElseIsNotFound) {
+  EXPECT_EQ(StatusLine(Get("/")), "HTTP/1.1 404 Not Found");
+  EXPECT_EQ(StatusLine(Get("/metrics/extra")), "HTTP/1.1 404 Not Found");
+}
+
+TEST_F(MetricsServerTest, OnlyReadingIsAllowed) {
+  const QByteArray response =
+      Fetch("POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+
+  EXPECT_EQ(StatusLine(response), "HTTP/1.1 405 Method Not Allowed");
+  EXPECT_TRUE(response.contains("Allow: GET, HEAD"));
+}
+
+TEST_F(MetricsServerTest, SomethingThatIsNotHttpIsRefused) {
+  EXPECT_EQ(StatusLine(Fetch("hello\n\n")), "HTTP/1.1 400 Bad Request");
+}
+
+// Whatever a client goes on sending while the close goes through is neither
+// kept nor answered: one request, one status line.
+TEST_F(MetricsServerTest, AnOversizedRequestIsAnsweredOnce) {
+  const QByteArray padding(16 << 10, 'x');
+  const QByteArray response =
+      Fetch("GET /metrics HTTP/1.1\r\nX-Padding: " + padding);
+  EXPECT_EQ(StatusLine(response),
+            "HTTP/1.1 431 Request Header Fields Too Large");
+  EXPECT_EQ(response.count("HTTP/1.1 "), 1);
+}
+
+TEST_F(MetricsServerTest, WhatFollowsARequestIsIgnored) {
+  const QByteArray trailing(16 << 10, 'x');
+  const QByteArray response =
+      Fetch("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n" + trailing);
+  EXPECT_EQ(StatusLine(response), "HTTP/1.1 200 OK");
+  EXPECT_EQ(response.count("HTTP/1.1 "), 1);
+}
+
+}  // namespace
+}  // namespace ddd::gui
@@ -704,7 +704,7 @@ TEST(PlayerTextTest, EveryProvenanceReadsDifferently) {
   const player::Provenance sources[] = {
       player::Provenance::kUnknown,  player::Provenance::kReported,
       player::Provenance::kMeasured, player::Provenance::kInferred,
-      player::Provenance::kDeclared,
+      player::Provenance::kDeclared, player::Provenance::kCached,
   };
 
   QSet<QString> seen;
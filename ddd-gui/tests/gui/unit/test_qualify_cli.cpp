@@ -0,0 +1,136 @@
+/************************************************************************
+
+    test_qualify_cli.cpp
+
+    T1 tests for --qualify: what it reports, saves and exits with
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QString>
+#include <QTextStream>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "capture_cli.h"
+#include "capture_format.h"
+#include "capture_settings.h"
+#include "disk_buffer_ring.h"
+#include "qualify_cli.h"
+
+namespace ddd::gui {
+namespace {
+
+class QualifyCliTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const ::testing::TestInfo* const info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+
+    QCoreApplication::setOrganizationName(QStringLiteral("Domesday86Test"));
+    QCoreApplication::setApplicationName(
+        QStringLiteral("ddd-gui-qualify-%1").arg(QLatin1String(info->name())));
+    QSettings().clear();
+
+    directory_ = std::filesystem::temp_directory_path() /
+                 (std::string("ddd-qualify-cli-") + info->name());
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directories(directory_);
+
+    cli_.capture_directory = QString::fromStdString(directory_.string());
+
+    // Small enough to be quick, and nowhere near enough to say anything about
+    // the machine: what is tested is what is done with the figures.
+    options_.write.duration_seconds = 0.2;
+    options_.write.maximum_bytes = uint64_t{4} << 20;
+    options_.write.block_bytes = size_t{256} << 10;
+    options_.signal_seconds = 0.005;
+    options_.encode_directory = QString::fromStdString(directory_.string());
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(directory_);
+    QSettings().clear();
+  }
+
+  int Run() {
+    QTextStream out(&out_text_);
+    QTextStream error(&error_text_);
+    return RunHostQualification(cli_, out, error, options_);
+  }
+
+  std::filesystem::path directory_;
+  CaptureCliOptions cli_;
+  QualifyOptions options_;
+  QString out_text_;
+  QString error_text_;
+};
+
+// Margins no machine can miss, so the verdict is decided before it is run.
+TEST_F(QualifyCliTest, AQualifiedHostHasItsSettingsSaved) {
+  options_.margins.throughput = 1e-9;
+  options_.margins.stall = 1e-9;
+
+  ASSERT_EQ(Run(), kExitSuccess) << error_text_.toStdString();
+
+  // Level 8 on one thread is the first configuration tried, and the first that
+  // passes is the one kept.
+  const CaptureSettings saved = LoadCaptureSettings();
+  EXPECT_EQ(saved.compression_level, 8);
+  EXPECT_EQ(saved.encoder_threads, 1U);
+  EXPECT_EQ(saved.queue_size_bytes,
+            capture::DiskBufferRing::kMinimumQueueSizeBytes);
+  EXPECT_TRUE(out_text_.contains(QStringLiteral("Stall tolerance")));
+  EXPECT_TRUE(out_text_.contains(QStringLiteral("best case")));
+  EXPECT_TRUE(out_text_.contains(QStringLiteral("Saved.")));
+}
+
+// Settings known not to keep up are no better than the ones there were.
+TEST_F(QualifyCliTest, AHostThatFallsShortHasNothingSaved) {
+  options_.margins.throughput = 1e9;
+
+  EXPECT_EQ(Run(), kExitHostNotQualified);
+
+  const CaptureSettings saved = LoadCaptureSettings();
+  EXPECT_EQ(saved.queue_size_bytes, CaptureSettings{}.queue_size_bytes);
+  EXPECT_EQ(saved.compression_level, CaptureSettings{}.compression_level);
+  EXPECT_EQ(saved.encoder_threads, CaptureSettings{}.encoder_threads);
+  EXPECT_TRUE(error_text_.contains(QStringLiteral("Not qualified")));
+}
+
+// The folder is what was measured, and is this run's, not the user's.
+TEST_F(QualifyCliTest, TheFolderMeasuredIsNotSaved) {
+  options_.margins.throughput = 1e-9;
+  options_.margins.stall = 1e-9;
+  cli_.output_format = capture::CaptureOutputFormat::kSigned16Bit;
+
+  ASSERT_EQ(Run(), kExitSuccess) << error_text_.toStdString();
+
+  const CaptureSettings saved = LoadCaptureSettings();
+  EXPECT_TRUE(saved.capture_directory.isEmpty());
+  EXPECT_EQ(saved.output_format, CaptureSettings{}.output_format);
+
+  // Nothing encodes an uncompressed capture, so nothing about the encoder is
+  // measured or changed.
+  EXPECT_FALSE(out_text_.contains(QStringLiteral("FLAC level")));
+  EXPECT_EQ(saved.encoder_threads, CaptureSettings{}.encoder_threads);
+}
+
+TEST_F(QualifyCliTest, AFolderThatCannotBeWrittenIsNotQualified) {
+  const std::filesystem::path file = directory_ / "not-a-folder";
+  { std::ofstream(file) << "x"; }
+  cli_.capture_directory = QString::fromStdString(file.string());
+
+  EXPECT_EQ(Run(), kExitHostNotQualified);
+  EXPECT_TRUE(error_text_.startsWith(QStringLiteral("Error:")));
+}
+
+}  // namespace
+}  // namespace ddd::gui
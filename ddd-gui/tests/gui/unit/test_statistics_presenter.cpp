@@ -356,6 +356,7 @@ TEST(StatisticsPresenterTest, IdleShowsNothingMeasuredAndWhatIsStillKnown) {
   EXPECT_EQ(view.throughput, None());
   EXPECT_EQ(view.signal_level, None());
   EXPECT_EQ(view.samples, None());
+  EXPECT_EQ(view.dropouts, None());
   EXPECT_EQ(view.buffer_percent, 0);
 
   // The link speed and the declared gain are facts about the setup, not
@@ -442,6 +443,44 @@ TEST(StatisticsPresenterTest,
 
 // A time first, because "412 GB free" does not answer the question a user has,
 // which is whether this will last the side they are about to play.
+TEST(StatisticsPresenterTest, DropoutsAreCountedAndGivenAsLengthsOfSignal) {
+  capture::DropoutSummary dropouts;
+  dropouts.armed = true;
+  dropouts.event_count = 14;
+  dropouts.dropout_samples = 24'000;  // 0.6 ms at full rate
+  dropouts.longest_samples = 3'400;   // 85 µs
+  dropouts.capture_event_count = 5;
+
+  EXPECT_EQ(FormatDropouts(dropouts, false),
+            QString::fromUtf8("14, 0.6 ms in all, longest 85 µs"));
+
+  // The file's own count only while there is a file
+  EXPECT_TRUE(FormatDropouts(dropouts, true)
+                  .endsWith(QStringLiteral("(5 in this file)")));
+}
+
+TEST(StatisticsPresenterTest, NoDropoutsFromADetectorWithNothingToWatchSaysSo) {
+  // Zero with no signal in front of the detector is not a clean disc
+  capture::DropoutSummary dropouts;
+  EXPECT_TRUE(FormatDropouts(dropouts, false)
+                  .startsWith(QStringLiteral("Not watching")));
+
+  dropouts.armed = true;
+  EXPECT_EQ(FormatDropouts(dropouts, false), QStringLiteral("None"));
+}
+
+TEST(StatisticsPresenterTest, DropoutLengthsAreMeasuredAtTheStreamsRate) {
+  capture::DropoutSummary dropouts;
+  dropouts.armed = true;
+  dropouts.event_count = 1;
+  dropouts.dropout_samples = 850;
+  dropouts.longest_samples = 850;
+
+  // 85 µs at a quarter rate, not 21
+  EXPECT_TRUE(FormatDropouts(dropouts, false, 10'000'000)
+                  .contains(QString::fromUtf8("longest 85 µs")));
+}
+
 TEST(StatisticsPresenterTest, FreeSpaceIsHowMuchCaptureItHolds) {
   capture::FreeSpace space;
   space.known = true;
@@ -57,7 +57,8 @@ const QStringList& ExpectedDockNames() {
   static const QStringList names{
       QStringLiteral("capture_dock"),   QStringLiteral("statistics_dock"),
       QStringLiteral("waveform_dock"),  QStringLiteral("spectrum_dock"),
-      QStringLiteral("amplitude_dock"), QStringLiteral("log_dock")};
+      QStringLiteral("amplitude_dock"), QStringLiteral("video_dock"),
+      QStringLiteral("log_dock")};
   return names;
 }
 
@@ -281,6 +282,16 @@ TEST_F(MainWindowTest, TheLogPanelStartsHidden) {
   EXPECT_TRUE(log->isHidden());
 }
 
+TEST_F(MainWindowTest, TheVideoPreviewStartsHidden) {
+  // It costs a share of a core whenever it can be seen
+  const std::unique_ptr<MainWindow> window = MakeWindow();
+  window->show();
+
+  QDockWidget* video = DockNamed(*window, QStringLiteral("video_dock"));
+  ASSERT_NE(video, nullptr);
+  EXPECT_TRUE(video->isHidden());
+}
+
 TEST_F(MainWindowTest, DebugRunsRevealTheLogPanel) {
   const std::unique_ptr<MainWindow> window = MakeWindow();
   window->show();
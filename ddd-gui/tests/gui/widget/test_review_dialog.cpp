@@ -0,0 +1,206 @@
+/************************************************************************
+
+    test_review_dialog.cpp
+
+    T1 tests for the capture review dialog
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QApplication>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_overview.h"
+#include "log_format.h"
+#include "review_dialog.h"
+#include "sample_format.h"
+
+namespace ddd::gui {
+namespace {
+
+using namespace std::chrono_literals;
+
+template <typename Predicate>
+bool PumpUntil(Predicate predicate, std::chrono::milliseconds limit = 10000ms) {
+  const auto deadline = std::chrono::steady_clock::now() + limit;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (predicate()) {
+      return true;
+    }
+    QApplication::processEvents();
+    std::this_thread::sleep_for(1ms);
+  }
+  return predicate();
+}
+
+class ReviewDialogTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const ::testing::TestInfo* const info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+    directory_ = std::filesystem::temp_directory_path() /
+                 (std::string("ddd-review-dialog-") + info->name());
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directories(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  std::filesystem::path CapturePath() const {
+    return directory_ / "capture.ddd.s16";
+  }
+
+  // A short capture at mid-scale, as the .s16 this application writes, with
+  // no overview beside it.
+  QString CaptureWithoutOverview(size_t samples) {
+    std::ofstream file(CapturePath(), std::ios::binary);
+    const auto mid = static_cast<uint16_t>(capture::ToSigned16Bit(
+        static_cast<int32_t>(capture::kSampleZeroOffset)));
+    for (size_t index = 0; index < samples; ++index) {
+      file.put(static_cast<char>(mid & 0xFF));
+      file.put(static_cast<char>((mid >> 8) & 0xFF));
+    }
+    return QString::fromStdString(CapturePath().string());
+  }
+
+  // An overview of a long capture that was never written: thousands of
+  // blocks cost a few hundred kilobytes of overview where the samples would
+  // cost gigabytes, and the dialog never needs the capture itself.
+  QString OverviewOnly(size_t blocks, uint32_t sample_rate_hz = 0) {
+    capture::CaptureOverviewBuilder builder;
+    builder.SetSampleRate(sample_rate_hz);
+    for (size_t index = 0; index < blocks; ++index) {
+      capture::OverviewBlock block;
+      block.first_sample = index * capture::kOverviewBlockSamples;
+      block.sample_count = capture::kOverviewBlockSamples;
+      block.minimum_value = 400;
+      block.maximum_value = 600;
+      block.sum_of_squares = block.sample_count * 50 * 50;
+      builder.Append(block);
+    }
+    std::string error;
+    EXPECT_TRUE(capture::WriteCaptureOverviewFile(
+        capture::CaptureOverviewPath(CapturePath()), builder.Finish(), error))
+        << error;
+    return QString::fromStdString(CapturePath().string());
+  }
+
+  static QLabel* Status(ReviewDialog& dialog) {
+    return dialog.findChild<QLabel*>(
+        QLatin1String(ReviewDialog::kStatusLabelName));
+  }
+  static QProgressBar* Progress(ReviewDialog& dialog) {
+    return dialog.findChild<QProgressBar*>(
+        QLatin1String(ReviewDialog::kProgressBarName));
+  }
+  static QPushButton* Close(ReviewDialog& dialog) {
+    return dialog.findChild<QPushButton*>(
+        QLatin1String(ReviewDialog::kCloseButtonName));
+  }
+
+  std::filesystem::path directory_;
+};
+
+TEST_F(ReviewDialogTest, EveryControlIsPresentAndFindable) {
+  ReviewDialog dialog;
+  EXPECT_NE(dialog.findChild<OverviewPlot*>(
+                QLatin1String(ReviewDialog::kPlotName)),
+            nullptr);
+  EXPECT_NE(Status(dialog), nullptr);
+  EXPECT_NE(Progress(dialog), nullptr);
+  EXPECT_NE(Close(dialog), nullptr);
+}
+
+TEST_F(ReviewDialogTest, ACaptureWithNoOverviewIsMeasuredOnceAndKept) {
+  ReviewDialog dialog;
+  dialog.resize(900, 400);
+  dialog.Review(CaptureWithoutOverview(capture::kOverviewBlockSamples * 3));
+
+  ASSERT_TRUE(PumpUntil([&] { return dialog.plot()->total_samples() > 0; }));
+  EXPECT_EQ(dialog.plot()->total_samples(), capture::kOverviewBlockSamples * 3);
+  EXPECT_TRUE(
+      std::filesystem::exists(capture::CaptureOverviewPath(CapturePath())));
+  EXPECT_EQ(Close(dialog)->text(), QStringLiteral("Close"));
+}
+
+TEST_F(ReviewDialogTest, AnExistingOverviewIsShownWithoutMeasuring) {
+  ReviewDialog dialog;
+  dialog.resize(900, 400);
+  dialog.Review(OverviewOnly(4096));
+
+  // Straight away, with no capture on disk to have measured
+  EXPECT_EQ(dialog.plot()->total_samples(),
+            capture::kOverviewBlockSamples * 4096);
+  EXPECT_EQ(dialog.plot()->first_sample(), 0U);
+  EXPECT_EQ(dialog.plot()->sample_span(), dialog.plot()->total_samples());
+}
+
+TEST_F(ReviewDialogTest, ADecimatedCaptureIsTimedAtItsOwnRate) {
+  ReviewDialog dialog;
+  dialog.resize(900, 400);
+  dialog.Review(OverviewOnly(64, capture::kSampleRateHz / 4));
+
+  // A quarter-rate capture is four times as long as its samples would be at
+  // the full rate, and the times under the plot say so
+  const uint64_t total = capture::kOverviewBlockSamples * 64;
+  const QString quarter = QString::fromStdString(
+      capture::FormatSampleDuration(total, capture::kSampleRateHz / 4));
+  const QString full = QString::fromStdString(
+      capture::FormatSampleDuration(total, capture::kSampleRateHz));
+  const QString text = Status(dialog)->text();
+  EXPECT_TRUE(text.contains(quarter)) << text.toStdString();
+  EXPECT_FALSE(text.contains(full)) << text.toStdString();
+}
+
+TEST_F(ReviewDialogTest, ZoomingInReadsAFinerLevel) {
+  ReviewDialog dialog;
+  dialog.resize(900, 400);
+  dialog.show();
+  dialog.Review(OverviewOnly(4096));
+  QApplication::processEvents();
+
+  OverviewPlot* const plot = dialog.plot();
+  const size_t whole = plot->level();
+  EXPECT_GT(whole, 0U);
+
+  plot->ShowSpan(0, capture::kOverviewBlockSamples * 16);
+  EXPECT_LT(plot->level(), whole);
+
+  // And no narrower than a block a column, however far it is asked to go
+  plot->ShowSpan(0, 1);
+  EXPECT_GE(plot->sample_span(), capture::kOverviewBlockSamples);
+  EXPECT_EQ(plot->level(), 0U);
+}
+
+TEST_F(ReviewDialogTest, ACorruptOverviewIsRebuiltNotReported) {
+  const QString capture_path =
+      CaptureWithoutOverview(capture::kOverviewBlockSamples);
+  {
+    std::ofstream stale(capture::CaptureOverviewPath(CapturePath()),
+                        std::ios::binary);
+    stale << "not an overview";
+  }
+
+  ReviewDialog dialog;
+  dialog.resize(900, 400);
+  dialog.Review(capture_path);
+
+  ASSERT_TRUE(PumpUntil([&] { return dialog.plot()->total_samples() > 0; }));
+  EXPECT_EQ(dialog.plot()->total_samples(), capture::kOverviewBlockSamples);
+}
+
+}  // namespace
+}  // namespace ddd::gui
@@ -0,0 +1,121 @@
+/************************************************************************
+
+    test_video_panel.cpp
+
+    T1 tests for the video preview panel
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QComboBox>
+#include <QImage>
+#include <QLabel>
+
+#include "video_panel.h"
+#include "video_preview.h"
+
+namespace ddd::gui {
+namespace {
+
+template <typename T>
+T* Named(const VideoPanel& panel, const char* name) {
+  return panel.findChild<T*>(QLatin1String(name));
+}
+
+analysis::VideoField Field(analysis::VideoStandard standard, size_t rows,
+                           size_t locked, uint8_t level = 200) {
+  analysis::VideoField field;
+  field.standard = standard;
+  field.width = 256;
+  field.rows = rows;
+  field.locked_rows = locked;
+  field.pixels.assign(field.width * field.rows, level);
+  return field;
+}
+
+TEST(VideoFormatTest, BeforeAFieldTheStatusSaysWhatItIsWaitingFor) {
+  EXPECT_EQ(FormatVideoStatus(analysis::VideoField(), 0.0),
+            QStringLiteral("Waiting for a vertical sync"));
+}
+
+TEST(VideoFormatTest, TheStatusStatesTheLockAndTheRate) {
+  const QString text =
+      FormatVideoStatus(Field(analysis::VideoStandard::kPal, 312, 298), 1.94);
+
+  EXPECT_EQ(text,
+            QStringLiteral("PAL · 298 of 312 lines locked · 1.9 fields/s"));
+}
+
+TEST(VideoFormatTest, AnUnknownRateIsLeftOutRatherThanShownAsZero) {
+  const QString text =
+      FormatVideoStatus(Field(analysis::VideoStandard::kNtsc, 262, 250), 0.0);
+
+  EXPECT_EQ(text, QStringLiteral("NTSC · 250 of 262 lines locked"));
+}
+
+TEST(VideoFormatTest, TheRefusalNamesTheRateAndTheStandard) {
+  const QString text =
+      FormatVideoRateRefusal(analysis::VideoStandard::kPal, 10'000'000);
+
+  EXPECT_TRUE(text.contains(QStringLiteral("10 Msps"))) << text.toStdString();
+  EXPECT_TRUE(text.contains(QStringLiteral("PAL"))) << text.toStdString();
+}
+
+TEST(VideoPanelTest, AFieldIsDrawnAndCounted) {
+  VideoPanel panel(nullptr);
+  auto* const picture = Named<VideoPicture>(panel, VideoPanel::kPictureName);
+  ASSERT_NE(picture, nullptr);
+  EXPECT_FALSE(picture->has_field());
+
+  panel.OnVideoFieldReady(Field(analysis::VideoStandard::kPal, 312, 300));
+
+  ASSERT_TRUE(picture->has_field());
+  EXPECT_EQ(picture->image().width(), 256);
+  EXPECT_EQ(picture->image().height(), 312);
+  EXPECT_TRUE(Named<QLabel>(panel, VideoPanel::kStatusLabelName)
+                  ->text()
+                  .contains(QStringLiteral("300 of 312")));
+}
+
+TEST(VideoPanelTest, AFieldRenderedUnderTheOtherStandardIsDropped) {
+  VideoPanel panel(nullptr);
+  auto* const standard =
+      Named<QComboBox>(panel, VideoPanel::kStandardComboName);
+  standard->setCurrentIndex(
+      standard->findData(static_cast<int>(analysis::VideoStandard::kNtsc)));
+
+  panel.OnVideoFieldReady(Field(analysis::VideoStandard::kPal, 312, 300));
+
+  EXPECT_FALSE(
+      Named<VideoPicture>(panel, VideoPanel::kPictureName)->has_field());
+}
+
+TEST(VideoPanelTest, AQuarterRateStreamSaysWhyThereIsNoPicture) {
+  VideoPanel panel(nullptr);
+  panel.OnVideoFieldReady(Field(analysis::VideoStandard::kPal, 312, 300));
+
+  panel.SetSampleRate(10'000'000);
+
+  EXPECT_FALSE(
+      Named<VideoPicture>(panel, VideoPanel::kPictureName)->has_field());
+  EXPECT_TRUE(Named<QLabel>(panel, VideoPanel::kStatusLabelName)
+                  ->text()
+                  .contains(QStringLiteral("filtered out")));
+}
+
+TEST(VideoPanelTest, ThePictureKeepsItsShapeWhateverTheDock) {
+  VideoPicture picture;
+  picture.resize(800, 300);
+
+  const QRectF area = picture.PictureArea();
+  EXPECT_DOUBLE_EQ(area.height(), 300.0);
+  EXPECT_DOUBLE_EQ(area.width(), 400.0);
+  EXPECT_DOUBLE_EQ(area.center().x(), 400.0);
+}
+
+}  // namespace
+}  // namespace ddd::gui
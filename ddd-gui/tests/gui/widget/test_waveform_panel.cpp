@@ -547,6 +547,31 @@ TEST(WaveformPanelTest, AnUntriggerableSignalFreeRunsRatherThanFreezing) {
   EXPECT_FALSE(panel.grab().isNull());
 }
 
+TEST(WaveformPanelTest, ThePipelinesCrossingIsDrawnWhenTheSnapshotHasNone) {
+  // One rising crossing, armed by a dip that happened before the snapshot
+  // began: inside it the signal never goes far enough below the level to arm,
+  // so the plot's own search finds nothing. The pipeline found the crossing
+  // across the whole slot and says where it is, and that is a triggered sweep.
+  WaveformPanel panel(nullptr);
+  panel.resize(600, 300);
+  ShowIndividualCycles(panel);
+
+  std::vector<uint16_t> codes(4096, 505);
+  std::fill(codes.begin() + 2048, codes.end(), 600);
+
+  auto* const plot = Named<WaveformPlot>(panel, WaveformPanel::kPlotName);
+  ASSERT_NE(plot, nullptr);
+
+  panel.OnWaveformReady(codes);
+  panel.grab();
+  EXPECT_TRUE(plot->free_running());
+
+  panel.OnWaveformReady(codes, 2047.5);
+  panel.grab();
+  EXPECT_FALSE(plot->free_running());
+  EXPECT_EQ(plot->sweep_count(), 1U);
+}
+
 TEST(WaveformPanelTest, ThePanelPaintsWithNothingToDraw) {
   // The first thing a user sees. An empty plot must be an empty plot and not a
   // crash on a zero-length span or an unpopulated column.
@@ -0,0 +1,158 @@
+/************************************************************************
+
+    test_disc_cache.cpp
+
+    T1 tests for remembering measured discs
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+
+#include "disc_cache.h"
+
+namespace ddd::player {
+namespace {
+
+// A CAV disc as a completed examination leaves it.
+DiscProfile MeasuredCavDisc() {
+  DiscProfile disc;
+  disc.disc_status_reply = "10001";
+  disc.video_standard.Record(VideoStandard::kNtsc, Provenance::kReported);
+  disc.standard_user_code.outcome = UserCodeReading::Outcome::kRead;
+  disc.standard_user_code.text = "Y1000";
+  disc.programme_start.Record(1, Provenance::kMeasured);
+  disc.programme_end.Record(54000, Provenance::kMeasured);
+  disc.lead_in_reachable.Record(true, Provenance::kMeasured);
+  disc.pioneer_user_code.outcome = UserCodeReading::Outcome::kRead;
+  disc.pioneer_user_code.text = "#59-014 CASPER";
+  return disc;
+}
+
+TEST(DiscCacheTest, ADiscIsFoundByItsFingerprint) {
+  DiscCache cache;
+  ASSERT_TRUE(cache.Remember("LD-V4300D", MeasuredCavDisc()));
+
+  const CachedDisc* found =
+      cache.Find(*FingerprintOf("LD-V4300D", MeasuredCavDisc()));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->programme_start, 1);
+  EXPECT_EQ(found->programme_end, 54000);
+  EXPECT_EQ(found->lead_in_reachable, true);
+  EXPECT_EQ(found->pioneer_user_code.text, "#59-014 CASPER");
+}
+
+// The measurement belongs to the model that made it, so the same disc in a
+// different player is a different entry.
+TEST(DiscCacheTest, TheSameDiscInAnotherModelIsNotFound) {
+  DiscCache cache;
+  ASSERT_TRUE(cache.Remember("LD-V4300D", MeasuredCavDisc()));
+
+  EXPECT_EQ(cache.Find(*FingerprintOf("LD-V4400", MeasuredCavDisc())),
+            nullptr);
+}
+
+// A disc whose ends were not both established is one the next examination
+// has to measure anyway.
+TEST(DiscCacheTest, AHalfMeasuredDiscIsNotKept) {
+  DiscProfile disc = MeasuredCavDisc();
+  disc.programme_start = {};
+
+  DiscCache cache;
+  EXPECT_FALSE(cache.Remember("LD-V4300D", disc));
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+// Nothing to tell discs apart by, so nothing to file it under.
+TEST(DiscCacheTest, ADiscThatNeverReportedItsStatusHasNoFingerprint) {
+  DiscProfile disc = MeasuredCavDisc();
+  disc.disc_status_reply.clear();
+
+  EXPECT_FALSE(FingerprintOf("LD-V4300D", disc).has_value());
+}
+
+TEST(DiscCacheTest, RememberingAgainReplacesTheEntry) {
+  DiscCache cache;
+  ASSERT_TRUE(cache.Remember("LD-V4300D", MeasuredCavDisc()));
+
+  DiscProfile remeasured = MeasuredCavDisc();
+  remeasured.programme_end.Record(53998, Provenance::kMeasured);
+  ASSERT_TRUE(cache.Remember("LD-V4300D", remeasured));
+
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_EQ(cache.Find(*FingerprintOf("LD-V4300D", remeasured))->programme_end,
+            53998);
+}
+
+TEST(DiscCacheTest, TheFileReadsBackAsItWasWritten) {
+  DiscCache cache;
+  ASSERT_TRUE(cache.Remember("LD-V4300D", MeasuredCavDisc()));
+
+  DiscProfile no_codes = MeasuredCavDisc();
+  no_codes.disc_status_reply = "11010";
+  no_codes.standard_user_code = {};
+  no_codes.pioneer_user_code = {};
+  no_codes.lead_in_reachable = {};
+  ASSERT_TRUE(cache.Remember("LD-V4300D", no_codes));
+
+  const DiscCache read = DiscCache::Parse(cache.Serialise());
+  ASSERT_EQ(read.size(), 2u);
+  EXPECT_EQ(*read.Find(*FingerprintOf("LD-V4300D", MeasuredCavDisc())),
+            *cache.Find(*FingerprintOf("LD-V4300D", MeasuredCavDisc())));
+  EXPECT_EQ(*read.Find(*FingerprintOf("LD-V4300D", no_codes)),
+            *cache.Find(*FingerprintOf("LD-V4300D", no_codes)));
+}
+
+// A damaged line costs its own entry and no others; a file this version did
+// not write costs everything, because none of it can be trusted to mean what
+// this version would take it to.
+TEST(DiscCacheTest, ALineThatCannotBeReadIsSkipped) {
+  const std::string text =
+      "ddd-disc-cache 1\n"
+      "LD-V4300D\t10001\tN\tY1000\tone\t54000\t1\tread\t#59\n"
+      "LD-V4300D\t11010\tP\t\t0\t504500\t-\t-\t\n";
+
+  const DiscCache read = DiscCache::Parse(text);
+  EXPECT_EQ(read.size(), 1u);
+  EXPECT_EQ(DiscCache::Parse("ddd-disc-cache 2\n" + text.substr(17)).size(),
+            0u);
+}
+
+TEST(DiscCacheTest, TheOldestEntryIsTheFirstToGo) {
+  DiscCache cache;
+  DiscProfile disc = MeasuredCavDisc();
+  for (size_t index = 0; index <= DiscCache::kMaximumEntries; ++index) {
+    disc.standard_user_code.text = "Y" + std::to_string(index);
+    ASSERT_TRUE(cache.Remember("LD-V4300D", disc));
+  }
+
+  EXPECT_EQ(cache.size(), DiscCache::kMaximumEntries);
+  disc.standard_user_code.text = "Y0";
+  EXPECT_EQ(cache.Find(*FingerprintOf("LD-V4300D", disc)), nullptr);
+  disc.standard_user_code.text = "Y1";
+  EXPECT_NE(cache.Find(*FingerprintOf("LD-V4300D", disc)), nullptr);
+}
+
+TEST(DiscCacheTest, SavesAndLoads) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "ddd-gui-disc-cache-test.tsv";
+  std::filesystem::remove(path);
+
+  // A file that is not there is an empty cache, not a failure.
+  EXPECT_EQ(DiscCache::Load(path.string()).size(), 0u);
+
+  DiscCache cache;
+  ASSERT_TRUE(cache.Remember("LD-V4300D", MeasuredCavDisc()));
+  ASSERT_TRUE(cache.Save(path.string()));
+
+  EXPECT_EQ(DiscCache::Load(path.string()).size(), 1u);
+  std::filesystem::remove(path);
+}
+
+}  // namespace
+}  // namespace ddd::player
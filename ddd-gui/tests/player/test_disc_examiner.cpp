@@ -999,5 +999,92 @@ TEST(DiscExaminerTest, TheDefaultScopeIsStillEverything) {
   EXPECT_TRUE(Sent(sent, ExamineStage::kReadingStart));
 }
 
+
+// --- Remembering discs -----------------------------------------------------
+
+// A cache holding this disc as a plain examination measured it.
+DiscCache CacheOfTheCavDisc() {
+  DiscExaminer first(LevelIIIModel(), "A1");
+  Drive(first, CavScript());
+
+  DiscCache cache;
+  EXPECT_TRUE(cache.Remember(LevelIIIModel().name, first.profile()));
+  return cache;
+}
+
+size_t Count(const std::vector<ExamineStep>& steps, ExamineStage stage) {
+  return static_cast<size_t>(std::count_if(
+      steps.begin(), steps.end(),
+      [stage](const ExamineStep& step) { return step.stage == stage; }));
+}
+
+// The slow half, skipped: no search to the lead-in for the Pioneer code and no
+// seek back to the start. The seek past the end is still made, because it is
+// what says the cache is talking about this disc.
+TEST(DiscExaminerTest, ADiscTheCacheKnowsIsConfirmedWithOneSeek) {
+  const DiscCache cache = CacheOfTheCavDisc();
+
+  DiscExaminer examiner(LevelIIIModel(), "A1", ExamineScope::kFull, &cache);
+  const std::vector<ExamineStep> sent = Drive(examiner, CavScript());
+
+  EXPECT_EQ(examiner.outcome(), ExamineOutcome::kCompleted);
+  EXPECT_EQ(examiner.cache_match(), CacheMatch::kConfirmed);
+  EXPECT_EQ(
+      Stages(sent),
+      (std::vector<ExamineStage>{
+          ExamineStage::kCheckingPlayer, ExamineStage::kSpinningUp,
+          ExamineStage::kReadingDiscStatus, ExamineStage::kReadingTvSystem,
+          ExamineStage::kReadingStandardUserCode, ExamineStage::kFindingEnd,
+          ExamineStage::kReadingEnd, ExamineStage::kSettling,
+          ExamineStage::kCheckingTransport, ExamineStage::kSpinningDown}));
+
+  // Everything a capture needs, and a report that says which of it was taken
+  // from last time.
+  const DiscProfile& disc = examiner.profile();
+  EXPECT_EQ(disc.programme_end.provenance, Provenance::kMeasured);
+  EXPECT_EQ(disc.programme_start.value, 1);
+  EXPECT_EQ(disc.programme_start.provenance, Provenance::kCached);
+  EXPECT_EQ(disc.lead_in_reachable.provenance, Provenance::kCached);
+  EXPECT_EQ(disc.pioneer_user_code.text, "#59-014 CASPER");
+  EXPECT_TRUE(disc.pioneer_user_code.from_cache);
+}
+
+// A disc that fingerprints like the remembered one and ends somewhere else is
+// another disc, and gets everything a disc with no cache would — the Pioneer
+// code included, read once, after the measurement it would have disturbed.
+TEST(DiscExaminerTest, ADiscThatEndsElsewhereIsMeasuredInFull) {
+  const DiscCache cache = CacheOfTheCavDisc();
+  Script script = CavScript();
+  script[ExamineStage::kReadingEnd] = Answered("048000");
+
+  DiscExaminer examiner(LevelIIIModel(), "A1", ExamineScope::kFull, &cache);
+  const std::vector<ExamineStep> sent = Drive(examiner, script);
+
+  EXPECT_EQ(examiner.cache_match(), CacheMatch::kStale);
+  EXPECT_TRUE(Sent(sent, ExamineStage::kReadingStart));
+  EXPECT_EQ(Count(sent, ExamineStage::kReadingPioneerUserCode), 1u);
+
+  const DiscProfile& disc = examiner.profile();
+  EXPECT_EQ(disc.programme_end.value, 48000);
+  EXPECT_EQ(disc.programme_start.provenance, Provenance::kMeasured);
+  EXPECT_EQ(disc.pioneer_user_code.text, "#59-014 CASPER");
+  EXPECT_FALSE(disc.pioneer_user_code.from_cache);
+}
+
+// A cache that knows nothing of this disc costs nothing: each step is asked
+// once, and only the two user codes change places.
+TEST(DiscExaminerTest, AnUnknownDiscIsExaminedAsIfThereWereNoCache) {
+  const DiscCache cache;
+
+  DiscExaminer examiner(LevelIIIModel(), "A1", ExamineScope::kFull, &cache);
+  const std::vector<ExamineStep> sent = Drive(examiner, CavScript());
+
+  EXPECT_EQ(examiner.cache_match(), CacheMatch::kNone);
+  EXPECT_EQ(Count(sent, ExamineStage::kReadingPioneerUserCode), 1u);
+  EXPECT_TRUE(Sent(sent, ExamineStage::kReadingStart));
+  EXPECT_EQ(examiner.profile().programme_start.provenance,
+            Provenance::kMeasured);
+}
+
 }  // namespace
 }  // namespace ddd::player
@@ -12,10 +12,14 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "device_updater.h"
@@ -24,6 +28,50 @@
 
 namespace ddd::capture {
 
+// What several fakes updated at once saw of each other: how many were inside
+// SendChunk together. Shared between the fakes of one fleet so that a test can
+// assert the orchestrator drove them concurrently from what the devices
+// observed, rather than from wall-clock rates that a loaded machine skews.
+//
+// A probe can also hold the first chunk on each device until `rendezvous`
+// devices are writing, which makes the overlap certain when it is possible at
+// all: on one core, four devices' chunks could otherwise happen to miss each
+// other. A device that waits out the timeout carries on alone, so a serial
+// orchestrator fails the test by the figure rather than by hanging it.
+class ChunkConcurrencyProbe {
+ public:
+  explicit ChunkConcurrencyProbe(int rendezvous = 0)
+      : rendezvous_(rendezvous) {}
+
+  void Enter(bool first_chunk) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++writing_;
+    most_at_once_ = std::max(most_at_once_, writing_);
+    arrived_.notify_all();
+    if (first_chunk && rendezvous_ > 0) {
+      arrived_.wait_for(lock, std::chrono::seconds(10),
+                        [this] { return most_at_once_ >= rendezvous_; });
+    }
+  }
+
+  void Leave() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --writing_;
+  }
+
+  int most_at_once() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return most_at_once_;
+  }
+
+ private:
+  const int rendezvous_;
+  mutable std::mutex mutex_;
+  std::condition_variable arrived_;
+  int writing_ = 0;
+  int most_at_once_ = 0;
+};
+
 // An IDeviceUpdater that models the firmware's side of the update protocol
 // closely enough to drive the whole flow, and can be told to fail at any
 // point in it.
@@ -155,6 +203,18 @@ class FakeDeviceUpdater : public IDeviceUpdater {
 
   bool SendChunk(UpdateTarget target, uint16_t index,
                  std::span<const uint8_t> data) override {
+    // The device writing the chunk before it acknowledges it, when a test
+    // wants the transfer to take long enough to measure.
+    if (probe_ != nullptr) {
+      probe_->Enter(index == 0);
+    }
+    if (chunk_latency_.count() > 0) {
+      std::this_thread::sleep_for(chunk_latency_);
+    }
+    if (probe_ != nullptr) {
+      probe_->Leave();
+    }
+
     if (fault_ == Fault::kRefuseChunk && index == fail_at_chunk_) {
       status_.phase = UpdatePhase::kFailed;
       status_.error = failure_error_;
@@ -194,6 +254,27 @@ class FakeDeviceUpdater : public IDeviceUpdater {
     return true;
   }
 
+  // Sent one at a time whatever the depth, as endpoint zero would take them;
+  // the depth asked for is recorded so a test can see it was asked.
+  uint64_t SendChunks(UpdateTarget target, std::span<const uint8_t> payload,
+                      uint64_t chunk_bytes, size_t depth,
+                      const std::function<bool(uint64_t sent)>& on_sent)
+      override {
+    chunks_in_flight_ = depth;
+    const auto started = std::chrono::steady_clock::now();
+    const uint64_t chunks_before = chunk_count_;
+
+    const uint64_t sent = IDeviceUpdater::SendChunks(target, payload,
+                                                     chunk_bytes, depth,
+                                                     on_sent);
+
+    transfer_seconds_ += std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - started)
+                             .count();
+    transferred_chunks_ += chunk_count_ - chunks_before;
+    return sent;
+  }
+
   bool Finish(UpdateTarget target) override {
     if (fault_ == Fault::kRefuseFinish) {
       status_.phase = UpdatePhase::kFailed;
@@ -270,6 +351,10 @@ class FakeDeviceUpdater : public IDeviceUpdater {
     maximum_chunk_bytes_ = bytes;
     status_.maximum_chunk_bytes = bytes;
   }
+  void SetChunkLatency(std::chrono::microseconds latency) {
+    chunk_latency_ = latency;
+  }
+  void SetConcurrencyProbe(ChunkConcurrencyProbe* probe) { probe_ = probe; }
   void SetReconfigureSucceeds(bool succeeds) {
     reconfigure_succeeds_ = succeeds;
   }
@@ -314,6 +399,15 @@ class FakeDeviceUpdater : public IDeviceUpdater {
   uint64_t wait_count() const { return wait_count_; }
   uint64_t status_reads() const { return status_reads_; }
   size_t largest_chunk() const { return largest_chunk_; }
+  size_t chunks_in_flight() const { return chunks_in_flight_; }
+
+  // Chunks accepted per second of SendChunks, across every transfer so far.
+  // Zero before the first.
+  double ChunksPerSecond() const {
+    return transfer_seconds_ > 0.0
+               ? static_cast<double>(transferred_chunks_) / transfer_seconds_
+               : 0.0;
+  }
   UpdateTarget target() const { return target_; }
 
  private:
@@ -369,6 +463,11 @@ class FakeDeviceUpdater : public IDeviceUpdater {
   uint64_t wait_count_ = 0;
   uint64_t status_reads_ = 0;
   size_t largest_chunk_ = 0;
+  std::chrono::microseconds chunk_latency_{0};
+  ChunkConcurrencyProbe* probe_ = nullptr;
+  size_t chunks_in_flight_ = 0;
+  uint64_t transferred_chunks_ = 0;
+  double transfer_seconds_ = 0.0;
 };
 
 }  // namespace ddd::capture
@@ -0,0 +1,82 @@
+/************************************************************************
+
+    fake_hotplug_events.h
+
+    Bus-change notifications a test can fire by hand
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <utility>
+
+#include "usb_hotplug.h"
+
+namespace ddd::capture {
+
+// The netlink socket with no kernel behind it.
+//
+// Paired with FakeUsbDevice: a test changes what the fake bus enumerates and
+// then, or not, says so through Fire(). Not saying so is the interesting case
+// as often as saying so is — it is how a test shows the monitor is no longer
+// looking on its own.
+//
+// Thread-safety: Fire() may be called from any thread, as the real source's
+// callback arrives from its own.
+class FakeHotplugEvents : public IHotplugEvents {
+ public:
+  // Whether Start() succeeds, as it would not in a Flatpak without the host's
+  // network namespace.
+  explicit FakeHotplugEvents(bool available = true) : available_(available) {}
+
+  const char* Name() const override { return "fake"; }
+
+  bool Start(Callback on_event) override {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    ++start_count_;
+    if (!available_) {
+      return false;
+    }
+    on_event_ = std::move(on_event);
+    listening_ = true;
+    return true;
+  }
+
+  void Stop() override {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    listening_ = false;
+    on_event_ = nullptr;
+  }
+
+  // Deliver an event, if anyone is listening. Called with the lock held, so
+  // that Stop() returning really does mean no callback is still running.
+  void Fire(HotplugEvent event = HotplugEvent::kChanged) {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    if (listening_ && on_event_) {
+      on_event_(event);
+    }
+  }
+
+  bool listening() const {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    return listening_;
+  }
+
+  int start_count() const {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    return start_count_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  bool available_ = true;
+  bool listening_ = false;
+  int start_count_ = 0;
+  Callback on_event_;
+};
+
+}  // namespace ddd::capture
@@ -11,11 +11,13 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "jtag_cable.h"
@@ -34,34 +36,27 @@ namespace ddd::capture {
 //
 // TDO comes from a stream the test primes: each bit read is taken from it in
 // order, and anything past the end reads as zero.
+//
+// A deferred answer is filled in at once, which the seam allows, and is
+// counted as owed until the next flush: what a test of batching wants to know
+// is how many times the player made the cable wait, not when the bits landed.
 class FakeJtagCable : public IJtagCable {
  public:
   bool Shift(std::span<const uint8_t> tms, std::span<const uint8_t> tdi,
              size_t bit_count, std::vector<uint8_t>* tdo) override {
-    ++shift_calls_;
-    if (fail_after_.has_value() && shift_calls_ > *fail_after_) {
-      return false;
-    }
-
     if (tdo != nullptr) {
-      tdo->assign((bit_count + 7) / 8, 0);
+      RoundTrip();
     }
+    return Record(tms, tdi, bit_count, tdo);
+  }
 
-    for (size_t index = 0; index < bit_count; ++index) {
-      tms_.push_back(BitAt(tms, index));
-      tdi_.push_back(BitAt(tdi, index));
-      read_.push_back(tdo != nullptr);
-
-      if (tdo != nullptr) {
-        const bool value =
-            tdo_position_ < answers_.size() ? answers_[tdo_position_] : false;
-        ++tdo_position_;
-        if (value) {
-          (*tdo)[index / 8] |= static_cast<uint8_t>(1U << (index % 8));
-        }
-      }
+  bool ShiftDeferred(std::span<const uint8_t> tms,
+                     std::span<const uint8_t> tdi, size_t bit_count,
+                     std::vector<uint8_t>* tdo) override {
+    if (tdo != nullptr) {
+      owed_ = true;
     }
-    return true;
+    return Record(tms, tdi, bit_count, tdo);
   }
 
   bool RunClock(size_t count) override {
@@ -81,6 +76,10 @@ class FakeJtagCable : public IJtagCable {
 
   bool Flush() override {
     ++flushes_;
+    if (owed_) {
+      owed_ = false;
+      RoundTrip();
+    }
     return true;
   }
 
@@ -96,6 +95,16 @@ class FakeJtagCable : public IJtagCable {
   size_t shift_calls() const { return shift_calls_; }
   size_t flushes() const { return flushes_; }
 
+  // How many times the player had to wait for an answer: a read-back Shift()
+  // each, and a Flush() with deferred answers owed.
+  size_t round_trips() const { return round_trips_; }
+
+  // Make every round trip take this long, as a full-speed USB one does, so
+  // that what batching saves can be measured as time as well as counted.
+  void SetRoundTripTime(std::chrono::microseconds time) {
+    round_trip_time_ = time;
+  }
+
   // The bits TDO will produce, in the order they are asked for.
   void AnswerWith(std::vector<bool> bits) { answers_ = std::move(bits); }
 
@@ -130,6 +139,41 @@ class FakeJtagCable : public IJtagCable {
   void FailAfterShifts(size_t shifts) { fail_after_ = shifts; }
 
  private:
+  bool Record(std::span<const uint8_t> tms, std::span<const uint8_t> tdi,
+              size_t bit_count, std::vector<uint8_t>* tdo) {
+    ++shift_calls_;
+    if (fail_after_.has_value() && shift_calls_ > *fail_after_) {
+      return false;
+    }
+
+    if (tdo != nullptr) {
+      tdo->assign((bit_count + 7) / 8, 0);
+    }
+
+    for (size_t index = 0; index < bit_count; ++index) {
+      tms_.push_back(BitAt(tms, index));
+      tdi_.push_back(BitAt(tdi, index));
+      read_.push_back(tdo != nullptr);
+
+      if (tdo != nullptr) {
+        const bool value =
+            tdo_position_ < answers_.size() ? answers_[tdo_position_] : false;
+        ++tdo_position_;
+        if (value) {
+          (*tdo)[index / 8] |= static_cast<uint8_t>(1U << (index % 8));
+        }
+      }
+    }
+    return true;
+  }
+
+  void RoundTrip() {
+    ++round_trips_;
+    if (round_trip_time_.count() > 0) {
+      std::this_thread::sleep_for(round_trip_time_);
+    }
+  }
+
   static bool BitAt(std::span<const uint8_t> bits, size_t index) {
     const size_t byte = index / 8;
     if (byte >= bits.size()) {
@@ -147,6 +191,9 @@ class FakeJtagCable : public IJtagCable {
   size_t shift_calls_ = 0;
   size_t run_calls_ = 0;
   size_t flushes_ = 0;
+  size_t round_trips_ = 0;
+  bool owed_ = false;
+  std::chrono::microseconds round_trip_time_{0};
   std::optional<size_t> fail_after_;
 };
 
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -171,6 +172,9 @@ class FakeUsbDevice : public IUsbDevice {
 
     for (const DeviceInfo& info : devices_) {
       if (info.path == path) {
+        if (control_channel_factory_) {
+          return control_channel_factory_();
+        }
         return std::make_unique<SilentControlChannel>(&channels_outstanding_);
       }
     }
@@ -179,6 +183,14 @@ class FakeUsbDevice : public IUsbDevice {
 
   // --- What the test decides ----------------------------------------------
 
+  // Hand out these instead of channels that stall everything, for a test
+  // that needs a device whose update agent answers.
+  void SetControlChannelFactory(
+      std::function<std::unique_ptr<IUsbControlChannel>()> factory) {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    control_channel_factory_ = std::move(factory);
+  }
+
   void SetDevices(std::vector<DeviceInfo> devices) {
     const std::lock_guard<std::mutex> guard(mutex_);
     devices_ = std::move(devices);
@@ -332,6 +344,7 @@ class FakeUsbDevice : public IUsbDevice {
   bool enumeration_fails_ = false;
   bool hidden_while_open_ = false;
   int channels_outstanding_ = 0;
+  std::function<std::unique_ptr<IUsbControlChannel>()> control_channel_factory_;
   bool configuration_fails_ = false;
 
   // Whether the device has been told a capture is running, and how many times
@@ -0,0 +1,103 @@
+/************************************************************************
+
+    test_address_index.cpp
+
+    T1 tests for the index of player addresses against sample positions
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "address_index.h"
+
+namespace ddd::capture {
+namespace {
+
+TEST(AddressIndexTest, AReadingIsPlacedHalfwayAcrossItsBracket) {
+  AddressIndex index;
+  ASSERT_TRUE(index.Add(1200, 40'000'000, 42'000'000));
+
+  ASSERT_EQ(index.readings().size(), 1U);
+  EXPECT_EQ(index.readings()[0], (AddressReading{41'000'000, 1200}));
+  EXPECT_EQ(index.uncertainty_samples(), 1'000'000U);
+}
+
+TEST(AddressIndexTest, TheUncertaintyIsTheWorstReadingsNotTheLast) {
+  AddressIndex index;
+  index.Add(100, 0, 4'000'000);
+  index.Add(125, 20'000'000, 20'400'000);
+
+  EXPECT_EQ(index.uncertainty_samples(), 2'000'000U);
+}
+
+TEST(AddressIndexTest, AReadingThatDoesNotMoveForwardIsLeftOut) {
+  AddressIndex index;
+  ASSERT_TRUE(index.Add(500, 10'000'000, 10'000'000));
+
+  // The same frame read twice, a frame from before it, and an answer that
+  // arrived out of order
+  EXPECT_FALSE(index.Add(500, 30'000'000, 30'000'000));
+  EXPECT_FALSE(index.Add(480, 50'000'000, 50'000'000));
+  EXPECT_FALSE(index.Add(600, 8'000'000, 8'000'000));
+
+  ASSERT_EQ(index.readings().size(), 1U);
+  EXPECT_EQ(index.readings()[0].address, 500);
+}
+
+TEST(AddressIndexTest, AnAnswerFromBeforeItsQuestionIsRefused) {
+  AddressIndex index;
+  EXPECT_FALSE(index.Add(100, 20'000'000, 10'000'000));
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(AddressIndexTest, AnAddressIsLocatedAtTheLastReadingNotPastIt) {
+  AddressIndex index;
+  index.Add(1000, 20'000'000, 20'000'000);
+  index.Add(1012, 40'000'000, 40'000'000);
+  index.Add(1025, 60'000'000, 60'000'000);
+
+  EXPECT_EQ(index.Locate(1000), 20'000'000U);
+  EXPECT_EQ(index.Locate(1011), 20'000'000U);
+  EXPECT_EQ(index.Locate(1012), 40'000'000U);
+  EXPECT_EQ(index.Locate(90'000), 60'000'000U);
+
+  // Before the first reading the file may not hold it at all
+  EXPECT_FALSE(index.Locate(999).has_value());
+}
+
+TEST(AddressIndexTest, AnEmptyIndexLocatesNothing) {
+  const AddressIndex index;
+  EXPECT_FALSE(index.Locate(0).has_value());
+}
+
+TEST(AddressIndexTest, TheListStopsAtItsCapacity) {
+  AddressIndex index;
+  for (size_t reading = 0; reading < AddressIndex::kMaximumReadings;
+       ++reading) {
+    ASSERT_TRUE(index.Add(static_cast<int32_t>(reading),
+                          reading * 20'000'000, reading * 20'000'000));
+  }
+
+  EXPECT_FALSE(index.Add(static_cast<int32_t>(AddressIndex::kMaximumReadings),
+                         AddressIndex::kMaximumReadings * 20'000'000,
+                         AddressIndex::kMaximumReadings * 20'000'000));
+  EXPECT_EQ(index.readings().size(), AddressIndex::kMaximumReadings);
+}
+
+TEST(AddressIndexTest, ClearStartsAgain) {
+  AddressIndex index;
+  index.Add(100, 0, 2'000);
+  index.Clear();
+
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(index.uncertainty_samples(), 0U);
+  EXPECT_TRUE(index.Add(50, 0, 0));
+}
+
+}  // namespace
+}  // namespace ddd::capture
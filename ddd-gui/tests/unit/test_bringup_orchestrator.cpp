@@ -92,6 +92,11 @@ class BorrowedCable : public IJtagCable {
              size_t bit_count, std::vector<uint8_t>* tdo) override {
     return fake_->Shift(tms, tdi, bit_count, tdo);
   }
+  bool ShiftDeferred(std::span<const uint8_t> tms,
+                     std::span<const uint8_t> tdi, size_t bit_count,
+                     std::vector<uint8_t>* tdo) override {
+    return fake_->ShiftDeferred(tms, tdi, bit_count, tdo);
+  }
   bool RunClock(size_t count) override { return fake_->RunClock(count); }
   bool Flush() override { return fake_->Flush(); }
   const char* Name() const override { return fake_->Name(); }
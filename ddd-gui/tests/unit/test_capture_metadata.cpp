@@ -345,6 +345,115 @@ TEST_F(CaptureMetadataTest, TheSignalFiguresAreAboutThisFile) {
   EXPECT_TRUE(Contains(document, "# Measured over this file's own samples"));
 }
 
+TEST_F(CaptureMetadataTest, DropoutsAreListedWhereTheyAreInTheFile) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.dropouts.known = true;
+  metadata.dropouts.count = 2;
+  metadata.dropouts.total_samples = 2400;
+  metadata.dropouts.events = {{1'234'560, 1600}, {98'765'440, 800}};
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+
+  EXPECT_TRUE(Contains(document, "\"dropouts\":\n  \"count\": 2\n"));
+  EXPECT_TRUE(Contains(document, "\"total_samples\": 2400"));
+  EXPECT_TRUE(Contains(document, "    \"1234560\": 1600\n"));
+  EXPECT_TRUE(Contains(document, "    \"98765440\": 800\n"));
+
+  // Every one is listed, so nothing says otherwise
+  EXPECT_FALSE(Contains(document, "\"listed\""));
+}
+
+TEST_F(CaptureMetadataTest, AListCutShortSaysSo) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.dropouts.known = true;
+  metadata.dropouts.count = 70'000;
+  metadata.dropouts.events = {{0, 32}};
+
+  EXPECT_TRUE(
+      Contains(BuildCaptureMetadataYaml(metadata), "\"listed\": 1\n"));
+}
+
+TEST_F(CaptureMetadataTest, ACleanFileSaysItWasWatched) {
+  // Nothing found and nothing looked for are different claims, and only the
+  // first is written as a section.
+  CaptureMetadata metadata = Ordinary();
+  EXPECT_FALSE(Contains(BuildCaptureMetadataYaml(metadata), "dropouts"));
+
+  metadata.dropouts.known = true;
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+  EXPECT_TRUE(Contains(document, "\"count\": 0"));
+  EXPECT_TRUE(Contains(document, "\"events\": {}"));
+}
+
+TEST_F(CaptureMetadataTest, ThePlayersAddressesAreKeyedByWhereTheFileWas) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.addresses.addressing = "frame";
+  metadata.addresses.uncertainty_samples = 1'200'000;
+  metadata.addresses.readings = {{60'000'000, 1}, {80'000'000, 13}};
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+
+  EXPECT_TRUE(
+      Contains(document, "\"addresses\":\n  \"addressing\": \"frame\""));
+  EXPECT_TRUE(Contains(document, "\"uncertainty_samples\": 1200000"));
+  EXPECT_TRUE(Contains(document, "    \"60000000\": 1\n"));
+  EXPECT_TRUE(Contains(document, "    \"80000000\": 13\n"));
+}
+
+TEST_F(CaptureMetadataTest, ACaptureThePlayerWasNotAskedAboutHasNoAddresses) {
+  // A capture taken by hand, and an automatic one that never read an address
+  CaptureMetadata metadata = Ordinary();
+  EXPECT_FALSE(Contains(BuildCaptureMetadataYaml(metadata), "addresses"));
+
+  metadata.addresses.addressing = "time code";
+  EXPECT_FALSE(Contains(BuildCaptureMetadataYaml(metadata), "addresses"));
+}
+
+TEST_F(CaptureMetadataTest, TheCodesSectionCarriesTheHistogramAndItsVerdict) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.codes.known = true;
+  metadata.codes.counts[500] = 7000;
+  metadata.codes.counts[502] = 6900;
+  metadata.codes.linearity.known = true;
+  metadata.codes.linearity.sample_count = 13'900;
+  metadata.codes.linearity.lowest_code = 500;
+  metadata.codes.linearity.highest_code = 502;
+  metadata.codes.linearity.codes_assessed = 1;
+  metadata.codes.linearity.worst_dnl = -1.0;
+  metadata.codes.linearity.worst_dnl_code = 501;
+  metadata.codes.linearity.rms_dnl = 1.0;
+  metadata.codes.linearity.missing_codes = {501};
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+
+  EXPECT_TRUE(Contains(document, "\"codes\":\n  \"samples\": 13900\n"));
+  EXPECT_TRUE(Contains(document, "\"worst_dnl\": -1.000"));
+  EXPECT_TRUE(Contains(document, "\"worst_dnl_code\": 501"));
+  EXPECT_TRUE(Contains(document, "\"missing_codes\": 1"));
+  EXPECT_TRUE(Contains(document, "\"missing\": \"501\""));
+  EXPECT_TRUE(Contains(document, "    \"500\": 7000\n"));
+  EXPECT_TRUE(Contains(document, "    \"502\": 6900\n"));
+
+  // The empty bins are left out rather than written as a run of zeros
+  EXPECT_FALSE(Contains(document, "\"501\": 0"));
+}
+
+TEST_F(CaptureMetadataTest, TooLittleSignalGivesAHistogramButNoVerdict) {
+  CaptureMetadata metadata = Ordinary();
+  EXPECT_FALSE(Contains(BuildCaptureMetadataYaml(metadata), "\"codes\""));
+
+  metadata.codes.known = true;
+  metadata.codes.counts[512] = 40;
+  metadata.codes.linearity.sample_count = 40;
+  metadata.codes.linearity.lowest_code = 512;
+  metadata.codes.linearity.highest_code = 512;
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+  EXPECT_TRUE(Contains(document, "\"codes_assessed\": 0"));
+  EXPECT_TRUE(Contains(document, "    \"512\": 40\n"));
+  EXPECT_FALSE(Contains(document, "worst_dnl"));
+}
+
 // Metadata is data about the data. Anything measured over the monitoring
 // session either side of the file describes something that was never recorded,
 // so it is not in the document at all — not written with a caveat, absent.
@@ -373,6 +482,61 @@ TEST_F(CaptureMetadataTest, WhatTheDeviceLostWhileWritingThisFileIsRecorded) {
   EXPECT_TRUE(Contains(document, "\"device_dropped_words\": 1024"));
 }
 
+TEST_F(CaptureMetadataTest, TheCaptureThreadsAreAccountedForWhereMeasured) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.threads.transfer.present = true;
+  metadata.threads.transfer.threads = 1;
+  metadata.threads.transfer.involuntary_switches = 14;
+  metadata.threads.transfer.major_faults = 0;
+  metadata.threads.encoder.present = true;
+  metadata.threads.encoder.threads = 8;
+  metadata.threads.encoder.migrations_known = true;
+  metadata.threads.encoder.migrations = 31;
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+  EXPECT_TRUE(Contains(document, "\"threads\":"));
+  EXPECT_TRUE(Contains(document, "\"involuntary_switches\": 14"));
+  EXPECT_TRUE(Contains(document, "\"migrations\": 31"));
+
+  // The processing thread was not measured, so it is not there at all; and
+  // the transfer thread's migrations were not known, so they are not zero.
+  EXPECT_FALSE(Contains(document, "\"processing\""));
+  EXPECT_EQ(document.find("\"migrations\""),
+            document.rfind("\"migrations\""));
+}
+
+// A platform without the counters writes no section rather than a section of
+// zeros, which would read as a perfectly quiet machine.
+TEST_F(CaptureMetadataTest, NoThreadSectionWhereNothingWasMeasured) {
+  const std::string document = BuildCaptureMetadataYaml(Ordinary());
+  EXPECT_FALSE(Contains(document, "\"threads\""));
+}
+
+TEST_F(CaptureMetadataTest, WhatTheEncoderGaveUpIsRecorded) {
+  CaptureMetadata metadata = Ordinary();
+  metadata.encoder_effort.adjustable = true;
+  metadata.encoder_effort.configured_level = 8;
+  metadata.encoder_effort.file_level = 5;
+  metadata.encoder_effort.advised_level = 3;
+  metadata.encoder_effort.advised_lower = 2;
+  metadata.encoder_effort.advised_higher = 1;
+
+  const std::string document = BuildCaptureMetadataYaml(metadata);
+  EXPECT_TRUE(Contains(document, "\"encoder_effort\":\n"
+                                 "  \"configured_level\": 8\n"
+                                 "  \"level\": 5\n"
+                                 "  \"advised_level\": 3\n"));
+  EXPECT_TRUE(Contains(document, "\"advised_lower\": 2"));
+  EXPECT_TRUE(Contains(document, "\"advised_higher\": 1"));
+}
+
+// An uncompressed capture had no effort to give up, which is not the same as
+// giving up none, so it writes no section rather than one of zeros.
+TEST_F(CaptureMetadataTest, NoEffortSectionWithoutAnEncoderToAdjust) {
+  EXPECT_FALSE(
+      Contains(BuildCaptureMetadataYaml(Ordinary()), "encoder_effort"));
+}
+
 TEST_F(CaptureMetadataTest, TheDocumentIsWrittenToDiskAsItWasBuilt) {
   const std::filesystem::path directory =
       std::filesystem::temp_directory_path() / "ddd_metadata_test";
@@ -0,0 +1,351 @@
+/************************************************************************
+
+    test_capture_overview.cpp
+
+    T1 tests for the capture overview pyramid and its file
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "capture_overview.h"
+#include "sample_format.h"
+#include "sample_metrics.h"
+
+namespace ddd::capture {
+namespace {
+
+class TemporaryFile {
+ public:
+  TemporaryFile() {
+    const ::testing::TestInfo* const info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+    path_ = std::filesystem::temp_directory_path() /
+            (std::string("ddd-overview-") +
+             (info != nullptr ? info->name() : "unknown") +
+             kCaptureOverviewSuffix);
+    std::filesystem::remove(path_);
+  }
+
+  ~TemporaryFile() {
+    std::error_code ignored;
+    std::filesystem::remove(path_, ignored);
+  }
+
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+  TemporaryFile(TemporaryFile&&) = delete;
+  TemporaryFile& operator=(TemporaryFile&&) = delete;
+
+  const std::filesystem::path& path() const { return path_; }
+
+ private:
+  std::filesystem::path path_;
+};
+
+// A buffer's tally with a recognisable range: block n spans n to n + 100.
+BufferTally Tally(uint64_t sample_count, uint16_t minimum, uint16_t maximum) {
+  BufferTally tally;
+  tally.sample_count = sample_count;
+  tally.minimum_value = minimum;
+  tally.maximum_value = maximum;
+  tally.sum_of_squares = sample_count * 100;
+  tally.clipped_high_count = maximum == kMaximumSampleValue ? 1 : 0;
+  return tally;
+}
+
+CaptureOverview Build(size_t buffers, uint64_t samples_per_buffer) {
+  CaptureOverviewBuilder builder;
+  for (size_t index = 0; index < buffers; ++index) {
+    builder.Append(Tally(samples_per_buffer, static_cast<uint16_t>(index),
+                         static_cast<uint16_t>(index + 100)));
+  }
+  return builder.Finish();
+}
+
+// --- The pyramid -----------------------------------------------------------
+
+TEST(CaptureOverviewTest, EachLevelHoldsThePairsOfTheOneBelow) {
+  const CaptureOverview overview = Build(8, 1000);
+
+  ASSERT_EQ(overview.levels.size(), 4U);
+  EXPECT_EQ(overview.levels[0].size(), 8U);
+  EXPECT_EQ(overview.levels[1].size(), 4U);
+  EXPECT_EQ(overview.levels[2].size(), 2U);
+  EXPECT_EQ(overview.levels[3].size(), 1U);
+
+  const OverviewBlock& pair = overview.levels[1][2];
+  EXPECT_EQ(pair.first_sample, 4000U);
+  EXPECT_EQ(pair.sample_count, 2000U);
+  EXPECT_EQ(pair.minimum_value, 4);
+  EXPECT_EQ(pair.maximum_value, 105);
+
+  const OverviewBlock& whole = overview.levels[3][0];
+  EXPECT_EQ(whole.first_sample, 0U);
+  EXPECT_EQ(whole.sample_count, 8000U);
+  EXPECT_EQ(whole.minimum_value, 0);
+  EXPECT_EQ(whole.maximum_value, 107);
+  EXPECT_DOUBLE_EQ(whole.Rms(), 10.0);
+}
+
+TEST(CaptureOverviewTest, TheOddBlockAtTheEndOfALevelIsCarriedUpAlone) {
+  // Five blocks: two pairs and one left over, which has to reach the top
+  // without being dropped or merged with a block that is not its neighbour.
+  const CaptureOverview overview = Build(5, 1000);
+
+  ASSERT_EQ(overview.levels.size(), 4U);
+  EXPECT_EQ(overview.levels[1].size(), 3U);
+  EXPECT_EQ(overview.levels[2].size(), 2U);
+  EXPECT_EQ(overview.levels[3].size(), 1U);
+
+  EXPECT_EQ(overview.levels[1][2].first_sample, 4000U);
+  EXPECT_EQ(overview.levels[1][2].sample_count, 1000U);
+  EXPECT_EQ(overview.levels[3][0].sample_count, 5000U);
+  EXPECT_EQ(overview.total_samples(), 5000U);
+}
+
+TEST(CaptureOverviewTest, EveryLevelCoversTheWholeFileWithoutGapsOrOverlaps) {
+  for (size_t buffers = 1; buffers <= 33; ++buffers) {
+    const CaptureOverview overview = Build(buffers, 777);
+    for (const std::vector<OverviewBlock>& level : overview.levels) {
+      uint64_t expected_first = 0;
+      for (const OverviewBlock& block : level) {
+        EXPECT_EQ(block.first_sample, expected_first) << buffers;
+        expected_first = block.end_sample();
+      }
+      EXPECT_EQ(expected_first, buffers * 777U) << buffers;
+    }
+    EXPECT_EQ(overview.levels.back().size(), 1U) << buffers;
+  }
+}
+
+TEST(CaptureOverviewTest, BlocksOfUnevenLengthAreEachPlacedWhereTheyStart) {
+  // The last buffer of a file is short, and a decimated run's buffers are not
+  // the length a full-rate one's are.
+  CaptureOverviewBuilder builder;
+  builder.Append(Tally(1000, 10, 20));
+  builder.Append(Tally(1000, 10, 20));
+  builder.Append(Tally(250, 10, 20));
+  const CaptureOverview overview = builder.Finish();
+
+  EXPECT_EQ(overview.levels[0][2].first_sample, 2000U);
+  EXPECT_EQ(overview.total_samples(), 2250U);
+  EXPECT_EQ(overview.block_samples, 1000U);
+}
+
+TEST(CaptureOverviewTest, AnEmptyTallyAddsNothing) {
+  CaptureOverviewBuilder builder;
+  builder.Append(BufferTally{});
+  EXPECT_TRUE(builder.empty());
+  EXPECT_TRUE(builder.Finish().empty());
+}
+
+TEST(CaptureOverviewTest, FinishingLeavesTheBuilderReadyForTheNextFile) {
+  CaptureOverviewBuilder builder;
+  builder.SetSampleRate(kSampleRateHz / 2);
+  builder.Append(Tally(1000, 10, 20));
+  EXPECT_EQ(builder.Finish().sample_rate_hz, kSampleRateHz / 2);
+
+  builder.Append(Tally(500, 30, 40));
+  const CaptureOverview next = builder.Finish();
+  ASSERT_EQ(next.levels.size(), 1U);
+  EXPECT_EQ(next.levels[0][0].first_sample, 0U);
+  EXPECT_EQ(next.levels[0][0].minimum_value, 30);
+
+  // The rate is the stream's, and the next file is of the same stream
+  EXPECT_EQ(next.sample_rate_hz, kSampleRateHz / 2);
+}
+
+// The pipeline's builder is fed on the processing thread, which must never
+// allocate: whatever the file's length, it stays inside what was reserved.
+TEST(CaptureOverviewTest, AReservedBuilderNeverGrowsPastItsReservation) {
+  CaptureOverviewBuilder builder(8);
+  const size_t capacity = builder.block_capacity();
+  ASSERT_GE(capacity, 8U);
+
+  for (int file = 0; file < 2; ++file) {
+    for (size_t index = 0; index < 100; ++index) {
+      builder.Append(Tally(1000, 10, 20));
+      ASSERT_EQ(builder.block_capacity(), capacity) << index;
+    }
+    const CaptureOverview overview = builder.Finish();
+    EXPECT_LE(overview.levels[0].size(), 8U);
+    EXPECT_EQ(overview.total_samples(), 100'000U);
+    for (const std::vector<OverviewBlock>& level : overview.levels) {
+      uint64_t expected_first = 0;
+      for (const OverviewBlock& block : level) {
+        EXPECT_EQ(block.first_sample, expected_first);
+        expected_first = block.end_sample();
+      }
+      EXPECT_EQ(expected_first, 100'000U);
+    }
+    EXPECT_EQ(overview.levels.back().size(), 1U);
+    EXPECT_EQ(builder.block_capacity(), capacity);
+  }
+}
+
+TEST(CaptureOverviewTest, AFullLevelFoldsIntoHalfTheResolution) {
+  CaptureOverviewBuilder builder(4);
+  for (size_t index = 0; index < 5; ++index) {
+    builder.Append(Tally(1000, static_cast<uint16_t>(index),
+                         static_cast<uint16_t>(index + 100)));
+  }
+  const CaptureOverview overview = builder.Finish();
+
+  // The first four became two pairs when the level filled, and the fifth was
+  // the start of a third that the file ended inside
+  ASSERT_EQ(overview.levels[0].size(), 3U);
+  EXPECT_EQ(overview.levels[0][0].sample_count, 2000U);
+  EXPECT_EQ(overview.levels[0][1].first_sample, 2000U);
+  EXPECT_EQ(overview.levels[0][1].minimum_value, 2);
+  EXPECT_EQ(overview.levels[0][1].maximum_value, 103);
+  EXPECT_EQ(overview.levels[0][2].first_sample, 4000U);
+  EXPECT_EQ(overview.levels[0][2].sample_count, 1000U);
+  EXPECT_EQ(overview.block_samples, 2000U);
+  EXPECT_EQ(overview.levels.back()[0].sample_count, 5000U);
+  EXPECT_EQ(overview.levels.back()[0].maximum_value, 104);
+}
+
+// --- Measuring a block from samples -----------------------------------------
+
+TEST(CaptureOverviewTest, AMeasuredBlockAgreesWithTheValidatorsDefinitions) {
+  const std::vector<uint16_t> samples = {0, 512, 1023, 522, 502, 1023};
+  const OverviewBlock block =
+      MeasureOverviewBlock(samples.data(), samples.size(), 0);
+
+  EXPECT_EQ(block.sample_count, 6U);
+  EXPECT_EQ(block.minimum_value, 0);
+  EXPECT_EQ(block.maximum_value, 1023);
+  EXPECT_EQ(block.clipped_low_count, 1U);
+  EXPECT_EQ(block.clipped_high_count, 2U);
+  EXPECT_EQ(block.sum_of_squares, (512U * 512U) + 0U + (511U * 511U) + 100U +
+                                      100U + (511U * 511U));
+}
+
+// --- The file ----------------------------------------------------------------
+
+TEST(CaptureOverviewTest, TheOverviewSitsBesideTheCaptureAndItsMetadata) {
+  EXPECT_EQ(CaptureOverviewPath("/captures/Casper_side1.ddd.flac"),
+            std::filesystem::path("/captures/Casper_side1.ddd.overview"));
+  EXPECT_EQ(CaptureOverviewPath("/captures/Casper_side1.ddd.s16"),
+            std::filesystem::path("/captures/Casper_side1.ddd.overview"));
+  EXPECT_EQ(CaptureOverviewPath("/captures/other.wav"),
+            std::filesystem::path("/captures/other.wav.ddd.overview"));
+}
+
+TEST(CaptureOverviewTest, AWrittenOverviewReadsBackLevelByLevel) {
+  const TemporaryFile file;
+  CaptureOverview overview = Build(37, 1000);
+  overview.sample_rate_hz = kSampleRateHz / 8;
+
+  std::string error;
+  ASSERT_TRUE(WriteCaptureOverviewFile(file.path(), overview, error)) << error;
+
+  CaptureOverviewFile reader;
+  ASSERT_TRUE(reader.Open(file.path(), error)) << error;
+  EXPECT_EQ(reader.total_samples(), 37000U);
+  EXPECT_EQ(reader.block_samples(), 1000U);
+  EXPECT_EQ(reader.sample_rate_hz(), kSampleRateHz / 8);
+  ASSERT_EQ(reader.level_count(), overview.levels.size());
+
+  for (size_t level = 0; level < reader.level_count(); ++level) {
+    std::vector<OverviewBlock> blocks;
+    ASSERT_TRUE(reader.ReadBlocks(level, 0, 37000, blocks))
+        << reader.LastError();
+    ASSERT_EQ(blocks.size(), overview.levels[level].size());
+    for (size_t index = 0; index < blocks.size(); ++index) {
+      const OverviewBlock& expected = overview.levels[level][index];
+      EXPECT_EQ(blocks[index].first_sample, expected.first_sample);
+      EXPECT_EQ(blocks[index].sample_count, expected.sample_count);
+      EXPECT_EQ(blocks[index].sum_of_squares, expected.sum_of_squares);
+      EXPECT_EQ(blocks[index].clipped_high_count,
+                expected.clipped_high_count);
+      EXPECT_EQ(blocks[index].minimum_value, expected.minimum_value);
+      EXPECT_EQ(blocks[index].maximum_value, expected.maximum_value);
+    }
+  }
+}
+
+TEST(CaptureOverviewTest, OnlyTheBlocksHoldingTheSpanAreRead) {
+  const TemporaryFile file;
+  std::string error;
+  ASSERT_TRUE(WriteCaptureOverviewFile(file.path(), Build(64, 1000), error));
+
+  CaptureOverviewFile reader;
+  ASSERT_TRUE(reader.Open(file.path(), error)) << error;
+
+  // 10,500 to 13,000 starts inside block 10 and ends where block 13 begins
+  std::vector<OverviewBlock> blocks;
+  ASSERT_TRUE(reader.ReadBlocks(0, 10'500, 13'000, blocks));
+  ASSERT_EQ(blocks.size(), 3U);
+  EXPECT_EQ(blocks.front().first_sample, 10'000U);
+  EXPECT_EQ(blocks.back().first_sample, 12'000U);
+
+  // And a level up, where the blocks are twice as long
+  ASSERT_TRUE(reader.ReadBlocks(1, 10'500, 13'000, blocks));
+  ASSERT_EQ(blocks.size(), 2U);
+  EXPECT_EQ(blocks.front().first_sample, 10'000U);
+  EXPECT_EQ(blocks.back().first_sample, 12'000U);
+
+  // Past the end is nothing, not an error
+  ASSERT_TRUE(reader.ReadBlocks(0, 70'000, 80'000, blocks));
+  EXPECT_TRUE(blocks.empty());
+}
+
+TEST(CaptureOverviewTest, TheLevelChosenHasBlocksNoLongerThanAColumn) {
+  const TemporaryFile file;
+  std::string error;
+  ASSERT_TRUE(WriteCaptureOverviewFile(file.path(), Build(64, 1000), error));
+
+  CaptureOverviewFile reader;
+  ASSERT_TRUE(reader.Open(file.path(), error)) << error;
+
+  EXPECT_EQ(reader.LevelFor(500.0), 0U);
+  EXPECT_EQ(reader.LevelFor(1000.0), 0U);
+  EXPECT_EQ(reader.LevelFor(1999.0), 0U);
+  EXPECT_EQ(reader.LevelFor(2000.0), 1U);
+  EXPECT_EQ(reader.LevelFor(9000.0), 3U);
+
+  // No coarser than the top, however wide the column
+  EXPECT_EQ(reader.LevelFor(1.0e12), reader.level_count() - 1);
+}
+
+TEST(CaptureOverviewTest, AFileCutShortIsRefused) {
+  const TemporaryFile file;
+  std::string error;
+  ASSERT_TRUE(WriteCaptureOverviewFile(file.path(), Build(16, 1000), error));
+  std::filesystem::resize_file(file.path(),
+                               std::filesystem::file_size(file.path()) - 10);
+
+  CaptureOverviewFile reader;
+  EXPECT_FALSE(reader.Open(file.path(), error));
+  EXPECT_FALSE(reader.IsOpen());
+  EXPECT_NE(error.find("length"), std::string::npos) << error;
+}
+
+TEST(CaptureOverviewTest, AFileThatIsNotAnOverviewIsRefused) {
+  const TemporaryFile file;
+  {
+    std::ofstream stream(file.path(), std::ios::binary);
+    stream << "schema_version: 1\ncapture:\n  file: Casper_side1.ddd.flac\n";
+  }
+
+  CaptureOverviewFile reader;
+  std::string error;
+  EXPECT_FALSE(reader.Open(file.path(), error));
+  EXPECT_NE(error.find("not a capture overview"), std::string::npos) << error;
+}
+
+}  // namespace
+}  // namespace ddd::capture
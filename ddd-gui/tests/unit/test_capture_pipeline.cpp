@@ -11,15 +11,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <memory>
+#include <optional>
 #include <thread>
 #include <vector>
 
+#include "capture_format.h"
 #include "capture_pipeline.h"
 #include "logger.h"
 #include "recording_sink.h"
 #include "synthetic_source.h"
+#include "wire_data.h"
 #include "wire_protocol.h"
 
 namespace ddd::capture {
@@ -250,6 +257,39 @@ TEST_F(CapturePipelineTest, ABoundedRunCompletesOnItsOwn) {
   EXPECT_EQ(outcome.stats.metrics.sample_count, 20U * kTestSlotSamples);
 }
 
+// Both workers take their own last reading on the way out, so a finished run
+// has a final account for each of them whether or not the control thread ever
+// got round to sampling — and the account reaches the statistics block and the
+// log, which are the two places anybody would look for it.
+TEST_F(CapturePipelineTest, EachWorkerThreadIsAccountedFor) {
+  if (!ReadCurrentThreadUsage().present) {
+    GTEST_SKIP() << "This platform does not keep per-thread counters";
+  }
+
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.slot_limit = 20;
+  SyntheticSource source(source_options);
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+
+  EXPECT_TRUE(outcome.stats.threads.transfer.present);
+  EXPECT_TRUE(outcome.stats.threads.processing.present);
+  EXPECT_GT(outcome.stats.threads.processing.CpuSeconds() +
+                outcome.stats.threads.transfer.CpuSeconds(),
+            0.0);
+
+  // Nothing was encoding, and nothing pretends otherwise.
+  EXPECT_FALSE(outcome.stats.threads.encoder.present);
+
+  EXPECT_TRUE(LogContains("Transfer thread: "));
+  EXPECT_TRUE(LogContains("Processing thread: "));
+}
+
 TEST_F(CapturePipelineTest, AGracefulStopWritesOutWhatWasAlreadyBuffered) {
   SyntheticSource source(BaseSourceOptions());
 
@@ -401,6 +441,160 @@ TEST_F(CapturePipelineTest, ASequenceBreakStopsTheCaptureWithItsOwnCode) {
             std::string::npos);
 }
 
+// --- The packed wire format ------------------------------------------------
+
+// The synthetic source's packed stream, through the unpacker and the ramp
+// check, to a sink that sees nothing but whole samples in order.
+TEST_F(CapturePipelineTest, APackedStreamReachesTheSinkAsWholeSamples) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.wire_format = WireFormat::kPacked;
+  source_options.slot_limit = 12;
+  SyntheticSource source(source_options);
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.wire_format = WireFormat::kPacked;
+  options.test_mode = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::move(sink), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kRunning);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+
+  // Every block of every slot, the slots being a whole number of blocks
+  EXPECT_EQ(sink_view->SamplesWritten(), 12U * (kTestSlotBytes /
+                                                kPackedBlockBytes) *
+                                             kPackedSamplesPerBlock);
+  ASSERT_FALSE(sink_view->values().empty());
+  EXPECT_EQ(sink_view->values().front(), source.FirstDeliveredSampleValue());
+}
+
+TEST_F(CapturePipelineTest, ASkippedPackedBlockIsASequenceMismatch) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.wire_format = WireFormat::kPacked;
+  source_options.fault = SyntheticSource::Fault::kSequenceBreak;
+  source_options.fault_at_slot = 3;
+  SyntheticSource source(source_options);
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.wire_format = WireFormat::kPacked;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSequenceMismatch);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kFailed);
+  EXPECT_NE(pipeline.ResultDetail().find("Block number mismatch"),
+            std::string::npos);
+}
+
+// --- In-band telemetry -----------------------------------------------------
+
+constexpr size_t kInbandPacketsPerSlot =
+    kTestSlotBytes / InbandTelemetryStripper::kPacketBytes;
+
+// The blocks come out of the stream before anything looks at it: the sequence
+// counter and the ramp run on across every packet boundary, and the sink sees
+// exactly the samples behind the blocks.
+TEST_F(CapturePipelineTest, InbandBlocksAreStrippedBeforeTheStreamIsChecked) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.inband_telemetry = true;
+  source_options.slot_limit = 12;
+  SyntheticSource source(source_options);
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.inband_telemetry = true;
+  options.test_mode = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::move(sink), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+  EXPECT_EQ(sink_view->SamplesWritten(),
+            12U * kInbandPacketsPerSlot *
+                (InbandTelemetryStripper::kPacketDataBytes / kBytesPerSample));
+  ASSERT_FALSE(sink_view->values().empty());
+  EXPECT_EQ(sink_view->values().front(), source.FirstDeliveredSampleValue());
+
+  // One reading per packet, rather than one per poll
+  EXPECT_EQ(pipeline.device_back_pressure().readings(),
+            12U * kInbandPacketsPerSlot);
+  EXPECT_EQ(outcome.stats.peak_device_buffer_words, kInbandPacketWords);
+  EXPECT_EQ(outcome.stats.device_overflow_events, 0U);
+}
+
+TEST_F(CapturePipelineTest, InbandBlocksComeOutAheadOfThePackedUnpacker) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.wire_format = WireFormat::kPacked;
+  source_options.inband_telemetry = true;
+  source_options.slot_limit = 12;
+  SyntheticSource source(source_options);
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.wire_format = WireFormat::kPacked;
+  options.inband_telemetry = true;
+  options.test_mode = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kRunning);
+  EXPECT_TRUE(outcome.stats.test_pattern_passed);
+}
+
+// A lost packet, which the word format has no marker of its own for at this
+// granularity, is caught by the packet numbers.
+TEST_F(CapturePipelineTest, ALostInbandPacketIsASequenceMismatch) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.inband_telemetry = true;
+  source_options.fault = SyntheticSource::Fault::kPacketLoss;
+  source_options.fault_at_slot = 3;
+  SyntheticSource source(source_options);
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.inband_telemetry = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSequenceMismatch);
+  EXPECT_NE(pipeline.ResultDetail().find("Packet number mismatch"),
+            std::string::npos);
+}
+
+// The stream is asked for blocks only when the device says it sends them, so
+// a stream without them is the device going back on its word.
+TEST_F(CapturePipelineTest, AStreamWithoutInbandBlocksIsRefused) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.slot_limit = 12;
+  SyntheticSource source(source_options);
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.inband_telemetry = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+
+  const RunResult outcome = RunToCompletion(pipeline);
+  EXPECT_EQ(outcome.result, TransferResult::kSequenceMismatch);
+  EXPECT_NE(pipeline.ResultDetail().find("No in-band telemetry blocks"),
+            std::string::npos);
+}
+
 TEST_F(CapturePipelineTest, AShortDeliveryIsFatalRatherThanAbsorbed) {
   SyntheticSource::Options source_options = BaseSourceOptions();
   source_options.fault = SyntheticSource::Fault::kShortDelivery;
@@ -605,6 +799,285 @@ TEST_F(CapturePipelineTest, DetachingFinishesTheSinkAndLeavesTheStreamRunning) {
   EXPECT_EQ(retired.get(), sink_view);
 }
 
+TEST_F(CapturePipelineTest, AClosedFileHandsOverTheDropoutsItHeld) {
+  // The synthetic sine is a thousand samples to a cycle, far slower than any
+  // carrier, so its envelope falls through every zero crossing: a dropout
+  // every five hundred samples, which is a stream with known dropouts in it at
+  // no cost.
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.pattern = SyntheticSource::Pattern::kSine;
+  SyntheticSource source(source_options);
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+  uint64_t request = pipeline.AttachSink(std::move(sink));
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  request = pipeline.DetachSink();
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+
+  const std::vector<DropoutEvent> events = pipeline.TakeRetiredDropouts();
+
+  // The session carries on finding them after the file has closed, and the
+  // file's own count stays where the file left it
+  const uint64_t buffers_at_detach = pipeline.stats().Read().buffers_processed;
+  ASSERT_TRUE(WaitFor([&] {
+    return pipeline.stats().Read().buffers_processed > buffers_at_detach + 2;
+  }));
+  const CaptureStats stats = pipeline.stats().Read();
+  pipeline.RequestStop();
+  RunToCompletion(pipeline);
+
+  ASSERT_FALSE(events.empty());
+  EXPECT_EQ(events.size(), stats.dropouts.capture_event_count);
+  EXPECT_GT(stats.dropouts.event_count, events.size());
+
+  // Every one of them inside the file, counted from its first sample
+  for (const DropoutEvent& event : events) {
+    EXPECT_LE(event.start_sample + event.duration_samples,
+              sink_view->SamplesWritten());
+  }
+
+  // Taken once
+  EXPECT_TRUE(pipeline.TakeRetiredDropouts().empty());
+}
+
+TEST_F(CapturePipelineTest, AClosedFileHandsOverAnOverviewOfWhatItHeld) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.pattern = SyntheticSource::Pattern::kSine;
+  SyntheticSource source(source_options);
+
+  // A decimated run, so the rate the overview is stamped with is seen to be
+  // the run's rather than the converter's
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.sample_rate_hz = SampleRateHzFor(kQuarterRateDecimationFactor);
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+  uint64_t request = pipeline.AttachSink(std::move(sink));
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  request = pipeline.DetachSink();
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+
+  const CaptureOverview overview = pipeline.TakeRetiredOverview();
+  pipeline.RequestStop();
+  RunToCompletion(pipeline);
+
+  // A block for every buffer the file was given, and each one the extremes of
+  // exactly the samples that buffer put in it
+  ASSERT_FALSE(overview.empty());
+  EXPECT_EQ(overview.total_samples(), sink_view->SamplesWritten());
+  EXPECT_EQ(overview.sample_rate_hz, kSampleRateHz / 4);
+  ASSERT_EQ(overview.levels[0].size(), sink_view->samples_per_write().size());
+
+  const std::vector<uint16_t>& values = sink_view->values();
+  for (const OverviewBlock& block : overview.levels[0]) {
+    const auto first =
+        values.begin() + static_cast<ptrdiff_t>(block.first_sample);
+    const auto last = first + static_cast<ptrdiff_t>(block.sample_count);
+    EXPECT_EQ(block.minimum_value, *std::min_element(first, last));
+    EXPECT_EQ(block.maximum_value, *std::max_element(first, last));
+  }
+
+  // Closed up to a single block for the whole file
+  EXPECT_EQ(overview.levels.back().size(), 1U);
+  EXPECT_EQ(overview.levels.back()[0].sample_count,
+            sink_view->SamplesWritten());
+
+  // Taken once
+  EXPECT_TRUE(pipeline.TakeRetiredOverview().empty());
+}
+
+TEST_F(CapturePipelineTest, AFileOpenWhenTheRunEndsStillHandsOverItsOverview) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+  ASSERT_TRUE(
+      pipeline.Start(&source, std::move(sink), BasePipelineOptions()));
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  pipeline.RequestStop();
+  RunToCompletion(pipeline);
+
+  const CaptureOverview overview = pipeline.TakeRetiredOverview();
+  EXPECT_EQ(overview.total_samples(), sink_view->SamplesWritten());
+}
+
+TEST_F(CapturePipelineTest, AClosedFilesHistogramIsReadyWhenItsChangeIs) {
+  // What the controller relies on when it writes the sidecar: the histogram is
+  // published in the same swap that closes the file, so it is complete before
+  // the sink change is counted, and it holds the file's samples and no others.
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+  uint64_t request = pipeline.AttachSink(std::move(sink));
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  request = pipeline.DetachSink();
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+
+  const CodeHistograms histograms = pipeline.histograms().Read();
+  pipeline.RequestStop();
+  RunToCompletion(pipeline);
+
+  uint64_t capture_total = 0;
+  uint64_t session_total = 0;
+  for (size_t code = 0; code < kSampleCodeCount; ++code) {
+    capture_total += histograms.capture[code];
+    session_total += histograms.session[code];
+  }
+  EXPECT_EQ(capture_total, sink_view->SamplesWritten());
+  EXPECT_GE(session_total, capture_total);
+}
+
+// A sink with effort to adjust and an encoder that has fallen two seconds
+// behind, which is pressure the controller acts on at once whatever the ring is
+// doing. Opened at whichever step it is given, as a FLAC sink is.
+class BackloggedSink : public test::RecordingSink {
+ public:
+  explicit BackloggedSink(size_t step = 0) : step_(step) {}
+
+  std::vector<int> EffortLevels() const override { return {8, 5, 3, 0}; }
+  size_t EffortStep() const override { return step_; }
+  uint64_t SamplesPending() const override {
+    return uint64_t{2} * kSampleRateHz;
+  }
+
+ private:
+  size_t step_;
+};
+
+// The file being written keeps its level. What the pressure lowers is the
+// level advised for the next one, and the log says which is which.
+TEST_F(CapturePipelineTest, AnEncoderFallingBehindLowersTheNextFile) {
+  SyntheticSource source(BaseSourceOptions());
+
+  auto sink = std::make_unique<BackloggedSink>();
+  BackloggedSink* sink_view = sink.get();
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::move(sink), BasePipelineOptions()));
+
+  ASSERT_TRUE(WaitFor([&] { return pipeline.EffortStepForNextFile() > 0; }));
+  pipeline.RequestStop();
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  EXPECT_EQ(sink_view->EffortStep(), 0U);
+  const EncoderEffortSummary& effort = outcome.stats.encoder_effort;
+  EXPECT_TRUE(effort.adjustable);
+  EXPECT_EQ(effort.configured_level, 8);
+  EXPECT_EQ(effort.file_level, 8);
+  EXPECT_LE(effort.advised_level, 5);
+  EXPECT_GE(effort.advised_lower, 1U);
+  EXPECT_EQ(pipeline.EffortStepForNextFile(), effort.advised_lower);
+  EXPECT_TRUE(LogContains("Advising level 5 for the next recording file: "
+                          "the ring is "));
+  EXPECT_TRUE(LogContains(
+      "This file stays at level 8 (configured 8) and gets no relief from "
+      "this."));
+}
+
+TEST_F(CapturePipelineTest, EffortIsLeftAloneWhenAdaptingIsOff) {
+  SyntheticSource source(BaseSourceOptions());
+
+  auto sink = std::make_unique<BackloggedSink>();
+  BackloggedSink* sink_view = sink.get();
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.adapt_encoder_effort = false;
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::move(sink), options));
+
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  pipeline.RequestStop();
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  EXPECT_EQ(pipeline.EffortStepForNextFile(), 0U);
+  EXPECT_FALSE(outcome.stats.encoder_effort.adjustable);
+}
+
+// A file opened lower, as the next file of a struggling session is, is
+// described at the level it was opened at, and the readings carry on from
+// there.
+TEST_F(CapturePipelineTest, AFileOpenedLowerIsDescribedAtItsOwnLevel) {
+  SyntheticSource source(BaseSourceOptions());
+
+  auto sink = std::make_unique<BackloggedSink>(2);
+  BackloggedSink* sink_view = sink.get();
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::move(sink), BasePipelineOptions()));
+
+  ASSERT_TRUE(WaitFor([&] { return pipeline.EffortStepForNextFile() == 3; }));
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 3; }));
+  pipeline.RequestStop();
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  EXPECT_EQ(outcome.result, TransferResult::kSuccess);
+  const EncoderEffortSummary& effort = outcome.stats.encoder_effort;
+  EXPECT_EQ(effort.file_level, 3);
+  EXPECT_EQ(effort.advised_level, 0);
+  EXPECT_EQ(effort.advised_lower, 1U);
+}
+
+// The summary is the closed file's until another file opens, so that whoever
+// writes its sidecar after the change can still read it — and the step it
+// decided is still there for whoever opens the next file.
+TEST_F(CapturePipelineTest, AClosedFileKeepsItsEffortSummary) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+  EXPECT_FALSE(pipeline.stats().Read().encoder_effort.adjustable);
+
+  uint64_t request = pipeline.AttachSink(std::make_unique<BackloggedSink>());
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+  ASSERT_TRUE(WaitFor([&] { return pipeline.EffortStepForNextFile() > 0; }));
+  request = pipeline.DetachSink();
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+
+  const uint64_t buffers_at_detach = pipeline.stats().Read().buffers_processed;
+  ASSERT_TRUE(WaitFor([&] {
+    return pipeline.stats().Read().buffers_processed > buffers_at_detach + 2;
+  }));
+  const EncoderEffortSummary effort = pipeline.stats().Read().encoder_effort;
+  const size_t next_step = pipeline.EffortStepForNextFile();
+  pipeline.RequestStop();
+  RunToCompletion(pipeline);
+
+  EXPECT_TRUE(effort.adjustable);
+  EXPECT_GE(effort.advised_lower, 1U);
+  EXPECT_EQ(next_step, effort.advised_lower);
+}
+
+TEST_F(CapturePipelineTest, ATestRampIsNotWatchedForDropouts) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.slot_limit = 8;
+  SyntheticSource source(source_options);
+
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.test_mode = true;
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  EXPECT_FALSE(outcome.stats.dropouts.armed);
+  EXPECT_EQ(outcome.stats.dropouts.event_count, 0U);
+}
+
 TEST_F(CapturePipelineTest, ASwapLandsBetweenBuffersRatherThanDuringOne) {
   SyntheticSource source(BaseSourceOptions());
 
@@ -633,6 +1106,188 @@ TEST_F(CapturePipelineTest, ASwapLandsBetweenBuffersRatherThanDuringOne) {
             outcome.stats.buffers_processed - swap_buffer);
 }
 
+// --- Monitoring on a share of the buffers ------------------------------------
+
+CapturePipeline::Options SampledMonitorOptions(uint64_t interval) {
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.monitor_validation_interval = interval;
+  return options;
+}
+
+TEST_F(CapturePipelineTest, MonitoringChecksOneBufferInTheInterval) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.slot_limit = 40;
+  SyntheticSource source(source_options);
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             SampledMonitorOptions(4)));
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  ASSERT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kRunning);
+
+  // The buffer the validator locks on in is checked whole, and three in every
+  // four after it are skipped.
+  EXPECT_GE(outcome.stats.buffers_skipped, 27U);
+  EXPECT_LE(outcome.stats.buffers_skipped, 30U);
+
+  // Counted: every sample of every buffer, skipped or not, so that the run's
+  // length and rates are the stream's.
+  EXPECT_EQ(outcome.stats.metrics.sample_count,
+            outcome.stats.buffers_processed * kTestSlotSamples);
+
+  // Measured: the checked buffers whole, and the head of each skipped one
+  // that went to the waveform tap.
+  const uint64_t checked =
+      outcome.stats.buffers_processed - outcome.stats.buffers_skipped;
+  EXPECT_EQ(outcome.stats.metrics.measured_sample_count,
+            (checked * kTestSlotSamples) +
+                (outcome.stats.buffers_skipped * (512 / kBytesPerSample)));
+}
+
+// The head of a skipped buffer is stripped on its way to the tap, so what the
+// displays draw is sample values whichever kind of buffer it came from.
+TEST_F(CapturePipelineTest, ASkippedBuffersSnapshotIsStrippedOfItsMarkers) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             SampledMonitorOptions(1000)));
+  ASSERT_TRUE(
+      WaitFor([&] { return pipeline.stats().Read().buffers_skipped > 3; }));
+
+  std::vector<uint8_t> snapshot;
+  uint64_t generation = 0;
+  ASSERT_TRUE(WaitFor(
+      [&] { return pipeline.snapshots().TryRead(snapshot, generation); }));
+  pipeline.Abort();
+  pipeline.Wait();
+
+  ASSERT_EQ(snapshot.size(), 512U);
+  for (size_t offset = 0; offset < snapshot.size(); offset += kBytesPerSample) {
+    ASSERT_EQ(snapshot[offset + 1] & ~kSampleValueHighByteMask, 0)
+        << "a marker reached the snapshot at byte " << offset;
+  }
+}
+
+// An armed tap looks for its crossing across the whole slot and copies the
+// window that puts it a pre-trigger fraction in, which on the ramp is where
+// the window's samples step from 511 to 512.
+TEST_F(CapturePipelineTest, AnArmedSnapshotIsLinedUpOnACrossing) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+  pipeline.snapshots().ArmTrigger({});
+
+  std::vector<uint8_t> snapshot;
+  uint64_t generation = 0;
+  std::optional<double> position;
+  ASSERT_TRUE(WaitFor([&] {
+    return pipeline.snapshots().TryRead(snapshot, generation, position) &&
+           position.has_value();
+  }));
+  pipeline.Abort();
+  pipeline.Wait();
+
+  ASSERT_EQ(snapshot.size(), 512U);
+  const size_t window = snapshot.size() / kBytesPerSample;
+  EXPECT_GE(*position, 0.1 * static_cast<double>(window));
+  EXPECT_LE(*position, (0.1 * static_cast<double>(window)) + 2.0);
+
+  const auto upper = static_cast<size_t>(std::ceil(*position));
+  EXPECT_EQ(test::SampleAt(snapshot, upper), 512);
+  EXPECT_EQ(test::SampleAt(snapshot, upper - 1), 511);
+}
+
+// The window of a skipped buffer is what gets checked and stripped, wherever
+// in the slot the trigger put it.
+TEST_F(CapturePipelineTest, ASkippedBuffersArmedSnapshotIsStrippedToo) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             SampledMonitorOptions(1000)));
+  pipeline.snapshots().ArmTrigger({});
+  ASSERT_TRUE(
+      WaitFor([&] { return pipeline.stats().Read().buffers_skipped > 3; }));
+
+  std::vector<uint8_t> snapshot;
+  uint64_t generation = 0;
+  std::optional<double> position;
+  ASSERT_TRUE(WaitFor([&] {
+    return pipeline.snapshots().TryRead(snapshot, generation, position) &&
+           position.has_value();
+  }));
+  const CaptureStats stats = pipeline.stats().Read();
+  pipeline.Abort();
+  pipeline.Wait();
+
+  EXPECT_NE(stats.sequence_state, SequenceState::kFailed);
+  for (size_t offset = 0; offset < snapshot.size(); offset += kBytesPerSample) {
+    ASSERT_EQ(snapshot[offset + 1] & ~kSampleValueHighByteMask, 0)
+        << "a marker reached the snapshot at byte " << offset;
+  }
+}
+
+// Skipped buffers have their counter changes checked, so a lost transfer is
+// found while monitoring as it would be while capturing.
+TEST_F(CapturePipelineTest, ASequenceBreakIsFoundInASkippedBuffer) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.fault = SyntheticSource::Fault::kSequenceBreak;
+  source_options.fault_at_slot = 6;
+  SyntheticSource source(source_options);
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             SampledMonitorOptions(1000)));
+  const RunResult outcome = RunToCompletion(pipeline);
+
+  EXPECT_EQ(outcome.result, TransferResult::kSequenceMismatch);
+  EXPECT_EQ(outcome.stats.sequence_state, SequenceState::kFailed);
+  EXPECT_NE(pipeline.ResultDetail().find("counter changes alone"),
+            std::string::npos);
+}
+
+// The first buffer a file gets is checked whole, and so is every one after
+// it. A skipped buffer reaching the sink would still carry its markers, which
+// the ramp would show at once.
+TEST_F(CapturePipelineTest, AStoringSinkGetsEveryBufferCheckedWhole) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             SampledMonitorOptions(1000)));
+  ASSERT_TRUE(
+      WaitFor([&] { return pipeline.stats().Read().buffers_skipped > 3; }));
+
+  auto sink = std::make_unique<test::RecordingSink>();
+  test::RecordingSink* sink_view = sink.get();
+  const uint64_t request = pipeline.AttachSink(std::move(sink));
+  ASSERT_TRUE(WaitFor([&] { return pipeline.SinkChangeCount() >= request; }));
+  const uint64_t skipped_at_attach = pipeline.stats().Read().buffers_skipped;
+  ASSERT_TRUE(WaitFor([&] { return sink_view->write_calls() > 8; }));
+
+  pipeline.RequestStop();
+  const RunResult outcome = RunToCompletion(pipeline);
+  ASSERT_EQ(outcome.result, TransferResult::kSuccess);
+  EXPECT_EQ(outcome.stats.buffers_skipped, skipped_at_attach);
+
+  const std::vector<uint16_t>& values = sink_view->values();
+  size_t first_break = 0;
+  for (size_t index = 1; index < values.size(); ++index) {
+    const uint16_t expected = static_cast<uint16_t>(
+        (values[index - 1] + 1) % SyntheticSource::kRampLength);
+    if (values[index] != expected) {
+      first_break = index;
+      break;
+    }
+  }
+  EXPECT_EQ(first_break, 0U) << "the ramp broke at sample " << first_break;
+}
+
 // --- Throughput -------------------------------------------------------------
 
 // An eighth of wire rate: 10 MB/s. Fast enough that a window holds a good many
@@ -808,6 +1463,97 @@ TEST_F(CapturePipelineTest, SnapshotsArriveWhileTheCaptureRuns) {
   pipeline.Wait();
 }
 
+TEST_F(CapturePipelineTest, ASecondConsumerOfTheSnapshotsTakesNothingAway) {
+  SyntheticSource source(BaseSourceOptions());
+
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                             BasePipelineOptions()));
+
+  std::unique_ptr<SnapshotPublisher::Reader> monitor =
+      pipeline.snapshots().AddReader();
+  ASSERT_NE(monitor, nullptr);
+
+  // The display's copy and the monitor's view, of the same snapshot when they
+  // happen to ask between the same two publications, and never one at the
+  // other's expense
+  std::vector<uint8_t> snapshot;
+  uint64_t generation = 0;
+  ASSERT_TRUE(WaitFor(
+      [&] { return pipeline.snapshots().TryRead(snapshot, generation); }));
+  ASSERT_TRUE(WaitFor([&] { return monitor->TryAcquire(); }));
+  EXPECT_GE(monitor->generation(), generation);
+  EXPECT_EQ(monitor->data().size(), 512U);
+
+  monitor.reset();
+  pipeline.Abort();
+  pipeline.Wait();
+}
+
+TEST_F(CapturePipelineTest, FieldSnapshotsArriveOnlyWhenAskedFor) {
+  SyntheticSource::Options source_options = BaseSourceOptions();
+  source_options.slot_limit = 8;
+
+  // Off by default: a run that never set the size publishes nothing
+  {
+    SyntheticSource source(source_options);
+    CapturePipeline pipeline(&logger_);
+    ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(),
+                               BasePipelineOptions()));
+    RunToCompletion(pipeline);
+
+    std::vector<uint8_t> snapshot;
+    uint64_t generation = 0;
+    EXPECT_FALSE(pipeline.field_snapshots().TryRead(snapshot, generation));
+  }
+
+  // Nor does one that set it but never enabled the tap, which is the GUI with
+  // the preview closed: no copies, and no pool allocated for them
+  CapturePipeline::Options options = BasePipelineOptions();
+  options.field_snapshot_interval_buffers = 2;
+  options.field_snapshot_bytes = kTestSlotBytes * 2;
+  {
+    SyntheticSource source(source_options);
+    CapturePipeline pipeline(&logger_);
+    ASSERT_TRUE(
+        pipeline.Start(&source, std::make_unique<NullSink>(), options));
+    RunToCompletion(pipeline);
+
+    std::vector<uint8_t> snapshot;
+    uint64_t generation = 0;
+    EXPECT_FALSE(pipeline.field_snapshots().TryRead(snapshot, generation));
+    EXPECT_EQ(pipeline.field_snapshots().Generation(), 0U);
+  }
+
+  // Whole buffers while it is enabled, and nothing more once it is not
+  source_options.slot_limit = 0;
+  SyntheticSource source(source_options);
+  CapturePipeline pipeline(&logger_);
+  ASSERT_TRUE(pipeline.Start(&source, std::make_unique<NullSink>(), options));
+  pipeline.field_snapshots().SetEnabled(true);
+
+  std::vector<uint8_t> snapshot;
+  uint64_t generation = 0;
+  ASSERT_TRUE(WaitFor([&] {
+    return pipeline.field_snapshots().TryRead(snapshot, generation);
+  }));
+  EXPECT_EQ(snapshot.size(), kTestSlotBytes);
+
+  const auto buffers = [&] {
+    return pipeline.stats().Read().buffers_processed;
+  };
+  pipeline.field_snapshots().SetEnabled(false);
+  uint64_t after = buffers() + 4;
+  ASSERT_TRUE(WaitFor([&] { return buffers() >= after; }));
+  const uint64_t published = pipeline.field_snapshots().Generation();
+  after = buffers() + 8;
+  ASSERT_TRUE(WaitFor([&] { return buffers() >= after; }));
+  EXPECT_EQ(pipeline.field_snapshots().Generation(), published);
+
+  pipeline.Abort();
+  pipeline.Wait();
+}
+
 // --- What the log says about a run -----------------------------------------
 //
 // These pin the debug-level account of a capture, which is the only record of
@@ -111,6 +111,17 @@ TEST_F(CaptureProvenanceTest, ADecimatedCaptureRecordsTheRateItWasWrittenAt) {
   EXPECT_EQ(Value(tags, kTagDecimation).value_or(""), "2");
 }
 
+// The same at the bottom of the cascade, where an octave out would be three.
+TEST_F(CaptureProvenanceTest, AnEighthRateCaptureRecordsFiveMegasamples) {
+  CaptureProvenance facts = Facts();
+  facts.decimation_factor = kEighthRateDecimationFactor;
+
+  const std::vector<FlacWriter::Tag> tags = BuildProvenanceTags(facts);
+
+  EXPECT_EQ(Value(tags, kTagSampleRate).value_or(""), "5000000");
+  EXPECT_EQ(Value(tags, kTagDecimation).value_or(""), "8");
+}
+
 // And an ordinary capture says so explicitly rather than by the tag's absence,
 // so a reader never has to decide what a missing one meant.
 TEST_F(CaptureProvenanceTest,
@@ -0,0 +1,118 @@
+/************************************************************************
+
+    test_code_linearity.cpp
+
+    T1 tests for reading the converter's linearity off a code histogram
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "code_linearity.h"
+
+namespace ddd::capture {
+namespace {
+
+// What a healthy converter makes of a disc: a broad smooth hump about the
+// middle, with a million samples at its peak.
+CodeCounts Smooth() {
+  CodeCounts counts{};
+  for (size_t code = 0; code < kSampleCodeCount; ++code) {
+    const double distance = (static_cast<double>(code) - 512.0) / 150.0;
+    counts[code] = static_cast<uint64_t>(
+        std::llround(1.0e6 * std::exp(-distance * distance)));
+  }
+  return counts;
+}
+
+TEST(CodeLinearityTest, ASmoothHistogramIsALinearConverter) {
+  const LinearityProfile profile = AnalyseLinearity(Smooth());
+
+  ASSERT_TRUE(profile.known);
+  EXPECT_TRUE(profile.missing_codes.empty());
+  EXPECT_LT(std::abs(profile.worst_dnl), 0.02);
+  EXPECT_LT(profile.rms_dnl, 0.01);
+
+  // The tails are too thin to judge, so not every occupied code is
+  EXPECT_GT(profile.codes_assessed, 300U);
+  EXPECT_LT(profile.codes_assessed,
+            static_cast<uint32_t>(profile.highest_code - profile.lowest_code));
+}
+
+TEST(CodeLinearityTest, AMissingCodeIsFoundAndIsTheWorst) {
+  CodeCounts counts = Smooth();
+  counts[544] = 0;
+
+  const LinearityProfile profile = AnalyseLinearity(counts);
+
+  ASSERT_EQ(profile.missing_codes.size(), 1U);
+  EXPECT_EQ(profile.missing_codes[0], 544);
+  EXPECT_EQ(profile.worst_dnl_code, 544);
+  EXPECT_DOUBLE_EQ(profile.worst_dnl, -1.0);
+
+  // And its neighbours are not blamed for it
+  EXPECT_EQ(AnalyseLinearity(counts).codes_assessed,
+            AnalyseLinearity(Smooth()).codes_assessed);
+}
+
+TEST(CodeLinearityTest, AnOddEvenPatternShowsInTheSpread) {
+  // Odd codes a fifth wider than they should be and even codes a fifth
+  // narrower: the commonest shape of a converter with a weak least
+  // significant bit.
+  CodeCounts counts = Smooth();
+  for (size_t code = 0; code < kSampleCodeCount; ++code) {
+    counts[code] = static_cast<uint64_t>(
+        static_cast<double>(counts[code]) * (code % 2 == 1 ? 1.2 : 0.8));
+  }
+
+  const LinearityProfile profile = AnalyseLinearity(counts);
+
+  ASSERT_TRUE(profile.known);
+  EXPECT_TRUE(profile.missing_codes.empty());
+  EXPECT_GT(profile.rms_dnl, 0.15);
+}
+
+TEST(CodeLinearityTest, TheRailsAreNeverJudged) {
+  CodeCounts counts = Smooth();
+  counts[kMinimumSampleValue] = 50'000'000;
+  counts[kMaximumSampleValue] = 50'000'000;
+
+  const LinearityProfile profile = AnalyseLinearity(counts);
+
+  EXPECT_EQ(profile.lowest_code, kMinimumSampleValue);
+  EXPECT_EQ(profile.highest_code, kMaximumSampleValue);
+  EXPECT_NE(profile.worst_dnl_code, kMinimumSampleValue);
+  EXPECT_NE(profile.worst_dnl_code, kMaximumSampleValue);
+  EXPECT_LT(std::abs(profile.worst_dnl), 0.02);
+}
+
+TEST(CodeLinearityTest, TooLittleSignalIsNotJudgedAtAll) {
+  // A few hundred samples on each code, which is counting noise
+  CodeCounts counts{};
+  for (size_t code = 400; code < 600; ++code) {
+    counts[code] = 200 + (code % 7) * 40;
+  }
+
+  const LinearityProfile profile = AnalyseLinearity(counts);
+
+  EXPECT_FALSE(profile.known);
+  EXPECT_EQ(profile.codes_assessed, 0U);
+  EXPECT_EQ(profile.lowest_code, 400);
+  EXPECT_EQ(profile.highest_code, 599);
+  EXPECT_GT(profile.sample_count, 0U);
+}
+
+TEST(CodeLinearityTest, NothingAtAllIsNothingAtAll) {
+  const LinearityProfile profile = AnalyseLinearity(CodeCounts{});
+
+  EXPECT_FALSE(profile.known);
+  EXPECT_EQ(profile.sample_count, 0U);
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -13,11 +13,14 @@
 
 #include <atomic>
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "device_monitor.h"
+#include "fake_hotplug_events.h"
 #include "fake_usb_device.h"
 #include "usb_device_info.h"
 
@@ -277,5 +280,119 @@ TEST(DeviceMonitorTest, TheDeviceListCanBeAskedForRatherThanWaitedOn) {
   EXPECT_EQ(monitor.Devices().front().path, "bus-1");
 }
 
+// With events, the interval is not what an attach waits for. An hour here, so
+// that a report arriving at all is proof the event did it.
+TEST(DeviceMonitorTest, AnEventReportsAnAttachWithoutWaitingOutTheInterval) {
+  FakeUsbDevice device;
+  auto events = std::make_unique<FakeHotplugEvents>();
+  FakeHotplugEvents* const source = events.get();
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr, std::move(events));
+  monitor.Start(reports.Callback(), 1h);
+  ASSERT_TRUE(monitor.listening());
+  ASSERT_TRUE(reports.WaitFor(1));
+
+  device.SetSingleDevice("bus-1", DeviceSpeed::kSuper, "");
+  source->Fire();
+
+  ASSERT_TRUE(reports.WaitFor(2));
+  EXPECT_EQ(reports.Latest().size(), 1U);
+}
+
+// The point of having events: between them, nothing. Not an enumeration, and
+// not a wake-up — at a 2 ms interval a polling monitor would have made fifty.
+TEST(DeviceMonitorTest, NothingIsEnumeratedWhileNoEventArrives) {
+  FakeUsbDevice device;
+  device.SetSingleDevice("bus-1", DeviceSpeed::kSuper, "");
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr,
+                        std::make_unique<FakeHotplugEvents>());
+  monitor.Start(reports.Callback(), kTestInterval);
+  ASSERT_TRUE(reports.WaitFor(1));
+
+  const uint64_t polls = monitor.PollCount();
+  std::this_thread::sleep_for(100ms);
+  EXPECT_EQ(monitor.PollCount(), polls);
+}
+
+// The kernel's event arrives before libusb's own list has caught up with it,
+// so the first look after one can see nothing new. The change has to be found
+// anyway, without a second event to prompt it.
+TEST(DeviceMonitorTest, AChangeThatLagsItsEventIsStillFound) {
+  FakeUsbDevice device;
+  auto events = std::make_unique<FakeHotplugEvents>();
+  FakeHotplugEvents* const source = events.get();
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr, std::move(events));
+  monitor.Start(reports.Callback(), kTestInterval);
+  ASSERT_TRUE(reports.WaitFor(1));
+
+  const uint64_t polls = monitor.PollCount();
+  source->Fire();
+  const auto deadline = std::chrono::steady_clock::now() + 2s;
+  while (monitor.PollCount() <= polls &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  device.SetSingleDevice("bus-1", DeviceSpeed::kSuper, "");
+  ASSERT_TRUE(reports.WaitFor(2));
+  EXPECT_EQ(reports.Latest().size(), 1U);
+}
+
+// A source that cannot start is no worse than none: the monitor polls.
+TEST(DeviceMonitorTest, WithoutEventsTheMonitorPollsAsBefore) {
+  FakeUsbDevice device;
+  auto events = std::make_unique<FakeHotplugEvents>(false);
+  FakeHotplugEvents* const source = events.get();
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr, std::move(events));
+  monitor.Start(reports.Callback(), kTestInterval);
+  ASSERT_TRUE(reports.WaitFor(1));
+  EXPECT_EQ(source->start_count(), 1);
+  EXPECT_FALSE(monitor.listening());
+
+  device.SetSingleDevice("bus-1", DeviceSpeed::kSuper, "");
+  EXPECT_TRUE(reports.WaitFor(2));
+}
+
+// Silence from a source that has died is not news that nothing is happening.
+TEST(DeviceMonitorTest, LosingTheEventsGoesBackToPolling) {
+  FakeUsbDevice device;
+  auto events = std::make_unique<FakeHotplugEvents>();
+  FakeHotplugEvents* const source = events.get();
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr, std::move(events));
+  monitor.Start(reports.Callback(), kTestInterval);
+  ASSERT_TRUE(reports.WaitFor(1));
+
+  source->Fire(HotplugEvent::kLost);
+  EXPECT_FALSE(monitor.listening());
+
+  device.SetSingleDevice("bus-1", DeviceSpeed::kSuper, "");
+  EXPECT_TRUE(reports.WaitFor(2));
+}
+
+TEST(DeviceMonitorTest, StoppingStopsTheEvents) {
+  FakeUsbDevice device;
+  auto events = std::make_unique<FakeHotplugEvents>();
+  FakeHotplugEvents* const source = events.get();
+
+  Reports reports;
+  DeviceMonitor monitor(&device, nullptr, std::move(events));
+  monitor.Start(reports.Callback(), 1h);
+  ASSERT_TRUE(reports.WaitFor(1));
+  ASSERT_TRUE(source->listening());
+
+  monitor.Stop();
+  EXPECT_FALSE(source->listening());
+  EXPECT_FALSE(monitor.listening());
+}
+
 }  // namespace
 }  // namespace ddd::capture
@@ -12,6 +12,8 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <memory>
+#include <span>
 #include <vector>
 
 #include "device_updater.h"
@@ -249,5 +251,99 @@ TEST(DeviceUpdateErrorNames, EveryCodeHasASentenceAndAName) {
   EXPECT_STREQ(DeviceUpdateErrorName(DeviceUpdateError::kWrite), "write");
 }
 
+// A control channel whose update agent takes every chunk, or every chunk but
+// one, and writes down what it was sent.
+class AcceptingControlChannel : public IUsbControlChannel {
+ public:
+  struct Sent {
+    uint8_t request = 0;
+    uint16_t value = 0;
+    uint16_t index = 0;
+    size_t bytes = 0;
+  };
+
+  AcceptingControlChannel(std::vector<Sent>* sent, int refuse_value)
+      : sent_(sent), refuse_value_(refuse_value) {}
+
+  int Transfer(uint8_t, uint8_t request, uint16_t value, uint16_t index,
+               std::span<uint8_t> data, unsigned int) override {
+    if (static_cast<int>(value) == refuse_value_) {
+      return -1;
+    }
+    sent_->push_back({request, value, index, data.size()});
+    return static_cast<int>(data.size());
+  }
+
+ private:
+  std::vector<Sent>* sent_ = nullptr;
+  int refuse_value_ = -1;
+};
+
+std::unique_ptr<IDeviceUpdater> MakeAcceptingUpdater(
+    FakeUsbDevice& usb, std::vector<AcceptingControlChannel::Sent>& sent,
+    int refuse_value = -1) {
+  usb.SetSingleDevice("device", DeviceSpeed::kSuper, "Domesday Duplicator");
+  usb.SetControlChannelFactory([&sent, refuse_value] {
+    return std::make_unique<AcceptingControlChannel>(&sent, refuse_value);
+  });
+  return MakeDeviceUpdater(usb, "device", nullptr);
+}
+
+// The queued path must put exactly what the stop-and-wait one did on the
+// wire: the chunk number in wValue from zero, the target in wIndex, and a
+// short last chunk.
+TEST(DeviceUpdaterChunks, TheQueuedPathSendsWhatTheOneAtATimePathDid) {
+  FakeUsbDevice usb;
+  std::vector<AcceptingControlChannel::Sent> sent;
+  const std::unique_ptr<IDeviceUpdater> updater =
+      MakeAcceptingUpdater(usb, sent);
+  ASSERT_NE(updater, nullptr);
+
+  const std::vector<uint8_t> payload(5000, 0x5A);
+  std::vector<uint64_t> progress;
+  const uint64_t accepted = updater->SendChunks(
+      UpdateTarget::kGateware, payload, 2048, 4, [&progress](uint64_t done) {
+        progress.push_back(done);
+        return true;
+      });
+
+  EXPECT_EQ(accepted, payload.size());
+  ASSERT_EQ(sent.size(), 3U);
+  for (size_t chunk = 0; chunk < sent.size(); ++chunk) {
+    EXPECT_EQ(sent[chunk].request, kUpdateDataRequest);
+    EXPECT_EQ(sent[chunk].value, chunk);
+    EXPECT_EQ(sent[chunk].index, kUpdateTargetGateware);
+  }
+  EXPECT_EQ(sent[2].bytes, 5000U - 2 * 2048U);
+  EXPECT_EQ(progress, (std::vector<uint64_t>{2048, 4096, 5000}));
+}
+
+TEST(DeviceUpdaterChunks, ARefusedChunkEndsTheRunAndIsNotCounted) {
+  FakeUsbDevice usb;
+  std::vector<AcceptingControlChannel::Sent> sent;
+  const std::unique_ptr<IDeviceUpdater> updater =
+      MakeAcceptingUpdater(usb, sent, 1);
+  ASSERT_NE(updater, nullptr);
+
+  const std::vector<uint8_t> payload(8192, 0x5A);
+  EXPECT_EQ(updater->SendChunks(UpdateTarget::kFirmware, payload, 2048, 4, {}),
+            2048U);
+  EXPECT_EQ(sent.size(), 1U);
+}
+
+TEST(DeviceUpdaterChunks, StoppingSendsNothingMore) {
+  FakeUsbDevice usb;
+  std::vector<AcceptingControlChannel::Sent> sent;
+  const std::unique_ptr<IDeviceUpdater> updater =
+      MakeAcceptingUpdater(usb, sent);
+  ASSERT_NE(updater, nullptr);
+
+  const std::vector<uint8_t> payload(8192, 0x5A);
+  EXPECT_EQ(updater->SendChunks(UpdateTarget::kFirmware, payload, 2048, 1,
+                                [](uint64_t) { return false; }),
+            2048U);
+  EXPECT_EQ(sent.size(), 1U);
+}
+
 }  // namespace
 }  // namespace ddd::capture
@@ -0,0 +1,302 @@
+/************************************************************************
+
+    test_dropout_detector.cpp
+
+    T1 tests for finding dropouts in the RF envelope as it goes past
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+#include "dropout_detector.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+namespace {
+
+// A carrier near the middle of the video band, at full rate: five samples to
+// a cycle.
+constexpr double kCarrierHz = 8'000'000.0;
+constexpr double kRate = 40'000'000.0;
+
+// An FM carrier at a given amplitude, continuing in phase from `first`.
+void AppendCarrier(std::vector<uint16_t>& samples, size_t count,
+                   double amplitude) {
+  const size_t first = samples.size();
+  for (size_t index = 0; index < count; ++index) {
+    const double phase = 2.0 * std::numbers::pi * kCarrierHz *
+                         static_cast<double>(first + index) / kRate;
+    samples.push_back(static_cast<uint16_t>(
+        std::lround(512.0 + (amplitude * std::sin(phase)))));
+  }
+}
+
+// Ten milliseconds of a disc at its nominal level, which is long enough for
+// the reference to have settled several times over.
+std::vector<uint16_t> Settled() {
+  std::vector<uint16_t> samples;
+  AppendCarrier(samples, 400'000, 300.0);
+  return samples;
+}
+
+TEST(DropoutDetectorTest, ACleanCarrierHasNoDropouts) {
+  DropoutDetector detector;
+  const std::vector<uint16_t> samples = Settled();
+  detector.Process(samples.data(), samples.size());
+
+  const DropoutSummary summary = detector.Summary();
+  EXPECT_TRUE(summary.armed);
+  EXPECT_EQ(summary.event_count, 0U);
+  EXPECT_EQ(summary.dropout_samples, 0U);
+}
+
+TEST(DropoutDetectorTest, ACollapseIsFoundWhereItHappened) {
+  std::vector<uint16_t> samples = Settled();
+  const size_t start = samples.size();
+  AppendCarrier(samples, 1600, 15.0);  // 40 µs, a speck on the disc
+  AppendCarrier(samples, 100'000, 300.0);
+
+  DropoutDetector detector;
+  detector.Process(samples.data(), samples.size());
+
+  const DropoutSummary summary = detector.Summary();
+  ASSERT_EQ(summary.event_count, 1U);
+
+  // To the block, which is all the detector claims
+  const auto block = static_cast<double>(detector.block_samples());
+  EXPECT_NEAR(static_cast<double>(summary.last_start_sample),
+              static_cast<double>(start), block);
+  EXPECT_NEAR(static_cast<double>(summary.dropout_samples), 1600.0,
+              2.0 * block);
+  EXPECT_EQ(summary.longest_samples, summary.dropout_samples);
+}
+
+// Samples nobody looked at still count towards where things are, and a
+// dropout under way when the watching stopped ends where the watching did.
+TEST(DropoutDetectorTest, SkippedSamplesMoveThePositionButAreNotJudged) {
+  std::vector<uint16_t> samples = Settled();
+  const size_t collapse = samples.size();
+  AppendCarrier(samples, 4000, 15.0);
+
+  DropoutDetector detector;
+  detector.Process(samples.data(), samples.size());
+  detector.Skip(1'000'000);
+
+  DropoutSummary summary = detector.Summary();
+  ASSERT_EQ(summary.event_count, 1U);
+  const auto block = static_cast<double>(detector.block_samples());
+  EXPECT_NEAR(static_cast<double>(summary.dropout_samples),
+              static_cast<double>(samples.size() - collapse), 2.0 * block);
+  EXPECT_TRUE(summary.armed);
+
+  std::vector<uint16_t> after;
+  AppendCarrier(after, 100'000, 300.0);
+  const size_t second = after.size();
+  AppendCarrier(after, 1600, 15.0);
+  AppendCarrier(after, 100'000, 300.0);
+  detector.Process(after.data(), after.size());
+
+  summary = detector.Summary();
+  ASSERT_EQ(summary.event_count, 2U);
+  EXPECT_NEAR(static_cast<double>(summary.last_start_sample),
+              static_cast<double>(samples.size() + 1'000'000 + second), block);
+}
+
+TEST(DropoutDetectorTest, ALevelThatChangesSlowlyIsNotADropout) {
+  // Half the envelope lost over a hundred milliseconds — the kind of change
+  // radius and gain make across a side. Far deeper than a dropout's threshold
+  // overall, and nowhere near it against the last couple of milliseconds.
+  std::vector<uint16_t> samples = Settled();
+  for (int step = 0; step < 100; ++step) {
+    AppendCarrier(samples, 40'000, 300.0 - (1.5 * step));
+  }
+
+  DropoutDetector detector;
+  detector.Process(samples.data(), samples.size());
+
+  EXPECT_EQ(detector.Summary().event_count, 0U);
+  EXPECT_TRUE(detector.Summary().armed);
+}
+
+TEST(DropoutDetectorTest, HowTheSamplesArriveChangesNothing) {
+  // A slot boundary can fall anywhere in a block, including inside a dropout.
+  std::vector<uint16_t> samples = Settled();
+  AppendCarrier(samples, 999, 10.0);
+  AppendCarrier(samples, 20'000, 300.0);
+  AppendCarrier(samples, 4321, 30.0);
+  AppendCarrier(samples, 20'000, 300.0);
+
+  DropoutDetector whole;
+  whole.Process(samples.data(), samples.size());
+
+  DropoutDetector pieces;
+  size_t offset = 0;
+  size_t piece = 7;
+  while (offset < samples.size()) {
+    const size_t count = std::min(piece, samples.size() - offset);
+    pieces.Process(samples.data() + offset, count);
+    offset += count;
+    piece = (piece * 3) % 9973 + 1;
+  }
+
+  EXPECT_EQ(whole.Summary().event_count, 2U);
+  EXPECT_EQ(pieces.Summary().event_count, whole.Summary().event_count);
+  EXPECT_EQ(pieces.Summary().dropout_samples, whole.Summary().dropout_samples);
+  EXPECT_EQ(pieces.Summary().last_start_sample,
+            whole.Summary().last_start_sample);
+}
+
+TEST(DropoutDetectorTest, SilenceIsNotOneLongDropout) {
+  // No disc, or the tray open: the converter's own noise. There is nothing to
+  // have dropped out of, and the detector says it is not armed rather than
+  // reporting a clean disc.
+  std::vector<uint16_t> samples;
+  for (size_t index = 0; index < 400'000; ++index) {
+    samples.push_back(static_cast<uint16_t>(511 + (index * 7919 % 3)));
+  }
+
+  DropoutDetector detector;
+  detector.Process(samples.data(), samples.size());
+
+  EXPECT_FALSE(detector.Summary().armed);
+  EXPECT_EQ(detector.Summary().event_count, 0U);
+}
+
+TEST(DropoutDetectorTest, TheSignalGoingAwayEndsAtAFieldAndDisarms) {
+  // The player stopped. One event, closed at the longest a dropout can be, and
+  // after it a detector that knows there is nothing to watch.
+  std::vector<uint16_t> samples = Settled();
+  AppendCarrier(samples, 2'000'000, 2.0);
+
+  DropoutDetector detector;
+  detector.Process(samples.data(), samples.size());
+
+  const DropoutSummary summary = detector.Summary();
+  EXPECT_EQ(summary.event_count, 1U);
+  EXPECT_NEAR(static_cast<double>(summary.longest_samples), 0.02 * kRate,
+              static_cast<double>(detector.block_samples()));
+  EXPECT_FALSE(summary.armed);
+}
+
+TEST(DropoutDetectorTest, AFileListsItsOwnDropoutsCountedFromItsFirstSample) {
+  DropoutDetector detector;
+  std::vector<uint16_t> before = Settled();
+  AppendCarrier(before, 2000, 10.0);  // In the session, not the file
+  AppendCarrier(before, 40'000, 300.0);
+  detector.Process(before.data(), before.size());
+
+  detector.BeginCaptureSpan();
+  std::vector<uint16_t> file;
+  AppendCarrier(file, 80'000, 300.0);
+  AppendCarrier(file, 800, 10.0);
+  AppendCarrier(file, 40'000, 300.0);
+  detector.Process(file.data(), file.size());
+  detector.EndCaptureSpan();
+
+  const DropoutSummary summary = detector.Summary();
+  EXPECT_EQ(summary.event_count, 2U);
+  EXPECT_EQ(summary.capture_event_count, 1U);
+
+  const std::vector<DropoutEvent> events = detector.TakeCaptureEvents();
+  ASSERT_EQ(events.size(), 1U);
+  const auto block = static_cast<double>(detector.block_samples());
+  EXPECT_NEAR(static_cast<double>(events[0].start_sample), 80'000.0, block);
+  EXPECT_NEAR(static_cast<double>(events[0].duration_samples), 800.0,
+              2.0 * block);
+  EXPECT_EQ(summary.capture_dropout_samples, events[0].duration_samples);
+
+  EXPECT_TRUE(detector.TakeCaptureEvents().empty());
+}
+
+// The list's megabyte is reserved when the detector is built, off the
+// processing thread's deadline, and a file handed over takes a copy of its
+// events rather than the reservation: the next file's span allocates nothing.
+TEST(DropoutDetectorTest, EveryFileListsIntoTheSameReservation) {
+  DropoutDetector detector;
+  EXPECT_GE(detector.capture_event_capacity(),
+            DropoutDetector::kMaximumCaptureEvents);
+
+  for (int file = 0; file < 2; ++file) {
+    detector.BeginCaptureSpan();
+    std::vector<uint16_t> samples = Settled();
+    AppendCarrier(samples, 800, 10.0);
+    AppendCarrier(samples, 40'000, 300.0);
+    detector.Process(samples.data(), samples.size());
+    detector.EndCaptureSpan();
+
+    EXPECT_EQ(detector.TakeCaptureEvents().size(), 1U);
+    EXPECT_GE(detector.capture_event_capacity(),
+              DropoutDetector::kMaximumCaptureEvents);
+  }
+}
+
+TEST(DropoutDetectorTest, ADropoutAcrossEitherEndIsTheFilesOnlyWhereItHasIt) {
+  DropoutDetector detector;
+  std::vector<uint16_t> before = Settled();
+  AppendCarrier(before, 640, 10.0);
+  detector.Process(before.data(), before.size());
+
+  // Opened partway through one dropout
+  detector.BeginCaptureSpan();
+  std::vector<uint16_t> file;
+  AppendCarrier(file, 320, 10.0);
+  AppendCarrier(file, 40'000, 300.0);
+  AppendCarrier(file, 480, 10.0);
+  detector.Process(file.data(), file.size());
+
+  // And closed partway through another
+  detector.EndCaptureSpan();
+
+  const std::vector<DropoutEvent> events = detector.TakeCaptureEvents();
+  ASSERT_EQ(events.size(), 2U);
+  const auto block = static_cast<double>(detector.block_samples());
+
+  EXPECT_EQ(events[0].start_sample, 0U);
+  EXPECT_NEAR(static_cast<double>(events[0].duration_samples), 320.0, block);
+
+  EXPECT_NEAR(static_cast<double>(events[1].start_sample), 40'320.0, block);
+  EXPECT_EQ(events[1].start_sample + events[1].duration_samples, file.size());
+}
+
+TEST(DropoutDetectorTest, WireWordsAreReadWithTheirMarkersMaskedOff) {
+  std::vector<uint16_t> samples = Settled();
+  AppendCarrier(samples, 1600, 15.0);
+  AppendCarrier(samples, 40'000, 300.0);
+
+  std::vector<uint8_t> wire;
+  for (size_t index = 0; index < samples.size(); ++index) {
+    const uint16_t word = MakeWireWord(
+        samples[index], static_cast<uint8_t>((index / 65'536) % 63 + 1));
+    wire.push_back(static_cast<uint8_t>(word & 0xFF));
+    wire.push_back(static_cast<uint8_t>(word >> 8));
+  }
+
+  DropoutDetector values;
+  values.Process(samples.data(), samples.size());
+  DropoutDetector words;
+  words.ProcessWireBytes(wire.data(), wire.size());
+
+  EXPECT_EQ(words.Summary().event_count, 1U);
+  EXPECT_EQ(words.Summary().dropout_samples, values.Summary().dropout_samples);
+  EXPECT_EQ(words.Summary().last_start_sample,
+            values.Summary().last_start_sample);
+}
+
+TEST(DropoutDetectorTest, TheBlockIsTheSameLengthOfTimeAtEveryRate) {
+  DropoutDetector::Options options;
+  EXPECT_EQ(DropoutDetector(options).block_samples(), 32U);
+
+  options.sample_rate_hz = 10'000'000;
+  EXPECT_EQ(DropoutDetector(options).block_samples(), 8U);
+}
+
+}  // namespace
+}  // namespace ddd::capture
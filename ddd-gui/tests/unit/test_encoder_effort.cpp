@@ -0,0 +1,204 @@
+/************************************************************************
+
+    test_encoder_effort.cpp
+
+    T1 tests for stepping the encoder's effort with the ring's fill
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+#include "encoder_effort.h"
+
+namespace ddd::capture {
+namespace {
+
+// Readings well clear of both thresholds, so that each test says which side it
+// is on without depending on where exactly the line is.
+constexpr double kFillingRing = 0.8;
+constexpr double kEmptyRing = 0.0;
+
+TEST(EncoderEffortLadderTest, StepsDownFromTheConfiguredLevel) {
+  EXPECT_EQ(EncoderEffortLadder(8), (std::vector<int>{8, 5, 3, 0}));
+  EXPECT_EQ(EncoderEffortLadder(6), (std::vector<int>{6, 5, 3, 0}));
+  EXPECT_EQ(EncoderEffortLadder(5), (std::vector<int>{5, 3, 0}));
+  EXPECT_EQ(EncoderEffortLadder(3), (std::vector<int>{3, 0}));
+  EXPECT_EQ(EncoderEffortLadder(1), (std::vector<int>{1, 0}));
+}
+
+TEST(EncoderEffortLadderTest, TheFastestLevelHasNowhereToGo) {
+  EXPECT_EQ(EncoderEffortLadder(0), (std::vector<int>{0}));
+}
+
+TEST(EncoderEffortLadderTest, AnOutOfRangeLevelIsClampedFirst) {
+  EXPECT_EQ(EncoderEffortLadder(12), EncoderEffortLadder(8));
+  EXPECT_EQ(EncoderEffortLadder(-1), EncoderEffortLadder(0));
+}
+
+TEST(EncoderEffortControllerTest, AQuietCaptureIsLeftAlone) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+
+  for (double now = 0.0; now < 60.0; now += 0.1) {
+    EXPECT_FALSE(controller.Observe(now, kEmptyRing, 0.0).has_value());
+  }
+
+  const EncoderEffortSummary& summary = controller.summary();
+  EXPECT_TRUE(summary.adjustable);
+  EXPECT_EQ(summary.configured_level, 8);
+  EXPECT_EQ(summary.file_level, 8);
+  EXPECT_EQ(summary.advised_level, 8);
+  EXPECT_EQ(summary.advised_lower, 0U);
+}
+
+// A file's own level never moves. What the readings decide is the next file's.
+TEST(EncoderEffortControllerTest, AFillingRingLowersTheNextFileAtOnce) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 100.0);
+
+  EXPECT_EQ(controller.Observe(100.0, kFillingRing, 0.0),
+            std::optional<size_t>(1));
+  EXPECT_EQ(controller.summary().file_level, 8);
+  EXPECT_EQ(controller.summary().advised_level, 5);
+  EXPECT_EQ(controller.summary().advised_lower, 1U);
+}
+
+// The encoder falling behind is seen in what it holds before the ring shows it.
+TEST(EncoderEffortControllerTest, AGrowingBacklogLowersTheEffortToo) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+
+  EXPECT_EQ(controller.Observe(0.0, kEmptyRing, 1.5),
+            std::optional<size_t>(1));
+}
+
+// The readings behind one step are not counted again for the next.
+TEST(EncoderEffortControllerTest, StepsDownNoFasterThanTheInterval) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+
+  EXPECT_EQ(controller.Observe(0.0, kFillingRing, 0.0),
+            std::optional<size_t>(1));
+  EXPECT_FALSE(controller.Observe(0.5, kFillingRing, 0.0).has_value());
+  EXPECT_EQ(controller.Observe(1.0, kFillingRing, 0.0),
+            std::optional<size_t>(2));
+  EXPECT_EQ(controller.Observe(2.0, kFillingRing, 0.0),
+            std::optional<size_t>(3));
+
+  // The bottom of the ladder is as far as it goes.
+  EXPECT_FALSE(controller.Observe(3.0, kFillingRing, 0.0).has_value());
+  EXPECT_EQ(controller.summary().advised_level, 0);
+  EXPECT_EQ(controller.summary().advised_lower, 3U);
+}
+
+TEST(EncoderEffortControllerTest, RestoresOneStepAtATimeOnceItIsCalm) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+  controller.Observe(0.0, kFillingRing, 0.0);
+  controller.Observe(1.0, kFillingRing, 0.0);
+  ASSERT_EQ(controller.step(), 2U);
+
+  // Calm begins at 2 s; ten seconds of it earns one step and no more.
+  EXPECT_FALSE(controller.Observe(2.0, kEmptyRing, 0.0).has_value());
+  EXPECT_FALSE(controller.Observe(11.9, kEmptyRing, 0.0).has_value());
+  EXPECT_EQ(controller.Observe(12.0, kEmptyRing, 0.0),
+            std::optional<size_t>(1));
+  EXPECT_FALSE(controller.Observe(21.9, kEmptyRing, 0.0).has_value());
+  EXPECT_EQ(controller.Observe(22.0, kEmptyRing, 0.0),
+            std::optional<size_t>(0));
+
+  const EncoderEffortSummary& summary = controller.summary();
+  EXPECT_EQ(summary.advised_level, 8);
+  EXPECT_EQ(summary.advised_lower, 2U);
+  EXPECT_EQ(summary.advised_higher, 2U);
+}
+
+// A ring that drains for a moment in a busy period has not proved anything.
+TEST(EncoderEffortControllerTest, CalmThatIsInterruptedStartsAgain) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+  controller.Observe(0.0, kFillingRing, 0.0);
+
+  controller.Observe(1.0, kEmptyRing, 0.0);
+  controller.Observe(9.0, kEmptyRing, 0.0);
+
+  // Between the thresholds: not pressure, but not calm either.
+  controller.Observe(10.0, 0.3, 0.0);
+
+  EXPECT_FALSE(controller.Observe(11.0, kEmptyRing, 0.0).has_value());
+  EXPECT_FALSE(controller.Observe(20.9, kEmptyRing, 0.0).has_value());
+  EXPECT_EQ(controller.Observe(21.0, kEmptyRing, 0.0),
+            std::optional<size_t>(0));
+}
+
+// The next file carries on from where the last one's readings left it, and a
+// calm one earns its way back up from there.
+TEST(EncoderEffortControllerTest, AFileOpenedLowerStartsFromItsOwnStep) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+  controller.Observe(0.0, kFillingRing, 0.0);
+  controller.Observe(1.0, kFillingRing, 0.0);
+  controller.End();
+  ASSERT_EQ(controller.step(), 2U);
+
+  controller.Begin(EncoderEffortLadder(8), controller.step(), 5.0);
+  EXPECT_EQ(controller.summary().file_level, 3);
+  EXPECT_EQ(controller.summary().advised_level, 3);
+  EXPECT_EQ(controller.summary().advised_lower, 0U);
+
+  EXPECT_FALSE(controller.Observe(5.0, kEmptyRing, 0.0).has_value());
+  EXPECT_EQ(controller.Observe(15.0, kEmptyRing, 0.0),
+            std::optional<size_t>(1));
+  EXPECT_EQ(controller.summary().file_level, 3);
+  EXPECT_EQ(controller.summary().advised_level, 5);
+}
+
+// A step past the ladder's end, as after the configured level was changed to
+// one with a shorter ladder, opens at its lowest level.
+TEST(EncoderEffortControllerTest, AStepPastTheLadderIsItsLastLevel) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(3), 3, 0.0);
+
+  EXPECT_EQ(controller.step(), 1U);
+  EXPECT_EQ(controller.summary().file_level, 0);
+}
+
+TEST(EncoderEffortControllerTest, NothingChangesOnceEnded) {
+  EncoderEffortController controller;
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+  controller.Observe(2.0, kFillingRing, 0.0);
+  controller.End();
+
+  EXPECT_FALSE(controller.active());
+  EXPECT_FALSE(controller.Observe(20.0, kFillingRing, 0.0).has_value());
+  EXPECT_EQ(controller.summary().advised_level, 5);
+  EXPECT_EQ(controller.summary().advised_lower, 1U);
+}
+
+TEST(EncoderEffortControllerTest, ASinkWithNothingToAdjustIsNeverAsked) {
+  EncoderEffortController controller;
+  controller.Begin({}, 0, 0.0);
+
+  EXPECT_FALSE(controller.active());
+  EXPECT_FALSE(controller.Observe(1.0, 1.0, 10.0).has_value());
+  EXPECT_FALSE(controller.summary().adjustable);
+}
+
+TEST(EncoderEffortControllerTest, TheThresholdsCanBeChosen) {
+  EncoderEffortController::Thresholds thresholds;
+  thresholds.lower_ring_fraction = 0.9;
+  EncoderEffortController controller(thresholds);
+  controller.Begin(EncoderEffortLadder(8), 0, 0.0);
+
+  EXPECT_FALSE(controller.Observe(0.0, kFillingRing, 0.0).has_value());
+  EXPECT_TRUE(controller.Observe(0.0, 0.95, 0.0).has_value());
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -20,12 +20,12 @@
 namespace ddd::capture {
 namespace {
 
-// The geometry the application gateware reports: a 16384-word FIFO offered to
-// the FX3 in 8192-word packets, with the near-full mark three quarters up.
-// These are the figures every percentage below is relative to.
-constexpr uint16_t kDepth = 16384;
+// The geometry the application gateware reports: a 24576-word FIFO offered to
+// the FX3 in 8192-word packets, with the near-full mark half way up the
+// headroom. These are the figures every percentage below is relative to.
+constexpr uint16_t kDepth = 24576;
 constexpr uint16_t kPacket = 8192;
-constexpr uint16_t kNearFull = 12288;
+constexpr uint16_t kNearFull = 16384;
 
 void PutWord(std::vector<uint8_t>& block, size_t offset, uint16_t value) {
   block[offset] = static_cast<uint8_t>(value & 0xFF);
@@ -35,7 +35,9 @@ void PutWord(std::vector<uint8_t>& block, size_t offset, uint16_t value) {
 // A block as the register read returns one, with a healthy capture in it.
 std::vector<uint8_t> MakeBlock(uint16_t peak, uint16_t overflows = 0,
                                uint16_t dropped = 0,
-                               uint8_t status = kTelemetryFormat) {
+                               uint8_t status = kTelemetryFormat,
+                               uint16_t depth = kDepth,
+                               uint16_t near_full = kNearFull) {
   std::vector<uint8_t> block(kTelemetryBlockLength, 0);
 
   block[0] = kTelemetryIdValue;
@@ -50,9 +52,9 @@ std::vector<uint8_t> MakeBlock(uint16_t peak, uint16_t overflows = 0,
   PutWord(block, kTelemetryOffsetPackets, 1221);
   PutWord(block, kTelemetryOffsetNearFull, 0);
 
-  PutWord(block, kTelemetryOffsetDepth, kDepth);
+  PutWord(block, kTelemetryOffsetDepth, depth);
   PutWord(block, kTelemetryOffsetPacketWords, kPacket);
-  PutWord(block, kTelemetryOffsetNearFullWords, kNearFull);
+  PutWord(block, kTelemetryOffsetNearFullWords, near_full);
 
   return block;
 }
@@ -145,7 +147,20 @@ TEST(FpgaTelemetryTest, HalfTheHeadroomIsHalfTheScale) {
   const FpgaTelemetry telemetry = ParseFpgaTelemetry(MakeBlock(kNearFull));
 
   EXPECT_EQ(telemetry.BackPressurePercent(), 50);
-  EXPECT_EQ(telemetry.PeakPercentOfDepth(), 75);
+  EXPECT_EQ(telemetry.PeakPercentOfDepth(), 66);
+}
+
+// The scale is the device's geometry, never this build's. An image from before
+// the FIFO was deepened reports 16384 words, and the same peak means twice the
+// pressure there: half its headroom is what the deeper FIFO calls a quarter.
+TEST(FpgaTelemetryTest, AShallowerFifoIsReadByItsOwnGeometry) {
+  const FpgaTelemetry shallow = ParseFpgaTelemetry(
+      MakeBlock(12288, 0, 0, kTelemetryFormat, 16384, 12288));
+  const FpgaTelemetry deep = ParseFpgaTelemetry(MakeBlock(12288));
+
+  EXPECT_EQ(shallow.depth_words, 16384);
+  EXPECT_EQ(shallow.BackPressurePercent(), 50);
+  EXPECT_EQ(deep.BackPressurePercent(), 25);
 }
 
 TEST(FpgaTelemetryTest, AFullBufferIsTheTopOfTheScale) {
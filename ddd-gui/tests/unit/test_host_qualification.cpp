@@ -0,0 +1,286 @@
+/************************************************************************
+
+    test_host_qualification.cpp
+
+    T1 tests for measuring a capture host and what the measurements imply
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "disk_buffer_ring.h"
+#include "host_qualification.h"
+#include "sample_format.h"
+#include "sequence_validator.h"
+
+namespace ddd::capture {
+namespace {
+
+constexpr double kRate = kSampleRateHz;
+constexpr double kWireBytes = kRate * kBytesPerSample;
+
+// A host comfortably able to capture: a disk three times the wire rate that
+// never stalls for more than 50 ms, and a validator ten times the sample rate.
+QualificationMeasurements ComfortableHost() {
+  QualificationMeasurements measurements;
+  measurements.write.ok = true;
+  measurements.write.bytes_per_second = 3.0 * kWireBytes;
+  measurements.write.latency.worst_seconds = 0.05;
+  measurements.validator_samples_per_second = 10.0 * kRate;
+  return measurements;
+}
+
+EncodeProbeResult Encode(int level, unsigned int threads, double headroom,
+                         double ratio = 0.3) {
+  EncodeProbeResult encode;
+  encode.compression_level = level;
+  encode.threads = threads;
+  encode.ok = true;
+  encode.samples_per_second = headroom * kRate;
+  encode.compression_ratio = ratio;
+  return encode;
+}
+
+TEST(HostQualificationTest, TheHighestLevelThatKeepsUpIsChosen) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 1.2), Encode(5, 1, 2.0),
+                          Encode(2, 1, 4.0)};
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  ASSERT_TRUE(result.qualified) << result.reason;
+  EXPECT_EQ(result.compression_level, 5);
+  EXPECT_DOUBLE_EQ(result.encode_headroom, 2.0);
+}
+
+// Threads the encoder does not need are the rest of the machine's.
+TEST(HostQualificationTest, TheFewestThreadsThatManageItAreChosen) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 8, 6.0), Encode(8, 1, 0.9),
+                          Encode(8, 4, 4.0), Encode(8, 2, 1.6)};
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  ASSERT_TRUE(result.qualified) << result.reason;
+  EXPECT_EQ(result.compression_level, 8);
+  EXPECT_EQ(result.encoder_threads, 2U);
+}
+
+// A fast encoder is no use if the file it produces is more than the disk
+// takes: at a ratio of 0.8 the disk's 1.0x of the wire rate is 1.25x of the
+// file, short of the margin, while level 8's 0.3 leaves it 3.3x.
+TEST(HostQualificationTest, TheDiskHasToTakeWhatTheLevelProduces) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.write.bytes_per_second = kWireBytes;
+  measurements.encodes = {Encode(8, 1, 0.5, 0.3), Encode(0, 1, 8.0, 0.8)};
+
+  QualificationResult result = RecommendQualifiedSettings(measurements);
+  EXPECT_FALSE(result.qualified);
+
+  measurements.encodes.push_back(Encode(5, 4, 2.0, 0.31));
+  result = RecommendQualifiedSettings(measurements);
+  ASSERT_TRUE(result.qualified) << result.reason;
+  EXPECT_EQ(result.compression_level, 5);
+  EXPECT_NEAR(result.write_headroom, 1.0 / 0.31, 1e-9);
+}
+
+// When nothing passes, the figures are the nearest the machine came — the ones
+// that say how far off it is.
+TEST(HostQualificationTest, AHostThatCannotKeepUpIsToldHowCloseItCame) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 0.6), Encode(0, 1, 1.1)};
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  EXPECT_FALSE(result.qualified);
+  EXPECT_EQ(result.compression_level, 0);
+  EXPECT_NE(result.reason.find("encoder"), std::string::npos) << result.reason;
+}
+
+TEST(HostQualificationTest, AFailedEncodeIsNotAConfiguration) {
+  QualificationMeasurements measurements = ComfortableHost();
+  EncodeProbeResult failed = Encode(8, 8, 100.0);
+  failed.ok = false;
+  measurements.encodes = {failed, Encode(6, 1, 2.0)};
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  ASSERT_TRUE(result.qualified) << result.reason;
+  EXPECT_EQ(result.compression_level, 6);
+
+  measurements.encodes = {failed};
+  EXPECT_FALSE(RecommendQualifiedSettings(measurements).qualified);
+}
+
+TEST(HostQualificationTest, AnUncompressedCaptureIsMeasuredAgainstTheWireRate) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.output_format = CaptureOutputFormat::kSigned16Bit;
+  measurements.write.bytes_per_second = 1.2 * kWireBytes;
+
+  QualificationResult result = RecommendQualifiedSettings(measurements);
+  EXPECT_FALSE(result.qualified);
+  EXPECT_DOUBLE_EQ(result.write_headroom, 1.2);
+
+  measurements.write.bytes_per_second = 2.0 * kWireBytes;
+  result = RecommendQualifiedSettings(measurements);
+  EXPECT_TRUE(result.qualified) << result.reason;
+}
+
+TEST(HostQualificationTest, ASlowValidatorDisqualifiesTheHost) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 4.0)};
+  measurements.validator_samples_per_second = 1.1 * kRate;
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  EXPECT_FALSE(result.qualified);
+  EXPECT_NE(result.reason.find("Checking"), std::string::npos) << result.reason;
+}
+
+// 64 MiB at 80 MB/s is 0.84 s; a 0.3 s stall with a margin of four needs
+// 1.2 s, which 128 MiB's 1.68 s covers.
+TEST(HostQualificationTest, TheSmallestQueueThatCoversTheStallIsChosen) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 4.0)};
+  measurements.write.latency.worst_seconds = 0.3;
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  ASSERT_TRUE(result.qualified) << result.reason;
+  EXPECT_EQ(result.queue_size_bytes, size_t{128} << 20);
+  EXPECT_NEAR(result.stall_tolerance_seconds,
+              static_cast<double>(size_t{128} << 20) / kWireBytes, 1e-9);
+  EXPECT_DOUBLE_EQ(result.worst_stall_seconds, 0.3);
+}
+
+TEST(HostQualificationTest, AStallNoQueueCoversDisqualifiesTheHost) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 4.0)};
+  measurements.write.latency.worst_seconds = 2.0;
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  EXPECT_FALSE(result.qualified);
+  EXPECT_EQ(result.queue_size_bytes, DiskBufferRing::kMaximumQueueSizeBytes);
+  EXPECT_NE(result.reason.find("stalled"), std::string::npos) << result.reason;
+}
+
+TEST(HostQualificationTest, AnUnmeasuredDiskIsNotQualified) {
+  QualificationMeasurements measurements = ComfortableHost();
+  measurements.encodes = {Encode(8, 1, 4.0)};
+  measurements.write.ok = false;
+  measurements.write.error = "Could not create a file in /nowhere.";
+
+  const QualificationResult result = RecommendQualifiedSettings(measurements);
+
+  EXPECT_FALSE(result.qualified);
+  EXPECT_EQ(result.reason, measurements.write.error);
+}
+
+// The sizes the settings dialog offers, and nothing in between.
+TEST(HostQualificationTest, TheQueueSizesAreTheOnesTheSettingsOffer) {
+  const std::vector<size_t> sizes = QualificationQueueSizes();
+  ASSERT_FALSE(sizes.empty());
+  EXPECT_EQ(sizes.front(), DiskBufferRing::kMinimumQueueSizeBytes);
+  EXPECT_EQ(sizes.back(), DiskBufferRing::kMaximumQueueSizeBytes);
+  EXPECT_TRUE(std::is_sorted(sizes.begin(), sizes.end()));
+}
+
+TEST(HostQualificationTest, TheLatencyTailIsMadeOfMeasuredValues) {
+  std::vector<double> latencies(1000, 0.001);
+  latencies[500] = 0.25;
+  latencies[10] = 0.01;
+
+  const WriteLatencySummary summary = SummariseWriteLatencies(latencies);
+
+  EXPECT_DOUBLE_EQ(summary.median_seconds, 0.001);
+  EXPECT_DOUBLE_EQ(summary.p99_seconds, 0.001);
+  EXPECT_DOUBLE_EQ(summary.p999_seconds, 0.01);
+  EXPECT_DOUBLE_EQ(summary.worst_seconds, 0.25);
+  EXPECT_DOUBLE_EQ(SummariseWriteLatencies({}).worst_seconds, 0.0);
+}
+
+// The probes are fed what the device sends, counters included: a validator
+// that failed on the generated RF would be measuring its own failure path.
+TEST(HostQualificationTest, TheGeneratedRfCarriesTheDevicesCounters) {
+  std::vector<uint8_t> data(kSamplesPerSequenceCounter * 3 * kBytesPerSample);
+  GenerateQualificationRf(data, kSampleRateHz, 1000);
+
+  SequenceValidator validator;
+  const SequenceValidator::Outcome outcome =
+      validator.Process(data.data(), data.size());
+
+  EXPECT_TRUE(outcome.ok);
+  EXPECT_EQ(validator.state(), SequenceState::kRunning);
+}
+
+// Busy across the converter's range rather than sitting on a few codes, which
+// is what would make it compress better than a disc.
+TEST(HostQualificationTest, TheGeneratedRfIsDeterministicAndBusy) {
+  std::vector<uint8_t> first(65536 * kBytesPerSample);
+  std::vector<uint8_t> second(first.size());
+  GenerateQualificationRf(first, kSampleRateHz);
+  GenerateQualificationRf(second, kSampleRateHz);
+  EXPECT_EQ(first, second);
+
+  std::vector<bool> seen(kMaximumSampleValue + 1, false);
+  for (size_t index = 0; index < first.size(); index += kBytesPerSample) {
+    const auto word =
+        static_cast<uint16_t>(first[index] | (first[index + 1] << 8));
+    seen[SampleValueFromWord(word)] = true;
+  }
+  EXPECT_GT(std::count(seen.begin(), seen.end(), true), 500);
+}
+
+TEST(HostQualificationTest, AShortWriteProbeMeasuresAndCleansUp) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "ddd-qualify-test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  WriteProbeOptions options;
+  options.duration_seconds = 0.2;
+  options.maximum_bytes = 8 * (size_t{64} << 10);
+  options.block_bytes = size_t{64} << 10;
+  options.sync_bytes = 3 * options.block_bytes;
+  const WriteProbeResult result = ProbeWriteBandwidth(directory, options);
+
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_GT(result.bytes, 0U);
+  EXPECT_LE(result.bytes, options.maximum_bytes);
+  EXPECT_GT(result.bytes_per_second, 0.0);
+  EXPECT_GE(result.latency.worst_seconds, result.latency.median_seconds);
+  EXPECT_TRUE(std::filesystem::is_empty(directory));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(HostQualificationTest, AMissingDirectoryIsAnErrorNotACrash) {
+  WriteProbeOptions options;
+  options.duration_seconds = 0.1;
+  const WriteProbeResult result = ProbeWriteBandwidth(
+      std::filesystem::temp_directory_path() / "ddd-qualify-missing" / "deeper",
+      options);
+
+  EXPECT_FALSE(result.ok);
+  EXPECT_FALSE(result.error.empty());
+}
+
+TEST(HostQualificationTest, TheValidatorProbeMeasuresARate) {
+  std::vector<uint8_t> data(kSamplesPerSequenceCounter * 2 * kBytesPerSample);
+  GenerateQualificationRf(data, kSampleRateHz);
+
+  EXPECT_GT(ProbeValidatorThroughput(data, 0.05), 0.0);
+  EXPECT_DOUBLE_EQ(ProbeValidatorThroughput({}, 0.05), 0.0);
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -52,6 +52,14 @@ TEST(FormatDecimalTest, WritesSomethingThatIsNotANumberAsZero) {
   EXPECT_EQ(FormatDecimal(1.0 / 0.0, 1), "0.0");
 }
 
+TEST(FormatHexTest, WritesLowercaseDigitsPaddedToTheWidth) {
+  EXPECT_EQ(FormatHex(0xB4, 2), "0xb4");
+  EXPECT_EQ(FormatHex(0x0A, 2), "0x0a");
+  EXPECT_EQ(FormatHex(0, 2), "0x00");
+  EXPECT_EQ(FormatHex(0x12345, 2), "0x12345");
+  EXPECT_EQ(FormatHex(0xFFFFFFFFFFFFFFFF, 0), "0xffffffffffffffff");
+}
+
 TEST(FormatBytesTest, ClimbsThroughTheBinaryUnits) {
   EXPECT_EQ(FormatBytes(0), "0 B");
   EXPECT_EQ(FormatBytes(512), "512 B");
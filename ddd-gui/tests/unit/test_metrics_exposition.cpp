@@ -0,0 +1,240 @@
+/************************************************************************
+
+    test_metrics_exposition.cpp
+
+    T1 tests for the page a metrics scraper reads
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "metrics_exposition.h"
+
+namespace ddd::capture {
+namespace {
+
+// The value of the one series with this name and these labels, or NaN when the
+// page has none — or more than one, which the format does not allow.
+double SeriesValue(const std::string& page, const std::string& series) {
+  std::istringstream lines(page);
+  std::string line;
+  double value = std::numeric_limits<double>::quiet_NaN();
+  int found = 0;
+  while (std::getline(lines, line)) {
+    if (line.rfind(series + " ", 0) == 0) {
+      value = std::stod(line.substr(series.size() + 1));
+      ++found;
+    }
+  }
+  return found == 1 ? value : std::numeric_limits<double>::quiet_NaN();
+}
+
+bool HasMetric(const std::string& page, const std::string& name) {
+  return page.find("# TYPE " + name + " ") != std::string::npos;
+}
+
+CaptureStats RunningStats() {
+  CaptureStats stats;
+  stats.elapsed_seconds = 12.5;
+  stats.throughput_bytes_per_second = 80'000'000.0;
+  stats.transfers_completed = 300;
+  stats.buffers_processed = 290;
+  stats.bytes_written = 1'000'000;
+  stats.samples_written = 500'000;
+  stats.samples_pending = 40'000;
+  stats.writing = true;
+  stats.slots_in_use = 2;
+  stats.peak_slots_in_use = 5;
+  stats.slot_count = 16;
+  stats.device_overflow_events = 1;
+  stats.device_dropped_words = 512;
+  stats.metrics.rms = 120.5;
+  stats.metrics.recent_rms = 118.0;
+  stats.metrics.clipped_low_count = 7;
+  stats.metrics.clipped_high_count = 9;
+  stats.dropouts.event_count = 3;
+  return stats;
+}
+
+TEST(MetricsExpositionTest, EveryMetricHasItsHelpAndTypeBeforeItsSeries) {
+  CaptureMetrics metrics;
+  const std::string page = metrics.Format(RunningStats(), MetricsContext{});
+
+  // Walk the page: a series line must belong to the metric whose TYPE line
+  // came last, allowing for a histogram's suffixes.
+  std::istringstream lines(page);
+  std::string line;
+  std::string current;
+  int series = 0;
+  while (std::getline(lines, line)) {
+    ASSERT_FALSE(line.empty());
+    if (line.rfind("# HELP ", 0) == 0) {
+      continue;
+    }
+    if (line.rfind("# TYPE ", 0) == 0) {
+      current = line.substr(7, line.find(' ', 7) - 7);
+      continue;
+    }
+    ASSERT_FALSE(current.empty()) << line;
+    EXPECT_EQ(line.rfind(current, 0), 0U) << line << " under " << current;
+    ++series;
+  }
+  EXPECT_GT(series, 20);
+  EXPECT_EQ(page.back(), '\n');
+}
+
+TEST(MetricsExpositionTest, TheStatsBlockIsCarriedThrough) {
+  CaptureMetrics metrics;
+  MetricsContext context;
+  context.running = true;
+  const std::string page = metrics.Format(RunningStats(), context);
+
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_running"), 1.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_writing"), 1.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_throughput_bytes_per_second"),
+            80'000'000.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_written_bytes_total"), 1'000'000);
+  EXPECT_EQ(SeriesValue(page, "ddd_sink_pending_samples"), 40'000);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_slots_in_use"), 2);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_slots_in_use_peak"), 5);
+  EXPECT_EQ(SeriesValue(page, "ddd_device_dropped_words_total"), 512);
+  EXPECT_EQ(SeriesValue(page, "ddd_signal_recent_rms"), 118.0);
+  EXPECT_EQ(
+      SeriesValue(page, "ddd_signal_clipped_samples_total{edge=\"high\"}"),
+      9.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_signal_dropouts_total"), 3.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_result{result=\"running\"}"), 1.0);
+}
+
+// A run that has ended leaves its figures behind, and the page goes on showing
+// them — but says they are no longer moving.
+TEST(MetricsExpositionTest, AnEndedRunSaysSo) {
+  CaptureMetrics metrics;
+  CaptureStats stats = RunningStats();
+  stats.result = TransferResult::kSuccess;
+
+  const std::string page = metrics.Format(stats, MetricsContext{});
+
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_running"), 0.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_result{result=\"success\"}"), 1.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_capture_written_bytes_total"), 1'000'000);
+}
+
+TEST(MetricsExpositionTest, TheRingHistogramIsCumulative) {
+  CaptureMetrics metrics;
+  CaptureStats stats;
+  stats.slot_count = 100;
+  for (const size_t in_use : {0, 1, 3, 40, 100}) {
+    stats.slots_in_use = in_use;
+    metrics.Observe(stats);
+  }
+
+  const std::string page = metrics.Format(stats, MetricsContext{});
+
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_bucket{le=\"1\"}"), 2.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_bucket{le=\"5\"}"), 3.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_bucket{le=\"50\"}"), 4.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_bucket{le=\"100\"}"),
+            5.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_bucket{le=\"+Inf\"}"),
+            5.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_count"), 5.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_ring_depth_percent_sum"), 144.0);
+}
+
+// A source with no buffer instrument has not measured a back pressure of zero,
+// and neither the histogram nor the gauges may say it did.
+TEST(MetricsExpositionTest, NoInstrumentRecordsNoBackPressure) {
+  CaptureMetrics metrics;
+  CaptureStats stats = RunningStats();
+  metrics.Observe(stats);
+
+  EXPECT_EQ(metrics.back_pressure().count(), 0U);
+  EXPECT_EQ(metrics.ring_depth().count(), 1U);
+
+  const std::string page = metrics.Format(stats, MetricsContext{});
+  EXPECT_FALSE(HasMetric(page, "ddd_device_buffer_used_words"));
+  EXPECT_TRUE(HasMetric(page, "ddd_device_back_pressure_percent"));
+}
+
+TEST(MetricsExpositionTest, AnInstrumentedDeviceReportsItsBuffer) {
+  CaptureMetrics metrics;
+  CaptureStats stats = RunningStats();
+  stats.device_buffer.present = true;
+  stats.device_buffer.used_now = 4000;
+  stats.device_buffer.depth_words = 16384;
+  stats.peak_back_pressure_percent = 12;
+  metrics.Observe(stats);
+
+  EXPECT_EQ(metrics.back_pressure().count(), 1U);
+
+  const std::string page = metrics.Format(stats, MetricsContext{});
+  EXPECT_EQ(SeriesValue(page, "ddd_device_buffer_used_words"), 4000.0);
+  EXPECT_EQ(SeriesValue(page, "ddd_device_back_pressure_peak_percent"), 12.0);
+}
+
+TEST(MetricsExpositionTest, LatencyIsQueueDepthOverTheSampleRate) {
+  CaptureStats stats = RunningStats();
+  stats.device_buffer.present = true;
+  stats.device_buffer.used_now = 8000;
+  MetricsContext context;
+  context.sample_rate_hz = 40'000'000.0;
+  context.ring_slot_samples = 1'000'000;
+
+  const StageLatency latency = StageLatencyFrom(stats, context);
+
+  EXPECT_DOUBLE_EQ(latency.device_seconds, 8000.0 / 40e6);
+  EXPECT_DOUBLE_EQ(latency.ring_seconds, 2.0 * 1e6 / 40e6);
+  EXPECT_DOUBLE_EQ(latency.sink_seconds, 40'000.0 / 40e6);
+
+  CaptureMetrics metrics;
+  const std::string page = metrics.Format(stats, context);
+  EXPECT_DOUBLE_EQ(
+      SeriesValue(page, "ddd_stage_latency_seconds{stage=\"ring\"}"), 0.05);
+}
+
+// Without a rate there is nothing to divide by, and a page of zeroes would
+// read as a pipeline with no delay in it at all.
+TEST(MetricsExpositionTest, NoRateLeavesTheLatenciesOff) {
+  CaptureMetrics metrics;
+  const std::string page = metrics.Format(RunningStats(), MetricsContext{});
+
+  EXPECT_FALSE(HasMetric(page, "ddd_stage_latency_seconds"));
+}
+
+TEST(MetricsExpositionTest, OnlyThreadsThatWereMeasuredAreListed) {
+  CaptureStats stats = RunningStats();
+  stats.threads.transfer.present = true;
+  stats.threads.transfer.user_seconds = 1.5;
+  stats.threads.transfer.system_seconds = 0.25;
+
+  CaptureMetrics metrics;
+  const std::string page = metrics.Format(stats, MetricsContext{});
+
+  EXPECT_EQ(
+      SeriesValue(page, "ddd_thread_cpu_seconds_total{role=\"transfer\"}"),
+      1.75);
+  EXPECT_EQ(page.find("role=\"encoder\""), std::string::npos);
+}
+
+TEST(MetricsExpositionTest, ValuesAreSpelledTheWayTheFormatReadsThem) {
+  EXPECT_EQ(FormatMetricValue(0.1), "0.1");
+  EXPECT_EQ(FormatMetricValue(25.0), "25");
+  EXPECT_EQ(FormatMetricValue(std::numeric_limits<double>::infinity()),
+            "+Inf");
+  EXPECT_EQ(FormatMetricValue(-std::numeric_limits<double>::infinity()),
+            "-Inf");
+  EXPECT_EQ(FormatMetricValue(std::nan("")), "NaN");
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -0,0 +1,366 @@
+/************************************************************************
+
+    test_monitor_protocol.cpp
+
+    T1 tests for the remote monitor's frames and the queue they wait in
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "monitor_protocol.h"
+
+namespace ddd::capture {
+namespace {
+
+MonitorFrame DecodeWhole(const std::vector<uint8_t>& bytes) {
+  MonitorFrame frame;
+  size_t consumed = 0;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kFrame);
+  EXPECT_EQ(consumed, bytes.size());
+  return frame;
+}
+
+std::vector<uint8_t> WaveformFrame(uint16_t level) {
+  MonitorWaveform waveform;
+  waveform.sample_span = 100;
+  waveform.minimum = {level};
+  waveform.maximum = {level};
+  std::vector<uint8_t> bytes;
+  EncodeMonitorWaveform(waveform, bytes);
+  return bytes;
+}
+
+std::vector<uint8_t> StatsFrame(uint64_t bytes_written) {
+  MonitorStats stats;
+  stats.bytes_written = bytes_written;
+  std::vector<uint8_t> bytes;
+  EncodeMonitorStats(stats, bytes);
+  return bytes;
+}
+
+std::vector<uint8_t> ReplyFrame(const std::string& json) {
+  std::vector<uint8_t> bytes;
+  EncodeMonitorReply(json, bytes);
+  return bytes;
+}
+
+TEST(MonitorProtocolTest, TheHeaderIsLaidOutAsDocumented) {
+  const std::vector<uint8_t> bytes = ReplyFrame("{}");
+
+  ASSERT_EQ(bytes.size(), kMonitorFrameHeaderBytes + 2);
+  EXPECT_EQ(bytes[0], static_cast<uint8_t>(MonitorFrameType::kReply));
+  EXPECT_EQ(bytes[1], kMonitorProtocolVersion);
+  EXPECT_EQ(bytes[2] | bytes[3] | bytes[4] | bytes[5], 0);
+
+  // The length, little-endian
+  EXPECT_EQ(bytes[6], 2);
+  EXPECT_EQ(bytes[7] | bytes[8] | bytes[9], 0);
+}
+
+TEST(MonitorProtocolTest, StatsSurviveTheRoundTrip) {
+  MonitorStats stats;
+  stats.result = TransferResult::kSuccess;
+  stats.sequence_state = SequenceState::kRunning;
+  stats.writing = true;
+  stats.elapsed_seconds = 1234.5;
+  stats.throughput_bytes_per_second = 80'000'000.25;
+  stats.bytes_written = 0x0123'4567'89AB'CDEFULL;
+  stats.samples_written = 40'000'000;
+  stats.slots_in_use = 3;
+  stats.slot_count = 256;
+  stats.device_overflow_events = 2;
+  stats.device_dropped_words = 4096;
+  stats.dropout_events = 17;
+  stats.recent_minimum_value = 12;
+  stats.recent_maximum_value = 1011;
+  stats.recent_clipped_low_count = 5;
+  stats.recent_clipped_high_count = 6;
+  stats.recent_rms = 143.75;
+
+  std::vector<uint8_t> bytes;
+  EncodeMonitorStats(stats, bytes);
+  const MonitorFrame frame = DecodeWhole(bytes);
+
+  EXPECT_EQ(frame.type, MonitorFrameType::kStats);
+  EXPECT_EQ(frame.stats, stats);
+}
+
+TEST(MonitorProtocolTest, StatsAreTakenFromTheCaptureStats) {
+  CaptureStats stats;
+  stats.bytes_written = 1000;
+  stats.slots_in_use = 4;
+  stats.dropouts.event_count = 9;
+  stats.metrics.recent_maximum_value = 900;
+  stats.metrics.recent_rms = 88.0;
+
+  const MonitorStats monitor = MonitorStatsFrom(stats);
+  EXPECT_EQ(monitor.bytes_written, 1000U);
+  EXPECT_EQ(monitor.slots_in_use, 4U);
+  EXPECT_EQ(monitor.dropout_events, 9U);
+  EXPECT_EQ(monitor.recent_maximum_value, 900);
+  EXPECT_DOUBLE_EQ(monitor.recent_rms, 88.0);
+}
+
+TEST(MonitorProtocolTest, ASpectrumAndAWaveformSurviveTheRoundTrip) {
+  MonitorSpectrum spectrum;
+  spectrum.bin_width_hz = 9765.625;
+  spectrum.centi_db = {-12000, -3456, 0, 250};
+  std::vector<uint8_t> bytes;
+  EncodeMonitorSpectrum(spectrum, bytes);
+
+  MonitorFrame frame = DecodeWhole(bytes);
+  EXPECT_EQ(frame.type, MonitorFrameType::kSpectrum);
+  EXPECT_DOUBLE_EQ(frame.spectrum.bin_width_hz, 9765.625);
+  EXPECT_EQ(frame.spectrum.centi_db, spectrum.centi_db);
+
+  MonitorWaveform waveform;
+  waveform.sample_span = 8000;
+  waveform.minimum = {100, 200, 0};
+  waveform.maximum = {900, 800, 1023};
+  bytes.clear();
+  EncodeMonitorWaveform(waveform, bytes);
+
+  frame = DecodeWhole(bytes);
+  EXPECT_EQ(frame.type, MonitorFrameType::kWaveform);
+  EXPECT_EQ(frame.waveform.sample_span, 8000U);
+  EXPECT_EQ(frame.waveform.minimum, waveform.minimum);
+  EXPECT_EQ(frame.waveform.maximum, waveform.maximum);
+}
+
+TEST(MonitorProtocolTest, APartFrameIsIncompleteAtEveryLength) {
+  const std::vector<uint8_t> bytes = WaveformFrame(512);
+
+  for (size_t length = 0; length < bytes.size(); ++length) {
+    MonitorFrame frame;
+    size_t consumed = 99;
+    EXPECT_EQ(DecodeMonitorFrame(std::span(bytes.data(), length), frame,
+                                 consumed),
+              MonitorDecodeStatus::kIncomplete)
+        << length;
+    EXPECT_EQ(consumed, 0U);
+  }
+}
+
+TEST(MonitorProtocolTest, FramesBackToBackAreTakenOneAtATime) {
+  std::vector<uint8_t> stream = StatsFrame(1);
+  const std::vector<uint8_t> second = ReplyFrame("{\"ok\":true}");
+  stream.insert(stream.end(), second.begin(), second.end());
+
+  MonitorFrame frame;
+  size_t consumed = 0;
+  ASSERT_EQ(DecodeMonitorFrame(stream, frame, consumed),
+            MonitorDecodeStatus::kFrame);
+  EXPECT_EQ(frame.type, MonitorFrameType::kStats);
+
+  ASSERT_EQ(DecodeMonitorFrame(std::span(stream).subspan(consumed), frame,
+                               consumed),
+            MonitorDecodeStatus::kFrame);
+  EXPECT_EQ(frame.reply, "{\"ok\":true}");
+}
+
+TEST(MonitorProtocolTest, WhatThisServerWouldNeverSendIsMalformed) {
+  MonitorFrame frame;
+  size_t consumed = 0;
+
+  std::vector<uint8_t> bytes = ReplyFrame("{}");
+  bytes[1] = kMonitorProtocolVersion + 1;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kMalformed);
+
+  bytes = ReplyFrame("{}");
+  bytes[0] = 0x7F;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kMalformed);
+
+  // A length past the limit is refused on the header alone, rather than
+  // waited for
+  bytes = ReplyFrame("{}");
+  bytes[9] = 0x40;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kMalformed);
+
+  // A stats payload one byte short
+  bytes = StatsFrame(1);
+  bytes.pop_back();
+  bytes[6] -= 1;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kMalformed);
+
+  // A waveform claiming more columns than it carries
+  bytes = WaveformFrame(1);
+  bytes[kMonitorFrameHeaderBytes + 4] = 2;
+  EXPECT_EQ(DecodeMonitorFrame(bytes, frame, consumed),
+            MonitorDecodeStatus::kMalformed);
+  EXPECT_EQ(consumed, 0U);
+}
+
+TEST(MonitorProtocolTest, AReducedSpectrumKeepsEachGroupsPeak) {
+  std::vector<double> levels(1000, -90.0);
+  levels[437] = -12.345;
+
+  std::vector<int16_t> reduced;
+  ReduceMonitorSpectrum(levels, 100, reduced);
+
+  ASSERT_EQ(reduced.size(), 100U);
+  EXPECT_EQ(reduced[43], -1235);
+  EXPECT_EQ(reduced[42], -9000);
+  EXPECT_EQ(reduced[44], -9000);
+}
+
+TEST(MonitorProtocolTest, AskingForEveryBinOrMoreSendsThemAll) {
+  const std::vector<double> levels = {-1.0, -2.0, -3.0};
+  std::vector<int16_t> reduced;
+
+  ReduceMonitorSpectrum(levels, 0, reduced);
+  EXPECT_EQ(reduced, (std::vector<int16_t>{-100, -200, -300}));
+
+  ReduceMonitorSpectrum(levels, 10, reduced);
+  EXPECT_EQ(reduced.size(), 3U);
+}
+
+TEST(MonitorProtocolTest, LevelsOutsideTheRangeAreHeldAtItsEdges) {
+  const std::vector<double> levels = {
+      -std::numeric_limits<double>::infinity(), 1e6,
+      std::numeric_limits<double>::quiet_NaN()};
+  std::vector<int16_t> reduced;
+  ReduceMonitorSpectrum(levels, 0, reduced);
+
+  EXPECT_EQ(reduced[0], std::numeric_limits<int16_t>::min());
+  EXPECT_EQ(reduced[1], std::numeric_limits<int16_t>::max());
+  EXPECT_EQ(reduced[2], std::numeric_limits<int16_t>::min());
+}
+
+TEST(MonitorRateLimiterTest, ASubscriptionGetsTheRateItAskedFor) {
+  MonitorRateLimiter limiter(3.0);
+
+  // A source arriving at 9 Hz for ten seconds
+  int admitted = 0;
+  for (int tick = 0; tick < 90; ++tick) {
+    admitted += limiter.Admit(tick / 9.0) ? 1 : 0;
+  }
+  EXPECT_EQ(admitted, 30);
+}
+
+TEST(MonitorRateLimiterTest, AStallDoesNotEarnABurst) {
+  MonitorRateLimiter limiter(2.0);
+  ASSERT_TRUE(limiter.Admit(0.0));
+
+  // Nothing arrived for five seconds. One frame goes, and the next waits its
+  // full interval rather than ten going at once to catch up.
+  EXPECT_TRUE(limiter.Admit(5.0));
+  EXPECT_FALSE(limiter.Admit(5.1));
+  EXPECT_FALSE(limiter.Admit(5.4));
+  EXPECT_TRUE(limiter.Admit(5.5));
+}
+
+TEST(MonitorRateLimiterTest, ZeroIsNeverAndTooFastIsHeldToTheLimit) {
+  MonitorRateLimiter off;
+  EXPECT_FALSE(off.Admit(0.0));
+  EXPECT_FALSE(off.Admit(100.0));
+
+  MonitorRateLimiter fast(1000.0);
+  EXPECT_DOUBLE_EQ(fast.rate_hz(), kMaximumMonitorRateHz);
+}
+
+TEST(MonitorOutboxTest, FramesLeaveInOrderWhenThereIsRoom) {
+  MonitorOutbox outbox(4);
+  outbox.Push(StatsFrame(1));
+  outbox.Push(WaveformFrame(2));
+
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_EQ(DecodeWhole(bytes).stats.bytes_written, 1U);
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_EQ(DecodeWhole(bytes).waveform.minimum[0], 2);
+  EXPECT_FALSE(outbox.Pop(bytes));
+  EXPECT_EQ(outbox.dropped_total(), 0U);
+}
+
+// The whole point: a client that has stopped reading costs a fixed amount,
+// keeps the newest, and is told what it missed
+TEST(MonitorOutboxTest, AFullOutboxDropsTheOldestAndSaysSo) {
+  MonitorOutbox outbox(3);
+  for (uint16_t level = 0; level < 10; ++level) {
+    outbox.Push(WaveformFrame(level));
+  }
+  EXPECT_EQ(outbox.size(), 3U);
+  EXPECT_EQ(outbox.dropped_total(), 7U);
+
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(outbox.Pop(bytes));
+  MonitorFrame frame = DecodeWhole(bytes);
+  EXPECT_EQ(frame.waveform.minimum[0], 7);
+  EXPECT_EQ(frame.dropped, 7U);
+
+  // Said once, not again with every frame after it
+  ASSERT_TRUE(outbox.Pop(bytes));
+  frame = DecodeWhole(bytes);
+  EXPECT_EQ(frame.waveform.minimum[0], 8);
+  EXPECT_EQ(frame.dropped, 0U);
+}
+
+TEST(MonitorOutboxTest, DropsAreChargedToTheStreamThatLostThem) {
+  MonitorOutbox outbox(2);
+  outbox.Push(StatsFrame(1));
+  outbox.Push(WaveformFrame(1));
+  outbox.Push(WaveformFrame(2));
+
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_EQ(DecodeWhole(bytes).dropped, 0U);
+
+  // The stats frame that went is reported on the next stats frame, whenever
+  // that is
+  outbox.Push(StatsFrame(2));
+  ASSERT_TRUE(outbox.Pop(bytes));
+  ASSERT_TRUE(outbox.Pop(bytes));
+  const MonitorFrame frame = DecodeWhole(bytes);
+  EXPECT_EQ(frame.type, MonitorFrameType::kStats);
+  EXPECT_EQ(frame.dropped, 1U);
+}
+
+TEST(MonitorOutboxTest, RepliesAreNeverDropped) {
+  MonitorOutbox outbox(2);
+  outbox.Push(ReplyFrame("{\"ok\":true}"));
+  for (uint16_t level = 0; level < 5; ++level) {
+    outbox.Push(WaveformFrame(level));
+  }
+
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_EQ(DecodeWhole(bytes).reply, "{\"ok\":true}");
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_EQ(DecodeWhole(bytes).waveform.minimum[0], 4);
+  EXPECT_FALSE(outbox.Pop(bytes));
+}
+
+// A client that writes requests and reads nothing would otherwise grow the
+// queue a reply at a time, for as long as it kept writing
+TEST(MonitorOutboxTest, RepliesStopAtTheirLimit) {
+  MonitorOutbox outbox(2);
+  for (size_t index = 0; index < MonitorOutbox::kMaximumReplies; ++index) {
+    EXPECT_TRUE(outbox.Push(ReplyFrame("{\"ok\":true}")));
+  }
+  EXPECT_TRUE(outbox.Push(WaveformFrame(1)));
+  EXPECT_FALSE(outbox.Push(ReplyFrame("{\"ok\":true}")));
+  EXPECT_EQ(outbox.size(), MonitorOutbox::kMaximumReplies + 1);
+
+  // Sending one makes room for one more
+  std::vector<uint8_t> bytes;
+  ASSERT_TRUE(outbox.Pop(bytes));
+  EXPECT_TRUE(outbox.Push(ReplyFrame("{\"ok\":true}")));
+  EXPECT_FALSE(outbox.Push(ReplyFrame("{\"ok\":true}")));
+}
+
+}  // namespace
+}  // namespace ddd::capture
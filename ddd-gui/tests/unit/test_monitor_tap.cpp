@@ -15,6 +15,9 @@
 #include <atomic>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -146,6 +149,36 @@ TEST(SnapshotPublisherTest, ABufferLargerThanTheSnapshotIsTruncatedNotRefused) {
   EXPECT_EQ(out.size(), 16U);
 }
 
+// The video preview's tap is built disabled and holds no pool: its three 2 MiB
+// buffers are allocated by whoever first enables it, never by the writer.
+TEST(SnapshotPublisherTest, ADisabledPublisherPublishesNothingUntilEnabled) {
+  SnapshotPublisher publisher(8, SnapshotPublisher::kDefaultReaderCapacity,
+                              false);
+  EXPECT_FALSE(publisher.enabled());
+
+  std::vector<uint8_t> source(8, 0x11);
+  publisher.Publish(source.data(), source.size());
+  EXPECT_EQ(publisher.Generation(), 0U);
+
+  publisher.SetEnabled(true);
+  publisher.Publish(source.data(), source.size());
+  std::vector<uint8_t> out;
+  uint64_t generation = 0;
+  ASSERT_TRUE(publisher.TryRead(out, generation));
+  EXPECT_EQ(out, source);
+
+  // Off again keeps the pool, and on again needs nothing more
+  publisher.SetEnabled(false);
+  publisher.Publish(source.data(), source.size());
+  EXPECT_EQ(publisher.Generation(), 1U);
+  publisher.SetEnabled(true);
+  std::fill(source.begin(), source.end(), 0x22);
+  publisher.Publish(source.data(), source.size());
+  ASSERT_TRUE(publisher.TryRead(out, generation));
+  EXPECT_EQ(out, source);
+  EXPECT_EQ(generation, 2U);
+}
+
 TEST(SnapshotPublisherTest,
      ASlowReaderDropsSnapshotsRatherThanHoldingUpTheWriter) {
   // Falling behind is correct behaviour, not a fault: an old snapshot of a live
@@ -220,6 +253,218 @@ TEST(SnapshotPublisherTest, AHammeringReaderNeverSeesAHalfWrittenSnapshot) {
   EXPECT_GT(reads.load(), 0U) << "the reader never ran, so nothing was tested";
 }
 
+TEST(SnapshotPublisherTest, EachReaderSeesEverySnapshotItAsksForInTime) {
+  // The reason readers have cursors of their own. With one read index between
+  // them, whichever consumer asked first took the fresh snapshot and the other
+  // was told there was nothing new.
+  SnapshotPublisher publisher(8, 2);
+  const std::unique_ptr<SnapshotPublisher::Reader> display =
+      publisher.AddReader();
+  const std::unique_ptr<SnapshotPublisher::Reader> monitor =
+      publisher.AddReader();
+  ASSERT_NE(display, nullptr);
+  ASSERT_NE(monitor, nullptr);
+
+  const std::vector<uint8_t> source(8, 0x5A);
+  publisher.Publish(source.data(), source.size());
+
+  ASSERT_TRUE(display->TryAcquire());
+  ASSERT_TRUE(monitor->TryAcquire());
+  EXPECT_EQ(display->generation(), 1U);
+  EXPECT_EQ(monitor->generation(), 1U);
+
+  // And each only once
+  EXPECT_FALSE(display->TryAcquire());
+  EXPECT_FALSE(monitor->TryAcquire());
+
+  // Still holding the one they had, until they say otherwise
+  EXPECT_EQ(display->data().size(), source.size());
+  monitor->Release();
+  EXPECT_FALSE(monitor->TryAcquire());
+  EXPECT_TRUE(monitor->data().empty());
+}
+
+TEST(SnapshotPublisherTest, AReaderLooksAtThePublishedBufferRatherThanACopy) {
+  SnapshotPublisher publisher(8, 2);
+  const std::unique_ptr<SnapshotPublisher::Reader> first =
+      publisher.AddReader();
+  const std::unique_ptr<SnapshotPublisher::Reader> second =
+      publisher.AddReader();
+
+  const std::vector<uint8_t> source = {1, 2, 3, 4, 5, 6, 7, 8};
+  publisher.Publish(source.data(), source.size());
+  ASSERT_TRUE(first->TryAcquire());
+  ASSERT_TRUE(second->TryAcquire());
+
+  // Two readers of one snapshot are looking at the same bytes
+  EXPECT_EQ(first->data().data(), second->data().data());
+  EXPECT_TRUE(std::equal(first->data().begin(), first->data().end(),
+                         source.begin(), source.end()));
+}
+
+TEST(SnapshotPublisherTest, APinnedSnapshotIsNeverWrittenOver) {
+  // However far the writer gets ahead, and with every other reader pinning
+  // something too, the pool always has a spare and the pinned buffers keep
+  // what they held.
+  SnapshotPublisher publisher(4, 3);
+  std::vector<std::unique_ptr<SnapshotPublisher::Reader>> readers;
+  std::vector<uint8_t> source(4);
+
+  for (uint8_t value = 1; value <= 3; ++value) {
+    readers.push_back(publisher.AddReader());
+    std::fill(source.begin(), source.end(), value);
+    publisher.Publish(source.data(), source.size());
+    ASSERT_TRUE(readers.back()->TryAcquire());
+  }
+
+  for (uint8_t value = 4; value < 200; ++value) {
+    std::fill(source.begin(), source.end(), value);
+    publisher.Publish(source.data(), source.size());
+  }
+
+  for (size_t index = 0; index < readers.size(); ++index) {
+    const std::span<const uint8_t> view = readers[index]->data();
+    ASSERT_EQ(view.size(), 4U);
+    EXPECT_TRUE(std::all_of(view.begin(), view.end(), [&](uint8_t byte) {
+      return byte == index + 1;
+    })) << "reader " << index;
+  }
+
+  // And once let go, the newest is what the next acquire finds
+  readers[0]->Release();
+  ASSERT_TRUE(readers[0]->TryAcquire());
+  EXPECT_EQ(readers[0]->generation(), 199U);
+  EXPECT_EQ(readers[0]->data().front(), 199);
+}
+
+TEST(SnapshotPublisherTest, TheReadersAreLimitedToWhatThePoolWasSizedFor) {
+  SnapshotPublisher publisher(8, 2);
+  std::unique_ptr<SnapshotPublisher::Reader> first = publisher.AddReader();
+  const std::unique_ptr<SnapshotPublisher::Reader> second =
+      publisher.AddReader();
+  EXPECT_EQ(publisher.AddReader(), nullptr);
+
+  // The copying entry point is a reader like any other
+  std::vector<uint8_t> out;
+  uint64_t generation = 0;
+  const std::vector<uint8_t> source(8, 1);
+  publisher.Publish(source.data(), source.size());
+  EXPECT_FALSE(publisher.TryRead(out, generation));
+
+  // A reader going away gives its place back
+  first.reset();
+  EXPECT_TRUE(publisher.TryRead(out, generation));
+}
+
+TEST(SnapshotPublisherTest, AnArmedTriggerReadsBackAsItWasSet) {
+  SnapshotPublisher publisher(8);
+  EXPECT_FALSE(publisher.ArmedTrigger().has_value());
+
+  SnapshotTrigger trigger;
+  trigger.level_codes = 600;
+  trigger.hysteresis_codes = 24;
+  trigger.pre_trigger_fraction = 0.25;
+  publisher.ArmTrigger(trigger);
+
+  const std::optional<SnapshotTrigger> armed = publisher.ArmedTrigger();
+  ASSERT_TRUE(armed.has_value());
+  EXPECT_EQ(armed->level_codes, 600);
+  EXPECT_EQ(armed->hysteresis_codes, 24);
+  EXPECT_DOUBLE_EQ(armed->pre_trigger_fraction, 0.25);
+
+  publisher.DisarmTrigger();
+  EXPECT_FALSE(publisher.ArmedTrigger().has_value());
+}
+
+TEST(SnapshotPublisherTest, ASnapshotCarriesTheCrossingItWasLinedUpOn) {
+  // Per snapshot rather than per publisher: the writer may find a crossing in
+  // one slot and none in the next, and a reader drawing from a position that
+  // belonged to another snapshot would draw from nowhere in particular.
+  SnapshotPublisher publisher(8);
+  const std::vector<uint8_t> source(8, 1);
+
+  publisher.Publish(source.data(), source.size(), 2.5);
+  std::vector<uint8_t> out;
+  uint64_t generation = 0;
+  std::optional<double> position;
+  ASSERT_TRUE(publisher.TryRead(out, generation, position));
+  ASSERT_TRUE(position.has_value());
+  EXPECT_DOUBLE_EQ(*position, 2.5);
+
+  publisher.Publish(source.data(), source.size());
+  ASSERT_TRUE(publisher.TryRead(out, generation, position));
+  EXPECT_FALSE(position.has_value());
+}
+
+TEST(SnapshotPublisherTest, HammeringReadersNeverSeeAHalfWrittenSnapshot) {
+  // The single-reader test above, with three readers holding their views for
+  // a while and letting go at different moments, which is what exercises the
+  // writer's search for a spare.
+  constexpr size_t kSnapshotBytes = 4096;
+  constexpr int kReaderCount = 3;
+  SnapshotPublisher publisher(kSnapshotBytes, kReaderCount);
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> torn{0};
+  std::atomic<uint64_t> repeated{0};
+  std::atomic<uint64_t> reads{0};
+
+  std::vector<std::thread> threads;
+  for (int index = 0; index < kReaderCount; ++index) {
+    std::unique_ptr<SnapshotPublisher::Reader> reader = publisher.AddReader();
+    ASSERT_NE(reader, nullptr);
+    threads.emplace_back([&, reader = std::move(reader), index]() mutable {
+      uint64_t last_generation = 0;
+      while (!stop.load()) {
+        if (!reader->TryAcquire()) {
+          continue;
+        }
+        ++reads;
+        if (reader->generation() <= last_generation) {
+          ++repeated;
+        }
+        last_generation = reader->generation();
+
+        // Looked at twice, some way apart, so a write landing under the view
+        // has time to show
+        const std::span<const uint8_t> view = reader->data();
+        for (int pass = 0; pass <= index; ++pass) {
+          for (const uint8_t byte : view) {
+            if (byte != view.front()) {
+              ++torn;
+              break;
+            }
+          }
+        }
+        if (index == 0) {
+          reader->Release();
+        }
+      }
+    });
+  }
+
+  std::vector<uint8_t> source(kSnapshotBytes);
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  for (uint64_t index = 1;
+       index <= 20'000 ||
+       (reads.load() < kReaderCount && std::chrono::steady_clock::now() <
+                                           deadline);
+       ++index) {
+    std::fill(source.begin(), source.end(), static_cast<uint8_t>(index));
+    publisher.Publish(source.data(), source.size());
+  }
+
+  stop = true;
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(torn.load(), 0U);
+  EXPECT_EQ(repeated.load(), 0U);
+  EXPECT_GT(reads.load(), 0U) << "no reader ran, so nothing was tested";
+}
+
 // The property the whole tap design exists for, measured directly rather than
 // inferred from throughput.
 //
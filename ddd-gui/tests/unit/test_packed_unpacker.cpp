@@ -0,0 +1,262 @@
+/************************************************************************
+
+    test_packed_unpacker.cpp
+
+    T1 tests for unpacking the packed wire format
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "packed_unpacker.h"
+#include "sample_format.h"
+
+namespace ddd::capture {
+namespace {
+
+// The gateware's stream, built a bit at a time rather than a group at a time:
+// the unpacker works in groups, so a fixture that did too would share any
+// mistake in how a group is laid out.
+class PackedStreamBuilder {
+ public:
+  explicit PackedStreamBuilder(uint16_t first_block) : block_(first_block) {}
+
+  // One block of ramp samples, continuing from the last
+  void AppendBlock() { AppendBlockNumbered(block_++); }
+
+  void AppendBlockNumbered(uint16_t number) {
+    const size_t start = bytes_.size();
+    bytes_.resize(start + kPackedBlockBytes, 0);
+    bytes_[start] = static_cast<uint8_t>(number & 0xFF);
+    bytes_[start + 1] = static_cast<uint8_t>(number >> 8);
+
+    uint8_t* payload = bytes_.data() + start + kPackedHeaderBytes;
+    for (size_t index = 0; index < kPackedSamplesPerBlock; ++index) {
+      const uint16_t value = ramp_;
+      ramp_ = static_cast<uint16_t>((ramp_ + 1) % 1021);
+      for (size_t bit = 0; bit < 10; ++bit) {
+        if (((value >> bit) & 1) != 0) {
+          const size_t position = (index * 10) + bit;
+          payload[position / 8] |= static_cast<uint8_t>(1 << (position % 8));
+        }
+      }
+    }
+  }
+
+  void SkipBlockNumber() { ++block_; }
+
+  const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  uint16_t block_;
+  uint16_t ramp_ = 0;
+};
+
+std::vector<uint16_t> Words(const std::vector<uint8_t>& output,
+                            size_t sample_count) {
+  std::vector<uint16_t> words(sample_count);
+  for (size_t index = 0; index < sample_count; ++index) {
+    words[index] = static_cast<uint16_t>(
+        output[index * kBytesPerSample] |
+        (output[(index * kBytesPerSample) + 1] << 8));
+  }
+  return words;
+}
+
+// Index of the first sample that does not follow its predecessor on the ramp,
+// or zero for an unbroken run.
+size_t FirstRampBreak(const std::vector<uint16_t>& words) {
+  for (size_t index = 1; index < words.size(); ++index) {
+    if (words[index] != (words[index - 1] + 1) % 1021) {
+      return index;
+    }
+  }
+  return 0;
+}
+
+TEST(PackedUnpackerTest, EverySampleComesBackInOrder) {
+  PackedStreamBuilder builder(0);
+  for (int block = 0; block < 6; ++block) {
+    builder.AppendBlock();
+  }
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(builder.bytes().size()) *
+      kBytesPerSample);
+  const PackedUnpacker::Outcome outcome = unpacker.Process(
+      builder.bytes().data(), builder.bytes().size(), output.data());
+
+  ASSERT_TRUE(outcome.ok);
+  EXPECT_TRUE(outcome.synchronised_here);
+  EXPECT_EQ(outcome.synchronisation_byte_offset, 0U);
+  EXPECT_EQ(unpacker.state(), SequenceState::kRunning);
+  ASSERT_EQ(outcome.sample_count, 6 * kPackedSamplesPerBlock);
+
+  const std::vector<uint16_t> words = Words(output, outcome.sample_count);
+  EXPECT_EQ(words.front(), 0);
+  EXPECT_EQ(FirstRampBreak(words), 0U);
+  EXPECT_LE(*std::max_element(words.begin(), words.end()), kSampleValueMask)
+      << "an unpacked word carries nothing above the sample";
+}
+
+// The host opens a stream that is already running, so the first byte it sees
+// is wherever the device had got to.
+TEST(PackedUnpackerTest, AStreamJoinedPartWayThroughABlockLocksOnTheNext) {
+  PackedStreamBuilder builder(40);
+  for (int block = 0; block < 6; ++block) {
+    builder.AppendBlock();
+  }
+  const size_t joined_at = 1000;
+  const std::vector<uint8_t> stream(builder.bytes().begin() + joined_at,
+                                    builder.bytes().end());
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(stream.size()) * kBytesPerSample);
+  const PackedUnpacker::Outcome outcome =
+      unpacker.Process(stream.data(), stream.size(), output.data());
+
+  ASSERT_TRUE(outcome.ok);
+  EXPECT_EQ(outcome.synchronisation_byte_offset,
+            kPackedBlockBytes - joined_at);
+  ASSERT_EQ(outcome.sample_count, 5 * kPackedSamplesPerBlock);
+  EXPECT_EQ(Words(output, 1).front(), kPackedSamplesPerBlock % 1021);
+}
+
+// Nothing obliges a transfer to end on a block boundary, and a slot size that
+// is not a whole number of blocks must not cost or repeat a sample.
+TEST(PackedUnpackerTest, BuffersThatSplitBlocksAreCarriedAcross) {
+  PackedStreamBuilder builder(0);
+  for (int block = 0; block < 12; ++block) {
+    builder.AppendBlock();
+  }
+
+  constexpr size_t kChunkBytes = 3000;
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(PackedUnpacker::MaximumSamplesFor(kChunkBytes) *
+                              kBytesPerSample);
+  std::vector<uint16_t> collected;
+
+  for (size_t offset = 0; offset < builder.bytes().size();
+       offset += kChunkBytes) {
+    const size_t bytes =
+        std::min(kChunkBytes, builder.bytes().size() - offset);
+    const PackedUnpacker::Outcome outcome = unpacker.Process(
+        builder.bytes().data() + offset, bytes, output.data());
+    ASSERT_TRUE(outcome.ok) << "at byte " << offset;
+    const std::vector<uint16_t> words = Words(output, outcome.sample_count);
+    collected.insert(collected.end(), words.begin(), words.end());
+  }
+
+  ASSERT_EQ(collected.size(), 12 * kPackedSamplesPerBlock);
+  EXPECT_EQ(FirstRampBreak(collected), 0U);
+}
+
+TEST(PackedUnpackerTest, ASkippedBlockIsAMismatch) {
+  PackedStreamBuilder builder(0);
+  for (int block = 0; block < 5; ++block) {
+    builder.AppendBlock();
+  }
+  builder.SkipBlockNumber();
+  builder.AppendBlock();
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(builder.bytes().size()) *
+      kBytesPerSample);
+  const PackedUnpacker::Outcome outcome = unpacker.Process(
+      builder.bytes().data(), builder.bytes().size(), output.data());
+
+  EXPECT_FALSE(outcome.ok);
+  EXPECT_TRUE(outcome.headers_found);
+  EXPECT_EQ(outcome.mismatch_block_index, 5U);
+  EXPECT_EQ(outcome.expected_block, 5);
+  EXPECT_EQ(outcome.actual_block, 6);
+  EXPECT_EQ(outcome.sample_count, 5 * kPackedSamplesPerBlock)
+      << "the blocks before the break were real";
+  EXPECT_EQ(unpacker.state(), SequenceState::kFailed);
+
+  // And it stays failed, however good what follows
+  PackedStreamBuilder more(7);
+  more.AppendBlock();
+  EXPECT_FALSE(
+      unpacker.Process(more.bytes().data(), more.bytes().size(), output.data())
+          .ok);
+}
+
+TEST(PackedUnpackerTest, TheBlockNumberWrapsAt65536) {
+  PackedStreamBuilder builder(65534);
+  for (int block = 0; block < 6; ++block) {
+    builder.AppendBlock();
+  }
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(builder.bytes().size()) *
+      kBytesPerSample);
+  const PackedUnpacker::Outcome outcome = unpacker.Process(
+      builder.bytes().data(), builder.bytes().size(), output.data());
+
+  EXPECT_TRUE(outcome.ok);
+  EXPECT_EQ(outcome.sample_count, 6 * kPackedSamplesPerBlock);
+}
+
+TEST(PackedUnpackerTest, NothingIsWrittenUntilThereIsEnoughToLockOn) {
+  PackedStreamBuilder builder(0);
+  for (int block = 0; block < 4; ++block) {
+    builder.AppendBlock();
+  }
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(builder.bytes().size()) *
+      kBytesPerSample);
+  const size_t first = PackedUnpacker::kSynchronisationBytes / 2;
+
+  const PackedUnpacker::Outcome waiting =
+      unpacker.Process(builder.bytes().data(), first, output.data());
+  EXPECT_TRUE(waiting.ok);
+  EXPECT_EQ(waiting.sample_count, 0U);
+  EXPECT_EQ(unpacker.state(), SequenceState::kSynchronising);
+
+  const PackedUnpacker::Outcome locked =
+      unpacker.Process(builder.bytes().data() + first,
+                       builder.bytes().size() - first, output.data());
+  EXPECT_TRUE(locked.ok);
+  EXPECT_TRUE(locked.synchronised_here);
+  EXPECT_EQ(locked.sample_count, 4 * kPackedSamplesPerBlock);
+}
+
+// Word-format data, or anything else that is not the packed stream, has no
+// three headers a block apart and counting. That is a failure rather than an
+// unverified capture: the device said it was packing.
+TEST(PackedUnpackerTest, AStreamWithNoHeadersIsAFailure) {
+  std::vector<uint8_t> stream(PackedUnpacker::kSynchronisationBytes);
+  for (size_t index = 0; index < stream.size(); index += kBytesPerSample) {
+    const uint16_t word = MakeWireWord(512, 3);
+    stream[index] = static_cast<uint8_t>(word & 0xFF);
+    stream[index + 1] = static_cast<uint8_t>(word >> 8);
+  }
+
+  PackedUnpacker unpacker;
+  std::vector<uint8_t> output(
+      PackedUnpacker::MaximumSamplesFor(stream.size()) * kBytesPerSample);
+  const PackedUnpacker::Outcome outcome =
+      unpacker.Process(stream.data(), stream.size(), output.data());
+
+  EXPECT_FALSE(outcome.ok);
+  EXPECT_FALSE(outcome.headers_found);
+  EXPECT_EQ(unpacker.state(), SequenceState::kFailed);
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -25,6 +25,46 @@ TEST(SampleFormatTest, TheWireRateIsEightyMegabytesPerSecond) {
   EXPECT_EQ(kWireBytesPerSecond, 80'000'000U);
 }
 
+// The packed format's point, stated as the figure it buys: 37.5% off the
+// wire, for the price of a header every 6552 samples.
+TEST(SampleFormatTest, ThePackedWireRateIsAboutFiftyMegabytesPerSecond) {
+  const double packed = WireBytesPerSecond(WireFormat::kPacked, kSampleRateHz);
+  EXPECT_GT(packed, 50.0e6);
+  EXPECT_LT(packed, 50.1e6);
+  EXPECT_EQ(WireBytesPerSecond(WireFormat::kWords, kSampleRateHz),
+            static_cast<double>(kWireBytesPerSecond));
+}
+
+// What a queued slot stands for, in each of the four wire layouts. A packed
+// slot is not half its bytes in samples, and an in-band one loses eight words
+// at the head of every packet, which the host never sees as samples.
+TEST(SampleFormatTest, QueuedBytesAreCountedInTheFormatTheyArrivedIn) {
+  constexpr uint64_t kSlot = uint64_t{128} * kInbandPacketWords *
+                             kBytesPerSample;  // 2 MiB, 256 packed blocks
+  EXPECT_EQ(SamplesInWireBytes(kSlot, WireFormat::kWords, false),
+            kSlot / kBytesPerSample);
+  EXPECT_EQ(SamplesInWireBytes(kSlot, WireFormat::kPacked, false),
+            256U * kPackedSamplesPerBlock);
+  EXPECT_EQ(SamplesInWireBytes(kSlot, WireFormat::kWords, true),
+            128U * (kInbandPacketWords - kInbandBlockWords));
+
+  // Packed behind the in-band block: the stripped stream is what is unpacked,
+  // so 16 bytes a packet come off before the 8192-byte blocks are counted
+  constexpr uint64_t kStripped = kSlot - (128U * kInbandBlockWords * 2U);
+  EXPECT_EQ(SamplesInWireBytes(kSlot, WireFormat::kPacked, true),
+            ((kStripped / kPackedBlockBytes) * kPackedSamplesPerBlock) +
+                (((kStripped % kPackedBlockBytes) - kPackedHeaderBytes) /
+                 kPackedGroupBytes * kPackedGroupSamples));
+
+  // Part of a block counts the whole samples it holds, and a header alone none
+  EXPECT_EQ(SamplesInWireBytes(kPackedHeaderBytes, WireFormat::kPacked, false),
+            0U);
+  EXPECT_EQ(
+      SamplesInWireBytes(kPackedHeaderBytes + 11, WireFormat::kPacked, false),
+      8U);
+  EXPECT_EQ(SamplesInWireBytes(10, WireFormat::kWords, true), 0U);
+}
+
 TEST(SampleFormatTest, AWordSplitsIntoASampleAndACounter) {
   const uint16_t word = MakeWireWord(0x2AB, 37);
 
@@ -104,6 +144,16 @@ TEST(WireProtocolTest, TestModeIsAWriteToItsOwnRegister) {
   EXPECT_EQ(MakeTestModeWrite(false), MakeRegisterWrite(kRegisterTestMode, 0));
 }
 
+TEST(WireProtocolTest, TheWireFormatIsAWriteToItsOwnRegister) {
+  EXPECT_EQ(MakeWireFormatWrite(true), 0x1301);
+  EXPECT_EQ(MakeWireFormatWrite(false), 0x1300);
+}
+
+TEST(WireProtocolTest, InbandTelemetryIsAWriteToItsOwnRegister) {
+  EXPECT_EQ(MakeInbandTelemetryWrite(true), 0x1401);
+  EXPECT_EQ(MakeInbandTelemetryWrite(false), 0x1400);
+}
+
 TEST(WireProtocolTest, TheIdentitySignatureIsNeitherAllZerosNorAllOnes) {
   // The whole value of the signature is that it tells a real register bank
   // from a floating wire. SPI has no acknowledgement, so an absent or
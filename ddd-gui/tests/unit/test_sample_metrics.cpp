@@ -32,6 +32,30 @@ BufferTally Buffer(uint64_t samples, uint16_t minimum, uint16_t maximum,
   return tally;
 }
 
+// The part of a skipped buffer nobody measured is part of the run's length and
+// nothing else: the RMS is still over what was measured.
+TEST(SampleMetricsTest, UnmeasuredSamplesCountButAreNotMeasured) {
+  SampleMetrics metrics;
+  metrics.Accumulate(Buffer(1000, 100, 900));
+  metrics.CountUnmeasured(3000);
+
+  const SampleMetricsSnapshot snapshot = metrics.Snapshot();
+  EXPECT_EQ(snapshot.sample_count, 4000U);
+  EXPECT_EQ(snapshot.measured_sample_count, 1000U);
+  EXPECT_DOUBLE_EQ(snapshot.rms, 900.0);
+  EXPECT_EQ(snapshot.minimum_value, 100U);
+}
+
+TEST(SampleMetricsTest, NothingMeasuredReadsAsNothingMeasured) {
+  SampleMetrics metrics;
+  metrics.CountUnmeasured(3000);
+
+  const SampleMetricsSnapshot snapshot = metrics.Snapshot();
+  EXPECT_EQ(snapshot.sample_count, 3000U);
+  EXPECT_EQ(snapshot.minimum_value, 0U);
+  EXPECT_EQ(snapshot.rms, 0.0);
+}
+
 TEST(SampleMetricsTest, WithNoCaptureTheFileFiguresAreEmpty) {
   // The state every monitoring session sits in. Nothing has been recorded, so
   // there is nothing to say about a recording — and zero is the honest answer
@@ -143,5 +167,41 @@ TEST(SampleMetricsTest, AResetClosesAnOpenSpan) {
   EXPECT_EQ(snapshot.capture_maximum_value, 0U);
 }
 
+TEST(SampleMetricsTest, TheHistogramsCoverTheSameSpansAsTheFigures) {
+  BufferTally before = Buffer(100, 200, 200);
+  before.code_counts[200] = 100;
+  BufferTally during = Buffer(50, 300, 300);
+  during.code_counts[300] = 50;
+  BufferTally after = Buffer(10, 400, 400);
+  after.code_counts[400] = 10;
+
+  SampleMetrics metrics;
+  metrics.Accumulate(before);
+  metrics.BeginCaptureSpan();
+  metrics.Accumulate(during);
+  metrics.Accumulate(during);
+  metrics.EndCaptureSpan();
+  metrics.Accumulate(after);
+
+  const CodeHistograms histograms = metrics.Histograms();
+  EXPECT_EQ(histograms.session[200], 100U);
+  EXPECT_EQ(histograms.session[300], 100U);
+  EXPECT_EQ(histograms.session[400], 10U);
+
+  EXPECT_EQ(histograms.recent[300], 0U);
+  EXPECT_EQ(histograms.recent[400], 10U);
+
+  EXPECT_EQ(histograms.capture[200], 0U);
+  EXPECT_EQ(histograms.capture[300], 100U);
+  EXPECT_EQ(histograms.capture[400], 0U);
+
+  // And a second file starts from nothing
+  metrics.BeginCaptureSpan();
+  EXPECT_EQ(metrics.Histograms().capture[300], 0U);
+
+  metrics.Reset();
+  EXPECT_EQ(metrics.Histograms().session[200], 0U);
+}
+
 }  // namespace
 }  // namespace ddd::capture
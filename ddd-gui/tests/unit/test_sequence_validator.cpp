@@ -11,7 +11,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <vector>
@@ -190,6 +192,209 @@ TEST(SequenceValidatorTest, TheRootMeanSquareIsMeasuredAboutTheMidpoint) {
   EXPECT_NEAR(metrics.Snapshot().rms, 100.0, 0.001);
 }
 
+TEST(SequenceValidatorTest, EverySampleIsCountedUnderItsOwnCode) {
+  // Runs of one code, which is what the lanes are for, and runs shorter than
+  // the number of lanes, which is what would expose a lane added in twice.
+  test::WireStreamBuilder builder(0, 64);
+  builder.AppendConstant(kMinimumSampleValue, 3);
+  builder.AppendConstant(511, 1000);
+  for (size_t index = 0; index < 90; ++index) {
+    builder.Append(static_cast<uint16_t>(600 + (index % 3)));
+  }
+  builder.AppendConstant(kMaximumSampleValue, 1);
+
+  SequenceValidator validator;
+  const SequenceValidator::Outcome outcome =
+      validator.Process(builder.bytes().data(), builder.bytes().size());
+
+  EXPECT_EQ(outcome.tally.code_counts[kMinimumSampleValue], 3U);
+  EXPECT_EQ(outcome.tally.code_counts[511], 1000U);
+  EXPECT_EQ(outcome.tally.code_counts[600], 30U);
+  EXPECT_EQ(outcome.tally.code_counts[601], 30U);
+  EXPECT_EQ(outcome.tally.code_counts[602], 30U);
+  EXPECT_EQ(outcome.tally.code_counts[kMaximumSampleValue], 1U);
+
+  uint64_t total = 0;
+  for (const uint32_t count : outcome.tally.code_counts) {
+    total += count;
+  }
+  EXPECT_EQ(total, outcome.tally.sample_count);
+}
+
+TEST(SequenceValidatorTest, EachBufferHasAHistogramOfItsOwn) {
+  test::WireStreamBuilder builder(0, 64);
+  builder.AppendConstant(300, 128);
+  builder.AppendConstant(700, 128);
+  std::vector<uint8_t> bytes = builder.bytes();
+  const size_t half = bytes.size() / 2;
+
+  SequenceValidator validator;
+  validator.Process(bytes.data(), half);
+  const SequenceValidator::Outcome outcome =
+      validator.Process(bytes.data() + half, half);
+
+  EXPECT_EQ(outcome.tally.code_counts[300], 0U);
+  EXPECT_EQ(outcome.tally.code_counts[700], 128U);
+}
+
+// Monitoring without a file leaves the histogram out of most buffers. What it
+// leaves out is the histogram and nothing else: the buffer is still checked,
+// stripped and measured, and the next buffer that counts codes counts only
+// its own.
+TEST(SequenceValidatorTest, LeavingTheCodesOutMeasuresEverythingElse) {
+  test::WireStreamBuilder builder(0, 64);
+  builder.AppendConstant(300, 128);
+  builder.AppendConstant(kMaximumSampleValue, 128);
+  builder.AppendConstant(700, 128);
+  std::vector<uint8_t> bytes = builder.bytes();
+  const size_t third = bytes.size() / 3;
+
+  SequenceValidator validator;
+  validator.Process(bytes.data(), third);
+  const SequenceValidator::Outcome uncounted =
+      validator.Process(bytes.data() + third, third, false);
+  EXPECT_TRUE(uncounted.ok);
+  EXPECT_EQ(uncounted.tally.sample_count, 128U);
+  EXPECT_EQ(uncounted.tally.clipped_high_count, 128U);
+  EXPECT_EQ(uncounted.tally.maximum_value, kMaximumSampleValue);
+  for (const uint32_t count : uncounted.tally.code_counts) {
+    EXPECT_EQ(count, 0U);
+  }
+  EXPECT_EQ(bytes[third + 1] & ~kSampleValueHighByteMask, 0)
+      << "the markers must still be stripped";
+
+  const SequenceValidator::Outcome counted =
+      validator.Process(bytes.data() + (2 * third), third);
+  EXPECT_EQ(counted.tally.code_counts[700], 128U);
+  EXPECT_EQ(counted.tally.code_counts[kMaximumSampleValue], 0U);
+}
+
+// A stream that locks on in its first buffer, which ends on a counter change,
+// so that everything after it is in a known phase: counter 2 begins at the
+// returned offset, in bytes.
+size_t LockOn(test::WireStreamBuilder& builder, SequenceValidator& validator) {
+  builder.AppendConstant(600, 100);
+  builder.AppendConstant(600, kSamplesPerSequenceCounter);
+  const size_t locked_bytes = builder.bytes().size();
+  EXPECT_TRUE(validator.Process(builder.bytes().data(), locked_bytes).ok);
+  EXPECT_EQ(validator.state(), SequenceState::kRunning);
+  return locked_bytes;
+}
+
+TEST(SequenceValidatorTest, SkippingCarriesThePhaseToTheNextBuffer) {
+  test::WireStreamBuilder builder(0, 100);
+  SequenceValidator validator;
+  const size_t first = LockOn(builder, validator);
+
+  // Two buffers ending partway through a counter run, then one checked whole
+  builder.AppendConstant(600, 100'000);
+  const size_t second = builder.bytes().size();
+  builder.AppendConstant(600, 70'000);
+  const size_t third = builder.bytes().size();
+  builder.AppendConstant(600, 200'000);
+
+  uint8_t* const bytes = builder.bytes().data();
+  const std::vector<uint8_t> before(bytes + first, bytes + third);
+
+  const SequenceValidator::Outcome skipped =
+      validator.Skip(bytes + first, second - first);
+  EXPECT_TRUE(skipped.ok);
+  EXPECT_EQ(skipped.tally.sample_count, 0U);
+  EXPECT_TRUE(validator.Skip(bytes + second, third - second).ok);
+
+  // Nothing skipped is touched: the markers are still there.
+  EXPECT_TRUE(std::equal(before.begin(), before.end(), bytes + first));
+
+  const SequenceValidator::Outcome checked =
+      validator.Process(bytes + third, builder.bytes().size() - third);
+  EXPECT_TRUE(checked.ok);
+  EXPECT_EQ(checked.tally.sample_count, 200'000U);
+  EXPECT_EQ(validator.state(), SequenceState::kRunning);
+}
+
+// Ten samples gone from the middle of a run move the next counter change ten
+// samples earlier, and the last sample of the run is where that shows.
+TEST(SequenceValidatorTest, ALossInASkippedBufferIsFoundAtTheNextChange) {
+  test::WireStreamBuilder builder(0, 100);
+  SequenceValidator validator;
+  const size_t first = LockOn(builder, validator);
+
+  builder.AppendConstant(600, size_t{kSamplesPerSequenceCounter} * 3);
+  std::vector<uint8_t>& bytes = builder.bytes();
+  const auto lost = bytes.begin() + static_cast<std::ptrdiff_t>(
+                                        first + (1000 * kBytesPerSample));
+  bytes.erase(lost, lost + (10 * kBytesPerSample));
+
+  const SequenceValidator::Outcome outcome =
+      validator.Skip(bytes.data() + first, bytes.size() - first);
+
+  EXPECT_FALSE(outcome.ok);
+  EXPECT_EQ(validator.state(), SequenceState::kFailed);
+  EXPECT_EQ(outcome.mismatch_sample_index, kSamplesPerSequenceCounter - 1);
+  EXPECT_EQ(outcome.expected_counter, 2);
+  EXPECT_EQ(outcome.actual_counter, 3);
+  EXPECT_EQ(outcome.samples_expected_remaining, 1U);
+}
+
+// A whole counter run gone changes every counter after it, including the very
+// first sample the skip reads.
+TEST(SequenceValidatorTest, AWholeRunLostAtTheBoundaryIsFoundAtOnce) {
+  test::WireStreamBuilder builder(0, 100);
+  SequenceValidator validator;
+  const size_t first = LockOn(builder, validator);
+
+  builder.SkipCounter();
+  builder.AppendConstant(600, 1000);
+  const SequenceValidator::Outcome outcome = validator.Skip(
+      builder.bytes().data() + first, builder.bytes().size() - first);
+
+  EXPECT_FALSE(outcome.ok);
+  EXPECT_EQ(outcome.mismatch_sample_index, 0U);
+}
+
+// Lost near the end of a skipped buffer, after its last counter change: the
+// buffer's own checks all agree, and the next buffer is where the change comes
+// early. That is the continuity the skip promises across buffers.
+TEST(SequenceValidatorTest, ALossAfterTheLastChangeIsFoundInTheNextBuffer) {
+  test::WireStreamBuilder builder(0, 100);
+  SequenceValidator validator;
+  const size_t first = LockOn(builder, validator);
+
+  builder.AppendConstant(600, kSamplesPerSequenceCounter + 500);
+  const size_t second_end = builder.bytes().size() - (10 * kBytesPerSample);
+  builder.AppendConstant(600, kSamplesPerSequenceCounter);
+
+  // Ten samples from the skipped buffer's tail never arrive
+  std::vector<uint8_t>& bytes = builder.bytes();
+  bytes.erase(bytes.begin() + static_cast<std::ptrdiff_t>(second_end),
+              bytes.begin() + static_cast<std::ptrdiff_t>(
+                                  second_end + (10 * kBytesPerSample)));
+
+  EXPECT_TRUE(validator.Skip(bytes.data() + first, second_end - first).ok);
+  const SequenceValidator::Outcome outcome =
+      validator.Process(bytes.data() + second_end, bytes.size() - second_end);
+  EXPECT_FALSE(outcome.ok);
+  EXPECT_EQ(validator.state(), SequenceState::kFailed);
+}
+
+// Nothing to carry: the skip leaves the search for the next Process.
+TEST(SequenceValidatorTest, SkippingBeforeTheLockChangesNothing) {
+  test::WireStreamBuilder builder(7, 50);
+  builder.AppendConstant(600, 1000);
+  const size_t skipped = builder.bytes().size();
+  builder.AppendConstant(600, kLockOnSamples);
+
+  SequenceValidator validator;
+  EXPECT_TRUE(validator.Skip(builder.bytes().data(), skipped).ok);
+  EXPECT_EQ(validator.state(), SequenceState::kSynchronising);
+
+  EXPECT_TRUE(validator
+                  .Process(builder.bytes().data() + skipped,
+                           builder.bytes().size() - skipped)
+                  .ok);
+  EXPECT_EQ(validator.state(), SequenceState::kRunning);
+}
+
 TEST(SampleMetricsTest, RecentFiguresTrackTheLastBufferOnly) {
   // A whole-capture maximum records the worst moment since the run started and
   // never comes back down, so it cannot show a user that turning the RF gain
@@ -0,0 +1,154 @@
+/************************************************************************
+
+    test_snapshot_trigger.cpp
+
+    T1 tests for lining the waveform tap up on a crossing
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "snapshot_trigger.h"
+#include "wire_data.h"
+
+namespace ddd::capture {
+namespace {
+
+constexpr uint16_t kLevel = 512;
+constexpr uint16_t kArmLevel = 496;
+
+TEST(SnapshotTriggerTest, TheCrossingIsPlacedBetweenTheSamplesItFellBetween) {
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(400, 2);
+  builder.Append(500);
+  builder.Append(524);
+
+  const std::optional<double> crossing =
+      FindRisingCrossing(builder.bytes().data(), 0, 4, kLevel, kArmLevel);
+  ASSERT_TRUE(crossing.has_value());
+  EXPECT_DOUBLE_EQ(*crossing, 2.5);
+}
+
+TEST(SnapshotTriggerTest, NothingCountsUntilTheSignalHasGoneBelowTheArmLevel) {
+  // Noise sitting on the level would otherwise trigger on every sample, which
+  // is the reason FindTriggers has hysteresis and the reason this agrees.
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(505, 100);
+  builder.AppendConstant(600, 10);
+  builder.AppendConstant(505, 100);
+  builder.AppendConstant(400, 10);
+  builder.AppendConstant(600, 10);
+
+  const std::optional<double> crossing =
+      FindRisingCrossing(builder.bytes().data(), 0, 230, kLevel, kArmLevel);
+  ASSERT_TRUE(crossing.has_value());
+  EXPECT_GT(*crossing, 219.0);
+  EXPECT_LT(*crossing, 220.0);
+}
+
+TEST(SnapshotTriggerTest, TheSequenceMarkersAreNotTakenForSignal) {
+  // Counter 40 sets the top bits of every word. Read unmasked, a flat 300
+  // would sit above the level from the start and never cross it.
+  test::WireStreamBuilder builder(40);
+  builder.AppendConstant(300, 200);
+  builder.AppendConstant(700, 200);
+
+  const std::optional<double> crossing =
+      FindRisingCrossing(builder.bytes().data(), 0, 400, kLevel, kArmLevel);
+  ASSERT_TRUE(crossing.has_value());
+  EXPECT_DOUBLE_EQ(*crossing, 199.0 + (212.0 / 400.0));
+}
+
+TEST(SnapshotTriggerTest, ACrossingIsFoundAfterALongRunWithoutOne) {
+  // Far enough in that the search passes whole blocks before it gets there,
+  // and at an offset that is not a whole number of them
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(600, 5003);
+  builder.AppendConstant(400, 4000);
+  builder.AppendConstant(600, 100);
+
+  const std::optional<double> crossing = FindRisingCrossing(
+      builder.bytes().data(), 0, 9103, kLevel, kArmLevel);
+  ASSERT_TRUE(crossing.has_value());
+  EXPECT_DOUBLE_EQ(*crossing, 9002.0 + (112.0 / 200.0));
+}
+
+TEST(SnapshotTriggerTest, AFlatSlotHasNoCrossing) {
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 5000);
+  EXPECT_FALSE(FindRisingCrossing(builder.bytes().data(), 0, 5000, kLevel,
+                                  kArmLevel)
+                   .has_value());
+}
+
+TEST(SnapshotTriggerTest, TheWindowPutsTheCrossingAtThePreTriggerFraction) {
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 3000);
+  builder.AppendConstant(700, 1096);
+
+  const std::optional<TriggeredWindow> window =
+      PlaceTriggeredWindow(builder.bytes().data(), 4096, 1000, {});
+  ASSERT_TRUE(window.has_value());
+  EXPECT_EQ(window->first_sample, 2899U);
+  EXPECT_NEAR(window->crossing, 100.0 + (212.0 / 400.0), 1e-9);
+}
+
+TEST(SnapshotTriggerTest, ACrossingOnASampleStillLeavesTheWholeWindowInside) {
+  // A ramp lands on the level exactly, so the crossing is a whole number and
+  // the window must be placed from the sample before it, not from it.
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 3098);
+  builder.Append(512);
+  builder.AppendConstant(700, 997);
+
+  const std::optional<TriggeredWindow> window =
+      PlaceTriggeredWindow(builder.bytes().data(), 4096, 1000, {});
+  ASSERT_TRUE(window.has_value());
+  EXPECT_EQ(window->first_sample, 2997U);
+  EXPECT_DOUBLE_EQ(window->crossing, 101.0);
+  EXPECT_LE(window->first_sample + 1000, 4096U);
+}
+
+TEST(SnapshotTriggerTest, ACrossingTooEarlyToHaveItsPreTriggerIsPassedOver) {
+  // The first crossing has fifty samples before it and the window wants a
+  // hundred, so the window is placed around the next one instead.
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 50);
+  builder.AppendConstant(700, 950);
+  builder.AppendConstant(300, 1000);
+  builder.AppendConstant(700, 2096);
+
+  const std::optional<TriggeredWindow> window =
+      PlaceTriggeredWindow(builder.bytes().data(), 4096, 1000, {});
+  ASSERT_TRUE(window.has_value());
+  EXPECT_EQ(window->first_sample, 1899U);
+}
+
+TEST(SnapshotTriggerTest, ACrossingTooLateToHaveItsWindowAfterItIsPassedOver) {
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 4000);
+  builder.AppendConstant(700, 96);
+
+  EXPECT_FALSE(
+      PlaceTriggeredWindow(builder.bytes().data(), 4096, 1000, {}).has_value());
+}
+
+TEST(SnapshotTriggerTest, ASlotShorterThanTheWindowIsLeftAlone) {
+  test::WireStreamBuilder builder;
+  builder.AppendConstant(300, 500);
+  builder.AppendConstant(700, 500);
+
+  EXPECT_FALSE(
+      PlaceTriggeredWindow(builder.bytes().data(), 1000, 2000, {}).has_value());
+}
+
+}  // namespace
+}  // namespace ddd::capture
@@ -12,6 +12,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -453,6 +454,123 @@ TEST_F(SvfPlayerTest, ACableThatStopsAnsweringStopsTheRun) {
   EXPECT_NE(result.problem.find("cable"), std::string::npos) << result.problem;
 }
 
+// --- Compiled once, played many times --------------------------------------
+
+// The cable as it was before reads could be deferred: every answer asked for
+// is waited for there and then.
+class UnbatchedJtagCable : public FakeJtagCable {
+ public:
+  bool ShiftDeferred(std::span<const uint8_t> tms,
+                     std::span<const uint8_t> tdi, size_t bit_count,
+                     std::vector<uint8_t>* tdo) override {
+    return Shift(tms, tdi, bit_count, tdo);
+  }
+};
+
+// A file shaped like a verify pass: the same instruction loaded once and then
+// one data register read back after another, each compared against what the
+// file expects.
+std::string ReadBackSvf(size_t scans) {
+  std::string text = "STATE IDLE; SIR 10 TDI (003);";
+  for (size_t index = 0; index < scans; ++index) {
+    text += " SDR 8 TDI (00) TDO (00) MASK (FF);";
+  }
+  return text;
+}
+
+// What batching is for. Forty read-back scans are forty waits for the cable
+// when each is checked as it arrives, and one when they are all checked at the
+// end; the fake's round trip stands in for the millisecond a full-speed USB
+// one costs, and the two times are recorded for the log of a test run.
+TEST(SvfPlayerBatchingTest, ReadBackScansShareOneRoundTrip) {
+  constexpr size_t kScans = 40;
+  const SvfCompileResult compiled = CompileSvf(ReadBackSvf(kScans));
+  ASSERT_TRUE(compiled.succeeded) << compiled.problem;
+
+  UnbatchedJtagCable unbatched;
+  unbatched.SetRoundTripTime(std::chrono::milliseconds(1));
+  auto started = std::chrono::steady_clock::now();
+  ASSERT_TRUE(SvfPlayer(unbatched).Play(compiled.program).succeeded);
+  const auto unbatched_time = std::chrono::steady_clock::now() - started;
+
+  FakeJtagCable batched;
+  batched.SetRoundTripTime(std::chrono::milliseconds(1));
+  started = std::chrono::steady_clock::now();
+  ASSERT_TRUE(SvfPlayer(batched).Play(compiled.program).succeeded);
+  const auto batched_time = std::chrono::steady_clock::now() - started;
+
+  EXPECT_EQ(unbatched.round_trips(), kScans);
+  EXPECT_EQ(batched.round_trips(), 1u);
+
+  // The same cycles either way: batching changes when answers are looked at,
+  // never what is clocked.
+  EXPECT_EQ(AsBits(batched.tms()), AsBits(unbatched.tms()));
+  EXPECT_EQ(AsBits(batched.tdi()), AsBits(unbatched.tdi()));
+
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  ::testing::Test::RecordProperty(
+      "unbatched_us",
+      static_cast<int>(duration_cast<microseconds>(unbatched_time).count()));
+  ::testing::Test::RecordProperty(
+      "batched_us",
+      static_cast<int>(duration_cast<microseconds>(batched_time).count()));
+}
+
+// A disagreement found late is still reported as the scan that disagreed,
+// and not as whatever made the player look.
+TEST(SvfPlayerBatchingTest, ADeferredMismatchNamesItsOwnScan) {
+  FakeJtagCable cable;
+  std::vector<bool> answers(8 * 3, false);
+  answers[8 + 2] = true;
+  cable.AnswerWith(answers);
+
+  const SvfPlayResult result = SvfPlayer(cable).Play(
+      "STATE IDLE;\nSIR 10 TDI (003);\nSDR 8 TDI (00) TDO (00);\n"
+      "SDR 8 TDI (00) TDO (00);\nSDR 8 TDI (00) TDO (00);\n"
+      "RUNTEST 4 TCK;\n");
+
+  EXPECT_FALSE(result.succeeded);
+  EXPECT_EQ(result.line, 4u);
+  EXPECT_EQ(result.statement_keyword, "SDR");
+  EXPECT_EQ(result.statements, 3u);
+  EXPECT_NE(result.problem.find("at bit 2 of a 8-bit scan"), std::string::npos)
+      << result.problem;
+}
+
+// The bring-up plays the same vectors again when an attempt fails, and
+// what it plays the second time is what it read the first.
+TEST(SvfPlayerCompileTest, ACompiledFilePlaysTheSameEveryTime) {
+  const SvfCompileResult compiled = CompileSvf(kGrammarSvf);
+  ASSERT_TRUE(compiled.succeeded) << compiled.problem;
+  EXPECT_GT(compiled.program.MemoryBytes(), 0u);
+
+  FakeJtagCable first;
+  FakeJtagCable second;
+  const SvfPlayResult once = SvfPlayer(first).Play(compiled.program);
+  const SvfPlayResult again = SvfPlayer(second).Play(compiled.program);
+
+  ASSERT_TRUE(once.succeeded) << once.problem;
+  ASSERT_TRUE(again.succeeded) << again.problem;
+  EXPECT_EQ(AsBits(first.tms()), AsBits(second.tms()));
+  EXPECT_EQ(AsBits(first.tdi()), AsBits(second.tdi()));
+  EXPECT_EQ(once.statements, again.statements);
+  EXPECT_EQ(once.shifted_bits, again.shifted_bits);
+}
+
+// A malformed file is refused whole, before the cable has clocked a cycle,
+// rather than after everything up to the bad line has been sent.
+TEST(SvfPlayerCompileTest, AFileThatDoesNotCompileSendsNothing) {
+  FakeJtagCable cable;
+
+  const SvfPlayResult result =
+      SvfPlayer(cable).Play("STATE IDLE; SDR 4 TDI (0);\nBOGUS;");
+
+  EXPECT_FALSE(result.succeeded);
+  EXPECT_EQ(result.line, 2u);
+  EXPECT_EQ(cable.clocks(), 0u);
+}
+
 // --- Without a cable at all ------------------------------------------------
 
 // What the shell tool's dry run is: everything this application contributes,
@@ -11,6 +11,8 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iostream>
 #include <optional>
 #include <vector>
 
@@ -159,5 +161,115 @@ TEST(TestPatternVerifierTest, SequenceMarkersDoNotLookLikeSignal) {
   EXPECT_FALSE(verifier.HasFailed());
 }
 
+TEST(TestPatternVerifierTest, ABreakInsideALongRunIsFoundAtItsExactOffset) {
+  // The verifier compares whole runs at once and only walks a run sample by
+  // sample once it knows there is a break in it. Every offset in and around
+  // one run, from a start part-way through the ramp, must still report the
+  // sample, the expectation and the value exactly as a walk would have.
+  for (size_t broken = 1; broken < 2100; broken += 7) {
+    std::vector<uint16_t> samples = Ramp(1019, 3000, 1021);
+    const uint16_t expected = samples[broken];
+    samples[broken] = static_cast<uint16_t>(expected ^ 0x200);
+
+    TestPatternVerifier verifier;
+    ASSERT_FALSE(verifier.Feed(samples.data(), samples.size()));
+    ASSERT_EQ(verifier.GetResult().samples_checked, broken) << broken;
+    EXPECT_EQ(verifier.GetResult().expected_value, expected) << broken;
+    EXPECT_EQ(verifier.GetResult().actual_value, samples[broken]) << broken;
+  }
+}
+
+TEST(TestPatternVerifierTest, ABreakInWireWordsIsFoundAtItsExactOffset) {
+  test::WireStreamBuilder builder;
+  builder.AppendRamp(3000);
+  std::vector<uint8_t> wire = builder.bytes();
+
+  // Sample 1500 is 1500 % 1021 = 479; flipping its lowest bit makes it 478
+  wire[1500 * 2] ^= 0x01;
+
+  TestPatternVerifier verifier;
+  ASSERT_FALSE(verifier.FeedWireBytes(wire.data(), wire.size()));
+  EXPECT_EQ(verifier.GetResult().samples_checked, 1500U);
+  EXPECT_EQ(verifier.GetResult().expected_value, 479);
+  EXPECT_EQ(verifier.GetResult().actual_value, 478);
+}
+
+TEST(TestPatternVerifierTest, AWrapIsRecordedEvenWhenTheWrappingSampleIsBad) {
+  // The length is known from the moment the expectation wraps, whatever the
+  // sample there turns out to be — which is what the sample-at-a-time check
+  // always reported, and a run compared whole has to agree.
+  std::vector<uint16_t> samples = Ramp(1000, 100, 1021);
+  samples[21] = 5;
+
+  TestPatternVerifier verifier;
+  ASSERT_FALSE(verifier.Feed(samples.data(), samples.size()));
+  EXPECT_EQ(verifier.GetResult().samples_checked, 21U);
+  EXPECT_EQ(verifier.GetResult().expected_value, 0);
+  EXPECT_EQ(verifier.GetResult().sequence_length,
+            std::optional<uint16_t>(1021));
+}
+
+TEST(TestPatternVerifierTest, AStreamSeededOutsideTheRampExpectsZeroNext) {
+  // A seed past the end of the ramp is a stream that is not the test pattern,
+  // and the next sample is judged against the wrap rather than counted on
+  // from the seed for ever.
+  const std::vector<uint16_t> samples = {1023, 0, 1, 2};
+
+  TestPatternVerifier verifier;
+  EXPECT_TRUE(verifier.Feed(samples.data(), samples.size()));
+  EXPECT_EQ(verifier.GetResult().sequence_length,
+            std::optional<uint16_t>(1021));
+}
+
+TEST(TestPatternVerifierTest, AFileIsCheckedFarFasterThanItWasCaptured) {
+  // The rate a test file is analysed at, and the rate the live path adds to the
+  // processing thread's work in test mode. Ten 2 MB buffers' worth, through
+  // both entry points.
+  constexpr size_t kSamples = size_t{10} << 20;
+  const std::vector<uint16_t> samples = Ramp(0, kSamples, 1021);
+  test::WireStreamBuilder builder;
+  builder.AppendRamp(kSamples);
+  const std::vector<uint8_t> wire = builder.bytes();
+
+  const auto samples_per_second = [&](auto feed) {
+    // One pass to warm the caches, then the best of three, which is the
+    // machine's speed rather than whatever else it was doing at the time
+    feed();
+    double best_seconds = 0.0;
+    for (int pass = 0; pass < 3; ++pass) {
+      const auto started = std::chrono::steady_clock::now();
+      feed();
+      const double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - started)
+                                 .count();
+      if (pass == 0 || seconds < best_seconds) {
+        best_seconds = seconds;
+      }
+    }
+    return static_cast<double>(kSamples) / best_seconds;
+  };
+
+  const double from_samples = samples_per_second([&] {
+    TestPatternVerifier verifier;
+    EXPECT_TRUE(verifier.Feed(samples.data(), samples.size()));
+  });
+  const double from_wire = samples_per_second([&] {
+    TestPatternVerifier verifier;
+    EXPECT_TRUE(verifier.FeedWireBytes(wire.data(), wire.size()));
+  });
+
+  // Printed whether it passes or not, like the validator's budget
+  std::cout << "[          ] ramp check: " << from_samples / 1.0e6
+            << " Msamples/s from sample values, " << from_wire / 1.0e6
+            << " Msamples/s from wire words (capture rate 40)\n";
+
+  // Five times the capture rate, which even an unoptimised build clears: the
+  // live check is then a fifth of a core at most, and an hour's test file is
+  // checked in twelve minutes at worst. An optimised build is several times
+  // past it.
+  EXPECT_GT(from_samples, 200.0e6);
+  EXPECT_GT(from_wire, 200.0e6);
+}
+
 }  // namespace
 }  // namespace ddd::capture
@@ -0,0 +1,333 @@
+/************************************************************************
+
+    test_thread_usage.cpp
+
+    T1 tests for the capture threads' scheduling accounting
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_usage.h"
+
+namespace ddd::capture {
+namespace {
+
+// /proc/<pid>/task/<tid>/stat for a thread whose name holds both a space and a
+// closing parenthesis — the case that defeats splitting on whitespace.
+constexpr const char* kTaskStat =
+    "4242 (ddd (worker) 1) S 4200 4200 4200 0 -1 4194368 "
+    "1234 0 7 0 250 30 0 0 -11 0 9 0 123456 0 0";
+
+constexpr const char* kTaskStatus =
+    "Name:\tddd-gui\n"
+    "State:\tS (sleeping)\n"
+    "voluntary_ctxt_switches:\t3120\n"
+    "nonvoluntary_ctxt_switches:\t14\n";
+
+constexpr const char* kTaskSched =
+    "ddd-gui (4242, #threads: 9)\n"
+    "-------------------------------------------------------------------\n"
+    "se.exec_start                                :      12345.678901\n"
+    "se.nr_migrations                             :                 6\n"
+    "nr_switches                                  :              3134\n";
+
+TEST(ThreadUsageTest, ReadsFaultsAndCpuTimeOutOfTheStatLine) {
+  ThreadUsage usage;
+  ASSERT_TRUE(ParseTaskStat(kTaskStat, usage));
+
+  EXPECT_EQ(usage.minor_faults, 1234U);
+  EXPECT_EQ(usage.major_faults, 7U);
+
+  // In clock ticks on the wire. Compared as a ratio so the test does not care
+  // what this machine's tick rate is.
+  EXPECT_GT(usage.user_seconds, 0.0);
+  EXPECT_NEAR(usage.system_seconds / usage.user_seconds, 30.0 / 250.0, 1e-9);
+}
+
+TEST(ThreadUsageTest, RefusesAStatLineThatIsNotOne) {
+  ThreadUsage usage;
+  EXPECT_FALSE(ParseTaskStat("", usage));
+  EXPECT_FALSE(ParseTaskStat("4242 (short) S 1 2", usage));
+}
+
+TEST(ThreadUsageTest, ReadsBothKindsOfContextSwitch) {
+  ThreadUsage usage;
+  ASSERT_TRUE(ParseTaskStatus(kTaskStatus, usage));
+
+  EXPECT_EQ(usage.voluntary_switches, 3120U);
+  EXPECT_EQ(usage.involuntary_switches, 14U);
+}
+
+// "voluntary_ctxt_switches" is a suffix of the other key, and the other key is
+// listed first here. Matching on a substring would read 9 for both.
+TEST(ThreadUsageTest, DoesNotConfuseTheTwoSwitchCounters) {
+  ThreadUsage usage;
+  ASSERT_TRUE(ParseTaskStatus(
+      "nonvoluntary_ctxt_switches:\t9\nvoluntary_ctxt_switches:\t2\n", usage));
+
+  EXPECT_EQ(usage.voluntary_switches, 2U);
+  EXPECT_EQ(usage.involuntary_switches, 9U);
+}
+
+TEST(ThreadUsageTest, ReadsMigrationsWhereTheKernelKeepsThem) {
+  ThreadUsage usage;
+  ASSERT_TRUE(ParseTaskSched(kTaskSched, usage));
+  EXPECT_TRUE(usage.migrations_known);
+  EXPECT_EQ(usage.migrations, 6U);
+
+  // A kernel built without the scheduler's debug statistics has no such line,
+  // and that is unknown rather than zero.
+  ThreadUsage without;
+  EXPECT_FALSE(ParseTaskSched("nr_switches : 12\n", without));
+  EXPECT_FALSE(without.migrations_known);
+}
+
+TEST(ThreadUsageTest, ReadsAThreadOutOfATaskDirectory) {
+  const std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "ddd_thread_usage_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root / "4242");
+  std::ofstream(root / "4242" / "stat") << kTaskStat;
+  std::ofstream(root / "4242" / "status") << kTaskStatus;
+
+  const ThreadUsage usage = ReadThreadUsage(4242, root);
+  EXPECT_TRUE(usage.present);
+  EXPECT_EQ(usage.threads, 1U);
+  EXPECT_EQ(usage.involuntary_switches, 14U);
+  EXPECT_FALSE(usage.migrations_known);
+
+  // A thread that has exited has no directory, and reads as nothing.
+  EXPECT_FALSE(ReadThreadUsage(4243, root).present);
+
+  const auto listed = ListProcessThreadIds(root);
+  ASSERT_TRUE(listed.has_value());
+  EXPECT_EQ(*listed, std::vector<uint64_t>{4242});
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(ThreadUsageTest, ReadsAThreadsNameWithoutTheNewline) {
+  const std::filesystem::path root =
+      std::filesystem::temp_directory_path() / "ddd_thread_name_test";
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root / "4242");
+  std::ofstream(root / "4242" / "comm") << "ddd-flac-enc\n";
+
+  EXPECT_EQ(ReadThreadName(4242, root),
+            std::optional<std::string>("ddd-flac-enc"));
+  EXPECT_FALSE(ReadThreadName(4243, root).has_value());
+
+  std::filesystem::remove_all(root);
+}
+
+// What FlacWriter relies on to tell libFLAC's workers from anyone else's: a
+// thread started while its starter carries a name carries it too, and the
+// starter can have its own back afterwards.
+TEST(ThreadUsageTest, AThreadStartedAfterARenameInheritsTheName) {
+  std::optional<std::string> own_name = RenameCurrentThread("ddd-renamed");
+  if (!own_name) {
+    GTEST_SKIP() << "This platform cannot rename a thread";
+  }
+
+  uint64_t child_id = 0;
+  std::optional<std::string> child_name;
+  std::thread child([&] {
+    child_id = CurrentNativeThreadId();
+    child_name = ReadThreadName(child_id);
+  });
+  child.join();
+  RenameCurrentThread(*own_name);
+
+  EXPECT_EQ(child_name, std::optional<std::string>("ddd-renamed"));
+  EXPECT_EQ(ReadThreadName(CurrentNativeThreadId()), own_name);
+}
+
+TEST(ThreadUsageTest, ADifferenceIsWhatHappenedInBetween) {
+  ThreadUsage earlier;
+  earlier.present = true;
+  earlier.threads = 1;
+  earlier.user_seconds = 1.0;
+  earlier.involuntary_switches = 10;
+  earlier.major_faults = 2;
+  earlier.migrations_known = true;
+  earlier.migrations = 3;
+
+  ThreadUsage later = earlier;
+  later.user_seconds = 1.5;
+  later.involuntary_switches = 25;
+  later.major_faults = 2;
+  later.migrations = 4;
+
+  const ThreadUsage difference = later.Since(earlier);
+  EXPECT_TRUE(difference.present);
+  EXPECT_DOUBLE_EQ(difference.user_seconds, 0.5);
+  EXPECT_EQ(difference.involuntary_switches, 15U);
+  EXPECT_EQ(difference.major_faults, 0U);
+  EXPECT_EQ(difference.migrations, 1U);
+  EXPECT_EQ(difference.threads, 1U);
+}
+
+// A total over fewer threads than before is a total that lost some, and
+// wrapping it would report eighteen quintillion preemptions.
+TEST(ThreadUsageTest, ACounterThatWentBackwardsIsTakenAsZero) {
+  ThreadUsage earlier;
+  earlier.present = true;
+  earlier.voluntary_switches = 100;
+
+  ThreadUsage later;
+  later.present = true;
+  later.voluntary_switches = 40;
+
+  EXPECT_EQ(later.Since(earlier).voluntary_switches, 0U);
+}
+
+TEST(ThreadUsageTest, AnAbsentReadingStaysAbsent) {
+  ThreadUsage present;
+  present.present = true;
+
+  EXPECT_FALSE(ThreadUsage{}.Since(present).present);
+  EXPECT_EQ(ThreadUsage{}.Describe(), "not measured");
+
+  ThreadUsage sum;
+  sum.Add(ThreadUsage{});
+  EXPECT_FALSE(sum.present);
+}
+
+TEST(ThreadUsageTest, ASumKnowsMigrationsOnlyIfEveryPartDid) {
+  ThreadUsage known;
+  known.present = true;
+  known.threads = 1;
+  known.migrations_known = true;
+  known.migrations = 5;
+
+  ThreadUsage unknown;
+  unknown.present = true;
+  unknown.threads = 1;
+
+  ThreadUsage sum;
+  sum.Add(known);
+  EXPECT_TRUE(sum.migrations_known);
+  sum.Add(unknown);
+  EXPECT_FALSE(sum.migrations_known);
+  EXPECT_EQ(sum.threads, 2U);
+}
+
+// The whole arrangement against the real kernel: a thread registers, does some
+// work, retires, and is charged for it. Only meaningful where the platform
+// keeps the counts, which the reading itself says.
+TEST(ThreadUsageTest, ChargesARegisteredThreadForTheWorkItDid) {
+  if (!ReadCurrentThreadUsage().present) {
+    GTEST_SKIP() << "This platform does not keep per-thread counters";
+  }
+
+  ThreadAccounting accounting;
+  std::thread worker([&accounting] {
+    accounting.RegisterCurrentThread(ThreadAccounting::Role::kProcessing);
+
+    const auto until =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(60);
+    volatile uint64_t spin = 0;
+    while (std::chrono::steady_clock::now() < until) {
+      spin = spin + 1;
+    }
+
+    accounting.RetireCurrentThread();
+  });
+  worker.join();
+
+  const CaptureThreadUsage totals = accounting.Totals();
+  EXPECT_TRUE(totals.processing.present);
+  EXPECT_EQ(totals.processing.threads, 1U);
+  EXPECT_GT(totals.processing.CpuSeconds(), 0.0);
+  EXPECT_FALSE(totals.transfer.present);
+  EXPECT_FALSE(totals.encoder.present);
+}
+
+TEST(ThreadUsageTest, SamplesALiveThreadFromAnotherOne) {
+  if (!ListProcessThreadIds().has_value()) {
+    GTEST_SKIP() << "This platform cannot list a process's threads";
+  }
+
+  ThreadAccounting accounting;
+  accounting.RegisterCurrentThread(ThreadAccounting::Role::kTransfer);
+
+  std::thread sampler([&accounting] { accounting.Sample(); });
+  sampler.join();
+
+  EXPECT_TRUE(accounting.Totals().transfer.present);
+  accounting.RetireCurrentThread();
+}
+
+// A registered thread that is gone by the next sample, as libFLAC's are once
+// their encoder is deleted, is dropped from the list but not from the totals.
+TEST(ThreadUsageTest, AThreadThatExitedKeepsWhatItWasCharged) {
+  if (!ReadCurrentThreadUsage().present) {
+    GTEST_SKIP() << "This platform does not keep per-thread counters";
+  }
+
+  ThreadAccounting accounting;
+  uint64_t worker_id = 0;
+  std::thread worker([&] {
+    worker_id = CurrentNativeThreadId();
+    accounting.RegisterThreads(ThreadAccounting::Role::kEncoder, {worker_id});
+
+    const auto until =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(60);
+    volatile uint64_t spin = 0;
+    while (std::chrono::steady_clock::now() < until) {
+      spin = spin + 1;
+    }
+    accounting.Sample();
+  });
+  worker.join();
+  accounting.Sample();
+
+  const CaptureThreadUsage totals = accounting.Totals();
+  EXPECT_TRUE(totals.encoder.present);
+  EXPECT_EQ(totals.encoder.threads, 1U);
+  EXPECT_GT(totals.encoder.CpuSeconds(), 0.0);
+
+  // Retiring it afterwards finds nothing left to retire and counts nothing
+  // twice.
+  accounting.RetireThreads({worker_id});
+  EXPECT_EQ(accounting.Totals().encoder.threads, 1U);
+}
+
+// Registering from one thread while another samples, the arrangement the
+// pipeline has for the whole of a capture. Run under TSan to mean much.
+TEST(ThreadUsageTest, SamplesWhileAnotherThreadRegisters) {
+  if (!ListProcessThreadIds().has_value()) {
+    GTEST_SKIP() << "This platform cannot list a process's threads";
+  }
+
+  ThreadAccounting accounting;
+  std::thread sampler([&accounting] {
+    for (int i = 0; i < 50; ++i) {
+      accounting.Sample();
+    }
+  });
+  const uint64_t own_id = CurrentNativeThreadId();
+  for (int i = 0; i < 50; ++i) {
+    accounting.RegisterThreads(ThreadAccounting::Role::kEncoder, {own_id});
+    accounting.RetireThreads({own_id});
+  }
+  sampler.join();
+
+  EXPECT_TRUE(accounting.Totals().encoder.present);
+}
+
+}  // namespace
+}  // namespace ddd::capture
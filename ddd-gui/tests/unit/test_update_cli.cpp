@@ -54,6 +54,23 @@ TEST(UpdateCliOptions, TakesADevicePathAndADryRun) {
   EXPECT_EQ(options.bundle_path, "bundle.dddfw");
 }
 
+TEST(UpdateCliOptions, TakesAll) {
+  const UpdateCliOptions options =
+      ParseUpdateCliOptions({"--all", "bundle.dddfw"});
+
+  EXPECT_TRUE(options.problem.empty());
+  EXPECT_TRUE(options.all_devices);
+  EXPECT_TRUE(options.device_path.empty());
+}
+
+// Every device and this one device are two different requests, and guessing
+// which was meant would be guessing which devices to write firmware to.
+TEST(UpdateCliOptions, RefusesAllWithADevice) {
+  const UpdateCliOptions options = ParseUpdateCliOptions(
+      {"--all", "--device", "/sys/bus/usb/devices/1-2", "bundle.dddfw"});
+  EXPECT_FALSE(options.problem.empty());
+}
+
 TEST(UpdateCliOptions, RefusesADeviceOptionWithNothingAfterIt) {
   const UpdateCliOptions options = ParseUpdateCliOptions({"--device"});
   EXPECT_FALSE(options.problem.empty());
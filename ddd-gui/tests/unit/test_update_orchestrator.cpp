@@ -11,6 +11,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <string_view>
@@ -438,6 +441,123 @@ TEST(UpdateOrchestrator, StopsWhenAskedTo) {
             std::string::npos);
 }
 
+// --- Keeping the transfer busy -------------------------------------------
+
+TEST(UpdateOrchestrator, KeepsSeveralChunksInFlight) {
+  const TestBundle test(65536);
+  FakeDeviceUpdater device;
+
+  ASSERT_TRUE(RunUpdate(device, test.bundle).succeeded);
+  EXPECT_EQ(device.chunks_in_flight(), UpdateTimings{}.chunks_in_flight);
+  EXPECT_GT(device.chunks_in_flight(), 1U);
+}
+
+// A rack of units, from one bundle, at once: every one of them gets the whole
+// payload and is restarted and proved.
+TEST(UpdateOrchestratorFleet, UpdatesEveryDeviceFromOneBundle) {
+  const TestBundle test(20000);
+  std::vector<std::unique_ptr<FakeDeviceUpdater>> fakes;
+  std::vector<IDeviceUpdater*> devices;
+  for (int count = 0; count < 3; ++count) {
+    fakes.push_back(std::make_unique<FakeDeviceUpdater>());
+    devices.push_back(fakes.back().get());
+  }
+
+  std::atomic<int> reports{0};
+  const std::vector<UpdateOutcome> outcomes = RunUpdateOnEach(
+      devices, test.bundle, nullptr, FastTimings(),
+      [&reports](size_t, const UpdateProgress&) { ++reports; });
+
+  ASSERT_EQ(outcomes.size(), 3U);
+  for (size_t device = 0; device < outcomes.size(); ++device) {
+    EXPECT_TRUE(outcomes[device].succeeded) << outcomes[device].problem;
+    EXPECT_TRUE(outcomes[device].identity_confirmed);
+    EXPECT_EQ(fakes[device]->received(UpdateTarget::kFirmware),
+              test.firmware_payload);
+    EXPECT_EQ(fakes[device]->reset_count(), 1U);
+  }
+  EXPECT_GT(reports.load(), 0);
+}
+
+// One device refusing a chunk is that device's failure, and only its.
+TEST(UpdateOrchestratorFleet, OneDeviceFailingStopsNoOther) {
+  const TestBundle test(20000);
+  FakeDeviceUpdater good;
+  FakeDeviceUpdater bad;
+  bad.SetFault(FakeDeviceUpdater::Fault::kRefuseChunk);
+  bad.SetFailAtChunk(2);
+
+  std::vector<IDeviceUpdater*> devices{&good, &bad, nullptr};
+  const std::vector<UpdateOutcome> outcomes =
+      RunUpdateOnEach(devices, test.bundle, nullptr, FastTimings());
+
+  ASSERT_EQ(outcomes.size(), 3U);
+  EXPECT_TRUE(outcomes[0].succeeded);
+  EXPECT_FALSE(outcomes[1].succeeded);
+  EXPECT_EQ(bad.reset_count(), 0U);
+
+  // The device that could not be opened still has its place in the list.
+  EXPECT_FALSE(outcomes[2].succeeded);
+  EXPECT_EQ(outcomes[2].stage, UpdateStage::kFailed);
+}
+
+// What the fleet path is for: four devices written at once rather than one
+// after another. Asserted on what the devices saw — how many of them were
+// writing a chunk at the same moment — rather than on chunks per second, which
+// a loaded CI machine turns into a coin toss. The rates are still recorded,
+// each fake taking a millisecond per chunk as a device would, for whoever
+// wants to see what the overlap buys.
+TEST(UpdateOrchestratorFleet, WritesEveryDeviceAtOnce) {
+  const TestBundle test(65536);
+  constexpr std::chrono::microseconds kChunkLatency{1000};
+  constexpr int kDevices = 4;
+
+  FakeDeviceUpdater alone;
+  alone.SetChunkLatency(kChunkLatency);
+  const auto alone_started = std::chrono::steady_clock::now();
+  ASSERT_TRUE(RunUpdate(alone, test.bundle).succeeded);
+  const double alone_seconds = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() -
+                                   alone_started)
+                                   .count();
+  const double alone_rate =
+      static_cast<double>(alone.chunk_count()) / alone_seconds;
+
+  ChunkConcurrencyProbe probe(kDevices);
+  std::vector<std::unique_ptr<FakeDeviceUpdater>> fakes;
+  std::vector<IDeviceUpdater*> devices;
+  for (int count = 0; count < kDevices; ++count) {
+    fakes.push_back(std::make_unique<FakeDeviceUpdater>());
+    fakes.back()->SetChunkLatency(kChunkLatency);
+    fakes.back()->SetConcurrencyProbe(&probe);
+    devices.push_back(fakes.back().get());
+  }
+
+  const auto fleet_started = std::chrono::steady_clock::now();
+  const std::vector<UpdateOutcome> outcomes =
+      RunUpdateOnEach(devices, test.bundle, nullptr, FastTimings());
+  const double fleet_seconds = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() -
+                                   fleet_started)
+                                   .count();
+
+  uint64_t fleet_chunks = 0;
+  for (size_t device = 0; device < outcomes.size(); ++device) {
+    ASSERT_TRUE(outcomes[device].succeeded);
+    fleet_chunks += fakes[device]->chunk_count();
+  }
+  const double fleet_rate = static_cast<double>(fleet_chunks) / fleet_seconds;
+
+  RecordProperty("chunks_per_second_one_device",
+                 static_cast<int>(alone_rate));
+  RecordProperty("chunks_per_second_four_devices",
+                 static_cast<int>(fleet_rate));
+  RecordProperty("transfer_chunks_per_second",
+                 static_cast<int>(alone.ChunksPerSecond()));
+
+  EXPECT_EQ(probe.most_at_once(), kDevices);
+}
+
 // --- The gateware target ---------------------------------------------------
 
 // A bundle carrying both halves, which is what a release bundle is.
@@ -130,6 +130,65 @@ TEST_F(UsbBlasterCableTest, TdoIsAskedForBeforeTheRisingEdge) {
   EXPECT_EQ(Unpacked(tdo, 1), "1");
 }
 
+// A scan read back is one trip to the cable, not one per bit. The answers are
+// one byte each in the stream the chip sends, in the order they were asked
+// for, so they can all be asked for before any is read.
+TEST_F(UsbBlasterCableTest, AScanReadBackIsOneRoundTripRatherThanOnePerBit) {
+  std::vector<uint8_t> answers(32, 0x00);
+  answers[3] = 0x01;
+  answers[31] = 0x01;
+  transport_.AnswerWith(answers);
+
+  std::vector<uint8_t> tdo;
+  const std::string cycles(32, '0');
+  ASSERT_TRUE(Shift(cycles, cycles, &tdo));
+
+  EXPECT_EQ(transport_.writes(), 1u);
+  EXPECT_EQ(transport_.reads(), 1u);
+  EXPECT_EQ(Unpacked(tdo, 32), "00010000000000000000000000000001");
+}
+
+// A deferred answer is owed until the next flush, and nothing goes on the wire
+// for it before then: the whole point is that the scans behind it do not
+// wait.
+TEST_F(UsbBlasterCableTest, ADeferredAnswerArrivesWithTheNextFlush) {
+  transport_.AnswerWith({0x01, 0x00, 0x00, 0x01});
+
+  std::vector<uint8_t> first;
+  std::vector<uint8_t> second;
+  ASSERT_TRUE(
+      cable_->ShiftDeferred(Packed("00"), Packed("00"), 2, &first));
+  ASSERT_TRUE(
+      cable_->ShiftDeferred(Packed("00"), Packed("00"), 2, &second));
+  EXPECT_TRUE(transport_.written().empty());
+
+  ASSERT_TRUE(cable_->Flush());
+  EXPECT_EQ(transport_.reads(), 1u);
+  EXPECT_EQ(Unpacked(first, 2), "10");
+  EXPECT_EQ(Unpacked(second, 2), "01");
+}
+
+// But never more owed than the chip can hold. Each answer waits in its
+// transmit buffer until it is read, and a host that asked for more than fits
+// would stall the cable behind a write that could never finish.
+TEST_F(UsbBlasterCableTest, OwedAnswersAreCollectedBeforeTheChipCouldFillUp) {
+  // One payload byte to a packet, so that the fake never hands over an answer
+  // before the read that asked for it has been sent — as the chip cannot.
+  FakeFtdiTransport one_at_a_time(kFtdiStatusBytes + 1);
+  std::unique_ptr<IJtagCable> cable =
+      MakeUsbBlasterCableOver(one_at_a_time, nullptr);
+  one_at_a_time.AnswerWith(std::vector<uint8_t>(200, 0x01));
+
+  std::vector<uint8_t> tdo;
+  const std::string cycles(200, '0');
+  ASSERT_TRUE(cable->ShiftDeferred(Packed(cycles), Packed(cycles), 200, &tdo));
+  ASSERT_TRUE(cable->Flush());
+
+  EXPECT_GE(one_at_a_time.writes(), 4u)
+      << "two hundred answers were owed to the chip at once";
+  EXPECT_EQ(Unpacked(tdo, 200), std::string(200, '1'));
+}
+
 // --- Byte-shift ------------------------------------------------------------
 
 // Eight cycles with TMS low become one command and one data byte: eight
@@ -308,12 +367,12 @@ TEST_F(UsbBlasterCableTest, ACableThatOnlySendsStatusIsGivenUpOn) {
 // And a cable that answers with *more* than it was asked for is refused too,
 // which is the less obvious half of the same rule.
 //
-// One read is outstanding at a time, so a surplus byte is one nothing asked
-// for and the stream is out of step: every answer after it belongs to the
-// cycle before. Dropping the surplus — which is what this used to do — turns
-// that into a scan that reads back plausible rubbish and fails a comparison
-// somewhere unrelated, clears on the next run, and cannot be diagnosed from
-// the message it produces.
+// Every read outstanding is accounted for, so a surplus byte is one nothing
+// asked for and the stream is out of step: every answer after it belongs to
+// the cycle before. Dropping the surplus — which is what this used to do —
+// turns that into a scan that reads back plausible rubbish and fails a
+// comparison somewhere unrelated, clears on the next run, and cannot be
+// diagnosed from the message it produces.
 TEST_F(UsbBlasterCableTest, ACableThatSaysMoreThanItWasAskedForIsRefused) {
   transport_.AnswerWith({0x01, 0x00});
 
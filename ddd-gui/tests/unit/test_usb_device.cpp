@@ -11,6 +11,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -465,5 +468,147 @@ TEST(TransferLayoutTest, BuffersAreHandedOverInTheOrderTheConsumerReadsThem) {
   }
 }
 
+// --- Queued control transfers ---------------------------------------------
+
+// A ring whose transfers finish when they are waited for, and which records
+// what the run did with it: how deep it went, the order it waited in, and
+// which outcomes it asked about. The libusb backend is this with the transfers
+// handed to the controller; what is under test here is everything around that.
+class FakeQueuedRing : public IQueuedControlRing {
+ public:
+  explicit FakeQueuedRing(size_t depth) : slots_(depth) {}
+
+  bool Submit(size_t slot, const ControlWrite& write) override {
+    if (refuse_submit_at_ && submitted_ == *refuse_submit_at_) {
+      return false;
+    }
+    EXPECT_FALSE(slots_[slot].has_value()) << "slot " << slot << " was busy";
+    slots_[slot] = write.value;
+    ++submitted_;
+    ++in_flight_;
+    most_in_flight_ = std::max(most_in_flight_, in_flight_);
+    return true;
+  }
+
+  void Wait(size_t slot) override {
+    EXPECT_TRUE(slots_[slot].has_value()) << "slot " << slot << " was idle";
+    waited_.push_back(slots_[slot].value_or(0xFFFF));
+    slots_[slot].reset();
+    --in_flight_;
+  }
+
+  // Always asked straight after the slot's Wait, so the transfer in question
+  // is the one last waited for.
+  bool Succeeded(size_t /*slot*/) override {
+    const uint16_t value = waited_.back();
+    asked_.push_back(value);
+    return !fail_value_ || value != *fail_value_;
+  }
+
+  std::optional<uint16_t> fail_value_;
+  std::optional<size_t> refuse_submit_at_;
+  size_t submitted_ = 0;
+  size_t in_flight_ = 0;
+  size_t most_in_flight_ = 0;
+  std::vector<uint16_t> waited_;
+  std::vector<uint16_t> asked_;
+
+ private:
+  std::vector<std::optional<uint16_t>> slots_;
+};
+
+// Writes whose `value` is their position, so the order they were waited in is
+// the list of values.
+std::vector<ControlWrite> NumberedWrites(size_t count) {
+  std::vector<ControlWrite> writes(count);
+  for (size_t index = 0; index < count; ++index) {
+    writes[index].value = static_cast<uint16_t>(index);
+  }
+  return writes;
+}
+
+std::vector<uint16_t> Sequence(size_t count) {
+  std::vector<uint16_t> values(count);
+  for (size_t index = 0; index < count; ++index) {
+    values[index] = static_cast<uint16_t>(index);
+  }
+  return values;
+}
+
+// The point of the queue: the ring is kept as full as it was asked to be, and
+// completions are still counted in the order the device saw the requests.
+TEST(QueuedControlTransferTest, KeepsTheRingFullAndReapsOldestFirst) {
+  const std::vector<ControlWrite> writes = NumberedWrites(20);
+  FakeQueuedRing ring(4);
+  std::vector<size_t> reported;
+
+  const size_t completed = RunQueuedControlTransfers(
+      writes, 4, ring, [&reported](size_t count) {
+        reported.push_back(count);
+        return true;
+      });
+
+  EXPECT_EQ(completed, 20U);
+  EXPECT_EQ(ring.most_in_flight_, 4U);
+  EXPECT_EQ(ring.waited_, Sequence(20));
+  ASSERT_EQ(reported.size(), 20U);
+  EXPECT_EQ(reported.front(), 1U);
+  EXPECT_EQ(reported.back(), 20U);
+}
+
+// A refused chunk ends the count at the chunk before it. The ones already in
+// flight behind it are waited for — a control transfer is never abandoned
+// mid-data-stage — but not counted, and not asked about, so each does not log
+// the same refusal again.
+TEST(QueuedControlTransferTest, AFailureEndsTheCountButEveryOneIsWaitedFor) {
+  const std::vector<ControlWrite> writes = NumberedWrites(20);
+  FakeQueuedRing ring(4);
+  ring.fail_value_ = 5;
+
+  const size_t completed = RunQueuedControlTransfers(writes, 4, ring, nullptr);
+
+  EXPECT_EQ(completed, 5U);
+  EXPECT_EQ(ring.submitted_, 9U);
+  EXPECT_EQ(ring.waited_, Sequence(9));
+  EXPECT_EQ(ring.asked_, Sequence(6));
+  EXPECT_EQ(ring.in_flight_, 0U);
+}
+
+// The caller stopping is the same: nothing more goes in, what is out comes
+// back, and the count is where the caller stopped.
+TEST(QueuedControlTransferTest, ACallerThatStopsIsNotSentMore) {
+  const std::vector<ControlWrite> writes = NumberedWrites(20);
+  FakeQueuedRing ring(4);
+
+  const size_t completed = RunQueuedControlTransfers(
+      writes, 4, ring, [](size_t count) { return count < 3; });
+
+  EXPECT_EQ(completed, 3U);
+  EXPECT_EQ(ring.submitted_, 6U);
+  EXPECT_EQ(ring.in_flight_, 0U);
+}
+
+// A submission the backend could not make ends the run, but the transfers
+// already out ahead of it reached the device and still count. Dropping them
+// would have the caller resend chunks the device has already taken, which it
+// refuses as out of sequence.
+TEST(QueuedControlTransferTest, ASubmissionThatFailsStillCountsThoseAhead) {
+  const std::vector<ControlWrite> writes = NumberedWrites(20);
+  FakeQueuedRing ring(4);
+  ring.refuse_submit_at_ = 7;
+  size_t reported = 0;
+
+  const size_t completed =
+      RunQueuedControlTransfers(writes, 4, ring, [&reported](size_t count) {
+        reported = count;
+        return true;
+      });
+
+  EXPECT_EQ(completed, 7U);
+  EXPECT_EQ(reported, 7U);
+  EXPECT_EQ(ring.waited_, Sequence(7));
+  EXPECT_EQ(ring.in_flight_, 0U);
+}
+
 }  // namespace
 }  // namespace ddd::capture
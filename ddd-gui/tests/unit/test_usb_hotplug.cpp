@@ -0,0 +1,114 @@
+/************************************************************************
+
+    test_usb_hotplug.cpp
+
+    T1 tests for reading the kernel's device events
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+
+#include "usb_hotplug.h"
+#include "wire_protocol.h"
+
+namespace ddd::capture {
+namespace {
+
+// A datagram as the kernel sends it: a header, then NUL-separated pairs, with
+// no terminator after the last. Built with std::string's length so that the
+// NULs survive.
+std::string Datagram(const std::string& header,
+                     std::initializer_list<std::string> pairs) {
+  std::string datagram = header;
+  for (const std::string& pair : pairs) {
+    datagram.push_back('\0');
+    datagram += pair;
+  }
+  return datagram;
+}
+
+std::string DuplicatorEvent(const std::string& action) {
+  return Datagram(action + "@/devices/pci0000:00/0000:00:14.0/usb2/2-1",
+                  {"ACTION=" + action,
+                   "DEVPATH=/devices/pci0000:00/0000:00:14.0/usb2/2-1",
+                   "SUBSYSTEM=usb", "MAJOR=189", "MINOR=129",
+                   "DEVNAME=bus/usb/002/002", "DEVTYPE=usb_device",
+                   "PRODUCT=1209/2347/100", "TYPE=0/0/0", "BUSNUM=002",
+                   "DEVNUM=002", "SEQNUM=5123"});
+}
+
+TEST(UsbHotplugTest, ReadsTheFieldsTheFilterNeeds) {
+  const std::optional<Uevent> event = ParseUevent(DuplicatorEvent("add"));
+  ASSERT_TRUE(event.has_value());
+
+  EXPECT_EQ(event->action, "add");
+  EXPECT_EQ(event->subsystem, "usb");
+  EXPECT_EQ(event->devtype, "usb_device");
+  ASSERT_TRUE(event->identity.has_value());
+  EXPECT_EQ(event->identity->vendor, kVendorId);
+  EXPECT_EQ(event->identity->product, kProductId);
+}
+
+// udev's re-broadcast of the same event, and anything else that is not a
+// kernel uevent, has no "action@devpath" header.
+TEST(UsbHotplugTest, RefusesWhatIsNotAKernelUevent) {
+  EXPECT_FALSE(ParseUevent("").has_value());
+  EXPECT_FALSE(ParseUevent(Datagram("libudev", {"ACTION=add"})).has_value());
+  EXPECT_FALSE(ParseUevent("add@/devices/x").has_value());
+}
+
+// The kernel leaves the leading zeros off, which is the one thing about these
+// identifiers that differs from sysfs's idVendor.
+TEST(UsbHotplugTest, ReadsAnIdentityWrittenWithoutLeadingZeros) {
+  const std::optional<Uevent> event = ParseUevent(
+      Datagram("add@/devices/x", {"ACTION=add", "SUBSYSTEM=usb",
+                                  "DEVTYPE=usb_device", "PRODUCT=4b4/f3/0"}));
+  ASSERT_TRUE(event.has_value());
+  ASSERT_TRUE(event->identity.has_value());
+  EXPECT_EQ(event->identity->vendor, kCypressVendorId);
+  EXPECT_EQ(event->identity->product, kRecoveryProductId);
+  EXPECT_TRUE(IsRelevantUevent(*event));
+}
+
+TEST(UsbHotplugTest, ADuplicatorArrivingOrLeavingIsRelevant) {
+  EXPECT_TRUE(IsRelevantUevent(*ParseUevent(DuplicatorEvent("add"))));
+  EXPECT_TRUE(IsRelevantUevent(*ParseUevent(DuplicatorEvent("remove"))));
+}
+
+// One plug-in is a burst of messages. Only the one for the whole device
+// counts, or a single attach would wake the monitor half a dozen times.
+TEST(UsbHotplugTest, TheRestOfTheBurstIsNot) {
+  EXPECT_FALSE(IsRelevantUevent(*ParseUevent(DuplicatorEvent("bind"))));
+
+  Uevent interface_event = *ParseUevent(DuplicatorEvent("add"));
+  interface_event.devtype = "usb_interface";
+  EXPECT_FALSE(IsRelevantUevent(interface_event));
+}
+
+TEST(UsbHotplugTest, SomebodyElsesDeviceIsNot) {
+  Uevent mouse = *ParseUevent(DuplicatorEvent("add"));
+  mouse.identity = UsbIdentity{0x046d, 0xc077};
+  EXPECT_FALSE(IsRelevantUevent(mouse));
+
+  mouse.identity.reset();
+  EXPECT_FALSE(IsRelevantUevent(mouse));
+}
+
+TEST(UsbHotplugTest, OnlyTheIdentityMapIsTheInitialNamespace) {
+  EXPECT_TRUE(IsIdentityUidMap("         0          0 4294967295\n"));
+
+  // A Flatpak's: its own uid mapped to the user's, and nothing else.
+  EXPECT_FALSE(IsIdentityUidMap("      1000       1000          1\n"));
+  EXPECT_FALSE(IsIdentityUidMap("0 100000 65536\n"));
+  EXPECT_FALSE(IsIdentityUidMap("0 0 4294967295\n1 1 1\n"));
+  EXPECT_FALSE(IsIdentityUidMap(""));
+}
+
+}  // namespace
+}  // namespace ddd::capture
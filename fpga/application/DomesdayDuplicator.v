@@ -170,6 +170,8 @@ module DomesdayDuplicator (
     wire       fx3_spi_chip_select_n;
     wire       fx3_test_mode;
     wire [7:0] fx3_decimation;
+    wire [7:0] fx3_wire_format;
+    wire       fx3_inband_telemetry;
 
     // Signal outputs to FX3
     assign fx3_control[00]       = fx3_data_available;
@@ -296,19 +298,15 @@ module DomesdayDuplicator (
     wire        fx3_is_reading;
     wire [15:0] data_generator_out;
 
-    // Sample rate
-    //
-    // The register holds the decimation factor rather than a flag, so that a
-    // host reading it back gets a positive statement of what the capture path
-    // is doing rather than an echo of what it asked for. Two is the only
-    // factor this gateware implements; the bank normalises anything else to
-    // one, so this comparison is the whole of the decode.
-    wire        fx3_decimate = (fx3_decimation == 8'h02);
-
     wire [ 9:0] capture_sample;
     wire        capture_enable;
 
-    // Anti-aliased 2:1 decimation, for tape capture
+    // Sample rate: anti-aliased 2:1, 4:1 or 8:1 decimation, for tape capture
+    //
+    // The register holds the decimation factor rather than a flag, so that a
+    // host reading it back gets a positive statement of what the capture path
+    // is doing rather than an echo of what it asked for. The bank normalises
+    // anything but 1, 2, 4 or 8 to one, and the chain decodes the rest.
     //
     // In front of the data generator rather than behind it, which is the
     // arrangement that keeps the sequence counter honest: the counter is
@@ -321,13 +319,13 @@ module DomesdayDuplicator (
     // downstream at the rate the decimator sets, so a test capture is an
     // unbroken ramp at whichever rate is selected and the integrity oracle
     // covers the decimated path as well as the full-rate one.
-    halfBandDecimator half_band_decimator_0 (
+    decimationChain decimation_chain_0 (
         // Inputs
-        .reset_n      (reset_n),        // Not reset
-        .clock        (system_clock),   // 80 MHz system clock
-        .sample_enable(sample_enable),  // 1 = a sample arrives on this edge
-        .data_in      (adc_databus),    // 10-bit ADC databus
-        .decimate     (fx3_decimate),   // 1 = filter and halve the rate
+        .reset_n      (reset_n),         // Not reset
+        .clock        (system_clock),    // 80 MHz system clock
+        .sample_enable(sample_enable),   // 1 = a sample arrives on this edge
+        .data_in      (adc_databus),     // 10-bit ADC databus
+        .decimation   (fx3_decimation),  // Samples kept: one in 1, 2, 4 or 8
 
         // Outputs
         .data_out     (capture_sample),  // 10-bit filtered sample
@@ -347,6 +345,33 @@ module DomesdayDuplicator (
         .data_out(data_generator_out)  // 16-bit data out
     );
 
+    // Four samples in five bytes, or one word per sample
+    //
+    // Behind the data generator, so that the generator, its test ramp and its
+    // sequence counter are the same in both formats and tb_dataGenerator
+    // covers both. The counter is simply not sent in packed mode: the packer
+    // numbers its blocks instead, and that number is what the host checks.
+    //
+    // Like the two registers before it, the format is the host's to choose and
+    // the bank normalises anything it does not recognise to words.
+    wire        fx3_pack = (fx3_wire_format == 8'h01);
+
+    wire [15:0] packer_out;
+    wire        packer_write;
+
+    samplePacker sample_packer_0 (
+        // Inputs
+        .reset_n      (reset_n),             // Not reset
+        .clock        (system_clock),        // 80 MHz system clock
+        .sample_enable(capture_enable),      // 1 = a sample arrives on this edge
+        .data_in      (data_generator_out),  // 16-bit word from the generator
+        .pack         (fx3_pack),            // 1 = four samples in five bytes
+
+        // Outputs
+        .data_out    (packer_out),   // 16-bit word for the buffer
+        .write_enable(packer_write)  // 1 = a word is written this edge
+    );
+
     // The capture buffer's back-pressure instrument, on its way to the register
     // bank. The latch pulse comes back the other way and is the only thing the
     // host can do to the buffer at all.
@@ -354,15 +379,25 @@ module DomesdayDuplicator (
     wire [ 47:0] buffer_telemetry_geometry;
     wire         buffer_telemetry_latch;
 
-    // FIFO buffer
-    buffer buffer_0 (
+    // FIFO buffer. Three packets deep: the 16384 words above the packet
+    // threshold are 410 us of grace at 40 MSPS in word mode, twice what the
+    // original pair of buffers gave, and 655 us packed. An M9K holds 512 of
+    // these words, so that is 48 of the device's 66 blocks, and a multiple of
+    // 8192 maps onto them the same way in whichever width Quartus chooses.
+    // The next packet up, 32768, would need 64 and leave two for everything
+    // else. The register bank reports the depth, so nothing on the host
+    // carries a copy of it.
+    buffer #(
+        .FifoDepth(24576)
+    ) buffer_0 (
         // Inputs
-        .reset_n        (reset_n),                // Not reset
-        .clock          (system_clock),           // 80 MHz system clock
-        .write_enable   (capture_enable),         // 1 = a sample is written this edge
-        .data_in        (data_generator_out),     // 16-bit ADC data bus input
-        .is_reading     (fx3_is_reading),         // 1 = FX3 is reading data
-        .telemetry_latch(buffer_telemetry_latch), // 1 = sample the instrument
+        .reset_n         (reset_n),                // Not reset
+        .clock           (system_clock),           // 80 MHz system clock
+        .write_enable    (packer_write),           // 1 = a word is written this edge
+        .data_in         (packer_out),             // 16-bit word from the packer
+        .is_reading      (fx3_is_reading),         // 1 = FX3 is reading data
+        .telemetry_latch (buffer_telemetry_latch), // 1 = sample the instrument
+        .inband_telemetry(fx3_inband_telemetry),   // 1 = open each packet with a reading
 
         // Outputs
         .data_out          (fx3_databus),               // 16-bit data output
@@ -407,7 +442,13 @@ module DomesdayDuplicator (
         .TelemetryPresent(1'b1),
 
         // and the only image with a sample stream to decimate
-        .DecimationPresent(1'b1)
+        .DecimationPresent(1'b1),
+
+        // or to pack
+        .PackingPresent(1'b1),
+
+        // or to report on from inside the stream
+        .InbandTelemetryPresent(1'b1)
     ) spi_registers_0 (
         // Inputs
         .reset_n           (reset_n),
@@ -424,6 +465,8 @@ module DomesdayDuplicator (
         .spi_miso           (fx3_spi_miso),
         .test_mode          (fx3_test_mode),          // 1 = test data generator selected
         .decimation         (fx3_decimation),         // Samples kept out of every n
+        .wire_format        (fx3_wire_format),        // 1 = four samples in five bytes
+        .inband_telemetry   (fx3_inband_telemetry),   // 1 = a reading opens each packet
         .leds               (LED),                    // Driven by the FX3, for status
         .window_write       (window_write),
         .window_address     (window_address),
@@ -35,14 +35,34 @@
     cleared, so only the *first* overflow of a session was held. Every one
     after it raised the flag for a single cycle. That is fixed here.
 
+    With in-band telemetry on, the first eight words of every packet are not
+    samples: they are the back-pressure instrument's reading for that packet,
+    taken as it was offered, and the FIFO supplies the remaining 8184. The
+    packet is still 8192 words, so nothing on the FX3's side of the pin
+    changes, and the FIFO is simply not popped while the block goes out. The
+    switch is sampled once per packet, as the packet is offered, so turning it
+    on or off mid-packet cannot produce a packet that is half of each.
+
+    The depth is a parameter, and the one number here that is not pinned by
+    the other end of a wire. Everything above the packet threshold is what a
+    USB stall is paid for out of, so the top level makes it as deep as the
+    device's memory allows, and the instrument reports whatever it is.
+
 ************************************************************************/
 
-module buffer (
+module buffer #(
+    // The FIFO's depth in words. Must be a whole number of packets, so that a
+    // full FIFO drains as whole packets, and must leave the instrument's
+    // 16-bit fields able to hold it.
+    parameter integer FifoDepth = 24576
+) (
     input reset_n,
     input clock,
 
-    // One assertion per sample. The sampling side runs at half the system
-    // clock, so this is high every second cycle.
+    // One assertion per word. The sampling side runs at half the system
+    // clock, so this is high at most every second cycle - every second one
+    // in word mode, and five times in eight of those in packed mode, where
+    // samplePacker.v sends ten bits a sample rather than sixteen.
     input        write_enable,
     input [15:0] data_in,
 
@@ -57,7 +77,11 @@ module buffer (
     // else about it leaves this module read-only - see bufferMonitor.v.
     input          telemetry_latch,
     output [127:0] telemetry,
-    output [ 47:0] telemetry_geometry
+    output [ 47:0] telemetry_geometry,
+
+    // Open every packet with the instrument's in-band block. From the register
+    // bank, and sampled as each packet is offered.
+    input inband_telemetry
 );
 
     // The packet size, in words, and the same number three places agree on:
@@ -65,16 +89,11 @@ module buffer (
     // bulk endpoint buffer. Changing it here alone breaks the capture.
     localparam integer PacketWords = 8192;
 
-    // Twice the packet size. The headroom above the threshold is what a USB
-    // stall is paid for out of: 8192 words at 40 MSPS is 205 us of grace, the
-    // same as the old pair of buffers gave, in the same total memory.
-    localparam integer FifoDepth = 16384;
-
-    // Three quarters of the depth, which is half the headroom above the packet
-    // threshold. Occupancy at or above this is what the instrument counts time
-    // against: the FIFO reaching half is ordinary, and reaching this means half
-    // of what a stall is paid out of has already been spent.
-    localparam integer NearFullWords = 12288;
+    // Half the headroom above the packet threshold, whatever the depth.
+    // Occupancy at or above this is what the instrument counts time against:
+    // the FIFO reaching a packet is ordinary, and reaching this means half of
+    // what a stall is paid out of has already been spent.
+    localparam integer NearFullWords = PacketWords + (FifoDepth - PacketWords) / 2;
 
     localparam integer UsedBits = $clog2(FifoDepth + 1);
     localparam integer PacketBits = $clog2(PacketWords + 1);
@@ -87,6 +106,12 @@ module buffer (
     localparam [PacketBits-1:0] PacketZero = {PacketBits{1'b0}};
     localparam [PacketBits-1:0] PacketOne = {{(PacketBits - 1) {1'b0}}, 1'b1};
 
+    // The in-band block's length in words, which is also the position in a
+    // packet at which the samples start when it is sent. Must match
+    // bufferMonitor.v, which builds a block of exactly this many words.
+    localparam [31:0] InbandValue = 8;
+    localparam [PacketBits-1:0] InbandWords = InbandValue[PacketBits-1:0];
+
     // How long the error flag is held, in system clock cycles. 2000 cycles at
     // 80 MHz is 25 us, which is what 1000 cycles of the old 40 MHz write clock
     // came to - the FX3 samples this pin per packet, so the flag has to
@@ -104,6 +129,12 @@ module buffer (
     // what raises the flag about it.
     wire                overflow = write_enable && fifo_full;
 
+    // What the FIFO presents, and whether the word on the databus is the
+    // in-band block's rather than the FIFO's. Declared here because the FIFO's
+    // read request depends on the second, which is driven further down.
+    wire [        15:0] fifo_data_out;
+    wire                inband_phase;
+
     fifo #(
         .DataWidth(16),
         .Depth    (FifoDepth)
@@ -112,8 +143,8 @@ module buffer (
         .clock        (clock),
         .write_request(write_enable),
         .data_in      (data_in),
-        .read_request (is_reading),
-        .data_out     (data_out),
+        .read_request (is_reading && !inband_phase),
+        .data_out     (fifo_data_out),
         .full         (fifo_full),
         .used_words   (used_words)
     );
@@ -124,6 +155,12 @@ module buffer (
     // inputs only. It cannot affect any of them, which is what makes it safe to
     // read a running capture with.
 
+    wire [127:0] inband_block;
+
+    // A packet is offered on the edge data_available rises, which is also the
+    // edge the instrument takes its in-band reading on
+    wire packet_start;
+
     bufferMonitor #(
         .FifoDepth    (FifoDepth),
         .PacketWords  (PacketWords),
@@ -136,8 +173,10 @@ module buffer (
         .overflow    (overflow),
         .is_reading  (is_reading),
         .latch       (telemetry_latch),
+        .packet_start(packet_start),
         .telemetry   (telemetry),
-        .geometry    (telemetry_geometry)
+        .geometry    (telemetry_geometry),
+        .inband_block(inband_block)
     );
 
     // Packet availability ---------------------------------------------------
@@ -151,15 +190,24 @@ module buffer (
     // the occupancy fell back below a packet would be a truthful signal and a
     // different contract.
     reg [PacketBits-1:0] packet_remaining;
+    reg                  inband_packet;
+
+    assign packet_start = !data_available && (used_words >= PacketThreshold);
 
     always @(posedge clock, negedge reset_n) begin
         if (!reset_n) begin
             data_available   <= 1'b0;
             packet_remaining <= PacketZero;
+            inband_packet    <= 1'b0;
         end else if (!data_available) begin
-            if (used_words >= PacketThreshold) begin
+            // Still the threshold of a whole packet, although a packet with
+            // the block in it takes eight words fewer from the FIFO. Lowering
+            // it would buy eight words of latency and cost a second threshold
+            // to reason about.
+            if (packet_start) begin
                 data_available   <= 1'b1;
                 packet_remaining <= PacketCount;
+                inband_packet    <= inband_telemetry;
             end
         end else if (is_reading) begin
             if (packet_remaining == PacketOne) begin
@@ -171,6 +219,21 @@ module buffer (
         end
     end
 
+    // The in-band block -----------------------------------------------------
+    //
+    // The position of the word on the databus within its packet, which is
+    // zero for the first word and only meaningful while data_available is
+    // high. The block's words are selected by it directly, so the databus
+    // presents each one before the FX3 takes it, exactly as the FIFO's
+    // show-ahead output does.
+    wire [PacketBits-1:0] packet_position = PacketCount - packet_remaining;
+
+    assign inband_phase = inband_packet && data_available &&
+        (packet_position < InbandWords);
+
+    assign data_out = inband_phase ?
+        inband_block[{packet_position[2:0], 4'b0000} +: 16] : fifo_data_out;
+
     // The overflow flag -----------------------------------------------------
 
     reg [11:0] error_hold;
@@ -44,6 +44,16 @@
     application - consumes intervals that the first one then never sees, and
     those two say what happened regardless of who was reading.
 
+    The in-band block is the same instrument read a second way. Four readings
+    a second cannot say which packet a stall landed in, and a host that wants
+    to know where in a capture the buffer was squeezed needs exactly that. So
+    a second, independent set of interval counters runs from one offered
+    packet to the next, and is snapshotted into an eight-word block on the
+    edge each packet is offered. buffer.v can then put that block at the head
+    of the packet, where the host finds it already aligned to the samples it
+    describes. Neither set of counters clears the other, so a host polling the
+    register bank and a host reading the stream see complete intervals each.
+
 ************************************************************************/
 
 module bufferMonitor #(
@@ -64,6 +74,10 @@ module bufferMonitor #(
     // telemetry block
     input latch,
 
+    // One clock wide, from buffer.v, on the edge a packet is offered to the
+    // FX3. Closes one in-band interval and opens the next.
+    input packet_start,
+
     // The shadow bank, least significant byte first, as the register map
     // presents it from TELEM_STATUS upwards
     output [127:0] telemetry,
@@ -71,7 +85,12 @@ module bufferMonitor #(
     // The three constants a host needs to interpret the bank, so that it never
     // has to carry a copy of this design's geometry: depth, packet size and the
     // near-full threshold, least significant byte first
-    output [47:0] geometry
+    output [47:0] geometry,
+
+    // The in-band block for the packet being offered, word zero in the low
+    // sixteen bits: the order buffer.v sends the words and the order a host
+    // reads them. Stands still from one packet_start to the next.
+    output [127:0] inband_block
 );
 
     localparam integer UsedBits = $clog2(FifoDepth + 1);
@@ -99,6 +118,17 @@ module bufferMonitor #(
 
     localparam [15:0] CounterMaximum = 16'hFFFF;
 
+    // The in-band block's first word. Its top six bits are all set, which is
+    // the one sequence number the data generator never stamps - it counts 0 to
+    // 62 - so in word mode no sample can be mistaken for it. Packed data has
+    // no such guarantee, which is why the host finds the block by its place in
+    // the packet and only confirms it by this.
+    localparam [15:0] InbandTag = 16'hFDDD;
+
+    // The in-band block's layout, in the low byte of its second word, on the
+    // same terms as TelemetryFormat
+    localparam [7:0] InbandFormat = 8'd1;
+
     // Live counters -----------------------------------------------------------
 
     reg [UsedBits-1:0] peak_interval;
@@ -117,6 +147,13 @@ module bufferMonitor #(
     reg overflow_sticky;
     reg saturated;
 
+    // The in-band interval counters, from one offered packet to the next
+    reg [UsedBits-1:0] inband_peak;
+    reg [        15:0] inband_dropped;
+    reg [        15:0] inband_packet_number;
+    reg                inband_near_full;
+    reg                inband_saturated;
+
     // An overflow event is a burst, not a cycle. A stall drops every sample
     // offered until the FX3 comes back, and counting those as separate events
     // would report one stall as thousands - so the run is counted once, and
@@ -238,6 +275,45 @@ module bufferMonitor #(
         end
     end
 
+    // The in-band interval --------------------------------------------------
+    //
+    // The register-bank interval's arithmetic, with packet_start where that
+    // one has latch. The interval is a packet's worth of sampling, about 205
+    // us at full rate, so nothing here comes near saturating in a working
+    // capture and the near-full figure is a flag rather than a prescaled
+    // duration.
+    always @(posedge clock, negedge reset_n) begin
+        if (!reset_n) begin
+            inband_peak          <= UsedZero;
+            inband_dropped       <= 16'd0;
+            inband_packet_number <= 16'd0;
+            inband_near_full     <= 1'b0;
+            inband_saturated     <= 1'b0;
+        end else if (packet_start) begin
+            inband_peak          <= used_words;
+            inband_dropped       <= overflow ? 16'd1 : 16'd0;
+            inband_packet_number <= inband_packet_number + 16'd1;
+            inband_near_full     <= near_full_sample;
+            inband_saturated     <= 1'b0;
+        end else begin
+            if (used_words > inband_peak) begin
+                inband_peak <= used_words;
+            end
+
+            if (overflow) begin
+                if (inband_dropped == CounterMaximum) begin
+                    inband_saturated <= 1'b1;
+                end else begin
+                    inband_dropped <= inband_dropped + 16'd1;
+                end
+            end
+
+            if (near_full_sample) begin
+                inband_near_full <= 1'b1;
+            end
+        end
+    end
+
     // The shadow bank -------------------------------------------------------
     //
     // A second block, and not the same one, so that what a read returns is the
@@ -283,6 +359,36 @@ module bufferMonitor #(
         end
     end
 
+    // The in-band shadow. Taken on the edge the packet is offered, which is
+    // also the edge data_available rises, so it is steady before the FX3 can
+    // take the first word of the packet and stays so until the next one is
+    // offered.
+    //
+    // The peak includes the occupancy at that instant, so that a host never
+    // reads a block whose peak is below the occupancy it reports alongside it.
+
+    reg [         7:0] inband_shadow_flags;
+    reg [        15:0] inband_shadow_number;
+    reg [UsedBits-1:0] inband_shadow_used;
+    reg [UsedBits-1:0] inband_shadow_peak;
+    reg [        15:0] inband_shadow_dropped;
+
+    always @(posedge clock, negedge reset_n) begin
+        if (!reset_n) begin
+            inband_shadow_flags   <= 8'h00;
+            inband_shadow_number  <= 16'd0;
+            inband_shadow_used    <= UsedZero;
+            inband_shadow_peak    <= UsedZero;
+            inband_shadow_dropped <= 16'd0;
+        end else if (packet_start) begin
+            inband_shadow_flags   <= {6'b000000, inband_saturated, inband_near_full};
+            inband_shadow_number  <= inband_packet_number;
+            inband_shadow_used    <= used_words;
+            inband_shadow_peak    <= (used_words > inband_peak) ? used_words : inband_peak;
+            inband_shadow_dropped <= inband_dropped;
+        end
+    end
+
     // The occupancies are UsedBits wide and the map presents them as sixteen,
     // which is what lets a host read every field of this bank the same way
     localparam integer UsedPad = 16 - UsedBits;
@@ -304,4 +410,28 @@ module bufferMonitor #(
 
     assign geometry = {NearFullValue[15:0], PacketValue[15:0], DepthValue[15:0]};
 
+    // Seven words and a check. The check is the first seven folded together
+    // with exclusive-or, which is what lets a host tell a block from eight
+    // words that merely sit where one should be.
+    wire [15:0] inband_word_0 = InbandTag;
+    wire [15:0] inband_word_1 = {inband_shadow_flags, InbandFormat};
+    wire [15:0] inband_word_2 = inband_shadow_number;
+    wire [15:0] inband_word_3 = {{UsedPad{1'b0}}, inband_shadow_used};
+    wire [15:0] inband_word_4 = {{UsedPad{1'b0}}, inband_shadow_peak};
+    wire [15:0] inband_word_5 = inband_shadow_dropped;
+    wire [15:0] inband_word_6 = DepthValue[15:0];
+    wire [15:0] inband_word_7 = inband_word_0 ^ inband_word_1 ^ inband_word_2 ^
+        inband_word_3 ^ inband_word_4 ^ inband_word_5 ^ inband_word_6;
+
+    assign inband_block = {
+        inband_word_7,
+        inband_word_6,
+        inband_word_5,
+        inband_word_4,
+        inband_word_3,
+        inband_word_2,
+        inband_word_1,
+        inband_word_0
+    };
+
 endmodule
@@ -0,0 +1,105 @@
+/************************************************************************
+
+    decimationChain.v
+
+    The sample rate: 1:1, 2:1, 4:1 or 8:1 decimation of the ADC stream
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    Three 2:1 stages in a row, each switched in or bypassed by the factor in
+    the DECIMATION register:
+
+        ADC -> front stage 0 -> front stage 1 -> final stage -> out
+
+        1:1   bypassed         bypassed         bypassed
+        2:1   bypassed         bypassed         40 -> 20 MHz
+        4:1   40 -> 20 MHz     bypassed         20 -> 10 MHz
+        8:1   40 -> 20 MHz     20 -> 10 MHz     10 ->  5 MHz
+
+    The final stage is halfBandDecimator.v at every factor, so the band edge
+    of a decimated capture is always drawn by the 63-tap filter at a quarter
+    of the rate that reaches it, and the 2:1 path is exactly the one that
+    existed before this chain did. The front stages are halfBandPrefilter.v,
+    a third of the length, because all they have to protect is the band the
+    final stage keeps; the reasoning and the measured responses are in
+    fpga/make-halfband-coefficients.py.
+
+    Every stage's bypass is combinational, so at 1:1 the ADC's sample
+    reaches the output unaltered on the cycle it arrived - bit for bit what
+    the gateware produced before any of this existed. A stage running at a
+    reduced rate needs nothing told to it: it counts sample enables rather
+    than clocks, and the stage in front of it only raises its enable once
+    for every two samples it took.
+
+************************************************************************/
+
+module decimationChain (
+    input       reset_n,
+    input       clock,
+    input       sample_enable,  // 1 = an ADC sample arrives on this edge, at 40 MHz
+    input [9:0] data_in,
+    input [7:0] decimation,     // The DECIMATION register: 1, 2, 4 or 8
+
+    // Outputs
+    output [9:0] data_out,
+    output       output_enable  // 1 = data_out carries a sample worth keeping
+);
+
+    // The factors, as the register holds them. The register bank normalises
+    // anything else to one, so these comparisons are the whole of the decode.
+    localparam [7:0] EverySecondSample = 8'h02;
+    localparam [7:0] EveryFourthSample = 8'h04;
+    localparam [7:0] EveryEighthSample = 8'h08;
+
+    wire       final_decimate = (decimation == EverySecondSample) ||
+        (decimation == EveryFourthSample) || (decimation == EveryEighthSample);
+    wire       front_0_decimate = (decimation == EveryFourthSample) ||
+        (decimation == EveryEighthSample);
+    wire       front_1_decimate = (decimation == EveryEighthSample);
+
+    wire [9:0] front_0_data;
+    wire       front_0_enable;
+    wire [9:0] front_1_data;
+    wire       front_1_enable;
+
+    halfBandPrefilter front_stage_0 (
+        // Inputs
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(sample_enable),
+        .data_in      (data_in),
+        .decimate     (front_0_decimate),
+
+        // Outputs
+        .data_out     (front_0_data),
+        .output_enable(front_0_enable)
+    );
+
+    halfBandPrefilter front_stage_1 (
+        // Inputs
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(front_0_enable),
+        .data_in      (front_0_data),
+        .decimate     (front_1_decimate),
+
+        // Outputs
+        .data_out     (front_1_data),
+        .output_enable(front_1_enable)
+    );
+
+    halfBandDecimator final_stage (
+        // Inputs
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(front_1_enable),
+        .data_in      (front_1_data),
+        .decimate     (final_decimate),
+
+        // Outputs
+        .data_out     (data_out),
+        .output_enable(output_enable)
+    );
+
+endmodule
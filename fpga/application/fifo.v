@@ -101,7 +101,7 @@ module fifo #(
     //
     // No reset in this block, deliberately. An M9K has no reset on its
     // contents, so a reset here would deny Quartus the inference and put
-    // Depth x DataWidth bits into logic elements instead - 262144 of them at
+    // Depth x DataWidth bits into logic elements instead - 393216 of them at
     // the depth this design uses, against the 22320 the whole device has.
     //
     // memory_data_out is left out of the reset for the same reason: it is the
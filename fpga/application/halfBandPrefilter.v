@@ -0,0 +1,224 @@
+/************************************************************************
+
+    halfBandPrefilter.v
+
+    The short 2:1 front stage of 4:1 and 8:1 decimation
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    Lower rates than 20 MHz are a cascade of 2:1 stages, and the 63-tap
+    filter in halfBandDecimator.v is always the last of them, so the band
+    edge of every decimated capture is drawn by the same sharp filter. This
+    is the stage that goes in front of it - once for 4:1, twice for 8:1.
+
+    Its job is much easier than the final stage's, which is why it is a third
+    of the length. The final stage keeps only the lowest quarter of what it is
+    given, so this stage has to keep the lowest eighth of its own input flat
+    and stop only what would fold into that eighth and into the final stage's
+    transition just above it - everything from three eighths of its input rate
+    up. That is a transition band five times wider than the final stage's, and
+    23 taps reach -67 dB across it, below a count of the 10-bit output. The
+    coefficients and the measured response are in
+    fpga/make-halfband-coefficients.py --front, which generated the table
+    below.
+
+    The same half-band form as the final stage, for the same reasons: every
+    second coefficient either side of the centre is zero and the centre is
+    exactly one half, so six multiplies by constants cover twelve taps and
+    cost shift-and-add networks in ordinary logic rather than any of the
+    device's embedded multipliers. Two of these cost less than a third of one
+    more copy of the final stage would have.
+
+    The same bypass as well: with decimate low the input reaches the output
+    unaltered on the cycle it arrived, so a stage that is not in use adds no
+    delay, no rounding and nothing else to the stream it passes on.
+
+************************************************************************/
+
+module halfBandPrefilter (
+    input       reset_n,
+    input       clock,
+    input       sample_enable,  // 1 = a new sample arrives on this edge
+    input [9:0] data_in,
+    input       decimate,       // 1 = filter and halve the rate
+
+    // Outputs
+    output [9:0] data_out,
+    output       output_enable  // 1 = data_out carries a sample worth keeping
+);
+
+    // Taps, and the width of the arithmetic they need. Six products of a
+    // 12-bit pre-sum and a coefficient below 2^14 stay well under 2^28, so the
+    // final stage's 32-bit accumulator has room to spare here and is kept for
+    // the sake of reading the two modules side by side.
+    localparam integer TapCount = 23;
+    localparam integer PairCount = 6;
+    localparam integer CentreTap = 11;
+    localparam integer CoefficientBits = 16;
+    localparam integer ScaleBits = 15;
+    localparam integer ProductBits = 28;
+    localparam integer AccumulatorBits = 32;
+
+    // The centre coefficient, the rounding, the offset and the clip, exactly as
+    // halfBandDecimator.v has them and for the reasons it gives.
+    localparam signed [CoefficientBits-1:0] CentreCoefficient = 16'sd16384;
+    localparam signed [AccumulatorBits-1:0] RoundOffset = 32'sd16384;
+    localparam signed [11:0] SampleOffset = 12'sd512;
+    localparam signed [AccumulatorBits-1:0] SampleOffsetWide = 32'sd512;
+    localparam signed [AccumulatorBits-1:0] MinimumSample = 32'sd0;
+    localparam signed [AccumulatorBits-1:0] MaximumSample = 32'sd1023;
+
+    // Coefficient table, generated by fpga/make-halfband-coefficients.py
+    // and checked against it by fpga/tests/test_halfband_coefficients.py.
+    // Do not hand-edit: run the generator.
+    //
+    // 23 taps, Kaiser window beta 7.0, scaled by 2^15.
+    // Each entry multiplies the sum of the two samples it is symmetric
+    // across, so 6 multipliers cover 12 taps; the centre tap is exactly
+    // half of full scale and is applied as a shift rather than a multiply.
+    //
+    //   tap pair        coefficient
+    //    0, 22              -6
+    //    2, 20              79
+    //    4, 18            -345
+    //    6, 16            1031
+    //    8, 14           -2721
+    //   10, 12           10154
+    //   11 (centre)      16384
+
+    localparam [95:0] Coefficients = {
+        16'sd10154, -16'sd2721, 16'sd1031, -16'sd345,
+        16'sd79, -16'sd6
+    };
+
+    // The sample history the taps read. delay[0] is the newest.
+    reg [9:0] delay[0:TapCount-1];
+
+    // Which of the two input samples this is, as in the final stage
+    reg output_phase;
+
+    // One flag per pipeline stage, as in the final stage. Five deep, with an
+    // output due every four clocks at the most, so two are in flight at once.
+    reg [4:0] stage_valid;
+
+    integer   i;
+
+    // Stage 1: the symmetric pre-adds, and the centre sample
+    reg signed [11:0] pre_sum[0:PairCount-1];
+    reg signed [11:0] centre_sample;
+
+    // Stage 2: the products, at the accumulator's width
+    reg signed [AccumulatorBits-1:0] product[0:PairCount-1];
+    reg signed [AccumulatorBits-1:0] centre_product;
+
+    // Stage 3: seven values summed three at a time, and stage 4: the total.
+    // Three-input adds are what the final stage's first level already closes
+    // at 80 MHz, so two levels are enough here.
+    reg signed [AccumulatorBits-1:0] sum_three[0:2];
+    reg signed [AccumulatorBits-1:0] total;
+
+    // Stage 5: the rounded sample
+    reg [9:0] filtered;
+
+    wire signed [AccumulatorBits-1:0] scaled = (total + RoundOffset) >>> ScaleBits;
+    wire signed [AccumulatorBits-1:0] recentred = scaled + SampleOffsetWide;
+
+    wire signed [ProductBits-1:0] centre_scaled = centre_sample * CentreCoefficient;
+
+    wire signed [AccumulatorBits-1:0] centre_scaled_wide = {
+        {(AccumulatorBits - ProductBits) {centre_scaled[ProductBits-1]}}, centre_scaled
+    };
+
+    wire [9:0] clipped = (recentred < MinimumSample) ? 10'd0 :
+        (recentred > MaximumSample) ? 10'd1023 : recentred[9:0];
+
+    // The bypass
+    assign data_out      = decimate ? filtered : data_in;
+    assign output_enable = decimate ? stage_valid[4] : sample_enable;
+
+    genvar pair;
+
+    generate
+        for (pair = 0; pair < PairCount; pair = pair + 1) begin : gen_taps
+            // Index 0 is the outermost pair, as the generator packed it
+            wire signed [CoefficientBits-1:0] coefficient =
+                $signed(Coefficients[CoefficientBits*pair+:CoefficientBits]);
+
+            wire signed [ProductBits-1:0] tap_product = pre_sum[pair] * coefficient;
+
+            wire signed [AccumulatorBits-1:0] tap_product_wide = {
+                {(AccumulatorBits - ProductBits) {tap_product[ProductBits-1]}}, tap_product
+            };
+
+            always @(posedge clock, negedge reset_n) begin
+                if (!reset_n) begin
+                    product[pair] <= {AccumulatorBits{1'b0}};
+                end else begin
+                    product[pair] <= tap_product_wide;
+                end
+            end
+        end
+    endgenerate
+
+    always @(posedge clock, negedge reset_n) begin
+        if (!reset_n) begin
+            for (i = 0; i < TapCount; i = i + 1) begin
+                delay[i] <= 10'd0;
+            end
+
+            output_phase <= 1'b0;
+            stage_valid  <= 5'd0;
+
+            for (i = 0; i < PairCount; i = i + 1) begin
+                pre_sum[i] <= 12'sd0;
+            end
+            centre_sample  <= 12'sd0;
+            centre_product <= {AccumulatorBits{1'b0}};
+
+            for (i = 0; i < 3; i = i + 1) begin
+                sum_three[i] <= {AccumulatorBits{1'b0}};
+            end
+
+            total    <= {AccumulatorBits{1'b0}};
+            filtered <= 10'd0;
+        end else begin
+            if (sample_enable) begin
+                delay[0] <= data_in;
+                for (i = 1; i < TapCount; i = i + 1) begin
+                    delay[i] <= delay[i-1];
+                end
+
+                output_phase <= ~output_phase;
+            end
+
+            // Stage 1, reading one consistent snapshot of the history
+            stage_valid[0] <= sample_enable & output_phase;
+
+            for (i = 0; i < PairCount; i = i + 1) begin
+                pre_sum[i] <= ($signed({2'b00, delay[2*i]}) - SampleOffset) +
+                    ($signed({2'b00, delay[TapCount-1-(2*i)]}) - SampleOffset);
+            end
+            centre_sample <= $signed({2'b00, delay[CentreTap]}) - SampleOffset;
+
+            // Stage 2
+            stage_valid[1] <= stage_valid[0];
+            centre_product <= centre_scaled_wide;
+
+            // Stage 3, with the centre joining the first of the three sums
+            stage_valid[2] <= stage_valid[1];
+            sum_three[0]   <= product[0] + product[1] + centre_product;
+            sum_three[1]   <= product[2] + product[3];
+            sum_three[2]   <= product[4] + product[5];
+
+            // Stage 4
+            stage_valid[3] <= stage_valid[2];
+            total          <= sum_three[0] + sum_three[1] + sum_three[2];
+
+            // Stage 5
+            stage_valid[4] <= stage_valid[3];
+            filtered       <= clipped;
+        end
+    end
+
+endmodule
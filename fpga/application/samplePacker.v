@@ -0,0 +1,156 @@
+/************************************************************************
+
+    samplePacker.v
+
+    Packed wire format: four samples in five bytes
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    Sits between the data generator and the buffer and decides what a sample
+    costs on the wire. In word mode it costs a whole 16-bit word, as it always
+    has: ten bits of sample and six of sequence number, 80 MB/s at the full
+    rate. In packed mode it costs ten bits, and the sequence number moves out
+    of every sample and into a header at the front of each block - 50 MB/s,
+    which is what a USB 3 host that cannot quite keep up with 80 needs.
+
+    A block is 4096 words, exactly half the buffer's packet: one header word
+    carrying a 16-bit block number, then 6552 samples packed into the 4095
+    words behind it. The samples are packed least significant bit first, sample
+    i starting at bit 10 * i of the payload, so that once the FX3 has put the
+    words on the wire low byte first every four samples are five consecutive
+    bytes and the host can unpack them without ever reassembling a word.
+
+    6552 is not a round number, and it is the one that makes everything else
+    round. Ten bits times 6552 is exactly 4095 words, so a block ends on a
+    word boundary with nothing left over, and a header plus its payload is a
+    power of two - which is what keeps two blocks to a packet and a block
+    boundary on every packet boundary the FX3 draws.
+
+    With in-band telemetry off, that is. With it on, buffer.v opens every
+    8192-word packet with its eight-word reading (see inband_phase there), so
+    a packet carries 8184 words of blocks and the boundaries drift by eight
+    words a packet: blocks straddle packets, and nothing here lines them up
+    again. The host copes by taking the readings out of each packet first and
+    unpacking what is left as one stream, carrying a block that is cut short
+    over to the next buffer (InbandTelemetryStripper, then PackedUnpacker, in
+    ddd-gui/src/capture).
+
+    The block number does the sequence counter's job and does it better. The
+    counter is six bits and changes every 65536 samples, so a host has to see
+    65536 samples before it knows where it is; the block number changes every
+    6552 and lets it know at the second header. Its wrap is 65536 blocks, or
+    about ten seconds at the full rate, against the counter's 103 ms.
+
+    Changing mode restarts the format - the first block after the change is
+    block zero - rather than switching half way through a block. The host
+    writes the mode before it opens the stream, so what is in flight across a
+    change is discarded either way.
+
+************************************************************************/
+
+module samplePacker (
+    input reset_n,
+    input clock,
+
+    // One assertion per sample, and the data generator's whole word with it.
+    // The sequence number in the top six bits is passed through in word mode
+    // and dropped in packed mode, where the block header carries it instead.
+    input        sample_enable,
+    input [15:0] data_in,
+
+    // 1 = pack four samples into five bytes, 0 = one word per sample
+    input pack,
+
+    // A word for the buffer, and the cycle it is valid on. Never more than one
+    // a cycle: a sample arrives at most every second cycle, and in packed mode
+    // a sample that completes a word never also starts a block.
+    output reg [15:0] data_out,
+    output reg        write_enable
+);
+
+    // Samples per block. 6552 * 10 = 4095 * 16, so a block's payload fills a
+    // whole number of words and the next header starts a word of its own.
+    // Compared as the position of the last one, sized to the counter, so that
+    // the comparison is the width of what it compares.
+    localparam [31:0] BlockSamples = 6552;
+    localparam [12:0] BlockLastSample = BlockSamples[12:0] - 13'd1;
+
+    // Samples of the current block already taken. Zero means the next sample
+    // starts a block, so it is preceded by a header.
+    reg [12:0] block_position;
+
+    // The number the next header carries. It wraps at 16 bits, and the host
+    // compares modulo 65536 rather than counting on it not to.
+    reg [15:0] block_number;
+
+    // The bits of a word not yet complete, least significant first, and how
+    // many of them there are. Never sixteen: a word is written the moment it
+    // is whole.
+    reg [15:0] pending_bits;
+    reg [ 3:0] pending_count;
+
+    // The mode in force, so that a change is seen as a change
+    reg        pack_previous;
+
+    // The pending bits with this sample appended above them. Ten bits on top
+    // of at most fifteen is at most 25, which is what the width allows.
+    wire [25:0] combined = {10'd0, pending_bits} | ({16'd0, data_in[9:0]} << pending_count);
+
+    // How many bits that is. Bit 4 set means a whole word is ready, and the
+    // low four bits are then what is left over - which is why the count needs
+    // no subtraction.
+    wire [ 4:0] filled = {1'b0, pending_count} + 5'd10;
+
+    always @(posedge clock, negedge reset_n) begin
+        if (!reset_n) begin
+            data_out       <= 16'd0;
+            write_enable   <= 1'b0;
+            block_position <= 13'd0;
+            block_number   <= 16'd0;
+            pending_bits   <= 16'd0;
+            pending_count  <= 4'd0;
+            pack_previous  <= 1'b0;
+        end else if (pack != pack_previous) begin
+            // A change of mode. Nothing is written on this cycle, and the new
+            // format starts from its beginning on the next sample.
+            pack_previous  <= pack;
+            write_enable   <= 1'b0;
+            block_position <= 13'd0;
+            block_number   <= 16'd0;
+            pending_bits   <= 16'd0;
+            pending_count  <= 4'd0;
+        end else if (!pack) begin
+            // Word mode: exactly what reached the buffer before this module
+            // existed, one cycle later
+            data_out     <= data_in;
+            write_enable <= sample_enable;
+        end else if (sample_enable) begin
+            if (block_position == 13'd0) begin
+                // The first sample of a block. The previous block ended on a
+                // word boundary, so nothing is pending and the header has the
+                // cycle to itself; the sample becomes the first ten bits of
+                // the payload.
+                data_out      <= block_number;
+                write_enable  <= 1'b1;
+                block_number  <= block_number + 16'd1;
+                pending_bits  <= {6'd0, data_in[9:0]};
+                pending_count <= 4'd10;
+            end else begin
+                write_enable  <= filled[4];
+                data_out      <= combined[15:0];
+                pending_bits  <= filled[4] ? {6'd0, combined[25:16]} : combined[15:0];
+                pending_count <= filled[3:0];
+            end
+
+            if (block_position == BlockLastSample) begin
+                block_position <= 13'd0;
+            end else begin
+                block_position <= block_position + 13'd1;
+            end
+        end else begin
+            write_enable <= 1'b0;
+        end
+    end
+
+endmodule
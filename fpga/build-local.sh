@@ -78,6 +78,8 @@ echo "=== Factory image ==="
 echo
 echo "=== Application image ==="
 (cd "$build/application" && quartus_sh --flow compile DomesdayDuplicator)
+# 48 M9Ks is the capture FIFO and nothing else; see check-memory-budget.sh.
+"$here/check-memory-budget.sh" "$build/application/DomesdayDuplicator.fit.rpt" 48
 
 echo
 echo "=== Provisioning image ==="
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+#
+# Fail a gateware build whose block memory has outgrown its budget.
+#
+# Domesday Duplicator - LaserDisc RF sampler
+# SPDX-FileCopyrightText: 2026 Simon Inns
+# SPDX-License-Identifier: GPL-3.0-or-later
+#
+#   check-memory-budget.sh <fit-report> <max-m9ks>
+#
+# Reads the M9K line of a Fitter report (<project>.fit.rpt) and fails if more
+# blocks were used than the caller allows. Run after the application image's
+# compile by build-local.sh and package.nix.
+#
+# The capture FIFO is the application image's only memory: 24576 16-bit words
+# is 48 of the EP4CE22's 66 M9Ks, and nothing else in the design is meant to
+# become RAM. The fit itself already fails if the design does not fit at all;
+# what this catches is the quieter failure, where it still fits but something
+# has started taking blocks it was not meant to - a delay line in the
+# decimation filters that Quartus decided to turn into an altshift_taps, or a
+# FIFO depth changed without the budget that goes with it. Either would leave
+# the next change with no room, and nobody would know until it failed to fit.
+#
+# The report line is printed whether or not the check passes, so that a build
+# log says what the image used.
+
+set -euo pipefail
+
+if [ "$#" -ne 2 ]; then
+    echo "usage: check-memory-budget.sh <fit-report> <max-m9ks>" >&2
+    exit 2
+fi
+
+report="$1"
+budget="$2"
+
+# The line reads "; M9Ks ; 48 / 66 ( 73 % ) ;" in the Fitter Resource Usage
+# Summary. Its absence is a failure rather than a pass: a report that no
+# longer has the line is a Quartus whose format this needs updating for.
+line="$(grep -m1 -E '^; M9Ks[[:space:]]+;' "$report" || true)"
+if [ -z "$line" ]; then
+    echo "check-memory-budget: no M9K line in $report" >&2
+    exit 1
+fi
+
+used="$(echo "$line" | sed -E 's/^; M9Ks[[:space:]]+;[[:space:]]*([0-9]+).*/\1/')"
+echo "Block memory: $(echo "$line" | sed -E 's/^; M9Ks[[:space:]]+;[[:space:]]*//; s/[[:space:]]*;[[:space:]]*$//') M9Ks (budget $budget)"
+
+if [ "$used" -gt "$budget" ]; then
+    echo "check-memory-budget: $used M9Ks used, over the budget of $budget" >&2
+    exit 1
+fi
@@ -49,6 +49,8 @@ module spiRegisters (
     // Register outputs
     output       test_mode,
     output [7:0] decimation,
+    output [7:0] wire_format,
+    output       inband_telemetry,
     output [7:0] leds,
 
     // The 0x20 to 0x23 window. A write pulses window_write for one clock
@@ -129,6 +131,21 @@ module spiRegisters (
     // synthesised into it.
     parameter [0:0] DecimationPresent = 1'b0;
 
+    // Whether this image can pack the sample stream, on exactly the terms of
+    // DecimationPresent: the factory image has no stream to pack, and with
+    // this off 0x13 folds away and reads zero - which is also what it reads on
+    // gateware built before it existed, and what it reads when the stream is
+    // in word mode. A host therefore learns the wire format by reading it
+    // back, and never by assuming its write was honoured.
+    parameter [0:0] PackingPresent = 1'b0;
+
+    // Whether this image can put the buffer instrument's readings into the
+    // sample stream itself. The same terms again: only the image with a
+    // capture buffer has readings to send, and with this off 0x14 folds away
+    // and reads zero, which a host takes as "no in-band telemetry" whether the
+    // gateware is the factory image or an application image that predates it.
+    parameter [0:0] InbandTelemetryPresent = 1'b0;
+
     // The register map this bank implements, reported at 0x01. Version 2
     // adds IMAGE_ROLE and the 0x20 to 0x23 window; everything version 1
     // defined is unchanged, and the identity block is frozen across all
@@ -152,13 +169,30 @@ module spiRegisters (
     // The decimation factors this gateware implements. The register holds the
     // factor rather than a flag, so that reading it back is a statement of
     // what the capture path is doing rather than an echo of what was asked
-    // for, and so that a third factor can be a value rather than a second bit.
+    // for, and so that 4:1 and 8:1 could arrive as values rather than bits.
     //
     // Anything else is normalised to EverySample rather than stored. Zero
     // especially: it is not a factor at all, and the alternative to normalising
     // it is a capture path asked to divide by it.
     localparam [7:0] EverySample = 8'h01;
     localparam [7:0] EverySecondSample = 8'h02;
+    localparam [7:0] EveryFourthSample = 8'h04;
+    localparam [7:0] EveryEighthSample = 8'h08;
+
+    // The wire formats. Zero is one word per sample, which is the reset value
+    // and what every gateware before this register sent; anything this
+    // gateware does not implement is normalised to it, for the reason zero is
+    // normalised in DECIMATION - the alternative is a stream the host would
+    // unpack as something it is not.
+    localparam [7:0] WireWords = 8'h00;
+    localparam [7:0] WirePacked = 8'h01;
+
+    // In-band telemetry is a switch, but stored and read back as a byte for
+    // the same reason as the wire format: anything but the one value that
+    // turns it on is normalised to off, so what a host reads back is what the
+    // stream will carry.
+    localparam [7:0] InbandOff = 8'h00;
+    localparam [7:0] InbandOn = 8'h01;
 
     // Input synchronisers ---------------------------------------------------
 
@@ -218,6 +252,8 @@ module spiRegisters (
 
     reg [7:0] test_mode_register;
     reg [7:0] decimation_register;
+    reg [7:0] wire_format_register;
+    reg [7:0] inband_telemetry_register;
     reg [7:0] led_register;
 
     // Unmapped addresses read as zero. That is what lets the map grow without
@@ -242,6 +278,8 @@ module spiRegisters (
                 7'h10:   read_register = test_mode_register;
                 7'h11:   read_register = led_register;
                 7'h12:   read_register = DecimationPresent ? decimation_register : 8'h00;
+                7'h13:   read_register = PackingPresent ? wire_format_register : 8'h00;
+                7'h14:   read_register = InbandTelemetryPresent ? inband_telemetry_register : 8'h00;
                 7'h20:   read_register = window_read_data[7:0];
                 7'h21:   read_register = window_read_data[15:8];
                 7'h22:   read_register = window_read_data[23:16];
@@ -320,6 +358,8 @@ module spiRegisters (
     // 0xFF agree about what they asked for
     assign test_mode           = (test_mode_register != 8'h00);
     assign decimation          = decimation_register;
+    assign wire_format         = wire_format_register;
+    assign inband_telemetry    = (inband_telemetry_register == InbandOn);
     assign leds                = led_register;
 
     assign window_write        = window_write_pulse;
@@ -350,6 +390,14 @@ module spiRegisters (
             // a file at a rate nobody asked for.
             decimation_register   <= EverySample;
 
+            // One word per sample, which is the format every host that
+            // predates this register expects
+            wire_format_register  <= WireWords;
+
+            // Off, so that the stream out of reset is exactly what it was
+            // before this register existed
+            inband_telemetry_register <= InbandOff;
+
             // One LED lit, which says "configured and running, but the FX3 has
             // not written here yet". An unconfigured FPGA shows none, because
             // its pins are high-Z, and the firmware overwrites this within a
@@ -432,8 +480,27 @@ module spiRegisters (
                                     // register fold away there.
                                     if (DecimationPresent) begin
                                         decimation_register <=
-                                            (shift_in_next == EverySecondSample) ?
-                                            EverySecondSample : EverySample;
+                                            ((shift_in_next == EverySecondSample) ||
+                                             (shift_in_next == EveryFourthSample) ||
+                                             (shift_in_next == EveryEighthSample)) ?
+                                            shift_in_next : EverySample;
+                                    end
+                                end
+                                7'h13: begin
+                                    // The same arrangement as 0x12, and the
+                                    // same reason for it
+                                    if (PackingPresent) begin
+                                        wire_format_register <=
+                                            (shift_in_next == WirePacked) ?
+                                            WirePacked : WireWords;
+                                    end
+                                end
+                                7'h14: begin
+                                    // And again
+                                    if (InbandTelemetryPresent) begin
+                                        inband_telemetry_register <=
+                                            (shift_in_next == InbandOn) ?
+                                            InbandOn : InbandOff;
                                     end
                                 end
                                 default: begin
@@ -196,6 +196,12 @@ module DomesdayDuplicatorFactory (
     // image's without either of them having to bump the map version.
     wire [ 7:0] decimation_unused;
 
+    // The wire format register, off on exactly the same terms
+    wire [ 7:0] wire_format_unused;
+
+    // and in-band telemetry, which has no buffer to report on here
+    wire        inband_telemetry_unused;
+
     spiRegisters #(
         .CommitText(`GATEWARE_COMMIT_TEXT),
         .BuildFlags(`GATEWARE_BUILD_FLAGS),
@@ -205,7 +211,9 @@ module DomesdayDuplicatorFactory (
         .ImageRole(8'h00),
 
         .TelemetryPresent (1'b0),
-        .DecimationPresent(1'b0)
+        .DecimationPresent(1'b0),
+        .PackingPresent   (1'b0),
+        .InbandTelemetryPresent(1'b0)
     ) spi_registers_0 (
         // Inputs
         .reset_n           (register_reset_n),
@@ -222,6 +230,8 @@ module DomesdayDuplicatorFactory (
         .spi_miso           (fx3_spi_miso),
         .test_mode          (test_mode_unused),
         .decimation         (decimation_unused),
+        .wire_format        (wire_format_unused),
+        .inband_telemetry   (inband_telemetry_unused),
         .leds               (leds),
         .window_write       (window_write_registers),
         .window_address     (window_address_registers),
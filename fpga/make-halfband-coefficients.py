@@ -1,5 +1,5 @@
 #!/usr/bin/env python3
-"""Generate the half-band decimation filter's coefficient table.
+"""Generate the half-band decimation filters' coefficient tables.
 
 Domesday Duplicator - LaserDisc RF sampler
 SPDX-FileCopyrightText: 2026 Simon Inns
@@ -17,8 +17,10 @@ time, because gateware cannot open a file. What keeps the two from drifting is
 fpga/tests/test_halfband_coefficients.py, which regenerates the table and fails
 if the committed one differs.
 
-    fpga/make-halfband-coefficients.py            # print the Verilog table
-    fpga/make-halfband-coefficients.py --response # print the frequency response
+    fpga/make-halfband-coefficients.py                    # the Verilog table
+    fpga/make-halfband-coefficients.py --response         # its response
+    fpga/make-halfband-coefficients.py --front            # the front stage's
+    fpga/make-halfband-coefficients.py --front --response # and its response
 
 Why a half-band filter, and why this one:
 
@@ -45,6 +47,26 @@ antisymmetric about 10 MHz and passes exactly -6 dB there, so energy just above
 10 MHz aliases to just below it at a comparable level. That is a property of
 2:1 decimation rather than of this filter: the only remedy is not to decimate a
 signal with content up there.
+
+The front stage, for 4:1 and 8:1:
+
+Lower rates are a cascade of 2:1 stages, and the 63-tap filter is always the
+last of them, so that the band edge of every decimated capture is drawn by the
+same sharp filter at a quarter of whatever rate reaches it. The stages in front
+of it - one for 4:1, two for 8:1, in fpga/application/halfBandPrefilter.v -
+have a far easier job. The final stage keeps only the lowest quarter of what
+they give it, so all a front stage has to do is keep the bottom eighth of its
+own input flat and stop what would fold into that eighth and the final stage's
+transition above it: everything from three eighths of its input rate up.
+
+That is a wide transition band, and it is bought with a short filter:
+
+    N=23, Kaiser beta=7   0.002 dB ripple to 5 MHz, -67 dB beyond 14 MHz
+
+at a 40 MHz input, and at half those frequencies for the second front stage.
+-67 dB is below a count of the 10-bit output, so a longer filter would be
+deeper stopband nobody could measure. Six multipliers rather than sixteen, and
+the centre tap still comes out at exactly half of full scale.
 """
 
 import argparse
@@ -61,6 +83,10 @@ SAMPLE_RATE_HZ = 40_000_000
 TAP_COUNT = 63
 KAISER_BETA = 7.0
 
+# The same for the front stages, for the reasons in the module docstring.
+FRONT_TAP_COUNT = 23
+FRONT_KAISER_BETA = 7.0
+
 # Coefficients are scaled by 2^15 and held as signed 16-bit values. Fifteen
 # bits is far more than a 10-bit converter can use - the quantisation floor of
 # the table sits around -90 dB, well below the -75 dB stopband it has to
@@ -99,7 +125,7 @@ def kaiser_window(index, length, beta):
     return bessel_i0(beta * math.sqrt(max(0.0, 1.0 - position * position))) / bessel_i0(beta)
 
 
-def coefficients():
+def coefficients(tap_count=TAP_COUNT, beta=KAISER_BETA):
     """The quantised half-band table, most negative index first.
 
     The zeros are forced rather than rounded to zero. They fall out of the
@@ -107,16 +133,16 @@ def coefficients():
     would cost a multiplier in the fabric to express a coefficient whose true
     value is nothing.
     """
-    centre = (TAP_COUNT - 1) // 2
+    centre = (tap_count - 1) // 2
     scale = 1 << COEFFICIENT_SCALE_BITS
 
     quantised = []
-    for index in range(TAP_COUNT):
+    for index in range(tap_count):
         offset = index - centre
         if offset != 0 and offset % 2 == 0:
             quantised.append(0)
             continue
-        ideal = 0.5 * sinc(0.5 * offset) * kaiser_window(index, TAP_COUNT, KAISER_BETA)
+        ideal = 0.5 * sinc(0.5 * offset) * kaiser_window(index, tap_count, beta)
         quantised.append(int(round(ideal * scale)))
 
     # DC gain of exactly one, so that a decimated capture sits at the same black
@@ -128,17 +154,17 @@ def coefficients():
 
 
 def symmetric_pairs(table):
-    """The 16 (coefficient, low index, high index) triples the fabric multiplies.
+    """The (coefficient, low index, high index) triples the fabric multiplies.
 
     The filter is symmetric, so each coefficient multiplies the sum of the two
     samples it applies to and one multiplier does the work of two.
     """
-    centre = (TAP_COUNT - 1) // 2
+    centre = (len(table) - 1) // 2
     pairs = []
     for index in range(0, centre):
         if table[index] == 0:
             continue
-        pairs.append((table[index], index, TAP_COUNT - 1 - index))
+        pairs.append((table[index], index, len(table) - 1 - index))
     return pairs
 
 
@@ -159,25 +185,26 @@ def decibels(magnitude):
     return 20.0 * math.log10(magnitude)
 
 
-def verilog_table():
+def verilog_table(tap_count=TAP_COUNT, beta=KAISER_BETA):
     """The committed Verilog, as text.
 
     Emitted whole rather than as a list of numbers so that the comparison the
     test makes is against exactly the characters in the source file, which is
     the only comparison that cannot pass while the file is wrong.
     """
-    table = coefficients()
+    table = coefficients(tap_count, beta)
     pairs = symmetric_pairs(table)
-    centre = (TAP_COUNT - 1) // 2
+    centre = (tap_count - 1) // 2
 
     lines = []
     lines.append("    // Coefficient table, generated by fpga/make-halfband-coefficients.py")
     lines.append("    // and checked against it by fpga/tests/test_halfband_coefficients.py.")
     lines.append("    // Do not hand-edit: run the generator.")
     lines.append("    //")
-    lines.append(f"    // {TAP_COUNT} taps, Kaiser window beta {KAISER_BETA}, scaled by 2^{COEFFICIENT_SCALE_BITS}.")
+    lines.append(f"    // {tap_count} taps, Kaiser window beta {beta}, scaled by 2^{COEFFICIENT_SCALE_BITS}.")
     lines.append("    // Each entry multiplies the sum of the two samples it is symmetric")
-    lines.append("    // across, so 16 multipliers cover 32 taps; the centre tap is exactly")
+    lines.append(f"    // across, so {len(pairs)} multipliers cover {2 * len(pairs)} taps; "
+                 "the centre tap is exactly")
     lines.append(f"    // half of full scale and is applied as a shift rather than a multiply.")
     lines.append("    //")
     lines.append("    //   tap pair        coefficient")
@@ -187,8 +214,8 @@ def verilog_table():
     lines.append("")
 
     # Packed so that a part select at 16*i reads the coefficient for taps 2i and
-    # N-1-2i: index 0 is the outermost pair and index 15 the pair either side of
-    # the centre. Verilog concatenation puts the first element in the most
+    # N-1-2i: index 0 is the outermost pair and the last index the pair either
+    # side of the centre. Verilog concatenation puts the first element in the most
     # significant bits, so the list is reversed to put the outermost pair at the
     # bottom - which is where the fabric's generate loop looks for it.
     parts = [f"-16'sd{-c}" if c < 0 else f"16'sd{c}" for c, _, _ in reversed(pairs)]
@@ -207,15 +234,22 @@ def main():
     parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
     parser.add_argument("--response", action="store_true",
                         help="print the frequency response instead of the table")
+    parser.add_argument("--front", action="store_true",
+                        help="the front stage used for 4:1 and 8:1, rather than "
+                             "the final one")
     arguments = parser.parse_args()
 
-    table = coefficients()
+    if arguments.front:
+        tap_count, beta = FRONT_TAP_COUNT, FRONT_KAISER_BETA
+    else:
+        tap_count, beta = TAP_COUNT, KAISER_BETA
+    table = coefficients(tap_count, beta)
 
     if not arguments.response:
-        print(verilog_table())
+        print(verilog_table(tap_count, beta))
         return 0
 
-    print(f"{TAP_COUNT} taps, Kaiser beta {KAISER_BETA}, "
+    print(f"{tap_count} taps, Kaiser beta {beta}, "
           f"scale 2^{COEFFICIENT_SCALE_BITS}, "
           f"{len(symmetric_pairs(table))} multipliers")
     print(f"DC gain {sum(table)} of {1 << COEFFICIENT_SCALE_BITS}")
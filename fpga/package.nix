@@ -49,6 +49,7 @@ stdenvNoCC.mkDerivation {
       ./factory
       ./provisioning
       ./bitstream-provenance.py
+      ./check-memory-budget.sh
       ./generate-version.sh
       ./make-boot-block.py
     ];
@@ -90,6 +91,8 @@ stdenvNoCC.mkDerivation {
     # without it, and it is the half that can never be repaired in the field.
     (cd factory && quartus_sh --flow compile DomesdayDuplicatorFactory)
     (cd application && quartus_sh --flow compile DomesdayDuplicator)
+    # 48 M9Ks is the capture FIFO and nothing else; see check-memory-budget.sh.
+    bash "$src/check-memory-budget.sh" application/DomesdayDuplicator.fit.rpt 48
 
     # The .cof files are committed and name their own inputs and outputs, so
     # the conversions need no arguments beyond the file itself. The
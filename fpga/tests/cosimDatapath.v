@@ -0,0 +1,140 @@
+/************************************************************************
+
+    cosimDatapath.v
+
+    The capture datapath, for the host-side co-simulation (T3)
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    Everything between the ADC pins and the FX3's databus, wired exactly as
+    DomesdayDuplicator.v wires it, with the register bank's outputs brought
+    out as ports. Verilator turns this into a C++ model, and
+    ddd-gui/tests/cosim/gateware_source.cpp drives that model as a capture
+    source, so the host's validator, telemetry parser and back-pressure
+    accounting are exercised by the real buffer rather than by a software
+    imitation of it.
+
+    Not part of either image. The top level cannot be simulated because of
+    the PLL, and everything it adds to this - the PLL, the pin mapping, the
+    SPI bank and the LEDs - is either covered by its own testbench or is
+    wiring. What is left is the part whose timing decides whether a stall
+    costs samples, and that is what this exposes.
+
+    The one liberty taken is the overflow output, a hierarchical read of the
+    buffer's own definition of a dropped word. The instrument's counters
+    saturate and clear on every reading, so they cannot be their own
+    reference; this is the count they are checked against.
+
+************************************************************************/
+
+module cosimDatapath (
+    input reset_n,
+    input clock,  // The 80 MHz system clock, a cycle per eval pair
+
+    // The ADC bus, sampled on every second clock as the top level does
+    input [9:0] adc_databus,
+
+    // What the register bank would be holding
+    input [7:0] decimation,
+    input       test_mode,
+    input       pack,
+    input       inband_telemetry,
+
+    // The FX3's side of the GPIF, and a register read of 0x40
+    input read_data,
+    input telemetry_latch,
+
+    // Outputs
+    output [15:0] fx3_databus,
+    output        data_available,
+    output        buffer_error,
+    output        fx3_is_reading,
+
+    output [127:0] telemetry,
+    output [ 47:0] telemetry_geometry,
+
+    // Diagnostics for the harness, not signals the FX3 can see
+    output word_written,
+    output overflow
+);
+
+    // The top level's divide-by-two, reset rather than left to power up in
+    // either phase, so every run of the model is the same run
+    reg adc_clock_divider;
+
+    always @(posedge clock, negedge reset_n) begin
+        if (!reset_n) begin
+            adc_clock_divider <= 1'b0;
+        end else begin
+            adc_clock_divider <= ~adc_clock_divider;
+        end
+    end
+
+    wire        sample_enable = ~adc_clock_divider;
+
+    wire [ 9:0] capture_sample;
+    wire        capture_enable;
+    wire [15:0] data_generator_out;
+    wire [15:0] packer_out;
+    wire        packer_write;
+
+    decimationChain decimation_chain_0 (
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(sample_enable),
+        .data_in      (adc_databus),
+        .decimation   (decimation),
+        .data_out     (capture_sample),
+        .output_enable(capture_enable)
+    );
+
+    dataGenerator data_generator_0 (
+        .reset_n       (reset_n),
+        .clock         (clock),
+        .sample_enable (capture_enable),
+        .adc_databus   (capture_sample),
+        .test_mode_flag(test_mode),
+        .data_out      (data_generator_out)
+    );
+
+    samplePacker sample_packer_0 (
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(capture_enable),
+        .data_in      (data_generator_out),
+        .pack         (pack),
+        .data_out     (packer_out),
+        .write_enable (packer_write)
+    );
+
+    // The depth the top level instantiates. A change there must be made here
+    // too, or the co-simulation tests a buffer the device does not have.
+    buffer #(
+        .FifoDepth(24576)
+    ) buffer_0 (
+        .reset_n           (reset_n),
+        .clock             (clock),
+        .write_enable      (packer_write),
+        .data_in           (packer_out),
+        .is_reading        (fx3_is_reading),
+        .telemetry_latch   (telemetry_latch),
+        .inband_telemetry  (inband_telemetry),
+        .data_out          (fx3_databus),
+        .data_available    (data_available),
+        .buffer_error      (buffer_error),
+        .telemetry         (telemetry),
+        .telemetry_geometry(telemetry_geometry)
+    );
+
+    fx3StateMachine fx3_state_machine_0 (
+        .reset_n       (reset_n),
+        .fx3_clock     (clock),
+        .read_data     (read_data),
+        .fx3_is_reading(fx3_is_reading)
+    );
+
+    assign word_written = packer_write;
+    assign overflow     = buffer_0.overflow;
+
+endmodule
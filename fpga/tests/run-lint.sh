@@ -41,9 +41,12 @@ modules=(
     "application:buffer"
     "application:bufferMonitor"
     "application:dataGenerator"
+    "application:decimationChain"
     "application:fifo"
     "application:fx3StateMachine"
     "application:halfBandDecimator"
+    "application:halfBandPrefilter"
+    "application:samplePacker"
     "common:spiRegisters"
     "common:flashBridge"
     "common:asmiBlock"
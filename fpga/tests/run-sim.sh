@@ -47,6 +47,9 @@ benches=(
     "tb_bufferMonitor:application/bufferMonitor"
     "tb_dataGenerator:application/dataGenerator"
     "tb_halfBandDecimator:application/halfBandDecimator"
+    "tb_halfBandPrefilter:application/halfBandPrefilter"
+    "tb_decimationChain:application/decimationChain,application/halfBandPrefilter,application/halfBandDecimator"
+    "tb_samplePacker:application/samplePacker"
     "tb_fifo:application/fifo"
     "tb_fx3StateMachine:application/fx3StateMachine"
     "tb_spiRegisters:common/spiRegisters"
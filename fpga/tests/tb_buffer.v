@@ -27,10 +27,17 @@
         and across an overflow.
       - an overflow drops the samples that do not fit and keeps what is
         already captured, rather than the reverse.
+      - a stall as long as the headroom above the packet threshold costs
+        nothing. That is the property the depth was chosen for, and the one
+        a host sees as dropped words when it is not met.
+      - with in-band telemetry on, every packet opens with the instrument's
+        block and the samples resume behind it without one being lost or
+        repeated, because the block is sent in place of FIFO reads rather
+        than over the top of them.
 
     The clock is 80 MHz and the writer runs one sample every second cycle,
     which is the 40 MSPS the instrument samples at. Nothing here is scaled
-    down: the packet is 8192 words and the FIFO is 16384, as built.
+    down: the packet is 8192 words and the FIFO is 24576, as built.
 
 ************************************************************************/
 
@@ -38,11 +45,16 @@
 
 module tb_buffer;
 
-    // Must match the localparams in buffer.v. They are not parameters of the
-    // module because they are not free: 8192 words is the FX3's DMA buffer and
-    // one 16 KiB USB 3 bulk endpoint buffer.
+    // The packet size must match the localparam in buffer.v. It is not a
+    // parameter of the module because it is not free: 8192 words is the FX3's
+    // DMA buffer and one 16 KiB USB 3 bulk endpoint buffer. The depth is, and
+    // this is the one the top level gives it.
     localparam integer PACKET_WORDS = 8192;
-    localparam integer FIFO_DEPTH = 16384;
+    localparam integer FIFO_DEPTH = 24576;
+
+    // What a stall is paid for out of: the room above the packet threshold,
+    // which is 16384 samples and 410 us of sampling.
+    localparam integer STALL_WORDS = FIFO_DEPTH - PACKET_WORDS;
 
     // buffer.v holds the error flag for 2000 cycles. It raises the flag and
     // zeroes the counter on the overflow edge, then counts 0, 1, ... and
@@ -50,6 +62,11 @@ module tb_buffer;
     // the flag is high for 2001 edges after the overflow.
     localparam integer ERROR_HOLD_EDGES = 2001;
 
+    // The in-band block, as bufferMonitor.v builds it and the host's
+    // inband_telemetry.h reads it
+    localparam integer INBAND_WORDS = 8;
+    localparam [15:0] INBAND_TAG = 16'hFDDD;
+
     reg             reset_n;
     reg             clock;
     reg             write_enable;
@@ -83,13 +100,22 @@ module tb_buffer;
     wire    [ 15:0] telemetry_peak = telemetry[47:32];
     wire    [ 15:0] telemetry_dropped = telemetry[95:80];
 
-    buffer dut (
+    reg             inband_telemetry;
+    reg     [ 15:0] block_word                  [0:INBAND_WORDS-1];
+    reg     [ 15:0] block_check;
+    integer         k;
+    integer         packet_number;
+
+    buffer #(
+        .FifoDepth(FIFO_DEPTH)
+    ) dut (
         .reset_n           (reset_n),
         .clock             (clock),
         .write_enable      (write_enable),
         .data_in           (data_in),
         .is_reading        (is_reading),
         .telemetry_latch   (telemetry_latch),
+        .inband_telemetry  (inband_telemetry),
         .data_out          (data_out),
         .data_available    (data_available),
         .buffer_error      (buffer_error),
@@ -174,6 +200,38 @@ module tb_buffer;
         end
     endtask
 
+    // Read one whole packet with in-band telemetry on: the block's eight
+    // words, then the samples, which must carry on from wherever the last
+    // packet left them
+    task read_packet_with_block;
+        input writer_running;
+        input [15:0] number;
+        begin
+            for (j = 0; j < PACKET_WORDS; j = j + 1) begin
+                if (j < INBAND_WORDS) begin
+                    block_word[j] = data_out;
+                end else begin
+                    check({16'd0, data_out}, {16'd0, read_value}, "packet word order behind the block");
+                end
+                check(data_available, 32'd1, "data_available is held for the whole packet");
+
+                cycle(writer_running && ((j % 2) == 0), 1'b1);
+                if (j >= INBAND_WORDS) begin
+                    read_value = read_value + 16'd1;
+                end
+            end
+
+            check({16'd0, block_word[0]}, {16'd0, INBAND_TAG}, "a packet opens with the in-band tag");
+            check({16'd0, block_word[2]}, {16'd0, number}, "and the packet's number");
+
+            block_check = 16'd0;
+            for (k = 0; k < INBAND_WORDS - 1; k = k + 1) begin
+                block_check = block_check ^ block_word[k];
+            end
+            check({16'd0, block_word[INBAND_WORDS-1]}, {16'd0, block_check}, "the block's check word");
+        end
+    endtask
+
     // Sample the instrument, as the register bank does: one clock of latch
     task take_reading;
         begin
@@ -192,6 +250,7 @@ module tb_buffer;
         write_value     = 16'd0;
         read_value      = 16'd0;
         telemetry_latch = 1'b0;
+        inband_telemetry = 1'b0;
         reset_n         = 1'b0;
 
         @(posedge clock);
@@ -305,16 +364,66 @@ module tb_buffer;
         check(held, ERROR_HOLD_EDGES, "second buffer_error hold in clock cycles");
 
         // --- What survived an overflow --------------------------------------
-        // Drain the lot. The FIFO is still full, so this is two whole packets,
-        // and every word must be one of the ones written before the drop.
-        check(data_available, 32'd1, "data_available with a full buffer");
-        read_packet(1'b0);
-        idle(4);
-        check(data_available, 32'd1, "data_available for the second queued packet");
-        read_packet(1'b0);
-        idle(4);
+        // Drain the lot. The FIFO is still full, so this is a whole number of
+        // packets, and every word must be one of the ones written before the
+        // drop.
+        for (packet_number = 0; packet_number < FIFO_DEPTH / PACKET_WORDS;
+             packet_number = packet_number + 1) begin
+            check(data_available, 32'd1, "data_available for each queued packet");
+            read_packet(1'b0);
+            idle(4);
+        end
         check(data_available, 32'd0, "data_available once the overflowed buffer is drained");
 
+        // --- Stall tolerance ------------------------------------------------
+        // The case the depth is for. A packet is offered and the FX3 does not
+        // come for it, because the host has stopped polling, while the
+        // sampling side carries on. Every sample up to the depth is kept: the
+        // stall the headroom pays for is lost-nothing, not merely shorter.
+        reset_n = 1'b0;
+        @(posedge clock);
+        #1 reset_n = 1'b1;
+
+        write_value = 16'h6000;
+        read_value  = 16'h6000;
+        write_samples(PACKET_WORDS);
+        idle(4);
+        check(data_available, 32'd1, "a packet is offered as the stall begins");
+
+        write_samples(STALL_WORDS);
+        check(buffer_error, 32'd0, "a stall as long as the headroom drops nothing");
+        take_reading;
+        check({16'd0, telemetry_dropped}, 32'd0, "and the instrument agrees");
+        check({16'd0, telemetry_used_now}, FIFO_DEPTH, "with the FIFO exactly full");
+
+        // The FX3 comes back with the writer still running. Reading a word a
+        // cycle against a writer at half that drains a packet's worth every
+        // two packets, and the order has to carry across every one of them.
+        for (packet_number = 0; packet_number < 2 * (FIFO_DEPTH / PACKET_WORDS);
+             packet_number = packet_number + 1) begin
+            while (data_available !== 1'b1) begin
+                cycle(1'b1, 1'b0);
+                cycle(1'b0, 1'b0);
+            end
+            read_packet(1'b1);
+        end
+        check(buffer_error, 32'd0, "buffer_error while recovering from a stall");
+
+        // One sample longer is the first one lost, so the figure above is the
+        // real margin rather than a lower bound on it
+        reset_n = 1'b0;
+        @(posedge clock);
+        #1 reset_n = 1'b1;
+
+        write_samples(PACKET_WORDS + STALL_WORDS);
+        check(buffer_error, 32'd0, "the headroom is exactly the stall");
+        write_samples(1);
+        check(buffer_error, 32'd1, "one sample more is the first dropped");
+
+        reset_n = 1'b0;
+        @(posedge clock);
+        #1 reset_n = 1'b1;
+
         // --- Reset while occupied -------------------------------------------
         // reset_n is the FX3's and drops when the host closes the device. The
         // next capture must not begin with the tail of the last one.
@@ -376,6 +485,67 @@ module tb_buffer;
         take_reading;
         check({16'd0, telemetry_dropped}, 32'd3, "and the instrument counted the same drops");
 
+        // --- In-band telemetry ------------------------------------------------
+        //
+        // The first packet after a reset is packet zero, and it reports the
+        // occupancy it was offered at: exactly one packet.
+        reset_n = 1'b0;
+        @(posedge clock);
+        #1 reset_n = 1'b1;
+        inband_telemetry = 1'b1;
+
+        write_value = 16'h2000;
+        read_value  = 16'h2000;
+        write_samples(PACKET_WORDS);
+        idle(4);
+        check(data_available, 32'd1, "a packet is offered at the same threshold");
+        read_packet_with_block(1'b0, 16'd0);
+        check({16'd0, block_word[3]}, PACKET_WORDS, "the block reports the occupancy it was offered at");
+        check(data_available, 32'd0, "the packet with the block in it is still a packet long");
+
+        // The block was sent in place of eight FIFO reads, so eight words of
+        // the packet's worth are still queued. That is the proof nothing was
+        // read from under the block and thrown away.
+        take_reading;
+        check({16'd0, telemetry_used_now}, INBAND_WORDS, "the FIFO was not read while the block went out");
+
+        // Steady state, with the writer running: the samples run on across
+        // packet boundaries, and the blocks between them count up
+        for (packet_number = 1; packet_number < 3; packet_number = packet_number + 1) begin
+            while (data_available !== 1'b1) begin
+                cycle(1'b1, 1'b0);
+                cycle(1'b0, 1'b0);
+            end
+            read_packet_with_block(1'b1, packet_number[15:0]);
+        end
+        check(buffer_error, 32'd0, "buffer_error across packets with blocks in them");
+
+        // Off again, and the stream is words and nothing else - carrying on
+        // from the last sample behind the last block
+        inband_telemetry = 1'b0;
+        while (data_available !== 1'b1) begin
+            cycle(1'b1, 1'b0);
+            cycle(1'b0, 1'b0);
+        end
+        read_packet(1'b1);
+
+        // The switch is sampled as a packet is offered. A packet offered with
+        // it off stays all samples however soon after it is turned on.
+        while (data_available !== 1'b1) begin
+            cycle(1'b1, 1'b0);
+            cycle(1'b0, 1'b0);
+        end
+        inband_telemetry = 1'b1;
+        read_packet(1'b1);
+
+        // ... and the next one has its block. Every packet offered is
+        // numbered, whether or not it carried a block, so this is packet five.
+        while (data_available !== 1'b1) begin
+            cycle(1'b1, 1'b0);
+            cycle(1'b0, 1'b0);
+        end
+        read_packet_with_block(1'b1, 16'd5);
+
         if (errors == 0) begin
             $display("tb_buffer: PASS");
         end else begin
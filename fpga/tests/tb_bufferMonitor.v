@@ -25,6 +25,8 @@
         catastrophe
       - a latch loses nothing: an event on the latching edge is counted in
         the interval that is starting, not dropped and not counted twice
+      - the in-band block and the register bank are two readers with an
+        interval each, and neither reading clears the other's
 
     The FIFO is modelled rather than instantiated. What is under test is the
     arithmetic over used_words, and driving the occupancy directly is what
@@ -39,9 +41,9 @@ module tb_bufferMonitor;
 
     // The geometry the application image builds, so what is tested is the
     // instrument as it ships rather than a scaled-down version of it
-    localparam integer FIFO_DEPTH = 16384;
+    localparam integer FIFO_DEPTH = 24576;
     localparam integer PACKET_WORDS = 8192;
-    localparam integer NEAR_FULL_WORDS = 12288;
+    localparam integer NEAR_FULL_WORDS = 16384;
 
     localparam integer USED_BITS = 15;
 
@@ -57,9 +59,11 @@ module tb_bufferMonitor;
     reg                     overflow;
     reg                     is_reading;
     reg                     latch;
+    reg                     packet_start;
 
     wire    [        127:0] telemetry;
     wire    [         47:0] geometry;
+    wire    [        127:0] inband_block;
 
     integer                 errors;
     integer                 i;
@@ -76,8 +80,10 @@ module tb_bufferMonitor;
         .overflow    (overflow),
         .is_reading  (is_reading),
         .latch       (latch),
+        .packet_start(packet_start),
         .telemetry   (telemetry),
-        .geometry    (geometry)
+        .geometry    (geometry),
+        .inband_block(inband_block)
     );
 
     // The shadow bank, named. The map presents these as bytes from TELEM_STATUS
@@ -93,6 +99,17 @@ module tb_bufferMonitor;
     wire [15:0] t_packets = telemetry[111:96];
     wire [15:0] t_near_full = telemetry[127:112];
 
+    // The in-band block, named by the word the FX3 sends it as. Word zero goes
+    // first, so it is the low sixteen bits.
+    wire [15:0] b_tag = inband_block[15:0];
+    wire [15:0] b_format_flags = inband_block[31:16];
+    wire [15:0] b_number = inband_block[47:32];
+    wire [15:0] b_used = inband_block[63:48];
+    wire [15:0] b_peak = inband_block[79:64];
+    wire [15:0] b_dropped = inband_block[95:80];
+    wire [15:0] b_depth = inband_block[111:96];
+    wire [15:0] b_check = inband_block[127:112];
+
     // 80 MHz — 12.5 ns period
     initial begin
         clock = 1'b0;
@@ -154,6 +171,28 @@ module tb_bufferMonitor;
         end
     endtask
 
+    // Offer a packet at the given occupancy, as buffer.v does on the edge its
+    // data_available rises: one clock of packet_start
+    task offer_packet;
+        input [15:0] occupancy;
+        begin
+            packet_start = 1'b1;
+            cycle(occupancy, 1'b0, 1'b0, 1'b0, 1'b0);
+            packet_start = 1'b0;
+        end
+    endtask
+
+    // The block's fixed words and its check, which every block must have
+    task check_block_framing;
+        begin
+            check({16'd0, b_tag}, 32'hFDDD, "in-band tag");
+            check({24'd0, b_format_flags[7:0]}, 32'd1, "in-band format");
+            check({16'd0, b_depth}, FIFO_DEPTH, "in-band depth");
+            check({16'd0, b_check}, {16'd0, b_tag ^ b_format_flags ^ b_number ^ b_used ^
+                                      b_peak ^ b_dropped ^ b_depth}, "in-band check word");
+        end
+    endtask
+
     // A stall: `samples` samples offered to a full FIFO, none of which fit
     task stall;
         input integer samples;
@@ -172,6 +211,7 @@ module tb_bufferMonitor;
         overflow     = 1'b0;
         is_reading   = 1'b0;
         latch        = 1'b0;
+        packet_start = 1'b0;
         reset_n      = 1'b0;
 
         @(posedge clock);
@@ -334,6 +374,57 @@ module tb_bufferMonitor;
         take_reading;
         check({24'd0, t_status}, 32'h11, "the saturation bit clears with the interval");
 
+        // --- The in-band block ----------------------------------------------------
+        //
+        // Nothing above offered a packet, so this is the first block, and it
+        // is numbered from zero.
+        offer_packet(16'd8192);
+        check_block_framing;
+        check({16'd0, b_number}, 32'd0, "the first block is packet zero");
+        check({16'd0, b_used}, 32'd8192, "in-band occupancy as the packet is offered");
+
+        // The interval is one packet to the next, and it has a peak of its own
+        hold(16'd9000, 20);
+        hold(16'd6000, 20);
+        offer_packet(16'd8192);
+        check_block_framing;
+        check({16'd0, b_number}, 32'd1, "the next block is the next packet");
+        check({16'd0, b_peak}, 32'd9000, "in-band peak of the packet interval");
+        check({16'd0, b_dropped}, 32'd0, "nothing dropped in a quiet packet interval");
+        check({24'd0, b_format_flags[15:8]}, 32'd0, "no flags in a quiet packet interval");
+
+        // A register-bank reading in the middle of a packet interval clears
+        // the register bank's interval and not this one
+        hold(16'd10000, 4);
+        take_reading;
+        hold(16'd3000, 2);
+        offer_packet(16'd8192);
+        check({16'd0, b_peak}, 32'd10000, "a register reading does not clear the in-band peak");
+
+        // ... and a packet offered does not clear the register bank's. The
+        // stall lands in both intervals and is counted whole in each.
+        take_reading;
+        stall(5);
+        hold(16'd8000, 2);
+        offer_packet(16'd8192);
+        check_block_framing;
+        check({16'd0, b_dropped}, 32'd5, "in-band count of the samples a stall cost");
+        check({24'd0, b_format_flags[15:8]}, 32'd1, "the near-full flag, set by the full FIFO");
+        check({16'd0, b_peak}, FIFO_DEPTH, "in-band peak at the depth");
+        take_reading;
+        check({16'd0, t_dropped}, 32'd5, "and the register bank counted the same drops");
+
+        // The block stands still between offers, whatever the buffer does,
+        // because the FX3 may take its eight words at any point in the packet
+        hold(16'd2000, 10);
+        check({16'd0, b_used}, 32'd8192, "the block stands still between offers");
+        check({16'd0, b_dropped}, 32'd5, "all of it");
+
+        offer_packet(16'd8192);
+        check({16'd0, b_dropped}, 32'd0, "the drop count clears with the packet interval");
+        check({24'd0, b_format_flags[15:8]}, 32'd0, "and so does the near-full flag");
+        check({16'd0, b_number}, 32'd4, "one number per packet offered");
+
         // --- Reset --------------------------------------------------------------
         //
         // reset_n is the FX3's and drops when the host closes the device. The
@@ -353,6 +444,9 @@ module tb_bufferMonitor;
         take_reading;
         check({16'd0, t_peak}, 32'd5000, "the instrument works after a reset");
 
+        offer_packet(16'd8192);
+        check({16'd0, b_number}, 32'd0, "reset starts the packet numbers again");
+
         if (errors == 0) begin
             $display("tb_bufferMonitor: PASS");
         end else begin
@@ -0,0 +1,363 @@
+/************************************************************************
+
+    tb_decimationChain.v
+
+    Testbench for the 1:1, 2:1, 4:1 and 8:1 sample rates (T3)
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    The stages are measured one at a time by tb_halfBandDecimator.v and
+    tb_halfBandPrefilter.v. This measures them in the order the register
+    puts them in, at the rates they actually run at there, which is where a
+    stage wired to the wrong enable or switched in at the wrong factor would
+    show: the rate would be wrong, or an alias a stage exists to stop would
+    come through.
+
+    For each factor, the three things a capture at that rate depends on: one
+    sample out for every `factor` in, a passband that is flat below the new
+    band edge, and a tone that would fold into that passband stopped - one
+    for each stage that is in use, at a frequency only that stage can stop.
+
+************************************************************************/
+
+`timescale 1ns / 1ps
+
+module tb_decimationChain;
+
+    reg         reset_n;
+    reg         clock;
+    reg  [ 9:0] data_in;
+    reg  [ 7:0] decimation;
+
+    wire [ 9:0] data_out;
+    wire        output_enable;
+
+    integer     errors;
+    integer     i;
+
+    // The sampling rate, and the two rates derived from it. Written out
+    // because every frequency assertion below is stated in MHz and has to be
+    // converted to a phase step against this.
+    localparam real SampleRateHz = 40.0e6;
+
+    // The chain's group delay at 8:1 is 11 input samples through the first
+    // front stage, 22 through the second and 124 through the final stage,
+    // each at its own rate; the settling window is several times that. The
+    // measurements run long enough to give 8:1 a few hundred outputs.
+    localparam integer SettlingSamples = 800;
+    localparam integer MeasuredSamples = 6000;
+
+    // 80 MHz system clock - 12.5 ns period
+    initial begin
+        clock = 1'b0;
+    end
+    always begin
+        #6.25 clock = ~clock;
+    end
+
+    // The sampling enable, built as the top level builds it: a free-running
+    // divide-by-two of the system clock, with the enable high on the cycle
+    // that takes the ADC clock high.
+    reg adc_clock_divider;
+    initial begin
+        adc_clock_divider = 1'b0;
+    end
+    always @(posedge clock) begin
+        adc_clock_divider <= ~adc_clock_divider;
+    end
+
+    wire sample_enable = ~adc_clock_divider;
+
+    decimationChain dut (
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(sample_enable),
+        .data_in      (data_in),
+        .decimation   (decimation),
+
+        .data_out     (data_out),
+        .output_enable(output_enable)
+    );
+
+    // Measurement state, updated by the monitor below ------------------------
+
+    integer input_samples;  // sample_enable pulses since the counters were cleared
+    integer output_samples;  // output_enable pulses in the same window
+    integer minimum_out;
+    integer maximum_out;
+    integer settling;  // outputs still to be discarded before measuring
+
+    task clear_measurement;
+        input integer discard;
+        begin
+            @(negedge clock);
+            input_samples  = 0;
+            output_samples = 0;
+            minimum_out    = 1023;
+            maximum_out    = 0;
+            settling       = discard;
+        end
+    endtask
+
+    always @(posedge clock) begin
+        if (reset_n) begin
+            if (sample_enable) begin
+                input_samples = input_samples + 1;
+            end
+
+            if (output_enable) begin
+                if (settling > 0) begin
+                    settling = settling - 1;
+                end else begin
+                    output_samples = output_samples + 1;
+                    if (data_out < minimum_out) begin
+                        minimum_out = data_out;
+                    end
+                    if (data_out > maximum_out) begin
+                        maximum_out = data_out;
+                    end
+                end
+            end
+        end
+    end
+
+    // Drive a sinusoid at the sampling rate, full scale about mid-range.
+    //
+    // Amplitude 480 rather than 511 so that the filter's overshoot has
+    // somewhere to go: a test that clipped would measure the clipping rather
+    // than the filter.
+    // The phase advances once per *sample*, not once per clock. The enable is
+    // high on every second clock, so a loop that stepped the phase per clock
+    // would drive a tone at twice the frequency it named - and would do it
+    // convincingly, because every measurement below would still come out as a
+    // number.
+    task drive_tone;
+        input real frequency_hz;
+        input integer samples;
+        integer n;
+        real phase;
+        begin
+            n = 0;
+            while (n < samples) begin
+                @(negedge clock);
+                if (sample_enable) begin
+                    phase   = 2.0 * 3.14159265358979 * frequency_hz * n / SampleRateHz;
+                    data_in = 512 + $rtoi(480.0 * $sin(phase));
+                    n       = n + 1;
+                end
+            end
+        end
+    endtask
+
+    task drive_constant;
+        input integer value;
+        input integer samples;
+        integer n;
+        begin
+            data_in = value;
+            for (n = 0; n < samples; n = n + 1) begin
+                @(negedge clock);
+            end
+        end
+    endtask
+
+    // The peak-to-peak swing of the last measurement, against the 960-count
+    // swing that was driven in.
+    real gain;
+
+    task check_gain;
+        input [255:0] name;
+        input real low;
+        input real high;
+        begin
+            gain = (maximum_out - minimum_out) / 960.0;
+            if (gain < low || gain > high) begin
+                $display("FAIL: %0s gain %f not in %f..%f (swing %0d..%0d)", name, gain, low, high,
+                         minimum_out, maximum_out);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    task do_reset;
+        begin
+            reset_n = 1'b0;
+            data_in = 10'd512;
+            @(negedge clock);
+            @(negedge clock);
+            reset_n = 1'b1;
+            @(negedge clock);
+        end
+    endtask
+
+    // One output for every `factor` inputs. Allowed to be a sample or two
+    // adrift either way: every stage in use can have an output still in its
+    // pipeline, and each can start on either of its two phases.
+    task check_rate;
+        input integer factor;
+        begin
+            if (output_samples > (input_samples / factor) + 1 ||
+                output_samples < (input_samples / factor) - 2) begin
+                $display("FAIL: %0d:1 rate %0d outputs for %0d inputs", factor, output_samples,
+                         input_samples);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    task measure_tone;
+        input real frequency_hz;
+        begin
+            do_reset;
+            drive_tone(frequency_hz, SettlingSamples);
+            clear_measurement(0);
+            drive_tone(frequency_hz, MeasuredSamples);
+        end
+    endtask
+
+    task check_dc;
+        input integer value;
+        begin
+            do_reset;
+            drive_constant(value, SettlingSamples * 2);
+            clear_measurement(0);
+            drive_constant(value, SettlingSamples * 2);
+            if (minimum_out !== value || maximum_out !== value) begin
+                $display("FAIL: %0d:1 DC %0d came out as %0d..%0d", decimation, value,
+                         minimum_out, maximum_out);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    initial begin
+        errors     = 0;
+        decimation = 8'h01;
+        do_reset;
+
+        // --- 1:1 -----------------------------------------------------------
+        //
+        // Every stage bypassed, and the stream bit for bit what it was before
+        // any of them existed - on the cycle it arrived, not a clock later.
+
+        clear_measurement(0);
+        for (i = 0; i < 200; i = i + 1) begin
+            @(negedge clock);
+            if (sample_enable) begin
+                data_in = i[9:0];
+            end
+
+            #1;
+            if (output_enable && data_out !== data_in) begin
+                $display("FAIL: 1:1 altered a sample: in %0d out %0d", data_in, data_out);
+                errors = errors + 1;
+            end
+        end
+
+        if (output_samples != input_samples) begin
+            $display("FAIL: 1:1 rate %0d outputs for %0d inputs", output_samples, input_samples);
+            errors = errors + 1;
+        end
+
+        // --- 2:1 -----------------------------------------------------------
+        //
+        // The final stage alone, at 40 MHz: the path the gateware had before
+        // this chain, which tb_halfBandDecimator.v covers in full.
+
+        decimation = 8'h02;
+        measure_tone(1.0e6);
+        check_rate(2);
+        check_gain("2:1 1 MHz", 0.97, 1.03);
+
+        measure_tone(15.7e6);
+        check_gain("2:1 15.7 MHz alias", 0.0, 0.02);
+
+        check_dc(512);
+
+        // --- 4:1 -----------------------------------------------------------
+        //
+        // 10 Msps, flat to 4 MHz. 7.7 MHz reaches the final stage at its own
+        // 20 MHz input and would fold to 2.3 MHz: the final stage's to stop.
+        // 17.3 MHz would fold to 2.7 MHz at the front stage's decimation:
+        // the front stage's to stop, since the final stage never sees it as
+        // anything but an in-band tone.
+
+        decimation = 8'h04;
+        measure_tone(1.0e6);
+        check_rate(4);
+        check_gain("4:1 1 MHz", 0.97, 1.03);
+
+        measure_tone(3.3e6);
+        check_gain("4:1 3.3 MHz", 0.97, 1.03);
+
+        measure_tone(7.7e6);
+        check_gain("4:1 7.7 MHz alias, final stage", 0.0, 0.02);
+
+        measure_tone(17.3e6);
+        check_gain("4:1 17.3 MHz alias, front stage", 0.0, 0.02);
+
+        check_dc(512);
+        check_dc(200);
+
+        // --- 8:1 -----------------------------------------------------------
+        //
+        // 5 Msps, flat to 2 MHz, and one alias for each of the three stages:
+        // 3.7 MHz for the final stage at 10 MHz, 8.7 MHz for the second front
+        // stage at 20 MHz, and 17.3 MHz for the first at 40 MHz - each of
+        // them a tone that every stage behind the one that stops it would
+        // take for signal.
+
+        decimation = 8'h08;
+        measure_tone(0.7e6);
+        check_rate(8);
+        check_gain("8:1 0.7 MHz", 0.97, 1.03);
+
+        measure_tone(1.7e6);
+        check_gain("8:1 1.7 MHz", 0.97, 1.03);
+
+        measure_tone(3.7e6);
+        check_gain("8:1 3.7 MHz alias, final stage", 0.0, 0.02);
+
+        measure_tone(8.7e6);
+        check_gain("8:1 8.7 MHz alias, second front stage", 0.0, 0.02);
+
+        measure_tone(17.3e6);
+        check_gain("8:1 17.3 MHz alias, first front stage", 0.0, 0.02);
+
+        check_dc(512);
+        check_dc(200);
+
+        // --- And back ------------------------------------------------------
+        //
+        // A change of factor takes effect without a reset, and 1:1 after 8:1
+        // is the bypass again rather than whatever the stages left behind.
+
+        decimation = 8'h01;
+        for (i = 0; i < 100; i = i + 1) begin
+            @(negedge clock);
+            if (sample_enable) begin
+                data_in = i[9:0];
+            end
+
+            #1;
+            if (output_enable && data_out !== data_in) begin
+                $display("FAIL: 1:1 after 8:1 altered a sample: in %0d out %0d", data_in,
+                         data_out);
+                errors = errors + 1;
+            end
+        end
+
+        if (errors == 0) begin
+            $display("tb_decimationChain: PASS");
+        end else begin
+            $display("tb_decimationChain: FAIL (%0d errors)", errors);
+        end
+
+        if (errors != 0) begin
+            $fatal(1, "tb_decimationChain failed");
+        end
+        $finish;
+    end
+
+endmodule
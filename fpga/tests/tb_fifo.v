@@ -20,7 +20,8 @@
              compare to support - a design that wrapped by letting the pointer
              overflow would pass every other test here and corrupt this one
       8      a power of two, where the compare and an overflow agree
-      16384  the depth the instrument is built with
+      24576  the depth the instrument is built with, which is three packets
+             and so not a power of two either
 
     Each depth is an instance of fifo_case, which runs the whole sequence
     against its own clock and reports its own error count. tb_fifo waits for
@@ -358,7 +359,7 @@ module tb_fifo;
     );
 
     fifo_case #(
-        .Depth(16384)
+        .Depth(24576)
     ) case_instrument (
         .done  (done_instrument),
         .errors(errors_instrument)
@@ -0,0 +1,342 @@
+/************************************************************************
+
+    tb_halfBandPrefilter.v
+
+    Testbench for the front stage of 4:1 and 8:1 decimation (T3)
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    The same measurement as tb_halfBandDecimator.v - a real sinusoid in, the
+    amplitude out - against the band this stage is responsible for, which is
+    not the final stage's. It has to be transparent across the lowest eighth
+    of its input, which is all the final stage behind it keeps, and deep from
+    three eighths up, which is everything that would fold into that eighth.
+    Between the two it is allowed to be soft, and it is: 8 MHz, which the
+    final stage would pass untouched, is measurably down here. That test is
+    the one that says this is the short filter and not a copy of the long one.
+
+    Stated at a 40 MHz input, which is where front stage 0 runs. Front
+    stage 1 is the same module at 20 MHz and the same response at half the
+    frequencies; tb_decimationChain.v measures it there.
+
+************************************************************************/
+
+`timescale 1ns / 1ps
+
+module tb_halfBandPrefilter;
+
+    reg         reset_n;
+    reg         clock;
+    reg  [ 9:0] data_in;
+    reg         decimate;
+
+    wire [ 9:0] data_out;
+    wire        output_enable;
+
+    integer     errors;
+    integer     i;
+
+    // The sampling rate, and the two rates derived from it. Written out
+    // because every frequency assertion below is stated in MHz and has to be
+    // converted to a phase step against this.
+    localparam real SampleRateHz = 40.0e6;
+
+    // The filter's group delay is (23-1)/2 = 11 input samples, and the
+    // pipeline adds five system clocks on top. Nothing here depends on the
+    // exact figure - the measurements below discard a settling window far
+    // longer than it - but a run that produced no output at all would
+    // otherwise look like a very quiet one.
+    localparam integer SettlingSamples = 400;
+
+    // 80 MHz system clock - 12.5 ns period
+    initial begin
+        clock = 1'b0;
+    end
+    always begin
+        #6.25 clock = ~clock;
+    end
+
+    // The sampling enable, built as the top level builds it: a free-running
+    // divide-by-two of the system clock, with the enable high on the cycle
+    // that takes the ADC clock high.
+    reg adc_clock_divider;
+    initial begin
+        adc_clock_divider = 1'b0;
+    end
+    always @(posedge clock) begin
+        adc_clock_divider <= ~adc_clock_divider;
+    end
+
+    wire sample_enable = ~adc_clock_divider;
+
+    halfBandPrefilter dut (
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(sample_enable),
+        .data_in      (data_in),
+        .decimate     (decimate),
+
+        .data_out     (data_out),
+        .output_enable(output_enable)
+    );
+
+    // Measurement state, updated by the monitor below ------------------------
+
+    integer input_samples;  // sample_enable pulses since the counters were cleared
+    integer output_samples;  // output_enable pulses in the same window
+    integer minimum_out;
+    integer maximum_out;
+    integer settling;  // outputs still to be discarded before measuring
+
+    task clear_measurement;
+        input integer discard;
+        begin
+            @(negedge clock);
+            input_samples  = 0;
+            output_samples = 0;
+            minimum_out    = 1023;
+            maximum_out    = 0;
+            settling       = discard;
+        end
+    endtask
+
+    always @(posedge clock) begin
+        if (reset_n) begin
+            if (sample_enable) begin
+                input_samples = input_samples + 1;
+            end
+
+            if (output_enable) begin
+                if (settling > 0) begin
+                    settling = settling - 1;
+                end else begin
+                    output_samples = output_samples + 1;
+                    if (data_out < minimum_out) begin
+                        minimum_out = data_out;
+                    end
+                    if (data_out > maximum_out) begin
+                        maximum_out = data_out;
+                    end
+                end
+            end
+        end
+    end
+
+    // Drive a sinusoid at the sampling rate, full scale about mid-range.
+    //
+    // Amplitude 480 rather than 511 so that the filter's overshoot has
+    // somewhere to go: a test that clipped would measure the clipping rather
+    // than the filter.
+    // The phase advances once per *sample*, not once per clock. The enable is
+    // high on every second clock, so a loop that stepped the phase per clock
+    // would drive a tone at twice the frequency it named - and would do it
+    // convincingly, because every measurement below would still come out as a
+    // number.
+    task drive_tone;
+        input real frequency_hz;
+        input integer samples;
+        integer n;
+        real phase;
+        begin
+            n = 0;
+            while (n < samples) begin
+                @(negedge clock);
+                if (sample_enable) begin
+                    phase   = 2.0 * 3.14159265358979 * frequency_hz * n / SampleRateHz;
+                    data_in = 512 + $rtoi(480.0 * $sin(phase));
+                    n       = n + 1;
+                end
+            end
+        end
+    endtask
+
+    task drive_constant;
+        input integer value;
+        input integer samples;
+        integer n;
+        begin
+            data_in = value;
+            for (n = 0; n < samples; n = n + 1) begin
+                @(negedge clock);
+            end
+        end
+    endtask
+
+    // The peak-to-peak swing of the last measurement, against the 960-count
+    // swing that was driven in.
+    real gain;
+
+    task check_gain;
+        input [255:0] name;
+        input real low;
+        input real high;
+        begin
+            gain = (maximum_out - minimum_out) / 960.0;
+            if (gain < low || gain > high) begin
+                $display("FAIL: %0s gain %f not in %f..%f (swing %0d..%0d)", name, gain, low, high,
+                         minimum_out, maximum_out);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    task do_reset;
+        begin
+            reset_n = 1'b0;
+            data_in = 10'd512;
+            @(negedge clock);
+            @(negedge clock);
+            reset_n = 1'b1;
+            @(negedge clock);
+        end
+    endtask
+
+    initial begin
+        errors   = 0;
+        decimate = 1'b0;
+        do_reset;
+
+        // --- Passthrough --------------------------------------------------
+        //
+        // A stage that is not in use must be invisible: at 2:1 both of these
+        // are bypassed, and that path must be bit for bit what it was before
+        // they existed.
+
+        clear_measurement(0);
+        for (i = 0; i < 200; i = i + 1) begin
+            @(negedge clock);
+            if (sample_enable) begin
+                data_in = i[9:0];
+            end
+
+            #1;
+            if (output_enable && data_out !== data_in) begin
+                $display("FAIL: passthrough altered a sample: in %0d out %0d", data_in, data_out);
+                errors = errors + 1;
+            end
+        end
+
+        if (output_samples != input_samples) begin
+            $display("FAIL: passthrough rate %0d outputs for %0d inputs", output_samples,
+                     input_samples);
+            errors = errors + 1;
+        end
+
+        // --- The rate ------------------------------------------------------
+
+        decimate = 1'b1;
+        do_reset;
+        drive_constant(512, 40);
+        clear_measurement(0);
+        drive_tone(1.0e6, 2000);
+
+        if (output_samples > (input_samples / 2) ||
+            output_samples < (input_samples / 2) - 1) begin
+            $display("FAIL: decimated rate %0d outputs for %0d inputs", output_samples,
+                     input_samples);
+            errors = errors + 1;
+        end
+
+        // --- DC ------------------------------------------------------------
+
+        do_reset;
+        drive_constant(512, 200);
+        clear_measurement(0);
+        drive_constant(512, 200);
+        if (minimum_out !== 512 || maximum_out !== 512) begin
+            $display("FAIL: DC 512 came out as %0d..%0d", minimum_out, maximum_out);
+            errors = errors + 1;
+        end
+
+        do_reset;
+        drive_constant(200, 200);
+        clear_measurement(0);
+        drive_constant(200, 200);
+        if (minimum_out !== 200 || maximum_out !== 200) begin
+            $display("FAIL: DC 200 came out as %0d..%0d", minimum_out, maximum_out);
+            errors = errors + 1;
+        end
+
+        // --- The band the final stage keeps --------------------------------
+        //
+        // To 5 MHz, an eighth of the input. The generator measures 0.002 dB
+        // of ripple there.
+
+        do_reset;
+        drive_tone(1.0e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(1.0e6, 3000);
+        check_gain("1 MHz", 0.97, 1.03);
+
+        do_reset;
+        drive_tone(4.3e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(4.3e6, 3000);
+        check_gain("4.3 MHz", 0.97, 1.03);
+
+        // --- Soft in between -------------------------------------------------
+        //
+        // -0.85 dB at 8 MHz by the generator's arithmetic. The final stage
+        // passes 8 MHz flat at 2:1; behind this stage it never sees it, since
+        // at 4:1 the final stage's own edge is 5 MHz.
+
+        do_reset;
+        drive_tone(7.9e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(7.9e6, 3000);
+        check_gain("7.9 MHz", 0.86, 0.96);
+
+        // --- The stopband ----------------------------------------------------
+        //
+        // From three eighths of the input up, where the alias would land in
+        // the band the final stage keeps: 15 MHz folds to 5 MHz, 18 MHz to
+        // 2 MHz. 14 MHz folds to 6 MHz, into the final stage's transition,
+        // and is held to the same bound anyway.
+
+        do_reset;
+        drive_tone(14.3e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(14.3e6, 3000);
+        check_gain("14.3 MHz alias", 0.0, 0.02);
+
+        do_reset;
+        drive_tone(15.7e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(15.7e6, 3000);
+        check_gain("15.7 MHz alias", 0.0, 0.02);
+
+        do_reset;
+        drive_tone(18.3e6, SettlingSamples);
+        clear_measurement(0);
+        drive_tone(18.3e6, 3000);
+        check_gain("18.3 MHz alias", 0.0, 0.02);
+
+        // --- Clipping -------------------------------------------------------
+
+        do_reset;
+        drive_constant(1023, 200);
+        clear_measurement(0);
+        for (i = 0; i < 60; i = i + 1) begin
+            drive_constant(0, 4);
+            drive_constant(1023, 4);
+        end
+        if (minimum_out < 0 || maximum_out > 1023) begin
+            $display("FAIL: a filtered sample left the converter's range: %0d..%0d", minimum_out,
+                     maximum_out);
+            errors = errors + 1;
+        end
+
+        if (errors == 0) begin
+            $display("tb_halfBandPrefilter: PASS");
+        end else begin
+            $display("tb_halfBandPrefilter: FAIL (%0d errors)", errors);
+        end
+
+        if (errors != 0) begin
+            $fatal(1, "tb_halfBandPrefilter failed");
+        end
+        $finish;
+    end
+
+endmodule
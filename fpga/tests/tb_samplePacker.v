@@ -0,0 +1,261 @@
+/************************************************************************
+
+    tb_samplePacker.v
+
+    Testbench for the packed wire format (T3)
+    Domesday Duplicator - LaserDisc RF sampler
+    SPDX-FileCopyrightText: 2026 Simon Inns
+    SPDX-License-Identifier: GPL-3.0-or-later
+
+    The host's unpacker and the synthetic source both have a copy of this
+    format, and each is tested against the other in the application's unit
+    tests. This is what ties the pair of them to the thing that actually
+    produces it: every property the host relies on - the header position, the
+    block length, the bit order, the four-in-five byte grouping, the restart on
+    a change of mode - is checked here against the words the buffer would be
+    given.
+
+    The block number's wrap is not. It is a 16-bit counter incremented once a
+    block, so it wraps the way every 16-bit counter does, and reaching it takes
+    ten seconds of simulated sampling.
+
+************************************************************************/
+
+`timescale 1ns / 1ps
+
+module tb_samplePacker;
+
+    // The format, as the host's sample_format.h states it
+    localparam integer BLOCK_WORDS = 4096;
+    localparam integer BLOCK_SAMPLES = 6552;
+
+    // The generator's ramp, which is what gives every sample a known successor
+    localparam integer RAMP_LENGTH = 1021;
+
+    // Three blocks: two to prove the header recurs, a third to prove it
+    // recurs in the same place again
+    localparam integer BLOCKS = 3;
+    localparam integer CAPTURE_WORDS = BLOCK_WORDS * BLOCKS;
+
+    // Stands in for the generator's sequence number. Alternating bits, so a
+    // packer that let any of them through would put them somewhere visible.
+    localparam [5:0] SEQUENCE_BITS = 6'b101010;
+
+    reg            reset_n;
+    reg            clock;
+    reg            pack;
+    reg     [ 9:0] ramp;
+    wire    [15:0] data_in = {SEQUENCE_BITS, ramp};
+    wire    [15:0] data_out;
+    wire           write_enable;
+
+    integer        errors;
+    integer        i;
+    integer        block;
+    integer        expected;
+    integer        words_in_word_mode;
+
+    // What the buffer would have been given, in order
+    reg     [15:0] captured                  [0:CAPTURE_WORDS-1];
+    integer        captured_count;
+    reg            capturing;
+
+    // 80 MHz system clock — 12.5 ns period
+    initial begin
+        clock = 1'b0;
+    end
+    always begin
+        #6.25 clock = ~clock;
+    end
+
+    // The sampling enable, built as the top level builds it, so that the
+    // packer sees samples exactly as far apart as it will in the fabric
+    reg adc_clock_divider;
+    initial begin
+        adc_clock_divider = 1'b0;
+    end
+    always @(posedge clock) begin
+        adc_clock_divider <= ~adc_clock_divider;
+    end
+
+    wire sample_enable = ~adc_clock_divider;
+
+    // The ramp advances on every sample, as the generator's does
+    initial begin
+        ramp = 10'd0;
+    end
+    always @(posedge clock) begin
+        if (sample_enable) begin
+            ramp <= (ramp == RAMP_LENGTH - 1) ? 10'd0 : ramp + 10'd1;
+        end
+    end
+
+    samplePacker dut (
+        .reset_n      (reset_n),
+        .clock        (clock),
+        .sample_enable(sample_enable),
+        .data_in      (data_in),
+        .pack         (pack),
+        .data_out     (data_out),
+        .write_enable (write_enable)
+    );
+
+    // The buffer's side of the interface: a word is taken on every edge that
+    // finds write_enable high, and nothing else is
+    always @(posedge clock) begin
+        if (capturing && write_enable && captured_count < CAPTURE_WORDS) begin
+            captured[captured_count] = data_out;
+            captured_count = captured_count + 1;
+        end
+    end
+
+    task check;
+        input [31:0] got;
+        input [31:0] want;
+        input [255:0] what;
+        begin
+            if (got !== want) begin
+                $display("FAIL: %0s: got %0d, expected %0d (t=%0t)", what, got, want, $time);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    // Sample `index` of block `block_index`, read out of the captured words
+    // the way the host reads it: ten bits starting at bit 10 * index of the
+    // payload, least significant first. A sample straddling two words takes
+    // its upper bits from the second.
+    function [9:0] payload_sample;
+        input [31:0] block_index;
+        input [31:0] index;
+        integer bit_position;
+        integer word;
+        reg [31:0] two_words;
+        begin
+            bit_position = index * 10;
+            word = (block_index * BLOCK_WORDS) + 1 + (bit_position / 16);
+            two_words = {captured[word+1], captured[word]};
+            payload_sample = two_words >> (bit_position % 16);
+        end
+    endfunction
+
+    // Byte `index` of block `block_index`'s payload, as the FX3 puts it on the
+    // wire: each word low byte first
+    function [7:0] payload_byte;
+        input [31:0] block_index;
+        input [31:0] index;
+        reg [15:0] word;
+        begin
+            word = captured[(block_index * BLOCK_WORDS) + 1 + (index / 2)];
+            payload_byte = (index % 2 == 0) ? word[7:0] : word[15:8];
+        end
+    endfunction
+
+    task wait_for_words;
+        input [31:0] count;
+        begin
+            while (captured_count < count) begin
+                @(posedge clock);
+            end
+            #1;
+        end
+    endtask
+
+    initial begin
+        errors         = 0;
+        pack           = 1'b0;
+        capturing      = 1'b0;
+        captured_count = 0;
+        reset_n        = 1'b0;
+
+        @(posedge clock);
+        #1 reset_n = 1'b1;
+
+        // --- Reset state -------------------------------------------------
+        check(write_enable, 0, "nothing written out of reset");
+
+        // --- Word mode ---------------------------------------------------
+        // Every sample is the generator's word, whole, sequence bits and all:
+        // exactly what the buffer was given before this module existed.
+        capturing = 1'b1;
+        repeat (400) @(posedge clock);
+        #1 capturing = 1'b0;
+        words_in_word_mode = captured_count;
+
+        check(words_in_word_mode, 200, "one word per sample in word mode");
+        for (i = 0; i + 1 < words_in_word_mode; i = i + 1) begin
+            check(captured[i][15:10], SEQUENCE_BITS, "word mode keeps the sequence bits");
+            check(captured[i+1][9:0], (captured[i][9:0] + 1) % RAMP_LENGTH,
+                  "word mode passes consecutive samples");
+        end
+
+        // --- Packed mode -------------------------------------------------
+        // Capturing starts a clock after the change, which is the cycle the
+        // packer spends restarting and writes nothing on. Everything from
+        // there is the new format.
+        captured_count = 0;
+        @(posedge clock);
+        #1 pack = 1'b1;
+        @(posedge clock);
+        #1 capturing = 1'b1;
+        wait_for_words(CAPTURE_WORDS);
+        capturing = 1'b0;
+
+        // A header opens every block, and it counts from zero
+        for (block = 0; block < BLOCKS; block = block + 1) begin
+            check(captured[block*BLOCK_WORDS], block, "block header");
+        end
+
+        // Behind each header, 6552 samples and not one more: the ramp runs
+        // on unbroken from the last sample of one block to the first of the
+        // next, with nothing of the sequence number in any of them
+        expected = payload_sample(0, 0);
+        for (block = 0; block < BLOCKS; block = block + 1) begin
+            for (i = 0; i < BLOCK_SAMPLES; i = i + 1) begin
+                check(payload_sample(block, i), expected, "packed sample");
+                expected = (expected + 1) % RAMP_LENGTH;
+            end
+        end
+
+        // Four samples in five bytes, least significant first. The second
+        // group starts half way through a word, which is the case a packer
+        // with its bit order backwards would get right by accident in the
+        // first.
+        for (i = 0; i < 2; i = i + 1) begin
+            if ({payload_byte(0, 5*i+4), payload_byte(0, 5*i+3), payload_byte(0, 5*i+2),
+                 payload_byte(0, 5*i+1), payload_byte(0, 5*i)}
+                !== {payload_sample(0, 4*i+3), payload_sample(0, 4*i+2),
+                     payload_sample(0, 4*i+1), payload_sample(0, 4*i)}) begin
+                $display("FAIL: group %0d is not four samples in five bytes", i);
+                errors = errors + 1;
+            end
+        end
+
+        // --- A change of mode restarts the format ------------------------
+        // The packer is part way into a fourth block by now. Back to words
+        // for a few samples and into packed mode again, and what follows is
+        // block zero, not the fourth block resumed or the fifth begun.
+        @(posedge clock);
+        #1 pack = 1'b0;
+        repeat (16) @(posedge clock);
+        #1 pack = 1'b1;
+        @(posedge clock);
+        #1 captured_count = 0;
+        capturing = 1'b1;
+        wait_for_words(2);
+        capturing = 1'b0;
+        check(captured[0], 0, "a change of mode starts again at block zero");
+
+        if (errors == 0) begin
+            $display("tb_samplePacker: PASS");
+        end else begin
+            $display("tb_samplePacker: FAIL (%0d errors)", errors);
+        end
+
+        if (errors != 0) begin
+            $fatal(1, "tb_samplePacker failed");
+        end
+        $finish;
+    end
+
+endmodule
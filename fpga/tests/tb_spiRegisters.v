@@ -52,6 +52,8 @@ module tb_spiRegisters;
 
     wire           test_mode;
     wire    [ 7:0] decimation;
+    wire    [ 7:0] wire_format;
+    wire           inband_telemetry;
     wire    [ 7:0] leds;
 
     // The 0x20 to 0x23 window, which in a real image reaches the flash
@@ -101,6 +103,8 @@ module tb_spiRegisters;
     wire            telemetry_latch_absent;
     wire            test_mode_absent;
     wire    [  7:0] decimation_absent;
+    wire    [  7:0] wire_format_absent;
+    wire            inband_telemetry_absent;
     wire    [  7:0] leds_absent;
     wire            window_write_absent;
     wire    [  1:0] window_address_absent;
@@ -112,7 +116,9 @@ module tb_spiRegisters;
         .BuildFlags       (BUILD_FLAGS),
         .ImageRole        (IMAGE_ROLE),
         .TelemetryPresent (1'b1),
-        .DecimationPresent(1'b1)
+        .DecimationPresent(1'b1),
+        .PackingPresent   (1'b1),
+        .InbandTelemetryPresent(1'b1)
     ) dut (
         .reset_n            (reset_n),
         .clock              (clock),
@@ -126,6 +132,8 @@ module tb_spiRegisters;
         .spi_miso           (spi_miso),
         .test_mode          (test_mode),
         .decimation         (decimation),
+        .wire_format        (wire_format),
+        .inband_telemetry   (inband_telemetry),
         .leds               (leds),
         .window_write       (window_write),
         .window_address     (window_address),
@@ -139,7 +147,9 @@ module tb_spiRegisters;
         .BuildFlags       (BUILD_FLAGS),
         .ImageRole        (IMAGE_ROLE),
         .TelemetryPresent (1'b0),
-        .DecimationPresent(1'b0)
+        .DecimationPresent(1'b0),
+        .PackingPresent   (1'b0),
+        .InbandTelemetryPresent(1'b0)
     ) dut_absent (
         .reset_n            (reset_n),
         .clock              (clock),
@@ -153,6 +163,8 @@ module tb_spiRegisters;
         .spi_miso           (spi_miso_absent),
         .test_mode          (test_mode_absent),
         .decimation         (decimation_absent),
+        .wire_format        (wire_format_absent),
+        .inband_telemetry   (inband_telemetry_absent),
         .leds               (leds_absent),
         .window_write       (window_write_absent),
         .window_address     (window_address_absent),
@@ -367,15 +379,28 @@ module tb_spiRegisters;
         spi_read(7'h12, 8'd1);
         check(read_data[0], 8'h02, "2:1 decimation reads back");
 
+        spi_write_one(7'h12, 8'h04);
+        check(decimation, 8'h04, "4:1 decimation selected");
+        spi_read(7'h12, 8'd1);
+        check(read_data[0], 8'h04, "4:1 decimation reads back");
+
+        spi_write_one(7'h12, 8'h08);
+        check(decimation, 8'h08, "8:1 decimation selected");
+        spi_read(7'h12, 8'd1);
+        check(read_data[0], 8'h08, "8:1 decimation reads back");
+
         // A factor this gateware does not implement is normalised to every
         // sample rather than stored. The host reads back 1, learns that its
-        // request was not honoured, and can say so - where a stored 4 would
-        // have it believe the capture was quarter rate when it was not.
-        spi_write_one(7'h12, 8'h04);
+        // request was not honoured, and can say so - where a stored 3 would
+        // have it believe the capture was a third of the rate when it was not.
+        spi_write_one(7'h12, 8'h03);
         check(decimation, 8'h01, "an unsupported factor falls back to every sample");
         spi_read(7'h12, 8'd1);
         check(read_data[0], 8'h01, "and reads back as every sample");
 
+        spi_write_one(7'h12, 8'h10);
+        check(decimation, 8'h01, "16:1 is not implemented either");
+
         // Zero is not a factor at all. It has to mean the same as one rather
         // than stopping the capture path, because dividing by it is what the
         // fabric would otherwise be asked to do.
@@ -391,6 +416,58 @@ module tb_spiRegisters;
         // is written, which is what makes the whole register fold away there.
         check(decimation_absent, 8'h01, "no capture path means no decimation");
 
+        // --- Wire format ---
+        //
+        // The same three answers as decimation, with one difference that
+        // matters: here "not implemented" and "word mode" are the same value,
+        // zero, because word mode is what gateware without the register
+        // sends. A host that reads zero unpacks nothing, whichever it is.
+        check(wire_format, 8'h00, "the wire format resets to one word per sample");
+        spi_read(7'h13, 8'd1);
+        check(read_data[0], 8'h00, "and reads back as words");
+
+        spi_write_one(7'h13, 8'h01);
+        check(wire_format, 8'h01, "packed format selected");
+        spi_read(7'h13, 8'd1);
+        check(read_data[0], 8'h01, "packed format reads back");
+
+        // A format this gateware does not know is words, not stored: a
+        // stored 2 would tell the host the stream is in a format it is not.
+        spi_write_one(7'h13, 8'h02);
+        check(wire_format, 8'h00, "an unknown format falls back to words");
+        spi_read(7'h13, 8'd1);
+        check(read_data[0], 8'h00, "and reads back as words");
+
+        spi_write_one(7'h13, 8'h01);
+        spi_write_one(7'h13, 8'h00);
+        check(wire_format, 8'h00, "back to words");
+
+        check(wire_format_absent, 8'h00, "no capture path means nothing to pack");
+
+        // --- In-band telemetry ---
+        //
+        // A switch with the wire format's normalisation: one value turns it
+        // on, and anything else is off and reads back as off, because what the
+        // host reads back is what it will strip from the stream.
+        check(inband_telemetry, 1'b0, "in-band telemetry resets off");
+        spi_read(7'h14, 8'd1);
+        check(read_data[0], 8'h00, "and reads back as off");
+
+        spi_write_one(7'h14, 8'h01);
+        check(inband_telemetry, 1'b1, "in-band telemetry switched on");
+        spi_read(7'h14, 8'd1);
+        check(read_data[0], 8'h01, "and reads back as on");
+
+        spi_write_one(7'h14, 8'hFF);
+        check(inband_telemetry, 1'b0, "a value other than one is off");
+        spi_read(7'h14, 8'd1);
+        check(read_data[0], 8'h00, "and reads back as off");
+
+        check(inband_telemetry_absent, 1'b0, "no capture buffer means no readings to send");
+        spi_write_one(7'h14, 8'h01);
+        check(inband_telemetry_absent, 1'b0, "whatever is written");
+        spi_write_one(7'h14, 8'h00);
+
         // --- LEDs ---
         spi_write_one(7'h11, 8'hA5);
         check(leds, 8'hA5, "LED register drives the LEDs");
@@ -502,6 +579,9 @@ module tb_spiRegisters;
         spi_read(7'h12, 8'd1);
         check(read_data_absent[0], 8'h00, "no decimation register without a capture path");
 
+        spi_read(7'h13, 8'd1);
+        check(read_data_absent[0], 8'h00, "no wire format register without a capture path");
+
         // --- The 0x20 to 0x23 window ---
         //
         // Four addresses that are not registers in this module at all: a
@@ -22,8 +22,22 @@ decimate actually turns on. tb_halfBandDecimator.v measures the same response
 in simulation, through the fabric and a 10-bit output; this checks the
 arithmetic the fabric was given, which is where a wrong window or a wrong
 length would show first and most precisely.
+
+Both tables are checked: the final stage's in halfBandDecimator.v, and the
+shorter front stage's in halfBandPrefilter.v that 4:1 and 8:1 put ahead of it.
+They are built around the same two properties and judged against different
+bands, for the reasons the generator gives.
+
+Last, the two tables are run as the fabric cascades them for 2:1, 4:1 and 8:1,
+one sample at a time in the modules' own integer arithmetic - the offset, the
+pre-add, the rounding shift and the 10-bit clip - against the tones and limits
+tb_decimationChain.v drives. That bench is the word on the fabric; this is the
+word on whether its limits are ones the arithmetic can meet, and it runs
+wherever Python does.
 """
 
+import math
+
 import importlib.util
 import re
 import sys
@@ -32,6 +46,7 @@ from pathlib import Path
 HERE = Path(__file__).resolve().parent
 GENERATOR = HERE.parent / "make-halfband-coefficients.py"
 MODULE = HERE.parent / "application" / "halfBandDecimator.v"
+FRONT_MODULE = HERE.parent / "application" / "halfBandPrefilter.v"
 
 spec = importlib.util.spec_from_file_location("make_halfband", GENERATOR)
 make_halfband = importlib.util.module_from_spec(spec)
@@ -45,10 +60,11 @@ def check(condition, message):
         failures.append(message)
 
 
-def main():
-    table = make_halfband.coefficients()
-    centre = (make_halfband.TAP_COUNT - 1) // 2
+def check_table(module, tap_count, beta, pair_count, response_points):
+    table = make_halfband.coefficients(tap_count, beta)
+    centre = (tap_count - 1) // 2
     scale = 1 << make_halfband.COEFFICIENT_SCALE_BITS
+    name = module.name
 
     # --- The two properties the fabric is built around ----------------------
 
@@ -56,83 +72,195 @@ def main():
     # capture, which reads as a black-level error rather than as a filter
     # fault.
     check(sum(table) == scale,
-          f"DC gain is {sum(table)}, not {scale}")
+          f"{name}: DC gain is {sum(table)}, not {scale}")
 
-    # halfBandDecimator.v applies the centre tap with `<<< CentreShift` rather
-    # than with a multiplier. That is only the right answer while the centre
-    # coefficient is exactly half of full scale.
+    # The module applies the centre tap as a multiply by a power of two, which
+    # costs nothing only while the centre coefficient is exactly half of full
+    # scale.
     check(table[centre] == scale // 2,
-          f"centre tap is {table[centre]}, not {scale // 2} — "
-          "halfBandDecimator.v applies it as a shift and would be wrong")
+          f"{name}: centre tap is {table[centre]}, not {scale // 2} — "
+          "the module applies it as a shift and would be wrong")
 
     # Every second coefficient either side of the centre is exactly zero. This
-    # is what makes it a half-band filter and what halves the multiplier count;
-    # a table without it would need thirty-two multipliers, not sixteen.
+    # is what makes it a half-band filter and what halves the multiplier count.
     for index, value in enumerate(table):
         offset = index - centre
         if offset != 0 and offset % 2 == 0:
-            check(value == 0, f"tap {index} should be zero and is {value}")
+            check(value == 0, f"{name}: tap {index} should be zero and is {value}")
 
-    check(len(make_halfband.symmetric_pairs(table)) == 16,
-          "expected 16 multiplier pairs")
+    check(len(make_halfband.symmetric_pairs(table)) == pair_count,
+          f"{name}: expected {pair_count} multiplier pairs")
 
     # Symmetric, which is what makes the pre-add legal and the phase linear.
-    for index in range(make_halfband.TAP_COUNT):
-        check(table[index] == table[make_halfband.TAP_COUNT - 1 - index],
-              f"tap {index} is not symmetric with tap "
-              f"{make_halfband.TAP_COUNT - 1 - index}")
+    for index in range(tap_count):
+        check(table[index] == table[tap_count - 1 - index],
+              f"{name}: tap {index} is not symmetric with tap "
+              f"{tap_count - 1 - index}")
 
     # Sixteen signed bits, because that is the multiplier input the device has.
     for index, value in enumerate(table):
         check(-32768 <= value <= 32767,
-              f"tap {index} is {value}, which does not fit a signed 16-bit coefficient")
+              f"{name}: tap {index} is {value}, which does not fit a signed "
+              "16-bit coefficient")
 
     # --- The response -------------------------------------------------------
-    #
-    # Passband flat where a tape's signal is, stopband deep where an alias
-    # would land on it. 15 MHz is the one that matters most: undecimated it is
-    # noise above the signal, decimated without a filter it lands on 5 MHz,
-    # directly on the luma FM carrier.
-    for megahertz, low_db, high_db in [
-        (0.0, -0.01, 0.01),
-        (4.0, -0.01, 0.01),
-        (8.0, -0.05, 0.05),
-        (10.0, -6.1, -5.9),     # -6 dB at the edge, by construction
-        (12.0, -1000.0, -70.0),
-        (15.0, -1000.0, -70.0),
-        (18.0, -1000.0, -70.0),
-    ]:
+
+    for megahertz, low_db, high_db in response_points:
         magnitude = make_halfband.frequency_response(table, megahertz * 1e6)
         response = make_halfband.decibels(magnitude)
         check(low_db <= response <= high_db,
-              f"{megahertz} MHz response is {response:.2f} dB, "
+              f"{name}: {megahertz} MHz response is {response:.2f} dB, "
               f"expected {low_db} to {high_db} dB")
 
     # --- The committed Verilog ----------------------------------------------
 
-    source = MODULE.read_text(encoding="utf-8")
-    expected = make_halfband.verilog_table()
+    source = module.read_text(encoding="utf-8")
+    expected = make_halfband.verilog_table(tap_count, beta)
 
     if expected not in source:
         failures.append(
-            f"{MODULE.name} does not contain the generated table.\n"
+            f"{name} does not contain the generated table.\n"
             "Regenerate it with:\n"
-            "    fpga/make-halfband-coefficients.py\n"
+            "    fpga/make-halfband-coefficients.py"
+            + (" --front" if module == FRONT_MODULE else "") + "\n"
             "and paste the output over the block in the module.\n"
             "Expected to find:\n" + expected)
 
     # And that the module's own constants agree with the generator's, since
     # they are written out separately on both sides.
-    for name, value in [
-        ("TapCount", make_halfband.TAP_COUNT),
+    for constant, value in [
+        ("TapCount", tap_count),
+        ("PairCount", pair_count),
         ("ScaleBits", make_halfband.COEFFICIENT_SCALE_BITS),
     ]:
-        match = re.search(rf"localparam\s+integer\s+{name}\s*=\s*(\d+)\s*;", source)
+        match = re.search(rf"localparam\s+integer\s+{constant}\s*=\s*(\d+)\s*;", source)
         if match is None:
-            failures.append(f"{MODULE.name} does not declare {name}")
+            failures.append(f"{name} does not declare {constant}")
         else:
             check(int(match.group(1)) == value,
-                  f"{MODULE.name} has {name} = {match.group(1)}, generator has {value}")
+                  f"{name} has {constant} = {match.group(1)}, generator has {value}")
+
+    return table
+
+
+class Stage:
+    """One 2:1 stage as halfBandDecimator.v and halfBandPrefilter.v compute it.
+
+    An output is due on every second input sample, and is computed from the
+    history as it stood before that sample arrived, as the modules' first
+    pipeline stage reads it. The pipeline's own latency is left out: it moves
+    outputs in time without changing any of them.
+    """
+
+    def __init__(self, table):
+        self.table = table
+        self.centre = (len(table) - 1) // 2
+        self.delay = [0] * len(table)
+        self.phase = 0
+
+    def push(self, sample):
+        output = None
+        if self.phase:
+            # Every tap is offset to signed first, exactly as the pre-adds are.
+            total = sum(coefficient * (self.delay[index] - 512)
+                        for index, coefficient in enumerate(self.table)
+                        if coefficient != 0)
+            scale_bits = make_halfband.COEFFICIENT_SCALE_BITS
+            value = ((total + (1 << (scale_bits - 1))) >> scale_bits) + 512
+            output = min(max(value, 0), 1023)
+        self.delay = [sample] + self.delay[:-1]
+        self.phase ^= 1
+        return output
+
+
+def run_chain(stages, samples):
+    outputs = []
+    for sample in samples:
+        for stage in stages:
+            sample = stage.push(sample)
+            if sample is None:
+                break
+        if sample is not None:
+            outputs.append(sample)
+    return outputs
+
+
+def check_cascade(final, front):
+    # The stages each factor switches in, front to back, as decimationChain.v
+    # wires them.
+    def chain(factor):
+        stages = [Stage(front) for _ in range({2: 0, 4: 1, 8: 2}[factor])]
+        return stages + [Stage(final)]
+
+    # The bench's tone: amplitude 480 about mid-range, truncated as $rtoi
+    # truncates, with the phase restarting when the measurement starts.
+    def tone(megahertz, count):
+        step = 2.0 * math.pi * megahertz * 1e6 / make_halfband.SAMPLE_RATE_HZ
+        return [512 + int(480.0 * math.sin(step * n)) for n in range(count)]
+
+    settling, measured = 800, 6000
+
+    # factor, MHz, lowest and highest peak-to-peak gain: tb_decimationChain.v's
+    # list, in its order.
+    for factor, megahertz, low, high in [
+        (2, 1.0, 0.97, 1.03), (2, 15.7, 0.0, 0.02),
+        (4, 1.0, 0.97, 1.03), (4, 3.3, 0.97, 1.03),
+        (4, 7.7, 0.0, 0.02), (4, 17.3, 0.0, 0.02),
+        (8, 0.7, 0.97, 1.03), (8, 1.7, 0.97, 1.03),
+        (8, 3.7, 0.0, 0.02), (8, 8.7, 0.0, 0.02), (8, 17.3, 0.0, 0.02),
+    ]:
+        stages = chain(factor)
+        run_chain(stages, tone(megahertz, settling))
+        outputs = run_chain(stages, tone(megahertz, measured))
+        gain = (max(outputs) - min(outputs)) / 960.0
+        check(low <= gain <= high,
+              f"{factor}:1 at {megahertz} MHz: gain {gain:.4f}, "
+              f"tb_decimationChain.v expects {low} to {high}")
+        check(len(outputs) == measured // factor,
+              f"{factor}:1: {len(outputs)} outputs for {measured} inputs")
+
+    # DC through every factor comes out exactly as it went in.
+    for factor in (2, 4, 8):
+        for level in (512, 200):
+            stages = chain(factor)
+            run_chain(stages, [level] * settling)
+            outputs = run_chain(stages, [level] * settling)
+            check(set(outputs) == {level},
+                  f"{factor}:1 DC {level} came out as "
+                  f"{min(outputs)}..{max(outputs)}")
+
+
+def main():
+    # The final stage. Passband flat where a tape's signal is, stopband deep
+    # where an alias would land on it. 15 MHz is the one that matters most:
+    # undecimated it is noise above the signal, decimated without a filter it
+    # lands on 5 MHz, directly on the luma FM carrier.
+    table = check_table(MODULE, make_halfband.TAP_COUNT, make_halfband.KAISER_BETA, 16, [
+        (0.0, -0.01, 0.01),
+        (4.0, -0.01, 0.01),
+        (8.0, -0.05, 0.05),
+        (10.0, -6.1, -5.9),     # -6 dB at the edge, by construction
+        (12.0, -1000.0, -70.0),
+        (15.0, -1000.0, -70.0),
+        (18.0, -1000.0, -70.0),
+    ])
+
+    # The front stage, at a 40 MHz input. It must be transparent across the
+    # eighth of its input the final stage keeps - 5 MHz here - and deep from
+    # three eighths up, 15 MHz, which is what folds into that eighth. 14 MHz
+    # folds into the final stage's own transition band, where less is needed.
+    front = check_table(FRONT_MODULE, make_halfband.FRONT_TAP_COUNT,
+                        make_halfband.FRONT_KAISER_BETA, 6, [
+        (0.0, -0.01, 0.01),
+        (4.0, -0.01, 0.01),
+        (5.0, -0.01, 0.01),
+        (10.0, -6.1, -5.9),
+        (14.0, -1000.0, -60.0),
+        (15.0, -1000.0, -70.0),
+        (18.0, -1000.0, -70.0),
+    ])
+
+    check_cascade(table, front)
 
     if failures:
         for failure in failures:
@@ -140,10 +268,14 @@ def main():
         print(f"\n{len(failures)} failure(s)", file=sys.stderr)
         return 1
 
+    scale = 1 << make_halfband.COEFFICIENT_SCALE_BITS
     print(f"half-band coefficients OK "
           f"({make_halfband.TAP_COUNT} taps, "
-          f"{len(make_halfband.symmetric_pairs(table))} multipliers, "
-          f"DC gain {sum(table)}/{scale})")
+          f"{len(make_halfband.symmetric_pairs(table))} multipliers; front stage "
+          f"{make_halfband.FRONT_TAP_COUNT} taps, "
+          f"{len(make_halfband.symmetric_pairs(front))} multipliers; "
+          f"DC gain {sum(table)}/{scale}; 2:1, 4:1 and 8:1 cascades meet "
+          f"tb_decimationChain.v's limits)")
     return 0
 
 
@@ -528,6 +528,52 @@ CyU3PDmaBufferFree (
     return retVal;
 }
 
+/* Not part of the porting layer: what the buffer heap has left, for the
+   application to report once its channels are created. CyU3PDmaBufferAlloc
+   leaves the last unit of every block clear to mark where it ends, so the
+   free space counted here reads one 32 byte unit high per allocation; the
+   largest block, a unit less than the longest clear run for the same reason,
+   is exact, and is the one to read. Runs do not join across the wrap, as
+   they do not when allocating. */
+void
+domDupBufferHeapFree (
+        uint32_t *freeBytes,
+        uint32_t *largestBytes)
+{
+    uint32_t wordnum, bitnum;
+    uint32_t run = 0, longest = 0, total = 0;
+
+    *freeBytes    = 0;
+    *largestBytes = 0;
+
+    if (CyU3PMutexGet (&glBufferManager.lock, CY_U3P_BUFFER_ALLOC_TIMEOUT) != CY_U3P_SUCCESS)
+    {
+        return;
+    }
+
+    for (wordnum = 0; wordnum < glBufferManager.statusSize; wordnum++)
+    {
+        for (bitnum = 0; bitnum < 32; bitnum++)
+        {
+            if ((glBufferManager.usedStatus[wordnum] & (1 << bitnum)) == 0)
+            {
+                total++;
+                run++;
+                longest = CY_U3P_MAX (longest, run);
+            }
+            else
+            {
+                run = 0;
+            }
+        }
+    }
+
+    CyU3PMutexPut (&glBufferManager.lock);
+
+    *freeBytes    = total << 5;
+    *largestBytes = (longest > 1) ? ((longest - 1) << 5) : 0;
+}
+
 void
 CyU3PFreeHeaps (
 	void)
@@ -714,6 +714,15 @@ void domDupStartApplication(void)
         domDupErrorHandler(apiReturnStatus);
     }
 
+    // Report the buffer heap's margin now the largest thing in it exists.
+    // See CY_FX_DMA_BUF_COUNT for where the rest of it goes.
+    {
+        uint32_t heapFree, heapLargest;
+        domDupBufferHeapFree(&heapFree, &heapLargest);
+        CyU3PDebugPrint(1, "domDupStartApplication(): DMA buffer heap has %d bytes free, largest block %d\r\n",
+            heapFree, heapLargest);
+    }
+
     // Start the DMA channel transfer
     apiReturnStatus = CyU3PDmaMultiChannelSetXfer(&glDmaMultiChHandle, 0, 0);
     if (apiReturnStatus != CY_U3P_SUCCESS) {
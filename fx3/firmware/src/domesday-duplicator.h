@@ -46,8 +46,30 @@
 #define CY_FX_EP_BURST_LENGTH           (16)
 // Set the DMA buffer size to 16Kbytes for the application
 #define CY_FX_DMA_BUF_SIZE              (16384)
-// Set the total number of DMA buffers available to 4 (64Kbytes total)
-#define CY_FX_DMA_BUF_COUNT             (4)
+// Set the number of DMA buffers to 6 per GPIF producer socket.
+//
+// The count is per socket, and the many-to-one channel has two, so this is
+// twelve 16Kbyte buffers. cyfxtx.c sets the buffer heap at 0x40040000 to
+// 0x40078000, 224Kbytes, and its allocator hands out 32 byte units. A 16Kbyte
+// buffer is 512 of them, but CyU3PDmaBufferAlloc() only grants it where 513
+// are clear: the buffer starts one unit into the run, and its own last unit is
+// left clear to mark where it ends. Allocated back to back, the clear unit in
+// front of each buffer is the last unit of the one before, so that overhead is
+// one unit for the whole run rather than one per buffer - 16,416 bytes for a
+// buffer on its own, 16,384 for each one after it. The twelve take 196,640 of
+// the heap's 229,376 bytes and leave 32,736. What else comes out of that heap
+// is the SDK's: the debug UART's channel and the USB driver's control
+// endpoint, which are a few Kbytes between them. The firmware's own buffers
+// are static and are not in the heap at all. Each buffer is a packet the FX3
+// can hold while the host is not collecting, so these are 2.5ms of sampling at
+// 40 MSPS on top of the FPGA's FIFO - which is why it is as many as the heap
+// allows rather than the 4 per socket it used to be: a seventh per socket
+// would need 14 x 16,384 + 32 = 229,408 bytes, more than the heap has before
+// anything else is allocated. A count the heap cannot satisfy fails
+// CyU3PDmaMultiChannelCreate() outright, at the first capture, and
+// domDupStartApplication() prints what the heap has left once the channel
+// exists, so the margin is on the debug console of every unit.
+#define CY_FX_DMA_BUF_COUNT             (6)
 
 // Function prototypes
 void domDupThreadInitialise(uint32_t input);
@@ -58,6 +80,7 @@ void domDupStopApplication(void);
 void domDupClearInputFlags(void);
 void domDupErrorHandler(CyU3PReturnStatus_t apiReturnStatus);
 void domDupDebugInit(void);
+void domDupBufferHeapFree(uint32_t *freeBytes, uint32_t *largestBytes);
 
 // Callback function prototypes
 void gpifDmaEventCB(CyU3PGpifEventType Event, uint8_t State);
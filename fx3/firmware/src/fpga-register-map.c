@@ -115,10 +115,12 @@ void fpgaIdentityCommitText(const uint8_t *identity, char *text, size_t size)
 
 int fpgaRegisterIsHostWritable(uint8_t address)
 {
-    // Test mode and the sample rate. Both select what the capture path does
-    // with the samples before they reach the buffer, both are meaningless to
-    // this firmware, and the host is the only thing that knows which the user
-    // asked for.
+    // Test mode, the sample rate, the wire format and in-band telemetry. All
+    // four select what the capture path does with the samples before they
+    // reach the USB link, all four are meaningless to this firmware - it
+    // moves bytes, and a packed stream or a packet that opens with a
+    // telemetry block is bytes like any other - and the host is the only
+    // thing that knows which the user asked for.
     //
     // The LED register is excluded even though the gateware would accept the
     // write, because the LEDs are a status output and status outputs have
@@ -131,7 +133,9 @@ int fpgaRegisterIsHostWritable(uint8_t address)
     // well: a write to an address it does not name is refused with a stall,
     // however willing the gateware would have been.
     return (address == FPGA_REGISTER_TEST_MODE ||
-            address == FPGA_REGISTER_DECIMATION) ? 1 : 0;
+            address == FPGA_REGISTER_DECIMATION ||
+            address == FPGA_REGISTER_WIRE_FORMAT ||
+            address == FPGA_REGISTER_INBAND_TELEMETRY) ? 1 : 0;
 }
 
 int fpgaReadRequestIsValid(uint16_t address, uint16_t length)
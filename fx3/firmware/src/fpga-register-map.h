@@ -34,12 +34,28 @@
 #define FPGA_REGISTER_TEST_MODE         (0x10u)
 #define FPGA_REGISTER_LED               (0x11u)
 #define FPGA_REGISTER_DECIMATION        (0x12u)
+#define FPGA_REGISTER_WIRE_FORMAT       (0x13u)
+#define FPGA_REGISTER_INBAND_TELEMETRY  (0x14u)
 
 // Decimation factors. The register holds the factor rather than a flag, so
 // reading it back says what the capture path is doing rather than echoing what
 // was asked for.
 #define FPGA_DECIMATION_EVERY_SAMPLE    (0x01u)
 #define FPGA_DECIMATION_HALF_RATE       (0x02u)
+#define FPGA_DECIMATION_QUARTER_RATE    (0x04u)
+#define FPGA_DECIMATION_EIGHTH_RATE     (0x08u)
+
+// Wire formats: one 16-bit word per sample, or four samples in five bytes
+// behind a numbered header. Nothing here reads the stream, so these are only
+// named so that the list of host-writable registers reads as what it is.
+#define FPGA_WIRE_FORMAT_WORDS          (0x00u)
+#define FPGA_WIRE_FORMAT_PACKED         (0x01u)
+
+// In-band telemetry: off, or a tagged block of buffer readings at the head of
+// every packet. Named for the same reason as the wire formats - the packets
+// are still 16 KiB and the firmware still only moves them.
+#define FPGA_INBAND_TELEMETRY_OFF       (0x00u)
+#define FPGA_INBAND_TELEMETRY_ON        (0x01u)
 
 // Map version 2's flash bridge and reconfiguration control. These are the
 // only registers whose writes have an effect outside the register bank:
@@ -138,11 +138,15 @@ static void testCommitText(void)
 static void testHostWritable(void)
 {
     // What the capture path does with the samples is the host's to choose,
-    // and these two are the whole of that choice.
+    // and these four are the whole of that choice.
     check(fpgaRegisterIsHostWritable(FPGA_REGISTER_TEST_MODE),
           "the host may write test mode");
     check(fpgaRegisterIsHostWritable(FPGA_REGISTER_DECIMATION),
           "the host may write the decimation factor");
+    check(fpgaRegisterIsHostWritable(FPGA_REGISTER_WIRE_FORMAT),
+          "the host may write the wire format");
+    check(fpgaRegisterIsHostWritable(FPGA_REGISTER_INBAND_TELEMETRY),
+          "the host may write the in-band telemetry switch");
 
     // The gateware would accept this write. The firmware refuses to relay it,
     // because the LEDs are a status output with exactly one owner.
@@ -154,12 +158,12 @@ static void testHostWritable(void)
     check(!fpgaRegisterIsHostWritable(0x20u),
           "the host may not write an unmapped register");
 
-    // The addresses either side of the two that are permitted, so that a
+    // The addresses either side of the ones that are permitted, so that a
     // whitelist which had become a range would fail here.
     check(!fpgaRegisterIsHostWritable(0x0Fu),
           "the host may not write the address below test mode");
-    check(!fpgaRegisterIsHostWritable(0x13u),
-          "the host may not write the address above decimation");
+    check(!fpgaRegisterIsHostWritable(0x15u),
+          "the host may not write the address above in-band telemetry");
 }
 
 static void testReadRequests(void)